@@ -8,34 +8,43 @@
 namespace MAEVN
 {
 
+namespace
+{
+    template <size_t N>
+    int findParameterIndex(const char* const (&names)[N], const juce::String& name)
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (name.equalsIgnoreCase(names[i]))
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+}
+
 //==============================================================================
 // CompressorEffect Implementation
 //==============================================================================
 
 CompressorEffect::CompressorEffect()
     : currentSampleRate(44100.0)
+    , releaseMs(100.0f)
 {
     compressor.setThreshold(-10.0f);
     compressor.setRatio(4.0f);
     compressor.setAttack(5.0f);
-    compressor.setRelease(100.0f);
+    compressor.setRelease(releaseMs);
 }
 
 void CompressorEffect::prepare(double sampleRate, int maxBlockSize)
 {
     currentSampleRate = sampleRate;
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = maxBlockSize;
-    spec.numChannels = 2;
-    compressor.prepare(spec);
+    compressor.prepare(sampleRate, maxBlockSize, 2);
 }
 
 void CompressorEffect::process(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
-    compressor.process(context);
+    compressor.process(buffer, numSamples);
 }
 
 void CompressorEffect::reset()
@@ -60,72 +69,99 @@ void CompressorEffect::setAttack(float ms)
 
 void CompressorEffect::setRelease(float ms)
 {
+    releaseMs = ms;
     compressor.setRelease(ms);
 }
 
+int CompressorEffect::getParameterIndex(const juce::String& name) const
+{
+    static const char* const names[] = { "threshold", "ratio", "attack", "release" };
+    return findParameterIndex(names, name);
+}
+
+void CompressorEffect::setParameter(int index, float value)
+{
+    switch (index)
+    {
+        case 0: setThreshold(value); break;
+        case 1: setRatio(value); break;
+        case 2: setAttack(value); break;
+        case 3: setRelease(value); break;
+        default: break;
+    }
+}
+
 //==============================================================================
 // EQEffect Implementation
 //==============================================================================
 
 EQEffect::EQEffect()
-    : currentSampleRate(44100.0)
+    : bands(NumBands)
+    , currentSampleRate(44100.0)
+    , lowGainDB(0.0f)
+    , midGainDB(0.0f)
+    , highGainDB(0.0f)
 {
 }
 
 void EQEffect::prepare(double sampleRate, int maxBlockSize)
 {
     currentSampleRate = sampleRate;
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = maxBlockSize;
-    spec.numChannels = 2;
-    
-    eqChain.prepare(spec);
     
-    // Low shelf at 200 Hz
-    *eqChain.get<0>().coefficients = *juce::dsp::IIR::Coefficients<float>::makeLowShelf(
-        sampleRate, 200.0f, 0.7f, 1.0f);
-    
-    // Mid peak at 1000 Hz
-    *eqChain.get<1>().coefficients = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        sampleRate, 1000.0f, 1.0f, 1.0f);
+    // Designed first so prepare() starts on them instead of ramping
+    setLowGain(lowGainDB);
+    setMidGain(midGainDB);
+    setHighGain(highGainDB);
     
-    // High shelf at 8000 Hz
-    *eqChain.get<2>().coefficients = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-        sampleRate, 8000.0f, 0.7f, 1.0f);
+    bands.prepare(2);
 }
 
 void EQEffect::process(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
-    eqChain.process(context);
+    bands.process(buffer, numSamples);
 }
 
 void EQEffect::reset()
 {
-    eqChain.reset();
+    bands.reset();
 }
 
 void EQEffect::setLowGain(float dB)
 {
-    float gain = dBToGain(dB);
-    *eqChain.get<0>().coefficients = *juce::dsp::IIR::Coefficients<float>::makeLowShelf(
-        currentSampleRate, 200.0f, 0.7f, gain);
+    // Low shelf at 200 Hz
+    lowGainDB = dB;
+    bands.setCoefficients(LowShelfBand, BiquadCoefficients::makeLowShelf(currentSampleRate, 200.0f, 0.7f, dBToGain(dB)));
 }
 
 void EQEffect::setMidGain(float dB)
 {
-    float gain = dBToGain(dB);
-    *eqChain.get<1>().coefficients = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        currentSampleRate, 1000.0f, 1.0f, gain);
+    // Mid peak at 1000 Hz
+    midGainDB = dB;
+    bands.setCoefficients(MidPeakBand, BiquadCoefficients::makePeakFilter(currentSampleRate, 1000.0f, 1.0f, dBToGain(dB)));
 }
 
 void EQEffect::setHighGain(float dB)
 {
-    float gain = dBToGain(dB);
-    *eqChain.get<2>().coefficients = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-        currentSampleRate, 8000.0f, 0.7f, gain);
+    // High shelf at 8000 Hz
+    highGainDB = dB;
+    bands.setCoefficients(HighShelfBand, BiquadCoefficients::makeHighShelf(currentSampleRate, 8000.0f, 0.7f, dBToGain(dB)));
+}
+
+int EQEffect::getParameterIndex(const juce::String& name) const
+{
+    static const char* const names[] = { "lowGain", "midGain", "highGain" };
+    return findParameterIndex(names, name);
+}
+
+void EQEffect::setParameter(int index, float value)
+{
+    switch (index)
+    {
+        case 0: setLowGain(value); break;
+        case 1: setMidGain(value); break;
+        case 2: setHighGain(value); break;
+        default: break;
+    }
 }
 
 //==============================================================================
@@ -187,14 +223,33 @@ void ReverbEffect::setDryLevel(float level)
     reverb.setParameters(reverbParams);
 }
 
+int ReverbEffect::getParameterIndex(const juce::String& name) const
+{
+    static const char* const names[] = { "roomSize", "damping", "wetLevel", "dryLevel" };
+    return findParameterIndex(names, name);
+}
+
+void ReverbEffect::setParameter(int index, float value)
+{
+    switch (index)
+    {
+        case 0: setRoomSize(value); break;
+        case 1: setDamping(value); break;
+        case 2: setWetLevel(value); break;
+        case 3: setDryLevel(value); break;
+        default: break;
+    }
+}
+
 //==============================================================================
 // LimiterEffect Implementation
 //==============================================================================
 
 LimiterEffect::LimiterEffect()
+    : releaseMs(50.0f)
 {
     limiter.setThreshold(-1.0f);
-    limiter.setRelease(50.0f);
+    limiter.setRelease(releaseMs);
 }
 
 void LimiterEffect::prepare(double sampleRate, int maxBlockSize)
@@ -225,235 +280,1457 @@ void LimiterEffect::setThreshold(float dB)
 
 void LimiterEffect::setRelease(float ms)
 {
+    releaseMs = ms;
     limiter.setRelease(ms);
 }
 
+int LimiterEffect::getParameterIndex(const juce::String& name) const
+{
+    static const char* const names[] = { "threshold", "release" };
+    return findParameterIndex(names, name);
+}
+
+void LimiterEffect::setParameter(int index, float value)
+{
+    switch (index)
+    {
+        case 0: setThreshold(value); break;
+        case 1: setRelease(value); break;
+        default: break;
+    }
+}
+
 //==============================================================================
-// AIEffect Implementation
+// FramedModelAdapter Implementation
 //==============================================================================
 
-AIEffect::AIEffect(OnnxEngine* engine, const juce::String& role)
+FramedModelAdapter::FramedModelAdapter(OnnxEngine* engine, const juce::String& role)
     : onnxEngine(engine)
     , modelRole(role)
-    , currentSampleRate(44100.0)
 {
 }
 
-void AIEffect::prepare(double sampleRate, int maxBlockSize)
+bool FramedModelAdapter::prepare(int channels, int requestedHop)
 {
-    currentSampleRate = sampleRate;
-    inputBuffer.resize(maxBlockSize * 2); // stereo
-    outputBuffer.resize(maxBlockSize * 2);
+    frameSize = 0;
+    
+    if (!onnxEngine)
+        return false;
+    
+    // Expect {batch, channels, samples} with a static sample dimension
+    const auto shape = onnxEngine->getModelInputShape(modelRole);
+    if (shape.size() != 3 || shape[2] <= 0)
+        return false;
+    
+    numChannels = juce::jmax(1, channels);
+    modelChannels = shape[1] > 0 ? static_cast<int>(shape[1]) : numChannels;
+    
+    if (modelChannels != numChannels && modelChannels != 1)
+    {
+        Logger::log(Logger::Level::Warning, "Frame adapter: unsupported channel count for " + modelRole);
+        return false;
+    }
+    
+    frameSize = static_cast<int>(shape[2]);
+    hopSize = requestedHop > 0 ? juce::jmin(requestedHop, frameSize) : juce::jmax(1, frameSize / 2);
+    
+    // Periodic Hann for overlapping frames, rectangular otherwise, scaled so
+    // the overlapping windows sum to unity gain
+    window.assign(static_cast<size_t>(frameSize), 1.0f);
+    if (hopSize < frameSize)
+    {
+        for (int n = 0; n < frameSize; ++n)
+            window[static_cast<size_t>(n)] = 0.5f - 0.5f * static_cast<float>(std::cos(TWO_PI * n / frameSize));
+    }
+    
+    double windowSum = 0.0;
+    for (float w : window)
+        windowSum += w;
+    
+    const float overlapGain = static_cast<float>(hopSize / windowSum);
+    for (auto& w : window)
+        w *= overlapGain;
+    
+    inputHistory.setSize(numChannels, frameSize);
+    frameOutput.setSize(numChannels, frameSize);
+    overlapAccumulator.setSize(numChannels, frameSize);
+    readyOutput.setSize(numChannels, hopSize);
+    
+    fallbackInput.reserve(static_cast<size_t>(modelChannels * frameSize));
+    fallbackOutput.reserve(static_cast<size_t>(modelChannels * frameSize));
+    fallbackShape = { 1, modelChannels, frameSize };
+    
+    reset();
+    
+    onnxEngine->prepareInPlaceInference(modelRole, modelChannels, frameSize);
+    
+    Logger::log(Logger::Level::Info, "Frame adapter [" + modelRole + "]: frame "
+                + juce::String(frameSize) + ", hop " + juce::String(hopSize));
+    return true;
 }
 
-void AIEffect::process(juce::AudioBuffer<float>& buffer, int numSamples)
+void FramedModelAdapter::reset()
 {
-    if (!onnxEngine || !onnxEngine->isModelReady(modelRole))
+    inputHistory.clear();
+    frameOutput.clear();
+    overlapAccumulator.clear();
+    readyOutput.clear();
+    hopFill = 0;
+}
+
+void FramedModelAdapter::process(float* const* channels, int channelCount, int numSamples)
+{
+    if (frameSize == 0)
         return;
     
-    // Convert audio buffer to flat array for ONNX
-    int numChannels = buffer.getNumChannels();
-    inputBuffer.clear();
+    const int activeChannels = juce::jmin(channelCount, numChannels);
+    int position = 0;
     
-    for (int channel = 0; channel < numChannels; ++channel)
+    while (position < numSamples)
     {
-        const float* channelData = buffer.getReadPointer(channel);
-        for (int i = 0; i < numSamples; ++i)
+        // Consume input up to the next frame boundary while draining the completed hop
+        const int count = juce::jmin(numSamples - position, hopSize - hopFill);
+        const int historyOffset = frameSize - hopSize + hopFill;
+        
+        for (int channel = 0; channel < activeChannels; ++channel)
         {
-            inputBuffer.push_back(channelData[i]);
+            float* io = channels[channel] + position;
+            inputHistory.copyFrom(channel, historyOffset, io, count);
+            juce::FloatVectorOperations::copy(io, readyOutput.getReadPointer(channel, hopFill), count);
+        }
+        
+        hopFill += count;
+        position += count;
+        
+        if (hopFill == hopSize)
+        {
+            processFrame();
+            hopFill = 0;
         }
     }
+}
+
+void FramedModelAdapter::processFrame()
+{
+    bool succeeded = true;
     
-    // Run AI inference
-    std::vector<int64_t> shape = {1, numChannels, numSamples};
-    if (onnxEngine->runInference(modelRole, inputBuffer, shape, outputBuffer))
+    if (modelChannels == numChannels)
     {
-        // Convert output back to audio buffer
-        int outputIndex = 0;
-        for (int channel = 0; channel < numChannels; ++channel)
+        succeeded = runModel(inputHistory.getArrayOfReadPointers(),
+                             frameOutput.getArrayOfWritePointers(), numChannels);
+    }
+    else
+    {
+        // Mono model: one frame per channel
+        for (int channel = 0; channel < numChannels && succeeded; ++channel)
         {
-            float* channelData = buffer.getWritePointer(channel);
-            for (int i = 0; i < numSamples; ++i)
-            {
-                if (outputIndex < (int)outputBuffer.size())
-                {
-                    channelData[i] = outputBuffer[outputIndex++];
-                }
-            }
+            const float* input = inputHistory.getReadPointer(channel);
+            float* output = frameOutput.getWritePointer(channel);
+            succeeded = runModel(&input, &output, 1);
         }
     }
+    
+    // Keep the stream continuous (and equally delayed) if the model fails
+    if (!succeeded)
+        frameOutput.makeCopyOf(inputHistory, true);
+    
+    const int overlap = frameSize - hopSize;
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        float* accumulator = overlapAccumulator.getWritePointer(channel);
+        float* history = inputHistory.getWritePointer(channel);
+        const float* output = frameOutput.getReadPointer(channel);
+        
+        for (int n = 0; n < frameSize; ++n)
+            accumulator[n] += output[n] * window[static_cast<size_t>(n)];
+        
+        // The first hop now has every overlapping frame added
+        readyOutput.copyFrom(channel, 0, accumulator, hopSize);
+        
+        std::memmove(accumulator, accumulator + hopSize, static_cast<size_t>(overlap) * sizeof(float));
+        juce::FloatVectorOperations::clear(accumulator + overlap, hopSize);
+        std::memmove(history, history + hopSize, static_cast<size_t>(overlap) * sizeof(float));
+    }
 }
 
-void AIEffect::reset()
+bool FramedModelAdapter::runModel(const float* const* input, float* const* output, int channels)
 {
-    inputBuffer.clear();
-    outputBuffer.clear();
+    if (onnxEngine->isInPlaceReady(modelRole, channels, frameSize))
+        return onnxEngine->runInferenceInPlace(modelRole, input, output, channels, frameSize);
+    
+    if (!onnxEngine->isModelReady(modelRole))
+        return false;
+    
+    fallbackInput.resize(static_cast<size_t>(channels * frameSize));
+    for (int channel = 0; channel < channels; ++channel)
+        std::copy(input[channel], input[channel] + frameSize, fallbackInput.begin() + channel * frameSize);
+    
+    fallbackShape[1] = channels;
+    if (!onnxEngine->runInference(modelRole, fallbackInput, fallbackShape, fallbackOutput)
+        || fallbackOutput.size() < fallbackInput.size())
+        return false;
+    
+    for (int channel = 0; channel < channels; ++channel)
+        std::copy(fallbackOutput.begin() + channel * frameSize,
+                  fallbackOutput.begin() + (channel + 1) * frameSize,
+                  output[channel]);
+    return true;
 }
 
 //==============================================================================
-// AIFXEngine Implementation
+// AsyncInferenceWorker Implementation
 //==============================================================================
 
-AIFXEngine::AIFXEngine(OnnxEngine* engine)
-    : onnxEngine(engine)
-    , currentSampleRate(44100.0)
-    , currentMaxBlockSize(512)
+AsyncInferenceWorker::AsyncInferenceWorker(OnnxEngine* engine, const juce::String& role)
+    : juce::Thread("MAEVN Inference: " + role)
+    , onnxEngine(engine)
+    , modelRole(role)
 {
 }
 
-AIFXEngine::~AIFXEngine()
+AsyncInferenceWorker::~AsyncInferenceWorker()
 {
+    release();
 }
 
-void AIFXEngine::prepare(double sampleRate, int maxBlockSize)
+void AsyncInferenceWorker::prepare(int channels, int newChunkSize, int latencyBlocks)
 {
-    const juce::ScopedLock sl(fxLock);
+    release();
     
-    currentSampleRate = sampleRate;
-    currentMaxBlockSize = maxBlockSize;
+    numChannels = juce::jmax(1, channels);
+    chunkSize = juce::jmax(1, newChunkSize);
+    latencySamples = chunkSize * juce::jmax(2, latencyBlocks);
     
-    for (auto& track : trackFX)
+    // Room for the latency window, one chunk in flight and one host block
+    ringSize = latencySamples + 2 * chunkSize;
+    
+    inputRing.assign(static_cast<size_t>(numChannels * ringSize), 0.0f);
+    outputRing.assign(static_cast<size_t>(numChannels * ringSize), 0.0f);
+    tensorInput.assign(static_cast<size_t>(numChannels * chunkSize), 0.0f);
+    tensorOutput.assign(static_cast<size_t>(numChannels * chunkSize), 0.0f);
+    
+    tensorInputChannels.resize(static_cast<size_t>(numChannels));
+    tensorOutputChannels.resize(static_cast<size_t>(numChannels));
+    for (int channel = 0; channel < numChannels; ++channel)
     {
-        for (auto& effect : track.dspEffects)
-        {
-            effect->prepare(sampleRate, maxBlockSize);
-        }
-        for (auto& effect : track.aiEffects)
-        {
-            effect->prepare(sampleRate, maxBlockSize);
-        }
+        tensorInputChannels[static_cast<size_t>(channel)] = tensorInput.data() + channel * chunkSize;
+        tensorOutputChannels[static_cast<size_t>(channel)] = tensorOutput.data() + channel * chunkSize;
     }
-}
-
-void AIFXEngine::reset()
-{
-    const juce::ScopedLock sl(fxLock);
     
-    for (auto& track : trackFX)
+    frameAdapter.reset();
+    if (framingEnabled)
     {
-        for (auto& effect : track.dspEffects)
-        {
-            effect->reset();
-        }
-        for (auto& effect : track.aiEffects)
-        {
-            effect->reset();
-        }
+        frameAdapter = std::make_unique<FramedModelAdapter>(onnxEngine, modelRole);
+        if (!frameAdapter->prepare(numChannels, frameHopSize))
+            frameAdapter.reset();
     }
-}
-
-void AIFXEngine::process(juce::AudioBuffer<float>& buffer, int numSamples, int trackIndex)
-{
-    if (trackIndex < 0 || trackIndex >= NUM_TRACKS)
-        return;
     
-    const juce::ScopedLock sl(fxLock);
+    if (onnxEngine && !frameAdapter)
+        onnxEngine->prepareInPlaceInference(modelRole, numChannels, chunkSize);
     
-    auto& track = trackFX[trackIndex];
+    writePosition.store(0);
+    processedStart.store(0);
+    processedEnd.store(0);
+    missedDeadlines.store(0);
     
-    switch (track.mode)
-    {
-        case FXMode::Off:
-            // No processing
-            break;
-            
-        case FXMode::DSP:
-            processDSP(buffer, numSamples, trackIndex);
-            break;
-            
-        case FXMode::AI:
-            processAI(buffer, numSamples, trackIndex);
-            break;
-            
-        case FXMode::Hybrid:
-            processHybrid(buffer, numSamples, trackIndex);
-            break;
-    }
+    startThread(juce::Thread::Priority::high);
 }
 
-void AIFXEngine::processDSP(juce::AudioBuffer<float>& buffer, int numSamples, int trackIndex)
+void AsyncInferenceWorker::setFraming(bool enabled, int hopSize)
 {
-    auto& track = trackFX[trackIndex];
-    
-    for (auto& effect : track.dspEffects)
-    {
-        effect->process(buffer, numSamples);
-    }
+    framingEnabled = enabled;
+    frameHopSize = juce::jmax(0, hopSize);
 }
 
-void AIFXEngine::processAI(juce::AudioBuffer<float>& buffer, int numSamples, int trackIndex)
+int AsyncInferenceWorker::getLatencySamples() const
 {
-    auto& track = trackFX[trackIndex];
-    
-    for (auto& effect : track.aiEffects)
-    {
-        effect->process(buffer, numSamples);
-    }
+    return latencySamples + (frameAdapter ? frameAdapter->getLatencySamples() : 0);
+}
+
+void AsyncInferenceWorker::release()
+{
+    stopThread(2000);
 }
 
-void AIFXEngine::processHybrid(juce::AudioBuffer<float>& buffer, int numSamples, int trackIndex)
+void AsyncInferenceWorker::reset()
 {
-    // First apply DSP effects
-    processDSP(buffer, numSamples, trackIndex);
+    const bool wasRunning = isThreadRunning();
+    release();
+    
+    std::fill(inputRing.begin(), inputRing.end(), 0.0f);
+    std::fill(outputRing.begin(), outputRing.end(), 0.0f);
+    writePosition.store(0);
+    processedStart.store(0);
+    processedEnd.store(0);
     
-    // Then apply AI effects
-    processAI(buffer, numSamples, trackIndex);
+    if (frameAdapter)
+        frameAdapter->reset();
+    
+    if (wasRunning)
+        startThread(juce::Thread::Priority::high);
 }
 
-void AIFXEngine::setFXMode(int trackIndex, FXMode mode)
+void AsyncInferenceWorker::process(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    if (trackIndex >= 0 && trackIndex < NUM_TRACKS)
+    if (ringSize == 0)
+        return;
+    
+    numSamples = juce::jmin(numSamples, chunkSize);
+    const int channels = juce::jmin(numChannels, buffer.getNumChannels());
+    const juce::int64 writeStart = writePosition.load(std::memory_order_relaxed);
+    
+    // Push input into the ring
+    for (int channel = 0; channel < channels; ++channel)
     {
-        const juce::ScopedLock sl(fxLock);
-        trackFX[trackIndex].mode = mode;
+        const float* source = buffer.getReadPointer(channel);
+        float* ring = inputRing.data() + channel * ringSize;
+        
+        for (int i = 0; i < numSamples; ++i)
+            ring[(writeStart + i) % ringSize] = source[i];
+    }
+    
+    // The worker polls for it within INPUT_POLL_MS
+    writePosition.store(writeStart + numSamples, std::memory_order_release);
+    
+    // Range of processed output that is complete (read end first, see run())
+    const juce::int64 readStart = writeStart - latencySamples;
+    const juce::int64 readEnd = readStart + numSamples;
+    const juce::int64 doneEnd = processedEnd.load(std::memory_order_acquire);
+    const juce::int64 doneStart = processedStart.load(std::memory_order_acquire);
+    
+    const juce::int64 wetStart = juce::jlimit(readStart, readEnd, doneStart);
+    const juce::int64 wetEnd = juce::jlimit(wetStart, readEnd, doneEnd);
+    
+    if (readStart >= 0 && (wetStart > readStart || wetEnd < readEnd))
+        missedDeadlines.fetch_add(1, std::memory_order_relaxed);
+    
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        float* dest = buffer.getWritePointer(channel);
+        const float* dry = inputRing.data() + channel * ringSize;
+        const float* wet = outputRing.data() + channel * ringSize;
+        
+        for (juce::int64 pos = readStart; pos < readEnd; ++pos)
+        {
+            const float* source = (pos >= wetStart && pos < wetEnd) ? wet : dry;
+            dest[pos - readStart] = pos < 0 ? 0.0f : source[pos % ringSize];
+        }
     }
 }
 
-FXMode AIFXEngine::getFXMode(int trackIndex) const
+void AsyncInferenceWorker::run()
 {
-    if (trackIndex >= 0 && trackIndex < NUM_TRACKS)
+    juce::int64 nextPosition = processedEnd.load();
+    const std::vector<int64_t> shape = { 1, numChannels, chunkSize };
+    
+    while (!threadShouldExit())
     {
-        return trackFX[trackIndex].mode;
+        const juce::int64 available = writePosition.load(std::memory_order_acquire);
+        
+        if (available - nextPosition < chunkSize)
+        {
+            wait(INPUT_POLL_MS);
+            continue;
+        }
+        
+        // Fell behind: skip to the newest chunk. The start marker is published
+        // before the end marker so the audio thread never treats skipped
+        // positions as processed.
+        if (nextPosition + chunkSize <= available - latencySamples)
+        {
+            nextPosition = available - chunkSize;
+            processedStart.store(nextPosition, std::memory_order_release);
+        }
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* ring = inputRing.data() + channel * ringSize;
+            float* dest = tensorInput.data() + channel * chunkSize;
+            
+            for (int i = 0; i < chunkSize; ++i)
+                dest[i] = ring[(nextPosition + i) % ringSize];
+        }
+        
+        // Input was overwritten while copying; the next pass will skip ahead
+        if (nextPosition < writePosition.load(std::memory_order_acquire) + chunkSize - ringSize)
+            continue;
+        
+        bool succeeded = false;
+        const std::vector<float>* result = &tensorOutput;
+        
+        if (frameAdapter)
+        {
+            // Fixed-frame model: the adapter handles framing and dry fallback
+            std::copy(tensorInput.begin(), tensorInput.end(), tensorOutput.begin());
+            frameAdapter->process(tensorOutputChannels.data(), numChannels, chunkSize);
+            succeeded = true;
+        }
+        else if (onnxEngine != nullptr && onnxEngine->isModelReady(modelRole))
+        {
+            if (onnxEngine->isInPlaceReady(modelRole, numChannels, chunkSize))
+                succeeded = onnxEngine->runInferenceInPlace(modelRole, tensorInputChannels.data(),
+                                                            tensorOutputChannels.data(),
+                                                            numChannels, chunkSize);
+            else
+            {
+                // Separate vector: runInference() may reallocate its output
+                succeeded = onnxEngine->runInference(modelRole, tensorInput, shape, tensorFallbackOutput);
+                result = &tensorFallbackOutput;
+            }
+        }
+        
+        // Write model output, falling back to dry input for missing samples
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* ring = outputRing.data() + channel * ringSize;
+            
+            for (int i = 0; i < chunkSize; ++i)
+            {
+                const size_t index = static_cast<size_t>(channel * chunkSize + i);
+                const bool hasOutput = succeeded && index < result->size();
+                ring[(nextPosition + i) % ringSize] = hasOutput ? (*result)[index] : tensorInput[index];
+            }
+        }
+        
+        nextPosition += chunkSize;
+        processedEnd.store(nextPosition, std::memory_order_release);
     }
-    return FXMode::Off;
 }
 
-void AIFXEngine::addDSPEffect(int trackIndex, std::unique_ptr<Effect> effect)
+//==============================================================================
+// AIEffect Implementation
+//==============================================================================
+
+AIEffect::AIEffect(OnnxEngine* engine, const juce::String& role)
+    : onnxEngine(engine)
+    , modelRole(role)
+    , currentSampleRate(44100.0)
 {
-    if (trackIndex >= 0 && trackIndex < NUM_TRACKS)
-    {
-        const juce::ScopedLock sl(fxLock);
-        effect->prepare(currentSampleRate, currentMaxBlockSize);
-        trackFX[trackIndex].dspEffects.push_back(std::move(effect));
-    }
 }
 
-void AIFXEngine::addAIEffect(int trackIndex, const juce::String& modelRole)
+AIEffect::~AIEffect()
 {
-    if (trackIndex >= 0 && trackIndex < NUM_TRACKS && onnxEngine)
-    {
-        const juce::ScopedLock sl(fxLock);
-        auto effect = std::make_unique<AIEffect>(onnxEngine, modelRole);
-        effect->prepare(currentSampleRate, currentMaxBlockSize);
-        trackFX[trackIndex].aiEffects.push_back(std::move(effect));
-    }
+    asyncWorker.reset();
 }
 
-void AIFXEngine::clearEffects(int trackIndex)
+void AIEffect::prepare(double sampleRate, int maxBlockSize)
 {
-    if (trackIndex >= 0 && trackIndex < NUM_TRACKS)
+    // Starts a lazy load here rather than from the audio thread
+    if (onnxEngine && !onnxEngine->isModelReady(modelRole)
+        && getModelLoadState() == ModelLoadState::Missing)
     {
-        const juce::ScopedLock sl(fxLock);
-        trackFX[trackIndex].dspEffects.clear();
-        trackFX[trackIndex].aiEffects.clear();
+        Logger::log(Logger::Level::Warning, "No model registered for AI effect: " + modelRole);
     }
-}
+    
+    currentSampleRate = sampleRate;
+    preparedBlockSize = maxBlockSize;
+    fallbackShape = { 1, PREPARED_CHANNELS, maxBlockSize };
+    inputBuffer.assign(static_cast<size_t>(PREPARED_CHANNELS * maxBlockSize), 0.0f);
+    outputBuffer.assign(static_cast<size_t>(PREPARED_CHANNELS * maxBlockSize), 0.0f);
+    
+    if (asyncEnabled)
+    {
+        if (!asyncWorker)
+            asyncWorker = std::make_unique<AsyncInferenceWorker>(onnxEngine, modelRole);
+        
+        frameAdapter.reset();
+        asyncWorker->setFraming(true, frameHopSize);
+        asyncWorker->prepare(2, maxBlockSize, asyncLatencyBlocks);
+    }
+    else
+    {
+        asyncWorker.reset();
+        
+        // Models with a static frame size are fed through the overlap-add adapter
+        frameAdapter = std::make_unique<FramedModelAdapter>(onnxEngine, modelRole);
+        if (!frameAdapter->prepare(2, frameHopSize))
+        {
+            frameAdapter.reset();
+            
+            // Pre-bind tensors so process() runs without heap traffic
+            if (onnxEngine)
+                onnxEngine->prepareInPlaceInference(modelRole, 2, maxBlockSize);
+        }
+    }
+}
+
+void AIEffect::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    if (asyncWorker)
+    {
+        asyncWorker->process(buffer, numSamples);
+        return;
+    }
+    
+    if (frameAdapter)
+    {
+        frameAdapter->process(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples);
+        return;
+    }
+    
+    if (!onnxEngine || !onnxEngine->isModelReady(modelRole))
+        return;
+    
+    int numChannels = buffer.getNumChannels();
+    
+    // Zero-copy path: model reads and writes planar audio through pre-bound tensors
+    if (onnxEngine->isInPlaceReady(modelRole, numChannels, numSamples))
+    {
+        onnxEngine->runInferenceInPlace(modelRole,
+                                        buffer.getArrayOfReadPointers(),
+                                        buffer.getArrayOfWritePointers(),
+                                        numChannels, numSamples);
+        return;
+    }
+    
+    if (fallbackShape.empty())
+        return;
+    
+    // Convert audio buffer to flat array for ONNX; never grows past what
+    // prepare() sized, extra channels pass through
+    numChannels = juce::jmin(numChannels, PREPARED_CHANNELS);
+    numSamples = juce::jmin(numSamples, preparedBlockSize);
+    inputBuffer.resize(static_cast<size_t>(numChannels * numSamples));
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const float* channelData = buffer.getReadPointer(channel);
+        std::copy(channelData, channelData + numSamples, inputBuffer.begin() + channel * numSamples);
+    }
+    
+    // Run AI inference
+    fallbackShape[1] = numChannels;
+    fallbackShape[2] = numSamples;
+    if (onnxEngine->runInference(modelRole, inputBuffer, fallbackShape, outputBuffer))
+    {
+        // Convert output back to audio buffer
+        int outputIndex = 0;
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* channelData = buffer.getWritePointer(channel);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                if (outputIndex < (int)outputBuffer.size())
+                {
+                    channelData[i] = outputBuffer[outputIndex++];
+                }
+            }
+        }
+    }
+}
+
+void AIEffect::reset()
+{
+    std::fill(inputBuffer.begin(), inputBuffer.end(), 0.0f);
+    std::fill(outputBuffer.begin(), outputBuffer.end(), 0.0f);
+    
+    if (asyncWorker)
+        asyncWorker->reset();
+    
+    if (frameAdapter)
+        frameAdapter->reset();
+}
+
+int AIEffect::getLatencySamples() const
+{
+    if (asyncWorker)
+        return asyncWorker->getLatencySamples();
+    
+    return frameAdapter ? frameAdapter->getLatencySamples() : 0;
+}
+
+ModelLoadState AIEffect::getModelLoadState() const
+{
+    return onnxEngine ? onnxEngine->getModelLoadState(modelRole) : ModelLoadState::Missing;
+}
+
+void AIEffect::setAsyncMode(bool enabled, int latencyBlocks)
+{
+    asyncEnabled = enabled;
+    asyncLatencyBlocks = juce::jmax(2, latencyBlocks);
+}
+
+//==============================================================================
+// AIFXEngine Implementation
+//==============================================================================
+
+AIFXEngine::AIFXEngine(OnnxEngine* engine)
+    : onnxEngine(engine)
+    , currentSampleRate(44100.0)
+    , currentMaxBlockSize(512)
+{
+    aiMix.fill(1.0f);
+    
+    const juce::ScopedLock sl(editLock);
+    publishChain();
+}
+
+AIFXEngine::~AIFXEngine()
+{
+    const juce::ScopedLock sl(editLock);
+    
+    collectRetiredChains();
+    delete pendingChain.exchange(nullptr);
+    delete activeChain;
+    activeChain = nullptr;
+}
+
+void AIFXEngine::prepare(double sampleRate, int maxBlockSize)
+{
+    const juce::ScopedLock sl(editLock);
+    
+    currentSampleRate = sampleRate;
+    currentMaxBlockSize = maxBlockSize;
+    
+    // The audio thread is stopped, so live effects may be prepared in place
+    for (auto& track : trackFX)
+    {
+        for (auto& effect : track.dspEffects)
+        {
+            effect->prepare(sampleRate, maxBlockSize);
+        }
+        for (auto& effect : track.aiEffects)
+        {
+            effect->prepare(sampleRate, maxBlockSize);
+        }
+    }
+    
+    for (auto& gate : trackGates)
+        gate.prepare(sampleRate);
+    
+    juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(maxBlockSize), 2 };
+    for (size_t trackIndex = 0; trackIndex < NUM_TRACKS; ++trackIndex)
+    {
+        fallbackBuffers[trackIndex].setSize(2, maxBlockSize);
+        fallbackDelays[trackIndex].setMaximumDelayInSamples(MAX_FALLBACK_DELAY);
+        fallbackDelays[trackIndex].prepare(spec);
+    }
+    
+    batchInputs.assign(NUM_TRACKS * BATCH_SCRATCH_PER_JOB, nullptr);
+    batchOutputs.assign(NUM_TRACKS * BATCH_SCRATCH_PER_JOB, nullptr);
+    prepareBatching();
+    
+    // Latencies may have changed with the block size
+    publishChain();
+}
+
+void AIFXEngine::reset()
+{
+    const juce::ScopedLock sl(editLock);
+    
+    for (auto& track : trackFX)
+    {
+        for (auto& effect : track.dspEffects)
+        {
+            effect->reset();
+        }
+        for (auto& effect : track.aiEffects)
+        {
+            effect->reset();
+        }
+    }
+    
+    for (auto& gate : trackGates)
+        gate.reset();
+    
+    for (auto& delay : fallbackDelays)
+        delay.reset();
+    
+    aiMix.fill(aiFallback.load(std::memory_order_relaxed) ? 0.0f : 1.0f);
+    aiWarmupSamples.fill(0);
+    aiSuspended.fill(false);
+    
+    collectRetiredChains();
+}
+
+void AIFXEngine::process(juce::AudioBuffer<float>& buffer, int numSamples, int trackIndex)
+{
+    if (trackIndex < 0 || trackIndex >= NUM_TRACKS)
+        return;
+    
+    const auto* chain = acquireChain();
+    if (chain == nullptr)
+        return;
+    
+    const auto& track = chain->tracks[trackIndex];
+    if (!shouldProcessTrack(*chain, trackIndex, buffer, numSamples))
+        return;
+    
+    switch (track.mode)
+    {
+        case FXMode::Off:
+            // No processing
+            break;
+            
+        case FXMode::DSP:
+            processEffects(track.dspEffects, buffer, numSamples);
+            break;
+            
+        case FXMode::AI:
+            processEffects(track.aiEffects, buffer, numSamples);
+            break;
+            
+        case FXMode::Hybrid:
+            // DSP first, then AI
+            processEffects(track.dspEffects, buffer, numSamples);
+            processEffects(track.aiEffects, buffer, numSamples);
+            break;
+    }
+}
+
+void AIFXEngine::processTracks(juce::AudioBuffer<float>* const* trackBuffers, int numTracks, int numSamples,
+                               RealtimeWorkerPool* workers)
+{
+    const auto* chain = acquireChain();
+    if (chain == nullptr)
+        return;
+    
+    numTracks = juce::jmin(numTracks, NUM_TRACKS);
+    size_t numStages = 0;
+    
+    // Tracks bypassed for silence are left out of every phase
+    std::array<juce::AudioBuffer<float>*, NUM_TRACKS> activeBuffers {};
+    for (int trackIndex = 0; trackIndex < numTracks; ++trackIndex)
+    {
+        auto* buffer = trackBuffers[trackIndex];
+        if (buffer != nullptr && shouldProcessTrack(*chain, trackIndex, *buffer, numSamples))
+            activeBuffers[trackIndex] = buffer;
+    }
+    trackBuffers = activeBuffers.data();
+    
+    TrackJobs jobs;
+    jobs.engine = this;
+    jobs.chain = chain;
+    jobs.trackBuffers = trackBuffers;
+    jobs.numSamples = numSamples;
+    
+    // DSP runs first in both DSP and Hybrid mode
+    for (int trackIndex = 0; trackIndex < numTracks; ++trackIndex)
+    {
+        const auto& track = chain->tracks[trackIndex];
+        if (trackBuffers[trackIndex] == nullptr || track.mode == FXMode::Off)
+            continue;
+        
+        if (track.mode == FXMode::DSP || track.mode == FXMode::Hybrid)
+        {
+            jobs.jobTracks[jobs.numJobs][0] = trackIndex;
+            jobs.jobSizes[jobs.numJobs++] = 1;
+        }
+        
+        if (track.mode == FXMode::AI || track.mode == FXMode::Hybrid)
+            numStages = std::max(numStages, track.aiEffects.size());
+    }
+    
+    runJobs(workers, jobs, &AIFXEngine::runDSPJob);
+    
+    const bool fallBack = aiFallback.load(std::memory_order_relaxed);
+    prepareAIFallback(*chain, trackBuffers, numTracks, numSamples, fallBack);
+    
+    for (size_t stage = 0; stage < numStages; ++stage)
+        processAIStage(*chain, trackBuffers, numTracks, numSamples, stage, workers);
+    
+    applyAIFallback(*chain, trackBuffers, numTracks, numSamples, fallBack);
+}
+
+void AIFXEngine::prepareAIFallback(const FXChain& chain, juce::AudioBuffer<float>* const* trackBuffers,
+                                   int numTracks, int numSamples, bool fallBack)
+{
+    for (int trackIndex = 0; trackIndex < numTracks; ++trackIndex)
+    {
+        const auto index = static_cast<size_t>(trackIndex);
+        const auto& track = chain.tracks[index];
+        auto* buffer = trackBuffers[trackIndex];
+        
+        // Gated tracks keep their state for when they come back
+        if (buffer == nullptr)
+            continue;
+        
+        if ((track.mode != FXMode::AI && track.mode != FXMode::Hybrid) || track.aiEffects.empty())
+        {
+            aiMix[index] = 1.0f;
+            aiWarmupSamples[index] = 0;
+            aiSuspended[index] = false;
+            continue;
+        }
+        
+        // Fed every block, so a switch never plays out a stale delay
+        auto& fallback = fallbackBuffers[index];
+        for (int ch = 0; ch < fallback.getNumChannels(); ++ch)
+            fallback.copyFrom(ch, 0, *buffer, juce::jmin(ch, buffer->getNumChannels() - 1), 0, numSamples);
+        
+        auto& delay = fallbackDelays[index];
+        delay.setDelay(static_cast<float>(juce::jmin(chain.aiLatencies[index], MAX_FALLBACK_DELAY)));
+        
+        juce::dsp::AudioBlock<float> block(fallback);
+        auto subBlock = block.getSubBlock(0, static_cast<size_t>(numSamples));
+        delay.process(juce::dsp::ProcessContextReplacing<float>(subBlock));
+        
+        // Skip the AI effects once they are faded out; on resuming, their
+        // output is stale until it has made it through their latency
+        const bool wasSuspended = aiSuspended[index];
+        aiSuspended[index] = fallBack && aiMix[index] <= 0.0f;
+        
+        if (fallBack)
+            aiWarmupSamples[index] = 0;
+        else if (wasSuspended)
+            aiWarmupSamples[index] = chain.aiLatencies[index];
+    }
+}
+
+void AIFXEngine::applyAIFallback(const FXChain& chain, juce::AudioBuffer<float>* const* trackBuffers,
+                                 int numTracks, int numSamples, bool fallBack)
+{
+    const float target = fallBack ? 0.0f : 1.0f;
+    const float step = static_cast<float>(numSamples / (AI_FALLBACK_FADE_SECONDS * currentSampleRate));
+    
+    for (int trackIndex = 0; trackIndex < numTracks; ++trackIndex)
+    {
+        const auto index = static_cast<size_t>(trackIndex);
+        const auto& track = chain.tracks[index];
+        auto* buffer = trackBuffers[trackIndex];
+        
+        if (buffer == nullptr || (track.mode != FXMode::AI && track.mode != FXMode::Hybrid)
+            || track.aiEffects.empty())
+            continue;
+        
+        const auto& fallback = fallbackBuffers[index];
+        const int numChannels = juce::jmin(buffer->getNumChannels(), fallback.getNumChannels());
+        
+        if (aiSuspended[index] || aiWarmupSamples[index] > 0)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer->copyFrom(ch, 0, fallback, ch, 0, numSamples);
+            
+            aiWarmupSamples[index] = juce::jmax(0, aiWarmupSamples[index] - numSamples);
+            continue;
+        }
+        
+        const float startMix = aiMix[index];
+        if (startMix == target)
+            continue;
+        
+        const float endMix = target > startMix ? juce::jmin(target, startMix + step)
+                                               : juce::jmax(target, startMix - step);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            buffer->applyGainRamp(ch, 0, numSamples, startMix, endMix);
+            buffer->addFromWithRamp(ch, 0, fallback.getReadPointer(ch), numSamples, 1.0f - startMix, 1.0f - endMix);
+        }
+        
+        aiMix[index] = endMix;
+    }
+}
+
+void AIFXEngine::processAIStage(const FXChain& chain, juce::AudioBuffer<float>* const* trackBuffers,
+                                int numTracks, int numSamples, size_t stage, RealtimeWorkerPool* workers)
+{
+    TrackJobs jobs;
+    jobs.engine = this;
+    jobs.chain = &chain;
+    jobs.trackBuffers = trackBuffers;
+    jobs.numSamples = numSamples;
+    jobs.stage = stage;
+    
+    std::array<const AIEffect*, NUM_TRACKS> jobEffects {};
+    
+    for (int trackIndex = 0; trackIndex < numTracks; ++trackIndex)
+    {
+        const auto& track = chain.tracks[trackIndex];
+        const bool runsAI = (track.mode == FXMode::AI || track.mode == FXMode::Hybrid)
+                            && !aiSuspended[static_cast<size_t>(trackIndex)];
+        
+        if (trackBuffers[trackIndex] == nullptr || !runsAI || stage >= track.aiEffects.size())
+            continue;
+        
+        // Tracks whose effect at this stage runs the same role share a job
+        const auto* effect = dynamic_cast<const AIEffect*>(track.aiEffects[stage].get());
+        int job = 0;
+        while (job < jobs.numJobs
+               && (effect == nullptr || jobEffects[job] == nullptr
+                   || jobEffects[job]->getModelRole() != effect->getModelRole()))
+            ++job;
+        
+        if (job == jobs.numJobs)
+        {
+            jobEffects[job] = effect;
+            jobs.jobSizes[job] = 0;
+            ++jobs.numJobs;
+        }
+        
+        jobs.jobTracks[job][jobs.jobSizes[job]++] = trackIndex;
+    }
+    
+    runJobs(workers, jobs, &AIFXEngine::runAIJob);
+}
+
+void AIFXEngine::processAIJob(const TrackJobs& jobs, int jobIndex)
+{
+    const auto& tracks = jobs.jobTracks[jobIndex];
+    const int numTracks = jobs.jobSizes[jobIndex];
+    
+    std::array<int, NUM_TRACKS> batch {};
+    std::array<bool, NUM_TRACKS> batchable {};
+    std::array<bool, NUM_TRACKS> done {};
+    int batchSize = 0;
+    AIEffect* batchEffect = nullptr;
+    
+    for (int i = 0; i < numTracks; ++i)
+    {
+        auto* effect = dynamic_cast<AIEffect*>(jobs.chain->tracks[tracks[i]].aiEffects[jobs.stage].get());
+        if (effect != nullptr && effect->canBatch())
+        {
+            batch[batchSize++] = tracks[i];
+            batchable[i] = true;
+            batchEffect = effect;
+        }
+    }
+    
+    if (batchSize > 1)
+    {
+        const RealtimeProfiler::ScopedTimer timer(profiler, batchProfileStage);
+        if (runBatch(batchEffect->getModelRole(), batch.data(), batchSize, jobs.trackBuffers,
+                     jobs.numSamples, static_cast<size_t>(jobIndex) * BATCH_SCRATCH_PER_JOB))
+            done = batchable;
+    }
+    
+    // Everything not batched runs on its own, in track order
+    for (int i = 0; i < numTracks; ++i)
+    {
+        if (done[i])
+            continue;
+        
+        const RealtimeProfiler::ScopedTimer timer(profiler, aiProfileStages[static_cast<size_t>(tracks[i])]);
+        jobs.chain->tracks[tracks[i]].aiEffects[jobs.stage]->process(*jobs.trackBuffers[tracks[i]], jobs.numSamples);
+    }
+}
+
+void AIFXEngine::runDSPJob(void* context, int jobIndex)
+{
+    auto& jobs = *static_cast<TrackJobs*>(context);
+    const int trackIndex = jobs.jobTracks[jobIndex][0];
+    const RealtimeProfiler::ScopedTimer timer(jobs.engine->profiler,
+                                              jobs.engine->dspProfileStages[static_cast<size_t>(trackIndex)]);
+    processEffects(jobs.chain->tracks[trackIndex].dspEffects, *jobs.trackBuffers[trackIndex], jobs.numSamples);
+}
+
+void AIFXEngine::runAIJob(void* context, int jobIndex)
+{
+    auto& jobs = *static_cast<TrackJobs*>(context);
+    jobs.engine->processAIJob(jobs, jobIndex);
+}
+
+void AIFXEngine::runJobs(RealtimeWorkerPool* workers, TrackJobs& jobs, RealtimeWorkerPool::JobFunction function)
+{
+    if (workers != nullptr)
+    {
+        workers->run(jobs.numJobs, function, &jobs);
+        return;
+    }
+    
+    for (int job = 0; job < jobs.numJobs; ++job)
+        function(&jobs, job);
+}
+
+bool AIFXEngine::runBatch(const juce::String& modelRole, const int* tracks, int batchSize,
+                          juce::AudioBuffer<float>* const* trackBuffers, int numSamples,
+                          size_t scratchOffset)
+{
+    const int numChannels = trackBuffers[tracks[0]]->getNumChannels();
+    if (numChannels <= 0 || numChannels > MAX_BATCH_CHANNELS
+        || scratchOffset + static_cast<size_t>(batchSize * numChannels) > batchInputs.size())
+        return false;
+    
+    for (int i = 0; i < batchSize; ++i)
+    {
+        if (trackBuffers[tracks[i]]->getNumChannels() != numChannels)
+            return false;
+    }
+    
+    if (!onnxEngine->isBatchReady(modelRole, batchSize, numChannels, numSamples))
+        return false;
+    
+    auto* inputs = batchInputs.data() + scratchOffset;
+    auto* outputs = batchOutputs.data() + scratchOffset;
+    
+    for (int i = 0; i < batchSize; ++i)
+    {
+        auto* buffer = trackBuffers[tracks[i]];
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto index = static_cast<size_t>(i * numChannels + channel);
+            inputs[index] = buffer->getReadPointer(channel);
+            outputs[index] = buffer->getWritePointer(channel);
+        }
+    }
+    
+    // On failure the blocks are left dry, as in the unbatched path
+    onnxEngine->runInferenceBatch(modelRole, inputs, outputs, batchSize, numChannels, numSamples);
+    return true;
+}
+
+void AIFXEngine::prepareBatching()
+{
+    if (onnxEngine == nullptr)
+        return;
+    
+    // Count batchable effects per role; any subset of them may share a stage
+    std::unordered_map<juce::String, int> effectsPerRole;
+    for (const auto& track : trackFX)
+    {
+        for (const auto& effect : track.aiEffects)
+        {
+            if (auto* aiEffect = dynamic_cast<AIEffect*>(effect.get()))
+            {
+                if (aiEffect->canBatch())
+                    effectsPerRole[aiEffect->getModelRole()]++;
+            }
+        }
+    }
+    
+    for (const auto& pair : effectsPerRole)
+    {
+        const int maxBatch = juce::jmin(pair.second, NUM_TRACKS);
+        for (int batchSize = 2; batchSize <= maxBatch; ++batchSize)
+            onnxEngine->prepareBatchInference(pair.first, batchSize, MAX_BATCH_CHANNELS, currentMaxBlockSize);
+    }
+}
+
+void AIFXEngine::processEffects(const std::vector<std::shared_ptr<Effect>>& effects,
+                                juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    for (const auto& effect : effects)
+    {
+        effect->process(buffer, numSamples);
+    }
+}
+
+//==============================================================================
+void AIFXEngine::publishChain()
+{
+    collectRetiredChains();
+    
+    auto chain = std::make_unique<FXChain>();
+    chain->tracks = trackFX;
+    chain->version = ++chainVersion;
+    
+    for (int trackIndex = 0; trackIndex < NUM_TRACKS; ++trackIndex)
+    {
+        chain->trackLatencies[trackIndex] = computeTrackLatency(trackFX[trackIndex]);
+        chain->aiLatencies[trackIndex] = computeAILatency(trackFX[trackIndex]);
+        chain->latencySamples = juce::jmax(chain->latencySamples, chain->trackLatencies[trackIndex]);
+    }
+    
+    // A chain still pending was never seen by the audio thread
+    delete pendingChain.exchange(chain.release(), std::memory_order_acq_rel);
+}
+
+void AIFXEngine::collectRetiredChains()
+{
+    const auto scope = retireFifo.read(retireFifo.getNumReady());
+    scope.forEach([this](int index)
+    {
+        delete retireQueue[static_cast<size_t>(index)];
+        retireQueue[static_cast<size_t>(index)] = nullptr;
+    });
+}
+
+const AIFXEngine::FXChain* AIFXEngine::acquireChain()
+{
+    // Only swap when the old chain can be handed back; otherwise keep it a block longer
+    if (pendingChain.load(std::memory_order_relaxed) != nullptr
+        && (activeChain == nullptr || retireFifo.getFreeSpace() > 0))
+    {
+        if (auto* chain = pendingChain.exchange(nullptr, std::memory_order_acq_rel))
+        {
+            if (activeChain != nullptr)
+            {
+                const auto scope = retireFifo.write(1);
+                scope.forEach([this](int index) { retireQueue[static_cast<size_t>(index)] = activeChain; });
+            }
+            activeChain = chain;
+        }
+    }
+    
+    applyParameterCommands();
+    return activeChain;
+}
+
+void AIFXEngine::applyParameterCommands()
+{
+    if (activeChain == nullptr)
+        return;
+    
+    for (int remaining = commandFifo.getNumReady(); remaining > 0; --remaining)
+    {
+        int start1, size1, start2, size2;
+        commandFifo.prepareToRead(1, start1, size1, start2, size2);
+        const auto& command = commandQueue[static_cast<size_t>(start1)];
+        
+        // Commands for effects this chain doesn't know yet wait for their chain
+        if (command.chainVersion > activeChain->version)
+            return;
+        
+        // Only touch effects the active chain holds; removed ones may be gone
+        for (const auto& track : activeChain->tracks)
+        {
+            for (const auto* effects : { &track.dspEffects, &track.aiEffects })
+            {
+                for (const auto& effect : *effects)
+                {
+                    if (effect.get() == command.effect && effect->getEffectId() == command.effectId)
+                        effect->setParameter(command.parameterIndex, command.value);
+                }
+            }
+        }
+        
+        commandFifo.finishedRead(1);
+    }
+}
+
+int AIFXEngine::computeTrackLatency(const TrackFX& track)
+{
+    int latency = 0;
+    
+    if (track.mode == FXMode::DSP || track.mode == FXMode::Hybrid)
+    {
+        for (const auto& effect : track.dspEffects)
+            latency += effect->getLatencySamples();
+    }
+    
+    if (track.mode == FXMode::AI || track.mode == FXMode::Hybrid)
+        latency += computeAILatency(track);
+    
+    return latency;
+}
+
+int AIFXEngine::computeAILatency(const TrackFX& track)
+{
+    int latency = 0;
+    
+    for (const auto& effect : track.aiEffects)
+        latency += effect->getLatencySamples();
+    
+    return latency;
+}
+
+double AIFXEngine::computeTrackTail(const TrackFX& track)
+{
+    double tail = 0.0;
+    
+    if (track.mode == FXMode::DSP || track.mode == FXMode::Hybrid)
+    {
+        for (const auto& effect : track.dspEffects)
+            tail += effect->getTailLengthSeconds();
+    }
+    
+    if (track.mode == FXMode::AI || track.mode == FXMode::Hybrid)
+    {
+        for (const auto& effect : track.aiEffects)
+            tail += effect->getTailLengthSeconds();
+    }
+    
+    return tail;
+}
+
+bool AIFXEngine::shouldProcessTrack(const FXChain& chain, int trackIndex,
+                                    const juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const auto& track = chain.tracks[trackIndex];
+    if (track.mode == FXMode::Off)
+    {
+        // Nothing rings on a bypassed track
+        trackGates[trackIndex].reset();
+        return true;
+    }
+    
+    // Tails are only looked up while the input is silent
+    const bool silent = SilenceGate::isSilent(buffer, numSamples);
+    const double tailSeconds = silent ? computeTrackTail(track)
+                                        + chain.trackLatencies[trackIndex] / currentSampleRate
+                                      : 0.0;
+    
+    return trackGates[trackIndex].shouldProcess(silent, numSamples, tailSeconds);
+}
+
+std::unique_ptr<AIEffect> AIFXEngine::createAIEffect(const juce::String& modelRole,
+                                                     double sampleRate, int maxBlockSize) const
+{
+    bool asyncEnabled;
+    int latencyBlocks, hopSize;
+    {
+        const juce::ScopedLock sl(editLock);
+        asyncEnabled = asyncInferenceEnabled;
+        latencyBlocks = asyncLatencyBlocks;
+        hopSize = frameHopSize;
+    }
+    
+    auto effect = std::make_unique<AIEffect>(onnxEngine, modelRole);
+    effect->setAsyncMode(asyncEnabled, latencyBlocks);
+    effect->setFrameHop(hopSize);
+    effect->prepare(sampleRate, maxBlockSize);
+    return effect;
+}
+
+//==============================================================================
+void AIFXEngine::setFXMode(int trackIndex, FXMode mode)
+{
+    if (trackIndex >= 0 && trackIndex < NUM_TRACKS)
+    {
+        const juce::ScopedLock sl(editLock);
+        trackFX[trackIndex].mode = mode;
+        publishChain();
+    }
+}
+
+FXMode AIFXEngine::getFXMode(int trackIndex) const
+{
+    if (trackIndex >= 0 && trackIndex < NUM_TRACKS)
+    {
+        const juce::ScopedLock sl(editLock);
+        return trackFX[trackIndex].mode;
+    }
+    return FXMode::Off;
+}
+
+void AIFXEngine::addDSPEffect(int trackIndex, std::unique_ptr<Effect> effect)
+{
+    if (trackIndex >= 0 && trackIndex < NUM_TRACKS && effect != nullptr)
+    {
+        double sampleRate;
+        int maxBlockSize;
+        {
+            const juce::ScopedLock sl(editLock);
+            sampleRate = currentSampleRate;
+            maxBlockSize = currentMaxBlockSize;
+        }
+        
+        // Prepared before any chain holds it, so no lock is held meanwhile
+        effect->prepare(sampleRate, maxBlockSize);
+        
+        const juce::ScopedLock sl(editLock);
+        trackFX[trackIndex].dspEffects.push_back(std::move(effect));
+        publishChain();
+    }
+}
+
+void AIFXEngine::addAIEffect(int trackIndex, const juce::String& modelRole)
+{
+    if (trackIndex >= 0 && trackIndex < NUM_TRACKS && onnxEngine)
+    {
+        double sampleRate;
+        int maxBlockSize;
+        {
+            const juce::ScopedLock sl(editLock);
+            sampleRate = currentSampleRate;
+            maxBlockSize = currentMaxBlockSize;
+        }
+        
+        std::shared_ptr<Effect> effect = createAIEffect(modelRole, sampleRate, maxBlockSize);
+        
+        const juce::ScopedLock sl(editLock);
+        trackFX[trackIndex].aiEffects.push_back(std::move(effect));
+        prepareBatching();
+        publishChain();
+    }
+}
+
+void AIFXEngine::clearEffects(int trackIndex)
+{
+    if (trackIndex >= 0 && trackIndex < NUM_TRACKS)
+    {
+        // Effects are freed once the audio thread hands back the last chain using them
+        const juce::ScopedLock sl(editLock);
+        trackFX[trackIndex].dspEffects.clear();
+        trackFX[trackIndex].aiEffects.clear();
+        publishChain();
+    }
+}
 
 void AIFXEngine::setEffectParameter(int trackIndex, int effectIndex, 
                                      const juce::String& paramName, float value)
 {
-    // Parameter setting would be implemented here
-    // This is a placeholder for future parameter automation
+    if (trackIndex < 0 || trackIndex >= NUM_TRACKS || effectIndex < 0)
+        return;
+    
+    const juce::ScopedLock sl(editLock);
+    
+    const auto& track = trackFX[trackIndex];
+    const auto numDSP = static_cast<int>(track.dspEffects.size());
+    const auto numEffects = numDSP + static_cast<int>(track.aiEffects.size());
+    if (effectIndex >= numEffects)
+        return;
+    
+    auto* effect = effectIndex < numDSP ? track.dspEffects[static_cast<size_t>(effectIndex)].get()
+                                        : track.aiEffects[static_cast<size_t>(effectIndex - numDSP)].get();
+    
+    const int parameterIndex = effect->getParameterIndex(paramName);
+    if (parameterIndex < 0)
+    {
+        Logger::log(Logger::Level::Warning, effect->getName() + " has no parameter " + paramName);
+        return;
+    }
+    
+    if (commandFifo.getFreeSpace() == 0)
+    {
+        Logger::log(Logger::Level::Warning, "FX parameter queue full, dropping " + paramName);
+        return;
+    }
+    
+    const auto scope = commandFifo.write(1);
+    scope.forEach([&](int index)
+    {
+        commandQueue[static_cast<size_t>(index)] = { effect, effect->getEffectId(), chainVersion,
+                                                     parameterIndex, value };
+    });
+}
+
+void AIFXEngine::setAsyncInferenceEnabled(bool enabled, int latencyBlocks)
+{
+    const juce::ScopedLock sl(editLock);
+    
+    asyncInferenceEnabled = enabled;
+    asyncLatencyBlocks = juce::jmax(2, latencyBlocks);
+    
+    // Only read by prepare(), so live effects can take the new setting now
+    for (auto& track : trackFX)
+    {
+        for (auto& effect : track.aiEffects)
+        {
+            if (auto* aiEffect = dynamic_cast<AIEffect*>(effect.get()))
+                aiEffect->setAsyncMode(asyncInferenceEnabled, asyncLatencyBlocks);
+        }
+    }
+}
+
+void AIFXEngine::setFrameHopSize(int hopSamples)
+{
+    const juce::ScopedLock sl(editLock);
+    
+    frameHopSize = juce::jmax(0, hopSamples);
+    
+    for (auto& track : trackFX)
+    {
+        for (auto& effect : track.aiEffects)
+        {
+            if (auto* aiEffect = dynamic_cast<AIEffect*>(effect.get()))
+                aiEffect->setFrameHop(frameHopSize);
+        }
+    }
+}
+
+int AIFXEngine::getLatencySamples() const
+{
+    const juce::ScopedLock sl(editLock);
+    
+    int maxLatency = 0;
+    for (const auto& track : trackFX)
+        maxLatency = juce::jmax(maxLatency, computeTrackLatency(track));
+    return maxLatency;
+}
+
+int AIFXEngine::getTrackLatencySamples(int trackIndex) const
+{
+    if (trackIndex < 0 || trackIndex >= NUM_TRACKS)
+        return 0;
+    
+    const juce::ScopedLock sl(editLock);
+    return computeTrackLatency(trackFX[trackIndex]);
+}
+
+int AIFXEngine::getRunningLatencySamples() const
+{
+    return activeChain != nullptr ? activeChain->latencySamples : 0;
+}
+
+int AIFXEngine::getRunningTrackLatencySamples(int trackIndex) const
+{
+    if (activeChain == nullptr || trackIndex < 0 || trackIndex >= NUM_TRACKS)
+        return 0;
+    
+    return activeChain->trackLatencies[trackIndex];
+}
+
+bool AIFXEngine::isTrackTailActive(int trackIndex) const
+{
+    return trackIndex >= 0 && trackIndex < NUM_TRACKS && trackGates[trackIndex].isOpen();
+}
+
+double AIFXEngine::getTailLengthSeconds() const
+{
+    const juce::ScopedLock sl(editLock);
+    
+    double maxTail = 0.0;
+    for (const auto& track : trackFX)
+        maxTail = juce::jmax(maxTail, computeTrackTail(track));
+    return maxTail;
+}
+
+void AIFXEngine::refreshModelRole(const juce::String& modelRole)
+{
+    struct Replacement
+    {
+        int trackIndex;
+        size_t slot;
+        const Effect* previous;
+        std::shared_ptr<Effect> effect;
+    };
+    
+    std::vector<Replacement> replacements;
+    double sampleRate;
+    int maxBlockSize;
+    
+    {
+        const juce::ScopedLock sl(editLock);
+        sampleRate = currentSampleRate;
+        maxBlockSize = currentMaxBlockSize;
+        
+        for (int trackIndex = 0; trackIndex < NUM_TRACKS; ++trackIndex)
+        {
+            const auto& effects = trackFX[trackIndex].aiEffects;
+            for (size_t slot = 0; slot < effects.size(); ++slot)
+            {
+                auto* aiEffect = dynamic_cast<AIEffect*>(effects[slot].get());
+                if (aiEffect != nullptr && aiEffect->getModelRole() == modelRole)
+                    replacements.push_back({ trackIndex, slot, aiEffect, nullptr });
+            }
+        }
+    }
+    
+    if (replacements.empty())
+        return;
+    
+    // Live effects keep running while their replacements are prepared
+    for (auto& replacement : replacements)
+        replacement.effect = createAIEffect(modelRole, sampleRate, maxBlockSize);
+    
+    const juce::ScopedLock sl(editLock);
+    
+    for (auto& replacement : replacements)
+    {
+        // Skip slots edited in the meantime
+        auto& effects = trackFX[replacement.trackIndex].aiEffects;
+        if (replacement.slot < effects.size() && effects[replacement.slot].get() == replacement.previous)
+            effects[replacement.slot] = std::move(replacement.effect);
+    }
+    
+    prepareBatching();
+    publishChain();
+}
+
+void AIFXEngine::setProfiler(RealtimeProfiler* profilerToUse)
+{
+    profiler = profilerToUse;
+    
+    for (int trackIndex = 0; trackIndex < NUM_TRACKS; ++trackIndex)
+    {
+        const auto prefix = "fx/track" + juce::String(trackIndex + 1);
+        dspProfileStages[static_cast<size_t>(trackIndex)] = profiler != nullptr ? profiler->registerStage(prefix + "/dsp") : -1;
+        aiProfileStages[static_cast<size_t>(trackIndex)] = profiler != nullptr ? profiler->registerStage(prefix + "/ai") : -1;
+    }
+    
+    batchProfileStage = profiler != nullptr ? profiler->registerStage("fx/ai batch") : -1;
 }
 
 } // namespace MAEVN
@@ -9,10 +9,16 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <vector>
 #include "Utilities.h"
 #include "OnnxEngine.h"
+#include "RealtimeWorkerPool.h"
+#include "RealtimeProfiler.h"
+#include "SmoothedBiquad.h"
+#include "Dynamics.h"
 
 namespace MAEVN
 {
@@ -45,6 +51,40 @@ public:
      * @brief Get effect name
      */
     virtual juce::String getName() const = 0;
+    
+    /**
+     * @brief Get processing latency introduced by this effect (in samples)
+     */
+    virtual int getLatencySamples() const { return 0; }
+    
+    /**
+     * @brief Get how long output continues after the input stops (beyond latency)
+     */
+    virtual double getTailLengthSeconds() const { return 0.0; }
+    
+    /**
+     * @brief Look up a parameter by name (off the audio thread)
+     * @return Index for setParameter(), or -1 if the effect has no such parameter
+     */
+    virtual int getParameterIndex(const juce::String& name) const
+    {
+        juce::ignoreUnused(name);
+        return -1;
+    }
+    
+    /**
+     * @brief Set a parameter by index (called on the audio thread)
+     */
+    virtual void setParameter(int index, float value) { juce::ignoreUnused(index, value); }
+    
+    /**
+     * @brief Process-wide unique id, used to match queued parameter changes
+     */
+    juce::uint32 getEffectId() const { return effectId; }
+    
+private:
+    inline static std::atomic<juce::uint32> nextEffectId { 1 };
+    const juce::uint32 effectId = nextEffectId++;
 };
 
 //==============================================================================
@@ -60,6 +100,9 @@ public:
     void prepare(double sampleRate, int maxBlockSize) override;
     void reset() override;
     juce::String getName() const override { return "Compressor"; }
+    double getTailLengthSeconds() const override { return releaseMs / 1000.0; }
+    int getParameterIndex(const juce::String& name) const override;
+    void setParameter(int index, float value) override;
     
     void setThreshold(float dB);
     void setRatio(float ratio);
@@ -67,8 +110,9 @@ public:
     void setRelease(float ms);
     
 private:
-    juce::dsp::Compressor<float> compressor;
+    Compressor compressor;
     double currentSampleRate;
+    float releaseMs;
 };
 
 //==============================================================================
@@ -84,19 +128,24 @@ public:
     void prepare(double sampleRate, int maxBlockSize) override;
     void reset() override;
     juce::String getName() const override { return "EQ"; }
+    double getTailLengthSeconds() const override { return FILTER_TAIL_SECONDS; }
+    int getParameterIndex(const juce::String& name) const override;
+    void setParameter(int index, float value) override;
     
     void setLowGain(float dB);
     void setMidGain(float dB);
     void setHighGain(float dB);
     
 private:
-    juce::dsp::ProcessorChain<
-        juce::dsp::IIR::Filter<float>,  // Low shelf
-        juce::dsp::IIR::Filter<float>,  // Mid peak
-        juce::dsp::IIR::Filter<float>   // High shelf
-    > eqChain;
+    // Sections of the band cascade, in processing order
+    enum Band { LowShelfBand = 0, MidPeakBand, HighShelfBand, NumBands };
+    
+    BiquadCascade bands;
     
     double currentSampleRate;
+    float lowGainDB;
+    float midGainDB;
+    float highGainDB;
 };
 
 //==============================================================================
@@ -112,6 +161,9 @@ public:
     void prepare(double sampleRate, int maxBlockSize) override;
     void reset() override;
     juce::String getName() const override { return "Reverb"; }
+    double getTailLengthSeconds() const override { return getReverbTailSeconds(reverbParams.roomSize); }
+    int getParameterIndex(const juce::String& name) const override;
+    void setParameter(int index, float value) override;
     
     void setRoomSize(float size);
     void setDamping(float damping);
@@ -136,12 +188,181 @@ public:
     void prepare(double sampleRate, int maxBlockSize) override;
     void reset() override;
     juce::String getName() const override { return "Limiter"; }
+    double getTailLengthSeconds() const override { return releaseMs / 1000.0; }
+    int getParameterIndex(const juce::String& name) const override;
+    void setParameter(int index, float value) override;
     
     void setThreshold(float dB);
     void setRelease(float ms);
     
 private:
     juce::dsp::Limiter<float> limiter;
+    float releaseMs;
+};
+
+//==============================================================================
+/**
+ * @brief Fixed-frame adapter with overlap-add for models with a static input size
+ * 
+ * Host blocks of any size are buffered into model-sized frames taken every
+ * hop samples. Each frame's output is Hann-windowed and overlap-added, so the
+ * model always sees the same tensor shape (no graph re-planning) and the
+ * result does not depend on how the host splits the stream. Output is
+ * delayed by exactly one frame.
+ */
+class FramedModelAdapter
+{
+public:
+    FramedModelAdapter(OnnxEngine* engine, const juce::String& modelRole);
+    
+    /**
+     * @brief Read the role's static frame size and allocate frame buffers
+     * @param numChannels Number of audio channels
+     * @param hopSize Hop between frames (0 = half a frame)
+     * @return true if the model has a static frame size and framing is active
+     */
+    bool prepare(int numChannels, int hopSize);
+    
+    /**
+     * @brief Process planar audio in place (any block size)
+     */
+    void process(float* const* channels, int numChannels, int numSamples);
+    
+    /**
+     * @brief Clear frame history and overlap-add state
+     */
+    void reset();
+    
+    int getFrameSize() const { return frameSize; }
+    int getHopSize() const { return hopSize; }
+    int getLatencySamples() const { return frameSize; }
+    
+private:
+    void processFrame();
+    bool runModel(const float* const* input, float* const* output, int channels);
+    
+    OnnxEngine* onnxEngine;
+    juce::String modelRole;
+    
+    int numChannels = 0;
+    int modelChannels = 0;  // 1 = mono model, run once per channel
+    int frameSize = 0;
+    int hopSize = 0;
+    int hopFill = 0;        // samples received since the last frame
+    
+    std::vector<float> window;  // synthesis window, pre-scaled for unity overlap gain
+    
+    juce::AudioBuffer<float> inputHistory;   // last frameSize input samples
+    juce::AudioBuffer<float> frameOutput;    // model output for the current frame
+    juce::AudioBuffer<float> overlapAccumulator;
+    juce::AudioBuffer<float> readyOutput;    // completed hop being drained
+    
+    // Fallback when no pre-bound tensor is available
+    std::vector<float> fallbackInput;
+    std::vector<float> fallbackOutput;
+    std::vector<int64_t> fallbackShape;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FramedModelAdapter)
+};
+
+//==============================================================================
+/**
+ * @brief Background inference thread for a single model role
+ * 
+ * The audio thread writes input into a single-producer/single-consumer ring
+ * indexed by absolute sample position and reads processed audio back a fixed
+ * number of samples later. The worker runs the ONNX model on fixed-size
+ * chunks in its own thread, so a slow inference never blocks the audio thread.
+ * Samples that have not been processed by the time they are due are replaced
+ * with the (equally delayed) dry input.
+ */
+class AsyncInferenceWorker : private juce::Thread
+{
+public:
+    /** How often the worker looks for a chunk pushed by the audio thread */
+    static constexpr int INPUT_POLL_MS = 1;
+    
+    AsyncInferenceWorker(OnnxEngine* engine, const juce::String& modelRole);
+    ~AsyncInferenceWorker() override;
+    
+    /**
+     * @brief Allocate ring buffers and start the inference thread
+     * @param numChannels Number of audio channels
+     * @param chunkSize Number of samples per inference call
+     * @param latencyBlocks Delay in chunks before processed audio is due (min 2)
+     */
+    void prepare(int numChannels, int chunkSize, int latencyBlocks);
+    
+    /**
+     * @brief Route chunks through a FramedModelAdapter (takes effect on prepare())
+     * @param enabled Use framing if the model has a static frame size
+     * @param hopSize Hop between frames (0 = half a frame)
+     */
+    void setFraming(bool enabled, int hopSize);
+    
+    /**
+     * @brief Stop the inference thread
+     */
+    void release();
+    
+    /**
+     * @brief Push a block to the worker and replace it with delayed output
+     * 
+     * Realtime safe: never locks or allocates.
+     */
+    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    /**
+     * @brief Clear ring state (call while audio is stopped)
+     */
+    void reset();
+    
+    /**
+     * @brief Get fixed delay between input and output (in samples)
+     */
+    int getLatencySamples() const;
+    
+    /**
+     * @brief Number of blocks that fell back to dry pass-through
+     */
+    int getNumMissedDeadlines() const { return missedDeadlines.load(); }
+    
+private:
+    void run() override;
+    
+    OnnxEngine* onnxEngine;
+    juce::String modelRole;
+    
+    int numChannels = 2;
+    int chunkSize = 512;
+    int latencySamples = 0;
+    int ringSize = 0;
+    
+    // Planar rings ([channel * ringSize + index]) indexed by absolute
+    // sample position modulo ringSize
+    std::vector<float> inputRing;
+    std::vector<float> outputRing;
+    
+    // Absolute sample positions shared between audio and worker threads
+    std::atomic<juce::int64> writePosition{0};     // written by audio thread
+    std::atomic<juce::int64> processedStart{0};    // written by worker
+    std::atomic<juce::int64> processedEnd{0};      // written by worker
+    std::atomic<int> missedDeadlines{0};
+    
+    // No event: signalling one takes a lock, so the worker polls writePosition
+    
+    // Worker-thread scratch buffers (tensor layout: planar channels)
+    std::vector<float> tensorInput;
+    std::vector<float> tensorOutput;
+    std::vector<float> tensorFallbackOutput;
+    std::vector<const float*> tensorInputChannels;
+    std::vector<float*> tensorOutputChannels;
+    
+    bool framingEnabled = false;
+    int frameHopSize = 0;
+    std::unique_ptr<FramedModelAdapter> frameAdapter;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AsyncInferenceWorker)
 };
 
 //==============================================================================
@@ -152,18 +373,71 @@ class AIEffect : public Effect
 {
 public:
     AIEffect(OnnxEngine* engine, const juce::String& modelRole);
+    ~AIEffect() override;
     
     void process(juce::AudioBuffer<float>& buffer, int numSamples) override;
     void prepare(double sampleRate, int maxBlockSize) override;
     void reset() override;
     juce::String getName() const override { return "AI: " + modelRole; }
+    int getLatencySamples() const override;
+    
+    /**
+     * @brief Models may add ambience of their own; allow it to ring out
+     */
+    double getTailLengthSeconds() const override { return MODEL_TAIL_SECONDS; }
+    
+    /**
+     * @brief Run inference on a background thread instead of the audio thread
+     * @param enabled Enable async mode (takes effect on next prepare())
+     * @param latencyBlocks Delay in blocks reported to the host (min 2)
+     */
+    void setAsyncMode(bool enabled, int latencyBlocks = 2);
+    bool isAsyncMode() const { return asyncEnabled; }
+    
+    /**
+     * @brief Set hop size used when the model has a static frame size
+     * @param hopSamples Hop between frames (0 = half a frame)
+     */
+    void setFrameHop(int hopSamples) { frameHopSize = juce::jmax(0, hopSamples); }
+    
+    /**
+     * @brief Get the model role this effect runs
+     */
+    const juce::String& getModelRole() const { return modelRole; }
+    
+    /**
+     * @brief Get the load state of this effect's model (loading vs. missing)
+     */
+    ModelLoadState getModelLoadState() const;
+    
+    /**
+     * @brief Check if this effect runs block-synchronously on the engine
+     * 
+     * Only such effects can share a batched session Run with other tracks;
+     * async and fixed-frame effects keep their own buffering.
+     */
+    bool canBatch() const { return onnxEngine != nullptr && !asyncWorker && !frameAdapter; }
     
 private:
+    static constexpr double MODEL_TAIL_SECONDS = 0.5;
+    
     OnnxEngine* onnxEngine;
     juce::String modelRole;
     double currentSampleRate;
     
-    // Buffer for AI processing
+    // Async mode
+    bool asyncEnabled = false;
+    int asyncLatencyBlocks = 2;
+    std::unique_ptr<AsyncInferenceWorker> asyncWorker;
+    
+    // Fixed-frame models
+    int frameHopSize = 0;
+    std::unique_ptr<FramedModelAdapter> frameAdapter;
+    
+    // Unbatched fallback, sized in prepare() for PREPARED_CHANNELS x maxBlockSize
+    static constexpr int PREPARED_CHANNELS = 2;
+    int preparedBlockSize = 0;
+    std::vector<int64_t> fallbackShape;
     std::vector<float> inputBuffer;
     std::vector<float> outputBuffer;
 };
@@ -171,6 +445,13 @@ private:
 //==============================================================================
 /**
  * @brief Main AI FX Engine - manages effects chains
+ * 
+ * Chain edits are made on a master copy off the audio thread and published
+ * as an immutable FXChain through an atomic pointer. The audio thread picks
+ * the newest chain up at the start of a block and hands the one it replaces
+ * back through a FIFO, so chains (and the effects only they still hold) are
+ * deleted by the next editing thread. Parameter changes reach live effects
+ * through a lock-free command FIFO. The audio thread never locks or frees.
  */
 class AIFXEngine
 {
@@ -184,12 +465,27 @@ public:
     void process(juce::AudioBuffer<float>& buffer, int numSamples, int trackIndex);
     
     /**
-     * @brief Prepare for playback
+     * @brief Process every track, each on its own buffer
+     * 
+     * DSP chains run first, one job per track. AI effects then run stage by
+     * stage with one job per model role: tracks sharing a role at a stage
+     * share its pre-bound tensors, so they stay in one job and are batched
+     * into one session Run where possible.
+     * @param trackBuffers One buffer per track (nullptr = skip)
+     * @param numTracks Number of entries in trackBuffers
+     * @param numSamples Samples to process
+     * @param workers Pool to spread the jobs over (nullptr = calling thread only)
+     */
+    void processTracks(juce::AudioBuffer<float>* const* trackBuffers, int numTracks, int numSamples,
+                       RealtimeWorkerPool* workers = nullptr);
+    
+    /**
+     * @brief Prepare for playback (audio stopped)
      */
     void prepare(double sampleRate, int maxBlockSize);
     
     /**
-     * @brief Reset all effects
+     * @brief Reset all effects (audio stopped)
      */
     void reset();
     
@@ -204,12 +500,12 @@ public:
     FXMode getFXMode(int trackIndex) const;
     
     /**
-     * @brief Add DSP effect to track chain
+     * @brief Add DSP effect to track chain (prepared before it goes live)
      */
     void addDSPEffect(int trackIndex, std::unique_ptr<Effect> effect);
     
     /**
-     * @brief Add AI effect to track chain
+     * @brief Add AI effect to track chain (prepared before it goes live)
      */
     void addAIEffect(int trackIndex, const juce::String& modelRole);
     
@@ -225,41 +521,287 @@ public:
     
     /**
      * @brief Set parameter for track effect
+     * 
+     * Queued and applied by the audio thread at the start of its next block.
+     * @param effectIndex Index into the track's DSP effects followed by its AI effects
      */
     void setEffectParameter(int trackIndex, int effectIndex, const juce::String& paramName, float value);
     
+    /**
+     * @brief Enable asynchronous inference for all AI effects
+     * 
+     * Takes effect on the next prepare(); the resulting delay is reported
+     * by getLatencySamples().
+     */
+    void setAsyncInferenceEnabled(bool enabled, int latencyBlocks = 2);
+    bool isAsyncInferenceEnabled() const { return asyncInferenceEnabled; }
+    
+    /**
+     * @brief Set overlap-add hop for AI effects on fixed-frame models
+     * 
+     * Takes effect on the next prepare().
+     * @param hopSamples Hop between frames (0 = half a frame)
+     */
+    void setFrameHopSize(int hopSamples);
+    
+    /**
+     * @brief Get latency of the slowest track (in samples)
+     * 
+     * Tracks run side by side, so faster tracks must be delayed by the
+     * difference (see getTrackLatencySamples()) before they are summed.
+     */
+    int getLatencySamples() const;
+    
+    /**
+     * @brief Get latency of one track's active chain (in samples)
+     */
+    int getTrackLatencySamples(int trackIndex) const;
+    
+    /**
+     * @brief Latencies of the chain the audio thread is running
+     * 
+     * Audio thread only (after processTracks()); lock-free counterparts of
+     * getLatencySamples() / getTrackLatencySamples().
+     */
+    int getRunningLatencySamples() const;
+    int getRunningTrackLatencySamples(int trackIndex) const;
+    
+    /**
+     * @brief Check whether a track's effects may still be sounding
+     * 
+     * Audio thread only. False once the track's input has been silent for
+     * longer than its tail, so a caller with nothing to feed the track can
+     * leave it out of processTracks().
+     */
+    bool isTrackTailActive(int trackIndex) const;
+    
+    /**
+     * @brief Get the longest tail of any track's active chain (in seconds)
+     */
+    double getTailLengthSeconds() const;
+    
+    /**
+     * @brief Replace AI effects using a role once its model has (re)loaded
+     * 
+     * Fixed-frame and pre-bound paths depend on the model's shape, which is
+     * unknown while the model is still loading. Fresh effects are prepared
+     * off the audio thread and swapped in with the next chain.
+     */
+    void refreshModelRole(const juce::String& modelRole);
+    
+    /**
+     * @brief Time each track's DSP and AI processing into a profiler (audio stopped)
+     * @param profiler Profiler to record into (nullptr = off)
+     */
+    void setProfiler(RealtimeProfiler* profiler);
+    
+    /**
+     * @brief Run AI and Hybrid tracks without their AI effects (any thread)
+     * 
+     * Used by the CPU governor to shed inference. Each track crossfades over
+     * AI_FALLBACK_FADE_SECONDS to its signal ahead of the AI effects, delayed
+     * by their latency so it stays aligned: Hybrid tracks keep their DSP
+     * chain and AI tracks play dry. On the way back the AI effects run
+     * unheard for their latency before they are faded in again.
+     */
+    void setAIFallback(bool shouldFallBack) { aiFallback.store(shouldFallBack, std::memory_order_relaxed); }
+    bool isAIFallbackEnabled() const { return aiFallback.load(std::memory_order_relaxed); }
+    
 private:
     static constexpr int NUM_TRACKS = 6; // Vocal, 808, HiHat, Snare, Piano, Synth
     
     struct TrackFX
     {
         FXMode mode = FXMode::Off;
-        std::vector<std::unique_ptr<Effect>> dspEffects;
-        std::vector<std::unique_ptr<Effect>> aiEffects;
+        std::vector<std::shared_ptr<Effect>> dspEffects;
+        std::vector<std::shared_ptr<Effect>> aiEffects;
     };
     
+    /**
+     * @brief Immutable snapshot of every track's chain as run by the audio thread
+     */
+    struct FXChain
+    {
+        std::array<TrackFX, NUM_TRACKS> tracks;
+        std::array<int, NUM_TRACKS> trackLatencies {};
+        std::array<int, NUM_TRACKS> aiLatencies {};     // of the AI effects alone
+        int latencySamples = 0;
+        juce::uint32 version = 0;
+    };
+    
+    // Master copy edited under editLock; every edit publishes a new chain
     std::array<TrackFX, NUM_TRACKS> trackFX;
+    juce::uint32 chainVersion = 0;
     OnnxEngine* onnxEngine;
     
     double currentSampleRate;
     int currentMaxBlockSize;
     
-    juce::CriticalSection fxLock;
+    bool asyncInferenceEnabled = false;
+    int asyncLatencyBlocks = 2;
+    int frameHopSize = 0;
+    
+    // Serializes editing threads; never taken by the audio thread
+    mutable juce::CriticalSection editLock;
+    
+    // Owned by the audio thread once published
+    FXChain* activeChain = nullptr;
+    std::atomic<FXChain*> pendingChain { nullptr };
+    
+    // Chains the audio thread has replaced, deleted by the next edit
+    static constexpr int RETIRE_QUEUE_SIZE = 16;
+    juce::AbstractFifo retireFifo { RETIRE_QUEUE_SIZE };
+    std::array<FXChain*, RETIRE_QUEUE_SIZE> retireQueue {};
+    
+    struct ParameterCommand
+    {
+        Effect* effect = nullptr;
+        juce::uint32 effectId = 0;
+        juce::uint32 chainVersion = 0;   // first chain that contains the effect
+        int parameterIndex = -1;
+        float value = 0.0f;
+    };
+    
+    static constexpr int COMMAND_QUEUE_SIZE = 256;
+    juce::AbstractFifo commandFifo { COMMAND_QUEUE_SIZE };
+    std::array<ParameterCommand, COMMAND_QUEUE_SIZE> commandQueue {};
+    
+    // Skip tracks whose input has been silent for longer than their tail (audio thread)
+    std::array<SilenceGate, NUM_TRACKS> trackGates;
+    
+    // Cross-track batching scratch (sized in prepare), one region per job
+    static constexpr int MAX_BATCH_CHANNELS = 2;
+    static constexpr size_t BATCH_SCRATCH_PER_JOB = NUM_TRACKS * MAX_BATCH_CHANNELS;
+    std::vector<const float*> batchInputs;
+    std::vector<float*> batchOutputs;
+    
+    // AI fallback: each AI track's signal ahead of its AI effects, delayed by their latency (audio thread)
+    static constexpr double AI_FALLBACK_FADE_SECONDS = 0.05;
+    static constexpr int MAX_FALLBACK_DELAY = 16384;
+    using FallbackDelay = juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None>;
+    std::atomic<bool> aiFallback { false };
+    std::array<juce::AudioBuffer<float>, NUM_TRACKS> fallbackBuffers;
+    std::array<FallbackDelay, NUM_TRACKS> fallbackDelays;
+    std::array<float, NUM_TRACKS> aiMix {};             // 1 = AI output, 0 = fallback
+    std::array<int, NUM_TRACKS> aiWarmupSamples {};     // AI output stays unheard until this runs out
+    std::array<bool, NUM_TRACKS> aiSuspended {};        // AI effects skipped this block
+    
+    // Stage ids in the profiler, if one is set
+    RealtimeProfiler* profiler = nullptr;
+    std::array<int, NUM_TRACKS> dspProfileStages {};
+    std::array<int, NUM_TRACKS> aiProfileStages {};
+    int batchProfileStage = -1;
+    
+    /**
+     * @brief Work of one processTracks() phase, handed to the worker pool
+     */
+    struct TrackJobs
+    {
+        AIFXEngine* engine = nullptr;
+        const FXChain* chain = nullptr;
+        juce::AudioBuffer<float>* const* trackBuffers = nullptr;
+        int numSamples = 0;
+        size_t stage = 0;
+        std::array<std::array<int, NUM_TRACKS>, NUM_TRACKS> jobTracks {};
+        std::array<int, NUM_TRACKS> jobSizes {};
+        int numJobs = 0;
+    };
+    
+    /**
+     * @brief Snapshot the master copy into a new chain and publish it (editLock held)
+     */
+    void publishChain();
+    
+    /**
+     * @brief Delete chains handed back by the audio thread (editLock held)
+     */
+    void collectRetiredChains();
+    
+    /**
+     * @brief Pick up the newest chain and apply queued parameters (audio thread)
+     */
+    const FXChain* acquireChain();
+    
+    /**
+     * @brief Apply queued parameter commands whose effects are live (audio thread)
+     */
+    void applyParameterCommands();
+    
+    /**
+     * @brief Latency of a track's chain for its mode
+     */
+    static int computeTrackLatency(const TrackFX& track);
+    
+    /**
+     * @brief Latency of a track's AI effects
+     */
+    static int computeAILatency(const TrackFX& track);
+    
+    /**
+     * @brief Tail of a track's chain for its mode, excluding latency
+     */
+    static double computeTrackTail(const TrackFX& track);
+    
+    /**
+     * @brief Decide whether a track has to run this block
+     */
+    bool shouldProcessTrack(const FXChain& chain, int trackIndex,
+                            const juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    static void runDSPJob(void* context, int jobIndex);
+    static void runAIJob(void* context, int jobIndex);
+    
+    /**
+     * @brief Run a phase's jobs on the pool, or in order without one
+     */
+    static void runJobs(RealtimeWorkerPool* workers, TrackJobs& jobs, RealtimeWorkerPool::JobFunction function);
+    
+    /**
+     * @brief Run one role's effects of an AI stage (batched where possible)
+     */
+    void processAIJob(const TrackJobs& jobs, int jobIndex);
+    
+    /**
+     * @brief Pre-bind batch tensors for roles shared by several tracks (editLock held)
+     */
+    void prepareBatching();
+    
+    /**
+     * @brief Run one AI stage across tracks, one job per model role
+     */
+    void processAIStage(const FXChain& chain, juce::AudioBuffer<float>* const* trackBuffers, int numTracks,
+                        int numSamples, size_t stage, RealtimeWorkerPool* workers);
+    
+    /**
+     * @brief Capture the fallback of each AI track and decide whose AI effects are skipped
+     */
+    void prepareAIFallback(const FXChain& chain, juce::AudioBuffer<float>* const* trackBuffers, int numTracks,
+                           int numSamples, bool fallBack);
+    
+    /**
+     * @brief Crossfade each AI track between its AI output and its fallback
+     */
+    void applyAIFallback(const FXChain& chain, juce::AudioBuffer<float>* const* trackBuffers, int numTracks,
+                         int numSamples, bool fallBack);
     
     /**
-     * @brief Process with DSP effects only
+     * @brief Run a batch of same-role tracks in one inference
+     * @return false if the batch can't be served (tracks then run one by one)
      */
-    void processDSP(juce::AudioBuffer<float>& buffer, int numSamples, int trackIndex);
+    bool runBatch(const juce::String& modelRole, const int* tracks, int batchSize,
+                  juce::AudioBuffer<float>* const* trackBuffers, int numSamples,
+                  size_t scratchOffset);
     
     /**
-     * @brief Process with AI effects only
+     * @brief Run a list of effects in order
      */
-    void processAI(juce::AudioBuffer<float>& buffer, int numSamples, int trackIndex);
+    static void processEffects(const std::vector<std::shared_ptr<Effect>>& effects,
+                               juce::AudioBuffer<float>& buffer, int numSamples);
     
     /**
-     * @brief Process with hybrid DSP+AI chain
+     * @brief Create and prepare an AI effect with the engine's settings
      */
-    void processHybrid(juce::AudioBuffer<float>& buffer, int numSamples, int trackIndex);
+    std::unique_ptr<AIEffect> createAIEffect(const juce::String& modelRole, double sampleRate, int maxBlockSize) const;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AIFXEngine)
 };
@@ -0,0 +1,313 @@
+/**
+ * @file AudioAssetStore.cpp
+ * @brief Implementation of the content-addressed audio asset store
+ */
+
+#include "AudioAssetStore.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace MAEVN
+{
+
+namespace
+{
+    constexpr const char* ASSET_FILE_EXTENSION = ".wav";
+    
+    inline juce::uint64 mixWord(juce::uint64 hash, juce::uint64 word)
+    {
+        constexpr juce::uint64 PRIME_1 = 0x9e3779b185ebca87ULL;
+        constexpr juce::uint64 PRIME_2 = 0xc2b2ae3d27d4eb4fULL;
+        
+        hash ^= word * PRIME_2;
+        hash = (hash << 31) | (hash >> 33);
+        return hash * PRIME_1;
+    }
+}
+
+//==============================================================================
+AudioAssetStore::AudioAssetStore(const juce::File& directory)
+    : diskUsage(0)
+    , diskBudget(DEFAULT_DISK_BUDGET)
+{
+    setDirectory(directory);
+}
+
+AudioAssetStore::~AudioAssetStore()
+{
+}
+
+//==============================================================================
+juce::String AudioAssetStore::hashAudio(const juce::AudioBuffer<float>& audio)
+{
+    juce::uint64 hash = mixWord(static_cast<juce::uint64>(audio.getNumChannels()),
+                                static_cast<juce::uint64>(audio.getNumSamples()));
+    
+    const auto numBytes = static_cast<size_t>(audio.getNumSamples()) * sizeof(float);
+    
+    for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+    {
+        const auto* bytes = reinterpret_cast<const char*>(audio.getReadPointer(ch));
+        
+        // Eight bytes (two samples) per step; a dependent multiply chain runs at memory speed
+        size_t offset = 0;
+        for (; offset + sizeof(juce::uint64) <= numBytes; offset += sizeof(juce::uint64))
+        {
+            juce::uint64 word;
+            std::memcpy(&word, bytes + offset, sizeof(word));
+            hash = mixWord(hash, word);
+        }
+        
+        if (offset < numBytes)
+        {
+            juce::uint64 word = 0;
+            std::memcpy(&word, bytes + offset, numBytes - offset);
+            hash = mixWord(hash, word);
+        }
+    }
+    
+    // Final avalanche, so every input bit reaches every digit
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    
+    return juce::String::toHexString(static_cast<juce::int64>(hash)).paddedLeft('0', 16);
+}
+
+//==============================================================================
+juce::File AudioAssetStore::findFile(const juce::String& key)
+{
+    const juce::ScopedLock sl(storeLock);
+    
+    auto it = lruIndex.find(key);
+    if (it == lruIndex.end())
+        return {};
+    
+    auto entry = it->second;
+    if (!entry->file.existsAsFile())
+    {
+        // Deleted behind the store's back
+        diskUsage -= entry->bytes;
+        lruList.erase(entry);
+        lruIndex.erase(it);
+        return {};
+    }
+    
+    lruList.splice(lruList.begin(), lruList, entry);
+    
+    // Persists the LRU order for the next session's scan
+    entry->file.setLastAccessTime(juce::Time::getCurrentTime());
+    return entry->file;
+}
+
+juce::File AudioAssetStore::store(const juce::String& key,
+                                  const juce::AudioBuffer<float>& audio,
+                                  double sampleRate,
+                                  int bitDepth)
+{
+    auto existing = findFile(key);
+    if (existing != juce::File())
+        return existing;
+    
+    const auto file = [this, &key]
+    {
+        const juce::ScopedLock sl(storeLock);
+        return getFile(key);
+    }();
+    
+    if (!file.getParentDirectory().createDirectory())
+        return {};
+    
+    // Write beside the target and move into place so readers never see partial files
+    juce::TemporaryFile temp(file);
+    
+    {
+        juce::WavAudioFormat wavFormat;
+        auto output = std::make_unique<juce::FileOutputStream>(temp.getFile());
+        if (!output->openedOk())
+            return {};
+        
+        std::unique_ptr<juce::AudioFormatWriter> writer(
+            wavFormat.createWriterFor(output.get(),
+                                      sampleRate,
+                                      static_cast<unsigned int>(audio.getNumChannels()),
+                                      bitDepth,
+                                      {},
+                                      0));
+        if (writer == nullptr)
+            return {};
+        
+        output.release();
+        
+        if (!writer->writeFromAudioSampleBuffer(audio, 0, audio.getNumSamples()))
+            return {};
+    } // the writer finalizes the header as it is destroyed
+    
+    if (!temp.overwriteTargetFileWithTemporary())
+    {
+        Logger::log(Logger::Level::Warning, "Failed to store audio asset: " + file.getFullPathName());
+        return {};
+    }
+    
+    const juce::ScopedLock sl(storeLock);
+    insertEntry(key, file);
+    evictToBudget();
+    return file;
+}
+
+AudioAssetStore::Audio AudioAssetStore::read(const juce::String& key)
+{
+    const auto file = findFile(key);
+    if (file == juce::File())
+        return nullptr;
+    
+    // Pages come straight from the file cache; nothing is streamed through a buffer
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader(wavFormat.createMemoryMappedReader(file));
+    
+    if (reader == nullptr || !reader->mapEntireFile() || reader->numChannels <= 0
+        || reader->lengthInSamples > std::numeric_limits<int>::max())
+    {
+        Logger::log(Logger::Level::Warning, "Discarding unreadable audio asset: " + file.getFileName());
+        reader.reset();
+        remove(key);
+        return nullptr;
+    }
+    
+    const int numSamples = static_cast<int>(reader->lengthInSamples);
+    auto audio = std::make_shared<juce::AudioBuffer<float>>(static_cast<int>(reader->numChannels), numSamples);
+    reader->read(audio.get(), 0, numSamples, 0, true, true);
+    
+    return audio;
+}
+
+void AudioAssetStore::remove(const juce::String& key)
+{
+    const juce::ScopedLock sl(storeLock);
+    
+    auto it = lruIndex.find(key);
+    if (it == lruIndex.end())
+        return;
+    
+    it->second->file.deleteFile();
+    diskUsage -= it->second->bytes;
+    lruList.erase(it->second);
+    lruIndex.erase(it);
+}
+
+void AudioAssetStore::clear()
+{
+    const juce::ScopedLock sl(storeLock);
+    
+    for (auto& entry : lruList)
+        entry.file.deleteFile();
+    
+    Logger::log(Logger::Level::Info, "Cleared " + juce::String(static_cast<int>(lruList.size()))
+                + " audio assets from " + assetDirectory.getFullPathName());
+    
+    lruList.clear();
+    lruIndex.clear();
+    diskUsage = 0;
+}
+
+//==============================================================================
+void AudioAssetStore::setDirectory(const juce::File& directory)
+{
+    const juce::ScopedLock sl(storeLock);
+    
+    assetDirectory = directory;
+    scanDirectory();
+}
+
+juce::File AudioAssetStore::getDirectory() const
+{
+    const juce::ScopedLock sl(storeLock);
+    return assetDirectory;
+}
+
+void AudioAssetStore::setDiskBudget(juce::int64 bytes)
+{
+    const juce::ScopedLock sl(storeLock);
+    diskBudget = bytes;
+    evictToBudget();
+}
+
+juce::int64 AudioAssetStore::getDiskBudget() const
+{
+    const juce::ScopedLock sl(storeLock);
+    return diskBudget;
+}
+
+juce::int64 AudioAssetStore::getDiskUsage() const
+{
+    const juce::ScopedLock sl(storeLock);
+    return diskUsage;
+}
+
+int AudioAssetStore::getNumAssets() const
+{
+    const juce::ScopedLock sl(storeLock);
+    return static_cast<int>(lruList.size());
+}
+
+//==============================================================================
+void AudioAssetStore::scanDirectory()
+{
+    lruList.clear();
+    lruIndex.clear();
+    diskUsage = 0;
+    
+    if (!assetDirectory.isDirectory())
+        return;
+    
+    auto files = assetDirectory.findChildFiles(juce::File::findFiles, false,
+                                               juce::String("*") + ASSET_FILE_EXTENSION);
+    
+    // Least recently accessed first, so each insert lands in front of the older ones
+    std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b)
+    {
+        return a.getLastAccessTime() < b.getLastAccessTime();
+    });
+    
+    for (const auto& file : files)
+        insertEntry(file.getFileNameWithoutExtension(), file);
+    
+    evictToBudget();
+}
+
+void AudioAssetStore::insertEntry(const juce::String& key, const juce::File& file)
+{
+    auto it = lruIndex.find(key);
+    if (it != lruIndex.end())
+    {
+        diskUsage -= it->second->bytes;
+        lruList.erase(it->second);
+        lruIndex.erase(it);
+    }
+    
+    const auto bytes = file.getSize();
+    lruList.push_front({ key, file, bytes });
+    lruIndex[key] = lruList.begin();
+    diskUsage += bytes;
+}
+
+void AudioAssetStore::evictToBudget()
+{
+    // Keep at least the newest asset even if it alone exceeds the budget
+    while (diskUsage > diskBudget && lruList.size() > 1)
+    {
+        auto& oldest = lruList.back();
+        oldest.file.deleteFile();
+        diskUsage -= oldest.bytes;
+        lruIndex.erase(oldest.key);
+        lruList.pop_back();
+    }
+}
+
+juce::File AudioAssetStore::getFile(const juce::String& key) const
+{
+    return assetDirectory.getChildFile(key + ASSET_FILE_EXTENSION);
+}
+
+} // namespace MAEVN
@@ -0,0 +1,136 @@
+/**
+ * @file AudioAssetStore.h
+ * @brief Content-addressed WAV files of rendered audio with a disk budget
+ *
+ * Rendered blocks are kept as WAV files named by a key that hashes
+ * everything they were made from. A request for audio that was rendered
+ * before is answered with the file that already exists, so a drag of an
+ * unchanged block hands the DAW that file at once, and reads go through a
+ * memory-mapped reader instead of a stream. The store tracks the bytes
+ * its files use and evicts the least recently used ones beyond a disk
+ * budget; use survives restarts through the files' access times.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Disk store of rendered audio keyed by content hash
+ *
+ * All methods are thread-safe; none of them are realtime-safe.
+ */
+class AudioAssetStore
+{
+public:
+    using Audio = std::shared_ptr<const juce::AudioBuffer<float>>;
+    
+    static constexpr juce::int64 DEFAULT_DISK_BUDGET = juce::int64(2) * 1024 * 1024 * 1024;
+    
+    explicit AudioAssetStore(const juce::File& directory);
+    ~AudioAssetStore();
+    
+    /**
+     * @brief Hash audio samples for use in a key (fast, not cryptographic)
+     * @return 16 hex digits
+     */
+    static juce::String hashAudio(const juce::AudioBuffer<float>& audio);
+    
+    /**
+     * @brief Get the file of a stored asset and mark it recently used
+     * @return juce::File() if the key is not stored
+     */
+    juce::File findFile(const juce::String& key);
+    
+    /**
+     * @brief Store audio under a key as a WAV file, unless it already is
+     * @param bitDepth 16, 24 or 32 (float)
+     * @return The asset's file, or juce::File() if it could not be written
+     */
+    juce::File store(const juce::String& key,
+                     const juce::AudioBuffer<float>& audio,
+                     double sampleRate,
+                     int bitDepth = 32);
+    
+    /**
+     * @brief Read a stored asset through a memory-mapped reader
+     * @return nullptr if the key is not stored or its file is unreadable
+     */
+    Audio read(const juce::String& key);
+    
+    /**
+     * @brief Delete one asset
+     */
+    void remove(const juce::String& key);
+    
+    /**
+     * @brief Delete every asset
+     */
+    void clear();
+    
+    /**
+     * @brief Set the store's directory and index the assets already in it
+     */
+    void setDirectory(const juce::File& directory);
+    juce::File getDirectory() const;
+    
+    /**
+     * @brief Set the disk budget in bytes (evicts immediately)
+     */
+    void setDiskBudget(juce::int64 bytes);
+    juce::int64 getDiskBudget() const;
+    
+    /**
+     * @brief Get the bytes currently used by the store's files
+     */
+    juce::int64 getDiskUsage() const;
+    
+    int getNumAssets() const;
+
+private:
+    struct Entry
+    {
+        juce::String key;
+        juce::File file;
+        juce::int64 bytes;
+    };
+    
+    // Most recently used first
+    std::list<Entry> lruList;
+    std::unordered_map<juce::String, std::list<Entry>::iterator> lruIndex;
+    juce::int64 diskUsage;
+    juce::int64 diskBudget;
+    
+    juce::File assetDirectory;
+    
+    mutable juce::CriticalSection storeLock;
+    
+    /**
+     * @brief Index the directory's files, most recently accessed first
+     */
+    void scanDirectory();
+    
+    /**
+     * @brief Add or refresh an entry at the front of the LRU list
+     */
+    void insertEntry(const juce::String& key, const juce::File& file);
+    
+    /**
+     * @brief Delete least recently used files until under the budget
+     */
+    void evictToBudget();
+    
+    juce::File getFile(const juce::String& key) const;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioAssetStore)
+};
+
+} // namespace MAEVN
@@ -0,0 +1,141 @@
+/**
+ * @file BandSplitter.cpp
+ * @brief Implementation of the shared three-band crossover
+ */
+
+#include "BandSplitter.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+BandSplitter::BandSplitter()
+    : lowCrossover(200.0f)
+    , highCrossover(4000.0f)
+    , numChannels(0)
+    , maxBlockSize(0)
+{
+    lowSplit.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
+    highSplit.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
+    lowAllpass.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+}
+
+void BandSplitter::prepare(double sampleRate, int maxBlock, int channels)
+{
+    numChannels = juce::jmax(1, channels);
+    maxBlockSize = juce::jmax(1, maxBlock);
+    
+    juce::dsp::ProcessSpec spec;
+    spec.sampleRate = sampleRate;
+    spec.maximumBlockSize = static_cast<juce::uint32>(maxBlockSize);
+    spec.numChannels = static_cast<juce::uint32>(numChannels);
+    
+    lowSplit.prepare(spec);
+    highSplit.prepare(spec);
+    lowAllpass.prepare(spec);
+    
+    lowCrossover = lowCrossoverTarget.load();
+    highCrossover = highCrossoverTarget.load();
+    updateCrossovers();
+    
+    storage.assign(static_cast<size_t>(NumBands * numChannels * maxBlockSize), 0.0f);
+    
+    for (int band = 0; band < NumBands; ++band)
+    {
+        std::vector<float*> pointers(static_cast<size_t>(numChannels));
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+            pointers[static_cast<size_t>(ch)] = storage.data() + (band * numChannels + ch) * maxBlockSize;
+        
+        bands[static_cast<size_t>(band)].setDataToReferTo(pointers.data(), numChannels, maxBlockSize);
+    }
+}
+
+void BandSplitter::reset()
+{
+    lowSplit.reset();
+    highSplit.reset();
+    lowAllpass.reset();
+}
+
+void BandSplitter::setCrossoverFrequencies(float lowHz, float highHz)
+{
+    const float low = juce::jlimit(20.0f, 2000.0f, lowHz);
+    lowCrossoverTarget.store(low);
+    highCrossoverTarget.store(juce::jlimit(low * 2.0f, 16000.0f, highHz));
+}
+
+void BandSplitter::updateCrossovers()
+{
+    lowSplit.setCutoffFrequency(lowCrossover);
+    highSplit.setCutoffFrequency(highCrossover);
+    lowAllpass.setCutoffFrequency(highCrossover);
+}
+
+//==============================================================================
+void BandSplitter::split(const juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    jassert(numSamples <= maxBlockSize);
+    numSamples = juce::jmin(numSamples, maxBlockSize);
+    
+    const float low = lowCrossoverTarget.load(std::memory_order_relaxed);
+    const float high = highCrossoverTarget.load(std::memory_order_relaxed);
+    if (low != lowCrossover || high != highCrossover)
+    {
+        lowCrossover = low;
+        highCrossover = high;
+        updateCrossovers();
+    }
+    
+    const int channels = juce::jmin(numChannels, buffer.getNumChannels());
+    
+    for (int ch = 0; ch < channels; ++ch)
+    {
+        const float* input = buffer.getReadPointer(ch);
+        float* lowBand = bands[Low].getWritePointer(ch);
+        float* midBand = bands[Mid].getWritePointer(ch);
+        float* highBand = bands[High].getWritePointer(ch);
+        
+        // Both splits and the compensation in one pass over the input
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float lowPart, upperPart, midPart, highPart;
+            lowSplit.processSample(ch, input[i], lowPart, upperPart);
+            highSplit.processSample(ch, upperPart, midPart, highPart);
+            
+            lowBand[i] = lowAllpass.processSample(ch, lowPart);
+            midBand[i] = midPart;
+            highBand[i] = highPart;
+        }
+    }
+    
+    // Channels the input does not have carry silence
+    for (int ch = channels; ch < numChannels; ++ch)
+        for (auto& band : bands)
+            band.clear(ch, 0, numSamples);
+    
+    lowSplit.snapToZero();
+    highSplit.snapToZero();
+    lowAllpass.snapToZero();
+}
+
+void BandSplitter::combine(juce::AudioBuffer<float>& buffer, int numSamples) const
+{
+    numSamples = juce::jmin(numSamples, maxBlockSize);
+    const int channels = juce::jmin(numChannels, buffer.getNumChannels());
+    
+    for (int ch = 0; ch < channels; ++ch)
+    {
+        float* output = buffer.getWritePointer(ch);
+        juce::FloatVectorOperations::add(output, bands[Low].getReadPointer(ch), bands[Mid].getReadPointer(ch), numSamples);
+        juce::FloatVectorOperations::add(output, bands[High].getReadPointer(ch), numSamples);
+    }
+}
+
+juce::dsp::AudioBlock<float> BandSplitter::getBandBlock(Band band, int numSamples)
+{
+    return juce::dsp::AudioBlock<float>(bands[static_cast<size_t>(band)])
+        .getSubBlock(0, static_cast<size_t>(juce::jmin(numSamples, maxBlockSize)));
+}
+
+} // namespace MAEVN
@@ -0,0 +1,107 @@
+/**
+ * @file BandSplitter.h
+ * @brief Three-band Linkwitz-Riley split into in-place band views
+ *
+ * The signal is split once into low, mid and high bands held in a single
+ * contiguous allocation. Band processors (compressors, imagers, shapers)
+ * then work on the views in place, and combine() sums them back into the
+ * output. Nothing is copied per block besides the split and the sum.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief LR4 crossover with allpass phase compensation of the low band
+ *
+ * The three bands sum to an allpass of the input (flat magnitude). split()
+ * and combine() belong to the audio thread; setCrossoverFrequencies() may
+ * be called from any thread.
+ */
+class BandSplitter
+{
+public:
+    enum Band
+    {
+        Low,
+        Mid,
+        High,
+        NumBands
+    };
+    
+    BandSplitter();
+    
+    /**
+     * @brief Allocate band storage (call outside the audio callback)
+     */
+    void prepare(double sampleRate, int maxBlockSize, int numChannels);
+    
+    /**
+     * @brief Clear the crossover filter state
+     */
+    void reset();
+    
+    /**
+     * @brief Set both crossover points; applied at the next split()
+     */
+    void setCrossoverFrequencies(float lowHz, float highHz);
+    
+    float getLowCrossoverFrequency() const { return lowCrossoverTarget.load(); }
+    float getHighCrossoverFrequency() const { return highCrossoverTarget.load(); }
+    
+    /**
+     * @brief Split numSamples of every prepared channel into the band views
+     */
+    void split(const juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    /**
+     * @brief Write the sum of the bands over the first numSamples of buffer
+     */
+    void combine(juce::AudioBuffer<float>& buffer, int numSamples) const;
+    
+    /**
+     * @brief A band's view; samples past the last split() are stale
+     */
+    juce::AudioBuffer<float>& getBand(Band band) { return bands[static_cast<size_t>(band)]; }
+    
+    /**
+     * @brief The first numSamples of a band, for juce::dsp processors
+     */
+    juce::dsp::AudioBlock<float> getBandBlock(Band band, int numSamples);
+    
+    int getNumChannels() const { return numChannels; }
+
+private:
+    juce::dsp::LinkwitzRileyFilter<float> lowSplit;
+    juce::dsp::LinkwitzRileyFilter<float> highSplit;
+    juce::dsp::LinkwitzRileyFilter<float> lowAllpass;   // matches the low band's phase to the high split
+    
+    // [band][channel][sample] in one block; the views point into it
+    std::vector<float> storage;
+    std::array<juce::AudioBuffer<float>, NumBands> bands;
+    
+    std::atomic<float> lowCrossoverTarget { 200.0f };
+    std::atomic<float> highCrossoverTarget { 4000.0f };
+    
+    // Audio thread: frequencies the filters are set to
+    float lowCrossover;
+    float highCrossover;
+    
+    int numChannels;
+    int maxBlockSize;
+    
+    void updateCrossovers();
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BandSplitter)
+};
+
+} // namespace MAEVN
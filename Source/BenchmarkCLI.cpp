@@ -0,0 +1,775 @@
+/**
+ * @file BenchmarkCLI.cpp
+ * @brief Offline benchmark suite for DSP modules, chains and models (MAEVN_Benchmarks)
+ *
+ * Drives every DSP module, enhancer stage and preset, FX engine mode and
+ * model role, the stage script parser and the sequencer over the block
+ * sizes, sample rates and channel counts the plugin runs at:
+ *
+ *     MAEVN_Benchmarks [options]
+ *
+ *     --out=<file.json>       Write the results here
+ *     --baseline=<file.json>  Compare against a stored run
+ *     --tolerance=<percent>   Slowdown that counts as a regression (default 10)
+ *     --models=<dir>          Directory holding the models' config.json (model cases need it)
+ *     --ai-role=<role>        Model role of the FX engine's AI effect (default: first loaded)
+ *     --filter=<text>         Only run cases whose name contains text
+ *     --seconds=<s>           Audio per measurement (default 0.5)
+ *     --repeats=<n>           Measurements per result; the fastest counts (default 3)
+ *     --quick                 512-sample stereo blocks at 48 kHz only
+ *
+ * Each result reports ns per sample (per parse for the script cases), the
+ * realtime factor and the heap allocations the processing thread made in
+ * the timed blocks. The exit code is the number of regressions against
+ * the baseline: results slower by more than the tolerance, or allocating
+ * where the baseline did not.
+ */
+
+#include <JuceHeader.h>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <new>
+#include <vector>
+#include "Utilities.h"
+#include "DSPModules.h"
+#include "CinematicAudioEnhancer.h"
+#include "AIFXEngine.h"
+#include "OnnxEngine.h"
+#include "PatternEngine.h"
+#include "InstrumentSequencer.h"
+
+//==============================================================================
+// Allocation counting: every heap allocation of the calling thread
+//==============================================================================
+
+namespace
+{
+    thread_local juce::int64 threadAllocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+    ++threadAllocations;
+    
+    if (auto* memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+    
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept                 { std::free(memory); }
+void operator delete[](void* memory) noexcept               { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept    { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept  { std::free(memory); }
+
+namespace
+{
+
+using namespace MAEVN;
+
+constexpr int BLOCK_SIZES[] = { 32, 64, 128, 256, 512, 1024, 2048 };
+constexpr double SAMPLE_RATES[] = { 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+constexpr int CHANNEL_COUNTS[] = { 1, 2 };
+
+// Untimed blocks first, so lazy setup (chain swaps, tensor binding) is not measured
+constexpr int WARMUP_BLOCKS = 8;
+
+constexpr int RESULTS_FORMAT_VERSION = 1;
+
+/**
+ * @brief Processes one block in place; false if the block failed
+ */
+using Processor = std::function<bool(juce::AudioBuffer<float>&)>;
+
+struct AudioCase
+{
+    juce::String name;
+    
+    // Returns nullptr when the case cannot run in this configuration
+    std::function<Processor(double sampleRate, int blockSize, int numChannels)> create;
+    
+    bool usesChannels = true;   // false: runs at one channel count only
+};
+
+struct Options
+{
+    juce::Array<int> blockSizes;
+    juce::Array<double> sampleRates;
+    juce::Array<int> channelCounts;
+    juce::String filter;
+    double seconds = 0.5;
+    int repeats = 3;
+};
+
+struct Result
+{
+    juce::String name;
+    int blockSize = 0;
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    bool perSample = true;          // false: nanoseconds are per call
+    double nanoseconds = 0.0;
+    double realtimeFactor = 0.0;
+    double allocationsPerBlock = 0.0;
+    bool failed = false;
+    
+    juce::String getKey() const
+    {
+        return name + "@" + juce::String(blockSize) + "/" + juce::String(sampleRate, 0) + "/" + juce::String(numChannels);
+    }
+};
+
+//==============================================================================
+/**
+ * @brief A second of -12 dBFS noise over a 220 Hz tone, cut into whole blocks
+ */
+juce::AudioBuffer<float> makeTestSignal(double sampleRate, int blockSize, int numChannels)
+{
+    const int numBlocks = juce::jmax(1, static_cast<int>(sampleRate) / blockSize);
+    juce::AudioBuffer<float> signal(numChannels, numBlocks * blockSize);
+    juce::Random random(0x4d41);
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* data = signal.getWritePointer(ch);
+        for (int i = 0; i < signal.getNumSamples(); ++i)
+        {
+            const auto tone = std::sin(juce::MathConstants<double>::twoPi * 220.0 * i / sampleRate);
+            data[i] = 0.125f * static_cast<float>(tone) + 0.125f * (random.nextFloat() * 2.0f - 1.0f);
+        }
+    }
+    
+    return signal;
+}
+
+/**
+ * @brief Two seconds of decaying noise, as a stand-in hall impulse response
+ */
+juce::AudioBuffer<float> makeImpulseResponse(double sampleRate)
+{
+    juce::AudioBuffer<float> impulse(2, static_cast<int>(2.0 * sampleRate));
+    juce::Random random(0x4952);
+    
+    for (int ch = 0; ch < impulse.getNumChannels(); ++ch)
+    {
+        auto* data = impulse.getWritePointer(ch);
+        for (int i = 0; i < impulse.getNumSamples(); ++i)
+            data[i] = (random.nextFloat() * 2.0f - 1.0f) * std::exp(-3.0f * static_cast<float>(i / sampleRate));
+    }
+    
+    return impulse;
+}
+
+//==============================================================================
+/**
+ * @brief A module from DSPModules.h (prepare(ProcessSpec), process(buffer))
+ */
+template <typename Module>
+AudioCase moduleCase(const juce::String& name, std::function<void(Module&, double)> setup = {})
+{
+    return { name, [setup](double sampleRate, int blockSize, int numChannels) -> Processor
+    {
+        auto module = std::make_shared<Module>();
+        if (setup)
+            setup(*module, sampleRate);
+        
+        module->prepare({ sampleRate, static_cast<juce::uint32>(blockSize), static_cast<juce::uint32>(numChannels) });
+        
+        return [module](juce::AudioBuffer<float>& buffer)
+        {
+            module->process(buffer);
+            return true;
+        };
+    } };
+}
+
+/**
+ * @brief A CinematicAudioEnhancer stage (prepare(rate, block), process(buffer, n))
+ */
+template <typename Stage>
+AudioCase stageCase(const juce::String& name, std::function<void(Stage&, double)> setup = {})
+{
+    return { name, [setup](double sampleRate, int blockSize, int) -> Processor
+    {
+        auto stage = std::make_shared<Stage>();
+        stage->prepare(sampleRate, blockSize);
+        
+        if (setup)
+            setup(*stage, sampleRate);
+        
+        return [stage](juce::AudioBuffer<float>& buffer)
+        {
+            stage->process(buffer, buffer.getNumSamples());
+            return true;
+        };
+    } };
+}
+
+AudioCase enhancerCase(const juce::String& name, std::function<void(CinematicAudioEnhancer&)> setup)
+{
+    return { name, [setup](double sampleRate, int blockSize, int) -> Processor
+    {
+        auto enhancer = std::make_shared<CinematicAudioEnhancer>();
+        enhancer->prepare(sampleRate, blockSize);
+        setup(*enhancer);
+        
+        return [enhancer](juce::AudioBuffer<float>& buffer)
+        {
+            enhancer->process(buffer, buffer.getNumSamples());
+            return true;
+        };
+    } };
+}
+
+AudioCase fxEngineCase(const juce::String& name, FXMode mode, OnnxEngine& onnxEngine, const juce::String& aiRole)
+{
+    return { name, [mode, &onnxEngine, aiRole](double sampleRate, int blockSize, int) -> Processor
+    {
+        auto engine = std::make_shared<AIFXEngine>(&onnxEngine);
+        engine->prepare(sampleRate, blockSize);
+        
+        // The default vocal chain, plus the AI effect the AI and Hybrid modes add
+        engine->addDSPEffect(0, std::make_unique<CompressorEffect>());
+        engine->addDSPEffect(0, std::make_unique<EQEffect>());
+        engine->addDSPEffect(0, std::make_unique<ReverbEffect>());
+        engine->addDSPEffect(0, std::make_unique<LimiterEffect>());
+        engine->addAIEffect(0, aiRole);
+        engine->setFXMode(0, mode);
+        
+        return [engine](juce::AudioBuffer<float>& buffer)
+        {
+            engine->process(buffer, buffer.getNumSamples(), 0);
+            return true;
+        };
+    } };
+}
+
+/**
+ * @brief One role through the vector API, with the tensor layout AIEffect uses
+ */
+AudioCase inferenceCase(OnnxEngine& onnxEngine, const juce::String& role)
+{
+    return { "onnx/" + role + "/runInference", [&onnxEngine, role](double, int blockSize, int numChannels) -> Processor
+    {
+        struct State
+        {
+            std::vector<float> input, output;
+            std::vector<int64_t> shape;
+        };
+        
+        auto state = std::make_shared<State>();
+        state->input.resize(static_cast<size_t>(numChannels * blockSize));
+        state->output.reserve(state->input.size());
+        state->shape = { 1, numChannels, blockSize };
+        
+        return [&onnxEngine, role, state](juce::AudioBuffer<float>& buffer)
+        {
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                std::copy(buffer.getReadPointer(ch), buffer.getReadPointer(ch) + buffer.getNumSamples(),
+                          state->input.begin() + ch * buffer.getNumSamples());
+            
+            return onnxEngine.runInference(role, state->input, state->shape, state->output);
+        };
+    } };
+}
+
+/**
+ * @brief One role through the pre-bound zero-copy path
+ */
+AudioCase inPlaceInferenceCase(OnnxEngine& onnxEngine, const juce::String& role)
+{
+    return { "onnx/" + role + "/inPlace", [&onnxEngine, role](double, int blockSize, int numChannels) -> Processor
+    {
+        if (!onnxEngine.prepareInPlaceInference(role, numChannels, blockSize))
+            return nullptr;
+        
+        return [&onnxEngine, role](juce::AudioBuffer<float>& buffer)
+        {
+            return onnxEngine.runInferenceInPlace(role,
+                                                  buffer.getArrayOfReadPointers(),
+                                                  buffer.getArrayOfWritePointers(),
+                                                  buffer.getNumChannels(),
+                                                  buffer.getNumSamples());
+        };
+    } };
+}
+
+AudioCase sequencerCase(const juce::String& name, std::function<SequencerPattern()> makePattern)
+{
+    AudioCase audioCase { name, [makePattern](double sampleRate, int, int) -> Processor
+    {
+        struct State
+        {
+            InstrumentSequencer sequencer;
+            juce::MidiBuffer midi;
+        };
+        
+        auto state = std::make_shared<State>();
+        state->sequencer.setBPM(140.0);
+        state->sequencer.setPattern(makePattern());
+        state->sequencer.start();
+        state->midi.ensureSize(16384);
+        
+        return [state, sampleRate](juce::AudioBuffer<float>& buffer)
+        {
+            state->midi.clear();
+            state->sequencer.processBlock(state->midi, buffer.getNumSamples(), sampleRate);
+            return true;
+        };
+    } };
+    
+    audioCase.usesChannels = false;
+    return audioCase;
+}
+
+//==============================================================================
+std::vector<AudioCase> createAudioCases(OnnxEngine& onnxEngine, const juce::String& aiRole)
+{
+    using namespace dspmodules;
+    
+    std::vector<AudioCase> cases;
+    
+    // DSPModules.h
+    cases.push_back(moduleCase<dspmodules::MultibandCompressor>("dsp/MultibandCompressor"));
+    cases.push_back(moduleCase<TransientShaper>("dsp/TransientShaper", [](TransientShaper& m, double)
+    {
+        m.setAttack(0.5f);
+        m.setSustain(-0.3f);
+    }));
+    cases.push_back(moduleCase<DeEsser>("dsp/DeEsser", [](DeEsser& m, double) { m.setThreshold(-30.0f); }));
+    cases.push_back(moduleCase<Saturation>("dsp/Saturation", [](Saturation& m, double) { m.setDrive(0.6f); }));
+    cases.push_back(moduleCase<Saturation>("dsp/Saturation/4x", [](Saturation& m, double)
+    {
+        m.setDrive(0.6f);
+        m.setOversamplingFactor(4);
+    }));
+    cases.push_back(moduleCase<StereoWidener>("dsp/StereoWidener", [](StereoWidener& m, double) { m.setWidth(1.5f); }));
+    cases.push_back(moduleCase<Limiter>("dsp/Limiter", [](Limiter& m, double) { m.setThreshold(-6.0f); }));
+    cases.push_back(moduleCase<PTHVocalClone>("dsp/PTHVocalClone", [](PTHVocalClone& m, double)
+    {
+        m.setPitchCorrection(2.0f);
+    }));
+    cases.push_back(moduleCase<PTHVocalClone>("dsp/PTHVocalClone/harmony", [](PTHVocalClone& m, double)
+    {
+        m.setHarmonyEnabled(true);
+        m.setHarmonyVoice(0, 4.0f);
+        m.setHarmonyVoice(1, 7.0f);
+    }));
+    cases.push_back(moduleCase<EpicSpaceReverb>("dsp/EpicSpaceReverb"));
+    cases.push_back(moduleCase<EpicSpaceReverb>("dsp/EpicSpaceReverb/convolution", [](EpicSpaceReverb& m, double sampleRate)
+    {
+        m.setMode(ReverbMode::Convolution);
+        m.loadImpulseResponse(makeImpulseResponse(sampleRate), sampleRate);
+    }));
+    
+    // CinematicAudioEnhancer stages
+    cases.push_back(stageCase<HighPassFilter>("enhancer/HighPassFilter"));
+    cases.push_back(stageCase<PresenceEQ>("enhancer/PresenceEQ"));
+    cases.push_back(stageCase<GentleCompressor>("enhancer/GentleCompressor"));
+    cases.push_back(stageCase<CinematicReverb>("enhancer/CinematicReverb"));
+    cases.push_back(stageCase<CinematicReverb>("enhancer/CinematicReverb/convolution", [](CinematicReverb& s, double sampleRate)
+    {
+        s.setMode(ReverbMode::Convolution);
+        s.loadImpulseResponse(makeImpulseResponse(sampleRate), sampleRate);
+    }));
+    cases.push_back(stageCase<SubtleDelay>("enhancer/SubtleDelay"));
+    cases.push_back(stageCase<ModulationEffect>("enhancer/ModulationEffect"));
+    cases.push_back(stageCase<WarmSaturation>("enhancer/WarmSaturation"));
+    cases.push_back(stageCase<MasteringBands>("enhancer/MasteringBands"));
+    cases.push_back(stageCase<LoudnessNormalizer>("enhancer/LoudnessNormalizer"));
+    cases.push_back(stageCase<FinalLimiter>("enhancer/FinalLimiter"));
+    
+    // CinematicAudioEnhancer presets and the chain with every stage on
+    cases.push_back(enhancerCase("enhancer/preset/CinematicVocal",
+                                 [](CinematicAudioEnhancer& e) { e.applyCinematicVocalPreset(); }));
+    cases.push_back(enhancerCase("enhancer/preset/CinematicMastering",
+                                 [](CinematicAudioEnhancer& e) { e.applyCinematicMasteringPreset(); }));
+    cases.push_back(enhancerCase("enhancer/preset/ViralAppeal",
+                                 [](CinematicAudioEnhancer& e) { e.applyViralAppealPreset(); }));
+    cases.push_back(enhancerCase("enhancer/allStages", [](CinematicAudioEnhancer& e)
+    {
+        auto parameters = e.getParameters();
+        parameters.highPassEnabled = parameters.presenceEQEnabled = parameters.vocalCompressorEnabled = true;
+        parameters.cinematicReverbEnabled = parameters.subtleDelayEnabled = parameters.modulationEnabled = true;
+        parameters.saturationEnabled = parameters.multibandCompressorEnabled = parameters.stereoImagerEnabled = true;
+        parameters.loudnessNormalizerEnabled = parameters.finalLimiterEnabled = true;
+        e.setParameters(parameters);
+    }));
+    
+    // AIFXEngine modes
+    cases.push_back(fxEngineCase("aifx/DSP", FXMode::DSP, onnxEngine, aiRole));
+    cases.push_back(fxEngineCase("aifx/AI", FXMode::AI, onnxEngine, aiRole));
+    cases.push_back(fxEngineCase("aifx/Hybrid", FXMode::Hybrid, onnxEngine, aiRole));
+    
+    // Every loaded model role
+    for (const auto& role : onnxEngine.getLoadedModels())
+    {
+        cases.push_back(inferenceCase(onnxEngine, role));
+        cases.push_back(inPlaceInferenceCase(onnxEngine, role));
+    }
+    
+    // InstrumentSequencer
+    cases.push_back(sequencerCase("sequencer/trapHiHat", []
+    {
+        return HiHatRollGenerator().generateTrapPattern(64, 0.9f, 0.5f);
+    }));
+    cases.push_back(sequencerCase("sequencer/trap808", []
+    {
+        return Bass808GlideGenerator().generateTrap808(64, 36);
+    }));
+    
+    return cases;
+}
+
+//==============================================================================
+bool measureAudio(const AudioCase& audioCase, double sampleRate, int blockSize, int numChannels,
+                  const Options& options, Result& result)
+{
+    auto process = audioCase.create(sampleRate, blockSize, numChannels);
+    if (process == nullptr)
+        return false;
+    
+    result.name = audioCase.name;
+    result.blockSize = blockSize;
+    result.sampleRate = sampleRate;
+    result.numChannels = numChannels;
+    
+    const auto signal = makeTestSignal(sampleRate, blockSize, numChannels);
+    const int numSignalBlocks = signal.getNumSamples() / blockSize;
+    const int numBlocks = juce::jmax(1, juce::roundToInt(options.seconds * sampleRate / blockSize));
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    
+    // The copy of the input is timed with the block; it is a memcpy next to the processing
+    const auto runBlock = [&](int block)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            buffer.copyFrom(ch, 0, signal, ch, (block % numSignalBlocks) * blockSize, blockSize);
+        
+        return process(buffer);
+    };
+    
+    for (int block = 0; block < WARMUP_BLOCKS; ++block)
+        result.failed |= !runBlock(block);
+    
+    double fastestSeconds = std::numeric_limits<double>::max();
+    juce::int64 allocations = 0;
+    
+    for (int repeat = 0; repeat < options.repeats && !result.failed; ++repeat)
+    {
+        const auto allocationsBefore = threadAllocations;
+        const auto start = juce::Time::getHighResolutionTicks();
+        
+        for (int block = 0; block < numBlocks && !result.failed; ++block)
+            result.failed |= !runBlock(block);
+        
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        allocations += threadAllocations - allocationsBefore;
+        fastestSeconds = juce::jmin(fastestSeconds, seconds);
+    }
+    
+    if (result.failed)
+        return true;
+    
+    const double numSamples = static_cast<double>(numBlocks) * blockSize;
+    result.nanoseconds = fastestSeconds * 1.0e9 / numSamples;
+    result.realtimeFactor = (numSamples / sampleRate) / fastestSeconds;
+    result.allocationsPerBlock = static_cast<double>(allocations) / (static_cast<double>(numBlocks) * options.repeats);
+    return true;
+}
+
+/**
+ * @brief A stage script of numLines lines cycling through every block tag
+ */
+juce::String makeStageScript(int numLines, int variant)
+{
+    static const char* const tags[] = { "INTRO", "VERSE", "HOOK", "808", "HIHAT", "SNARE",
+                                        "PIANO", "SYNTH", "BRIDGE", "VOCAL", "OUTRO" };
+    juce::StringArray lines;
+    
+    for (int i = 0; i < numLines; ++i)
+        lines.add("[" + juce::String(tags[i % juce::numElementsInArray(tags)]) + "] line " + juce::String(i)
+                  + " take " + juce::String(variant) + " duration:" + juce::String(1 + i % 4) + ".0");
+    
+    return lines.joinIntoString("\n");
+}
+
+/**
+ * @brief Time parseStageScript() on whole rewrites or on one edited line
+ */
+juce::String getParseCaseName(int numLines, bool editOneLine)
+{
+    return juce::String("pattern/parseStageScript/") + (editOneLine ? "editLine" : "full")
+         + "/" + juce::String(numLines) + "lines";
+}
+
+Result measureParse(int numLines, bool editOneLine, const Options& options)
+{
+    Result result;
+    result.name = getParseCaseName(numLines, editOneLine);
+    result.perSample = false;
+    
+    // Alternating between two scripts makes every call a full or a one-line change
+    juce::String scripts[2] = { makeStageScript(numLines, 0), makeStageScript(numLines, 1) };
+    if (editOneLine)
+    {
+        auto lines = juce::StringArray::fromLines(scripts[0]);
+        lines.set(numLines / 2, lines[numLines / 2] + " edited");
+        scripts[1] = lines.joinIntoString("\n");
+    }
+    
+    PatternEngine patternEngine;
+    patternEngine.parseStageScript(scripts[1]);
+    
+    const int numCalls = juce::jmax(2, juce::roundToInt(options.seconds * 200.0));
+    double fastestSeconds = std::numeric_limits<double>::max();
+    juce::int64 allocations = 0;
+    
+    for (int repeat = 0; repeat < options.repeats; ++repeat)
+    {
+        const auto allocationsBefore = threadAllocations;
+        const auto start = juce::Time::getHighResolutionTicks();
+        
+        for (int call = 0; call < numCalls; ++call)
+            patternEngine.parseStageScript(scripts[call % 2]);
+        
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        allocations += threadAllocations - allocationsBefore;
+        fastestSeconds = juce::jmin(fastestSeconds, seconds);
+    }
+    
+    result.nanoseconds = fastestSeconds * 1.0e9 / numCalls;
+    result.allocationsPerBlock = static_cast<double>(allocations) / (static_cast<double>(numCalls) * options.repeats);
+    return result;
+}
+
+//==============================================================================
+juce::var resultToVar(const Result& result)
+{
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty("name", result.name);
+    
+    if (result.perSample)
+    {
+        obj->setProperty("blockSize", result.blockSize);
+        obj->setProperty("sampleRate", result.sampleRate);
+        obj->setProperty("channels", result.numChannels);
+    }
+    
+    if (result.failed)
+    {
+        obj->setProperty("failed", true);
+        return juce::var(obj);
+    }
+    
+    obj->setProperty(result.perSample ? "nsPerSample" : "nsPerCall", result.nanoseconds);
+    if (result.perSample)
+        obj->setProperty("realtimeFactor", result.realtimeFactor);
+    obj->setProperty(result.perSample ? "allocationsPerBlock" : "allocationsPerCall", result.allocationsPerBlock);
+    
+    return juce::var(obj);
+}
+
+juce::var resultsToVar(const std::vector<Result>& results)
+{
+    juce::Array<juce::var> array;
+    for (const auto& result : results)
+        array.add(resultToVar(result));
+    
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty("version", RESULTS_FORMAT_VERSION);
+    obj->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    obj->setProperty("cpu", juce::SystemStats::getCpuModel());
+    obj->setProperty("cores", juce::SystemStats::getNumPhysicalCpus());
+    obj->setProperty("results", array);
+    return juce::var(obj);
+}
+
+/**
+ * @brief Report regressions against a stored run
+ * @return The number of regressions
+ */
+int compareWithBaseline(const std::vector<Result>& results, const juce::File& baselineFile, double tolerance)
+{
+    const auto baseline = juce::JSON::parse(baselineFile);
+    if (baseline["results"].getArray() == nullptr)
+    {
+        std::cout << "Could not read baseline " << baselineFile.getFullPathName() << "\n";
+        return 1;
+    }
+    
+    std::map<juce::String, juce::var> baselineResults;
+    for (const auto& entry : *baseline["results"].getArray())
+    {
+        Result key;
+        key.name = entry["name"].toString();
+        key.blockSize = entry["blockSize"];
+        key.sampleRate = entry["sampleRate"];
+        key.numChannels = entry["channels"];
+        baselineResults[key.getKey()] = entry;
+    }
+    
+    int numRegressions = 0, numCompared = 0;
+    
+    for (const auto& result : results)
+    {
+        auto it = baselineResults.find(result.getKey());
+        if (it == baselineResults.end() || result.failed)
+            continue;
+        
+        const auto& entry = it->second;
+        const double before = entry[result.perSample ? "nsPerSample" : "nsPerCall"];
+        const double allocationsBefore = entry[result.perSample ? "allocationsPerBlock" : "allocationsPerCall"];
+        ++numCompared;
+        
+        if (before > 0.0 && result.nanoseconds > before * (1.0 + tolerance))
+        {
+            std::cout << "REGRESSION " << result.getKey() << ": " << juce::String(before, 2) << " -> "
+                      << juce::String(result.nanoseconds, 2) << " ns (+"
+                      << juce::String((result.nanoseconds / before - 1.0) * 100.0, 1) << "%)\n";
+            ++numRegressions;
+        }
+        
+        if (allocationsBefore == 0.0 && result.allocationsPerBlock > 0.0)
+        {
+            std::cout << "REGRESSION " << result.getKey() << ": now allocates ("
+                      << juce::String(result.allocationsPerBlock, 2) << " per block)\n";
+            ++numRegressions;
+        }
+    }
+    
+    std::cout << numRegressions << " regressions in " << numCompared << " results compared with "
+              << baselineFile.getFileName() << "\n";
+    return numRegressions;
+}
+
+void printResult(const Result& result)
+{
+    std::cout << result.getKey().paddedRight(' ', 64) << " ";
+    
+    if (result.failed)
+        std::cout << "FAILED\n";
+    else if (result.perSample)
+        std::cout << juce::String(result.nanoseconds, 2) << " ns/sample, "
+                  << juce::String(result.realtimeFactor, 1) << "x realtime, "
+                  << juce::String(result.allocationsPerBlock, 2) << " allocs/block\n";
+    else
+        std::cout << juce::String(result.nanoseconds / 1000.0, 1) << " us/parse, "
+                  << juce::String(result.allocationsPerBlock, 0) << " allocs/parse\n";
+}
+
+void printUsage()
+{
+    std::cout << "Usage: MAEVN_Benchmarks [options]\n"
+                 "  --out=<file.json>  --baseline=<file.json>  --tolerance=<percent>  --models=<dir>\n"
+                 "  --ai-role=<role>  --filter=<text>  --seconds=<s>  --repeats=<n>  --quick\n";
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+    
+    if (args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+    
+    const auto valueOf = [&args](const char* option, const juce::String& fallback)
+    {
+        const auto value = args.getValueForOption(option);
+        return value.isNotEmpty() ? value : fallback;
+    };
+    
+    Options options;
+    options.filter = args.getValueForOption("--filter");
+    options.seconds = juce::jmax(0.01, valueOf("--seconds", "0.5").getDoubleValue());
+    options.repeats = juce::jmax(1, valueOf("--repeats", "3").getIntValue());
+    
+    if (args.containsOption("--quick"))
+    {
+        options.blockSizes = { 512 };
+        options.sampleRates = { 48000.0 };
+        options.channelCounts = { 2 };
+    }
+    else
+    {
+        options.blockSizes.addArray(BLOCK_SIZES, juce::numElementsInArray(BLOCK_SIZES));
+        options.sampleRates.addArray(SAMPLE_RATES, juce::numElementsInArray(SAMPLE_RATES));
+        options.channelCounts.addArray(CHANNEL_COUNTS, juce::numElementsInArray(CHANNEL_COUNTS));
+    }
+    
+    // Models load up front and blocking, so no case measures a load
+    OnnxEngine onnxEngine;
+    onnxEngine.initialize();
+    
+    if (args.containsOption("--models"))
+    {
+        const auto configFile = juce::File::getCurrentWorkingDirectory()
+                                    .getChildFile(args.getValueForOption("--models"))
+                                    .getChildFile("config.json");
+        const int numLoaded = onnxEngine.loadModelsFromConfig(configFile.getFullPathName(), ModelLoadPolicy::Blocking);
+        std::cout << "Loaded " << numLoaded << " models from " << configFile.getFullPathName() << "\n";
+    }
+    
+    // Without a model the AI effect measures the engine's bypass
+    const auto loadedModels = onnxEngine.getLoadedModels();
+    const auto aiRole = valueOf("--ai-role", loadedModels.isEmpty() ? juce::String("none") : loadedModels[0]);
+    
+    std::vector<Result> results;
+    const auto record = [&results](const Result& result)
+    {
+        printResult(result);
+        results.push_back(result);
+    };
+    
+    for (const auto& audioCase : createAudioCases(onnxEngine, aiRole))
+    {
+        if (options.filter.isNotEmpty() && !audioCase.name.contains(options.filter))
+            continue;
+        
+        for (const auto sampleRate : options.sampleRates)
+            for (const auto blockSize : options.blockSizes)
+                for (const auto numChannels : options.channelCounts)
+                {
+                    if (!audioCase.usesChannels && numChannels != options.channelCounts.getLast())
+                        continue;
+                    
+                    Result result;
+                    if (measureAudio(audioCase, sampleRate, blockSize, numChannels, options, result))
+                        record(result);
+                }
+    }
+    
+    for (const int numLines : { 16, 256 })
+        for (const bool editOneLine : { false, true })
+            if (options.filter.isEmpty() || getParseCaseName(numLines, editOneLine).contains(options.filter))
+                record(measureParse(numLines, editOneLine, options));
+    
+    if (args.containsOption("--out"))
+    {
+        const auto outFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--out"));
+        if (!outFile.replaceWithText(juce::JSON::toString(resultsToVar(results))))
+            std::cout << "Could not write " << outFile.getFullPathName() << "\n";
+        else
+            std::cout << "Wrote " << results.size() << " results to " << outFile.getFullPathName() << "\n";
+    }
+    
+    if (!args.containsOption("--baseline"))
+        return 0;
+    
+    const auto tolerance = valueOf("--tolerance", "10").getDoubleValue() / 100.0;
+    const auto baselineFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--baseline"));
+    return compareWithBaseline(results, baselineFile, tolerance);
+}
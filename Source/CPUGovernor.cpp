@@ -0,0 +1,108 @@
+/**
+ * @file CPUGovernor.cpp
+ * @brief Implementation of the CPU-budget governor
+ */
+
+#include "CPUGovernor.h"
+
+namespace MAEVN
+{
+
+namespace
+{
+    // Indexed by QualityTier; plain strings so the audio thread can log them
+    constexpr const char* TIER_NAMES[static_cast<int>(QualityTier::NumTiers)] = {
+        "Full quality",
+        "AI effects bypassed",
+        "Reduced oversampling",
+        "Short reverb tail"
+    };
+}
+
+//==============================================================================
+CPUGovernor::CPUGovernor()
+    : secondsPerTick(1.0 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()))
+    , blockStartTicks(0)
+    , smoothedLoad(0.0f)
+    , secondsSinceChange(0.0)
+    , secondsBelowRestore(0.0)
+{
+}
+
+CPUGovernor::~CPUGovernor()
+{
+}
+
+void CPUGovernor::setBudget(float fractionOfDeadline)
+{
+    budget.store(juce::jlimit(0.1f, 1.0f, fractionOfDeadline), std::memory_order_relaxed);
+}
+
+//==============================================================================
+void CPUGovernor::beginBlock() noexcept
+{
+    blockStartTicks = juce::Time::getHighResolutionTicks();
+}
+
+QualityTier CPUGovernor::endBlock(int numSamples, double sampleRate, bool canDegrade) noexcept
+{
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return getTier();
+    
+    const double blockSeconds = numSamples / sampleRate;
+    const double elapsedSeconds = static_cast<double>(juce::Time::getHighResolutionTicks() - blockStartTicks) * secondsPerTick;
+    const auto blockLoad = static_cast<float>(elapsedSeconds / blockSeconds);
+    
+    // Peaks count at once; the load falls back slowly so one quiet block doesn't restore
+    const auto release = static_cast<float>(std::exp(-blockSeconds / LOAD_RELEASE_SECONDS));
+    smoothedLoad = blockLoad >= smoothedLoad ? blockLoad : blockLoad + (smoothedLoad - blockLoad) * release;
+    load.store(smoothedLoad, std::memory_order_relaxed);
+    
+    if (!canDegrade || !isEnabled())
+    {
+        setTier(0);
+        secondsSinceChange = 0.0;
+        secondsBelowRestore = 0.0;
+        return QualityTier::Full;
+    }
+    
+    const float currentBudget = getBudget();
+    const int currentTier = tier.load(std::memory_order_relaxed);
+    const int lastTier = static_cast<int>(QualityTier::NumTiers) - 1;
+    
+    secondsSinceChange += blockSeconds;
+    secondsBelowRestore = smoothedLoad < currentBudget * RESTORE_FRACTION ? secondsBelowRestore + blockSeconds : 0.0;
+    
+    if (smoothedLoad > currentBudget && currentTier < lastTier && secondsSinceChange >= DEGRADE_HOLD_SECONDS)
+    {
+        setTier(currentTier + 1);
+        numDegrades.fetch_add(1, std::memory_order_relaxed);
+        Logger::logRealtime(Logger::Level::Warning, Logger::Message::QualityReduced,
+                            TIER_NAMES[currentTier + 1], std::round(smoothedLoad * 100.0f));
+    }
+    else if (currentTier > 0 && secondsBelowRestore >= RESTORE_HOLD_SECONDS)
+    {
+        setTier(currentTier - 1);
+    }
+    
+    return getTier();
+}
+
+void CPUGovernor::setTier(int newTier) noexcept
+{
+    if (tier.exchange(newTier, std::memory_order_relaxed) == newTier)
+        return;
+    
+    secondsSinceChange = 0.0;
+    secondsBelowRestore = 0.0;
+}
+
+//==============================================================================
+juce::String CPUGovernor::getTierName(QualityTier tier)
+{
+    const int index = static_cast<int>(tier);
+    return juce::isPositiveAndBelow(index, static_cast<int>(QualityTier::NumTiers)) ? juce::String(TIER_NAMES[index])
+                                                                                   : juce::String();
+}
+
+} // namespace MAEVN
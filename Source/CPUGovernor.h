@@ -0,0 +1,117 @@
+/**
+ * @file CPUGovernor.h
+ * @brief Steps processing quality down under CPU pressure instead of dropping out
+ *
+ * The governor times every processBlock against its numSamples / sampleRate
+ * deadline. When the smoothed load goes over the instance's budget it moves
+ * one quality tier down, waiting DEGRADE_HOLD_SECONDS between steps so each
+ * one can take effect; once the load has stayed below RESTORE_FRACTION of
+ * the budget for RESTORE_HOLD_SECONDS it moves one tier back up. Tiers are
+ * cumulative and always shed work in the same order. Every lever the
+ * processor turns for a tier crossfades on its own and keeps its latency.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Quality tiers, each including the ones before it
+ */
+enum class QualityTier
+{
+    Full,                   // everything as set
+    AIFallback,             // AI and Hybrid tracks skip their AI effects
+    ReducedOversampling,    // saturation runs at 1x
+    ShortReverbTail,        // convolution reverb tail capped at SHORT_TAIL_SECONDS
+    NumTiers
+};
+
+//==============================================================================
+/**
+ * @brief Per-instance CPU budget and the tier it calls for
+ *
+ * beginBlock()/endBlock() are for the audio thread only; the setters and
+ * getters may be called from any thread.
+ */
+class CPUGovernor
+{
+public:
+    static constexpr float DEFAULT_BUDGET = 0.7f;           // share of each block's deadline
+    static constexpr float RESTORE_FRACTION = 0.6f;         // of the budget
+    static constexpr double DEGRADE_HOLD_SECONDS = 0.25;
+    static constexpr double RESTORE_HOLD_SECONDS = 3.0;
+    static constexpr double LOAD_RELEASE_SECONDS = 0.5;     // load rises at once, falls at this rate
+    static constexpr double SHORT_TAIL_SECONDS = 1.5;
+    
+    CPUGovernor();
+    ~CPUGovernor();
+    
+    /**
+     * @brief Turn the governor on or off (on by default; off runs at full quality)
+     */
+    void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Set the share of each block's deadline this instance may use
+     * @param fractionOfDeadline 0.1 - 1.0
+     */
+    void setBudget(float fractionOfDeadline);
+    float getBudget() const { return budget.load(std::memory_order_relaxed); }
+    
+    //==========================================================================
+    /**
+     * @brief Start timing a block (audio thread)
+     */
+    void beginBlock() noexcept;
+    
+    /**
+     * @brief Measure the block and pick the tier for the next one (audio thread)
+     * @param canDegrade false while rendering offline, where there is no deadline
+     */
+    QualityTier endBlock(int numSamples, double sampleRate, bool canDegrade) noexcept;
+    
+    //==========================================================================
+    QualityTier getTier() const { return static_cast<QualityTier>(tier.load(std::memory_order_relaxed)); }
+    
+    /**
+     * @brief Smoothed share of the deadline processBlock takes
+     */
+    float getLoad() const { return load.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Number of times the governor has moved down a tier
+     */
+    int getNumDegrades() const { return numDegrades.load(std::memory_order_relaxed); }
+    
+    static juce::String getTierName(QualityTier tier);
+
+private:
+    std::atomic<bool> enabled { true };
+    std::atomic<float> budget { DEFAULT_BUDGET };
+    const double secondsPerTick;
+    
+    // Published for the UI and the meters
+    std::atomic<int> tier { 0 };
+    std::atomic<float> load { 0.0f };
+    std::atomic<int> numDegrades { 0 };
+    
+    // Audio thread
+    juce::int64 blockStartTicks;
+    float smoothedLoad;
+    double secondsSinceChange;
+    double secondsBelowRestore;
+    
+    void setTier(int newTier) noexcept;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CPUGovernor)
+};
+
+} // namespace MAEVN
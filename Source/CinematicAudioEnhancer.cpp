@@ -8,6 +8,42 @@
 namespace MAEVN
 {
 
+namespace
+{
+    // Chorus centre delay plus modulation depth, with a little feedback
+    constexpr double MODULATION_TAIL_SECONDS = 0.05;
+    
+    // Longest band compressor release
+    constexpr double MULTIBAND_RELEASE_SECONDS = 0.1;
+    
+    // Normalizer: ignore input below the BS.1770 absolute gate, and follow
+    // loudness changes about as slowly as a 0.9/0.1 step once a second
+    constexpr float LOUDNESS_GATE_LUFS = -70.0f;
+    constexpr double GAIN_SMOOTHING_SECONDS = 9.5;
+    
+    /**
+     * @brief Run a stage unless its input has been silent for longer than its tail
+     * 
+     * inputSilent is updated to describe the stage's output. Output of a
+     * non-silent block is assumed non-silent without scanning it again.
+     */
+    template <typename StageType>
+    void processGated(StageType& stage, SilenceGate& gate, RealtimeProfiler* profiler, int profileStage,
+                      juce::AudioBuffer<float>& buffer, int numSamples, bool& inputSilent)
+    {
+        if (!gate.shouldProcess(inputSilent, numSamples, stage.getTailLengthSeconds()))
+            return;
+        
+        {
+            const RealtimeProfiler::ScopedTimer timer(profiler, profileStage);
+            stage.process(buffer, numSamples);
+        }
+        
+        if (inputSilent)
+            inputSilent = SilenceGate::isSilent(buffer, numSamples);
+    }
+}
+
 //==============================================================================
 // HighPassFilter Implementation
 //==============================================================================
@@ -18,26 +54,17 @@ HighPassFilter::HighPassFilter()
 {
 }
 
-void HighPassFilter::prepare(double sampleRate, int maxBlockSize)
+void HighPassFilter::prepare(double sampleRate, int /*maxBlockSize*/)
 {
     currentSampleRate = sampleRate;
     
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = static_cast<juce::uint32>(maxBlockSize);
-    spec.numChannels = 2;
-    
-    highPassFilter.prepare(spec);
     setCutoffFrequency(cutoffFreq);
+    highPassFilter.prepare(2);
 }
 
 void HighPassFilter::process(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), 
-                                        buffer.getNumChannels(), 
-                                        static_cast<size_t>(numSamples));
-    juce::dsp::ProcessContextReplacing<float> context(block);
-    highPassFilter.process(context);
+    highPassFilter.process(buffer, numSamples);
 }
 
 void HighPassFilter::reset()
@@ -48,8 +75,12 @@ void HighPassFilter::reset()
 void HighPassFilter::setCutoffFrequency(float frequency)
 {
     cutoffFreq = juce::jlimit(20.0f, 500.0f, frequency);
-    *highPassFilter.state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(
-        currentSampleRate, cutoffFreq);
+    highPassFilter.setCoefficients(BiquadCoefficients::makeHighPass(currentSampleRate, cutoffFreq));
+}
+
+double HighPassFilter::getTailLengthSeconds() const
+{
+    return FILTER_TAIL_SECONDS;
 }
 
 //==============================================================================
@@ -64,26 +95,17 @@ PresenceEQ::PresenceEQ()
 {
 }
 
-void PresenceEQ::prepare(double sampleRate, int maxBlockSize)
+void PresenceEQ::prepare(double sampleRate, int /*maxBlockSize*/)
 {
     currentSampleRate = sampleRate;
     
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = static_cast<juce::uint32>(maxBlockSize);
-    spec.numChannels = 2;
-    
-    presenceFilter.prepare(spec);
     updateCoefficients();
+    presenceFilter.prepare(2);
 }
 
 void PresenceEQ::process(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), 
-                                        buffer.getNumChannels(), 
-                                        static_cast<size_t>(numSamples));
-    juce::dsp::ProcessContextReplacing<float> context(block);
-    presenceFilter.process(context);
+    presenceFilter.process(buffer, numSamples);
 }
 
 void PresenceEQ::reset()
@@ -112,8 +134,13 @@ void PresenceEQ::setQ(float q)
 void PresenceEQ::updateCoefficients()
 {
     float gainLinear = dBToGain(gainDB);
-    *presenceFilter.state = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        currentSampleRate, frequency, qFactor, gainLinear);
+    presenceFilter.setCoefficients(BiquadCoefficients::makePeakFilter(
+        currentSampleRate, frequency, qFactor, gainLinear));
+}
+
+double PresenceEQ::getTailLengthSeconds() const
+{
+    return FILTER_TAIL_SECONDS;
 }
 
 //==============================================================================
@@ -122,6 +149,7 @@ void PresenceEQ::updateCoefficients()
 
 GentleCompressor::GentleCompressor()
     : currentSampleRate(44100.0)
+    , releaseMs(100.0f)
 {
     // Default gentle settings for natural vocals
     compressor.setThreshold(-18.0f);
@@ -134,21 +162,12 @@ void GentleCompressor::prepare(double sampleRate, int maxBlockSize)
 {
     currentSampleRate = sampleRate;
     
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = static_cast<juce::uint32>(maxBlockSize);
-    spec.numChannels = 2;
-    
-    compressor.prepare(spec);
+    compressor.prepare(sampleRate, maxBlockSize, 2);
 }
 
 void GentleCompressor::process(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), 
-                                        buffer.getNumChannels(), 
-                                        static_cast<size_t>(numSamples));
-    juce::dsp::ProcessContextReplacing<float> context(block);
-    compressor.process(context);
+    compressor.process(buffer, numSamples);
 }
 
 void GentleCompressor::reset()
@@ -173,7 +192,14 @@ void GentleCompressor::setAttack(float ms)
 
 void GentleCompressor::setRelease(float ms)
 {
-    compressor.setRelease(juce::jlimit(1.0f, 2000.0f, ms));
+    releaseMs = juce::jlimit(1.0f, 2000.0f, ms);
+    compressor.setRelease(releaseMs);
+}
+
+double GentleCompressor::getTailLengthSeconds() const
+{
+    // Silence in gives silence out; the release only lets the envelope settle
+    return releaseMs / 1000.0;
 }
 
 //==============================================================================
@@ -181,7 +207,8 @@ void GentleCompressor::setRelease(float ms)
 //==============================================================================
 
 CinematicReverb::CinematicReverb()
-    : preDelayMs(30.0f)
+    : activeMode(ReverbMode::Algorithmic)
+    , preDelayMs(30.0f)
     , currentSampleRate(44100.0)
 {
     // Large hall reverb defaults for cinematic feel
@@ -205,6 +232,12 @@ void CinematicReverb::prepare(double sampleRate, int maxBlockSize)
     reverb.prepare(spec);
     preDelayLine.prepare(spec);
     
+    convolver.prepare(sampleRate, maxBlockSize, 2);
+    updateDampingFilter();
+    dampingFilter.prepare(2);
+    wetBuffer.setSize(2, maxBlockSize);
+    activeMode = mode.load();
+    
     // Set pre-delay
     float delaySamples = static_cast<float>(preDelayMs * sampleRate / 1000.0);
     preDelayLine.setDelay(delaySamples);
@@ -228,15 +261,72 @@ void CinematicReverb::process(juce::AudioBuffer<float>& buffer, int numSamples)
         }
     }
     
+    // Whatever the other engine last heard is stale by now
+    const auto currentMode = mode.load();
+    if (currentMode != activeMode)
+    {
+        activeMode = currentMode;
+        if (activeMode == ReverbMode::Convolution)
+            convolver.clearHistory();
+        else
+            reverb.reset();
+    }
+    
+    if (activeMode == ReverbMode::Convolution)
+    {
+        processConvolution(buffer, numSamples);
+        return;
+    }
+    
     // Then apply reverb
     juce::dsp::ProcessContextReplacing<float> context(block);
     reverb.process(context);
 }
 
+void CinematicReverb::processConvolution(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), wetBuffer.getNumChannels());
+    numSamples = juce::jmin(numSamples, wetBuffer.getNumSamples());
+    
+    // Non-owning view of the first numChannels of the wet scratch buffer
+    juce::AudioBuffer<float> wet(wetBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+    for (int ch = 0; ch < numChannels; ++ch)
+        wet.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+    
+    convolver.process(wet, numSamples);
+    dampingFilter.process(wet, numSamples);
+    
+    // Same width law as juce::dsp::Reverb; levels are plain linear gains
+    const float dry = reverbParams.dryLevel;
+    const float wet1 = reverbParams.wetLevel * 0.5f * (1.0f + reverbParams.width);
+    const float wet2 = reverbParams.wetLevel * 0.5f * (1.0f - reverbParams.width);
+    
+    if (numChannels > 1)
+    {
+        float* left = buffer.getWritePointer(0);
+        float* right = buffer.getWritePointer(1);
+        const float* wetLeft = wet.getReadPointer(0);
+        const float* wetRight = wet.getReadPointer(1);
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            left[i] = left[i] * dry + wetLeft[i] * wet1 + wetRight[i] * wet2;
+            right[i] = right[i] * dry + wetRight[i] * wet1 + wetLeft[i] * wet2;
+        }
+    }
+    else if (numChannels == 1)
+    {
+        buffer.applyGain(0, 0, numSamples, dry);
+        buffer.addFrom(0, 0, wet, 0, 0, numSamples, reverbParams.wetLevel);
+    }
+}
+
 void CinematicReverb::reset()
 {
     reverb.reset();
     preDelayLine.reset();
+    convolver.reset();
+    dampingFilter.reset();
 }
 
 void CinematicReverb::setRoomSize(float size)
@@ -249,6 +339,14 @@ void CinematicReverb::setDamping(float damping)
 {
     reverbParams.damping = clamp(damping, 0.0f, 1.0f);
     reverb.setParameters(reverbParams);
+    updateDampingFilter();
+}
+
+void CinematicReverb::updateDampingFilter()
+{
+    // Higher damping = more high frequency absorption
+    const float cutoff = juce::jlimit(1000.0f, 20000.0f, 20000.0f - reverbParams.damping * 15000.0f);
+    dampingFilter.setCoefficients(BiquadCoefficients::makeLowPass(currentSampleRate, cutoff));
 }
 
 void CinematicReverb::setWetLevel(float level)
@@ -276,6 +374,14 @@ void CinematicReverb::setWidth(float width)
     reverb.setParameters(reverbParams);
 }
 
+double CinematicReverb::getTailLengthSeconds() const
+{
+    if (mode.load() == ReverbMode::Convolution)
+        return preDelayMs / 1000.0 + convolver.getImpulseLengthSeconds() + FILTER_TAIL_SECONDS;
+    
+    return preDelayMs / 1000.0 + getReverbTailSeconds(reverbParams.roomSize);
+}
+
 //==============================================================================
 // SubtleDelay Implementation
 //==============================================================================
@@ -353,6 +459,15 @@ void SubtleDelay::setMix(float mix)
     mixLevel = juce::jlimit(0.0f, 1.0f, mix);
 }
 
+double SubtleDelay::getTailLengthSeconds() const
+{
+    // Echoes until the feedback has decayed by 60 dB
+    const double echoes = feedbackAmount > 0.0f
+                        ? 1.0 + std::log(0.001) / std::log(static_cast<double>(feedbackAmount))
+                        : 1.0;
+    return delayTimeMs / 1000.0 * echoes;
+}
+
 //==============================================================================
 // ModulationEffect Implementation
 //==============================================================================
@@ -410,6 +525,11 @@ void ModulationEffect::setMix(float mix)
     chorus.setMix(juce::jlimit(0.0f, 1.0f, mix));
 }
 
+double ModulationEffect::getTailLengthSeconds() const
+{
+    return MODULATION_TAIL_SECONDS;
+}
+
 //==============================================================================
 // WarmSaturation Implementation
 //==============================================================================
@@ -418,52 +538,51 @@ WarmSaturation::WarmSaturation()
     : driveAmount(0.2f)
     , outputGainLinear(1.0f)
 {
+    setDrive(driveAmount);
+    shaper.setOutputGain(outputGainLinear);
 }
 
-void WarmSaturation::prepare(double /*sampleRate*/, int /*maxBlockSize*/)
+void WarmSaturation::prepare(double sampleRate, int maxBlockSize)
 {
-    // No special preparation needed
+    shaper.prepare(sampleRate, maxBlockSize, 2);
 }
 
 void WarmSaturation::process(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-    {
-        auto* channelData = buffer.getWritePointer(channel);
-        
-        for (int i = 0; i < numSamples; ++i)
-        {
-            // Apply drive
-            float input = channelData[i] * (1.0f + driveAmount * 10.0f);
-            
-            // Apply soft saturation
-            float saturated = saturate(input);
-            
-            // Apply output gain compensation
-            channelData[i] = saturated * outputGainLinear;
-        }
-    }
+    // Drive into a tanh soft clipper, then output gain compensation
+    shaper.process(buffer, numSamples);
 }
 
 void WarmSaturation::reset()
 {
-    // No state to reset
+    shaper.reset();
 }
 
 void WarmSaturation::setDrive(float drive)
 {
     driveAmount = juce::jlimit(0.0f, 1.0f, drive);
+    shaper.setInputGain(1.0f + driveAmount * 10.0f);
 }
 
 void WarmSaturation::setOutputGain(float dB)
 {
     outputGainLinear = dBToGain(juce::jlimit(-24.0f, 12.0f, dB));
+    shaper.setOutputGain(outputGainLinear);
+}
+
+void WarmSaturation::setOversamplingFactor(int factor)
+{
+    shaper.setOversamplingFactor(factor);
+}
+
+void WarmSaturation::setOversamplingLimit(int maxFactor)
+{
+    shaper.setOversamplingLimit(maxFactor);
 }
 
-float WarmSaturation::saturate(float sample)
+int WarmSaturation::getLatencySamples(int factor) const
 {
-    // Soft clipping with tanh for warm saturation
-    return std::tanh(sample);
+    return shaper.getLatencySamples(factor);
 }
 
 //==============================================================================
@@ -494,106 +613,21 @@ void MultibandCompressor::prepare(double sampleRate, int maxBlockSize)
 {
     currentSampleRate = sampleRate;
     
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = static_cast<juce::uint32>(maxBlockSize);
-    spec.numChannels = 2;
-    
-    // Prepare crossover filters
-    lowCrossover.prepare(spec);
-    highCrossover.prepare(spec);
-    
-    lowCrossover.setCutoffFrequency(LOW_CROSSOVER_FREQ);
-    highCrossover.setCutoffFrequency(HIGH_CROSSOVER_FREQ);
-    
-    lowCrossover.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
-    highCrossover.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
-    
     // Prepare band compressors
-    lowBandCompressor.prepare(spec);
-    midBandCompressor.prepare(spec);
-    highBandCompressor.prepare(spec);
-    
-    // Allocate band buffers
-    lowBandBuffer.setSize(2, maxBlockSize);
-    midBandBuffer.setSize(2, maxBlockSize);
-    highBandBuffer.setSize(2, maxBlockSize);
+    lowBandCompressor.prepare(sampleRate, maxBlockSize, 2);
+    midBandCompressor.prepare(sampleRate, maxBlockSize, 2);
+    highBandCompressor.prepare(sampleRate, maxBlockSize, 2);
 }
 
-void MultibandCompressor::process(juce::AudioBuffer<float>& buffer, int numSamples)
+void MultibandCompressor::process(BandSplitter& bands, int numSamples)
 {
-    // Copy input to band buffers
-    lowBandBuffer.copyFrom(0, 0, buffer, 0, 0, numSamples);
-    lowBandBuffer.copyFrom(1, 0, buffer, 1, 0, numSamples);
-    midBandBuffer.copyFrom(0, 0, buffer, 0, 0, numSamples);
-    midBandBuffer.copyFrom(1, 0, buffer, 1, 0, numSamples);
-    highBandBuffer.copyFrom(0, 0, buffer, 0, 0, numSamples);
-    highBandBuffer.copyFrom(1, 0, buffer, 1, 0, numSamples);
-    
-    // Apply crossover filters
-    juce::dsp::AudioBlock<float> lowBlock(lowBandBuffer.getArrayOfWritePointers(), 2, static_cast<size_t>(numSamples));
-    juce::dsp::AudioBlock<float> midBlock(midBandBuffer.getArrayOfWritePointers(), 2, static_cast<size_t>(numSamples));
-    juce::dsp::AudioBlock<float> highBlock(highBandBuffer.getArrayOfWritePointers(), 2, static_cast<size_t>(numSamples));
-    
-    juce::dsp::ProcessContextReplacing<float> lowContext(lowBlock);
-    juce::dsp::ProcessContextReplacing<float> midContext(midBlock);
-    juce::dsp::ProcessContextReplacing<float> highContext(highBlock);
-    
-    lowCrossover.process(lowContext);
-    highCrossover.process(highContext);
-    
-    // Mid band is what's left (simplified - in production would use proper bandpass)
-    for (int channel = 0; channel < 2; ++channel)
-    {
-        auto* midData = midBandBuffer.getWritePointer(channel);
-        const auto* lowData = lowBandBuffer.getReadPointer(channel);
-        const auto* highData = highBandBuffer.getReadPointer(channel);
-        
-        for (int i = 0; i < numSamples; ++i)
-        {
-            midData[i] = midData[i] - lowData[i] - highData[i];
-        }
-    }
-    
-    // Apply compression to each band
-    juce::dsp::AudioBlock<float> lowCompBlock(lowBandBuffer.getArrayOfWritePointers(), 
-                                               lowBandBuffer.getNumChannels(), 
-                                               static_cast<size_t>(numSamples));
-    juce::dsp::AudioBlock<float> midCompBlock(midBandBuffer.getArrayOfWritePointers(), 
-                                               midBandBuffer.getNumChannels(), 
-                                               static_cast<size_t>(numSamples));
-    juce::dsp::AudioBlock<float> highCompBlock(highBandBuffer.getArrayOfWritePointers(), 
-                                                highBandBuffer.getNumChannels(), 
-                                                static_cast<size_t>(numSamples));
-    
-    juce::dsp::ProcessContextReplacing<float> lowCompContext(lowCompBlock);
-    juce::dsp::ProcessContextReplacing<float> midCompContext(midCompBlock);
-    juce::dsp::ProcessContextReplacing<float> highCompContext(highCompBlock);
-    
-    lowBandCompressor.process(lowCompContext);
-    midBandCompressor.process(midCompContext);
-    highBandCompressor.process(highCompContext);
-    
-    // Sum bands back together
-    buffer.clear();
-    for (int channel = 0; channel < 2; ++channel)
-    {
-        auto* outputData = buffer.getWritePointer(channel);
-        const auto* lowData = lowBandBuffer.getReadPointer(channel);
-        const auto* midData = midBandBuffer.getReadPointer(channel);
-        const auto* highData = highBandBuffer.getReadPointer(channel);
-        
-        for (int i = 0; i < numSamples; ++i)
-        {
-            outputData[i] = lowData[i] + midData[i] + highData[i];
-        }
-    }
+    lowBandCompressor.process(bands.getBand(BandSplitter::Low), numSamples);
+    midBandCompressor.process(bands.getBand(BandSplitter::Mid), numSamples);
+    highBandCompressor.process(bands.getBand(BandSplitter::High), numSamples);
 }
 
 void MultibandCompressor::reset()
 {
-    lowCrossover.reset();
-    highCrossover.reset();
     lowBandCompressor.reset();
     midBandCompressor.reset();
     highBandCompressor.reset();
@@ -629,38 +663,35 @@ void MultibandCompressor::setHighBandRatio(float ratio)
     highBandCompressor.setRatio(juce::jlimit(1.0f, 20.0f, ratio));
 }
 
+double MultibandCompressor::getTailLengthSeconds() const
+{
+    return FILTER_TAIL_SECONDS + MULTIBAND_RELEASE_SECONDS;
+}
+
 //==============================================================================
 // StereoImager Implementation
 //==============================================================================
 
 StereoImager::StereoImager()
     : stereoWidth(1.2f)
-    , monoFrequency(200.0f)
-    , currentSampleRate(44100.0)
 {
 }
 
-void StereoImager::prepare(double sampleRate, int maxBlockSize)
+void StereoImager::process(BandSplitter& bands, int numSamples)
 {
-    currentSampleRate = sampleRate;
-    
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = static_cast<juce::uint32>(maxBlockSize);
-    spec.numChannels = 2;
+    if (bands.getNumChannels() < 2)
+        return;
     
-    lowPassFilter.prepare(spec);
-    *lowPassFilter.state = *juce::dsp::IIR::Coefficients<float>::makeLowPass(
-        sampleRate, monoFrequency);
+    // Keep the bass centered: fold the low band to mono
+    applyWidth(bands.getBand(BandSplitter::Low), numSamples, 0.0f);
+    applyWidth(bands.getBand(BandSplitter::Mid), numSamples, stereoWidth);
+    applyWidth(bands.getBand(BandSplitter::High), numSamples, stereoWidth);
 }
 
-void StereoImager::process(juce::AudioBuffer<float>& buffer, int numSamples)
+void StereoImager::applyWidth(juce::AudioBuffer<float>& band, int numSamples, float width)
 {
-    if (buffer.getNumChannels() < 2)
-        return;
-    
-    auto* leftChannel = buffer.getWritePointer(0);
-    auto* rightChannel = buffer.getWritePointer(1);
+    auto* leftChannel = band.getWritePointer(0);
+    auto* rightChannel = band.getWritePointer(1);
     
     for (int i = 0; i < numSamples; ++i)
     {
@@ -672,32 +703,65 @@ void StereoImager::process(juce::AudioBuffer<float>& buffer, int numSamples)
         float side = (left - right) * 0.5f;
         
         // Apply width to side signal
-        side *= stereoWidth;
+        side *= width;
         
         // Reconstruct left and right
         leftChannel[i] = mid + side;
         rightChannel[i] = mid - side;
     }
+}
+
+void StereoImager::setWidth(float width)
+{
+    stereoWidth = juce::jlimit(0.0f, 2.0f, width);
+}
+
+//==============================================================================
+// MasteringBands Implementation
+//==============================================================================
+
+MasteringBands::MasteringBands()
+    : compressorEnabled(true)
+    , imagerEnabled(true)
+{
+    bands.setCrossoverFrequencies(LOW_CROSSOVER_FREQ, HIGH_CROSSOVER_FREQ);
+}
+
+void MasteringBands::prepare(double sampleRate, int maxBlockSize)
+{
+    bands.prepare(sampleRate, maxBlockSize, 2);
+    compressor.prepare(sampleRate, maxBlockSize);
+}
+
+void MasteringBands::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    bands.split(buffer, numSamples);
     
-    // Apply low-pass filter to keep bass mono (simplified approach)
-    // In a full implementation, would process low frequencies separately
+    if (compressorEnabled)
+        compressor.process(bands, numSamples);
+    
+    if (imagerEnabled)
+        imager.process(bands, numSamples);
+    
+    bands.combine(buffer, numSamples);
 }
 
-void StereoImager::reset()
+void MasteringBands::reset()
 {
-    lowPassFilter.reset();
+    bands.reset();
+    compressor.reset();
 }
 
-void StereoImager::setWidth(float width)
+void MasteringBands::setProcessorsEnabled(bool shouldCompress, bool shouldImage)
 {
-    stereoWidth = juce::jlimit(0.0f, 2.0f, width);
+    compressorEnabled = shouldCompress;
+    imagerEnabled = shouldImage;
 }
 
-void StereoImager::setMonoFrequency(float frequency)
+double MasteringBands::getTailLengthSeconds() const
 {
-    monoFrequency = juce::jlimit(50.0f, 500.0f, frequency);
-    *lowPassFilter.state = *juce::dsp::IIR::Coefficients<float>::makeLowPass(
-        currentSampleRate, monoFrequency);
+    return compressorEnabled ? compressor.getTailLengthSeconds()
+                             : FILTER_TAIL_SECONDS + imager.getTailLengthSeconds();
 }
 
 //==============================================================================
@@ -706,10 +770,7 @@ void StereoImager::setMonoFrequency(float frequency)
 
 LoudnessNormalizer::LoudnessNormalizer()
     : targetLUFS(-14.0f)
-    , currentLUFS(-24.0f)
     , currentGain(1.0f)
-    , rmsSum(0.0f)
-    , rmsSampleCount(0)
     , currentSampleRate(44100.0)
 {
 }
@@ -717,48 +778,26 @@ LoudnessNormalizer::LoudnessNormalizer()
 void LoudnessNormalizer::prepare(double sampleRate, int /*maxBlockSize*/)
 {
     currentSampleRate = sampleRate;
+    meter.prepare(sampleRate, 2);
     reset();
 }
 
 void LoudnessNormalizer::process(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    // Measure RMS
-    float sumSquares = 0.0f;
-    
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-    {
-        const auto* channelData = buffer.getReadPointer(channel);
-        for (int i = 0; i < numSamples; ++i)
-        {
-            sumSquares += channelData[i] * channelData[i];
-        }
-    }
+    // Measure the input, then move the gain toward the target
+    meter.process(buffer, numSamples);
     
-    rmsSum += sumSquares;
-    rmsSampleCount += numSamples * buffer.getNumChannels();
-    
-    // Update loudness measurement every second
-    if (rmsSampleCount >= RMS_WINDOW_SIZE)
-    {
-        float rms = std::sqrt(rmsSum / static_cast<float>(rmsSampleCount));
-        // Approximate LUFS from RMS (simplified - real LUFS uses K-weighting)
-        currentLUFS = 20.0f * std::log10(rms + 0.0000001f);
-        updateGain();
-        
-        rmsSum = 0.0f;
-        rmsSampleCount = 0;
-    }
+    const float previousGain = currentGain;
+    updateGain(numSamples);
     
     // Apply gain
-    buffer.applyGain(currentGain);
+    buffer.applyGainRamp(0, numSamples, previousGain, currentGain);
 }
 
 void LoudnessNormalizer::reset()
 {
-    rmsSum = 0.0f;
-    rmsSampleCount = 0;
+    meter.reset();
     currentGain = 1.0f;
-    currentLUFS = -24.0f;
 }
 
 void LoudnessNormalizer::setTargetLUFS(float lufs)
@@ -768,20 +807,27 @@ void LoudnessNormalizer::setTargetLUFS(float lufs)
 
 float LoudnessNormalizer::getCurrentLUFS() const
 {
-    return currentLUFS;
+    return meter.getShortTermLUFS();
 }
 
-void LoudnessNormalizer::updateGain()
+void LoudnessNormalizer::updateGain(int numSamples)
 {
+    // Hold the gain through silence and until the 3 s window has filled
+    const float shortTerm = meter.getShortTermLUFS();
+    if (shortTerm <= LOUDNESS_GATE_LUFS)
+        return;
+    
     // Calculate required gain adjustment
-    float gainDB = targetLUFS - currentLUFS;
+    float gainDB = targetLUFS - shortTerm;
     
     // Limit gain adjustment to prevent extreme changes
     gainDB = juce::jlimit(-12.0f, 12.0f, gainDB);
     
-    // Smooth gain change (simple one-pole filter)
-    float targetGain = dBToGain(gainDB);
-    currentGain = currentGain * 0.9f + targetGain * 0.1f;
+    // Smooth gain change (one-pole, time constant independent of block size)
+    const float targetGain = dBToGain(gainDB);
+    const float coefficient = 1.0f - std::exp(-static_cast<float>(numSamples)
+                                              / static_cast<float>(GAIN_SMOOTHING_SECONDS * currentSampleRate));
+    currentGain += (targetGain - currentGain) * coefficient;
 }
 
 //==============================================================================
@@ -790,27 +836,18 @@ void LoudnessNormalizer::updateGain()
 
 FinalLimiter::FinalLimiter()
 {
-    limiter.setThreshold(-0.1f);
+    limiter.setCeiling(-0.1f);
     limiter.setRelease(50.0f);
 }
 
 void FinalLimiter::prepare(double sampleRate, int maxBlockSize)
 {
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = static_cast<juce::uint32>(maxBlockSize);
-    spec.numChannels = 2;
-    
-    limiter.prepare(spec);
+    limiter.prepare(sampleRate, maxBlockSize, 2);
 }
 
 void FinalLimiter::process(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), 
-                                        buffer.getNumChannels(), 
-                                        static_cast<size_t>(numSamples));
-    juce::dsp::ProcessContextReplacing<float> context(block);
-    limiter.process(context);
+    limiter.process(buffer, numSamples);
 }
 
 void FinalLimiter::reset()
@@ -820,7 +857,7 @@ void FinalLimiter::reset()
 
 void FinalLimiter::setCeiling(float dB)
 {
-    limiter.setThreshold(juce::jlimit(-12.0f, 0.0f, dB));
+    limiter.setCeiling(dB);
 }
 
 void FinalLimiter::setRelease(float ms)
@@ -828,6 +865,21 @@ void FinalLimiter::setRelease(float ms)
     limiter.setRelease(juce::jlimit(1.0f, 500.0f, ms));
 }
 
+void FinalLimiter::setLookahead(float ms)
+{
+    limiter.setLookahead(ms);
+}
+
+double FinalLimiter::getTailLengthSeconds() const
+{
+    return limiter.getTailLengthSeconds();
+}
+
+int FinalLimiter::getLatencySamples(float lookaheadMs) const
+{
+    return limiter.getLatencySamples(lookaheadMs);
+}
+
 //==============================================================================
 // CinematicAudioEnhancer Implementation
 //==============================================================================
@@ -835,17 +887,6 @@ void FinalLimiter::setRelease(float ms)
 CinematicAudioEnhancer::CinematicAudioEnhancer()
     : currentSampleRate(44100.0)
     , currentMaxBlockSize(512)
-    , highPassEnabled(true)
-    , presenceEQEnabled(true)
-    , vocalCompressorEnabled(true)
-    , cinematicReverbEnabled(true)
-    , subtleDelayEnabled(false)
-    , modulationEnabled(false)
-    , saturationEnabled(false)
-    , multibandCompressorEnabled(true)
-    , stereoImagerEnabled(true)
-    , loudnessNormalizerEnabled(true)
-    , finalLimiterEnabled(true)
 {
     // Apply default cinematic preset
     applyCinematicVocalPreset();
@@ -857,11 +898,13 @@ CinematicAudioEnhancer::~CinematicAudioEnhancer()
 
 void CinematicAudioEnhancer::prepare(double sampleRate, int maxBlockSize)
 {
-    const juce::ScopedLock sl(processLock);
-    
     currentSampleRate = sampleRate;
     currentMaxBlockSize = maxBlockSize;
     
+    // Pick up the latest settings first so each stage prepares with them
+    parameterSnapshot.acquireLatest();
+    applyParameters(parameterSnapshot.getAcquired(), true);
+    
     // Prepare all components
     highPassFilter.prepare(sampleRate, maxBlockSize);
     presenceEQ.prepare(sampleRate, maxBlockSize);
@@ -870,79 +913,90 @@ void CinematicAudioEnhancer::prepare(double sampleRate, int maxBlockSize)
     subtleDelay.prepare(sampleRate, maxBlockSize);
     modulationEffect.prepare(sampleRate, maxBlockSize);
     warmSaturation.prepare(sampleRate, maxBlockSize);
-    multibandCompressor.prepare(sampleRate, maxBlockSize);
-    stereoImager.prepare(sampleRate, maxBlockSize);
+    masteringBands.prepare(sampleRate, maxBlockSize);
     loudnessNormalizer.prepare(sampleRate, maxBlockSize);
     finalLimiter.prepare(sampleRate, maxBlockSize);
     
+    for (auto& gate : stageGates)
+        gate.prepare(sampleRate);
+    
     Logger::log(Logger::Level::Info, "CinematicAudioEnhancer prepared");
 }
 
 void CinematicAudioEnhancer::process(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    const juce::ScopedLock sl(processLock);
+    if (parameterSnapshot.acquireLatest())
+        applyParameters(parameterSnapshot.getAcquired(), false);
+    
+    const auto& parameters = parameterSnapshot.getAcquired();
+    
+    // Stages whose input has been silent for longer than their tail are skipped
+    bool silent = SilenceGate::isSilent(buffer, numSamples);
+    
+    auto runStage = [&](auto& stage, StageIndex index)
+    {
+        processGated(stage, stageGates[index], profiler, profileStages[index], buffer, numSamples, silent);
+    };
     
     //==========================================================================
     // Vocal Processing Chain
     //==========================================================================
     
     // High-pass filter (remove low frequencies below 80 Hz)
-    if (highPassEnabled)
-        highPassFilter.process(buffer, numSamples);
+    if (parameters.highPassEnabled)
+        runStage(highPassFilter, HighPassStage);
     
     // Presence EQ (boost 3-5 kHz for clarity)
-    if (presenceEQEnabled)
-        presenceEQ.process(buffer, numSamples);
+    if (parameters.presenceEQEnabled)
+        runStage(presenceEQ, PresenceEQStage);
     
     // Gentle compression (2:1 ratio for natural dynamics)
-    if (vocalCompressorEnabled)
-        vocalCompressor.process(buffer, numSamples);
+    if (parameters.vocalCompressorEnabled)
+        runStage(vocalCompressor, VocalCompressorStage);
     
     //==========================================================================
     // Multi-FX Processing
     //==========================================================================
     
     // Modulation (chorus/flanger for lush sound)
-    if (modulationEnabled)
-        modulationEffect.process(buffer, numSamples);
+    if (parameters.modulationEnabled)
+        runStage(modulationEffect, ModulationStage);
     
     // Warm saturation (for richness during climactic moments)
-    if (saturationEnabled)
-        warmSaturation.process(buffer, numSamples);
+    if (parameters.saturationEnabled)
+        runStage(warmSaturation, SaturationStage);
     
     // Subtle delay (quarter-note for depth)
-    if (subtleDelayEnabled)
-        subtleDelay.process(buffer, numSamples);
+    if (parameters.subtleDelayEnabled)
+        runStage(subtleDelay, SubtleDelayStage);
     
     // Cinematic reverb (large hall with pre-delay)
-    if (cinematicReverbEnabled)
-        cinematicReverb.process(buffer, numSamples);
+    if (parameters.cinematicReverbEnabled)
+        runStage(cinematicReverb, CinematicReverbStage);
     
     //==========================================================================
     // Mastering Chain
     //==========================================================================
     
-    // Multiband compression (control dynamics across frequency ranges)
-    if (multibandCompressorEnabled)
-        multibandCompressor.process(buffer, numSamples);
-    
-    // Stereo imaging (widen stereo, keep bass centered)
-    if (stereoImagerEnabled)
-        stereoImager.process(buffer, numSamples);
+    // Multiband compression (control dynamics across frequency ranges) and
+    // stereo imaging (widen stereo, keep bass centered) on one band split
+    if (parameters.multibandCompressorEnabled || parameters.stereoImagerEnabled)
+    {
+        masteringBands.setProcessorsEnabled(parameters.multibandCompressorEnabled, parameters.stereoImagerEnabled);
+        runStage(masteringBands, MasteringBandsStage);
+    }
     
     // Loudness normalization (target -14 LUFS for streaming)
-    if (loudnessNormalizerEnabled)
-        loudnessNormalizer.process(buffer, numSamples);
+    if (parameters.loudnessNormalizerEnabled)
+        runStage(loudnessNormalizer, LoudnessNormalizerStage);
     
     // Final limiter (-0.1 dB ceiling, no clipping)
-    if (finalLimiterEnabled)
-        finalLimiter.process(buffer, numSamples);
+    if (parameters.finalLimiterEnabled)
+        runStage(finalLimiter, FinalLimiterStage);
 }
 
 void CinematicAudioEnhancer::reset()
 {
-    const juce::ScopedLock sl(processLock);
-    
     highPassFilter.reset();
     presenceEQ.reset();
     vocalCompressor.reset();
@@ -950,10 +1004,139 @@ void CinematicAudioEnhancer::reset()
     subtleDelay.reset();
     modulationEffect.reset();
     warmSaturation.reset();
-    multibandCompressor.reset();
-    stereoImager.reset();
+    masteringBands.reset();
     loudnessNormalizer.reset();
     finalLimiter.reset();
+    
+    for (auto& gate : stageGates)
+        gate.reset();
+}
+
+void CinematicAudioEnhancer::setProfiler(RealtimeProfiler* profilerToUse)
+{
+    static constexpr const char* stageNames[NumStages] = {
+        "enhancer/high-pass", "enhancer/presence EQ", "enhancer/compressor", "enhancer/modulation",
+        "enhancer/saturation", "enhancer/delay", "enhancer/reverb", "enhancer/mastering bands",
+        "enhancer/normalizer", "enhancer/limiter"
+    };
+    
+    profiler = profilerToUse;
+    
+    for (int i = 0; i < NumStages; ++i)
+        profileStages[static_cast<size_t>(i)] = profiler != nullptr ? profiler->registerStage(stageNames[i]) : -1;
+}
+
+double CinematicAudioEnhancer::getTailLengthSeconds() const
+{
+    const auto parameters = getParameters();
+    
+    // Stages run in series, so their tails add up
+    double tail = 0.0;
+    
+    if (parameters.highPassEnabled)            tail += highPassFilter.getTailLengthSeconds();
+    if (parameters.presenceEQEnabled)          tail += presenceEQ.getTailLengthSeconds();
+    if (parameters.vocalCompressorEnabled)     tail += vocalCompressor.getTailLengthSeconds();
+    if (parameters.modulationEnabled)          tail += modulationEffect.getTailLengthSeconds();
+    if (parameters.saturationEnabled)          tail += warmSaturation.getTailLengthSeconds();
+    if (parameters.subtleDelayEnabled)         tail += subtleDelay.getTailLengthSeconds();
+    if (parameters.cinematicReverbEnabled)     tail += cinematicReverb.getTailLengthSeconds();
+    if (parameters.multibandCompressorEnabled) tail += masteringBands.getCompressor().getTailLengthSeconds();
+    else if (parameters.stereoImagerEnabled)   tail += FILTER_TAIL_SECONDS;
+    if (parameters.loudnessNormalizerEnabled)  tail += loudnessNormalizer.getTailLengthSeconds();
+    if (parameters.finalLimiterEnabled)        tail += finalLimiter.getTailLengthSeconds();
+    
+    return tail;
+}
+
+int CinematicAudioEnhancer::getLatencySamples() const
+{
+    const auto parameters = getParameters();
+    
+    // Taken from the edited settings, so the host can be told before the audio thread switches
+    int latency = 0;
+    
+    if (parameters.saturationEnabled)
+        latency += warmSaturation.getLatencySamples(parameters.saturationOversampling);
+    if (parameters.finalLimiterEnabled)
+        latency += finalLimiter.getLatencySamples(parameters.limiterLookahead);
+    
+    return latency;
+}
+
+//==============================================================================
+// Parameter Handoff
+//==============================================================================
+
+CinematicAudioEnhancer::Parameters CinematicAudioEnhancer::getParameters() const
+{
+    const juce::ScopedLock sl(editLock);
+    return editedParameters;
+}
+
+void CinematicAudioEnhancer::setParameters(const Parameters& newParameters)
+{
+    editParameters([&newParameters](Parameters& p) { p = newParameters; });
+}
+
+void CinematicAudioEnhancer::applyParameters(const Parameters& p, bool force)
+{
+    // Only changed values reach the stages, so unchanged filters are not redesigned
+    auto& applied = appliedParameters;
+    
+    if (force || p.highPassCutoff != applied.highPassCutoff)
+        highPassFilter.setCutoffFrequency(p.highPassCutoff);
+    
+    if (force || p.presenceFrequency != applied.presenceFrequency)
+        presenceEQ.setFrequency(p.presenceFrequency);
+    if (force || p.presenceGain != applied.presenceGain)
+        presenceEQ.setGain(p.presenceGain);
+    
+    if (force || p.vocalCompressorThreshold != applied.vocalCompressorThreshold)
+        vocalCompressor.setThreshold(p.vocalCompressorThreshold);
+    if (force || p.vocalCompressorRatio != applied.vocalCompressorRatio)
+        vocalCompressor.setRatio(p.vocalCompressorRatio);
+    
+    if (force || p.cinematicReverbSize != applied.cinematicReverbSize)
+        cinematicReverb.setRoomSize(p.cinematicReverbSize);
+    if (force || p.cinematicReverbMix != applied.cinematicReverbMix)
+    {
+        cinematicReverb.setWetLevel(p.cinematicReverbMix);
+        cinematicReverb.setDryLevel(1.0f - p.cinematicReverbMix);
+    }
+    if (force || p.cinematicReverbPreDelay != applied.cinematicReverbPreDelay)
+        cinematicReverb.setPreDelay(p.cinematicReverbPreDelay);
+    if (force || p.cinematicReverbMode != applied.cinematicReverbMode)
+        cinematicReverb.setMode(p.cinematicReverbMode);
+    
+    if (force || p.subtleDelayTime != applied.subtleDelayTime)
+        subtleDelay.setDelayTime(p.subtleDelayTime);
+    if (force || p.subtleDelayMix != applied.subtleDelayMix)
+        subtleDelay.setMix(p.subtleDelayMix);
+    
+    if (force || p.modulationRate != applied.modulationRate)
+        modulationEffect.setRate(p.modulationRate);
+    if (force || p.modulationDepth != applied.modulationDepth)
+        modulationEffect.setDepth(p.modulationDepth);
+    if (force || p.modulationMix != applied.modulationMix)
+        modulationEffect.setMix(p.modulationMix);
+    
+    if (force || p.saturationDrive != applied.saturationDrive)
+        warmSaturation.setDrive(p.saturationDrive);
+    if (force || p.saturationOversampling != applied.saturationOversampling)
+        warmSaturation.setOversamplingFactor(p.saturationOversampling);
+    
+    if (force || p.stereoWidth != applied.stereoWidth)
+        masteringBands.getImager().setWidth(p.stereoWidth);
+    
+    if (force || p.targetLUFS != applied.targetLUFS)
+        loudnessNormalizer.setTargetLUFS(p.targetLUFS);
+    
+    if (force || p.limiterCeiling != applied.limiterCeiling)
+        finalLimiter.setCeiling(p.limiterCeiling);
+    if (force || p.limiterLookahead != applied.limiterLookahead)
+        finalLimiter.setLookahead(p.limiterLookahead);
+    
+    applied = p;
 }
 
 //==============================================================================
@@ -962,78 +1145,92 @@ void CinematicAudioEnhancer::reset()
 
 void CinematicAudioEnhancer::setHighPassEnabled(bool enabled)
 {
-    highPassEnabled = enabled;
+    editParameters([enabled](Parameters& p) { p.highPassEnabled = enabled; });
 }
 
 void CinematicAudioEnhancer::setHighPassCutoff(float frequency)
 {
-    highPassFilter.setCutoffFrequency(frequency);
+    editParameters([frequency](Parameters& p) { p.highPassCutoff = frequency; });
 }
 
 void CinematicAudioEnhancer::setPresenceEQEnabled(bool enabled)
 {
-    presenceEQEnabled = enabled;
+    editParameters([enabled](Parameters& p) { p.presenceEQEnabled = enabled; });
 }
 
 void CinematicAudioEnhancer::setPresenceFrequency(float frequency)
 {
-    presenceEQ.setFrequency(frequency);
+    editParameters([frequency](Parameters& p) { p.presenceFrequency = frequency; });
 }
 
 void CinematicAudioEnhancer::setPresenceGain(float dB)
 {
-    presenceEQ.setGain(dB);
+    editParameters([dB](Parameters& p) { p.presenceGain = dB; });
 }
 
 void CinematicAudioEnhancer::setVocalCompressorEnabled(bool enabled)
 {
-    vocalCompressorEnabled = enabled;
+    editParameters([enabled](Parameters& p) { p.vocalCompressorEnabled = enabled; });
 }
 
 void CinematicAudioEnhancer::setVocalCompressorThreshold(float dB)
 {
-    vocalCompressor.setThreshold(dB);
+    editParameters([dB](Parameters& p) { p.vocalCompressorThreshold = dB; });
 }
 
 void CinematicAudioEnhancer::setVocalCompressorRatio(float ratio)
 {
-    vocalCompressor.setRatio(ratio);
+    editParameters([ratio](Parameters& p) { p.vocalCompressorRatio = ratio; });
 }
 
 void CinematicAudioEnhancer::setCinematicReverbEnabled(bool enabled)
 {
-    cinematicReverbEnabled = enabled;
+    editParameters([enabled](Parameters& p) { p.cinematicReverbEnabled = enabled; });
 }
 
 void CinematicAudioEnhancer::setCinematicReverbSize(float size)
 {
-    cinematicReverb.setRoomSize(size);
+    editParameters([size](Parameters& p) { p.cinematicReverbSize = size; });
 }
 
 void CinematicAudioEnhancer::setCinematicReverbMix(float mix)
 {
-    cinematicReverb.setWetLevel(mix);
-    cinematicReverb.setDryLevel(1.0f - mix);
+    editParameters([mix](Parameters& p) { p.cinematicReverbMix = mix; });
 }
 
 void CinematicAudioEnhancer::setCinematicReverbPreDelay(float ms)
 {
-    cinematicReverb.setPreDelay(ms);
+    editParameters([ms](Parameters& p) { p.cinematicReverbPreDelay = ms; });
+}
+
+void CinematicAudioEnhancer::setCinematicReverbMode(ReverbMode mode)
+{
+    editParameters([mode](Parameters& p) { p.cinematicReverbMode = mode; });
+}
+
+bool CinematicAudioEnhancer::loadCinematicReverbImpulseResponse(const juce::File& file)
+{
+    return cinematicReverb.loadImpulseResponse(file);
+}
+
+bool CinematicAudioEnhancer::loadCinematicReverbImpulseResponse(const void* data, size_t numBytes)
+{
+    return cinematicReverb.loadImpulseResponse(data, numBytes);
 }
 
 void CinematicAudioEnhancer::setSubtleDelayEnabled(bool enabled)
 {
-    subtleDelayEnabled = enabled;
+    editParameters([enabled](Parameters& p) { p.subtleDelayEnabled = enabled; });
 }
 
 void CinematicAudioEnhancer::setSubtleDelayTime(float ms)
 {
-    subtleDelay.setDelayTime(ms);
+    editParameters([ms](Parameters& p) { p.subtleDelayTime = ms; });
 }
 
 void CinematicAudioEnhancer::setSubtleDelayMix(float mix)
 {
-    subtleDelay.setMix(mix);
+    editParameters([mix](Parameters& p) { p.subtleDelayMix = mix; });
 }
 
 //==============================================================================
@@ -1042,32 +1239,37 @@ void CinematicAudioEnhancer::setSubtleDelayMix(float mix)
 
 void CinematicAudioEnhancer::setModulationEnabled(bool enabled)
 {
-    modulationEnabled = enabled;
+    editParameters([enabled](Parameters& p) { p.modulationEnabled = enabled; });
 }
 
 void CinematicAudioEnhancer::setModulationRate(float hz)
 {
-    modulationEffect.setRate(hz);
+    editParameters([hz](Parameters& p) { p.modulationRate = hz; });
 }
 
 void CinematicAudioEnhancer::setModulationDepth(float depth)
 {
-    modulationEffect.setDepth(depth);
+    editParameters([depth](Parameters& p) { p.modulationDepth = depth; });
 }
 
 void CinematicAudioEnhancer::setModulationMix(float mix)
 {
-    modulationEffect.setMix(mix);
+    editParameters([mix](Parameters& p) { p.modulationMix = mix; });
 }
 
 void CinematicAudioEnhancer::setSaturationEnabled(bool enabled)
 {
-    saturationEnabled = enabled;
+    editParameters([enabled](Parameters& p) { p.saturationEnabled = enabled; });
 }
 
 void CinematicAudioEnhancer::setSaturationDrive(float drive)
 {
-    warmSaturation.setDrive(drive);
+    editParameters([drive](Parameters& p) { p.saturationDrive = drive; });
+}
+
+void CinematicAudioEnhancer::setSaturationOversampling(int factor)
+{
+    editParameters([factor](Parameters& p) { p.saturationOversampling = factor; });
 }
 
 //==============================================================================
@@ -1076,37 +1278,42 @@ void CinematicAudioEnhancer::setSaturationDrive(float drive)
 
 void CinematicAudioEnhancer::setMultibandCompressorEnabled(bool enabled)
 {
-    multibandCompressorEnabled = enabled;
+    editParameters([enabled](Parameters& p) { p.multibandCompressorEnabled = enabled; });
 }
 
 void CinematicAudioEnhancer::setStereoImagerEnabled(bool enabled)
 {
-    stereoImagerEnabled = enabled;
+    editParameters([enabled](Parameters& p) { p.stereoImagerEnabled = enabled; });
 }
 
 void CinematicAudioEnhancer::setStereoWidth(float width)
 {
-    stereoImager.setWidth(width);
+    editParameters([width](Parameters& p) { p.stereoWidth = width; });
 }
 
 void CinematicAudioEnhancer::setLoudnessNormalizerEnabled(bool enabled)
 {
-    loudnessNormalizerEnabled = enabled;
+    editParameters([enabled](Parameters& p) { p.loudnessNormalizerEnabled = enabled; });
 }
 
 void CinematicAudioEnhancer::setTargetLUFS(float lufs)
 {
-    loudnessNormalizer.setTargetLUFS(lufs);
+    editParameters([lufs](Parameters& p) { p.targetLUFS = lufs; });
 }
 
 void CinematicAudioEnhancer::setFinalLimiterEnabled(bool enabled)
 {
-    finalLimiterEnabled = enabled;
+    editParameters([enabled](Parameters& p) { p.finalLimiterEnabled = enabled; });
 }
 
 void CinematicAudioEnhancer::setLimiterCeiling(float dB)
 {
-    finalLimiter.setCeiling(dB);
+    editParameters([dB](Parameters& p) { p.limiterCeiling = dB; });
+}
+
+void CinematicAudioEnhancer::setLimiterLookahead(float ms)
+{
+    editParameters([ms](Parameters& p) { p.limiterLookahead = ms; });
 }
 
 //==============================================================================
@@ -1115,109 +1322,122 @@ void CinematicAudioEnhancer::setLimiterCeiling(float dB)
 
 void CinematicAudioEnhancer::applyCinematicVocalPreset()
 {
+    // Built on a copy and published once so no block hears half a preset
+    auto p = getParameters();
+    
     // Vocal Processing - Grammy-quality settings
-    setHighPassEnabled(true);
-    setHighPassCutoff(80.0f);
+    p.highPassEnabled = true;
+    p.highPassCutoff = 80.0f;
     
-    setPresenceEQEnabled(true);
-    setPresenceFrequency(4000.0f);
-    setPresenceGain(3.0f);
+    p.presenceEQEnabled = true;
+    p.presenceFrequency = 4000.0f;
+    p.presenceGain = 3.0f;
     
-    setVocalCompressorEnabled(true);
-    setVocalCompressorThreshold(-18.0f);
-    setVocalCompressorRatio(2.0f);
+    p.vocalCompressorEnabled = true;
+    p.vocalCompressorThreshold = -18.0f;
+    p.vocalCompressorRatio = 2.0f;
     
-    setCinematicReverbEnabled(true);
-    setCinematicReverbSize(0.8f);
-    setCinematicReverbMix(0.25f);
-    setCinematicReverbPreDelay(30.0f);
+    p.cinematicReverbEnabled = true;
+    p.cinematicReverbSize = 0.8f;
+    p.cinematicReverbMix = 0.25f;
+    p.cinematicReverbPreDelay = 30.0f;
     
-    setSubtleDelayEnabled(true);
-    setSubtleDelayTime(300.0f);
-    setSubtleDelayMix(0.15f);
+    p.subtleDelayEnabled = true;
+    p.subtleDelayTime = 300.0f;
+    p.subtleDelayMix = 0.15f;
     
     // Multi-FX - Subtle enhancement
-    setModulationEnabled(false);
-    setSaturationEnabled(false);
+    p.modulationEnabled = false;
+    p.saturationEnabled = false;
     
     // Mastering - Professional polish
-    setMultibandCompressorEnabled(true);
-    setStereoImagerEnabled(true);
-    setStereoWidth(1.2f);
-    setLoudnessNormalizerEnabled(true);
-    setTargetLUFS(-14.0f);
-    setFinalLimiterEnabled(true);
-    setLimiterCeiling(-0.1f);
+    p.multibandCompressorEnabled = true;
+    p.stereoImagerEnabled = true;
+    p.stereoWidth = 1.2f;
+    p.loudnessNormalizerEnabled = true;
+    p.targetLUFS = -14.0f;
+    p.finalLimiterEnabled = true;
+    p.limiterCeiling = -0.1f;
+    
+    setParameters(p);
     
     Logger::log(Logger::Level::Info, "Applied Cinematic Vocal Preset");
 }
 
 void CinematicAudioEnhancer::applyCinematicMasteringPreset()
 {
+    auto p = getParameters();
+    
     // Disable vocal-specific processing
-    setHighPassEnabled(false);
-    setPresenceEQEnabled(false);
-    setVocalCompressorEnabled(false);
-    setCinematicReverbEnabled(false);
-    setSubtleDelayEnabled(false);
+    p.highPassEnabled = false;
+    p.presenceEQEnabled = false;
+    p.vocalCompressorEnabled = false;
+    p.cinematicReverbEnabled = false;
+    p.subtleDelayEnabled = false;
     
     // Multi-FX - Light enhancement
-    setModulationEnabled(false);
-    setSaturationEnabled(true);
-    setSaturationDrive(0.1f);
+    p.modulationEnabled = false;
+    p.saturationEnabled = true;
+    p.saturationDrive = 0.1f;
     
     // Mastering - Full chain
-    setMultibandCompressorEnabled(true);
-    setStereoImagerEnabled(true);
-    setStereoWidth(1.3f);
-    setLoudnessNormalizerEnabled(true);
-    setTargetLUFS(-14.0f);
-    setFinalLimiterEnabled(true);
-    setLimiterCeiling(-0.1f);
+    p.multibandCompressorEnabled = true;
+    p.stereoImagerEnabled = true;
+    p.stereoWidth = 1.3f;
+    p.loudnessNormalizerEnabled = true;
+    p.targetLUFS = -14.0f;
+    p.finalLimiterEnabled = true;
+    p.limiterCeiling = -0.1f;
+    
+    setParameters(p);
     
     Logger::log(Logger::Level::Info, "Applied Cinematic Mastering Preset");
 }
 
 void CinematicAudioEnhancer::applyViralAppealPreset()
 {
+    auto p = getParameters();
+    
     // Vocal Processing - Punchy and present
-    setHighPassEnabled(true);
-    setHighPassCutoff(100.0f);
+    p.highPassEnabled = true;
+    p.highPassCutoff = 100.0f;
     
-    setPresenceEQEnabled(true);
-    setPresenceFrequency(5000.0f);
-    setPresenceGain(4.0f);
+    p.presenceEQEnabled = true;
+    p.presenceFrequency = 5000.0f;
+    p.presenceGain = 4.0f;
     
-    setVocalCompressorEnabled(true);
-    setVocalCompressorThreshold(-15.0f);
-    setVocalCompressorRatio(3.0f);
+    p.vocalCompressorEnabled = true;
+    p.vocalCompressorThreshold = -15.0f;
+    p.vocalCompressorRatio = 3.0f;
     
-    setCinematicReverbEnabled(true);
-    setCinematicReverbSize(0.5f);
-    setCinematicReverbMix(0.2f);
-    setCinematicReverbPreDelay(20.0f);
+    p.cinematicReverbEnabled = true;
+    p.cinematicReverbSize = 0.5f;
+    p.cinematicReverbMix = 0.2f;
+    p.cinematicReverbPreDelay = 20.0f;
     
-    setSubtleDelayEnabled(true);
-    setSubtleDelayTime(250.0f);
-    setSubtleDelayMix(0.1f);
+    p.subtleDelayEnabled = true;
+    p.subtleDelayTime = 250.0f;
+    p.subtleDelayMix = 0.1f;
     
     // Multi-FX - More aggressive
-    setModulationEnabled(true);
-    setModulationRate(0.3f);
-    setModulationDepth(0.2f);
-    setModulationMix(0.15f);
+    p.modulationEnabled = true;
+    p.modulationRate = 0.3f;
+    p.modulationDepth = 0.2f;
+    p.modulationMix = 0.15f;
     
-    setSaturationEnabled(true);
-    setSaturationDrive(0.15f);
+    p.saturationEnabled = true;
+    p.saturationDrive = 0.15f;
     
     // Mastering - Louder for impact
-    setMultibandCompressorEnabled(true);
-    setStereoImagerEnabled(true);
-    setStereoWidth(1.4f);
-    setLoudnessNormalizerEnabled(true);
-    setTargetLUFS(-12.0f);
-    setFinalLimiterEnabled(true);
-    setLimiterCeiling(-0.1f);
+    p.multibandCompressorEnabled = true;
+    p.stereoImagerEnabled = true;
+    p.stereoWidth = 1.4f;
+    p.loudnessNormalizerEnabled = true;
+    p.targetLUFS = -12.0f;
+    p.finalLimiterEnabled = true;
+    p.limiterCeiling = -0.1f;
+    
+    setParameters(p);
     
     Logger::log(Logger::Level::Info, "Applied Viral Appeal Preset");
 }
@@ -14,10 +14,20 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
 #include <memory>
 #include <vector>
 #include "Utilities.h"
 #include "OnnxEngine.h"
+#include "SmoothedBiquad.h"
+#include "ParameterSnapshot.h"
+#include "LoudnessMeter.h"
+#include "Waveshaper.h"
+#include "PartitionedConvolver.h"
+#include "BandSplitter.h"
+#include "TruePeakLimiter.h"
+#include "Dynamics.h"
+#include "RealtimeProfiler.h"
 
 namespace MAEVN
 {
@@ -41,10 +51,14 @@ public:
      * @brief Set the cutoff frequency (default 80 Hz)
      */
     void setCutoffFrequency(float frequency);
+    
+    /**
+     * @brief Get how long output continues after the input stops
+     */
+    double getTailLengthSeconds() const;
 
 private:
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> highPassFilter;
+    SmoothedBiquad highPassFilter;
     double currentSampleRate;
     float cutoffFreq;
 };
@@ -78,10 +92,14 @@ public:
      * @brief Set the Q factor (bandwidth)
      */
     void setQ(float q);
+    
+    /**
+     * @brief Get how long output continues after the input stops
+     */
+    double getTailLengthSeconds() const;
 
 private:
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> presenceFilter;
+    SmoothedBiquad presenceFilter;
     double currentSampleRate;
     float frequency;
     float gainDB;
@@ -110,10 +128,16 @@ public:
     void setRatio(float ratio);
     void setAttack(float ms);
     void setRelease(float ms);
+    
+    /**
+     * @brief Get how long output continues after the input stops
+     */
+    double getTailLengthSeconds() const;
 
 private:
-    juce::dsp::Compressor<float> compressor;
+    Compressor compressor;
     double currentSampleRate;
+    float releaseMs;
 };
 
 //==============================================================================
@@ -121,7 +145,9 @@ private:
  * @brief Large hall reverb for cinematic space
  * 
  * Creates a sense of space with large hall reverb, 
- * with adjustable pre-delay for clarity
+ * with adjustable pre-delay for clarity. In convolution mode the hall is
+ * a loaded impulse response; pre-delay, damping, width and levels apply
+ * the same way.
  */
 class CinematicReverb
 {
@@ -138,15 +164,51 @@ public:
     void setDryLevel(float level);
     void setPreDelay(float ms);
     void setWidth(float width);
+    
+    /**
+     * @brief Switch between Freeverb and the impulse response (any thread)
+     */
+    void setMode(ReverbMode newMode) { mode.store(newMode); }
+    ReverbMode getMode() const { return mode.load(); }
+    
+    /**
+     * @brief Load the impulse response used in convolution mode (not the audio thread)
+     */
+    bool loadImpulseResponse(const juce::File& file) { return convolver.loadImpulseResponse(file); }
+    bool loadImpulseResponse(const void* data, size_t numBytes) { return convolver.loadImpulseResponse(data, numBytes); }
+    bool loadImpulseResponse(const juce::AudioBuffer<float>& impulse, double sampleRate)
+    {
+        return convolver.loadImpulseResponse(impulse, sampleRate);
+    }
+    
+    /**
+     * @brief Convolve no more than this much of the impulse response (<= 0 = all; any thread)
+     */
+    void setTailLimitSeconds(double seconds) { convolver.setTailLimitSeconds(seconds); }
+    
+    /**
+     * @brief Get how long output continues after the input stops
+     */
+    double getTailLengthSeconds() const;
 
 private:
     juce::dsp::Reverb reverb;
     juce::dsp::Reverb::Parameters reverbParams;
     
+    // Convolution mode: wet path, and damping in place of Freeverb's
+    PartitionedConvolver convolver;
+    SmoothedBiquad dampingFilter;
+    juce::AudioBuffer<float> wetBuffer;
+    std::atomic<ReverbMode> mode { ReverbMode::Algorithmic };
+    ReverbMode activeMode;
+    
     // Pre-delay line
     juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> preDelayLine{192000};
     float preDelayMs;
     double currentSampleRate;
+    
+    void updateDampingFilter();
+    void processConvolution(juce::AudioBuffer<float>& buffer, int numSamples);
 };
 
 //==============================================================================
@@ -177,6 +239,11 @@ public:
     
     void setFeedback(float feedback);
     void setMix(float mix);
+    
+    /**
+     * @brief Get how long output continues after the input stops
+     */
+    double getTailLengthSeconds() const;
 
 private:
     juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> delayLine{192000};
@@ -206,6 +273,11 @@ public:
     void setRate(float hz);
     void setDepth(float depth);
     void setMix(float mix);
+    
+    /**
+     * @brief Get how long output continues after the input stops
+     */
+    double getTailLengthSeconds() const;
 
 private:
     juce::dsp::Chorus<float> chorus;
@@ -237,20 +309,37 @@ public:
      * @brief Set output gain compensation
      */
     void setOutputGain(float dB);
+    
+    /**
+     * @brief Run the waveshaper at 1x, 2x or 4x to keep high drive alias-free
+     */
+    void setOversamplingFactor(int factor);
+    
+    /**
+     * @brief Cap the factor actually run without changing the latency (any thread)
+     */
+    void setOversamplingLimit(int maxFactor);
+    
+    /**
+     * @brief Delay added by oversampling at the given factor
+     */
+    int getLatencySamples(int factor) const;
+    
+    double getTailLengthSeconds() const { return 0.0; }
 
 private:
     float driveAmount;
     float outputGainLinear;
     
-    // Soft saturation function
-    float saturate(float sample);
+    Waveshaper shaper;
 };
 
 //==============================================================================
 /**
  * @brief Multiband compressor for mastering
  * 
- * Controls dynamics across different frequency ranges
+ * Controls dynamics across different frequency ranges. Works in place on
+ * the bands of a shared BandSplitter (see MasteringBands).
  */
 class MultibandCompressor
 {
@@ -258,7 +347,11 @@ public:
     MultibandCompressor();
     
     void prepare(double sampleRate, int maxBlockSize);
-    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    /**
+     * @brief Compress each band of the last split in place
+     */
+    void process(BandSplitter& bands, int numSamples);
     void reset();
     
     void setLowBandThreshold(float dB);
@@ -268,60 +361,88 @@ public:
     void setLowBandRatio(float ratio);
     void setMidBandRatio(float ratio);
     void setHighBandRatio(float ratio);
+    
+    /**
+     * @brief Get how long output continues after the input stops
+     */
+    double getTailLengthSeconds() const;
 
 private:
-    // Crossover filters
-    juce::dsp::LinkwitzRileyFilter<float> lowCrossover;
-    juce::dsp::LinkwitzRileyFilter<float> highCrossover;
-    
     // Band compressors
-    juce::dsp::Compressor<float> lowBandCompressor;
-    juce::dsp::Compressor<float> midBandCompressor;
-    juce::dsp::Compressor<float> highBandCompressor;
-    
-    // Band buffers
-    juce::AudioBuffer<float> lowBandBuffer;
-    juce::AudioBuffer<float> midBandBuffer;
-    juce::AudioBuffer<float> highBandBuffer;
+    Compressor lowBandCompressor;
+    Compressor midBandCompressor;
+    Compressor highBandCompressor;
     
     double currentSampleRate;
-    static constexpr float LOW_CROSSOVER_FREQ = 200.0f;
-    static constexpr float HIGH_CROSSOVER_FREQ = 4000.0f;
 };
 
 //==============================================================================
 /**
  * @brief Stereo imaging for width control
  * 
- * Widens the stereo field while keeping low frequencies centered
+ * Widens the stereo field while keeping low frequencies centered: the low
+ * band of the shared split is folded to mono, the others are widened.
  */
 class StereoImager
 {
 public:
     StereoImager();
     
+    /**
+     * @brief Fold the low band to mono and widen the mid and high bands in place
+     */
+    void process(BandSplitter& bands, int numSamples);
+    
+    /**
+     * @brief Set stereo width (0.0 = mono, 1.0 = normal, 2.0 = wide)
+     */
+    void setWidth(float width);
+    
+    double getTailLengthSeconds() const { return 0.0; }
+
+private:
+    float stereoWidth;
+    
+    static void applyWidth(juce::AudioBuffer<float>& band, int numSamples, float width);
+};
+
+//==============================================================================
+/**
+ * @brief Band-split mastering stage shared by the multiband compressor and the stereo imager
+ * 
+ * Splits once, runs the enabled band processors in place, and sums once.
+ */
+class MasteringBands
+{
+public:
+    MasteringBands();
+    
     void prepare(double sampleRate, int maxBlockSize);
     void process(juce::AudioBuffer<float>& buffer, int numSamples);
     void reset();
     
     /**
-     * @brief Set stereo width (0.0 = mono, 1.0 = normal, 2.0 = wide)
+     * @brief Choose which band processors run (audio thread)
      */
-    void setWidth(float width);
+    void setProcessorsEnabled(bool compressorEnabled, bool imagerEnabled);
+    
+    MultibandCompressor& getCompressor() { return compressor; }
+    StereoImager& getImager() { return imager; }
     
     /**
-     * @brief Set frequency below which to keep mono
+     * @brief Get how long output continues after the input stops
      */
-    void setMonoFrequency(float frequency);
+    double getTailLengthSeconds() const;
 
 private:
-    float stereoWidth;
-    float monoFrequency;
+    BandSplitter bands;
+    MultibandCompressor compressor;
+    StereoImager imager;
+    bool compressorEnabled;
+    bool imagerEnabled;
     
-    // Low-pass filter for bass mono processing
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> lowPassFilter;
-    double currentSampleRate;
+    static constexpr float LOW_CROSSOVER_FREQ = 200.0f;
+    static constexpr float HIGH_CROSSOVER_FREQ = 4000.0f;
 };
 
 //==============================================================================
@@ -345,30 +466,33 @@ public:
     void setTargetLUFS(float lufs);
     
     /**
-     * @brief Get current measured loudness
+     * @brief Get current measured loudness (short-term, any thread)
      */
     float getCurrentLUFS() const;
+    
+    /**
+     * @brief Get the BS.1770 meter measuring the input
+     */
+    const LoudnessMeter& getMeter() const { return meter; }
+    
+    double getTailLengthSeconds() const { return 0.0; }
 
 private:
     float targetLUFS;
-    float currentLUFS;
     float currentGain;
     
-    // RMS measurement
-    float rmsSum;
-    int rmsSampleCount;
-    static constexpr int RMS_WINDOW_SIZE = 44100; // 1 second window
-    
+    LoudnessMeter meter;
     double currentSampleRate;
     
-    void updateGain();
+    void updateGain(int numSamples);
 };
 
 //==============================================================================
 /**
- * @brief Final limiter for mastering (-0.1 dB ceiling)
+ * @brief Final limiter for mastering (-0.1 dBTP ceiling)
  * 
- * Ensures the track peaks at -0.1 dB without clipping
+ * Ensures the track's true peak stays under the ceiling after encoding.
+ * The lookahead delays the output; see getLatencySamples().
  */
 class FinalLimiter
 {
@@ -381,9 +505,22 @@ public:
     
     void setCeiling(float dB);
     void setRelease(float ms);
+    void setLookahead(float ms);
+    
+    /**
+     * @brief Get how long output continues after the input stops
+     */
+    double getTailLengthSeconds() const;
+    
+    /**
+     * @brief Get the delay a given lookahead adds
+     */
+    int getLatencySamples(float lookaheadMs) const;
+    
+    float getGainReductionDB() const { return limiter.getGainReductionDB(); }
 
 private:
-    juce::dsp::Limiter<float> limiter;
+    TruePeakLimiter limiter;
 };
 
 //==============================================================================
@@ -396,6 +533,58 @@ private:
 class CinematicAudioEnhancer
 {
 public:
+    /**
+     * @brief Every user-facing setting of the chain, published as one value
+     * 
+     * The setters below edit a copy on the calling thread and publish it;
+     * process() picks up the newest copy once per block, so the audio
+     * thread never locks and a block never sees half of a preset.
+     */
+    struct Parameters
+    {
+        bool highPassEnabled = true;
+        float highPassCutoff = 80.0f;
+        
+        bool presenceEQEnabled = true;
+        float presenceFrequency = 4000.0f;
+        float presenceGain = 3.0f;
+        
+        bool vocalCompressorEnabled = true;
+        float vocalCompressorThreshold = -18.0f;
+        float vocalCompressorRatio = 2.0f;
+        
+        bool cinematicReverbEnabled = true;
+        float cinematicReverbSize = 0.8f;
+        float cinematicReverbMix = 0.25f;
+        float cinematicReverbPreDelay = 30.0f;
+        ReverbMode cinematicReverbMode = ReverbMode::Algorithmic;
+        
+        bool subtleDelayEnabled = false;
+        float subtleDelayTime = 300.0f;
+        float subtleDelayMix = 0.2f;
+        
+        bool modulationEnabled = false;
+        float modulationRate = 0.5f;
+        float modulationDepth = 0.3f;
+        float modulationMix = 0.3f;
+        
+        bool saturationEnabled = false;
+        float saturationDrive = 0.2f;
+        int saturationOversampling = 1;
+        
+        bool multibandCompressorEnabled = true;
+        
+        bool stereoImagerEnabled = true;
+        float stereoWidth = 1.2f;
+        
+        bool loudnessNormalizerEnabled = true;
+        float targetLUFS = -14.0f;
+        
+        bool finalLimiterEnabled = true;
+        float limiterCeiling = -0.1f;
+        float limiterLookahead = 1.5f;
+    };
+    
     CinematicAudioEnhancer();
     ~CinematicAudioEnhancer();
     
@@ -414,6 +603,27 @@ public:
      */
     void reset();
     
+    /**
+     * @brief Get the combined tail of every enabled stage
+     */
+    double getTailLengthSeconds() const;
+    
+    /**
+     * @brief Get the delay the enabled stages add (saturation oversampling,
+     *        limiter lookahead)
+     */
+    int getLatencySamples() const;
+    
+    /**
+     * @brief Get the most recently set parameters
+     */
+    Parameters getParameters() const;
+    
+    /**
+     * @brief Replace every parameter at once (lock-free for the audio thread)
+     */
+    void setParameters(const Parameters& newParameters);
+    
     //==========================================================================
     // Vocal Processing
     //==========================================================================
@@ -433,6 +643,13 @@ public:
     void setCinematicReverbSize(float size);
     void setCinematicReverbMix(float mix);
     void setCinematicReverbPreDelay(float ms);
+    void setCinematicReverbMode(ReverbMode mode);
+    
+    /**
+     * @brief Load the hall impulse response for convolution mode (not the audio thread)
+     */
+    bool loadCinematicReverbImpulseResponse(const juce::File& file);
+    bool loadCinematicReverbImpulseResponse(const void* data, size_t numBytes);
     
     void setSubtleDelayEnabled(bool enabled);
     void setSubtleDelayTime(float ms);
@@ -449,6 +666,7 @@ public:
     
     void setSaturationEnabled(bool enabled);
     void setSaturationDrive(float drive);
+    void setSaturationOversampling(int factor);
     
     //==========================================================================
     // Mastering Chain
@@ -464,6 +682,7 @@ public:
     
     void setFinalLimiterEnabled(bool enabled);
     void setLimiterCeiling(float dB);
+    void setLimiterLookahead(float ms);
     
     //==========================================================================
     // Preset Management
@@ -491,6 +710,34 @@ public:
      * @brief Get current loudness measurement
      */
     float getCurrentLUFS() const;
+    
+    /**
+     * @brief Get the final limiter's gain reduction in dB (0 or negative)
+     */
+    float getLimiterGainReductionDB() const { return finalLimiter.getGainReductionDB(); }
+    
+    /**
+     * @brief Time each stage into a profiler (audio stopped)
+     * @param profiler Profiler to record into (nullptr = off)
+     */
+    void setProfiler(RealtimeProfiler* profiler);
+    
+    //==========================================================================
+    // CPU Governor (any thread; not part of the parameters or presets)
+    //==========================================================================
+    
+    /**
+     * @brief Cap the saturation oversampling actually run
+     * 
+     * Unlike setSaturationOversampling() the latency stays that of the set
+     * factor, so the host's compensation holds while the governor works.
+     */
+    void setSaturationOversamplingLimit(int maxFactor) { warmSaturation.setOversamplingLimit(maxFactor); }
+    
+    /**
+     * @brief Convolve no more than this much of the reverb's impulse response (<= 0 = all)
+     */
+    void setCinematicReverbTailLimit(double seconds) { cinematicReverb.setTailLimitSeconds(seconds); }
 
 private:
     double currentSampleRate;
@@ -514,27 +761,57 @@ private:
     //==========================================================================
     // Mastering Chain Components
     //==========================================================================
-    MultibandCompressor multibandCompressor;
-    StereoImager stereoImager;
+    MasteringBands masteringBands;          // multiband compressor and stereo imager
     LoudnessNormalizer loudnessNormalizer;
     FinalLimiter finalLimiter;
     
     //==========================================================================
-    // Enable Flags
+    // Parameter Handoff
+    //==========================================================================
+    juce::CriticalSection editLock;                 // serializes writers only
+    Parameters editedParameters;                    // guarded by editLock
+    ParameterSnapshot<Parameters> parameterSnapshot;
+    Parameters appliedParameters;                   // audio thread: pushed into the stages
+    
+    //==========================================================================
+    // Silence Bypass (one gate per stage, in processing order)
     //==========================================================================
-    bool highPassEnabled;
-    bool presenceEQEnabled;
-    bool vocalCompressorEnabled;
-    bool cinematicReverbEnabled;
-    bool subtleDelayEnabled;
-    bool modulationEnabled;
-    bool saturationEnabled;
-    bool multibandCompressorEnabled;
-    bool stereoImagerEnabled;
-    bool loudnessNormalizerEnabled;
-    bool finalLimiterEnabled;
-    
-    juce::CriticalSection processLock;
+    enum StageIndex
+    {
+        HighPassStage,
+        PresenceEQStage,
+        VocalCompressorStage,
+        ModulationStage,
+        SaturationStage,
+        SubtleDelayStage,
+        CinematicReverbStage,
+        MasteringBandsStage,
+        LoudnessNormalizerStage,
+        FinalLimiterStage,
+        NumStages
+    };
+    
+    std::array<SilenceGate, NumStages> stageGates;
+    
+    // Stage ids in the profiler, if one is set
+    RealtimeProfiler* profiler = nullptr;
+    std::array<int, NumStages> profileStages {};
+    
+    /**
+     * @brief Edit the parameters under editLock and publish the result
+     */
+    template <typename EditFunction>
+    void editParameters(EditFunction&& edit)
+    {
+        const juce::ScopedLock sl(editLock);
+        edit(editedParameters);
+        parameterSnapshot.publish(editedParameters);
+    }
+    
+    /**
+     * @brief Push the values that differ from the applied ones into the stages
+     */
+    void applyParameters(const Parameters& parameters, bool force);
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CinematicAudioEnhancer)
 };
@@ -20,10 +20,15 @@ DAWAutomation::DAWAutomation(juce::AudioProcessor& processor)
     
     parameterCallback = std::make_unique<ParameterCallback>(*this);
     
-    // Add listener for all parameters
-    for (const auto& paramID : getAllParameterIDs())
+    const auto parameterIDs = getAllParameterIDs();
+    jassert(parameterIDs.size() == static_cast<int>(AutomationParameter::NumParameters));
+    
+    // Add listener for all parameters and cache their values for the audio thread
+    for (int i = 0; i < parameterIDs.size(); ++i)
     {
-        apvts->addParameterListener(paramID, parameterCallback.get());
+        apvts->addParameterListener(parameterIDs[i], parameterCallback.get());
+        rawParameters[static_cast<size_t>(i)] = apvts->getRawParameterValue(parameterIDs[i]);
+        jassert(rawParameters[static_cast<size_t>(i)] != nullptr);
     }
     
     Logger::log(Logger::Level::Info, "DAW Automation initialized with " + 
@@ -304,6 +309,19 @@ float DAWAutomation::getParameterValue(const juce::String& parameterID) const
     return 0.0f;
 }
 
+float DAWAutomation::getParameterValue(AutomationParameter parameter) const
+{
+    if (auto* value = rawParameters[static_cast<size_t>(parameter)])
+        return value->load(std::memory_order_relaxed);
+    return 0.0f;
+}
+
+void DAWAutomation::getSnapshot(AutomationSnapshot& snapshot) const
+{
+    for (size_t i = 0; i < rawParameters.size(); ++i)
+        snapshot.values[i] = rawParameters[i] != nullptr ? rawParameters[i]->load(std::memory_order_relaxed) : 0.0f;
+}
+
 void DAWAutomation::setParameterValue(const juce::String& parameterID, float value)
 {
     if (auto* param = apvts->getParameter(parameterID))
@@ -577,6 +595,7 @@ ToneShaperEffect::ToneShaperEffect()
     , warmthAmount(0.5f)
     , airAmount(0.5f)
     , currentSampleRate(44100.0)
+    , bands(NumBands)
 {
 }
 
@@ -584,23 +603,13 @@ ToneShaperEffect::~ToneShaperEffect()
 {
 }
 
-void ToneShaperEffect::prepare(double sampleRate, int maxBlockSize)
+void ToneShaperEffect::prepare(double sampleRate, int /*maxBlockSize*/)
 {
     currentSampleRate = sampleRate;
     
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = maxBlockSize;
-    spec.numChannels = 2;
-    
-    lowShelf.prepare(spec);
-    midPeak.prepare(spec);
-    highShelf.prepare(spec);
-    presenceFilter.prepare(spec);
-    warmthFilter.prepare(spec);
-    airFilter.prepare(spec);
-    
     updateFilters();
+    
+    bands.prepare(2);
 }
 
 void ToneShaperEffect::process(juce::AudioBuffer<float>& buffer, int numSamples)
@@ -608,26 +617,13 @@ void ToneShaperEffect::process(juce::AudioBuffer<float>& buffer, int numSamples)
     if (!enabled)
         return;
     
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
-    
-    // Apply all filters in sequence
-    lowShelf.process(context);
-    midPeak.process(context);
-    highShelf.process(context);
-    presenceFilter.process(context);
-    warmthFilter.process(context);
-    airFilter.process(context);
+    // Apply all filters in sequence, in one pass over the buffer
+    bands.process(buffer, numSamples);
 }
 
 void ToneShaperEffect::reset()
 {
-    lowShelf.reset();
-    midPeak.reset();
-    highShelf.reset();
-    presenceFilter.reset();
-    warmthFilter.reset();
-    airFilter.reset();
+    bands.reset();
 }
 
 void ToneShaperEffect::setLowGain(float dB)
@@ -670,33 +666,33 @@ void ToneShaperEffect::updateFilters()
 {
     // Low shelf at 200 Hz
     float lowGainLinear = dBToGain(lowGain);
-    *lowShelf.state = *juce::dsp::IIR::Coefficients<float>::makeLowShelf(
-        currentSampleRate, 200.0f, 0.7f, lowGainLinear);
+    bands.setCoefficients(LowShelfBand, BiquadCoefficients::makeLowShelf(
+        currentSampleRate, 200.0f, 0.7f, lowGainLinear));
     
     // Mid peak at 1000 Hz
     float midGainLinear = dBToGain(midGain);
-    *midPeak.state = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        currentSampleRate, 1000.0f, 1.0f, midGainLinear);
+    bands.setCoefficients(MidPeakBand, BiquadCoefficients::makePeakFilter(
+        currentSampleRate, 1000.0f, 1.0f, midGainLinear));
     
     // High shelf at 8000 Hz
     float highGainLinear = dBToGain(highGain);
-    *highShelf.state = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-        currentSampleRate, 8000.0f, 0.7f, highGainLinear);
+    bands.setCoefficients(HighShelfBand, BiquadCoefficients::makeHighShelf(
+        currentSampleRate, 8000.0f, 0.7f, highGainLinear));
     
     // Presence at 4000 Hz
     float presenceGain = dBToGain((presenceAmount - 0.5f) * 12.0f); // ±6dB range
-    *presenceFilter.state = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        currentSampleRate, 4000.0f, 1.0f, presenceGain);
+    bands.setCoefficients(PresenceBand, BiquadCoefficients::makePeakFilter(
+        currentSampleRate, 4000.0f, 1.0f, presenceGain));
     
     // Warmth at 250 Hz
     float warmthGain = dBToGain((warmthAmount - 0.5f) * 6.0f); // ±3dB range
-    *warmthFilter.state = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-        currentSampleRate, 250.0f, 0.8f, warmthGain);
+    bands.setCoefficients(WarmthBand, BiquadCoefficients::makePeakFilter(
+        currentSampleRate, 250.0f, 0.8f, warmthGain));
     
     // Air at 12000 Hz
     float airGain = dBToGain((airAmount - 0.5f) * 8.0f); // ±4dB range
-    *airFilter.state = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-        currentSampleRate, 12000.0f, 0.7f, airGain);
+    bands.setCoefficients(AirBand, BiquadCoefficients::makeHighShelf(
+        currentSampleRate, 12000.0f, 0.7f, airGain));
 }
 
 } // namespace MAEVN
@@ -10,10 +10,12 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
 #include <memory>
 #include <vector>
 #include <functional>
 #include "Utilities.h"
+#include "SmoothedBiquad.h"
 
 namespace MAEVN
 {
@@ -86,6 +88,76 @@ namespace AutomationIDs
     static const juce::String AIHarmonyDepth = "aiHarmonyDepth";
 }
 
+//==============================================================================
+/**
+ * @brief Dense index of every automatable parameter, in getAllParameterIDs() order
+ * 
+ * Used on the audio thread instead of the string IDs above.
+ */
+enum class AutomationParameter
+{
+    MasterVolume,
+    MasterPan,
+    BPM,
+    GhostChoirEnabled,
+    GhostChoirVoices,
+    GhostChoirSpread,
+    GhostChoirDepth,
+    GhostChoirMix,
+    GhostChoirPitch,
+    GhostChoirDetune,
+    ToneShaperEnabled,
+    ToneShaperLow,
+    ToneShaperMid,
+    ToneShaperHigh,
+    ToneShaperPresence,
+    ToneShaperWarmth,
+    ToneShaperAir,
+    CinematicEnabled,
+    CinematicReverbSize,
+    CinematicReverbMix,
+    CinematicDelayTime,
+    CinematicDelayMix,
+    CinematicModulation,
+    CinematicSaturation,
+    CompressorThreshold,
+    CompressorRatio,
+    CompressorAttack,
+    CompressorRelease,
+    EQLowGain,
+    EQMidGain,
+    EQHighGain,
+    LimiterCeiling,
+    LimiterRelease,
+    Track0FXMode,
+    Track1FXMode,
+    Track2FXMode,
+    Track3FXMode,
+    Track4FXMode,
+    Track5FXMode,
+    AIProcessingEnabled,
+    AIAutotuneStrength,
+    AIVocalClarity,
+    AIHarmonyDepth,
+    NumParameters
+};
+
+//==============================================================================
+/**
+ * @brief Values of every automatable parameter for one block
+ * 
+ * Filled from cached raw parameter pointers, so reading all of them costs
+ * one atomic load each and no string lookups.
+ */
+struct AutomationSnapshot
+{
+    std::array<float, static_cast<size_t>(AutomationParameter::NumParameters)> values {};
+    
+    float get(AutomationParameter parameter) const { return values[static_cast<size_t>(parameter)]; }
+    bool getBool(AutomationParameter parameter) const { return get(parameter) >= 0.5f; }
+    int getInt(AutomationParameter parameter) const { return juce::roundToInt(get(parameter)); }
+};
+
 //==============================================================================
 /**
  * @brief Parameter listener interface for automation changes
@@ -128,6 +200,16 @@ public:
      */
     float getParameterValue(const juce::String& parameterID) const;
     
+    /**
+     * @brief Get parameter value by index (realtime safe, no string lookup)
+     */
+    float getParameterValue(AutomationParameter parameter) const;
+    
+    /**
+     * @brief Read every parameter for the current block (realtime safe)
+     */
+    void getSnapshot(AutomationSnapshot& snapshot) const;
+    
     /**
      * @brief Set parameter value by ID (for internal use)
      * @param parameterID The parameter identifier
@@ -204,6 +286,9 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState> apvts;
     std::vector<AutomationListener*> listeners;
     
+    // Cached once at construction; the APVTS owns the values
+    std::array<std::atomic<float>*, static_cast<size_t>(AutomationParameter::NumParameters)> rawParameters {};
+    
     /**
      * @brief Create parameter layout for APVTS
      */
@@ -319,19 +404,10 @@ private:
     
     double currentSampleRate;
     
-    // Multi-band filters
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> lowShelf;
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> midPeak;
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> highShelf;
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> presenceFilter;
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> warmthFilter;
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> airFilter;
+    // Multi-band filters, one cascade section each in processing order
+    enum Band { LowShelfBand = 0, MidPeakBand, HighShelfBand, PresenceBand, WarmthBand, AirBand, NumBands };
+    
+    BiquadCascade bands;
     
     void updateFilters();
 };
@@ -14,6 +14,15 @@
 #include <cmath>
 #include <array>
 #include "Utilities.h"
+#include "SmoothedBiquad.h"
+#include "Waveshaper.h"
+#include "PartitionedConvolver.h"
+#include "BandSplitter.h"
+#include "TruePeakLimiter.h"
+#include "MultiTapDelay.h"
+#include "Dynamics.h"
+#include "PitchTracker.h"
+#include "MultiVoicePitchShifter.h"
 
 namespace dspmodules
 {
@@ -48,97 +57,35 @@ public:
     {
         currentSampleRate = spec.sampleRate;
         
-        lowCrossover.prepare(spec);
-        highCrossover.prepare(spec);
+        bands.setCrossoverFrequencies(lowCrossoverFreq, highCrossoverFreq);
+        bands.prepare(spec.sampleRate, static_cast<int>(spec.maximumBlockSize), static_cast<int>(spec.numChannels));
         
-        lowCrossover.setCutoffFrequency(lowCrossoverFreq);
-        highCrossover.setCutoffFrequency(highCrossoverFreq);
-        
-        lowCrossover.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
-        highCrossover.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
-        
-        lowBandCompressor.prepare(spec);
-        midBandCompressor.prepare(spec);
-        highBandCompressor.prepare(spec);
+        const int maxBlockSize = static_cast<int>(spec.maximumBlockSize);
+        const int numChannels = static_cast<int>(spec.numChannels);
+        lowBandCompressor.prepare(spec.sampleRate, maxBlockSize, numChannels);
+        midBandCompressor.prepare(spec.sampleRate, maxBlockSize, numChannels);
+        highBandCompressor.prepare(spec.sampleRate, maxBlockSize, numChannels);
         
         applyBandSettings();
-        
-        lowBandBuffer.setSize(static_cast<int>(spec.numChannels), static_cast<int>(spec.maximumBlockSize));
-        midBandBuffer.setSize(static_cast<int>(spec.numChannels), static_cast<int>(spec.maximumBlockSize));
-        highBandBuffer.setSize(static_cast<int>(spec.numChannels), static_cast<int>(spec.maximumBlockSize));
     }
 
     void process(juce::AudioBuffer<float>& buffer)
     {
-        int numSamples = buffer.getNumSamples();
-        int numChannels = buffer.getNumChannels();
-        
-        // Copy input to band buffers
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            lowBandBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
-            midBandBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
-            highBandBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
-        }
+        const int numSamples = buffer.getNumSamples();
         
-        // Apply crossover filters
-        juce::dsp::AudioBlock<float> lowBlock(lowBandBuffer);
-        juce::dsp::AudioBlock<float> highBlock(highBandBuffer);
+        // Split once, compress each band in place, sum once
+        bands.split(buffer, numSamples);
         
-        juce::dsp::ProcessContextReplacing<float> lowContext(lowBlock);
-        juce::dsp::ProcessContextReplacing<float> highContext(highBlock);
+        lowBandCompressor.process(bands.getBand(MAEVN::BandSplitter::Low), numSamples);
+        midBandCompressor.process(bands.getBand(MAEVN::BandSplitter::Mid), numSamples);
+        highBandCompressor.process(bands.getBand(MAEVN::BandSplitter::High), numSamples);
         
-        lowCrossover.process(lowContext);
-        highCrossover.process(highContext);
-        
-        // Mid band = original - low - high
-        // midBandBuffer still contains the original input at this point
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            auto* midData = midBandBuffer.getWritePointer(ch);
-            const auto* originalData = buffer.getReadPointer(ch);
-            const auto* lowData = lowBandBuffer.getReadPointer(ch);
-            const auto* highData = highBandBuffer.getReadPointer(ch);
-            
-            for (int i = 0; i < numSamples; ++i)
-            {
-                midData[i] = originalData[i] - lowData[i] - highData[i];
-            }
-        }
-        
-        // Apply compression to each band
-        juce::dsp::AudioBlock<float> lowCompBlock(lowBandBuffer);
-        juce::dsp::AudioBlock<float> midCompBlock(midBandBuffer);
-        juce::dsp::AudioBlock<float> highCompBlock(highBandBuffer);
-        
-        juce::dsp::ProcessContextReplacing<float> lowCompContext(lowCompBlock);
-        juce::dsp::ProcessContextReplacing<float> midCompContext(midCompBlock);
-        juce::dsp::ProcessContextReplacing<float> highCompContext(highCompBlock);
-        
-        lowBandCompressor.process(lowCompContext);
-        midBandCompressor.process(midCompContext);
-        highBandCompressor.process(highCompContext);
-        
-        // Sum bands back together
-        buffer.clear();
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            auto* outputData = buffer.getWritePointer(ch);
-            const auto* lowData = lowBandBuffer.getReadPointer(ch);
-            const auto* midData = midBandBuffer.getReadPointer(ch);
-            const auto* highData = highBandBuffer.getReadPointer(ch);
-            
-            for (int i = 0; i < numSamples; ++i)
-            {
-                outputData[i] = lowData[i] + midData[i] + highData[i];
-            }
-        }
+        bands.combine(buffer, numSamples);
     }
 
     void reset()
     {
-        lowCrossover.reset();
-        highCrossover.reset();
+        bands.reset();
         lowBandCompressor.reset();
         midBandCompressor.reset();
         highBandCompressor.reset();
@@ -163,8 +110,15 @@ public:
     void setHighRelease(float ms) { highBandSettings.release = ms; applyBandSettings(); }
 
     // Crossover frequency controls
-    void setLowCrossoverFreq(float freq) { lowCrossoverFreq = freq; lowCrossover.setCutoffFrequency(freq); }
-    void setHighCrossoverFreq(float freq) { highCrossoverFreq = freq; highCrossover.setCutoffFrequency(freq); }
+    void setLowCrossoverFreq(float freq) { lowCrossoverFreq = freq; bands.setCrossoverFrequencies(lowCrossoverFreq, highCrossoverFreq); }
+    void setHighCrossoverFreq(float freq) { highCrossoverFreq = freq; bands.setCrossoverFrequencies(lowCrossoverFreq, highCrossoverFreq); }
+    
+    /** Deepest reduction of any band during the last block, in dB */
+    float getGainReductionDB() const
+    {
+        return juce::jmin(lowBandCompressor.getGainReductionDB(),
+                          juce::jmin(midBandCompressor.getGainReductionDB(), highBandCompressor.getGainReductionDB()));
+    }
 
 private:
     void applyBandSettings()
@@ -193,16 +147,11 @@ private:
     BandSettings midBandSettings;
     BandSettings highBandSettings;
     
-    juce::dsp::LinkwitzRileyFilter<float> lowCrossover;
-    juce::dsp::LinkwitzRileyFilter<float> highCrossover;
-    
-    juce::dsp::Compressor<float> lowBandCompressor;
-    juce::dsp::Compressor<float> midBandCompressor;
-    juce::dsp::Compressor<float> highBandCompressor;
+    MAEVN::BandSplitter bands;
     
-    juce::AudioBuffer<float> lowBandBuffer;
-    juce::AudioBuffer<float> midBandBuffer;
-    juce::AudioBuffer<float> highBandBuffer;
+    MAEVN::Compressor lowBandCompressor;
+    MAEVN::Compressor midBandCompressor;
+    MAEVN::Compressor highBandCompressor;
 };
 
 //==============================================================================
@@ -218,11 +167,14 @@ public:
     static constexpr float MIN_GAIN = 0.1f;
     static constexpr float MAX_GAIN = 4.0f;
     
+    // Envelope ballistics (1 ms and 50 ms time constants)
+    static constexpr float ENVELOPE_ATTACK_MS = 1.0f * static_cast<float>(MAEVN::TWO_PI);
+    static constexpr float ENVELOPE_RELEASE_MS = 50.0f * static_cast<float>(MAEVN::TWO_PI);
+    
     TransientShaper()
         : attackAmount(0.0f)
         , sustainAmount(0.0f)
         , currentSampleRate(44100.0)
-        , envelopeFollower(0.0f)
         , previousEnvelope(0.0f)
     {
     }
@@ -231,62 +183,42 @@ public:
     {
         currentSampleRate = spec.sampleRate;
         
-        // Calculate envelope follower coefficients
-        attackCoeff = std::exp(-1.0f / static_cast<float>(spec.sampleRate * 0.001f)); // 1ms attack
-        releaseCoeff = std::exp(-1.0f / static_cast<float>(spec.sampleRate * 0.050f)); // 50ms release
+        envelopeFollower.prepare(spec.sampleRate, 1);
+        envelopeFollower.setAttack(ENVELOPE_ATTACK_MS);
+        envelopeFollower.setRelease(ENVELOPE_RELEASE_MS);
+        
+        envelope.assign(static_cast<size_t>(spec.maximumBlockSize), 0.0f);
+        gains.assign(static_cast<size_t>(spec.maximumBlockSize), 1.0f);
     }
 
     void process(juce::AudioBuffer<float>& buffer)
     {
-        int numSamples = buffer.getNumSamples();
-        int numChannels = buffer.getNumChannels();
+        const int numChannels = buffer.getNumChannels();
+        const int numSamples = juce::jmin(buffer.getNumSamples(), static_cast<int>(envelope.size()));
+        if (numSamples <= 0)
+            return;
         
-        for (int i = 0; i < numSamples; ++i)
-        {
-            // Calculate envelope from all channels
-            float inputLevel = 0.0f;
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                inputLevel += std::abs(buffer.getSample(ch, i));
-            }
-            inputLevel /= static_cast<float>(numChannels);
-            
-            // Envelope follower
-            float coeff = (inputLevel > envelopeFollower) ? attackCoeff : releaseCoeff;
-            envelopeFollower = envelopeFollower * coeff + inputLevel * (1.0f - coeff);
-            
-            // Detect transients (rate of change of envelope)
-            float envelopeDelta = envelopeFollower - previousEnvelope;
-            previousEnvelope = envelopeFollower;
-            
-            // Calculate gain modification
-            float transientGain = 1.0f;
-            
-            if (envelopeDelta > 0.0f)
-            {
-                // Attack phase - apply attack shaping
-                transientGain += attackAmount * envelopeDelta * ATTACK_SCALING_FACTOR;
-            }
-            else
-            {
-                // Sustain phase - apply sustain shaping
-                transientGain += sustainAmount * SUSTAIN_SCALING_FACTOR;
-            }
-            
-            transientGain = juce::jlimit(MIN_GAIN, MAX_GAIN, transientGain);
-            
-            // Apply gain to all channels
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                float* sample = buffer.getWritePointer(ch);
-                sample[i] *= transientGain;
-            }
-        }
+        // Envelope of the channel average
+        MAEVN::measureAverageMagnitude(buffer, numChannels, numSamples, envelope.data());
+        envelopeFollower.process(0, envelope.data(), envelope.data(), numSamples);
+        
+        // Rising envelope (a transient) gets the attack gain, the rest the sustain gain
+        const float sustainGain = 1.0f + sustainAmount * SUSTAIN_SCALING_FACTOR;
+        const float attackScale = attackAmount * ATTACK_SCALING_FACTOR;
+        
+        gains[0] = computeGain(envelope[0] - previousEnvelope, attackScale, sustainGain);
+        for (int i = 1; i < numSamples; ++i)
+            gains[static_cast<size_t>(i)] = computeGain(envelope[static_cast<size_t>(i)] - envelope[static_cast<size_t>(i - 1)],
+                                                        attackScale, sustainGain);
+        
+        previousEnvelope = envelope[static_cast<size_t>(numSamples - 1)];
+        
+        MAEVN::applyGainCurve(buffer, numChannels, gains.data(), numSamples);
     }
 
     void reset()
     {
-        envelopeFollower = 0.0f;
+        envelopeFollower.reset();
         previousEnvelope = 0.0f;
     }
 
@@ -294,13 +226,20 @@ public:
     void setSustain(float amount) { sustainAmount = juce::jlimit(-1.0f, 1.0f, amount); }
 
 private:
+    static float computeGain(float envelopeDelta, float attackScale, float sustainGain)
+    {
+        const float gain = envelopeDelta > 0.0f ? 1.0f + attackScale * envelopeDelta : sustainGain;
+        return std::min(std::max(gain, MIN_GAIN), MAX_GAIN);
+    }
+
     float attackAmount;
     float sustainAmount;
     double currentSampleRate;
-    float envelopeFollower;
     float previousEnvelope;
-    float attackCoeff;
-    float releaseCoeff;
+    
+    MAEVN::EnvelopeFollower envelopeFollower;
+    std::vector<float> envelope;
+    std::vector<float> gains;
 };
 
 //==============================================================================
@@ -314,6 +253,8 @@ public:
         : frequency(6000.0f)
         , threshold(-20.0f)
         , ratio(4.0f)
+        , attack(0.5f)
+        , release(20.0f)
         , currentSampleRate(44100.0)
     {
     }
@@ -323,23 +264,22 @@ public:
         currentSampleRate = spec.sampleRate;
         
         // Prepare high-pass filter for sibilance detection
-        sibilanceFilter.prepare(spec);
         updateFilterCoefficients();
+        sibilanceFilter.prepare(static_cast<int>(spec.numChannels));
         
-        // Prepare compressor for gain reduction
-        compressor.prepare(spec);
-        compressor.setThreshold(threshold);
-        compressor.setRatio(ratio);
-        compressor.setAttack(0.5f);
-        compressor.setRelease(20.0f);
+        // Prepare the sibilance envelope
+        sibilanceFollower.prepare(spec.sampleRate, 1);
         
         sideChainBuffer.setSize(static_cast<int>(spec.numChannels), static_cast<int>(spec.maximumBlockSize));
+        gains.assign(static_cast<size_t>(spec.maximumBlockSize), 1.0f);
     }
 
     void process(juce::AudioBuffer<float>& buffer)
     {
-        int numSamples = buffer.getNumSamples();
-        int numChannels = buffer.getNumChannels();
+        const int numChannels = juce::jmin(buffer.getNumChannels(), sideChainBuffer.getNumChannels());
+        const int numSamples = juce::jmin(buffer.getNumSamples(), static_cast<int>(gains.size()));
+        if (numSamples <= 0)
+            return;
         
         // Copy to sidechain buffer and filter
         for (int ch = 0; ch < numChannels; ++ch)
@@ -347,45 +287,26 @@ public:
             sideChainBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
         }
         
-        juce::dsp::AudioBlock<float> sideChainBlock(sideChainBuffer);
-        juce::dsp::ProcessContextReplacing<float> filterContext(sideChainBlock);
-        sibilanceFilter.process(filterContext);
+        sibilanceFilter.process(sideChainBuffer, numSamples);
         
-        // Use filtered signal to control compression on original
-        for (int i = 0; i < numSamples; ++i)
-        {
-            // Measure sibilance level
-            float sibilanceLevel = 0.0f;
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                sibilanceLevel += std::abs(sideChainBuffer.getSample(ch, i));
-            }
-            sibilanceLevel /= static_cast<float>(numChannels);
-            
-            // Calculate gain reduction based on sibilance
-            float thresholdLinear = MAEVN::dBToGain(threshold);
-            float gainReduction = 1.0f;
-            
-            if (sibilanceLevel > thresholdLinear)
-            {
-                float overThreshold = sibilanceLevel / thresholdLinear;
-                float targetGain = 1.0f / std::pow(overThreshold, 1.0f - 1.0f / ratio);
-                gainReduction = targetGain;
-            }
-            
-            // Apply gain reduction to original signal
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                float* sample = buffer.getWritePointer(ch);
-                sample[i] *= gainReduction;
-            }
-        }
+        // Sibilance level -> envelope -> gain reduction, applied to the original signal
+        sibilanceFollower.setAttack(attack);
+        sibilanceFollower.setRelease(release);
+        
+        MAEVN::measureAverageMagnitude(sideChainBuffer, numChannels, numSamples, gains.data());
+        sibilanceFollower.process(0, gains.data(), gains.data(), numSamples);
+        MAEVN::GainComputer::process(gains.data(), numSamples, threshold, ratio);
+        MAEVN::applyGainCurve(buffer, numChannels, gains.data(), numSamples);
+        
+        gainReductionDB.store(MAEVN::gainReductionFromGain(juce::FloatVectorOperations::findMinimum(gains.data(), numSamples)),
+                              std::memory_order_relaxed);
     }
 
     void reset()
     {
         sibilanceFilter.reset();
-        compressor.reset();
+        sibilanceFollower.reset();
+        gainReductionDB.store(0.0f);
     }
 
     void setFrequency(float freq)
@@ -394,27 +315,32 @@ public:
         updateFilterCoefficients();
     }
     
-    void setThreshold(float dB) { threshold = juce::jlimit(-60.0f, 0.0f, dB); compressor.setThreshold(threshold); }
-    void setRatio(float r) { ratio = juce::jlimit(1.0f, 20.0f, r); compressor.setRatio(ratio); }
-    void setAttack(float ms) { compressor.setAttack(ms); }
-    void setRelease(float ms) { compressor.setRelease(ms); }
+    void setThreshold(float dB) { threshold = juce::jlimit(-60.0f, 0.0f, dB); }
+    void setRatio(float r) { ratio = juce::jlimit(1.0f, 20.0f, r); }
+    void setAttack(float ms) { attack = juce::jlimit(0.0f, 100.0f, ms); }
+    void setRelease(float ms) { release = juce::jlimit(1.0f, 1000.0f, ms); }
+    
+    /** Deepest reduction during the last block, in dB */
+    float getGainReductionDB() const { return gainReductionDB.load(std::memory_order_relaxed); }
 
 private:
     void updateFilterCoefficients()
     {
-        *sibilanceFilter.state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(
-            currentSampleRate, frequency);
+        sibilanceFilter.setCoefficients(MAEVN::BiquadCoefficients::makeHighPass(currentSampleRate, frequency));
     }
 
     float frequency;
     float threshold;
     float ratio;
+    float attack;
+    float release;
     double currentSampleRate;
     
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> sibilanceFilter;
-    juce::dsp::Compressor<float> compressor;
+    MAEVN::SmoothedBiquad sibilanceFilter;
+    MAEVN::EnvelopeFollower sibilanceFollower;
     juce::AudioBuffer<float> sideChainBuffer;
+    std::vector<float> gains;
+    std::atomic<float> gainReductionDB { 0.0f };
 };
 
 //==============================================================================
@@ -433,53 +359,44 @@ public:
         , outputGain(1.0f)
         , currentSampleRate(44100.0)
     {
+        updateShaperGains();
     }
 
     void prepare(const juce::dsp::ProcessSpec& spec)
     {
         currentSampleRate = spec.sampleRate;
         
+        shaper.prepare(spec.sampleRate, static_cast<int>(spec.maximumBlockSize), static_cast<int>(spec.numChannels));
+        
         // Prepare tone filter
-        toneFilter.prepare(spec);
         updateToneFilter();
+        toneFilter.prepare(static_cast<int>(spec.numChannels));
     }
 
     void process(juce::AudioBuffer<float>& buffer)
     {
         int numSamples = buffer.getNumSamples();
-        int numChannels = buffer.getNumChannels();
         
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            float* data = buffer.getWritePointer(ch);
-            
-            for (int i = 0; i < numSamples; ++i)
-            {
-                // Apply drive
-                float input = data[i] * (1.0f + drive * DRIVE_SCALING_FACTOR);
-                
-                // Soft clipping saturation (tanh waveshaper)
-                float saturated = std::tanh(input);
-                
-                // Apply output gain compensation
-                data[i] = saturated * outputGain;
-            }
-        }
+        // Drive, tanh waveshaper and output gain compensation
+        shaper.process(buffer, numSamples);
         
         // Apply tone filter
-        juce::dsp::AudioBlock<float> block(buffer);
-        juce::dsp::ProcessContextReplacing<float> context(block);
-        toneFilter.process(context);
+        toneFilter.process(buffer, numSamples);
     }
 
     void reset()
     {
+        shaper.reset();
         toneFilter.reset();
     }
 
-    void setDrive(float d) { drive = juce::jlimit(0.0f, 1.0f, d); }
+    void setDrive(float d) { drive = juce::jlimit(0.0f, 1.0f, d); updateShaperGains(); }
     void setTone(float t) { tone = juce::jlimit(0.0f, 1.0f, t); updateToneFilter(); }
-    void setOutput(float dB) { outputGain = MAEVN::dBToGain(juce::jlimit(-24.0f, 12.0f, dB)); }
+    void setOutput(float dB) { outputGain = MAEVN::dBToGain(juce::jlimit(-24.0f, 12.0f, dB)); updateShaperGains(); }
+    
+    /** 1x, 2x or 4x; the host must be told the new getLatencySamples() */
+    void setOversamplingFactor(int factor) { shaper.setOversamplingFactor(factor); }
+    int getLatencySamples() const { return shaper.getLatencySamples(); }
 
 private:
     void updateToneFilter()
@@ -488,8 +405,14 @@ private:
         float filterFreq = 1000.0f + tone * 4000.0f;
         float gainLinear = 0.5f + tone; // 0.5 to 1.5
         
-        *toneFilter.state = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-            currentSampleRate, filterFreq, 0.7f, gainLinear);
+        toneFilter.setCoefficients(MAEVN::BiquadCoefficients::makeHighShelf(
+            currentSampleRate, filterFreq, 0.7f, gainLinear));
+    }
+
+    void updateShaperGains()
+    {
+        shaper.setInputGain(1.0f + drive * DRIVE_SCALING_FACTOR);
+        shaper.setOutputGain(outputGain);
     }
 
     float drive;
@@ -497,8 +420,8 @@ private:
     float outputGain;
     double currentSampleRate;
     
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> toneFilter;
+    MAEVN::Waveshaper shaper;
+    MAEVN::SmoothedBiquad toneFilter;
 };
 
 //==============================================================================
@@ -521,8 +444,8 @@ public:
         currentSampleRate = spec.sampleRate;
         
         // Prepare low-pass filter for bass mono processing
-        bassFilter.prepare(spec);
         updateFilterCoefficients();
+        bassFilter.prepare(static_cast<int>(spec.numChannels));
     }
 
     void process(juce::AudioBuffer<float>& buffer)
@@ -565,8 +488,7 @@ public:
 private:
     void updateFilterCoefficients()
     {
-        *bassFilter.state = *juce::dsp::IIR::Coefficients<float>::makeLowPass(
-            currentSampleRate, frequency);
+        bassFilter.setCoefficients(MAEVN::BiquadCoefficients::makeLowPass(currentSampleRate, frequency));
     }
 
     float width;
@@ -574,13 +496,16 @@ private:
     float outputGain;
     double currentSampleRate;
     
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> bassFilter;
+    MAEVN::SmoothedBiquad bassFilter;
 };
 
 //==============================================================================
 /**
  * @brief Limiter effect with Threshold and Ceiling controls
+ * 
+ * Signal at the threshold is raised to the ceiling, and true peaks above it
+ * are held there. The attack time is the limiter's lookahead, which delays
+ * the output; see getLatencySamples().
  */
 class Limiter
 {
@@ -588,37 +513,20 @@ public:
     Limiter()
         : threshold(-1.0f)
         , ceiling(-0.1f)
-        , attack(0.5f)
+        , attack(1.5f)
         , release(50.0f)
     {
+        applySettings();
     }
 
     void prepare(const juce::dsp::ProcessSpec& spec)
     {
-        limiter.prepare(spec);
-        limiter.setThreshold(threshold);
-        limiter.setRelease(release);
+        limiter.prepare(spec.sampleRate, static_cast<int>(spec.maximumBlockSize), static_cast<int>(spec.numChannels));
     }
 
     void process(juce::AudioBuffer<float>& buffer)
     {
-        juce::dsp::AudioBlock<float> block(buffer);
-        juce::dsp::ProcessContextReplacing<float> context(block);
-        limiter.process(context);
-        
-        // Apply ceiling
-        float ceilingLinear = MAEVN::dBToGain(ceiling);
-        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-        {
-            float* data = buffer.getWritePointer(ch);
-            for (int i = 0; i < buffer.getNumSamples(); ++i)
-            {
-                if (data[i] > ceilingLinear)
-                    data[i] = ceilingLinear;
-                else if (data[i] < -ceilingLinear)
-                    data[i] = -ceilingLinear;
-            }
-        }
+        limiter.process(buffer, buffer.getNumSamples());
     }
 
     void reset()
@@ -626,18 +534,31 @@ public:
         limiter.reset();
     }
 
-    void setThreshold(float dB) { threshold = juce::jlimit(-24.0f, 0.0f, dB); limiter.setThreshold(threshold); }
-    void setCeiling(float dB) { ceiling = juce::jlimit(-12.0f, 0.0f, dB); }
-    void setAttack(float ms) { attack = juce::jlimit(0.1f, 50.0f, ms); }
-    void setRelease(float ms) { release = juce::jlimit(1.0f, 500.0f, ms); limiter.setRelease(release); }
+    void setThreshold(float dB) { threshold = juce::jlimit(-24.0f, 0.0f, dB); applySettings(); }
+    void setCeiling(float dB) { ceiling = juce::jlimit(-12.0f, 0.0f, dB); applySettings(); }
+    
+    /** Lookahead time; the host must be told the new getLatencySamples() */
+    void setAttack(float ms) { attack = juce::jlimit(0.0f, MAEVN::TruePeakLimiter::MAX_LOOKAHEAD_MS, ms); applySettings(); }
+    void setRelease(float ms) { release = juce::jlimit(1.0f, 500.0f, ms); applySettings(); }
+    
+    int getLatencySamples() const { return limiter.getLatencySamples(); }
+    float getGainReductionDB() const { return limiter.getGainReductionDB(); }
 
 private:
+    void applySettings()
+    {
+        limiter.setInputGain(ceiling - threshold);
+        limiter.setCeiling(ceiling);
+        limiter.setLookahead(attack);
+        limiter.setRelease(release);
+    }
+
     float threshold;
     float ceiling;
     float attack;
     float release;
     
-    juce::dsp::Limiter<float> limiter;
+    MAEVN::TruePeakLimiter limiter;
 };
 
 //==============================================================================
@@ -651,6 +572,9 @@ public:
     static constexpr float DRIFT_FREQUENCY_FACTOR = 0.001f;
     static constexpr float DRIFT_AMPLITUDE_FACTOR = 0.01f;
     
+    // Detune of each harmony voice at full humanize, in cents
+    static constexpr float HUMANIZE_DETUNE_CENTS[4] = { 6.0f, -8.0f, 4.0f, -5.0f };
+    
     PTHVocalClone()
         : pitchCorrection(0.0f)  // semitones (-12 to +12)
         , correctionSpeed(50.0f) // ms (10 to 100)
@@ -661,6 +585,9 @@ public:
         , harmonyEnabled(false)
         , humanize(0.3f)         // random variation amount
         , currentSampleRate(44100.0)
+        , timbreFilters(NumTimbreFilters)
+        , pitchSource(nullptr)
+        , correctionTarget(0.0f)
     {
         for (int i = 0; i < 4; ++i)
         {
@@ -673,37 +600,28 @@ public:
     {
         currentSampleRate = spec.sampleRate;
         
-        // Prepare brightness filter
-        brightnessFilter.prepare(spec);
+        // Prepare brightness and formant filters
         updateBrightnessFilter();
-        
-        // Prepare formant filter
-        formantFilter.prepare(spec);
         updateFormantFilter();
+        timbreFilters.prepare(static_cast<int>(spec.numChannels));
         
-        // Initialize delay lines for pitch shifting (simple approach)
-        for (auto& delay : pitchDelays)
-        {
-            delay.prepare(spec);
-            delay.setMaximumDelayInSamples(static_cast<int>(spec.sampleRate * 0.1)); // 100ms max
-        }
+        // One analysis feeds the corrected lead and every harmony voice
+        voiceShifter.prepare(spec.sampleRate, static_cast<int>(spec.maximumBlockSize),
+                             static_cast<int>(spec.numChannels));
     }
 
     void process(juce::AudioBuffer<float>& buffer)
     {
         int numSamples = buffer.getNumSamples();
         
-        // Apply brightness filter (timbre)
-        juce::dsp::AudioBlock<float> block(buffer);
-        juce::dsp::ProcessContextReplacing<float> context(block);
-        brightnessFilter.process(context);
+        updateCorrection(numSamples);
+        updateVoices();
         
-        // Apply formant filter for timbre shaping
-        formantFilter.process(context);
+        // Corrected lead plus harmonies, replacing the dry voice
+        voiceShifter.process(buffer, numSamples);
         
-        // Note: Full pitch correction and harmony generation would require 
-        // FFT-based processing and complex algorithms. This is a simplified
-        // implementation that demonstrates the structure.
+        // Apply brightness (timbre) and formant filters in one pass
+        timbreFilters.process(buffer, numSamples);
         
         // Apply spectral shaping (simplified as EQ adjustment)
         for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
@@ -720,14 +638,35 @@ public:
 
     void reset()
     {
-        brightnessFilter.reset();
-        formantFilter.reset();
-        for (auto& delay : pitchDelays)
-        {
-            delay.reset();
-        }
+        timbreFilters.reset();
+        voiceShifter.reset();
+        
+        correctionTarget = 0.0f;
+        correctionSemitones.store(0.0f);
     }
 
+    /**
+     * @brief Read the input's pitch from a shared tracker (nullptr for none)
+     */
+    void setPitchSource(const MAEVN::PitchTracker* source) { pitchSource = source; }
+    
+    /**
+     * @brief Detected input pitch in Hz (0 when unvoiced or without a source)
+     */
+    float getDetectedPitch() const { return pitchSource != nullptr ? pitchSource->getFrequency() : 0.0f; }
+    
+    /**
+     * @brief Shift the voice needs, in semitones: the detected note snapped to
+     *        the nearest semitone plus the pitch correction offset, reached
+     *        over the correction speed and held through unvoiced passages
+     */
+    float getCorrectionSemitones() const { return correctionSemitones.load(); }
+    
+    /**
+     * @brief Delay of the voice path (valid after prepare)
+     */
+    int getLatencySamples() const { return voiceShifter.getLatencySamples(); }
+
     // Pitch controls
     void setPitchCorrection(float semitones) { pitchCorrection = juce::jlimit(-12.0f, 12.0f, semitones); }
     void setCorrectionSpeed(float ms) { correctionSpeed = juce::jlimit(10.0f, 100.0f, ms); }
@@ -777,12 +716,47 @@ public:
     }
 
 private:
+    void updateCorrection(int numSamples)
+    {
+        if (pitchSource != nullptr && pitchSource->hasPitch())
+        {
+            const float note = pitchSource->getMidiNote();
+            correctionTarget = std::round(note) - note;
+        }
+        
+        const float target = correctionTarget + pitchCorrection;
+        const float coefficient = std::exp(-1000.0f * static_cast<float>(numSamples)
+                                           / (correctionSpeed * static_cast<float>(currentSampleRate)));
+        const float current = correctionSemitones.load(std::memory_order_relaxed);
+        float next = target + coefficient * (current - target);
+        
+        // Land exactly so an uncorrected lead stays an unprocessed voice
+        if (std::abs(next - target) < 1.0e-4f)
+            next = target;
+        
+        correctionSemitones.store(next, std::memory_order_relaxed);
+    }
+    
+    void updateVoices()
+    {
+        const float lead = correctionSemitones.load(std::memory_order_relaxed);
+        voiceShifter.setVoice(0, lead, 1.0f);
+        
+        // A harmony voice left at 0 semitones is off
+        for (int i = 0; i < 4; ++i)
+        {
+            const bool active = harmonyEnabled && harmonyVoices[i] != 0.0f;
+            const float detune = humanize * HUMANIZE_DETUNE_CENTS[i] / 100.0f;
+            voiceShifter.setVoice(i + 1, lead + harmonyVoices[i] + detune, active ? harmonyLevels[i] : 0.0f);
+        }
+    }
+    
     void updateBrightnessFilter()
     {
         float freq = 2000.0f + brightness * 6000.0f;
         float gain = 0.7f + brightness * 0.6f;
-        *brightnessFilter.state = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-            currentSampleRate, freq, 0.7f, gain);
+        timbreFilters.setCoefficients(BrightnessFilter, MAEVN::BiquadCoefficients::makeHighShelf(
+            currentSampleRate, freq, 0.7f, gain));
     }
     
     void updateFormantFilter()
@@ -790,8 +764,8 @@ private:
         // Simplified formant shifting using a peak filter
         float freq = 1000.0f * std::pow(2.0f, formantShift / 12.0f);
         freq = juce::jlimit(200.0f, 5000.0f, freq);
-        *formantFilter.state = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-            currentSampleRate, freq, 2.0f, 1.2f);
+        timbreFilters.setCoefficients(FormantFilter, MAEVN::BiquadCoefficients::makePeakFilter(
+            currentSampleRate, freq, 2.0f, 1.2f));
     }
 
     float pitchCorrection;
@@ -806,25 +780,40 @@ private:
     float humanize;
     double currentSampleRate;
     
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> brightnessFilter;
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> formantFilter;
-    std::array<juce::dsp::DelayLine<float>, 4> pitchDelays;
+    // Brightness shelf then formant peak, as sections of one cascade
+    enum TimbreFilter { BrightnessFilter = 0, FormantFilter, NumTimbreFilters };
+    MAEVN::BiquadCascade timbreFilters;
+    MAEVN::MultiVoicePitchShifter voiceShifter;
+    
+    // Pitch correction (audio thread)
+    const MAEVN::PitchTracker* pitchSource;
+    float correctionTarget;
+    std::atomic<float> correctionSemitones { 0.0f };
 };
 
 //==============================================================================
 /**
  * @brief Epic Space Reverb with advanced reverb controls
+ * 
+ * The late field is Freeverb or, in convolution mode, a loaded impulse
+ * response; pre-delay, early reflections and damping are shared.
  */
 class EpicSpaceReverb
 {
 public:
     // Constants for reverb calculations
     static constexpr float EARLY_REFLECTIONS_MIX = 0.3f;
-    static constexpr float ER_DECAY_FACTOR = 0.1f;
     static constexpr float ROOM_SHAPE_OFFSET = 0.5f;
     
+    // Early reflections: NUM_EARLY_REFLECTIONS taps between the first and
+    // last arrival, the last ER_DECAY quieter than the first, scaled to the
+    // same energy whatever the tap count
+    static constexpr int NUM_EARLY_REFLECTIONS = 32;
+    static constexpr float ER_FIRST_MS = 5.0f;
+    static constexpr float ER_LAST_MS = 61.0f;
+    static constexpr float ER_DECAY = 0.7f;
+    static constexpr float ER_ENERGY = 3.8f;
+    
     EpicSpaceReverb()
         : roomSize(0.7f)
         , decayTime(2.5f)
@@ -836,6 +825,9 @@ public:
         , reverbTail(0.8f)
         , roomShape(0.5f)
         , currentSampleRate(44100.0)
+        , activeMode(MAEVN::ReverbMode::Algorithmic)
+        , tapsEarlyReflections(-1.0f)
+        , tapsRoomShape(-1.0f)
     {
     }
 
@@ -846,24 +838,21 @@ public:
         reverb.prepare(spec);
         updateReverbParameters();
         
+        convolver.prepare(spec.sampleRate, static_cast<int>(spec.maximumBlockSize), static_cast<int>(spec.numChannels));
+        activeMode = mode.load();
+        
         preDelayLine.prepare(spec);
         preDelayLine.setMaximumDelayInSamples(static_cast<int>(spec.sampleRate * 0.2)); // 200ms max pre-delay
         updatePreDelay();
         
-        // Prepare early reflections delay lines
-        for (int i = 0; i < 8; ++i)
-        {
-            earlyReflectionDelays[i].prepare(spec);
-            earlyReflectionDelays[i].setMaximumDelayInSamples(static_cast<int>(spec.sampleRate * 0.1));
-            
-            // Set different delay times for early reflections
-            float delayMs = 5.0f + static_cast<float>(i) * 8.0f; // 5ms, 13ms, 21ms, etc.
-            earlyReflectionDelays[i].setDelay(static_cast<float>(delayMs * spec.sampleRate / 1000.0));
-        }
+        // Prepare the early reflection taps
+        earlyReflectionTaps.prepare(spec.sampleRate, static_cast<int>(spec.maximumBlockSize),
+                                    static_cast<int>(spec.numChannels), ER_LAST_MS / 1000.0);
+        updateEarlyReflections();
         
         // Prepare damping filter
-        dampingFilter.prepare(spec);
         updateDampingFilter();
+        dampingFilter.prepare(static_cast<int>(spec.numChannels));
         
         wetBuffer.setSize(static_cast<int>(spec.numChannels), static_cast<int>(spec.maximumBlockSize));
     }
@@ -890,40 +879,37 @@ public:
             }
         }
         
-        // Apply early reflections
-        if (earlyReflections > 0.0f)
+        // Apply early reflections (the taps keep hearing the input at zero level)
+        if (earlyReflections != tapsEarlyReflections || roomShape != tapsRoomShape)
+            updateEarlyReflections();
+        
+        earlyReflectionTaps.process(wetBuffer, numSamples);
+        
+        // Whatever the other engine last heard is stale by now
+        const auto currentMode = mode.load();
+        if (currentMode != activeMode)
         {
-            for (int i = 0; i < numSamples; ++i)
-            {
-                for (int ch = 0; ch < numChannels; ++ch)
-                {
-                    float* wetData = wetBuffer.getWritePointer(ch);
-                    float earlySum = 0.0f;
-                    
-                    for (int er = 0; er < 8; ++er)
-                    {
-                        float erSample = earlyReflectionDelays[er].popSample(ch);
-                        earlyReflectionDelays[er].pushSample(ch, wetData[i]);
-                        
-                        // Apply room shape (affects reflection pattern)
-                        float erGain = (1.0f - static_cast<float>(er) * ER_DECAY_FACTOR) * earlyReflections;
-                        erGain *= (ROOM_SHAPE_OFFSET + roomShape * ROOM_SHAPE_OFFSET);
-                        earlySum += erSample * erGain;
-                    }
-                    
-                    wetData[i] += earlySum * EARLY_REFLECTIONS_MIX;
-                }
-            }
+            activeMode = currentMode;
+            if (activeMode == MAEVN::ReverbMode::Convolution)
+                convolver.clearHistory();
+            else
+                reverb.reset();
         }
         
         // Apply main reverb
-        juce::dsp::AudioBlock<float> wetBlock(wetBuffer);
-        juce::dsp::ProcessContextReplacing<float> reverbContext(wetBlock);
-        reverb.process(reverbContext);
+        if (activeMode == MAEVN::ReverbMode::Convolution)
+        {
+            convolver.process(wetBuffer, numSamples);
+        }
+        else
+        {
+            juce::dsp::AudioBlock<float> wetBlock(wetBuffer);
+            juce::dsp::ProcessContextReplacing<float> reverbContext(wetBlock);
+            reverb.process(reverbContext);
+        }
         
         // Apply damping filter
-        juce::dsp::ProcessContextReplacing<float> dampContext(wetBlock);
-        dampingFilter.process(dampContext);
+        dampingFilter.process(wetBuffer, numSamples);
         
         // Apply reverb tail adjustment
         wetBuffer.applyGain(lateReverb * reverbTail);
@@ -944,12 +930,10 @@ public:
     void reset()
     {
         reverb.reset();
+        convolver.reset();
         preDelayLine.reset();
         dampingFilter.reset();
-        for (auto& delay : earlyReflectionDelays)
-        {
-            delay.reset();
-        }
+        earlyReflectionTaps.reset();
     }
 
     // Basic controls
@@ -964,6 +948,31 @@ public:
     void setLateReverb(float amount) { lateReverb = juce::jlimit(0.0f, 1.0f, amount); }
     void setReverbTail(float amount) { reverbTail = juce::jlimit(0.0f, 1.0f, amount); }
     void setRoomShape(float shape) { roomShape = juce::jlimit(0.0f, 1.0f, shape); }
+    
+    // Convolution mode
+    void setMode(MAEVN::ReverbMode newMode) { mode.store(newMode); }
+    MAEVN::ReverbMode getMode() const { return mode.load(); }
+    
+    /**
+     * @brief Load the impulse response used in convolution mode (not the audio thread)
+     */
+    bool loadImpulseResponse(const juce::File& file) { return convolver.loadImpulseResponse(file); }
+    bool loadImpulseResponse(const void* data, size_t numBytes) { return convolver.loadImpulseResponse(data, numBytes); }
+    bool loadImpulseResponse(const juce::AudioBuffer<float>& impulse, double sampleRate)
+    {
+        return convolver.loadImpulseResponse(impulse, sampleRate);
+    }
+    
+    /**
+     * @brief Get how long the reverb rings after the input stops
+     */
+    double getTailLengthSeconds() const
+    {
+        if (mode.load() == MAEVN::ReverbMode::Convolution)
+            return preDelay / 1000.0 + convolver.getImpulseLengthSeconds() + MAEVN::FILTER_TAIL_SECONDS;
+        
+        return preDelay / 1000.0 + juce::jmax(static_cast<double>(decayTime), MAEVN::getReverbTailSeconds(roomSize));
+    }
 
 private:
     void updateReverbParameters()
@@ -984,13 +993,41 @@ private:
         preDelayLine.setDelay(delaySamples);
     }
     
+    void updateEarlyReflections()
+    {
+        tapsEarlyReflections = earlyReflections;
+        tapsRoomShape = roomShape;
+        
+        std::array<MAEVN::MultiTapDelay::Tap, NUM_EARLY_REFLECTIONS> taps;
+        float energy = 0.0f;
+        
+        for (int i = 0; i < NUM_EARLY_REFLECTIONS; ++i)
+        {
+            // Golden-ratio jitter keeps the arrivals from forming a comb
+            const float jitter = std::fmod(static_cast<float>(i) * 0.618034f, 1.0f) - 0.5f;
+            const float position = juce::jlimit(0.0f, 1.0f, (static_cast<float>(i) + 0.8f * jitter)
+                                                            / static_cast<float>(NUM_EARLY_REFLECTIONS - 1));
+            
+            taps[static_cast<size_t>(i)].delaySeconds = (ER_FIRST_MS + position * (ER_LAST_MS - ER_FIRST_MS)) / 1000.0f;
+            taps[static_cast<size_t>(i)].gain = 1.0f - position * ER_DECAY;
+            energy += taps[static_cast<size_t>(i)].gain * taps[static_cast<size_t>(i)].gain;
+        }
+        
+        // Room shape scales the whole pattern
+        const float level = std::sqrt(ER_ENERGY / energy) * earlyReflections
+                            * (ROOM_SHAPE_OFFSET + roomShape * ROOM_SHAPE_OFFSET) * EARLY_REFLECTIONS_MIX;
+        for (auto& tap : taps)
+            tap.gain *= level;
+        
+        earlyReflectionTaps.setTaps(taps.data(), earlyReflections > 0.0f ? NUM_EARLY_REFLECTIONS : 0);
+    }
+    
     void updateDampingFilter()
     {
         // Higher damping = more high frequency absorption
         float cutoff = 20000.0f - damping * 15000.0f;
         cutoff = juce::jlimit(1000.0f, 20000.0f, cutoff);
-        *dampingFilter.state = *juce::dsp::IIR::Coefficients<float>::makeLowPass(
-            currentSampleRate, cutoff);
+        dampingFilter.setCoefficients(MAEVN::BiquadCoefficients::makeLowPass(currentSampleRate, cutoff));
     }
 
     float roomSize;
@@ -1004,25 +1041,18 @@ private:
     float roomShape;
     double currentSampleRate;
     
-    // Maximum delay line sizes: 192000 samples = ~4 seconds at 48kHz (for pre-delay)
-    // Early reflection delay: 19200 samples = ~400ms at 48kHz (for early reflections)
+    // Maximum delay line size: 192000 samples = ~4 seconds at 48kHz (for pre-delay)
     static constexpr int MAX_PRE_DELAY_SAMPLES = 192000;
-    static constexpr int MAX_EARLY_REFLECTION_DELAY_SAMPLES = 19200;
     
     juce::dsp::Reverb reverb;
+    MAEVN::PartitionedConvolver convolver;
+    std::atomic<MAEVN::ReverbMode> mode { MAEVN::ReverbMode::Algorithmic };
+    MAEVN::ReverbMode activeMode;
     juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> preDelayLine{MAX_PRE_DELAY_SAMPLES};
-    std::array<juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear>, 8> earlyReflectionDelays = {{
-        juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear>{MAX_EARLY_REFLECTION_DELAY_SAMPLES},
-        juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear>{MAX_EARLY_REFLECTION_DELAY_SAMPLES},
-        juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear>{MAX_EARLY_REFLECTION_DELAY_SAMPLES},
-        juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear>{MAX_EARLY_REFLECTION_DELAY_SAMPLES},
-        juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear>{MAX_EARLY_REFLECTION_DELAY_SAMPLES},
-        juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear>{MAX_EARLY_REFLECTION_DELAY_SAMPLES},
-        juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear>{MAX_EARLY_REFLECTION_DELAY_SAMPLES},
-        juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear>{MAX_EARLY_REFLECTION_DELAY_SAMPLES}
-    }};
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, 
-                                    juce::dsp::IIR::Coefficients<float>> dampingFilter;
+    MAEVN::MultiTapDelay earlyReflectionTaps;
+    float tapsEarlyReflections;   // settings the taps were built for
+    float tapsRoomShape;
+    MAEVN::SmoothedBiquad dampingFilter;
     juce::AudioBuffer<float> wetBuffer;
 };
 
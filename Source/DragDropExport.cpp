@@ -17,12 +17,18 @@ DragDropExport::DragDropExport()
     : sampleRate(44100.0)
     , bitDepth(24)
     , bpm(120.0)
+    , lastExportLUFS(LoudnessMeter::MINIMUM_LUFS)
+    , assetStore(juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                     .getChildFile("MAEVN")
+                     .getChildFile("DragCache"))
 {
     // Create temp export directory
     tempExportDir = juce::File::getSpecialLocation(juce::File::tempDirectory)
                         .getChildFile("MAEVN_Export");
     tempExportDir.createDirectory();
     
+    offlineRenderer.onProgress = [this](float progress) { notifyProgress(progress); };
+    
     Logger::log(Logger::Level::Info, "DragDropExport initialized with temp dir: " + 
                 tempExportDir.getFullPathName());
 }
@@ -56,20 +62,20 @@ bool DragDropExport::startBlockDrag(const TimelineBlock& block,
     
     notifyExportStarted(region);
     
-    // Create temporary audio file for drag
-    juce::File tempFile = tempExportDir.getChildFile(region.name + ".wav");
+    juce::File tempFile;
     
     bool success = false;
     if (audioData != nullptr && audioData->getNumSamples() > 0)
     {
-        // Export audio data to temp file
-        success = createAudioFile(block, ExportFormat::WAV, tempFile);
+        // Dragging an unchanged block again reuses the file of the last drag
+        tempFile = findOrStoreDragAsset(region.name, *audioData, static_cast<int>(block.duration * sampleRate));
+        success = tempFile != juce::File();
     }
     else
     {
         // Create MIDI file if no audio
         tempFile = tempExportDir.getChildFile(region.name + ".mid");
-        success = createMIDIFile(block, tempFile);
+        success = createMIDIFile({ block }, tempFile);
     }
     
     if (success)
@@ -110,23 +116,13 @@ bool DragDropExport::startMultiBlockDrag(const std::vector<TimelineBlock>& block
     // For multi-block export, we need to combine the audio
     if (audioData != nullptr && audioData->getNumSamples() > 0)
     {
-        // Write combined audio to file
-        juce::WavAudioFormat wavFormat;
-        std::unique_ptr<juce::AudioFormatWriter> writer(
-            wavFormat.createWriterFor(
-                new juce::FileOutputStream(tempFile),
-                sampleRate,
-                static_cast<unsigned int>(audioData->getNumChannels()),
-                bitDepth,
-                {},
-                0
-            )
-        );
-        
-        if (writer != nullptr)
-        {
-            writer->writeFromAudioSampleBuffer(*audioData, 0, audioData->getNumSamples());
-        }
+        tempFile = findOrStoreDragAsset(combinedName, *audioData, audioData->getNumSamples());
+        if (tempFile == juce::File())
+            return false;
+    }
+    else if (!renderAudioFile(blocks, tempFile))
+    {
+        return false;
     }
     
     // Start drag
@@ -162,7 +158,7 @@ bool DragDropExport::exportBlock(const TimelineBlock& block,
     
     if (format == ExportFormat::MIDI)
     {
-        success = createMIDIFile(block, destinationFile);
+        success = createMIDIFile({ block }, destinationFile);
     }
     else
     {
@@ -180,9 +176,39 @@ bool DragDropExport::exportBlocks(const std::vector<TimelineBlock>& blocks,
     if (blocks.empty())
         return false;
     
-    // For now, export the first block only
-    // In a full implementation, this would combine all blocks
-    return exportBlock(blocks[0], format, destinationFile);
+    if (blocks.size() == 1)
+        return exportBlock(blocks[0], format, destinationFile);
+    
+    ExportableRegion region;
+    region.name = destinationFile.getFileNameWithoutExtension();
+    region.blockType = blocks[0].type;
+    region.startTime = blocks[0].startTime;
+    region.trackIndex = blocks[0].trackIndex;
+    
+    double endTime = region.startTime;
+    for (const auto& block : blocks)
+    {
+        region.startTime = juce::jmin(region.startTime, block.startTime);
+        endTime = juce::jmax(endTime, block.startTime + block.duration);
+    }
+    region.duration = endTime - region.startTime;
+    
+    notifyExportStarted(region);
+    
+    // All the blocks go into one file, each at its own place on the timeline
+    bool success = false;
+    
+    if (format == ExportFormat::MIDI)
+    {
+        success = createMIDIFile(blocks, destinationFile);
+    }
+    else
+    {
+        success = renderAudioFile(blocks, destinationFile);
+    }
+    
+    notifyExportCompleted(region, success);
+    return success;
 }
 
 juce::String DragDropExport::getFileExtension(ExportFormat format)
@@ -280,12 +306,15 @@ void DragDropExport::removeListener(DragDropExportListener* listener)
     listeners.erase(std::remove(listeners.begin(), listeners.end(), listener), listeners.end());
 }
 
-bool DragDropExport::createMIDIFile(const TimelineBlock& block, const juce::File& file)
+bool DragDropExport::createMIDIFile(const std::vector<TimelineBlock>& blocks, const juce::File& file)
 {
     juce::MidiFile midiFile;
     midiFile.setTicksPerQuarterNote(480);
     
-    juce::MidiMessageSequence sequence = createMIDISequence(block);
+    juce::MidiMessageSequence sequence;
+    for (const auto& block : blocks)
+        sequence.addSequence(createMIDISequence(block), 0.0);
+    sequence.updateMatchedPairs();
     
     midiFile.addTrack(sequence);
     
@@ -300,14 +329,26 @@ bool DragDropExport::createMIDIFile(const TimelineBlock& block, const juce::File
 
 bool DragDropExport::createAudioFile(const TimelineBlock& block,
                                      ExportFormat format,
-                                     const juce::File& file)
+                                     const juce::File& file,
+                                     const juce::AudioBuffer<float>* audioData)
 {
-    // Create a silent audio buffer as placeholder
-    // In a full implementation, this would use the rendered audio from the block
+    // Blocks without audio go through the offline renderer's FX and mastering chains
+    if (audioData == nullptr || audioData->getNumChannels() == 0)
+        return renderAudioFile({ block }, file);
+    
     int numSamples = static_cast<int>(block.duration * sampleRate);
     juce::AudioBuffer<float> buffer(2, numSamples);
     buffer.clear();
     
+    const int count = juce::jmin(numSamples, audioData->getNumSamples());
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        buffer.copyFrom(ch, 0, *audioData, juce::jmin(ch, audioData->getNumChannels() - 1), 0, count);
+    
+    // The buffer is complete here, so its integrated loudness costs one meter pass
+    lastExportLUFS = LoudnessMeter::measureIntegratedLUFS(buffer, sampleRate);
+    Logger::log(Logger::Level::Info, "Exporting " + file.getFileName() + " at "
+                + juce::String(lastExportLUFS, 1) + " LUFS integrated");
+    
     // Create appropriate audio format
     std::unique_ptr<juce::AudioFormat> audioFormat;
     
@@ -343,6 +384,56 @@ bool DragDropExport::createAudioFile(const TimelineBlock& block,
     return false;
 }
 
+juce::File DragDropExport::findOrStoreDragAsset(const juce::String& name,
+                                               const juce::AudioBuffer<float>& audio,
+                                               int numSamples)
+{
+    // Everything the file's bytes depend on, so changed audio never maps to a stale file
+    juce::String description;
+    description << AudioAssetStore::hashAudio(audio)
+                << "|" << numSamples
+                << "|" << juce::String(sampleRate, 1)
+                << "|" << bitDepth;
+    
+    // The name leads, as DAWs show it when the file is dropped
+    const auto key = juce::File::createLegalFileName(name) + "_"
+                     + juce::SHA256(description.toUTF8()).toHexString().substring(0, 16);
+    
+    auto file = assetStore.findFile(key);
+    if (file != juce::File())
+        return file;
+    
+    juce::AudioBuffer<float> buffer(2, numSamples);
+    buffer.clear();
+    
+    const int count = juce::jmin(numSamples, audio.getNumSamples());
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        buffer.copyFrom(ch, 0, audio, juce::jmin(ch, audio.getNumChannels() - 1), 0, count);
+    
+    lastExportLUFS = LoudnessMeter::measureIntegratedLUFS(buffer, sampleRate);
+    Logger::log(Logger::Level::Info, "Storing drag file " + key + " at "
+                + juce::String(lastExportLUFS, 1) + " LUFS integrated");
+    
+    return assetStore.store(key, buffer, sampleRate, bitDepth);
+}
+
+bool DragDropExport::renderAudioFile(const std::vector<TimelineBlock>& blocks, const juce::File& file)
+{
+    auto renderSettings = offlineRenderer.getSettings();
+    renderSettings.sampleRate = sampleRate;
+    renderSettings.bitDepth = bitDepth;
+    offlineRenderer.setSettings(renderSettings);
+    
+    // Includes the chains' tail, so reverb and delay ring out past the last block
+    const bool success = offlineRenderer.renderToFile(blocks, file);
+    
+    lastExportLUFS = offlineRenderer.getLastResult().integratedLUFS;
+    Logger::log(Logger::Level::Info, "Exported " + file.getFileName() + " at "
+                + juce::String(lastExportLUFS, 1) + " LUFS integrated");
+    
+    return success;
+}
+
 juce::MidiMessageSequence DragDropExport::createMIDISequence(const TimelineBlock& block)
 {
     juce::MidiMessageSequence sequence;
@@ -10,10 +10,14 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <functional>
 #include <memory>
 #include <vector>
 #include "Utilities.h"
 #include "PatternEngine.h"
+#include "LoudnessMeter.h"
+#include "OfflineRenderer.h"
+#include "AudioAssetStore.h"
 
 namespace MAEVN
 {
@@ -164,6 +168,29 @@ public:
      */
     void setBPM(double bpm) { this->bpm = bpm; }
     
+    /**
+     * @brief Integrated loudness of the last exported audio file (BS.1770-4)
+     */
+    float getLastExportLUFS() const { return lastExportLUFS; }
+    
+    /**
+     * @brief The engine that renders blocks exported without audio data
+     * 
+     * Give it MAEVNAudioProcessor::renderVocalBlock() as its renderer, so
+     * exports read from the vocal render cache, and the processor's chain
+     * settings. Its sample rate and bit depth follow setSampleRate() and
+     * setBitDepth().
+     */
+    OfflineRenderer& getOfflineRenderer() { return offlineRenderer; }
+    
+    /**
+     * @brief The store dragged audio files are served from
+     * 
+     * A drag of audio that has not changed since an earlier drag hands the
+     * DAW the file that drag wrote; the store's disk budget bounds them all.
+     */
+    AudioAssetStore& getAssetStore() { return assetStore; }
+    
     /**
      * @brief Add an export listener
      * @param listener The listener to add
@@ -205,21 +232,37 @@ private:
     double sampleRate;
     int bitDepth;
     double bpm;
+    float lastExportLUFS;
+    OfflineRenderer offlineRenderer;
+    AudioAssetStore assetStore;
     
     std::vector<DragDropExportListener*> listeners;
     juce::File tempExportDir;
     
     /**
-     * @brief Create MIDI file from block
+     * @brief Create one MIDI file from blocks
      */
-    bool createMIDIFile(const TimelineBlock& block, const juce::File& file);
+    bool createMIDIFile(const std::vector<TimelineBlock>& blocks, const juce::File& file);
     
     /**
      * @brief Create audio file from block
+     * @param audioData Pre-rendered audio, or nullptr to render the block
      */
     bool createAudioFile(const TimelineBlock& block, 
                         ExportFormat format,
-                        const juce::File& file);
+                        const juce::File& file,
+                        const juce::AudioBuffer<float>* audioData = nullptr);
+    
+    /**
+     * @brief Get the drag file of audio fitted to numSamples, writing it only if new
+     * @return juce::File() if the file could not be written
+     */
+    juce::File findOrStoreDragAsset(const juce::String& name, const juce::AudioBuffer<float>& audio, int numSamples);
+    
+    /**
+     * @brief Render blocks through the offline renderer into one audio file
+     */
+    bool renderAudioFile(const std::vector<TimelineBlock>& blocks, const juce::File& file);
     
     /**
      * @brief Create MIDI sequence from block content
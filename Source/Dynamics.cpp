@@ -0,0 +1,172 @@
+/**
+ * @file Dynamics.cpp
+ * @brief Implementation of the shared dynamics building blocks
+ */
+
+#include "Dynamics.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+void measureAverageMagnitude(const juce::AudioBuffer<float>& buffer, int numChannels,
+                             int numSamples, float* detector)
+{
+    numChannels = juce::jmin(numChannels, buffer.getNumChannels());
+    if (numChannels <= 0)
+    {
+        juce::FloatVectorOperations::clear(detector, numSamples);
+        return;
+    }
+    
+    juce::FloatVectorOperations::abs(detector, buffer.getReadPointer(0), numSamples);
+    
+    for (int ch = 1; ch < numChannels; ++ch)
+    {
+        const float* input = buffer.getReadPointer(ch);
+        for (int i = 0; i < numSamples; ++i)
+            detector[i] += std::abs(input[i]);
+    }
+    
+    if (numChannels > 1)
+        juce::FloatVectorOperations::multiply(detector, 1.0f / static_cast<float>(numChannels), numSamples);
+}
+
+void applyGainCurve(juce::AudioBuffer<float>& buffer, int numChannels,
+                    const float* gains, int numSamples)
+{
+    numChannels = juce::jmin(numChannels, buffer.getNumChannels());
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+        juce::FloatVectorOperations::multiply(buffer.getWritePointer(ch), gains, numSamples);
+}
+
+float gainReductionFromGain(float minimumGain)
+{
+    return juce::jmin(0.0f, gainTodB(juce::jmax(minimumGain, 1.0e-5f)));
+}
+
+//==============================================================================
+EnvelopeFollower::EnvelopeFollower()
+    : currentSampleRate(44100.0)
+    , attackCoefficient(0.0f)
+    , releaseCoefficient(0.0f)
+{
+}
+
+void EnvelopeFollower::prepare(double sampleRate, int numChannels)
+{
+    currentSampleRate = sampleRate;
+    state.assign(static_cast<size_t>(juce::jmax(1, numChannels)), 0.0f);
+}
+
+void EnvelopeFollower::reset()
+{
+    std::fill(state.begin(), state.end(), 0.0f);
+}
+
+float EnvelopeFollower::calculateCoefficient(float ms) const
+{
+    if (ms < 1.0e-3f)
+        return 0.0f;
+    
+    return static_cast<float>(std::exp(-TWO_PI * 1000.0 / (currentSampleRate * ms)));
+}
+
+void EnvelopeFollower::setAttack(float ms)
+{
+    attackCoefficient = calculateCoefficient(ms);
+}
+
+void EnvelopeFollower::setRelease(float ms)
+{
+    releaseCoefficient = calculateCoefficient(ms);
+}
+
+void EnvelopeFollower::process(int channel, const float* input, float* envelope, int numSamples)
+{
+    jassert(channel < static_cast<int>(state.size()));
+    
+    const float attack = attackCoefficient;
+    const float release = releaseCoefficient;
+    float level = state[static_cast<size_t>(channel)];
+    
+    // The only recursive pass: a select and a multiply-add per sample
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float x = input[i];
+        const float coefficient = x > level ? attack : release;
+        level = x + coefficient * (level - x);
+        envelope[i] = level;
+    }
+    
+    // Keep a decayed envelope from going denormal
+    state[static_cast<size_t>(channel)] = level < 1.0e-15f ? 0.0f : level;
+}
+
+//==============================================================================
+void GainComputer::process(float* levelsToGains, int numSamples, float thresholdDB, float ratio)
+{
+    // gainDB = min(0, (levelDB - threshold) * (1 / ratio - 1)), branch-free
+    const float slope = 1.0f / juce::jmax(1.0f, ratio) - 1.0f;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float levelDB = fastGainTodB(std::max(levelsToGains[i], 1.0e-20f));
+        levelsToGains[i] = fastDBToGain(std::min(0.0f, (levelDB - thresholdDB) * slope));
+    }
+}
+
+//==============================================================================
+Compressor::Compressor()
+    : numChannels(0)
+    , maxBlockSize(0)
+{
+}
+
+void Compressor::prepare(double sampleRate, int maxBlock, int channels)
+{
+    numChannels = juce::jmax(1, channels);
+    maxBlockSize = juce::jmax(1, maxBlock);
+    
+    follower.prepare(sampleRate, numChannels);
+    gains.assign(static_cast<size_t>(maxBlockSize), 1.0f);
+}
+
+void Compressor::reset()
+{
+    follower.reset();
+    gainReductionDB.store(0.0f);
+}
+
+void Compressor::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    jassert(numSamples <= maxBlockSize);
+    numSamples = juce::jmin(numSamples, maxBlockSize);
+    
+    follower.setAttack(attackMs.load(std::memory_order_relaxed));
+    follower.setRelease(releaseMs.load(std::memory_order_relaxed));
+    const float threshold = thresholdDB.load(std::memory_order_relaxed);
+    const float ratio = ratioValue.load(std::memory_order_relaxed);
+    
+    const int channels = juce::jmin(numChannels, buffer.getNumChannels());
+    float* gainCurve = gains.data();
+    float minimumGain = 1.0f;
+    
+    for (int ch = 0; ch < channels; ++ch)
+    {
+        float* data = buffer.getWritePointer(ch);
+        
+        juce::FloatVectorOperations::abs(gainCurve, data, numSamples);
+        follower.process(ch, gainCurve, gainCurve, numSamples);
+        GainComputer::process(gainCurve, numSamples, threshold, ratio);
+        juce::FloatVectorOperations::multiply(data, gainCurve, numSamples);
+        
+        if (numSamples > 0)
+            minimumGain = juce::jmin(minimumGain, juce::FloatVectorOperations::findMinimum(gainCurve, numSamples));
+    }
+    
+    gainReductionDB.store(gainReductionFromGain(minimumGain), std::memory_order_relaxed);
+}
+
+} // namespace MAEVN
@@ -0,0 +1,135 @@
+/**
+ * @file Dynamics.h
+ * @brief Block-based detectors, envelope followers, gain computers and compressor
+ *
+ * Every dynamics processor runs the same four planar passes over a block:
+ * detect (rectify or link channels), follow the envelope, turn levels into
+ * gains, apply the gains. Only the envelope pass is recursive; the others
+ * are straight loops over contiguous floats that vectorise, and the gain
+ * computer uses fastLog2/fastExp2 from Utilities.h instead of std::pow.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Mean magnitude across the first numChannels channels into detector
+ */
+void measureAverageMagnitude(const juce::AudioBuffer<float>& buffer, int numChannels,
+                             int numSamples, float* detector);
+
+/**
+ * @brief Multiply the first numChannels channels by a per-sample gain curve
+ */
+void applyGainCurve(juce::AudioBuffer<float>& buffer, int numChannels,
+                    const float* gains, int numSamples);
+
+/**
+ * @brief Smallest gain of a block as gain reduction in dB (0 or negative)
+ */
+float gainReductionFromGain(float minimumGain);
+
+//==============================================================================
+/**
+ * @brief Peak envelope follower with separate attack and release
+ *
+ * Times follow juce::dsp::BallisticsFilter (and so juce::dsp::Compressor):
+ * the coefficient is exp(-2 pi * 1000 / (sampleRate * ms)), and times
+ * under a microsecond follow the input instantly.
+ */
+class EnvelopeFollower
+{
+public:
+    EnvelopeFollower();
+    
+    void prepare(double sampleRate, int numChannels);
+    void reset();
+    
+    void setAttack(float ms);
+    void setRelease(float ms);
+    
+    /**
+     * @brief Follow a rectified detector signal (input and envelope may alias)
+     */
+    void process(int channel, const float* input, float* envelope, int numSamples);
+
+private:
+    std::vector<float> state;
+    double currentSampleRate;
+    float attackCoefficient;
+    float releaseCoefficient;
+    
+    float calculateCoefficient(float ms) const;
+};
+
+//==============================================================================
+/**
+ * @brief Hard-knee downward gain computer
+ */
+struct GainComputer
+{
+    /**
+     * @brief Turn linear envelope levels into linear gains in place
+     */
+    static void process(float* levelsToGains, int numSamples, float thresholdDB, float ratio);
+};
+
+//==============================================================================
+/**
+ * @brief Per-channel feed-forward compressor
+ *
+ * Behaves like juce::dsp::Compressor (peak detection, same ballistics,
+ * hard knee), so settings carry over unchanged, but works in planar block
+ * passes. Setters may be called from any thread.
+ */
+class Compressor
+{
+public:
+    Compressor();
+    
+    /**
+     * @brief Allocate the envelope buffer (call outside the audio callback)
+     */
+    void prepare(double sampleRate, int maxBlockSize, int numChannels);
+    
+    /**
+     * @brief Compress numSamples of every prepared channel in place
+     */
+    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    void reset();
+    
+    void setThreshold(float dB) { thresholdDB.store(dB); }
+    void setRatio(float ratio) { ratioValue.store(juce::jmax(1.0f, ratio)); }
+    void setAttack(float ms) { attackMs.store(ms); }
+    void setRelease(float ms) { releaseMs.store(ms); }
+    
+    /**
+     * @brief Deepest gain reduction of the last block, in dB (0 or negative)
+     */
+    float getGainReductionDB() const { return gainReductionDB.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<float> thresholdDB { 0.0f };
+    std::atomic<float> ratioValue { 1.0f };
+    std::atomic<float> attackMs { 1.0f };
+    std::atomic<float> releaseMs { 100.0f };
+    std::atomic<float> gainReductionDB { 0.0f };
+    
+    EnvelopeFollower follower;
+    std::vector<float> gains;
+    int numChannels;
+    int maxBlockSize;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Compressor)
+};
+
+} // namespace MAEVN
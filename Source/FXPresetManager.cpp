@@ -4,6 +4,8 @@
  */
 
 #include "FXPresetManager.h"
+#include <algorithm>
+#include <iterator>
 
 namespace MAEVN
 {
@@ -29,6 +31,7 @@ int FXPresetManager::loadPresetsFromDirectory(const juce::File& directory)
     
     presetsDirectory = directory;
     presets.clear();
+    rebuildIndex();
     
     // Find all .json files in directory
     juce::Array<juce::File> files = directory.findChildFiles(
@@ -55,6 +58,7 @@ bool FXPresetManager::loadPresetFile(const juce::File& file)
     if (preset.loadFromFile(file))
     {
         presets.push_back(preset);
+        indexPreset(static_cast<int>(presets.size()) - 1);
         return true;
     }
     return false;
@@ -82,6 +86,7 @@ void FXPresetManager::addPreset(const FXPreset& preset)
 {
     const juce::ScopedLock sl(presetLock);
     presets.push_back(preset);
+    indexPreset(static_cast<int>(presets.size()) - 1);
 }
 
 void FXPresetManager::removePreset(int index)
@@ -91,6 +96,9 @@ void FXPresetManager::removePreset(int index)
     if (index >= 0 && index < (int)presets.size())
     {
         presets.erase(presets.begin() + index);
+        
+        // Later presets moved down by one
+        rebuildIndex();
     }
 }
 
@@ -110,8 +118,9 @@ std::vector<int> FXPresetManager::searchPresets(const juce::String& searchTerm)
     const juce::ScopedLock sl(presetLock);
     
     std::vector<int> results;
+    const auto words = tokenize(searchTerm);
     
-    if (searchTerm.isEmpty())
+    if (words.isEmpty())
     {
         // Return all presets
         for (int i = 0; i < (int)presets.size(); ++i)
@@ -121,48 +130,35 @@ std::vector<int> FXPresetManager::searchPresets(const juce::String& searchTerm)
         return results;
     }
     
-    juce::String lowerSearch = searchTerm.toLowerCase();
-    
-    for (int i = 0; i < (int)presets.size(); ++i)
+    for (int w = 0; w < words.size(); ++w)
     {
-        const auto& preset = presets[i];
+        const auto& prefix = words[w];
         
-        // Search in name
-        if (preset.getName().toLowerCase().contains(lowerSearch))
+        // Union of the presets of every indexed word starting with the prefix
+        std::vector<int> matches;
+        for (auto it = wordIndex.lower_bound(prefix); it != wordIndex.end() && it->first.startsWith(prefix); ++it)
         {
-            results.push_back(i);
-            continue;
+            matches.insert(matches.end(), it->second.begin(), it->second.end());
         }
         
-        // Search in category
-        if (preset.getCategory().toLowerCase().contains(lowerSearch))
-        {
-            results.push_back(i);
-            continue;
-        }
+        std::sort(matches.begin(), matches.end());
+        matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
         
-        // Search in tags
-        bool foundInTags = false;
-        for (const auto& tag : preset.getTags())
+        // Every word has to match
+        if (w == 0)
         {
-            if (tag.toLowerCase().contains(lowerSearch))
-            {
-                foundInTags = true;
-                break;
-            }
+            results = std::move(matches);
         }
-        if (foundInTags)
+        else
         {
-            results.push_back(i);
-            continue;
+            std::vector<int> intersection;
+            std::set_intersection(results.begin(), results.end(), matches.begin(), matches.end(),
+                                  std::back_inserter(intersection));
+            results = std::move(intersection);
         }
         
-        // Search in description
-        if (preset.getDescription().toLowerCase().contains(lowerSearch))
-        {
-            results.push_back(i);
-            continue;
-        }
+        if (results.empty())
+            break;
     }
     
     return results;
@@ -172,34 +168,22 @@ std::vector<int> FXPresetManager::filterByCategory(const juce::String& category)
 {
     const juce::ScopedLock sl(presetLock);
     
-    std::vector<int> results;
-    
-    for (int i = 0; i < (int)presets.size(); ++i)
-    {
-        if (presets[i].getCategory().equalsIgnoreCase(category))
-        {
-            results.push_back(i);
-        }
-    }
+    auto it = categoryIndex.find(category.toLowerCase());
+    if (it == categoryIndex.end())
+        return {};
     
-    return results;
+    return it->second.presets;
 }
 
 std::vector<int> FXPresetManager::filterByTag(const juce::String& tag) const
 {
     const juce::ScopedLock sl(presetLock);
     
-    std::vector<int> results;
+    auto it = tagIndex.find(tag);
+    if (it == tagIndex.end())
+        return {};
     
-    for (int i = 0; i < (int)presets.size(); ++i)
-    {
-        if (presets[i].hasTag(tag))
-        {
-            results.push_back(i);
-        }
-    }
-    
-    return results;
+    return it->second;
 }
 
 juce::StringArray FXPresetManager::getAllCategories() const
@@ -208,13 +192,9 @@ juce::StringArray FXPresetManager::getAllCategories() const
     
     juce::StringArray categories;
     
-    for (const auto& preset : presets)
+    for (const auto& entry : categoryIndex)
     {
-        juce::String category = preset.getCategory();
-        if (!categories.contains(category))
-        {
-            categories.add(category);
-        }
+        categories.add(entry.second.name);
     }
     
     categories.sort(false);
@@ -225,20 +205,14 @@ juce::StringArray FXPresetManager::getAllTags() const
 {
     const juce::ScopedLock sl(presetLock);
     
+    // Already unique and sorted
     juce::StringArray allTags;
     
-    for (const auto& preset : presets)
+    for (const auto& entry : tagIndex)
     {
-        for (const auto& tag : preset.getTags())
-        {
-            if (!allTags.contains(tag))
-            {
-                allTags.add(tag);
-            }
-        }
+        allTags.add(entry.first);
     }
     
-    allTags.sort(false);
     return allTags;
 }
 
@@ -246,21 +220,18 @@ void FXPresetManager::clearPresets()
 {
     const juce::ScopedLock sl(presetLock);
     presets.clear();
+    rebuildIndex();
 }
 
 const FXPreset* FXPresetManager::getPresetByName(const juce::String& name) const
 {
     const juce::ScopedLock sl(presetLock);
     
-    for (const auto& preset : presets)
-    {
-        if (preset.getName().equalsIgnoreCase(name))
-        {
-            return &preset;
-        }
-    }
+    auto it = nameIndex.find(name.toLowerCase());
+    if (it == nameIndex.end())
+        return nullptr;
     
-    return nullptr;
+    return &presets[static_cast<size_t>(it->second)];
 }
 
 bool FXPresetManager::hasPreset(const juce::String& name) const
@@ -281,4 +252,72 @@ void FXPresetManager::reloadPresets()
     }
 }
 
+//==============================================================================
+void FXPresetManager::indexPreset(int index)
+{
+    const auto& preset = presets[static_cast<size_t>(index)];
+    
+    // Indices only ever grow here, so appending keeps each list sorted and
+    // checking the last entry removes duplicates
+    const auto addTo = [index](std::vector<int>& list)
+    {
+        if (list.empty() || list.back() != index)
+            list.push_back(index);
+    };
+    
+    auto words = tokenize(preset.getName());
+    words.addArray(tokenize(preset.getCategory()));
+    for (const auto& tag : preset.getTags())
+    {
+        words.addArray(tokenize(tag));
+        addTo(tagIndex[tag]);
+    }
+    
+    for (const auto& word : words)
+    {
+        addTo(wordIndex[word]);
+    }
+    
+    auto& category = categoryIndex[preset.getCategory().toLowerCase()];
+    if (category.presets.empty())
+        category.name = preset.getCategory();
+    addTo(category.presets);
+    
+    nameIndex.emplace(preset.getName().toLowerCase(), index);
+}
+
+void FXPresetManager::rebuildIndex()
+{
+    wordIndex.clear();
+    tagIndex.clear();
+    categoryIndex.clear();
+    nameIndex.clear();
+    
+    for (int i = 0; i < (int)presets.size(); ++i)
+    {
+        indexPreset(i);
+    }
+}
+
+juce::StringArray FXPresetManager::tokenize(const juce::String& text)
+{
+    juce::StringArray words;
+    
+    auto p = text.getCharPointer();
+    while (!p.isEmpty())
+    {
+        while (!p.isEmpty() && !p.isLetterOrDigit())
+            ++p;
+        
+        const auto start = p;
+        while (!p.isEmpty() && p.isLetterOrDigit())
+            ++p;
+        
+        if (p != start)
+            words.add(juce::String(start, p).toLowerCase());
+    }
+    
+    return words;
+}
+
 } // namespace MAEVN
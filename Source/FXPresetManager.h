@@ -4,11 +4,17 @@
  * 
  * This module manages a collection of FX presets, providing search,
  * filtering, and organization capabilities.
+ * 
+ * Searches go through an inverted index of the words in each preset's
+ * name, category and tags, kept up to date as presets are added, so a
+ * query costs a few ordered-map lookups instead of a pass over every
+ * preset.
  */
 
 #pragma once
 
 #include <JuceHeader.h>
+#include <map>
 #include <vector>
 #include <memory>
 #include "FXPreset.h"
@@ -63,9 +69,13 @@ public:
     int getNumPresets() const { return static_cast<int>(presets.size()); }
     
     /**
-     * @brief Search presets by name or tag
+     * @brief Search presets by name, category or tag
+     * 
+     * Every word of the search term must be the start of a word of the
+     * preset's name, category or tags (case-insensitive).
+     * 
      * @param searchTerm Search string
-     * @return Indices of matching presets
+     * @return Indices of matching presets, ascending
      */
     std::vector<int> searchPresets(const juce::String& searchTerm) const;
     
@@ -127,6 +137,20 @@ private:
     std::vector<FXPreset> presets;
     juce::File presetsDirectory;
     
+    // Inverted index; every list holds preset indices in ascending order.
+    // Words are lower-case and ordered, so a prefix covers a contiguous range
+    std::map<juce::String, std::vector<int>> wordIndex;
+    std::map<juce::String, std::vector<int>> tagIndex;
+    
+    struct CategoryEntry
+    {
+        juce::String name;          // As first seen
+        std::vector<int> presets;
+    };
+    
+    std::map<juce::String, CategoryEntry> categoryIndex;   // Keyed lower-case
+    std::map<juce::String, int> nameIndex;                 // Lower-case name -> first preset
+    
     mutable juce::CriticalSection presetLock;
     
     /**
@@ -134,6 +158,21 @@ private:
      */
     bool loadPresetFile(const juce::File& file);
     
+    /**
+     * @brief Add the preset at an index to the index (it must be the highest indexed so far)
+     */
+    void indexPreset(int index);
+    
+    /**
+     * @brief Index every preset from scratch, e.g. after indices shift
+     */
+    void rebuildIndex();
+    
+    /**
+     * @brief Split text into lower-case words
+     */
+    static juce::StringArray tokenize(const juce::String& text);
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FXPresetManager)
 };
 
@@ -4,10 +4,100 @@
  */
 
 #include "GPUAcceleration.h"
+#include "OnnxEngine.h"
+#include <algorithm>
+
+#if defined(_WIN32) && MAEVN_ENABLE_DIRECTML
+    #include <dml_provider_factory.h>
+#endif
+
+#if defined(__APPLE__) && MAEVN_ENABLE_COREML
+    #include <coreml_provider_factory.h>
+#endif
 
 namespace MAEVN
 {
 
+namespace
+{
+   #if defined(_WIN32) || defined(__linux__)
+    /**
+     * @brief Ask the CUDA driver which devices exist, their compute capability and memory
+     *
+     * The driver is loaded at runtime, so machines without one simply report
+     * no devices. Free memory needs a CUDA context and is left at 0 (unknown).
+     */
+    std::vector<GPUDeviceInfo> queryCudaDevices()
+    {
+        // Driver API entry points; CUresult and CUdevice are plain ints
+        using InitFn = int (*)(unsigned int);
+        using GetCountFn = int (*)(int*);
+        using GetDeviceFn = int (*)(int*, int);
+        using GetNameFn = int (*)(char*, int, int);
+        using GetAttributeFn = int (*)(int*, int, int);
+        using TotalMemFn = int (*)(size_t*, int);
+        using DriverVersionFn = int (*)(int*);
+        
+        constexpr int CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR = 75;
+        constexpr int CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR = 76;
+        
+        std::vector<GPUDeviceInfo> devices;
+        
+       #ifdef _WIN32
+        juce::DynamicLibrary driver("nvcuda.dll");
+       #else
+        juce::DynamicLibrary driver("libcuda.so.1");
+       #endif
+        
+        auto init = reinterpret_cast<InitFn>(driver.getFunction("cuInit"));
+        auto getCount = reinterpret_cast<GetCountFn>(driver.getFunction("cuDeviceGetCount"));
+        auto getDevice = reinterpret_cast<GetDeviceFn>(driver.getFunction("cuDeviceGet"));
+        auto getName = reinterpret_cast<GetNameFn>(driver.getFunction("cuDeviceGetName"));
+        auto getAttribute = reinterpret_cast<GetAttributeFn>(driver.getFunction("cuDeviceGetAttribute"));
+        auto totalMem = reinterpret_cast<TotalMemFn>(driver.getFunction("cuDeviceTotalMem_v2"));
+        auto driverVersion = reinterpret_cast<DriverVersionFn>(driver.getFunction("cuDriverGetVersion"));
+        
+        int count = 0;
+        if (init == nullptr || getCount == nullptr || getDevice == nullptr || getAttribute == nullptr
+            || init(0) != 0 || getCount(&count) != 0)
+            return devices;
+        
+        int version = 0;
+        const bool hasVersion = driverVersion != nullptr && driverVersion(&version) == 0;
+        
+        for (int ordinal = 0; ordinal < count; ++ordinal)
+        {
+            int device = 0;
+            int major = 0, minor = 0;
+            if (getDevice(&device, ordinal) != 0
+                || getAttribute(&major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, device) != 0
+                || getAttribute(&minor, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR, device) != 0)
+                continue;
+            
+            GPUDeviceInfo info;
+            info.backend = GPUBackend::CUDA;
+            info.deviceIndex = ordinal;
+            info.computeCapability = static_cast<float>(major) + static_cast<float>(minor) / 10.0f;
+            
+            char name[256] = {};
+            info.name = (getName != nullptr && getName(name, static_cast<int>(sizeof(name)) - 1, device) == 0)
+                            ? juce::String(name) : juce::String("NVIDIA GPU");
+            
+            size_t bytes = 0;
+            if (totalMem != nullptr && totalMem(&bytes, device) == 0)
+                info.totalMemory = bytes;
+            
+            if (hasVersion)
+                info.driverVersion = juce::String(version / 1000) + "." + juce::String((version % 1000) / 10);
+            
+            devices.push_back(info);
+        }
+        
+        return devices;
+    }
+   #endif
+}
+
 //==============================================================================
 // GPUAccelerationManager Implementation
 //==============================================================================
@@ -16,6 +106,8 @@ GPUAccelerationManager::GPUAccelerationManager()
     : activeBackend(GPUBackend::None)
     , gpuAvailable(false)
     , gpuActive(false)
+    , onnxEngine(nullptr)
+    , benchmarkBlockSizes({ 128, 256, 512 })
 {
     detectDevices();
     
@@ -37,6 +129,7 @@ bool GPUAccelerationManager::initialize(const GPUConfig& config)
     {
         gpuActive = false;
         activeBackend = GPUBackend::None;
+        applyToEngine();
         notifyInitialized(true, "GPU acceleration disabled (CPU mode)");
         return true;
     }
@@ -86,6 +179,7 @@ bool GPUAccelerationManager::initialize(const GPUConfig& config)
         notifyFallback(message);
     }
     
+    applyToEngine();
     notifyInitialized(success, message);
     
     Logger::log(Logger::Level::Info, message);
@@ -157,6 +251,7 @@ void GPUAccelerationManager::fallbackToCPU()
     
     gpuActive = false;
     activeBackend = GPUBackend::None;
+    applyToEngine();
     
     notifyFallback("Manual fallback to CPU");
     Logger::log(Logger::Level::Info, "Fell back to CPU processing");
@@ -229,78 +324,257 @@ bool GPUAccelerationManager::hasEnoughMemory(size_t requiredBytes) const
     if (!gpuActive)
         return true; // CPU has virtually unlimited memory
     
-    return activeDevice.freeMemory >= requiredBytes;
+    // Free memory is often unknown; total memory still bounds what can fit
+    const size_t knownMemory = activeDevice.freeMemory > 0 ? activeDevice.freeMemory : activeDevice.totalMemory;
+    if (knownMemory == 0)
+        return true; // unknown: let session creation decide
+    
+    return knownMemory >= requiredBytes;
+}
+
+bool GPUAccelerationManager::appendExecutionProvider(Ort::SessionOptions& options,
+                                                     GPUBackend backend,
+                                                     const GPUConfig& config)
+{
+    if (backend == GPUBackend::None)
+        return true;
+    
+    try
+    {
+        switch (backend)
+        {
+            case GPUBackend::CUDA:
+            {
+                OrtCUDAProviderOptions cudaOptions;
+                cudaOptions.device_id = config.deviceIndex;
+                if (config.memoryLimit > 0)
+                    cudaOptions.gpu_mem_limit = config.memoryLimit;
+                options.AppendExecutionProvider_CUDA(cudaOptions);
+                return true;
+            }
+            
+            case GPUBackend::TensorRT:
+            {
+                const auto& api = Ort::GetApi();
+                OrtTensorRTProviderOptionsV2* trtOptions = nullptr;
+                Ort::ThrowOnError(api.CreateTensorRTProviderOptions(&trtOptions));
+                std::unique_ptr<OrtTensorRTProviderOptionsV2, decltype(api.ReleaseTensorRTProviderOptions)>
+                    trtGuard(trtOptions, api.ReleaseTensorRTProviderOptions);
+                
+                const std::string deviceId = std::to_string(config.deviceIndex);
+                const char* keys[] = { "device_id", "trt_fp16_enable" };
+                const char* values[] = { deviceId.c_str(), config.useTensorCores ? "1" : "0" };
+                Ort::ThrowOnError(api.UpdateTensorRTProviderOptions(trtOptions, keys, values, 2));
+                options.AppendExecutionProvider_TensorRT_V2(*trtOptions);
+                
+                // Nodes TensorRT can't take run on CUDA rather than the CPU
+                OrtCUDAProviderOptions cudaOptions;
+                cudaOptions.device_id = config.deviceIndex;
+                options.AppendExecutionProvider_CUDA(cudaOptions);
+                return true;
+            }
+            
+            case GPUBackend::DirectML:
+            #if defined(_WIN32) && MAEVN_ENABLE_DIRECTML
+                // DirectML requires sequential execution without memory patterns
+                options.DisableMemPattern();
+                options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+                Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_DML(options, config.deviceIndex));
+                return true;
+            #else
+                break;
+            #endif
+            
+            case GPUBackend::CoreML:
+            #if defined(__APPLE__) && MAEVN_ENABLE_COREML
+                Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_CoreML(options, 0));
+                return true;
+            #else
+                break;
+            #endif
+            
+            case GPUBackend::OpenVINO:
+            {
+                std::unordered_map<std::string, std::string> openVinoOptions;
+                openVinoOptions["device_type"] = "GPU";
+                options.AppendExecutionProvider_OpenVINO_V2(openVinoOptions);
+                return true;
+            }
+            
+            default:
+                break;
+        }
+    }
+    catch (const Ort::Exception& e)
+    {
+        Logger::log(Logger::Level::Warning, "Failed to enable " + getBackendName(backend)
+                    + " execution provider: " + juce::String(e.what()));
+        return false;
+    }
+    
+    Logger::log(Logger::Level::Warning, getBackendName(backend) + " is not enabled in this build");
+    return false;
+}
+
+bool GPUAccelerationManager::isProviderCompiledIn(GPUBackend backend)
+{
+    std::string providerName;
+    switch (backend)
+    {
+        case GPUBackend::None:      return true;
+        case GPUBackend::CUDA:      providerName = "CUDAExecutionProvider"; break;
+        case GPUBackend::TensorRT:  providerName = "TensorrtExecutionProvider"; break;
+        case GPUBackend::DirectML:  providerName = "DmlExecutionProvider"; break;
+        case GPUBackend::CoreML:    providerName = "CoreMLExecutionProvider"; break;
+        case GPUBackend::OpenVINO:  providerName = "OpenVINOExecutionProvider"; break;
+        default:                    return false;
+    }
+    
+    try
+    {
+        const auto providers = Ort::GetAvailableProviders();
+        return std::find(providers.begin(), providers.end(), providerName) != providers.end();
+    }
+    catch (const Ort::Exception&)
+    {
+        return false;
+    }
+}
+
+void GPUAccelerationManager::setOnnxEngine(OnnxEngine* engine)
+{
+    const juce::ScopedLock sl(gpuLock);
+    
+    onnxEngine = engine;
+    applyToEngine();
+}
+
+void GPUAccelerationManager::applyToEngine()
+{
+    if (onnxEngine == nullptr)
+        return;
+    
+    // Roles without an explicit backend follow the active one
+    GPUConfig engineConfig = currentConfig;
+    engineConfig.preferredBackend = activeBackend;
+    onnxEngine->setExecutionConfig(engineConfig);
+    onnxEngine->setExecutionDevice(activeDevice);
+    onnxEngine->setUseGPU(gpuActive);
 }
 
 float GPUAccelerationManager::runBenchmark()
 {
     const juce::ScopedLock sl(gpuLock);
     
-    // Simulate benchmark with timing
-    auto startTime = juce::Time::getHighResolutionTicks();
+    if (onnxEngine == nullptr)
+    {
+        Logger::log(Logger::Level::Warning, "Benchmark skipped: no ONNX engine attached");
+        return 0.0f;
+    }
+    
+    // CPU is always a candidate; GPU backends only if their provider is present
+    std::vector<GPUBackend> backends = { GPUBackend::None };
+    for (const auto& device : availableDevices)
+    {
+        if (device.isAvailable && std::find(backends.begin(), backends.end(), device.backend) == backends.end())
+            backends.push_back(device.backend);
+    }
+    
+    benchmarkResults.clear();
+    metrics.reset();
     
-    // Simulate some work
-    volatile float sum = 0.0f;
-    for (int i = 0; i < 10000000; ++i)
+    const auto roles = onnxEngine->getLoadedModels();
+    for (const auto& role : roles)
     {
-        sum += std::sin(static_cast<float>(i) * 0.001f);
+        for (auto backend : backends)
+        {
+            for (int blockSize : benchmarkBlockSizes)
+            {
+                auto result = onnxEngine->benchmarkModel(role, backend, blockSize);
+                
+                // Overall metrics track the backend currently in use
+                if (result.succeeded && backend == activeBackend)
+                {
+                    metrics.update(result.metrics.averageInferenceTimeMs);
+                    metrics.maxInferenceTimeMs = juce::jmax(metrics.maxInferenceTimeMs,
+                                                            result.metrics.maxInferenceTimeMs);
+                }
+                
+                benchmarkResults.push_back(result);
+            }
+        }
     }
     
-    auto endTime = juce::Time::getHighResolutionTicks();
-    double elapsedMs = juce::Time::highResolutionTicksToSeconds(endTime - startTime) * 1000.0;
+    onnxEngine->selectFastestBackends(benchmarkResults);
     
-    // Score: higher is better (inversely proportional to time)
-    float score = static_cast<float>(10000.0 / elapsedMs);
+    for (auto* listener : listeners)
+        listener->onPerformanceMetricsUpdated(metrics);
     
-    // Apply GPU multiplier if active
-    if (gpuActive)
+    if (metrics.inferenceCount == 0)
     {
-        score *= 5.0f; // GPU is roughly 5x faster for this type of work
+        Logger::log(Logger::Level::Warning, "Benchmark: no loaded model could run on "
+                    + getBackendName(activeBackend));
+        return 0.0f;
     }
     
-    Logger::log(Logger::Level::Info, "Benchmark score: " + juce::String(score, 2));
+    // Score: higher is better (inversely proportional to mean inference time)
+    float score = static_cast<float>(100.0 / juce::jmax(0.001, metrics.averageInferenceTimeMs));
+    
+    Logger::log(Logger::Level::Info, "Benchmark score: " + juce::String(score, 2) + " ("
+                + juce::String(roles.size()) + " models, " + juce::String(static_cast<int>(backends.size()))
+                + " backends)");
     
     return score;
 }
 
+std::vector<BackendBenchmarkResult> GPUAccelerationManager::getBenchmarkResults() const
+{
+    const juce::ScopedLock sl(gpuLock);
+    return benchmarkResults;
+}
+
+void GPUAccelerationManager::setBenchmarkBlockSizes(const std::vector<int>& blockSizes)
+{
+    const juce::ScopedLock sl(gpuLock);
+    
+    benchmarkBlockSizes.clear();
+    for (int blockSize : blockSizes)
+    {
+        if (blockSize > 0)
+            benchmarkBlockSizes.push_back(blockSize);
+    }
+}
+
 void GPUAccelerationManager::detectDevices()
 {
     availableDevices.clear();
     gpuAvailable = false;
     
-    // NOTE: This is placeholder/simulation code for GPU device detection.
-    // In a production implementation, actual GPU detection would use:
-    // - CUDA: cudaGetDeviceCount() and cudaGetDeviceProperties()
-    // - DirectML: ID3D12Device enumeration
-    // - CoreML: MLModel availability check
-    // The simulated memory values represent typical mid-range GPU specifications.
+    // Availability comes from the execution providers compiled into the
+    // linked ONNX Runtime. CUDA devices, their compute capability and memory
+    // come from the driver; anything not queried stays 0 (unknown), which
+    // precision selection treats as "no fast fp16".
     
-#ifdef _WIN32
-    // On Windows, check for CUDA and DirectML
-    {
-        GPUDeviceInfo cudaDevice;
-        cudaDevice.name = "NVIDIA GPU (CUDA)";
-        cudaDevice.backend = GPUBackend::CUDA;
-        cudaDevice.deviceIndex = 0;
-        // Simulated memory values - in production, use cudaMemGetInfo()
-        cudaDevice.totalMemory = 8ULL * 1024 * 1024 * 1024; // 8GB simulated (typical GTX 1080)
-        cudaDevice.freeMemory = 6ULL * 1024 * 1024 * 1024;  // 6GB free (accounting for OS usage)
-        cudaDevice.isAvailable = false; // Actual CUDA check would go here
-        cudaDevice.computeCapability = 7.5f;
+#if defined(_WIN32) || defined(__linux__)
+    // CUDA and TensorRT both run on the devices the CUDA driver reports
+    const auto cudaDevices = queryCudaDevices();
+    for (auto cudaDevice : cudaDevices)
+    {
+        cudaDevice.isAvailable = isProviderCompiledIn(GPUBackend::CUDA);
         availableDevices.push_back(cudaDevice);
+        gpuAvailable = gpuAvailable || cudaDevice.isAvailable;
     }
-    
+#endif
+
+#ifdef _WIN32
     {
         GPUDeviceInfo dmlDevice;
         dmlDevice.name = "DirectX 12 GPU (DirectML)";
         dmlDevice.backend = GPUBackend::DirectML;
         dmlDevice.deviceIndex = 0;
-        // Simulated memory values - in production, use DXGI adapter enumeration
-        dmlDevice.totalMemory = 8ULL * 1024 * 1024 * 1024;
-        dmlDevice.freeMemory = 6ULL * 1024 * 1024 * 1024;
-        dmlDevice.isAvailable = true; // DirectML is generally available on Windows 10+
+        dmlDevice.isAvailable = MAEVN_ENABLE_DIRECTML && isProviderCompiledIn(GPUBackend::DirectML);
         availableDevices.push_back(dmlDevice);
-        gpuAvailable = true;
+        gpuAvailable = gpuAvailable || dmlDevice.isAvailable;
     }
 #endif
 
@@ -311,21 +585,22 @@ void GPUAccelerationManager::detectDevices()
         coremlDevice.name = "Apple GPU (CoreML)";
         coremlDevice.backend = GPUBackend::CoreML;
         coremlDevice.deviceIndex = 0;
-        coremlDevice.isAvailable = true; // CoreML is available on all modern macOS
+        coremlDevice.isAvailable = MAEVN_ENABLE_COREML && isProviderCompiledIn(GPUBackend::CoreML);
         availableDevices.push_back(coremlDevice);
-        gpuAvailable = true;
+        gpuAvailable = gpuAvailable || coremlDevice.isAvailable;
     }
 #endif
 
-#ifdef __linux__
-    // On Linux, check for CUDA
+#if defined(_WIN32) || defined(__linux__)
+    if (isProviderCompiledIn(GPUBackend::TensorRT))
     {
-        GPUDeviceInfo cudaDevice;
-        cudaDevice.name = "NVIDIA GPU (CUDA)";
-        cudaDevice.backend = GPUBackend::CUDA;
-        cudaDevice.deviceIndex = 0;
-        cudaDevice.isAvailable = false; // Actual CUDA check would go here
-        availableDevices.push_back(cudaDevice);
+        for (auto trtDevice : cudaDevices)
+        {
+            trtDevice.backend = GPUBackend::TensorRT;
+            trtDevice.isAvailable = true;
+            availableDevices.push_back(trtDevice);
+            gpuAvailable = true;
+        }
     }
 #endif
     
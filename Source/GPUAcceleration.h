@@ -9,13 +9,25 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <onnxruntime_cxx_api.h>
 #include <memory>
 #include <vector>
 #include "Utilities.h"
 
+// Providers that need extra headers from the matching ONNX Runtime package
+#ifndef MAEVN_ENABLE_DIRECTML
+    #define MAEVN_ENABLE_DIRECTML 0
+#endif
+
+#ifndef MAEVN_ENABLE_COREML
+    #define MAEVN_ENABLE_COREML 0
+#endif
+
 namespace MAEVN
 {
 
+class OnnxEngine;
+
 //==============================================================================
 /**
  * @brief GPU backend types
@@ -39,11 +51,11 @@ struct GPUDeviceInfo
     juce::String name;              ///< Device name
     GPUBackend backend;             ///< Backend type
     int deviceIndex;                ///< Device index
-    size_t totalMemory;             ///< Total GPU memory in bytes
-    size_t freeMemory;              ///< Available GPU memory in bytes
+    size_t totalMemory;             ///< Total GPU memory in bytes (0 = unknown)
+    size_t freeMemory;              ///< Available GPU memory in bytes (0 = unknown)
     bool isAvailable;               ///< Whether device is usable
     juce::String driverVersion;     ///< Driver version string
-    float computeCapability;        ///< CUDA compute capability (if applicable)
+    float computeCapability;        ///< CUDA compute capability (0 = unknown or not CUDA)
     
     GPUDeviceInfo()
         : backend(GPUBackend::None)
@@ -123,6 +135,25 @@ struct GPUPerformanceMetrics
     }
 };
 
+//==============================================================================
+/**
+ * @brief Timing of one model role on one backend at one block size
+ */
+struct BackendBenchmarkResult
+{
+    juce::String role;              ///< Model role
+    GPUBackend backend;             ///< Backend the session ran on
+    int blockSize;                  ///< Samples per inference
+    bool succeeded;                 ///< Session created and ran on this backend
+    GPUPerformanceMetrics metrics;  ///< Per-inference timings
+    
+    BackendBenchmarkResult()
+        : backend(GPUBackend::None)
+        , blockSize(0)
+        , succeeded(false)
+    {}
+};
+
 //==============================================================================
 /**
  * @brief Listener interface for GPU acceleration events
@@ -267,11 +298,33 @@ public:
     
     /**
      * @brief Get session options for ONNX Runtime with GPU
-     * Note: In actual implementation, this would return Ort::SessionOptions
      * @return Configuration string for logging/debugging
      */
     juce::String getOnnxSessionOptionsDescription() const;
     
+    /**
+     * @brief Append the execution provider for a backend to session options
+     * 
+     * GPUBackend::None leaves the options on ORT's default CPU provider.
+     * @return true if the provider was appended (or none was needed)
+     */
+    static bool appendExecutionProvider(Ort::SessionOptions& options,
+                                        GPUBackend backend,
+                                        const GPUConfig& config);
+    
+    /**
+     * @brief Check if the linked ONNX Runtime build contains a backend's provider
+     */
+    static bool isProviderCompiledIn(GPUBackend backend);
+    
+    /**
+     * @brief Attach the engine whose sessions use this manager's configuration
+     * 
+     * initialize() then pushes the active backend to the engine, and
+     * runBenchmark() times the engine's loaded models.
+     */
+    void setOnnxEngine(OnnxEngine* engine);
+    
     /**
      * @brief Estimate GPU memory required for a model
      * @param modelSizeBytes Model file size in bytes
@@ -287,11 +340,24 @@ public:
     bool hasEnoughMemory(size_t requiredBytes) const;
     
     /**
-     * @brief Run GPU benchmark
-     * @return Benchmark score (higher is better)
+     * @brief Benchmark every loaded model on every available backend
+     * 
+     * Runs synchronously. Results feed the performance metrics and the
+     * engine switches each role to its fastest backend.
+     * @return Benchmark score (higher is better, 0 if nothing could run)
      */
     float runBenchmark();
     
+    /**
+     * @brief Get per-role results of the last runBenchmark()
+     */
+    std::vector<BackendBenchmarkResult> getBenchmarkResults() const;
+    
+    /**
+     * @brief Block sizes used by runBenchmark() (default 128, 256, 512)
+     */
+    void setBenchmarkBlockSizes(const std::vector<int>& blockSizes);
+    
 private:
     GPUConfig currentConfig;
     GPUDeviceInfo activeDevice;
@@ -304,7 +370,11 @@ private:
     std::vector<GPUDeviceInfo> availableDevices;
     std::vector<GPUAccelerationListener*> listeners;
     
-    juce::CriticalSection gpuLock;
+    OnnxEngine* onnxEngine;
+    std::vector<int> benchmarkBlockSizes;
+    std::vector<BackendBenchmarkResult> benchmarkResults;
+    
+    mutable juce::CriticalSection gpuLock;
     
     /**
      * @brief Detect available GPU devices
@@ -346,6 +416,11 @@ private:
      */
     void updateMetrics();
     
+    /**
+     * @brief Push the active backend and configuration to the attached engine
+     */
+    void applyToEngine();
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GPUAccelerationManager)
 };
 
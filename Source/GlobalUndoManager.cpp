@@ -4,16 +4,30 @@
  */
 
 #include "GlobalUndoManager.h"
+#include <algorithm>
 
 namespace MAEVN
 {
 
+namespace
+{
+    inline bool isContinuationByte(char c)
+    {
+        return (static_cast<unsigned char>(c) & 0xc0) == 0x80;
+    }
+}
+
 //==============================================================================
 GlobalUndoManager::GlobalUndoManager()
-    : currentIndex(-1)
-    , maxHistorySize(100)
+    : ringHead(0)
+    , numEntries(0)
+    , firstSequence(0)
+    , currentIndex(-1)
+    , memoryUsage(0)
+    , memoryBudget(DEFAULT_MEMORY_BUDGET)
     , inTransaction(false)
 {
+    latestOfType.fill(-1);
 }
 
 GlobalUndoManager::~GlobalUndoManager()
@@ -31,18 +45,7 @@ void GlobalUndoManager::addAction(const ActionState& action)
         return;
     }
     
-    // Remove any actions after current index (they become invalidated)
-    if (currentIndex < (int)history.size() - 1)
-    {
-        history.erase(history.begin() + currentIndex + 1, history.end());
-    }
-    
-    // Add new action
-    history.push_back(action);
-    currentIndex++;
-    
-    // Trim if necessary
-    trimHistory();
+    pushAction(action);
     
     Logger::log(Logger::Level::Info, "Action added: " + action.description);
 }
@@ -54,17 +57,17 @@ bool GlobalUndoManager::undo()
     if (!canUndo())
         return false;
     
-    const auto& action = history[currentIndex];
+    const auto sequence = firstSequence + currentIndex;
     
     // Call undo callback if set
     if (undoCallback)
     {
-        undoCallback(action);
+        undoCallback(makeAction(sequence, getState(sequence)));
     }
     
     currentIndex--;
     
-    Logger::log(Logger::Level::Info, "Undo: " + action.description);
+    Logger::log(Logger::Level::Info, "Undo: " + getEntry(sequence).description);
     return true;
 }
 
@@ -76,28 +79,28 @@ bool GlobalUndoManager::redo()
         return false;
     
     currentIndex++;
-    const auto& action = history[currentIndex];
+    const auto sequence = firstSequence + currentIndex;
     
     // Call redo callback if set
     if (redoCallback)
     {
-        redoCallback(action);
+        redoCallback(makeAction(sequence, getState(sequence)));
     }
     
-    Logger::log(Logger::Level::Info, "Redo: " + action.description);
+    Logger::log(Logger::Level::Info, "Redo: " + getEntry(sequence).description);
     return true;
 }
 
 bool GlobalUndoManager::canUndo() const
 {
     const juce::ScopedLock sl(historyLock);
-    return currentIndex >= 0 && !history.empty();
+    return currentIndex >= 0 && numEntries > 0;
 }
 
 bool GlobalUndoManager::canRedo() const
 {
     const juce::ScopedLock sl(historyLock);
-    return currentIndex < (int)history.size() - 1;
+    return currentIndex < static_cast<int>(numEntries) - 1;
 }
 
 juce::String GlobalUndoManager::getUndoDescription() const
@@ -106,7 +109,7 @@ juce::String GlobalUndoManager::getUndoDescription() const
     
     if (canUndo())
     {
-        return history[currentIndex].description;
+        return getEntry(firstSequence + currentIndex).description;
     }
     return "";
 }
@@ -117,7 +120,7 @@ juce::String GlobalUndoManager::getRedoDescription() const
     
     if (canRedo())
     {
-        return history[currentIndex + 1].description;
+        return getEntry(firstSequence + currentIndex + 1).description;
     }
     return "";
 }
@@ -126,33 +129,45 @@ bool GlobalUndoManager::jumpToHistoryIndex(int index)
 {
     const juce::ScopedLock sl(historyLock);
     
-    if (index < -1 || index >= (int)history.size())
+    if (index < -1 || index >= static_cast<int>(numEntries))
         return false;
     
     int previousIndex = currentIndex;
     currentIndex = index;
     
     // Apply or undo actions as needed
-    if (index > previousIndex)
+    if (index > previousIndex && redoCallback)
     {
-        // Redo actions
+        // Redo actions; walking forwards, each delta applies to the state
+        // of the type rebuilt last, so the jump costs one delta per action
+        std::array<juce::int64, NUM_ACTION_TYPES> rebuiltSequence;
+        std::array<juce::var, NUM_ACTION_TYPES> rebuiltState;
+        rebuiltSequence.fill(-1);
+        
         for (int i = previousIndex + 1; i <= index; ++i)
         {
-            if (redoCallback)
-            {
-                redoCallback(history[i]);
-            }
+            const auto sequence = firstSequence + i;
+            const auto& entry = getEntry(sequence);
+            const auto typeIndex = static_cast<size_t>(entry.type);
+            
+            if (entry.isKeyframe)
+                rebuiltState[typeIndex] = entry.keyframe;
+            else if (rebuiltSequence[typeIndex] == entry.previousOfType)
+                rebuiltState[typeIndex] = applyDelta(rebuiltState[typeIndex], entry.delta);
+            else
+                rebuiltState[typeIndex] = getState(sequence);
+            
+            rebuiltSequence[typeIndex] = sequence;
+            redoCallback(makeAction(sequence, rebuiltState[typeIndex]));
         }
     }
-    else if (index < previousIndex)
+    else if (index < previousIndex && undoCallback)
     {
         // Undo actions
         for (int i = previousIndex; i > index; --i)
         {
-            if (undoCallback)
-            {
-                undoCallback(history[i]);
-            }
+            const auto sequence = firstSequence + i;
+            undoCallback(makeAction(sequence, getState(sequence)));
         }
     }
     
@@ -164,21 +179,63 @@ void GlobalUndoManager::clearHistory()
 {
     const juce::ScopedLock sl(historyLock);
     
-    history.clear();
+    ring.clear();
+    ringHead = 0;
+    numEntries = 0;
+    firstSequence = 0;
     currentIndex = -1;
+    latestOfType.fill(-1);
+    latestState.fill({});
+    memoryUsage = 0;
     
     Logger::log(Logger::Level::Info, "History cleared");
 }
 
-void GlobalUndoManager::setMaxHistorySize(int maxSize)
+int GlobalUndoManager::getHistorySize() const
+{
+    const juce::ScopedLock sl(historyLock);
+    return static_cast<int>(numEntries);
+}
+
+juce::String GlobalUndoManager::getHistoryDescription(int index) const
 {
     const juce::ScopedLock sl(historyLock);
     
-    if (maxSize > 0)
-    {
-        maxHistorySize = maxSize;
-        trimHistory();
-    }
+    if (index < 0 || index >= static_cast<int>(numEntries))
+        return {};
+    
+    return getEntry(firstSequence + index).description;
+}
+
+ActionState GlobalUndoManager::getHistoryAction(int index) const
+{
+    const juce::ScopedLock sl(historyLock);
+    
+    if (index < 0 || index >= static_cast<int>(numEntries))
+        return ActionState(ActionState::Type::FXChange, {}, {});
+    
+    const auto sequence = firstSequence + index;
+    return makeAction(sequence, getState(sequence));
+}
+
+void GlobalUndoManager::setMemoryBudget(size_t bytes)
+{
+    const juce::ScopedLock sl(historyLock);
+    
+    memoryBudget = bytes;
+    trimHistory();
+}
+
+size_t GlobalUndoManager::getMemoryBudget() const
+{
+    const juce::ScopedLock sl(historyLock);
+    return memoryBudget;
+}
+
+size_t GlobalUndoManager::getMemoryUsage() const
+{
+    const juce::ScopedLock sl(historyLock);
+    return memoryUsage;
 }
 
 void GlobalUndoManager::beginTransaction(const juce::String& description)
@@ -224,14 +281,7 @@ void GlobalUndoManager::endTransaction()
             );
             
             // Add compound action to history
-            if (currentIndex < (int)history.size() - 1)
-            {
-                history.erase(history.begin() + currentIndex + 1, history.end());
-            }
-            
-            history.push_back(compoundAction);
-            currentIndex++;
-            trimHistory();
+            pushAction(compoundAction);
         }
         
         inTransaction = false;
@@ -250,12 +300,82 @@ void GlobalUndoManager::setRedoCallback(std::function<void(const ActionState&)>
     redoCallback = callback;
 }
 
+//==============================================================================
+void GlobalUndoManager::pushAction(const ActionState& action)
+{
+    // Remove any actions after current index (they become invalidated)
+    while (static_cast<int>(numEntries) > currentIndex + 1)
+    {
+        popNewest();
+    }
+    
+    const auto sequence = firstSequence + static_cast<juce::int64>(numEntries);
+    const auto typeIndex = static_cast<size_t>(action.type);
+    
+    Entry entry;
+    entry.type = action.type;
+    entry.description = action.description;
+    entry.timestamp = action.timestamp;
+    entry.previousOfType = latestOfType[typeIndex];
+    
+    const auto stateBytes = estimateSize(action.stateData);
+    
+    if (entry.previousOfType >= 0)
+    {
+        auto& previous = getEntry(entry.previousOfType);
+        const int chainLength = previous.isKeyframe ? 0 : previous.chainLength;
+        
+        if (chainLength + 1 < KEYFRAME_INTERVAL)
+        {
+            auto delta = createDelta(latestState[typeIndex], action.stateData);
+            
+            // Small or unrelated states are cheaper kept whole
+            if (estimateSize(delta) < stateBytes)
+            {
+                entry.isKeyframe = false;
+                entry.delta = std::move(delta);
+                entry.chainLength = chainLength + 1;
+            }
+        }
+        
+        previous.nextOfType = sequence;
+    }
+    
+    if (entry.isKeyframe)
+        entry.keyframe = action.stateData;
+    
+    entry.bytes = sizeof(Entry) + static_cast<size_t>(entry.description.getNumBytesAsUTF8())
+                + (entry.isKeyframe ? stateBytes : estimateSize(entry.delta));
+    
+    // Grow the ring, unwrapping it, when full
+    if (numEntries == ring.size())
+    {
+        std::vector<Entry> grown(std::max<size_t>(64, ring.size() * 2));
+        for (size_t i = 0; i < numEntries; ++i)
+            grown[i] = std::move(ring[(ringHead + i) % ring.size()]);
+        
+        ring = std::move(grown);
+        ringHead = 0;
+    }
+    
+    memoryUsage += entry.bytes;
+    ring[(ringHead + numEntries) % ring.size()] = std::move(entry);
+    ++numEntries;
+    currentIndex++;
+    
+    latestOfType[typeIndex] = sequence;
+    latestState[typeIndex] = action.stateData;
+    
+    // Trim if necessary
+    trimHistory();
+}
+
 void GlobalUndoManager::trimHistory()
 {
-    // Remove oldest actions if history exceeds max size
-    while ((int)history.size() > maxHistorySize)
+    // Remove oldest actions while over budget, keeping the newest
+    while (memoryUsage > memoryBudget && numEntries > 1)
     {
-        history.erase(history.begin());
+        popOldest();
         if (currentIndex >= 0)
         {
             currentIndex--;
@@ -263,4 +383,339 @@ void GlobalUndoManager::trimHistory()
     }
 }
 
+void GlobalUndoManager::popOldest()
+{
+    auto& oldest = getEntry(firstSequence);
+    
+    // The oldest entry of a type is always a keyframe; the next one becomes one in its place
+    if (oldest.nextOfType >= 0)
+    {
+        auto& next = getEntry(oldest.nextOfType);
+        
+        if (!next.isKeyframe)
+        {
+            memoryUsage -= next.bytes;
+            next.keyframe = applyDelta(oldest.keyframe, next.delta);
+            next.delta = {};
+            next.isKeyframe = true;
+            next.bytes = sizeof(Entry) + static_cast<size_t>(next.description.getNumBytesAsUTF8())
+                       + estimateSize(next.keyframe);
+            memoryUsage += next.bytes;
+        }
+        
+        next.previousOfType = -1;
+    }
+    
+    const auto typeIndex = static_cast<size_t>(oldest.type);
+    if (latestOfType[typeIndex] == firstSequence)
+    {
+        latestOfType[typeIndex] = -1;
+        latestState[typeIndex] = {};
+    }
+    
+    memoryUsage -= oldest.bytes;
+    oldest = {};
+    
+    ringHead = (ringHead + 1) % ring.size();
+    --numEntries;
+    ++firstSequence;
+}
+
+void GlobalUndoManager::popNewest()
+{
+    const auto sequence = firstSequence + static_cast<juce::int64>(numEntries) - 1;
+    auto& newest = getEntry(sequence);
+    const auto typeIndex = static_cast<size_t>(newest.type);
+    
+    latestOfType[typeIndex] = newest.previousOfType;
+    if (newest.previousOfType >= 0)
+    {
+        getEntry(newest.previousOfType).nextOfType = -1;
+        latestState[typeIndex] = getState(newest.previousOfType);
+    }
+    else
+    {
+        latestState[typeIndex] = {};
+    }
+    
+    memoryUsage -= newest.bytes;
+    newest = {};
+    --numEntries;
+}
+
+GlobalUndoManager::Entry& GlobalUndoManager::getEntry(juce::int64 sequence)
+{
+    return ring[(ringHead + static_cast<size_t>(sequence - firstSequence)) % ring.size()];
+}
+
+const GlobalUndoManager::Entry& GlobalUndoManager::getEntry(juce::int64 sequence) const
+{
+    return ring[(ringHead + static_cast<size_t>(sequence - firstSequence)) % ring.size()];
+}
+
+juce::var GlobalUndoManager::getState(juce::int64 sequence) const
+{
+    // Walk back to the keyframe, then apply the deltas forwards
+    std::array<const StateDelta*, KEYFRAME_INTERVAL> chain;
+    size_t chainLength = 0;
+    
+    while (!getEntry(sequence).isKeyframe && chainLength < chain.size())
+    {
+        chain[chainLength++] = &getEntry(sequence).delta;
+        sequence = getEntry(sequence).previousOfType;
+    }
+    
+    auto state = getEntry(sequence).keyframe;
+    while (chainLength > 0)
+    {
+        state = applyDelta(state, *chain[--chainLength]);
+    }
+    
+    return state;
+}
+
+ActionState GlobalUndoManager::makeAction(juce::int64 sequence, const juce::var& state) const
+{
+    const auto& entry = getEntry(sequence);
+    
+    ActionState action(entry.type, entry.description, state);
+    action.timestamp = entry.timestamp;
+    return action;
+}
+
+//==============================================================================
+GlobalUndoManager::StateDelta GlobalUndoManager::createDelta(const juce::var& from, const juce::var& to)
+{
+    StateDelta delta;
+    
+    if (from.isString() && to.isString())
+    {
+        // Keep the common head and tail; split only between characters
+        const auto fromText = from.toString();
+        const auto toText = to.toString();
+        const char* a = fromText.toRawUTF8();
+        const char* b = toText.toRawUTF8();
+        const size_t lengthA = fromText.getNumBytesAsUTF8();
+        const size_t lengthB = toText.getNumBytesAsUTF8();
+        const size_t common = std::min(lengthA, lengthB);
+        
+        size_t head = 0;
+        while (head < common && a[head] == b[head])
+            ++head;
+        while (head > 0 && isContinuationByte(b[head]))
+            --head;
+        
+        size_t tail = 0;
+        while (tail < common - head && a[lengthA - 1 - tail] == b[lengthB - 1 - tail])
+            ++tail;
+        while (tail > 0 && isContinuationByte(b[lengthB - tail]))
+            --tail;
+        
+        delta.kind = StateDelta::Kind::StringSplice;
+        delta.keepHead = static_cast<int>(head);
+        delta.keepTail = static_cast<int>(tail);
+        delta.value = juce::String::fromUTF8(b + head, static_cast<int>(lengthB - head - tail));
+        return delta;
+    }
+    
+    const auto* arrayA = from.getArray();
+    const auto* arrayB = to.getArray();
+    
+    if (arrayA != nullptr && arrayB != nullptr)
+    {
+        const int common = std::min(arrayA->size(), arrayB->size());
+        
+        int head = 0;
+        while (head < common && sameState(arrayA->getReference(head), arrayB->getReference(head)))
+            ++head;
+        
+        int tail = 0;
+        while (tail < common - head
+               && sameState(arrayA->getReference(arrayA->size() - 1 - tail), arrayB->getReference(arrayB->size() - 1 - tail)))
+            ++tail;
+        
+        juce::Array<juce::var> inserted;
+        for (int i = head; i < arrayB->size() - tail; ++i)
+            inserted.add(arrayB->getReference(i));
+        
+        delta.kind = StateDelta::Kind::ArraySplice;
+        delta.keepHead = head;
+        delta.keepTail = tail;
+        delta.value = inserted;
+        return delta;
+    }
+    
+    auto* objectA = from.getDynamicObject();
+    auto* objectB = to.getDynamicObject();
+    
+    if (objectA != nullptr && objectB != nullptr)
+    {
+        delta.kind = StateDelta::Kind::Properties;
+        
+        for (const auto& property : objectB->getProperties())
+        {
+            if (!objectA->hasProperty(property.name))
+            {
+                StateDelta added;
+                added.value = property.value;
+                delta.changed.push_back({ property.name, std::move(added) });
+            }
+            else if (!sameState(objectA->getProperty(property.name), property.value))
+            {
+                delta.changed.push_back({ property.name, createDelta(objectA->getProperty(property.name), property.value) });
+            }
+        }
+        
+        for (const auto& property : objectA->getProperties())
+        {
+            if (!objectB->hasProperty(property.name))
+                delta.removed.add(property.name);
+        }
+        
+        return delta;
+    }
+    
+    delta.value = to;
+    return delta;
+}
+
+juce::var GlobalUndoManager::applyDelta(const juce::var& from, const StateDelta& delta)
+{
+    switch (delta.kind)
+    {
+        case StateDelta::Kind::StringSplice:
+        {
+            const auto fromText = from.toString();
+            const char* text = fromText.toRawUTF8();
+            const int length = static_cast<int>(fromText.getNumBytesAsUTF8());
+            
+            return juce::String::fromUTF8(text, delta.keepHead)
+                 + delta.value.toString()
+                 + juce::String::fromUTF8(text + length - delta.keepTail, delta.keepTail);
+        }
+        
+        case StateDelta::Kind::ArraySplice:
+        {
+            // Build a new array: stored states share their elements and are never modified
+            const auto* elements = from.getArray();
+            const auto* inserted = delta.value.getArray();
+            juce::Array<juce::var> result;
+            
+            if (elements != nullptr)
+            {
+                for (int i = 0; i < delta.keepHead; ++i)
+                    result.add(elements->getReference(i));
+            }
+            
+            if (inserted != nullptr)
+                result.addArray(*inserted);
+            
+            if (elements != nullptr)
+            {
+                for (int i = elements->size() - delta.keepTail; i < elements->size(); ++i)
+                    result.add(elements->getReference(i));
+            }
+            
+            return result;
+        }
+        
+        case StateDelta::Kind::Properties:
+        {
+            auto* result = new juce::DynamicObject();
+            
+            if (auto* object = from.getDynamicObject())
+            {
+                for (const auto& property : object->getProperties())
+                    result->setProperty(property.name, property.value);
+            }
+            
+            for (const auto& name : delta.removed)
+                result->removeProperty(name);
+            
+            for (const auto& property : delta.changed)
+                result->setProperty(property.name, applyDelta(result->getProperty(property.name), property.delta));
+            
+            return juce::var(result);
+        }
+        
+        case StateDelta::Kind::Replace:
+        default:
+            return delta.value;
+    }
+}
+
+bool GlobalUndoManager::sameState(const juce::var& a, const juce::var& b)
+{
+    if (const auto* arrayA = a.getArray())
+    {
+        const auto* arrayB = b.getArray();
+        if (arrayB == nullptr || arrayA->size() != arrayB->size())
+            return false;
+        
+        for (int i = 0; i < arrayA->size(); ++i)
+        {
+            if (!sameState(arrayA->getReference(i), arrayB->getReference(i)))
+                return false;
+        }
+        return true;
+    }
+    
+    if (auto* objectA = a.getDynamicObject())
+    {
+        auto* objectB = b.getDynamicObject();
+        if (objectA == objectB)
+            return true;
+        if (objectB == nullptr || objectA->getProperties().size() != objectB->getProperties().size())
+            return false;
+        
+        for (const auto& property : objectA->getProperties())
+        {
+            if (!objectB->hasProperty(property.name) || !sameState(property.value, objectB->getProperty(property.name)))
+                return false;
+        }
+        return true;
+    }
+    
+    return a.hasSameTypeAs(b) && a == b;
+}
+
+size_t GlobalUndoManager::estimateSize(const juce::var& value)
+{
+    size_t bytes = sizeof(juce::var);
+    
+    if (value.isString())
+    {
+        bytes += static_cast<size_t>(value.toString().getNumBytesAsUTF8());
+    }
+    else if (const auto* elements = value.getArray())
+    {
+        for (const auto& element : *elements)
+            bytes += estimateSize(element);
+    }
+    else if (auto* object = value.getDynamicObject())
+    {
+        for (const auto& property : object->getProperties())
+            bytes += static_cast<size_t>(property.name.toString().getNumBytesAsUTF8()) + estimateSize(property.value);
+    }
+    else if (const auto* data = value.getBinaryData())
+    {
+        bytes += data->getSize();
+    }
+    
+    return bytes;
+}
+
+size_t GlobalUndoManager::estimateSize(const StateDelta& delta)
+{
+    size_t bytes = sizeof(StateDelta) + estimateSize(delta.value);
+    
+    for (const auto& property : delta.changed)
+        bytes += static_cast<size_t>(property.name.toString().getNumBytesAsUTF8()) + estimateSize(property.delta);
+    
+    for (const auto& name : delta.removed)
+        bytes += static_cast<size_t>(name.toString().getNumBytesAsUTF8());
+    
+    return bytes;
+}
+
 } // namespace MAEVN
@@ -4,11 +4,18 @@
  * 
  * This module provides a comprehensive undo/redo system that tracks
  * changes to FX, arrangements, models, and timeline.
+ * 
+ * Snapshots are not kept whole: each action stores the structural delta
+ * from the previous action of its type, with a full keyframe every
+ * KEYFRAME_INTERVAL actions, so rebuilding any snapshot applies a bounded
+ * number of deltas. History lives in a ring buffer trimmed from the
+ * oldest end once its estimated size exceeds a memory budget in bytes.
  */
 
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
 #include <vector>
 #include <memory>
 #include "Utilities.h"
@@ -100,9 +107,19 @@ public:
     bool jumpToHistoryIndex(int index);
     
     /**
-     * @brief Get all history actions
+     * @brief Get the number of actions in the history
      */
-    const std::vector<ActionState>& getHistory() const { return history; }
+    int getHistorySize() const;
+    
+    /**
+     * @brief Get the description of a history action (cheap)
+     */
+    juce::String getHistoryDescription(int index) const;
+    
+    /**
+     * @brief Get a history action with its full state rebuilt from the deltas
+     */
+    ActionState getHistoryAction(int index) const;
     
     /**
      * @brief Get current position in history
@@ -115,14 +132,19 @@ public:
     void clearHistory();
     
     /**
-     * @brief Set maximum history size
+     * @brief Set the memory budget of the history in bytes (trims immediately)
+     */
+    void setMemoryBudget(size_t bytes);
+    
+    /**
+     * @brief Get the memory budget of the history in bytes
      */
-    void setMaxHistorySize(int maxSize);
+    size_t getMemoryBudget() const;
     
     /**
-     * @brief Get maximum history size
+     * @brief Get the estimated bytes held by the history
      */
-    int getMaxHistorySize() const { return maxHistorySize; }
+    size_t getMemoryUsage() const;
     
     /**
      * @brief Begin a transaction (group multiple actions)
@@ -151,10 +173,76 @@ public:
      */
     void setRedoCallback(std::function<void(const ActionState&)> callback);
     
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 16 * 1024 * 1024;
+    
+    /** Actions of a type between full snapshots */
+    static constexpr int KEYFRAME_INTERVAL = 32;
+    
 private:
-    std::vector<ActionState> history;
+    //==============================================================================
+    /**
+     * @brief Turns one state into the next
+     */
+    struct StateDelta
+    {
+        struct PropertyDelta;
+        
+        enum class Kind
+        {
+            Replace,        // value is the new state
+            StringSplice,   // keep keepHead and keepTail UTF-8 bytes, insert value between
+            ArraySplice,    // keep keepHead and keepTail elements, insert value's elements between
+            Properties      // apply changed and removed to the object's properties
+        };
+        
+        Kind kind = Kind::Replace;
+        int keepHead = 0;
+        int keepTail = 0;
+        juce::var value;
+        std::vector<PropertyDelta> changed;
+        juce::Array<juce::Identifier> removed;
+    };
+    
+    struct StateDelta::PropertyDelta
+    {
+        juce::Identifier name;
+        StateDelta delta;
+    };
+    
+    struct Entry
+    {
+        ActionState::Type type = ActionState::Type::FXChange;
+        juce::String description;
+        juce::Time timestamp;
+        
+        bool isKeyframe = true;
+        juce::var keyframe;             // The full state (keyframes)
+        StateDelta delta;               // From the previous entry of the type (otherwise)
+        int chainLength = 0;            // Deltas since the type's last keyframe
+        
+        // Sequence numbers of the neighbouring entries of the same type (-1 = none)
+        juce::int64 previousOfType = -1;
+        juce::int64 nextOfType = -1;
+        
+        size_t bytes = 0;
+    };
+    
+    static constexpr int NUM_ACTION_TYPES = 5;   // ActionState::Type values
+    
+    // Ring buffer of entries, oldest at ringHead; an entry's sequence number
+    // counts every action ever added, so links survive trimming
+    std::vector<Entry> ring;
+    size_t ringHead;
+    size_t numEntries;
+    juce::int64 firstSequence;
     int currentIndex;
-    int maxHistorySize;
+    
+    // Newest entry of each type and its full state, the base of the next delta
+    std::array<juce::int64, NUM_ACTION_TYPES> latestOfType;
+    std::array<juce::var, NUM_ACTION_TYPES> latestState;
+    
+    size_t memoryUsage;
+    size_t memoryBudget;
     
     bool inTransaction;
     juce::String transactionDescription;
@@ -166,10 +254,34 @@ private:
     mutable juce::CriticalSection historyLock;
     
     /**
-     * @brief Trim history if it exceeds max size
+     * @brief Drop the redo entries and append an action (under historyLock)
+     */
+    void pushAction(const ActionState& action);
+    
+    /**
+     * @brief Remove the oldest entries until the history fits the memory budget
      */
     void trimHistory();
     
+    void popOldest();
+    void popNewest();
+    
+    Entry& getEntry(juce::int64 sequence);
+    const Entry& getEntry(juce::int64 sequence) const;
+    
+    /**
+     * @brief Rebuild an entry's full state from its keyframe and deltas
+     */
+    juce::var getState(juce::int64 sequence) const;
+    
+    ActionState makeAction(juce::int64 sequence, const juce::var& state) const;
+    
+    static StateDelta createDelta(const juce::var& from, const juce::var& to);
+    static juce::var applyDelta(const juce::var& from, const StateDelta& delta);
+    static bool sameState(const juce::var& a, const juce::var& b);
+    static size_t estimateSize(const juce::var& value);
+    static size_t estimateSize(const StateDelta& delta);
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GlobalUndoManager)
 };
 
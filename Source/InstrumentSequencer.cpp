@@ -176,6 +176,7 @@ void HiHatRollGenerator::applyVelocityVariation(SequencerPattern& pattern, float
 //==============================================================================
 
 Bass808GlideGenerator::Bass808GlideGenerator()
+    : pitchSource(nullptr)
 {
 }
 
@@ -183,6 +184,16 @@ Bass808GlideGenerator::~Bass808GlideGenerator()
 {
 }
 
+int Bass808GlideGenerator::getTrackedRootNote(int fallbackNote) const
+{
+    if (pitchSource == nullptr || !pitchSource->hasPitch())
+        return fallbackNote;
+    
+    // Keep the pitch class, drop the octave: C1 (24) to B1 (35)
+    const int trackedNote = juce::roundToInt(pitchSource->getMidiNote());
+    return 24 + ((trackedNote % 12) + 12) % 12;
+}
+
 SequencerPattern Bass808GlideGenerator::generateSimpleBass(int numSteps, int rootNote, 
                                                             float glideTime)
 {
@@ -322,17 +333,23 @@ SequencerPattern Bass808GlideGenerator::generateSubBass(int numSteps, int rootNo
 
 InstrumentSequencer::InstrumentSequencer()
     : currentBPM(120.0)
+    , instrumentType(InstrumentType::Unknown)
     , playing(false)
+    , restartPending(false)
+    , stopPending(false)
     , currentStep(0)
+    , blockStartSample(0)
     , samplePosition(0.0)
     , samplesPerStep(0.0)
-    , instrumentType(InstrumentType::Unknown)
+    , numPendingNotes(0)
     , currentPitchBend(0.0f)
     , targetPitchBend(0.0f)
     , pitchBendSmoothingFactor(0.995f)
+    , lastSentPitchBend(8192)
 {
     currentPattern.numSteps = 16;
     currentPattern.steps.resize(64);
+    publishPattern();
     
     Logger::log(Logger::Level::Info, "InstrumentSequencer initialized");
 }
@@ -346,6 +363,7 @@ void InstrumentSequencer::setPattern(const SequencerPattern& pattern)
     const juce::ScopedLock sl(sequencerLock);
     currentPattern = pattern;
     instrumentType = pattern.instrumentType;
+    publishPattern();
 }
 
 void InstrumentSequencer::setStep(int stepIndex, const SequencerStep& step)
@@ -355,6 +373,7 @@ void InstrumentSequencer::setStep(int stepIndex, const SequencerStep& step)
     if (stepIndex >= 0 && stepIndex < static_cast<int>(currentPattern.steps.size()))
     {
         currentPattern.steps[stepIndex] = step;
+        publishPattern();
     }
 }
 
@@ -374,6 +393,7 @@ void InstrumentSequencer::toggleStep(int stepIndex)
     if (stepIndex >= 0 && stepIndex < static_cast<int>(currentPattern.steps.size()))
     {
         currentPattern.steps[stepIndex].active = !currentPattern.steps[stepIndex].active;
+        publishPattern();
     }
 }
 
@@ -385,70 +405,111 @@ void InstrumentSequencer::clearPattern()
     {
         step.active = false;
     }
+    
+    publishPattern();
 }
 
 void InstrumentSequencer::setBPM(double bpm)
 {
     const juce::ScopedLock sl(sequencerLock);
     currentBPM = clamp(bpm, 20.0, 300.0);
+    publishPattern();
 }
 
-void InstrumentSequencer::start()
+void InstrumentSequencer::publishPattern()
 {
     const juce::ScopedLock sl(sequencerLock);
-    playing = true;
-    currentStep = 0;
-    samplePosition = 0.0;
+    
+    PlaybackPattern playback;
+    playback.numSteps = juce::jlimit(1, PlaybackPattern::MAX_STEPS,
+                                     juce::jmin(currentPattern.numSteps, static_cast<int>(currentPattern.steps.size())));
+    playback.stepsPerBeat = juce::jmax(1, currentPattern.stepsPerBeat);
+    playback.bpm = currentBPM;
+    
+    for (int i = 0; i < playback.numSteps; ++i)
+    {
+        const auto& step = currentPattern.steps[static_cast<size_t>(i)];
+        playback.steps[static_cast<size_t>(i)] = { step.active, step.noteNumber, step.velocity, step.pitchBend,
+                                                   step.slideAmount, step.probability, step.retrigger };
+    }
+    
+    playbackPattern.publish(playback);
+}
+
+void InstrumentSequencer::start()
+{
+    // The audio thread rewinds to the first step at its next block
+    restartPending.store(true);
+    playing.store(true);
 }
 
 void InstrumentSequencer::stop()
 {
-    const juce::ScopedLock sl(sequencerLock);
-    playing = false;
-    currentStep = 0;
-    samplePosition = 0.0;
+    // The audio thread releases the notes still sounding at its next block
+    stopPending.store(true);
+    playing.store(false);
+    restartPending.store(true);
+    currentStep.store(0);
 }
 
 void InstrumentSequencer::processBlock(juce::MidiBuffer& midiBuffer, int numSamples, 
                                         double sampleRate)
 {
-    if (!playing)
+    if (stopPending.exchange(false))
+        releaseAllNotes(midiBuffer);
+    
+    if (!playing.load())
         return;
     
-    const juce::ScopedLock sl(sequencerLock);
+    if (restartPending.exchange(false))
+    {
+        // Events queued by the previous run must not fire into this one
+        releaseAllNotes(midiBuffer);
+        currentStep.store(0, std::memory_order_relaxed);
+        samplePosition = 0.0;
+    }
+    
+    playbackPattern.acquireLatest();
+    const auto& pattern = playbackPattern.getAcquired();
     
     // Calculate samples per step
-    double stepDuration = currentPattern.getStepDuration(currentBPM);
-    samplesPerStep = stepDuration * sampleRate;
+    samplesPerStep = 60.0 / (pattern.bpm * pattern.stepsPerBeat) * sampleRate;
     
-    for (int sample = 0; sample < numSamples; ++sample)
+    int step = currentStep.load(std::memory_order_relaxed) % pattern.numSteps;
+    int sample = 0;
+    
+    // Visit only the samples where a step begins; samplePosition counts
+    // samples since the current step began
+    while (sample < numSamples)
     {
-        // Check if we've reached the next step
         if (samplePosition >= samplesPerStep)
         {
             samplePosition -= samplesPerStep;
-            currentStep = (currentStep + 1) % currentPattern.numSteps;
+            step = (step + 1) % pattern.numSteps;
         }
         
         // Trigger step at the beginning
         if (samplePosition < 1.0)
         {
-            const auto& step = currentPattern.steps[currentStep];
-            if (step.active)
-            {
-                // Check probability
-                if (random.nextFloat() <= step.probability)
-                {
-                    triggerStep(currentStep, midiBuffer, sample);
-                }
-            }
+            const auto& stepData = pattern.steps[static_cast<size_t>(step)];
+            if (stepData.active && playbackRandom.nextFloat() <= stepData.probability)
+                triggerStep(stepData, blockStartSample + sample);
         }
         
+        const int untilNextStep = juce::jmax(1, static_cast<int>(std::ceil(samplesPerStep - samplePosition)));
+        const int advance = juce::jmin(untilNextStep, numSamples - sample);
+        
         // Update pitch bend smoothing
-        updatePitchBend(midiBuffer, sample);
+        updatePitchBend(midiBuffer, sample, sample + advance, sampleRate);
         
-        samplePosition += 1.0;
+        samplePosition += advance;
+        sample += advance;
     }
+    
+    flushPendingNotes(midiBuffer, numSamples);
+    
+    currentStep.store(step, std::memory_order_relaxed);
+    blockStartSample += numSamples;
 }
 
 void InstrumentSequencer::setInstrumentType(InstrumentType type)
@@ -531,6 +592,7 @@ bool InstrumentSequencer::loadPatternFromJSON(const juce::var& json)
         }
     }
     
+    publishPattern();
     return true;
 }
 
@@ -583,6 +645,8 @@ void InstrumentSequencer::humanize(float velocityVariation, float timingVariatio
             step.probability = clamp(step.probability + probDelta, 0.5f, 1.0f);
         }
     }
+    
+    publishPattern();
 }
 
 void InstrumentSequencer::shiftPattern(int steps)
@@ -605,6 +669,8 @@ void InstrumentSequencer::shiftPattern(int steps)
     {
         currentPattern.steps[i] = temp[i];
     }
+    
+    publishPattern();
 }
 
 void InstrumentSequencer::reversePattern()
@@ -616,6 +682,8 @@ void InstrumentSequencer::reversePattern()
         int j = currentPattern.numSteps - 1 - i;
         std::swap(currentPattern.steps[i], currentPattern.steps[j]);
     }
+    
+    publishPattern();
 }
 
 void InstrumentSequencer::doublePattern()
@@ -633,6 +701,8 @@ void InstrumentSequencer::doublePattern()
     {
         currentPattern.steps[i] = currentPattern.steps[i - originalLength];
     }
+    
+    publishPattern();
 }
 
 void InstrumentSequencer::halvePattern()
@@ -642,69 +712,115 @@ void InstrumentSequencer::halvePattern()
     if (currentPattern.numSteps > 4)
     {
         currentPattern.numSteps /= 2;
+        publishPattern();
     }
 }
 
-void InstrumentSequencer::triggerStep(int step, juce::MidiBuffer& midiBuffer, int sampleOffset)
+void InstrumentSequencer::triggerStep(const PlaybackPattern::Step& step, juce::int64 startSample)
 {
-    const auto& stepData = currentPattern.steps[step];
-    
-    int channel = 1;
-    int noteNumber = stepData.noteNumber;
-    float velocity = stepData.velocity;
-    
     // Handle retriggers
-    int numTriggers = stepData.retrigger;
-    if (numTriggers < 1) numTriggers = 1;
-    if (numTriggers > 8) numTriggers = 8;
-    
-    double samplesPerRetrigger = samplesPerStep / numTriggers;
+    const int numTriggers = clamp(step.retrigger, 1, 8);
+    const double samplesPerRetrigger = samplesPerStep / numTriggers;
     
     for (int t = 0; t < numTriggers; ++t)
     {
-        int triggerOffset = sampleOffset + static_cast<int>(t * samplesPerRetrigger);
+        const auto triggerTime = startSample + static_cast<juce::int64>(t * samplesPerRetrigger);
         
         // Decrease velocity for retriggers
-        float triggerVelocity = velocity * (1.0f - 0.1f * t);
+        float triggerVelocity = step.velocity * (1.0f - 0.1f * t);
         int midiVelocity = static_cast<int>(triggerVelocity * 127);
         midiVelocity = clamp(midiVelocity, 1, 127);
         
-        midiBuffer.addEvent(
-            juce::MidiMessage::noteOn(channel, noteNumber, static_cast<juce::uint8>(midiVelocity)),
-            triggerOffset
-        );
+        queueNote(triggerTime, step.noteNumber, midiVelocity);
         
         // Note off after short duration
-        int noteOffOffset = triggerOffset + static_cast<int>(samplesPerRetrigger * 0.8);
-        midiBuffer.addEvent(
-            juce::MidiMessage::noteOff(channel, noteNumber),
-            noteOffOffset
-        );
+        queueNote(triggerTime + static_cast<juce::int64>(samplesPerRetrigger * 0.8), step.noteNumber, 0);
     }
     
     // Set target pitch bend for glide
-    if (stepData.slideAmount > 0.0f)
+    if (step.slideAmount > 0.0f)
     {
-        targetPitchBend = stepData.pitchBend;
+        targetPitchBend = step.pitchBend;
     }
 }
 
-void InstrumentSequencer::updatePitchBend(juce::MidiBuffer& midiBuffer, int sampleOffset)
+void InstrumentSequencer::queueNote(juce::int64 time, int noteNumber, int velocity)
 {
-    // Smooth pitch bend
-    currentPitchBend = currentPitchBend * pitchBendSmoothingFactor + 
-                       targetPitchBend * (1.0f - pitchBendSmoothingFactor);
+    // A full queue means notes far denser than any pattern produces
+    jassert(numPendingNotes < MAX_PENDING_NOTES);
+    if (numPendingNotes < MAX_PENDING_NOTES)
+        pendingNotes[static_cast<size_t>(numPendingNotes++)] = { time, noteNumber, velocity };
+}
+
+void InstrumentSequencer::releaseAllNotes(juce::MidiBuffer& midiBuffer)
+{
+    for (int i = 0; i < numPendingNotes; ++i)
+    {
+        const auto& note = pendingNotes[static_cast<size_t>(i)];
+        if (note.velocity == 0)
+            midiBuffer.addEvent(juce::MidiMessage::noteOff(1, note.noteNumber), 0);
+    }
+    
+    numPendingNotes = 0;
     
-    // Convert to MIDI pitch bend
-    int bendValue = static_cast<int>((currentPitchBend + 1.0f) * 8192.0f);
-    bendValue = clamp(bendValue, 0, 16383);
+    currentPitchBend = 0.0f;
+    targetPitchBend = 0.0f;
+    if (lastSentPitchBend != 8192)
+    {
+        midiBuffer.addEvent(juce::MidiMessage::pitchWheel(1, 8192), 0);
+        lastSentPitchBend = 8192;
+    }
+}
+
+void InstrumentSequencer::flushPendingNotes(juce::MidiBuffer& midiBuffer, int numSamples)
+{
+    const juce::int64 blockEnd = blockStartSample + numSamples;
+    int kept = 0;
     
-    if (bendValue != 8192) // Only send if not centered
+    for (int i = 0; i < numPendingNotes; ++i)
     {
-        midiBuffer.addEvent(
-            juce::MidiMessage::pitchWheel(1, bendValue),
-            sampleOffset
-        );
+        const auto& note = pendingNotes[static_cast<size_t>(i)];
+        
+        if (note.time >= blockEnd)
+        {
+            pendingNotes[static_cast<size_t>(kept++)] = note;
+            continue;
+        }
+        
+        const int offset = static_cast<int>(juce::jmax<juce::int64>(0, note.time - blockStartSample));
+        if (note.velocity > 0)
+            midiBuffer.addEvent(juce::MidiMessage::noteOn(1, note.noteNumber, static_cast<juce::uint8>(note.velocity)), offset);
+        else
+            midiBuffer.addEvent(juce::MidiMessage::noteOff(1, note.noteNumber), offset);
+    }
+    
+    numPendingNotes = kept;
+}
+
+void InstrumentSequencer::updatePitchBend(juce::MidiBuffer& midiBuffer, int startSample, int endSample, double sampleRate)
+{
+    const auto interval = static_cast<juce::int64>(juce::jmax(1, juce::roundToInt(sampleRate * PITCH_BEND_INTERVAL_SECONDS)));
+    const float smoothingPerUpdate = std::pow(pitchBendSmoothingFactor, static_cast<float>(interval));
+    
+    // Control-rate updates fall on whole multiples of the interval
+    const juce::int64 start = blockStartSample + startSample;
+    juce::int64 update = ((start + interval - 1) / interval) * interval;
+    
+    for (; update < blockStartSample + endSample; update += interval)
+    {
+        // Smooth pitch bend
+        currentPitchBend = targetPitchBend + (currentPitchBend - targetPitchBend) * smoothingPerUpdate;
+        
+        // Convert to MIDI pitch bend
+        int bendValue = static_cast<int>((currentPitchBend + 1.0f) * 8192.0f);
+        bendValue = clamp(bendValue, 0, 16383);
+        
+        // Only send changes, including the return to centre
+        if (bendValue != lastSentPitchBend)
+        {
+            midiBuffer.addEvent(juce::MidiMessage::pitchWheel(1, bendValue), static_cast<int>(update - blockStartSample));
+            lastSentPitchBend = bendValue;
+        }
     }
 }
 
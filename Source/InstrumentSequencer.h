@@ -10,10 +10,13 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <array>
 #include "Utilities.h"
+#include "ParameterSnapshot.h"
+#include "PitchTracker.h"
 
 namespace MAEVN
 {
@@ -82,6 +85,34 @@ struct SequencerPattern
     }
 };
 
+//==============================================================================
+/**
+ * @brief What the audio thread needs of a pattern, as a plain value
+ *
+ * Published to the audio thread whenever the pattern or tempo is edited,
+ * so playback never takes the sequencer's lock.
+ */
+struct PlaybackPattern
+{
+    static constexpr int MAX_STEPS = 64;
+    
+    struct Step
+    {
+        bool active = false;
+        int noteNumber = 60;
+        float velocity = 0.8f;
+        float pitchBend = 0.0f;
+        float slideAmount = 0.0f;
+        float probability = 1.0f;
+        int retrigger = 1;
+    };
+    
+    std::array<Step, MAX_STEPS> steps {};
+    int numSteps = 16;
+    int stepsPerBeat = 4;
+    double bpm = 120.0;
+};
+
 //==============================================================================
 /**
  * @brief Hi-hat roll pattern generator
@@ -181,8 +212,22 @@ public:
     SequencerPattern generateSubBass(int numSteps, int rootNote, 
                                      const juce::String& octaveDropPattern);
     
+    /**
+     * @brief Follow the key of an analysed input (nullptr for none)
+     * @param tracker Shared pitch tracker owned by the processor
+     */
+    void setPitchSource(const PitchTracker* tracker) { pitchSource = tracker; }
+    
+    /**
+     * @brief Root note matching the tracked input, for the generators above
+     * @param fallbackNote Note returned when there is no source or no pitch
+     * @return The nearest tracked note moved into the 808 octave (C1 to B1)
+     */
+    int getTrackedRootNote(int fallbackNote) const;
+    
 private:
     juce::Random random;
+    const PitchTracker* pitchSource;
 };
 
 //==============================================================================
@@ -208,9 +253,16 @@ public:
     
     /**
      * @brief Get modifiable pattern reference
+     *
+     * Edits made through it are heard after the next publishPattern().
      */
     SequencerPattern& getPatternRef() { return currentPattern; }
     
+    /**
+     * @brief Hand the current pattern and tempo to the audio thread
+     */
+    void publishPattern();
+    
     /**
      * @brief Set step data
      * @param stepIndex Index of the step (0-based)
@@ -260,10 +312,16 @@ public:
     /**
      * @brief Check if playing
      */
-    bool isPlaying() const { return playing; }
+    bool isPlaying() const { return playing.load(); }
     
     /**
      * @brief Process a block of samples
+     *
+     * Lock-free. Step boundaries are found analytically, so the cost follows
+     * the number of notes and pitch-bend updates rather than the number of
+     * samples; every note, retrigger and note-off lands on its exact sample,
+     * in a later block if it falls past this one.
+     *
      * @param midiBuffer MIDI buffer to fill with events
      * @param numSamples Number of samples in the block
      * @param sampleRate Current sample rate
@@ -273,7 +331,7 @@ public:
     /**
      * @brief Get current step position
      */
-    int getCurrentStep() const { return currentStep; }
+    int getCurrentStep() const { return currentStep.load(std::memory_order_relaxed); }
     
     /**
      * @brief Set instrument type
@@ -345,12 +403,22 @@ public:
     void halvePattern();
     
 private:
+    /** Pitch bend is smoothed and sent once per this many seconds */
+    static constexpr double PITCH_BEND_INTERVAL_SECONDS = 0.001;
+    
+    /** Notes and note-offs waiting for a later sample (retriggers span blocks) */
+    static constexpr int MAX_PENDING_NOTES = 64;
+    
+    struct PendingNote
+    {
+        juce::int64 time;      // absolute sample
+        int noteNumber;
+        int velocity;          // 0 for note-off
+    };
+    
+    // Editing side, guarded by sequencerLock
     SequencerPattern currentPattern;
     double currentBPM;
-    bool playing;
-    int currentStep;
-    double samplePosition;
-    double samplesPerStep;
     InstrumentType instrumentType;
     
     HiHatRollGenerator hiHatGenerator;
@@ -359,20 +427,52 @@ private:
     juce::Random random;
     juce::CriticalSection sequencerLock;
     
+    // Handoff to the audio thread
+    ParameterSnapshot<PlaybackPattern> playbackPattern;
+    std::atomic<bool> playing;
+    std::atomic<bool> restartPending;
+    std::atomic<bool> stopPending;      // queued notes still need releasing
+    std::atomic<int> currentStep;
+    
+    // Audio thread only
+    juce::Random playbackRandom;
+    juce::int64 blockStartSample;
+    double samplePosition;
+    double samplesPerStep;
+    std::array<PendingNote, MAX_PENDING_NOTES> pendingNotes;
+    int numPendingNotes;
+    
     // For pitch glide processing
     float currentPitchBend;
     float targetPitchBend;
-    float pitchBendSmoothingFactor;
+    float pitchBendSmoothingFactor;   // per sample
+    int lastSentPitchBend;
+    
+    /**
+     * @brief Trigger a step: queue its notes from the given absolute sample
+     */
+    void triggerStep(const PlaybackPattern::Step& step, juce::int64 startSample);
+    
+    /**
+     * @brief Queue one note event (audio thread)
+     */
+    void queueNote(juce::int64 time, int noteNumber, int velocity);
+    
+    /**
+     * @brief Send every queued note-off at the start of the block, drop the
+     *        rest of the queue and centre the pitch wheel
+     */
+    void releaseAllNotes(juce::MidiBuffer& midiBuffer);
     
     /**
-     * @brief Trigger a step
+     * @brief Emit every queued note due before the end of this block, in order
      */
-    void triggerStep(int step, juce::MidiBuffer& midiBuffer, int sampleOffset);
+    void flushPendingNotes(juce::MidiBuffer& midiBuffer, int numSamples);
     
     /**
-     * @brief Update pitch bend smoothing
+     * @brief Smooth and send pitch bend at the control rate over [startSample, endSample) of the block
      */
-    void updatePitchBend(juce::MidiBuffer& midiBuffer, int sampleOffset);
+    void updatePitchBend(juce::MidiBuffer& midiBuffer, int startSample, int endSample, double sampleRate);
     
     /**
      * @brief Calculate sample position for step
@@ -4,6 +4,7 @@
  */
 
 #include "LegendaryProducerFXSuiteUltimate.h"
+#include "StateChunk.h"
 
 namespace MAEVN
 {
@@ -42,6 +43,7 @@ LegendaryProducerFXSuiteUltimateAudioProcessor::LegendaryProducerFXSuiteUltimate
     stereoWidener.prepare(defaultSpec);
     limiter.prepare(defaultSpec);
     pthVocalClone.prepare(defaultSpec);
+    pthVocalClone.setPitchSource(&pitchTracker);
     epicSpaceReverb.prepare(defaultSpec);
 
     Logger::log(Logger::Level::Info, "LegendaryProducerFXSuiteUltimate initialized");
@@ -75,7 +77,7 @@ bool LegendaryProducerFXSuiteUltimateAudioProcessor::isMidiEffect() const
 double LegendaryProducerFXSuiteUltimateAudioProcessor::getTailLengthSeconds() const
 {
     // Account for reverb tail
-    return 5.0;
+    return epicSpaceReverbEnabled ? epicSpaceReverb.getTailLengthSeconds() : 0.0;
 }
 
 int LegendaryProducerFXSuiteUltimateAudioProcessor::getNumPrograms()
@@ -124,6 +126,10 @@ void LegendaryProducerFXSuiteUltimateAudioProcessor::prepareToPlay(double sample
     limiter.prepare(spec);
     pthVocalClone.prepare(spec);
     epicSpaceReverb.prepare(spec);
+    pitchTracker.prepare(sampleRate, samplesPerBlock, getTotalNumInputChannels());
+    outputLoudness.prepare(sampleRate, getTotalNumOutputChannels());
+    
+    updateHostLatency();
     
     Logger::log(Logger::Level::Info, 
         "LegendaryProducerFXSuiteUltimate prepared: " + juce::String(sampleRate) + " Hz, " 
@@ -140,6 +146,7 @@ void LegendaryProducerFXSuiteUltimateAudioProcessor::releaseResources()
     limiter.reset();
     pthVocalClone.reset();
     epicSpaceReverb.reset();
+    pitchTracker.release();
 }
 
 bool LegendaryProducerFXSuiteUltimateAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
@@ -167,16 +174,19 @@ void LegendaryProducerFXSuiteUltimateAudioProcessor::processBlock(juce::AudioBuf
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
     
-    // Measure input level
-    inputLevel.store(calculateRMSLevel(buffer));
+    // Measure the input
+    MeterBlock meters;
+    meters.numSamples = buffer.getNumSamples();
+    meters.sampleRate = currentSampleRate;
+    meters.measureInput(buffer, meters.numSamples);
     
-    // Estimate pitch (for metering)
-    currentPitch.store(estimatePitch(buffer));
+    // Queue the input for pitch analysis (metering and the vocal clone)
+    pitchTracker.pushSamples(buffer, buffer.getNumSamples());
     
     // A/B Comparison - if enabled and showing original, skip processing
     if (abComparisonEnabled && !abComparisonShowProcessed)
     {
-        outputLevel.store(calculateRMSLevel(buffer));
+        publishMeters(meters, buffer, false);
         return;
     }
     
@@ -242,7 +252,7 @@ void LegendaryProducerFXSuiteUltimateAudioProcessor::processBlock(juce::AudioBuf
     }
     
     // Measure output level
-    outputLevel.store(calculateRMSLevel(buffer));
+    publishMeters(meters, buffer, true);
 }
 
 //==============================================================================
@@ -259,24 +269,50 @@ juce::AudioProcessorEditor* LegendaryProducerFXSuiteUltimateAudioProcessor::crea
 //==============================================================================
 void LegendaryProducerFXSuiteUltimateAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    auto* obj = new juce::DynamicObject();
+    StateChunkWriter writer;
     
-    // Save enable states
-    obj->setProperty("multibandCompressorEnabled", multibandCompressorEnabled);
-    obj->setProperty("transientShaperEnabled", transientShaperEnabled);
-    obj->setProperty("deEsserEnabled", deEsserEnabled);
-    obj->setProperty("saturationEnabled", saturationEnabled);
-    obj->setProperty("stereoWidenerEnabled", stereoWidenerEnabled);
-    obj->setProperty("limiterEnabled", limiterEnabled);
-    obj->setProperty("pthVocalCloneEnabled", pthVocalCloneEnabled);
-    obj->setProperty("epicSpaceReverbEnabled", epicSpaceReverbEnabled);
+    {
+        // Enable states, in the order of the chain
+        juce::MemoryOutputStream fx(writer.addSection(StateSection::FXChains, 1), false);
+        fx.writeBool(multibandCompressorEnabled);
+        fx.writeBool(transientShaperEnabled);
+        fx.writeBool(deEsserEnabled);
+        fx.writeBool(saturationEnabled);
+        fx.writeBool(stereoWidenerEnabled);
+        fx.writeBool(limiterEnabled);
+        fx.writeBool(pthVocalCloneEnabled);
+        fx.writeBool(epicSpaceReverbEnabled);
+    }
     
-    juce::var state(obj);
-    juce::String stateString = juce::JSON::toString(state);
-    destData.append(stateString.toRawUTF8(), stateString.getNumBytesAsUTF8());
+    writer.writeTo(destData);
 }
 
 void LegendaryProducerFXSuiteUltimateAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
+{
+    if (!StateChunkReader::isStateChunk(data, static_cast<size_t>(sizeInBytes)))
+    {
+        setLegacyJSONState(data, sizeInBytes);
+        return;
+    }
+    
+    StateChunkReader reader(data, static_cast<size_t>(sizeInBytes));
+    
+    if (auto fx = reader.createSectionStream(StateSection::FXChains))
+    {
+        multibandCompressorEnabled = fx->readBool();
+        transientShaperEnabled = fx->readBool();
+        deEsserEnabled = fx->readBool();
+        saturationEnabled = fx->readBool();
+        stereoWidenerEnabled = fx->readBool();
+        limiterEnabled = fx->readBool();
+        pthVocalCloneEnabled = fx->readBool();
+        epicSpaceReverbEnabled = fx->readBool();
+        
+        updateHostLatency();
+    }
+}
+
+void LegendaryProducerFXSuiteUltimateAudioProcessor::setLegacyJSONState(const void* data, int sizeInBytes)
 {
     juce::String stateString = juce::String::createStringFromData(data, sizeInBytes);
     juce::var state = juce::JSON::parse(stateString);
@@ -301,6 +337,8 @@ void LegendaryProducerFXSuiteUltimateAudioProcessor::setStateInformation(const v
             pthVocalCloneEnabled = obj->getProperty("pthVocalCloneEnabled");
         if (obj->hasProperty("epicSpaceReverbEnabled"))
             epicSpaceReverbEnabled = obj->getProperty("epicSpaceReverbEnabled");
+        
+        updateHostLatency();
     }
 }
 
@@ -348,6 +386,8 @@ void LegendaryProducerFXSuiteUltimateAudioProcessor::loadPreset(const juce::Stri
             if (obj->hasProperty("epicSpaceReverbEnabled"))
                 epicSpaceReverbEnabled = obj->getProperty("epicSpaceReverbEnabled");
             
+            updateHostLatency();
+            
             Logger::log(Logger::Level::Info, "Preset loaded: " + name);
         }
     }
@@ -364,50 +404,24 @@ juce::StringArray LegendaryProducerFXSuiteUltimateAudioProcessor::getPresetNames
 }
 
 //==============================================================================
-float LegendaryProducerFXSuiteUltimateAudioProcessor::calculateRMSLevel(const juce::AudioBuffer<float>& buffer)
+void LegendaryProducerFXSuiteUltimateAudioProcessor::publishMeters(MeterBlock& meters,
+                                                                   const juce::AudioBuffer<float>& buffer,
+                                                                   bool processed)
 {
-    float sumSquares = 0.0f;
-    int numSamples = buffer.getNumSamples();
-    int numChannels = buffer.getNumChannels();
+    meters.measureOutput(buffer, meters.numSamples);
     
-    for (int ch = 0; ch < numChannels; ++ch)
-    {
-        const float* data = buffer.getReadPointer(ch);
-        for (int i = 0; i < numSamples; ++i)
-        {
-            sumSquares += data[i] * data[i];
-        }
-    }
+    outputLoudness.process(buffer, meters.numSamples);
+    meters.momentaryLUFS = outputLoudness.getMomentaryLUFS();
+    meters.pitchHz = pitchTracker.getFrequency();
     
-    return std::sqrt(sumSquares / static_cast<float>(numSamples * numChannels));
-}
-
-float LegendaryProducerFXSuiteUltimateAudioProcessor::estimatePitch(const juce::AudioBuffer<float>& buffer)
-{
-    // Simplified pitch estimation using zero-crossing rate
-    // A full implementation would use autocorrelation or FFT
-    
-    int numSamples = buffer.getNumSamples();
-    if (numSamples < 2)
-        return 0.0f;
-    
-    const float* data = buffer.getReadPointer(0);
-    int zeroCrossings = 0;
-    
-    for (int i = 1; i < numSamples; ++i)
+    if (processed)
     {
-        if ((data[i - 1] >= 0.0f && data[i] < 0.0f) ||
-            (data[i - 1] < 0.0f && data[i] >= 0.0f))
-        {
-            zeroCrossings++;
-        }
+        meters.gainReductionDB[CompressorStage] = multibandCompressorEnabled ? multibandCompressor.getGainReductionDB() : 0.0f;
+        meters.gainReductionDB[DeEsserStage] = deEsserEnabled ? deEsser.getGainReductionDB() : 0.0f;
+        meters.gainReductionDB[LimiterStage] = limiterEnabled ? limiter.getGainReductionDB() : 0.0f;
     }
     
-    // Estimate frequency from zero-crossing rate
-    float estimatedFreq = static_cast<float>(zeroCrossings) * static_cast<float>(currentSampleRate) 
-                          / (2.0f * static_cast<float>(numSamples));
-    
-    return estimatedFreq;
+    meterQueue.push(meters);
 }
 
 //==============================================================================
@@ -455,6 +469,12 @@ LegendaryProducerFXSuiteUltimateAudioProcessorEditor::LegendaryProducerFXSuiteUl
     addAndMakeVisible(outputLevelLabel);
     outputLevelLabel.setText("Output: 0 dB", juce::dontSendNotification);
     
+    addAndMakeVisible(loudnessLabel);
+    loudnessLabel.setText("-- LUFS", juce::dontSendNotification);
+    
+    addAndMakeVisible(gainReductionLabel);
+    gainReductionLabel.setText("GR: 0 dB", juce::dontSendNotification);
+    
     // Start meter update timer
     startTimerHz(METER_UPDATE_RATE_HZ);
     
@@ -489,6 +509,8 @@ void LegendaryProducerFXSuiteUltimateAudioProcessorEditor::resized()
     // A/B button and metering at top right
     auto topArea = bounds.removeFromTop(30);
     abCompareButton.setBounds(topArea.removeFromRight(100).reduced(5));
+    gainReductionLabel.setBounds(topArea.removeFromRight(100).reduced(5));
+    loudnessLabel.setBounds(topArea.removeFromRight(100).reduced(5));
     outputLevelLabel.setBounds(topArea.removeFromRight(120).reduced(5));
     inputLevelLabel.setBounds(topArea.removeFromRight(120).reduced(5));
     
@@ -744,11 +766,20 @@ void LegendaryProducerFXSuiteUltimateAudioProcessorEditor::setupReverbTab()
 
 void LegendaryProducerFXSuiteUltimateAudioProcessorEditor::updateMeterDisplay()
 {
-    float inputdB = 20.0f * std::log10(audioProcessor.getInputLevel() + 0.0001f);
-    float outputdB = 20.0f * std::log10(audioProcessor.getOutputLevel() + 0.0001f);
+    // Everything the audio thread measured since the last tick, in order
+    audioProcessor.getMeterQueue().popAll([this](const MeterBlock& block) { meterBallistics.process(block); });
+    
+    float gainReduction = 0.0f;
+    for (int stage = 0; stage < MeterBlock::MAX_STAGES; ++stage)
+        gainReduction = juce::jmin(gainReduction, meterBallistics.getGainReductionDB(stage));
+    
+    const float lufs = meterBallistics.getMomentaryLUFS();
     
-    inputLevelLabel.setText("Input: " + juce::String(inputdB, 1) + " dB", juce::dontSendNotification);
-    outputLevelLabel.setText("Output: " + juce::String(outputdB, 1) + " dB", juce::dontSendNotification);
+    inputLevelLabel.setText("Input: " + juce::String(meterBallistics.getInputRMSDB(), 1) + " dB", juce::dontSendNotification);
+    outputLevelLabel.setText("Output: " + juce::String(meterBallistics.getOutputRMSDB(), 1) + " dB", juce::dontSendNotification);
+    loudnessLabel.setText(lufs > LoudnessMeter::MINIMUM_LUFS ? juce::String(lufs, 1) + " LUFS" : juce::String("-- LUFS"),
+                          juce::dontSendNotification);
+    gainReductionLabel.setText("GR: " + juce::String(gainReduction, 1) + " dB", juce::dontSendNotification);
 }
 
 } // namespace MAEVN
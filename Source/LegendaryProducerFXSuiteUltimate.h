@@ -12,6 +12,9 @@
 
 #include <JuceHeader.h>
 #include "DSPModules.h"
+#include "PitchTracker.h"
+#include "LoudnessMeter.h"
+#include "Metering.h"
 #include "Utilities.h"
 
 namespace MAEVN
@@ -75,22 +78,36 @@ public:
     void setDeEsserEnabled(bool enabled) { deEsserEnabled = enabled; }
     bool isDeEsserEnabled() const { return deEsserEnabled; }
     
-    void setSaturationEnabled(bool enabled) { saturationEnabled = enabled; }
+    void setSaturationEnabled(bool enabled) { saturationEnabled = enabled; updateHostLatency(); }
     bool isSaturationEnabled() const { return saturationEnabled; }
     
+    /** 1x, 2x or 4x saturation oversampling (changes the reported latency) */
+    void setSaturationOversampling(int factor) { saturation.setOversamplingFactor(factor); updateHostLatency(); }
+    
     void setStereoWidenerEnabled(bool enabled) { stereoWidenerEnabled = enabled; }
     bool isStereoWidenerEnabled() const { return stereoWidenerEnabled; }
     
-    void setLimiterEnabled(bool enabled) { limiterEnabled = enabled; }
+    void setLimiterEnabled(bool enabled) { limiterEnabled = enabled; updateHostLatency(); }
     bool isLimiterEnabled() const { return limiterEnabled; }
     
     // PTH Vocal Clone Tab
-    void setPTHVocalCloneEnabled(bool enabled) { pthVocalCloneEnabled = enabled; }
+    void setPTHVocalCloneEnabled(bool enabled) { pthVocalCloneEnabled = enabled; updateHostLatency(); }
     bool isPTHVocalCloneEnabled() const { return pthVocalCloneEnabled; }
     
     // Epic Space Reverb Tab
     void setEpicSpaceReverbEnabled(bool enabled) { epicSpaceReverbEnabled = enabled; }
     bool isEpicSpaceReverbEnabled() const { return epicSpaceReverbEnabled; }
+    
+    /**
+     * @brief Report the saturation oversampling, vocal clone frame and limiter
+     *        lookahead delays to the host
+     */
+    void updateHostLatency()
+    {
+        setLatencySamples((saturationEnabled ? saturation.getLatencySamples() : 0)
+                          + (pthVocalCloneEnabled ? pthVocalClone.getLatencySamples() : 0)
+                          + (limiterEnabled ? limiter.getLatencySamples() : 0));
+    }
 
     //==============================================================================
     // Direct access to DSP modules for parameter control
@@ -104,6 +121,11 @@ public:
     dspmodules::Limiter& getLimiter() { return limiter; }
     dspmodules::PTHVocalClone& getPTHVocalClone() { return pthVocalClone; }
     dspmodules::EpicSpaceReverb& getEpicSpaceReverb() { return epicSpaceReverb; }
+    
+    /**
+     * @brief Pitch of the input, analysed once for the meter and the vocal clone
+     */
+    const PitchTracker& getPitchTracker() const { return pitchTracker; }
 
     //==============================================================================
     // A/B Comparison
@@ -126,9 +148,20 @@ public:
     // Metering
     //==============================================================================
     
-    float getInputLevel() const { return inputLevel; }
-    float getOutputLevel() const { return outputLevel; }
-    float getCurrentPitch() const { return currentPitch; }
+    /** Gain reduction slots of each MeterBlock */
+    enum MeterStage
+    {
+        CompressorStage = 0,
+        DeEsserStage,
+        LimiterStage
+    };
+    
+    /**
+     * @brief Per-block meter summaries, drained by the editor's timer
+     */
+    MeterQueue& getMeterQueue() { return meterQueue; }
+    
+    float getCurrentPitch() const { return pitchTracker.getFrequency(); }
 
 private:
     //==============================================================================
@@ -139,6 +172,7 @@ private:
     dspmodules::StereoWidener stereoWidener;
     dspmodules::Limiter limiter;
 
+    PitchTracker pitchTracker;
     dspmodules::PTHVocalClone pthVocalClone;
     dspmodules::EpicSpaceReverb epicSpaceReverb;
 
@@ -157,9 +191,8 @@ private:
     bool abComparisonShowProcessed;
 
     // Metering
-    std::atomic<float> inputLevel{0.0f};
-    std::atomic<float> outputLevel{0.0f};
-    std::atomic<float> currentPitch{0.0f};
+    MeterQueue meterQueue;
+    LoudnessMeter outputLoudness;
 
     // Processing state
     double currentSampleRate;
@@ -170,14 +203,15 @@ private:
 
     //==============================================================================
     /**
-     * @brief Calculate RMS level of buffer
+     * @brief Measure the output, add the stage readings and queue the block for the editor
+     * @param processed False when the chain was bypassed (no gain reduction)
      */
-    float calculateRMSLevel(const juce::AudioBuffer<float>& buffer);
+    void publishMeters(MeterBlock& meters, const juce::AudioBuffer<float>& buffer, bool processed);
 
     /**
-     * @brief Estimate pitch from buffer (simplified)
+     * @brief Restore a state saved as JSON by earlier versions
      */
-    float estimatePitch(const juce::AudioBuffer<float>& buffer);
+    void setLegacyJSONState(const void* data, int sizeInBytes);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LegendaryProducerFXSuiteUltimateAudioProcessor)
 };
@@ -244,8 +278,11 @@ private:
     juce::TextButton abCompareButton{"A/B"};
 
     // Metering
+    MeterBallistics meterBallistics;
     juce::Label inputLevelLabel;
     juce::Label outputLevelLabel;
+    juce::Label loudnessLabel;
+    juce::Label gainReductionLabel;
 
     void setupVocalFXTab();
     void setupPTHTab();
@@ -0,0 +1,454 @@
+/**
+ * @file Logger.cpp
+ * @brief Background writer behind the Logger
+ */
+
+#include "Logger.h"
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace MAEVN
+{
+
+namespace
+{
+    constexpr int RING_CAPACITY = 256;
+    constexpr juce::uint32 RING_MASK = RING_CAPACITY - 1;
+    static_assert((RING_CAPACITY & RING_MASK) == 0, "RING_CAPACITY must be a power of two");
+    
+    constexpr int WRITE_INTERVAL_MS = 50;
+    constexpr juce::uint32 RATE_WINDOW_MS = 1000;   // MAX_REALTIME_RECORDS_PER_SECOND applies per window
+    constexpr int NUM_MESSAGES = static_cast<int>(Logger::Message::NumMessages);
+    
+    // Set once the writer has been deleted at shutdown; it is never recreated
+    std::atomic<bool> writerShutDown { false };
+    
+    // Realtime posts that got past the writerShutDown check; the writer waits for them
+    std::atomic<int> realtimePostsInFlight { 0 };
+    
+    // Indexed by Logger::Message; {text} and {value} are filled in by the writer
+    constexpr const char* MESSAGE_FORMATS[NUM_MESSAGES] = {
+        "Model not found or not ready: {text}",
+        "Inference failed: {text}",
+        "Block took {value}% of its deadline; quality reduced to: {text}"
+    };
+    
+    const char* getLevelPrefix(Logger::Level level)
+    {
+        switch (level)
+        {
+            case Logger::Level::Debug:   return "[DEBUG] ";
+            case Logger::Level::Info:    return "[INFO] ";
+            case Logger::Level::Warning: return "[WARNING] ";
+            case Logger::Level::Error:   return "[ERROR] ";
+        }
+        
+        return "";
+    }
+    
+    //==========================================================================
+    /**
+     * @brief What a realtime thread hands the writer
+     */
+    struct RealtimeRecord
+    {
+        Logger::Level level = Logger::Level::Info;
+        Logger::Message message = Logger::Message::ModelNotReady;
+        juce::uint32 timeMs = 0;
+        double value = 0.0;
+        char text[Logger::MAX_TEXT_LENGTH + 1] = {};
+    };
+    
+    /**
+     * @brief Bounded multi-producer, single-consumer ring of realtime records
+     *
+     * Audio and worker threads push; only the writer pops. Each slot's
+     * sequence tells producers whether it is free and the consumer whether
+     * it has been filled.
+     */
+    class RealtimeRing
+    {
+    public:
+        RealtimeRing()
+        {
+            for (juce::uint32 i = 0; i < static_cast<juce::uint32>(RING_CAPACITY); ++i)
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        
+        bool push(const RealtimeRecord& record) noexcept
+        {
+            auto position = writeIndex.load(std::memory_order_relaxed);
+            
+            for (;;)
+            {
+                auto& slot = slots[position & RING_MASK];
+                const auto sequence = slot.sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<juce::int32>(sequence - position);
+                
+                if (difference == 0)
+                {
+                    if (writeIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        slot.record = record;
+                        slot.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = writeIndex.load(std::memory_order_relaxed);
+                }
+            }
+        }
+        
+        bool pop(RealtimeRecord& record) noexcept
+        {
+            auto& slot = slots[readIndex & RING_MASK];
+            if (slot.sequence.load(std::memory_order_acquire) != readIndex + 1)
+                return false;
+            
+            record = slot.record;
+            slot.sequence.store(readIndex + RING_CAPACITY, std::memory_order_release);
+            ++readIndex;
+            return true;
+        }
+    
+    private:
+        struct Slot
+        {
+            std::atomic<juce::uint32> sequence { 0 };
+            RealtimeRecord record;
+        };
+        
+        std::array<Slot, RING_CAPACITY> slots;
+        std::atomic<juce::uint32> writeIndex { 0 };
+        juce::uint32 readIndex = 0;     // writer only
+    };
+    
+    //==========================================================================
+    /**
+     * @brief Formats queued messages, drops repeats and writes them out
+     *
+     * Deleted at JUCE shutdown, writing whatever is still queued. Messages
+     * logged after that go straight to DBG.
+     */
+    class LogWriter : public juce::DeletedAtShutdown,
+                      private juce::Thread
+    {
+    public:
+        LogWriter()
+            : juce::Thread("MAEVN Log Writer")
+        {
+           #if ! JUCE_DEBUG
+            setFile(Logger::getDefaultLogFile());
+           #endif
+           
+            startThread(juce::Thread::Priority::low);
+        }
+        
+        ~LogWriter() override
+        {
+            // Turn realtime callers away before anything is torn down, then let
+            // the ones already posting finish
+            writerShutDown.store(true);
+            while (realtimePostsInFlight.load() > 0)
+                juce::Thread::yield();
+            
+            stopThread(1000);
+            writePending();
+            clearSingletonInstance();
+        }
+        
+        void post(Logger::Level level, const juce::String& message)
+        {
+            {
+                const juce::ScopedLock sl(queueLock);
+                queue.push_back({ level, juce::Time::getCurrentTime(), message });
+            }
+            
+            notify();
+        }
+        
+        void postRealtime(Logger::Level level, Logger::Message message, const char* text, double value) noexcept
+        {
+            const auto index = static_cast<size_t>(message);
+            if (index >= static_cast<size_t>(NUM_MESSAGES) || !takeRateToken(index))
+                return;
+            
+            RealtimeRecord record;
+            record.level = level;
+            record.message = message;
+            record.timeMs = juce::Time::getMillisecondCounter();
+            record.value = value;
+            
+            if (text != nullptr)
+                std::strncpy(record.text, text, static_cast<size_t>(Logger::MAX_TEXT_LENGTH));
+            
+            // No notify(): waking the writer takes a lock, so it polls instead
+            if (!ring.push(record))
+                droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        void setFile(const juce::File& file)
+        {
+            const juce::ScopedLock sl(writeLock);
+            
+            stream.reset();
+            logFile = file;
+            openFile();
+        }
+        
+        juce::File getFile() const
+        {
+            const juce::ScopedLock sl(writeLock);
+            return logFile;
+        }
+        
+        /**
+         * @brief Write out everything queued so far (any non-realtime thread)
+         */
+        void writePending()
+        {
+            const juce::ScopedLock sl(writeLock);
+            
+            std::vector<QueuedMessage> messages;
+            {
+                const juce::ScopedLock ql(queueLock);
+                messages.swap(queue);
+            }
+            
+            for (const auto& message : messages)
+                writeLine(message.level, message.time, message.text);
+            
+            RealtimeRecord record;
+            const auto nowMs = juce::Time::getMillisecondCounter();
+            const auto now = juce::Time::getCurrentTime();
+            
+            while (ring.pop(record))
+            {
+                const auto age = juce::RelativeTime::milliseconds(static_cast<int>(nowMs - record.timeMs));
+                writeLine(record.level, now - age, formatRecord(record));
+            }
+            
+            const auto dropped = droppedRecords.exchange(0, std::memory_order_relaxed);
+            if (dropped > 0)
+                writeLine(Logger::Level::Warning, now, juce::String(dropped) + " realtime log records dropped (ring full)");
+            
+            // A repeat run is closed once nothing has repeated for a whole window
+            if (repeatCount > 0 && (now - lastLineTime).inSeconds() >= Logger::REPEAT_WINDOW_SECONDS)
+                writeRepeats(now);
+            
+            if (stream != nullptr)
+                stream->flush();
+        }
+        
+        JUCE_DECLARE_SINGLETON(LogWriter, true)
+    
+    private:
+        struct QueuedMessage
+        {
+            Logger::Level level;
+            juce::Time time;
+            juce::String text;
+        };
+        
+        struct RateLimit
+        {
+            std::atomic<juce::uint32> windowStartMs { 0 };
+            std::atomic<int> count { 0 };
+            std::atomic<int> suppressed { 0 };
+        };
+        
+        juce::CriticalSection queueLock;
+        std::vector<QueuedMessage> queue;       // guarded by queueLock
+        
+        RealtimeRing ring;
+        std::array<RateLimit, NUM_MESSAGES> rateLimits;
+        std::atomic<int> droppedRecords { 0 };
+        
+        // Guarded by writeLock
+        juce::CriticalSection writeLock;
+        juce::File logFile;
+        std::unique_ptr<juce::FileOutputStream> stream;
+        juce::String lastLine;
+        juce::Time lastLineTime;
+        int repeatCount = 0;
+        
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                wait(WRITE_INTERVAL_MS);
+                writePending();
+            }
+        }
+        
+        /**
+         * @brief Let a realtime record through unless its message is over its rate
+         */
+        bool takeRateToken(size_t index) noexcept
+        {
+            auto& limit = rateLimits[index];
+            const auto nowMs = juce::Time::getMillisecondCounter();
+            
+            auto windowStart = limit.windowStartMs.load(std::memory_order_relaxed);
+            if (nowMs - windowStart >= RATE_WINDOW_MS
+                && limit.windowStartMs.compare_exchange_strong(windowStart, nowMs, std::memory_order_relaxed))
+                limit.count.store(0, std::memory_order_relaxed);
+            
+            if (limit.count.fetch_add(1, std::memory_order_relaxed) < Logger::MAX_REALTIME_RECORDS_PER_SECOND)
+                return true;
+            
+            limit.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        
+        juce::String formatRecord(const RealtimeRecord& record)
+        {
+            const auto index = static_cast<size_t>(record.message);
+            
+            auto text = juce::String(MESSAGE_FORMATS[index])
+                            .replace("{text}", juce::String::fromUTF8(record.text))
+                            .replace("{value}", juce::String(record.value));
+            
+            const auto suppressed = rateLimits[index].suppressed.exchange(0, std::memory_order_relaxed);
+            if (suppressed > 0)
+                text << " (" << suppressed << " similar suppressed)";
+            
+            return text;
+        }
+        
+        void writeLine(Logger::Level level, juce::Time time, const juce::String& message)
+        {
+            const auto line = getLevelPrefix(level) + message;
+            
+            if (line == lastLine && (time - lastLineTime).inSeconds() < Logger::REPEAT_WINDOW_SECONDS)
+            {
+                ++repeatCount;
+                return;
+            }
+            
+            if (repeatCount > 0)
+                writeRepeats(time);
+            
+            lastLine = line;
+            lastLineTime = time;
+            output(time, line);
+        }
+        
+        void writeRepeats(juce::Time time)
+        {
+            output(time, "Last message repeated " + juce::String(repeatCount) + " times");
+            repeatCount = 0;
+            lastLine.clear();
+        }
+        
+        void output(juce::Time time, const juce::String& line)
+        {
+            DBG(line);
+            
+            if (stream == nullptr)
+                return;
+            
+            stream->writeText(time.formatted("%Y-%m-%d %H:%M:%S ") + line + "\n", false, false, "\n");
+            
+            if (stream->getPosition() >= Logger::MAX_FILE_BYTES)
+                rotateFile();
+        }
+        
+        void openFile()
+        {
+            if (logFile == juce::File() || !logFile.getParentDirectory().createDirectory())
+                return;
+            
+            stream = std::make_unique<juce::FileOutputStream>(logFile);
+            if (!stream->openedOk())
+                stream.reset();
+        }
+        
+        /**
+         * @brief Shift MAEVN.log to MAEVN.1.log and so on, dropping the oldest
+         */
+        void rotateFile()
+        {
+            stream.reset();
+            
+            const auto getBackup = [this](int index)
+            {
+                return logFile.getSiblingFile(logFile.getFileNameWithoutExtension() + "." + juce::String(index)
+                                              + logFile.getFileExtension());
+            };
+            
+            getBackup(Logger::NUM_BACKUP_FILES).deleteFile();
+            for (int i = Logger::NUM_BACKUP_FILES - 1; i >= 1; --i)
+                getBackup(i).moveFileTo(getBackup(i + 1));
+            
+            logFile.moveFileTo(getBackup(1));
+            openFile();
+        }
+        
+        JUCE_DECLARE_NON_COPYABLE(LogWriter)
+    };
+    
+    JUCE_IMPLEMENT_SINGLETON(LogWriter)
+}
+
+//==============================================================================
+void Logger::log(Level level, const juce::String& message)
+{
+    if (writerShutDown.load())
+        DBG(getLevelPrefix(level) + message);
+    else if (auto* writer = LogWriter::getInstance())
+        writer->post(level, message);
+}
+
+void Logger::logRealtime(Level level, Message message, const char* text, double value) noexcept
+{
+    // Never created here; anything logged before the writer exists is lost
+    realtimePostsInFlight.fetch_add(1);
+    
+    if (!writerShutDown.load())
+        if (auto* writer = LogWriter::getInstanceWithoutCreating())
+            writer->postRealtime(level, message, text, value);
+    
+    realtimePostsInFlight.fetch_sub(1);
+}
+
+void Logger::setLogFile(const juce::File& file)
+{
+    if (writerShutDown.load())
+        return;
+    
+    if (auto* writer = LogWriter::getInstance())
+        writer->setFile(file);
+}
+
+juce::File Logger::getLogFile()
+{
+    if (auto* writer = LogWriter::getInstanceWithoutCreating())
+        return writer->getFile();
+    
+    return {};
+}
+
+juce::File Logger::getDefaultLogFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+               .getChildFile("MAEVN")
+               .getChildFile("Logs")
+               .getChildFile("MAEVN.log");
+}
+
+void Logger::flush()
+{
+    if (auto* writer = LogWriter::getInstanceWithoutCreating())
+        writer->writePending();
+}
+
+} // namespace MAEVN
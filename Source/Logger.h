@@ -0,0 +1,84 @@
+/**
+ * @file Logger.h
+ * @brief Asynchronous, rate-limited logging that is safe on the audio thread
+ *
+ * Every message is formatted and written by one background thread, so no
+ * caller waits on DBG or the disk. Realtime threads use logRealtime(): a
+ * fixed-size record (level, message id, a short text and a number) is
+ * copied into a lock-free ring without allocating, and each message id is
+ * limited to a few records per second at the source. The writer collapses
+ * a line repeated within REPEAT_WINDOW_SECONDS into one "repeated N times"
+ * line. Output goes to DBG in debug builds and to a rotating log file in
+ * release builds.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Logging utility
+ */
+class Logger
+{
+public:
+    enum class Level
+    {
+        Debug,
+        Info,
+        Warning,
+        Error
+    };
+    
+    /**
+     * @brief Messages that realtime threads can log (formats in Logger.cpp)
+     */
+    enum class Message
+    {
+        ModelNotReady,      // text: model role
+        InferenceFailed,    // text: ONNX Runtime error
+        QualityReduced,     // text: quality tier, value: load in percent
+        NumMessages
+    };
+    
+    static constexpr int MAX_TEXT_LENGTH = 64;                  // bytes of text kept per realtime record
+    static constexpr int MAX_REALTIME_RECORDS_PER_SECOND = 4;   // per message id
+    static constexpr double REPEAT_WINDOW_SECONDS = 10.0;
+    static constexpr juce::int64 MAX_FILE_BYTES = 1024 * 1024;
+    static constexpr int NUM_BACKUP_FILES = 3;
+    
+    /**
+     * @brief Queue a message (any thread except realtime ones; may allocate)
+     */
+    static void log(Level level, const juce::String& message);
+    
+    /**
+     * @brief Queue a fixed message from a realtime thread
+     *
+     * Never allocates, locks or blocks. Records over the per-message rate,
+     * or that find the ring full, are counted and reported by the writer.
+     * @param text Copied up to MAX_TEXT_LENGTH bytes (nullptr = none)
+     * @param value Shown by messages whose format has a {value}
+     */
+    static void logRealtime(Level level, Message message, const char* text = nullptr, double value = 0.0) noexcept;
+    
+    /**
+     * @brief Write to a file, rotated at MAX_FILE_BYTES (juce::File() = stop)
+     *
+     * Release builds log to getDefaultLogFile() unless told otherwise.
+     */
+    static void setLogFile(const juce::File& file);
+    static juce::File getLogFile();
+    static juce::File getDefaultLogFile();
+    
+    /**
+     * @brief Write everything queued so far before returning (not realtime)
+     */
+    static void flush();
+};
+
+} // namespace MAEVN
@@ -8,20 +8,59 @@
 namespace MAEVN
 {
 
+namespace
+{
+    bool isSameBlock(const TimelineBlock& a, const TimelineBlock& b)
+    {
+        return a.type == b.type && a.trackIndex == b.trackIndex && a.startTime == b.startTime
+               && a.duration == b.duration && a.content == b.content;
+    }
+    
+    bool overlaps(const TimelineBlock& block, const LoopRegion& region)
+    {
+        return block.startTime < region.endTime && block.startTime + block.duration > region.startTime;
+    }
+    
+    /**
+     * @brief Remove one match of every block in toRemove
+     * @return false, leaving blocks alone, if any of them is missing
+     */
+    bool removeEach(std::vector<TimelineBlock>& blocks, const std::vector<TimelineBlock>& toRemove)
+    {
+        auto remaining = blocks;
+        for (const auto& block : toRemove)
+        {
+            auto match = std::find_if(remaining.begin(), remaining.end(),
+                                      [&block](const TimelineBlock& other) { return isSameBlock(block, other); });
+            if (match == remaining.end())
+                return false;
+            
+            remaining.erase(match);
+        }
+        
+        blocks = std::move(remaining);
+        return true;
+    }
+}
+
 //==============================================================================
 // LoopRegionSync Implementation
 //==============================================================================
 
 LoopRegionSync::LoopRegionSync(PatternEngine* engine)
-    : patternEngine(engine)
+    : juce::Thread("Loop Region Fit")
+    , patternEngine(engine)
     , autoFitEnabled(false)
     , defaultFitMode(FitMode::Smart)
 {
+    startThread(juce::Thread::Priority::low);
+    
     Logger::log(Logger::Level::Info, "LoopRegionSync initialized");
 }
 
 LoopRegionSync::~LoopRegionSync()
 {
+    stopThread(2000);
 }
 
 void LoopRegionSync::updateFromPlayHead(juce::AudioPlayHead* playHead)
@@ -29,101 +68,217 @@ void LoopRegionSync::updateFromPlayHead(juce::AudioPlayHead* playHead)
     if (playHead == nullptr)
         return;
     
-    const juce::ScopedLock sl(syncLock);
+    auto posInfo = playHead->getPosition();
+    if (!posInfo.hasValue())
+        return;
     
-    previousRegion = currentRegion;
+    LoopRegion region = hostRegion;
     
-    // Get current position info from DAW
-    if (auto posInfo = playHead->getPosition())
+    // Check if DAW is looping
+    if (auto loopPoints = posInfo->getLoopPoints())
     {
-        // Check if DAW is looping
-        if (auto loopPoints = posInfo->getLoopPoints())
-        {
-            currentRegion.isLooping = posInfo->getIsLooping();
-            
-            // Convert PPQ to seconds using BPM
-            double bpm = 120.0;
-            if (auto tempo = posInfo->getBpm())
-            {
-                bpm = *tempo;
-            }
-            
-            double beatsPerSecond = bpm / 60.0;
-            
-            currentRegion.startTime = loopPoints->ppqStart / beatsPerSecond;
-            currentRegion.endTime = loopPoints->ppqEnd / beatsPerSecond;
-            currentRegion.hasSelection = true;
-        }
-        else
+        region.isLooping = posInfo->getIsLooping();
+        
+        // Convert PPQ to seconds using BPM
+        double bpm = 120.0;
+        if (auto tempo = posInfo->getBpm())
         {
-            currentRegion.hasSelection = false;
-            currentRegion.isLooping = false;
+            bpm = *tempo;
         }
+        
+        double beatsPerSecond = bpm / 60.0;
+        
+        region.startTime = loopPoints->ppqStart / beatsPerSecond;
+        region.endTime = loopPoints->ppqEnd / beatsPerSecond;
+        region.hasSelection = true;
+    }
+    else
+    {
+        region.hasSelection = false;
+        region.isLooping = false;
     }
     
     // Check if region changed
-    bool regionChanged = (currentRegion.startTime != previousRegion.startTime ||
-                         currentRegion.endTime != previousRegion.endTime ||
-                         currentRegion.isLooping != previousRegion.isLooping);
+    bool regionChanged = (region.startTime != hostRegion.startTime ||
+                          region.endTime != hostRegion.endTime ||
+                          region.isLooping != hostRegion.isLooping);
+    
+    hostRegion = region;
+    
+    // Fitting and notifying happen on the fit thread, for the newest region only;
+    // it polls, so nothing here takes the lock a signal would
+    if (regionChanged)
+        hostRegions.publish(region);
+}
+
+void LoopRegionSync::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(HOST_REGION_POLL_MS);
+        
+        if (threadShouldExit() || !hostRegions.acquireLatest())
+            continue;
+        
+        const juce::ScopedLock sl(syncLock);
+        applyRegion(hostRegions.getAcquired());
+    }
+}
+
+void LoopRegionSync::applyRegion(const LoopRegion& region)
+{
+    const bool regionChanged = (region.startTime != currentRegion.startTime ||
+                                region.endTime != currentRegion.endTime ||
+                                region.isLooping != currentRegion.isLooping);
+    
+    previousRegion = currentRegion;
+    currentRegion = region;
     
     if (regionChanged && currentRegion.isValid())
     {
         notifyLoopRegionChanged();
         
-        if (autoFitEnabled)
+        if (autoFitEnabled.load())
         {
-            int affected = fitArrangementToLoop(defaultFitMode);
+            int affected = autoFitToRegion(defaultFitMode.load());
             notifyArrangementFitted(affected);
         }
     }
 }
 
+LoopRegion LoopRegionSync::getCurrentLoopRegion() const
+{
+    const juce::ScopedLock sl(syncLock);
+    return currentRegion;
+}
+
 int LoopRegionSync::fitArrangementToLoop(FitMode mode)
+{
+    const juce::ScopedLock sl(syncLock);
+    
+    if (!currentRegion.isValid() || patternEngine == nullptr)
+        return 0;
+    
+    return fitSpanToRegion(currentRegion.startTime, currentRegion.endTime, mode);
+}
+
+int LoopRegionSync::fitSpanToRegion(double spanStart, double spanEnd, FitMode mode)
 {
     if (!currentRegion.isValid() || patternEngine == nullptr)
         return 0;
     
-    const juce::ScopedLock sl(syncLock);
+    const LoopRegion region = currentRegion;
+    const double bpm = patternEngine->getBPM();
     
-    FitMode actualMode = (mode == FitMode::Smart) ? determineBestFitMode() : mode;
+    // Only the blocks in the span are copied, fitted and written back
+    int numAffected = patternEngine->editBlocksInRange(spanStart, spanEnd, [&](std::vector<TimelineBlock>& blocks)
+    {
+        fitBlocks(blocks, region, mode, bpm);
+    });
+    
+    // An explicit fit is an edit in its own right; auto-fit starts over from it
+    preFitBlocks.clear();
+    fittedBlocks.clear();
     
-    int numAffected = 0;
+    Logger::log(Logger::Level::Info, "Fitted " + juce::String(numAffected) +
+                " blocks to loop region");
     
-    switch (actualMode)
+    return numAffected;
+}
+
+int LoopRegionSync::autoFitToRegion(FitMode mode)
+{
+    if (!currentRegion.isValid() || patternEngine == nullptr)
+        return 0;
+    
+    const LoopRegion region = currentRegion;
+    const double bpm = patternEngine->getBPM();
+    
+    // The span reaches every block the last auto-fit read or wrote
+    double spanStart = region.startTime;
+    double spanEnd = region.endTime;
+    for (const auto* lastFit : { &preFitBlocks, &fittedBlocks })
     {
-        case FitMode::Stretch:
-            numAffected = applyStretchMode();
-            break;
-            
-        case FitMode::Trim:
-            numAffected = applyTrimMode();
-            break;
-            
-        case FitMode::Loop:
-            numAffected = applyLoopMode();
-            break;
-            
-        case FitMode::Quantize:
-            numAffected = applyQuantizeMode();
-            break;
-            
-        default:
-            break;
+        for (const auto& block : *lastFit)
+        {
+            spanStart = juce::jmin(spanStart, block.startTime);
+            spanEnd = juce::jmax(spanEnd, block.startTime + block.duration);
+        }
     }
     
-    Logger::log(Logger::Level::Info, "Fitted " + juce::String(numAffected) + 
+    int numAffected = patternEngine->editBlocksInRange(spanStart, spanEnd, [&](std::vector<TimelineBlock>& blocks)
+    {
+        // Put back what the last auto-fit replaced, unless its result has been edited since
+        auto unfitted = blocks;
+        if (removeEach(unfitted, fittedBlocks))
+            unfitted.insert(unfitted.end(), preFitBlocks.begin(), preFitBlocks.end());
+        else
+            unfitted = blocks;
+        
+        // Blocks outside the region stay as they were
+        blocks.clear();
+        preFitBlocks.clear();
+        for (const auto& block : unfitted)
+            (overlaps(block, region) ? preFitBlocks : blocks).push_back(block);
+        
+        fittedBlocks = preFitBlocks;
+        fitBlocks(fittedBlocks, region, mode, bpm);
+        blocks.insert(blocks.end(), fittedBlocks.begin(), fittedBlocks.end());
+    });
+    
+    Logger::log(Logger::Level::Info, "Auto-fitted " + juce::String(numAffected) +
                 " blocks to loop region");
     
     return numAffected;
 }
 
+void LoopRegionSync::fitBlocks(std::vector<TimelineBlock>& blocks, const LoopRegion& region, FitMode mode, double bpm)
+{
+    // Tracks play side by side, so each one is fitted on its own
+    std::map<int, std::vector<TimelineBlock>> tracks;
+    for (const auto& block : blocks)
+        tracks[block.trackIndex].push_back(block);
+    
+    blocks.clear();
+    
+    for (auto& track : tracks)
+    {
+        auto& trackBlocks = track.second;
+        FitMode actualMode = (mode == FitMode::Smart) ? determineBestFitMode(trackBlocks, region) : mode;
+        
+        switch (actualMode)
+        {
+            case FitMode::Stretch:
+                applyStretchMode(trackBlocks, region, bpm);
+                break;
+            
+            case FitMode::Trim:
+                applyTrimMode(trackBlocks, region, bpm);
+                break;
+            
+            case FitMode::Loop:
+                applyLoopMode(trackBlocks, region);
+                break;
+            
+            case FitMode::Quantize:
+                applyQuantizeMode(trackBlocks, region, bpm);
+                break;
+            
+            default:
+                break;
+        }
+        
+        blocks.insert(blocks.end(), trackBlocks.begin(), trackBlocks.end());
+    }
+}
+
 int LoopRegionSync::fitBlocksToLoop(const std::vector<int>& blockIndices, FitMode mode)
 {
+    const juce::ScopedLock sl(syncLock);
+    
     if (!currentRegion.isValid() || patternEngine == nullptr || blockIndices.empty())
         return 0;
     
-    const juce::ScopedLock sl(syncLock);
-    
     // Get blocks and calculate total duration
     const auto& allBlocks = patternEngine->getBlocks();
     double totalDuration = 0.0;
@@ -171,9 +326,9 @@ void LoopRegionSync::setLoopRegion(const LoopRegion& region)
     
     notifyLoopRegionChanged();
     
-    if (autoFitEnabled && currentRegion.isValid())
+    if (autoFitEnabled.load() && currentRegion.isValid())
     {
-        int affected = fitArrangementToLoop(defaultFitMode);
+        int affected = autoFitToRegion(defaultFitMode.load());
         notifyArrangementFitted(affected);
     }
 }
@@ -188,142 +343,135 @@ void LoopRegionSync::clearLoopRegion()
 
 std::vector<int> LoopRegionSync::getBlocksInLoopRegion() const
 {
-    std::vector<int> result;
+    const auto region = getCurrentLoopRegion();
     
-    if (!currentRegion.isValid() || patternEngine == nullptr)
-        return result;
-    
-    const auto& blocks = patternEngine->getBlocks();
+    if (!region.isValid() || patternEngine == nullptr)
+        return {};
     
-    for (size_t i = 0; i < blocks.size(); ++i)
-    {
-        const auto& block = blocks[i];
-        double blockEnd = block.startTime + block.duration;
-        
-        // Check if block overlaps with loop region
-        if (block.startTime < currentRegion.endTime && 
-            blockEnd > currentRegion.startTime)
-        {
-            result.push_back(static_cast<int>(i));
-        }
-    }
-    
-    return result;
+    return patternEngine->getBlockIndicesInRange(region.startTime, region.endTime);
 }
 
 std::vector<double> LoopRegionSync::calculateOptimalFit(FitMode mode) const
 {
-    std::vector<double> adjustedDurations;
+    const auto region = getCurrentLoopRegion();
     
-    if (!currentRegion.isValid() || patternEngine == nullptr)
-        return adjustedDurations;
+    if (!region.isValid() || patternEngine == nullptr)
+        return {};
     
-    auto blockIndices = getBlocksInLoopRegion();
-    const auto& allBlocks = patternEngine->getBlocks();
+    return calculateFit(patternEngine->getBlocksInRange(region.startTime, region.endTime), region, mode,
+                        patternEngine->getBPM());
+}
+
+std::vector<double> LoopRegionSync::calculateFit(const std::vector<TimelineBlock>& blocks, const LoopRegion& region,
+                                                 FitMode mode, double bpm)
+{
+    std::vector<double> adjustedDurations(blocks.size(), 0.0);
     
-    if (blockIndices.empty())
+    if (blocks.empty())
         return adjustedDurations;
     
-    // Calculate current total duration
-    double totalDuration = 0.0;
-    for (int idx : blockIndices)
-    {
-        totalDuration += allBlocks[idx].duration;
-    }
+    // Tracks play side by side: each track's blocks are fitted to the region on their own
+    std::map<int, std::vector<size_t>> tracks;
+    for (size_t i = 0; i < blocks.size(); ++i)
+        tracks[blocks[i].trackIndex].push_back(i);
     
-    double targetDuration = currentRegion.getDuration();
+    double targetDuration = region.getDuration();
     
-    switch (mode)
+    for (const auto& track : tracks)
     {
-        case FitMode::Stretch:
+        const auto& indices = track.second;
+        
+        double totalDuration = 0.0;
+        for (const auto i : indices)
+            totalDuration += blocks[i].duration;
+        
+        switch (mode)
         {
-            double stretchFactor = targetDuration / totalDuration;
-            for (int idx : blockIndices)
+            case FitMode::Stretch:
             {
-                adjustedDurations.push_back(allBlocks[idx].duration * stretchFactor);
+                double stretchFactor = totalDuration > 0.0 ? targetDuration / totalDuration : 1.0;
+                for (const auto i : indices)
+                    adjustedDurations[i] = blocks[i].duration * stretchFactor;
+                break;
             }
-            break;
-        }
-        
-        case FitMode::Trim:
-        {
-            double remaining = targetDuration;
-            for (int idx : blockIndices)
+            
+            case FitMode::Trim:
             {
-                double blockDur = allBlocks[idx].duration;
-                if (remaining > 0)
-                {
-                    adjustedDurations.push_back(std::min(blockDur, remaining));
-                    remaining -= blockDur;
-                }
-                else
+                double remaining = targetDuration;
+                for (const auto i : indices)
                 {
-                    adjustedDurations.push_back(0.0);
+                    // Blocks past the end get no length; the caller drops them
+                    adjustedDurations[i] = juce::jmax(0.0, std::min(blocks[i].duration, remaining));
+                    remaining -= blocks[i].duration;
                 }
+                break;
             }
-            break;
-        }
-        
-        case FitMode::Quantize:
-        {
-            double beatDuration = 60.0 / patternEngine->getBPM();
-            for (int idx : blockIndices)
+            
+            case FitMode::Quantize:
             {
-                double blockDur = allBlocks[idx].duration;
-                double numBeats = std::round(blockDur / beatDuration);
-                adjustedDurations.push_back(numBeats * beatDuration);
+                double beatDuration = 60.0 / bpm;
+                for (const auto i : indices)
+                    adjustedDurations[i] = std::round(blocks[i].duration / beatDuration) * beatDuration;
+                break;
             }
-            break;
+            
+            default:
+                for (const auto i : indices)
+                    adjustedDurations[i] = blocks[i].duration;
+                break;
         }
-        
-        default:
-            for (int idx : blockIndices)
-            {
-                adjustedDurations.push_back(allBlocks[idx].duration);
-            }
-            break;
     }
     
     return adjustedDurations;
 }
 
+double LoopRegionSync::getTotalDuration(const std::vector<TimelineBlock>& blocks)
+{
+    // Tracks play side by side, so the longest track is the arrangement's length
+    std::map<int, double> trackDurations;
+    for (const auto& block : blocks)
+    {
+        trackDurations[block.trackIndex] += block.duration;
+    }
+    
+    double totalDuration = 0.0;
+    for (const auto& track : trackDurations)
+    {
+        totalDuration = juce::jmax(totalDuration, track.second);
+    }
+    
+    return totalDuration;
+}
+
 int LoopRegionSync::quantizeBlocksToGrid()
 {
-    return applyQuantizeMode();
+    return fitArrangementToLoop(FitMode::Quantize);
 }
 
 double LoopRegionSync::stretchBlocksToFit()
 {
-    if (!currentRegion.isValid() || patternEngine == nullptr)
-        return 1.0;
+    const auto region = getCurrentLoopRegion();
     
-    auto blockIndices = getBlocksInLoopRegion();
-    const auto& allBlocks = patternEngine->getBlocks();
-    
-    if (blockIndices.empty())
+    if (!region.isValid() || patternEngine == nullptr)
         return 1.0;
     
     // Calculate current total duration
-    double totalDuration = 0.0;
-    for (int idx : blockIndices)
-    {
-        totalDuration += allBlocks[idx].duration;
-    }
+    double totalDuration = getTotalDuration(patternEngine->getBlocksInRange(region.startTime, region.endTime));
     
     if (totalDuration <= 0.0)
         return 1.0;
     
-    double stretchFactor = currentRegion.getDuration() / totalDuration;
+    double stretchFactor = region.getDuration() / totalDuration;
     
     // Apply stretch factor
-    applyStretchMode();
+    fitArrangementToLoop(FitMode::Stretch);
     
     return stretchFactor;
 }
 
 int LoopRegionSync::loopBlocksToFill()
 {
-    return applyLoopMode();
+    return fitArrangementToLoop(FitMode::Loop);
 }
 
 void LoopRegionSync::notifyLoopRegionChanged()
@@ -342,100 +490,99 @@ void LoopRegionSync::notifyArrangementFitted(int numBlocksAffected)
     }
 }
 
-int LoopRegionSync::applyStretchMode()
+void LoopRegionSync::applyStretchMode(std::vector<TimelineBlock>& blocks, const LoopRegion& region, double bpm)
 {
-    auto blockIndices = getBlocksInLoopRegion();
-    
-    if (blockIndices.empty())
-        return 0;
+    double totalDuration = getTotalDuration(blocks);
+    if (totalDuration <= 0.0)
+        return;
     
-    // Calculate stretch factor and apply
-    // In a full implementation, this would modify the pattern engine blocks
-    auto adjustedDurations = calculateOptimalFit(FitMode::Stretch);
+    // Scale the blocks' layout about the first of them, then move it to the region start
+    auto adjustedDurations = calculateFit(blocks, region, FitMode::Stretch, bpm);
+    double stretchFactor = region.getDuration() / totalDuration;
     
-    Logger::log(Logger::Level::Info, "Applied stretch mode to " + 
-                juce::String(static_cast<int>(blockIndices.size())) + " blocks");
+    double firstStart = blocks.front().startTime;
+    for (const auto& block : blocks)
+    {
+        firstStart = std::min(firstStart, block.startTime);
+    }
     
-    return static_cast<int>(blockIndices.size());
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        blocks[i].startTime = region.startTime + (blocks[i].startTime - firstStart) * stretchFactor;
+        blocks[i].duration = adjustedDurations[i];
+    }
 }
 
-int LoopRegionSync::applyTrimMode()
+void LoopRegionSync::applyTrimMode(std::vector<TimelineBlock>& blocks, const LoopRegion& region, double bpm)
 {
-    auto blockIndices = getBlocksInLoopRegion();
-    
-    if (blockIndices.empty())
-        return 0;
-    
-    auto adjustedDurations = calculateOptimalFit(FitMode::Trim);
+    auto adjustedDurations = calculateFit(blocks, region, FitMode::Trim, bpm);
     
-    Logger::log(Logger::Level::Info, "Applied trim mode to " + 
-                juce::String(static_cast<int>(blockIndices.size())) + " blocks");
+    // Nothing may run past the region end either; blocks with nothing left are
+    // dropped, since a zero-length block would never be found again
+    std::vector<TimelineBlock> trimmed;
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        const double duration = std::min(adjustedDurations[i], std::max(0.0, region.endTime - blocks[i].startTime));
+        if (duration <= 0.0)
+            continue;
+        
+        trimmed.push_back(blocks[i]);
+        trimmed.back().duration = duration;
+    }
     
-    return static_cast<int>(blockIndices.size());
+    blocks = std::move(trimmed);
 }
 
-int LoopRegionSync::applyLoopMode()
+void LoopRegionSync::applyLoopMode(std::vector<TimelineBlock>& blocks, const LoopRegion& region)
 {
-    auto blockIndices = getBlocksInLoopRegion();
-    
-    if (blockIndices.empty() || patternEngine == nullptr)
-        return 0;
-    
-    const auto& allBlocks = patternEngine->getBlocks();
-    
     // Calculate how many loop iterations fit
-    double totalDuration = 0.0;
-    for (int idx : blockIndices)
-    {
-        totalDuration += allBlocks[idx].duration;
-    }
+    double totalDuration = getTotalDuration(blocks);
     
     if (totalDuration <= 0.0)
-        return 0;
+        return;
     
-    double targetDuration = currentRegion.getDuration();
+    double targetDuration = region.getDuration();
     int numLoops = static_cast<int>(std::ceil(targetDuration / totalDuration));
     
-    Logger::log(Logger::Level::Info, "Applied loop mode: " + 
-                juce::String(numLoops) + " iterations");
+    // Copies of the blocks follow them until the region is full
+    const size_t numOriginals = blocks.size();
+    for (int loop = 1; loop < numLoops; ++loop)
+    {
+        for (size_t i = 0; i < numOriginals; ++i)
+        {
+            TimelineBlock copy = blocks[i];
+            copy.startTime += loop * totalDuration;
+            
+            if (copy.startTime < region.endTime)
+                blocks.push_back(copy);
+        }
+    }
     
-    return numLoops;
+    Logger::log(Logger::Level::Info, "Applied loop mode: " +
+                juce::String(numLoops) + " iterations");
 }
 
-int LoopRegionSync::applyQuantizeMode()
+void LoopRegionSync::applyQuantizeMode(std::vector<TimelineBlock>& blocks, const LoopRegion& region, double bpm)
 {
-    auto blockIndices = getBlocksInLoopRegion();
+    auto adjustedDurations = calculateFit(blocks, region, FitMode::Quantize, bpm);
+    double beatDuration = 60.0 / bpm;
     
-    if (blockIndices.empty())
-        return 0;
-    
-    auto adjustedDurations = calculateOptimalFit(FitMode::Quantize);
-    
-    Logger::log(Logger::Level::Info, "Applied quantize mode to " + 
-                juce::String(static_cast<int>(blockIndices.size())) + " blocks");
-    
-    return static_cast<int>(blockIndices.size());
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        blocks[i].startTime = std::round(blocks[i].startTime / beatDuration) * beatDuration;
+        blocks[i].duration = adjustedDurations[i];
+    }
 }
 
-FitMode LoopRegionSync::determineBestFitMode() const
+FitMode LoopRegionSync::determineBestFitMode(const std::vector<TimelineBlock>& blocks, const LoopRegion& region)
 {
-    if (!currentRegion.isValid() || patternEngine == nullptr)
-        return FitMode::Stretch;
-    
-    auto blockIndices = getBlocksInLoopRegion();
-    const auto& allBlocks = patternEngine->getBlocks();
+    // Calculate current total duration
+    double totalDuration = getTotalDuration(blocks);
     
-    if (blockIndices.empty())
+    if (!region.isValid() || totalDuration <= 0.0)
         return FitMode::Stretch;
     
-    // Calculate current total duration
-    double totalDuration = 0.0;
-    for (int idx : blockIndices)
-    {
-        totalDuration += allBlocks[idx].duration;
-    }
-    
-    double targetDuration = currentRegion.getDuration();
+    double targetDuration = region.getDuration();
     double ratio = targetDuration / totalDuration;
     
     // Determine best mode based on ratio
@@ -5,15 +5,30 @@
  * This module provides synchronization between the plugin's timeline
  * and the DAW's loop/selection region, automatically fitting arrangements
  * to match the selected area.
+ *
+ * The audio thread only compares the host's loop points with the last
+ * ones it saw and publishes a change for a fit thread, which polls for
+ * it (signalling from the audio thread could block). That thread picks up
+ * the newest region (a brace drag coalesces into few fits), notifies the
+ * listeners and rewrites just the blocks around the old and the new
+ * region, which PatternEngine publishes as one timeline edit.
+ *
+ * Auto-fit always starts from the arrangement as it was before the last
+ * auto-fit, so following the loop braces around never compounds edits;
+ * once the fitted blocks are edited by hand, the edit becomes the new
+ * starting point. Each track is fitted on its own.
  */
 
 #pragma once
 
 #include <JuceHeader.h>
+#include <atomic>
+#include <map>
 #include <memory>
 #include <vector>
 #include <functional>
 #include "Utilities.h"
+#include "ParameterSnapshot.h"
 #include "PatternEngine.h"
 
 namespace MAEVN
@@ -57,6 +72,9 @@ enum class FitMode
 //==============================================================================
 /**
  * @brief Listener interface for loop region changes
+ *
+ * Called on the fit thread, or on the thread calling setLoopRegion(),
+ * clearLoopRegion() or fitArrangementToLoop(); never on the audio thread.
  */
 class LoopRegionListener
 {
@@ -84,14 +102,20 @@ public:
  * Handles synchronization between the plugin's arrangement and
  * the DAW's loop/selection region.
  */
-class LoopRegionSync
+class LoopRegionSync : private juce::Thread
 {
 public:
+    /** How often the fit thread looks for a region published by the audio thread */
+    static constexpr int HOST_REGION_POLL_MS = 10;
+    
     LoopRegionSync(PatternEngine* patternEngine);
-    ~LoopRegionSync();
+    ~LoopRegionSync() override;
     
     /**
      * @brief Update with current DAW transport info
+     *
+     * Audio thread, realtime safe. A changed region is handed to the fit
+     * thread; nothing is fitted or notified here.
      * @param playHead The DAW's play head
      */
     void updateFromPlayHead(juce::AudioPlayHead* playHead);
@@ -100,15 +124,18 @@ public:
      * @brief Get current loop region
      * @return Current loop region info
      */
-    LoopRegion getCurrentLoopRegion() const { return currentRegion; }
+    LoopRegion getCurrentLoopRegion() const;
     
     /**
      * @brief Check if a loop region is currently active
      */
-    bool hasActiveLoopRegion() const { return currentRegion.isValid(); }
+    bool hasActiveLoopRegion() const { return getCurrentLoopRegion().isValid(); }
     
     /**
      * @brief Fit arrangement to current loop region
+     *
+     * Rewrites the blocks overlapping the region as they are now (not on the
+     * audio thread); unlike auto-fit, repeated calls build on each other.
      * @param mode The fit mode to use
      * @return Number of blocks affected
      */
@@ -126,23 +153,23 @@ public:
      * @brief Auto-fit arrangement when loop region changes
      * @param enabled Whether to enable auto-fit
      */
-    void setAutoFitEnabled(bool enabled) { autoFitEnabled = enabled; }
+    void setAutoFitEnabled(bool enabled) { autoFitEnabled.store(enabled); }
     
     /**
      * @brief Check if auto-fit is enabled
      */
-    bool isAutoFitEnabled() const { return autoFitEnabled; }
+    bool isAutoFitEnabled() const { return autoFitEnabled.load(); }
     
     /**
      * @brief Set the fit mode for auto-fit
      * @param mode The fit mode to use
      */
-    void setDefaultFitMode(FitMode mode) { defaultFitMode = mode; }
+    void setDefaultFitMode(FitMode mode) { defaultFitMode.store(mode); }
     
     /**
      * @brief Get the default fit mode
      */
-    FitMode getDefaultFitMode() const { return defaultFitMode; }
+    FitMode getDefaultFitMode() const { return defaultFitMode.load(); }
     
     /**
      * @brief Add a listener for loop region events
@@ -200,15 +227,45 @@ public:
     
 private:
     PatternEngine* patternEngine;
+    
+    // Fit thread and message thread, guarded by syncLock
     LoopRegion currentRegion;
     LoopRegion previousRegion;
+    std::vector<LoopRegionListener*> listeners;
+    mutable juce::CriticalSection syncLock;
     
-    bool autoFitEnabled;
-    FitMode defaultFitMode;
+    // What the last auto-fit replaced and what it wrote (under syncLock)
+    std::vector<TimelineBlock> preFitBlocks;
+    std::vector<TimelineBlock> fittedBlocks;
     
-    std::vector<LoopRegionListener*> listeners;
+    std::atomic<bool> autoFitEnabled;
+    std::atomic<FitMode> defaultFitMode;
+    
+    // Audio thread to fit thread
+    LoopRegion hostRegion;   // last region read from the play head (audio thread)
+    ParameterSnapshot<LoopRegion> hostRegions;
+    
+    void run() override;
     
-    juce::CriticalSection syncLock;
+    /**
+     * @brief Make a region current, notify and auto-fit (under syncLock)
+     */
+    void applyRegion(const LoopRegion& region);
+    
+    /**
+     * @brief Fit the blocks overlapping [spanStart, spanEnd) to the current region (under syncLock)
+     */
+    int fitSpanToRegion(double spanStart, double spanEnd, FitMode mode);
+    
+    /**
+     * @brief Fit the pre-auto-fit arrangement to the current region (under syncLock)
+     */
+    int autoFitToRegion(FitMode mode);
+    
+    /**
+     * @brief Fit blocks to a region one track at a time
+     */
+    static void fitBlocks(std::vector<TimelineBlock>& blocks, const LoopRegion& region, FitMode mode, double bpm);
     
     /**
      * @brief Notify listeners of loop region change
@@ -220,30 +277,41 @@ private:
      */
     void notifyArrangementFitted(int numBlocksAffected);
     
+    /**
+     * @brief Adjusted durations of blocks for a region, each track fitted on its own
+     */
+    static std::vector<double> calculateFit(const std::vector<TimelineBlock>& blocks, const LoopRegion& region,
+                                            FitMode mode, double bpm);
+    
+    /**
+     * @brief Sum of block durations on the busiest track
+     */
+    static double getTotalDuration(const std::vector<TimelineBlock>& blocks);
+    
     /**
      * @brief Apply stretch mode to blocks
      */
-    int applyStretchMode();
+    static void applyStretchMode(std::vector<TimelineBlock>& blocks, const LoopRegion& region, double bpm);
     
     /**
-     * @brief Apply trim mode to blocks
+     * @brief Apply trim mode to blocks (drops the ones with no length left)
      */
-    int applyTrimMode();
+    static void applyTrimMode(std::vector<TimelineBlock>& blocks, const LoopRegion& region, double bpm);
     
     /**
-     * @brief Apply loop mode to blocks
+     * @brief Apply loop mode to blocks (appends the copies)
      */
-    int applyLoopMode();
+    static void applyLoopMode(std::vector<TimelineBlock>& blocks, const LoopRegion& region);
     
     /**
      * @brief Apply quantize mode to blocks
      */
-    int applyQuantizeMode();
+    static void applyQuantizeMode(std::vector<TimelineBlock>& blocks, const LoopRegion& region, double bpm);
     
     /**
      * @brief Determine best fit mode automatically
      */
-    FitMode determineBestFitMode() const;
+    static FitMode determineBestFitMode(const std::vector<TimelineBlock>& blocks, const LoopRegion& region);
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopRegionSync)
 };
@@ -0,0 +1,253 @@
+/**
+ * @file LoudnessMeter.cpp
+ * @brief Implementation of the BS.1770-4 loudness meter
+ */
+
+#include "LoudnessMeter.h"
+
+namespace MAEVN
+{
+
+namespace
+{
+    // Residual filter state below this is flushed so silence stays cheap
+    constexpr double STATE_FLUSH_THRESHOLD = 1.0e-15;
+    
+    void flushState(double& value)
+    {
+        if (std::abs(value) < STATE_FLUSH_THRESHOLD)
+            value = 0.0;
+    }
+}
+
+//==============================================================================
+LoudnessMeter::LoudnessMeter()
+    : subBlockLength(4410)
+    , subBlockPosition(0)
+    , subBlockEnergy(0.0)
+    , subBlockIndex(0)
+    , subBlocksFilled(0)
+    , gatedEnergy(0.0)
+    , gatedCount(0)
+    , relativeGateBin(0)
+    , relativeEnergy(0.0)
+    , relativeCount(0)
+    , momentaryLUFS(MINIMUM_LUFS)
+    , shortTermLUFS(MINIMUM_LUFS)
+    , integratedLUFS(MINIMUM_LUFS)
+{
+    prepare(44100.0, 2);
+}
+
+void LoudnessMeter::prepare(double sampleRate, int numChannels)
+{
+    // K-weighting for any sample rate (BS.1770-4 filters re-derived from
+    // their analog prototypes; matches the 48 kHz table exactly)
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDB = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        
+        const double k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double vh = std::pow(10.0, gainDB / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        
+        preFilter.b0 = (vh + vb * k / q + k * k) / a0;
+        preFilter.b1 = 2.0 * (k * k - vh) / a0;
+        preFilter.b2 = (vh - vb * k / q + k * k) / a0;
+        preFilter.a1 = 2.0 * (k * k - 1.0) / a0;
+        preFilter.a2 = (1.0 - k / q + k * k) / a0;
+    }
+    
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        
+        const double k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+        
+        rlbFilter.b0 = 1.0;
+        rlbFilter.b1 = -2.0;
+        rlbFilter.b2 = 1.0;
+        rlbFilter.a1 = 2.0 * (k * k - 1.0) / a0;
+        rlbFilter.a2 = (1.0 - k / q + k * k) / a0;
+    }
+    
+    subBlockLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+    channels.assign(static_cast<size_t>(juce::jmax(0, numChannels)), {});
+    
+    reset();
+}
+
+void LoudnessMeter::reset()
+{
+    std::fill(channels.begin(), channels.end(), ChannelState{});
+    
+    subBlockPosition = 0;
+    subBlockEnergy = 0.0;
+    subBlocks.fill(0.0);
+    subBlockIndex = 0;
+    subBlocksFilled = 0;
+    
+    binEnergy.fill(0.0);
+    binCount.fill(0);
+    gatedEnergy = 0.0;
+    gatedCount = 0;
+    relativeGateBin = 0;
+    relativeEnergy = 0.0;
+    relativeCount = 0;
+    
+    momentaryLUFS.store(MINIMUM_LUFS, std::memory_order_relaxed);
+    shortTermLUFS.store(MINIMUM_LUFS, std::memory_order_relaxed);
+    integratedLUFS.store(MINIMUM_LUFS, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void LoudnessMeter::process(const juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), static_cast<int>(channels.size()));
+    if (numChannels <= 0)
+        return;
+    
+    const auto pre = preFilter;
+    const auto rlb = rlbFilter;
+    int position = 0;
+    
+    while (position < numSamples)
+    {
+        // Never let a segment straddle a sub-block boundary
+        const int count = juce::jmin(numSamples - position, subBlockLength - subBlockPosition);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* data = buffer.getReadPointer(ch, position);
+            auto& s = channels[static_cast<size_t>(ch)];
+            
+            // Both K-weighting stages and the energy sum in one pass, state in registers
+            double x1 = s.x1, x2 = s.x2, y1 = s.y1, y2 = s.y2, z1 = s.z1, z2 = s.z2;
+            double sum = 0.0;
+            
+            for (int i = 0; i < count; ++i)
+            {
+                const double x = data[i];
+                const double y = pre.b0 * x + pre.b1 * x1 + pre.b2 * x2 - pre.a1 * y1 - pre.a2 * y2;
+                const double z = y - 2.0 * y1 + y2 - rlb.a1 * z1 - rlb.a2 * z2;
+                
+                x2 = x1; x1 = x;
+                y2 = y1; y1 = y;
+                z2 = z1; z1 = z;
+                sum += z * z;
+            }
+            
+            flushState(y1); flushState(y2);
+            flushState(z1); flushState(z2);
+            s = { x1, x2, y1, y2, z1, z2 };
+            
+            subBlockEnergy += sum;
+        }
+        
+        position += count;
+        subBlockPosition += count;
+        
+        if (subBlockPosition >= subBlockLength)
+            finishSubBlock();
+    }
+}
+
+void LoudnessMeter::finishSubBlock()
+{
+    subBlocks[static_cast<size_t>(subBlockIndex)] = subBlockEnergy / static_cast<double>(subBlockLength);
+    subBlockIndex = (subBlockIndex + 1) % SHORT_TERM_SUB_BLOCKS;
+    subBlocksFilled = juce::jmin(subBlocksFilled + 1, SHORT_TERM_SUB_BLOCKS);
+    subBlockEnergy = 0.0;
+    subBlockPosition = 0;
+    
+    // Sum the newest sub-blocks backwards; both windows are a fixed, small size
+    auto sumLatest = [this](int count)
+    {
+        double sum = 0.0;
+        for (int k = 1; k <= count; ++k)
+            sum += subBlocks[static_cast<size_t>((subBlockIndex - k + SHORT_TERM_SUB_BLOCKS) % SHORT_TERM_SUB_BLOCKS)];
+        return sum;
+    };
+    
+    if (subBlocksFilled >= MOMENTARY_SUB_BLOCKS)
+    {
+        // Momentary windows double as the 75 %-overlapped gating blocks
+        const double momentary = sumLatest(MOMENTARY_SUB_BLOCKS) / MOMENTARY_SUB_BLOCKS;
+        momentaryLUFS.store(energyToLUFS(momentary), std::memory_order_relaxed);
+        addGatingBlock(momentary);
+    }
+    
+    if (subBlocksFilled >= SHORT_TERM_SUB_BLOCKS)
+    {
+        const double shortTerm = sumLatest(SHORT_TERM_SUB_BLOCKS) / SHORT_TERM_SUB_BLOCKS;
+        shortTermLUFS.store(energyToLUFS(shortTerm), std::memory_order_relaxed);
+    }
+}
+
+void LoudnessMeter::addGatingBlock(double meanSquare)
+{
+    const float loudness = energyToLUFS(meanSquare);
+    if (loudness <= ABSOLUTE_GATE_LUFS)
+        return;
+    
+    const int bin = getHistogramBin(loudness);
+    binEnergy[static_cast<size_t>(bin)] += meanSquare;
+    ++binCount[static_cast<size_t>(bin)];
+    
+    gatedEnergy += meanSquare;
+    ++gatedCount;
+    
+    if (bin >= relativeGateBin)
+    {
+        relativeEnergy += meanSquare;
+        ++relativeCount;
+    }
+    
+    // The relative gate drifts slowly, so moving it bin by bin is O(1) amortized
+    const int gateBin = getHistogramBin(energyToLUFS(gatedEnergy / gatedCount) + RELATIVE_GATE_LU);
+    
+    while (relativeGateBin < gateBin)
+    {
+        relativeEnergy -= binEnergy[static_cast<size_t>(relativeGateBin)];
+        relativeCount -= binCount[static_cast<size_t>(relativeGateBin)];
+        ++relativeGateBin;
+    }
+    
+    while (relativeGateBin > gateBin)
+    {
+        --relativeGateBin;
+        relativeEnergy += binEnergy[static_cast<size_t>(relativeGateBin)];
+        relativeCount += binCount[static_cast<size_t>(relativeGateBin)];
+    }
+    
+    if (relativeCount > 0)
+        integratedLUFS.store(energyToLUFS(relativeEnergy / relativeCount), std::memory_order_relaxed);
+}
+
+//==============================================================================
+float LoudnessMeter::measureIntegratedLUFS(const juce::AudioBuffer<float>& buffer, double sampleRate)
+{
+    LoudnessMeter meter;
+    meter.prepare(sampleRate, buffer.getNumChannels());
+    meter.process(buffer, buffer.getNumSamples());
+    return meter.getIntegratedLUFS();
+}
+
+float LoudnessMeter::energyToLUFS(double meanSquare)
+{
+    if (meanSquare <= 0.0)
+        return MINIMUM_LUFS;
+    
+    return juce::jmax(MINIMUM_LUFS, static_cast<float>(-0.691 + 10.0 * std::log10(meanSquare)));
+}
+
+int LoudnessMeter::getHistogramBin(float lufs)
+{
+    const int bin = static_cast<int>(std::floor((lufs - ABSOLUTE_GATE_LUFS) / HISTOGRAM_BIN_LU));
+    return juce::jlimit(0, HISTOGRAM_BINS - 1, bin);
+}
+
+} // namespace MAEVN
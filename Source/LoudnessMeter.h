@@ -0,0 +1,135 @@
+/**
+ * @file LoudnessMeter.h
+ * @brief ITU-R BS.1770-4 loudness meter (momentary, short-term, integrated)
+ *
+ * The signal is K-weighted and its energy gathered into 100 ms sub-blocks.
+ * Momentary (400 ms) and short-term (3 s) loudness are read from a ring of
+ * the latest sub-blocks, and integrated loudness is gated incrementally
+ * through a loudness histogram, so the work per sub-block is constant and
+ * the meter runs the same on the audio thread and over a whole render.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Gated loudness meter following BS.1770-4 / EBU R 128
+ *
+ * process() is realtime safe and must be called from one thread; the
+ * getters may be called from any thread. All channels are weighted 1.0,
+ * which is correct for mono and stereo.
+ */
+class LoudnessMeter
+{
+public:
+    /** Reported for silence and before the first window has filled */
+    static constexpr float MINIMUM_LUFS = -100.0f;
+    
+    LoudnessMeter();
+    
+    /**
+     * @brief Design the K-weighting filters and allocate per-channel state
+     */
+    void prepare(double sampleRate, int numChannels);
+    
+    /**
+     * @brief Measure a block (the buffer is not modified)
+     */
+    void process(const juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    /**
+     * @brief Clear the filter state and every measurement
+     */
+    void reset();
+    
+    /** 400 ms window, updated every 100 ms */
+    float getMomentaryLUFS() const { return momentaryLUFS.load(std::memory_order_relaxed); }
+    
+    /** 3 s window, updated every 100 ms */
+    float getShortTermLUFS() const { return shortTermLUFS.load(std::memory_order_relaxed); }
+    
+    /** Gated loudness since the last reset() */
+    float getIntegratedLUFS() const { return integratedLUFS.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Integrated loudness of a complete buffer (e.g. an offline render)
+     */
+    static float measureIntegratedLUFS(const juce::AudioBuffer<float>& buffer, double sampleRate);
+
+private:
+    // Direct form I coefficients and state are kept in double: the RLB
+    // high-pass poles sit very close to the unit circle at high rates
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    };
+    
+    struct ChannelState
+    {
+        double x1 = 0.0, x2 = 0.0;     // pre-filter input history
+        double y1 = 0.0, y2 = 0.0;     // pre-filter output history
+        double z1 = 0.0, z2 = 0.0;     // RLB output history
+    };
+    
+    static constexpr int MOMENTARY_SUB_BLOCKS = 4;     // 400 ms
+    static constexpr int SHORT_TERM_SUB_BLOCKS = 30;   // 3 s
+    
+    // Gating histogram: 0.1 LU bins from the absolute gate up to +10 LUFS
+    static constexpr float ABSOLUTE_GATE_LUFS = -70.0f;
+    static constexpr float RELATIVE_GATE_LU = -10.0f;
+    static constexpr float HISTOGRAM_BIN_LU = 0.1f;
+    static constexpr int HISTOGRAM_BINS = 800;
+    
+    Biquad preFilter;
+    Biquad rlbFilter;
+    std::vector<ChannelState> channels;
+    
+    // Current sub-block
+    int subBlockLength;
+    int subBlockPosition;
+    double subBlockEnergy;
+    
+    // Mean square of the latest sub-blocks, oldest overwritten first
+    std::array<double, SHORT_TERM_SUB_BLOCKS> subBlocks;
+    int subBlockIndex;
+    int subBlocksFilled;
+    
+    // Gating blocks above the absolute gate, binned by loudness
+    std::array<double, HISTOGRAM_BINS> binEnergy;
+    std::array<int, HISTOGRAM_BINS> binCount;
+    double gatedEnergy;     // all blocks above the absolute gate
+    int gatedCount;
+    int relativeGateBin;    // first bin at or above the relative gate
+    double relativeEnergy;  // blocks in bins >= relativeGateBin
+    int relativeCount;
+    
+    std::atomic<float> momentaryLUFS;
+    std::atomic<float> shortTermLUFS;
+    std::atomic<float> integratedLUFS;
+    
+    /**
+     * @brief Close the current sub-block and update every measurement
+     */
+    void finishSubBlock();
+    
+    /**
+     * @brief Add one 400 ms gating block to the integrated measurement
+     */
+    void addGatingBlock(double meanSquare);
+    
+    static float energyToLUFS(double meanSquare);
+    static int getHistogramBin(float lufs);
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoudnessMeter)
+};
+
+} // namespace MAEVN
@@ -0,0 +1,174 @@
+/**
+ * @file Metering.cpp
+ * @brief Implementation of the meter summaries, queue and ballistics
+ */
+
+#include "Metering.h"
+
+namespace MAEVN
+{
+
+namespace
+{
+    float toDecibels(double power, double floorPower, float decibelsPerDecade)
+    {
+        return power > floorPower ? static_cast<float>(decibelsPerDecade * std::log10(power))
+                                  : MeterBlock::SILENCE_DB;
+    }
+}
+
+//==============================================================================
+float measurePeak(const float* data, int numSamples)
+{
+    if (numSamples <= 0)
+        return 0.0f;
+    
+    const auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+    return juce::jmax(-range.getStart(), range.getEnd());
+}
+
+float measureSumOfSquares(const float* data, int numSamples)
+{
+    // Eight independent partial sums, one per SIMD lane, so the loop
+    // vectorises without reassociating a single running sum
+    constexpr int LANES = 8;
+    std::array<float, LANES> partial {};
+    
+    int i = 0;
+    for (; i + LANES <= numSamples; i += LANES)
+        for (int lane = 0; lane < LANES; ++lane)
+            partial[static_cast<size_t>(lane)] += data[i + lane] * data[i + lane];
+    
+    float sum = 0.0f;
+    for (const float lane : partial)
+        sum += lane;
+    
+    for (; i < numSamples; ++i)
+        sum += data[i] * data[i];
+    
+    return sum;
+}
+
+//==============================================================================
+void MeterBlock::measureInput(const juce::AudioBuffer<float>& buffer, int length)
+{
+    inputPeak = 0.0f;
+    float sum = 0.0f;
+    
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        inputPeak = juce::jmax(inputPeak, measurePeak(buffer.getReadPointer(ch), length));
+        sum += measureSumOfSquares(buffer.getReadPointer(ch), length);
+    }
+    
+    const int count = buffer.getNumChannels() * length;
+    inputMeanSquare = count > 0 ? sum / static_cast<float>(count) : 0.0f;
+}
+
+void MeterBlock::measureOutput(const juce::AudioBuffer<float>& buffer, int length)
+{
+    outputPeak = 0.0f;
+    float sum = 0.0f;
+    
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        outputPeak = juce::jmax(outputPeak, measurePeak(buffer.getReadPointer(ch), length));
+        sum += measureSumOfSquares(buffer.getReadPointer(ch), length);
+    }
+    
+    const int count = buffer.getNumChannels() * length;
+    outputMeanSquare = count > 0 ? sum / static_cast<float>(count) : 0.0f;
+}
+
+//==============================================================================
+bool MeterQueue::push(const MeterBlock& block)
+{
+    const juce::uint32 write = writeIndex.load(std::memory_order_relaxed);
+    if (write - readIndex.load(std::memory_order_acquire) >= static_cast<juce::uint32>(CAPACITY))
+        return false;
+    
+    blocks[write & MASK] = block;
+    writeIndex.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+//==============================================================================
+MeterBallistics::MeterBallistics()
+    : momentaryLUFS(MeterBlock::SILENCE_DB)
+    , pitchHz(0.0f)
+    , cpuLoad(0.0f)
+    , qualityTier(0)
+{
+    reset();
+}
+
+void MeterBallistics::reset()
+{
+    input = {};
+    output = {};
+    momentaryLUFS = MeterBlock::SILENCE_DB;
+    pitchHz = 0.0f;
+    gainReductionDB.fill(0.0f);
+    cpuLoad = 0.0f;
+    qualityTier = 0;
+}
+
+void MeterBallistics::process(const MeterBlock& block)
+{
+    if (block.numSamples <= 0 || block.sampleRate <= 0.0)
+        return;
+    
+    const double seconds = block.numSamples / block.sampleRate;
+    
+    input.process(block.inputPeak, block.inputMeanSquare, seconds);
+    output.process(block.outputPeak, block.outputMeanSquare, seconds);
+    
+    // Loudness and pitch carry their own integration already
+    momentaryLUFS = block.momentaryLUFS;
+    pitchHz = block.pitchHz;
+    cpuLoad = block.cpuLoad;
+    qualityTier = block.qualityTier;
+    
+    const float recovery = PEAK_FALL_DB_PER_SECOND * static_cast<float>(seconds);
+    for (size_t stage = 0; stage < gainReductionDB.size(); ++stage)
+    {
+        const float reduction = block.gainReductionDB[stage];
+        gainReductionDB[stage] = reduction <= gainReductionDB[stage] ? reduction
+                                                                     : juce::jmin(reduction, gainReductionDB[stage] + recovery);
+    }
+}
+
+float MeterBallistics::getGainReductionDB(int stage) const
+{
+    return juce::isPositiveAndBelow(stage, MeterBlock::MAX_STAGES) ? gainReductionDB[static_cast<size_t>(stage)] : 0.0f;
+}
+
+//==============================================================================
+void MeterBallistics::Channel::process(float peak, float blockMeanSquare, double seconds)
+{
+    const float blockPeakDB = toDecibels(peak, 1.0e-5, 20.0f);
+    
+    if (blockPeakDB >= peakDB)
+    {
+        peakDB = blockPeakDB;
+        holdRemaining = PEAK_HOLD_SECONDS;
+    }
+    else if (holdRemaining > 0.0)
+    {
+        holdRemaining -= seconds;
+    }
+    else
+    {
+        peakDB = juce::jmax(blockPeakDB, peakDB - PEAK_FALL_DB_PER_SECOND * static_cast<float>(seconds));
+    }
+    
+    const double coefficient = std::exp(-seconds / RMS_SECONDS);
+    meanSquare = blockMeanSquare + coefficient * (meanSquare - blockMeanSquare);
+}
+
+float MeterBallistics::Channel::rmsDB() const
+{
+    return toDecibels(meanSquare, 1.0e-10, 10.0f);
+}
+
+} // namespace MAEVN
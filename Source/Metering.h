@@ -0,0 +1,182 @@
+/**
+ * @file Metering.h
+ * @brief Per-block meter summaries handed from the audio thread to the UI
+ *
+ * The audio thread measures each block once (peak and sum of squares in
+ * vectorised passes, plus whatever loudness and gain reduction its stages
+ * already track) and pushes a fixed-size MeterBlock into a single-producer,
+ * single-consumer ring. The editor's timer drains the ring and runs the
+ * meter ballistics, which are the only time-dependent part and so cost the
+ * audio thread nothing.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Largest magnitude in a run of samples
+ */
+float measurePeak(const float* data, int numSamples);
+
+/**
+ * @brief Sum of squares of a run of samples
+ */
+float measureSumOfSquares(const float* data, int numSamples);
+
+//==============================================================================
+/**
+ * @brief What a processor measured over one audio block
+ */
+struct MeterBlock
+{
+    static constexpr int MAX_STAGES = 4;
+    static constexpr float SILENCE_DB = -100.0f;
+    
+    int numSamples = 0;
+    double sampleRate = 44100.0;
+    
+    // Linear, across all channels
+    float inputPeak = 0.0f;
+    float inputMeanSquare = 0.0f;
+    float outputPeak = 0.0f;
+    float outputMeanSquare = 0.0f;
+    
+    float momentaryLUFS = SILENCE_DB;
+    float pitchHz = 0.0f;
+    
+    // Deepest reduction of each stage during the block, in dB (0 or negative)
+    std::array<float, MAX_STAGES> gainReductionDB {};
+    
+    // CPU governor: smoothed share of the block's deadline and the quality tier run
+    float cpuLoad = 0.0f;
+    int qualityTier = 0;
+    
+    /**
+     * @brief Fill inputPeak and inputMeanSquare from the first numSamples
+     */
+    void measureInput(const juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    /**
+     * @brief Fill outputPeak and outputMeanSquare from the first numSamples
+     */
+    void measureOutput(const juce::AudioBuffer<float>& buffer, int numSamples);
+};
+
+//==============================================================================
+/**
+ * @brief Wait-free ring of meter blocks from the audio thread to the UI
+ *
+ * push() is called by the audio thread only and drops the block when the UI
+ * has fallen CAPACITY blocks behind (e.g. while the editor is closed);
+ * popAll() is called by one UI thread only.
+ */
+class MeterQueue
+{
+public:
+    static constexpr int CAPACITY = 256;
+    
+    MeterQueue() = default;
+    
+    /**
+     * @brief Append a block (audio thread)
+     * @return false if the ring was full and the block was dropped
+     */
+    bool push(const MeterBlock& block);
+    
+    /**
+     * @brief Hand every waiting block, oldest first, to consumer (UI thread)
+     * @return Number of blocks consumed
+     */
+    template <typename Consumer>
+    int popAll(Consumer&& consumer)
+    {
+        const juce::uint32 write = writeIndex.load(std::memory_order_acquire);
+        juce::uint32 read = readIndex.load(std::memory_order_relaxed);
+        int count = 0;
+        
+        for (; read != write; ++read, ++count)
+            consumer(blocks[read & MASK]);
+        
+        readIndex.store(read, std::memory_order_release);
+        return count;
+    }
+
+private:
+    static constexpr juce::uint32 MASK = CAPACITY - 1;
+    static_assert((CAPACITY & MASK) == 0, "CAPACITY must be a power of two");
+    
+    std::array<MeterBlock, CAPACITY> blocks;
+    std::atomic<juce::uint32> writeIndex { 0 };
+    std::atomic<juce::uint32> readIndex { 0 };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MeterQueue)
+};
+
+//==============================================================================
+/**
+ * @brief Meter ballistics driven by drained meter blocks (UI thread)
+ *
+ * Peaks attack instantly, hold for PEAK_HOLD_SECONDS and then fall at
+ * PEAK_FALL_DB_PER_SECOND; RMS is integrated over RMS_SECONDS; gain
+ * reduction attacks instantly and recovers at the peak fall rate. Time
+ * advances by each block's length, so the meters move at the same speed
+ * whatever the timer rate or block size.
+ */
+class MeterBallistics
+{
+public:
+    static constexpr double PEAK_HOLD_SECONDS = 1.0;
+    static constexpr float PEAK_FALL_DB_PER_SECOND = 20.0f;
+    static constexpr double RMS_SECONDS = 0.3;
+    
+    MeterBallistics();
+    
+    /**
+     * @brief Advance the meters by one block
+     */
+    void process(const MeterBlock& block);
+    
+    /**
+     * @brief Drop every meter to silence
+     */
+    void reset();
+    
+    float getInputPeakDB() const { return input.peakDB; }
+    float getInputRMSDB() const { return input.rmsDB(); }
+    float getOutputPeakDB() const { return output.peakDB; }
+    float getOutputRMSDB() const { return output.rmsDB(); }
+    float getMomentaryLUFS() const { return momentaryLUFS; }
+    float getPitchHz() const { return pitchHz; }
+    float getGainReductionDB(int stage) const;
+    float getCPULoad() const { return cpuLoad; }
+    int getQualityTier() const { return qualityTier; }
+
+private:
+    struct Channel
+    {
+        float peakDB = MeterBlock::SILENCE_DB;
+        double holdRemaining = 0.0;
+        double meanSquare = 0.0;
+        
+        void process(float peak, float blockMeanSquare, double seconds);
+        float rmsDB() const;
+    };
+    
+    Channel input;
+    Channel output;
+    float momentaryLUFS;
+    float pitchHz;
+    std::array<float, MeterBlock::MAX_STAGES> gainReductionDB;
+    float cpuLoad;
+    int qualityTier;
+};
+
+} // namespace MAEVN
@@ -4,16 +4,176 @@
  */
 
 #include "ModelMarketplace.h"
+#include "OnnxEngine.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
 
 namespace MAEVN
 {
 
+namespace
+{
+    constexpr int READ_SIZE = 64 * 1024;
+    
+    //==============================================================================
+    /**
+     * @brief SHA-256 that can be fed piecewise and saved between blocks
+     * 
+     * juce::SHA256 only hashes a whole stream at once; a download needs to
+     * hash chunks as they arrive and resume the hash in a later session.
+     */
+    class StreamingSHA256
+    {
+    public:
+        StreamingSHA256() { reset(); }
+        
+        void reset()
+        {
+            state = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+            numBytes = 0;
+            blockUsed = 0;
+        }
+        
+        void update(const void* data, size_t size)
+        {
+            const auto* bytes = static_cast<const juce::uint8*>(data);
+            numBytes += size;
+            
+            if (blockUsed > 0)
+            {
+                const size_t n = std::min(size, block.size() - blockUsed);
+                std::memcpy(block.data() + blockUsed, bytes, n);
+                blockUsed += n;
+                bytes += n;
+                size -= n;
+                
+                if (blockUsed < block.size())
+                    return;
+                
+                processBlock(block.data());
+                blockUsed = 0;
+            }
+            
+            for (; size >= block.size(); bytes += block.size(), size -= block.size())
+                processBlock(bytes);
+            
+            std::memcpy(block.data(), bytes, size);
+            blockUsed = size;
+        }
+        
+        /**
+         * @brief Pad, finish and return the digest as lowercase hex
+         */
+        juce::String finish()
+        {
+            const juce::uint64 bitLength = numBytes * 8;
+            const juce::uint8 padding[64] = { 0x80 };
+            juce::uint8 lengthBytes[8];
+            
+            for (int i = 0; i < 8; ++i)
+                lengthBytes[i] = static_cast<juce::uint8>(bitLength >> (56 - 8 * i));
+            
+            update(padding, (blockUsed < 56 ? 56 : 120) - blockUsed);
+            update(lengthBytes, sizeof(lengthBytes));
+            
+            juce::String digest;
+            for (auto word : state)
+                digest << juce::String::toHexString(static_cast<int>(word)).paddedLeft('0', 8);
+            
+            return digest;
+        }
+        
+        /**
+         * @brief Get the state to persist (empty unless at a block boundary)
+         */
+        juce::String getState() const
+        {
+            if (blockUsed != 0)
+                return {};
+            
+            juce::StringArray words;
+            for (auto word : state)
+                words.add(juce::String::toHexString(static_cast<int>(word)));
+            
+            return words.joinIntoString(" ") + ":" + juce::String(static_cast<juce::int64>(numBytes));
+        }
+        
+        bool setState(const juce::String& savedState)
+        {
+            const auto words = juce::StringArray::fromTokens(savedState.upToFirstOccurrenceOf(":", false, false), " ", "");
+            const auto bytes = savedState.fromFirstOccurrenceOf(":", false, false).getLargeIntValue();
+            
+            if (words.size() != static_cast<int>(state.size()) || bytes <= 0 || bytes % 64 != 0)
+                return false;
+            
+            for (size_t i = 0; i < state.size(); ++i)
+                state[i] = static_cast<juce::uint32>(words[static_cast<int>(i)].getHexValue32());
+            
+            numBytes = static_cast<juce::uint64>(bytes);
+            blockUsed = 0;
+            return true;
+        }
+        
+    private:
+        std::array<juce::uint32, 8> state;
+        std::array<juce::uint8, 64> block;
+        size_t blockUsed;
+        juce::uint64 numBytes;
+        
+        static juce::uint32 rotateRight(juce::uint32 x, int n) { return (x >> n) | (x << (32 - n)); }
+        
+        void processBlock(const juce::uint8* data)
+        {
+            static constexpr juce::uint32 K[64] = {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+            };
+            
+            juce::uint32 w[64];
+            for (int i = 0; i < 16; ++i)
+                w[i] = juce::ByteOrder::bigEndianInt(data + 4 * i);
+            
+            for (int i = 16; i < 64; ++i)
+            {
+                const auto s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                const auto s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+            
+            auto a = state[0], b = state[1], c = state[2], d = state[3];
+            auto e = state[4], f = state[5], g = state[6], h = state[7];
+            
+            for (int i = 0; i < 64; ++i)
+            {
+                const auto t1 = h + (rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25))
+                                  + ((e & f) ^ (~e & g)) + K[i] + w[i];
+                const auto t2 = (rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22))
+                                  + ((a & b) ^ (a & c) ^ (b & c));
+                h = g; g = f; f = e; e = d + t1;
+                d = c; c = b; b = a; a = t1 + t2;
+            }
+            
+            state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+            state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        }
+    };
+}
+
 //==============================================================================
 // ModelMarketplace Implementation
 //==============================================================================
 
 ModelMarketplace::ModelMarketplace()
     : connected(false)
+    , onnxEngine(nullptr)
     , downloadPool(2) // 2 concurrent downloads max
 {
     modelsDirectory = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
@@ -183,16 +343,13 @@ void ModelMarketplace::cancelDownload(const juce::String& modelId)
 {
     const juce::ScopedLock sl(marketplaceLock);
     
-    // Remove from active downloads
+    // The download task sees the flag, stops its connections and removes the entry
     auto it = activeDownloads.find(modelId);
     if (it != activeDownloads.end())
     {
         it->second.hasFailed = true;
         it->second.errorMessage = "Cancelled by user";
-        activeDownloads.erase(it);
     }
-    
-    // Note: In real implementation, would also signal the download thread to stop
 }
 
 DownloadProgress ModelMarketplace::getDownloadProgress(const juce::String& modelId) const
@@ -272,6 +429,12 @@ void ModelMarketplace::setModelsDirectory(const juce::File& directory)
     modelsDirectory.createDirectory();
 }
 
+void ModelMarketplace::setOnnxEngine(OnnxEngine* engine)
+{
+    const juce::ScopedLock sl(marketplaceLock);
+    onnxEngine = engine;
+}
+
 void ModelMarketplace::submitRating(const juce::String& modelId, int rating, 
                                     const juce::String& review)
 {
@@ -439,6 +602,7 @@ std::vector<MarketplaceModelInfo> ModelMarketplace::generateSampleCatalog()
         model.isVerified = true;
         model.requiresGPU = false;
         model.license = "MIT";
+        model.modelRole = "vocal_tts";
         models.push_back(model);
     }
     
@@ -502,6 +666,7 @@ std::vector<MarketplaceModelInfo> ModelMarketplace::generateSampleCatalog()
         model.isVerified = true;
         model.requiresGPU = true;
         model.license = "MIT";
+        model.modelRole = "vocal_hifigan";
         models.push_back(model);
     }
     
@@ -526,6 +691,9 @@ std::vector<MarketplaceModelInfo> ModelMarketplace::generateSampleCatalog()
         models.push_back(model);
     }
     
+    for (auto& model : models)
+        model.downloadUrl = apiEndpoint + "/models/" + model.id + "/file";
+    
     return models;
 }
 
@@ -533,6 +701,159 @@ std::vector<MarketplaceModelInfo> ModelMarketplace::generateSampleCatalog()
 // DownloadTask Implementation
 //==============================================================================
 
+/**
+ * @brief Shared state of one download's connections (members under lock)
+ */
+struct ModelMarketplace::DownloadTask::Transfer
+{
+    // Out-of-order chunks kept in memory for the hash; later ones are re-read from the file
+    static constexpr size_t MAX_UNHASHED_CHUNKS = 2 * NUM_CONNECTIONS;
+    
+    juce::File partFile;
+    juce::File stateFile;
+    juce::int64 totalBytes = 0;
+    int numChunks = 0;
+    
+    juce::CriticalSection lock;
+    std::unique_ptr<juce::FileOutputStream> output;
+    std::vector<bool> chunkDone;
+    int nextChunk = 0;                                  // Where the next claim starts looking
+    int numHashed = 0;                                  // Chunks [0, numHashed) are in the hash
+    std::map<int, juce::MemoryBlock> unhashedChunks;
+    StreamingSHA256 hash;
+    juce::int64 bytesDone = 0;
+    bool failed = false;
+    juce::String error;
+    
+    void setTotalBytes(juce::int64 bytes)
+    {
+        totalBytes = bytes;
+        numChunks = static_cast<int>((bytes + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        chunkDone.assign(static_cast<size_t>(numChunks), false);
+    }
+    
+    juce::int64 getChunkLength(int chunk) const
+    {
+        return juce::jmin(CHUNK_SIZE, totalBytes - chunk * CHUNK_SIZE);
+    }
+    
+    /**
+     * @brief Claim the next chunk that is neither done nor claimed (-1 = none left)
+     */
+    int claimChunk()
+    {
+        while (nextChunk < numChunks && chunkDone[static_cast<size_t>(nextChunk)])
+            ++nextChunk;
+        
+        return nextChunk < numChunks ? nextChunk++ : -1;
+    }
+    
+    /**
+     * @brief Hash the written chunks that follow the hashed prefix
+     */
+    bool advanceHash()
+    {
+        while (numHashed < numChunks && chunkDone[static_cast<size_t>(numHashed)])
+        {
+            auto it = unhashedChunks.find(numHashed);
+            if (it != unhashedChunks.end())
+            {
+                hash.update(it->second.getData(), it->second.getSize());
+                unhashedChunks.erase(it);
+            }
+            else if (!hashFromFile(numHashed))
+            {
+                return false;
+            }
+            
+            ++numHashed;
+        }
+        
+        return true;
+    }
+    
+    bool hashFromFile(int chunk)
+    {
+        if (output != nullptr)
+            output->flush();
+        
+        juce::FileInputStream input(partFile);
+        if (!input.openedOk() || !input.setPosition(chunk * CHUNK_SIZE))
+            return false;
+        
+        juce::HeapBlock<char> buffer(READ_SIZE);
+        for (auto remaining = getChunkLength(chunk); remaining > 0;)
+        {
+            const int numRead = input.read(buffer, static_cast<int>(juce::jmin<juce::int64>(READ_SIZE, remaining)));
+            if (numRead <= 0)
+                return false;
+            
+            hash.update(buffer, static_cast<size_t>(numRead));
+            remaining -= numRead;
+        }
+        
+        return true;
+    }
+    
+    /**
+     * @brief Restore a previous session's progress (false = start over)
+     */
+    bool load(const juce::String& url)
+    {
+        if (!partFile.existsAsFile() || !stateFile.existsAsFile())
+            return false;
+        
+        const auto json = juce::JSON::parse(stateFile);
+        const auto chunks = json["chunks"].toString();
+        
+        if (json["url"].toString() != url
+            || static_cast<juce::int64>(json["chunkSize"]) != CHUNK_SIZE
+            || static_cast<juce::int64>(json["totalBytes"]) <= 0)
+            return false;
+        
+        setTotalBytes(static_cast<juce::int64>(json["totalBytes"]));
+        if (chunks.length() != numChunks)
+            return false;
+        
+        for (int i = 0; i < numChunks; ++i)
+        {
+            chunkDone[static_cast<size_t>(i)] = chunks[i] == '1';
+            if (chunkDone[static_cast<size_t>(i)])
+                bytesDone += getChunkLength(i);
+        }
+        
+        // A hash state that does not cover a done prefix is rebuilt from the file
+        numHashed = static_cast<int>(json["hashedChunks"]);
+        if (numHashed <= 0 || numHashed > numChunks
+            || std::find(chunkDone.begin(), chunkDone.begin() + numHashed, false) != chunkDone.begin() + numHashed
+            || !hash.setState(json["hashState"].toString())
+            || hash.getState().fromFirstOccurrenceOf(":", false, false).getLargeIntValue() != numHashed * CHUNK_SIZE)
+        {
+            numHashed = 0;
+            hash.reset();
+        }
+        
+        return true;
+    }
+    
+    void save(const juce::String& url) const
+    {
+        juce::String chunks;
+        for (bool done : chunkDone)
+            chunks << (done ? '1' : '0');
+        
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty("url", url);
+        obj->setProperty("totalBytes", totalBytes);
+        obj->setProperty("chunkSize", CHUNK_SIZE);
+        obj->setProperty("chunks", chunks);
+        obj->setProperty("hashedChunks", numHashed);
+        obj->setProperty("hashState", hash.getState());
+        
+        stateFile.replaceWithText(juce::JSON::toString(juce::var(obj), true));
+    }
+};
+
 ModelMarketplace::DownloadTask::DownloadTask(ModelMarketplace& owner, 
                                               const MarketplaceModelInfo& model,
                                               const juce::File& destDir)
@@ -545,58 +866,403 @@ ModelMarketplace::DownloadTask::DownloadTask(ModelMarketplace& owner,
 
 juce::ThreadPoolJob::JobStatus ModelMarketplace::DownloadTask::runJob()
 {
-    // Simulate download with progress updates
-    const int numSteps = 20;
-    size_t bytesPerStep = modelInfo.fileSize / numSteps;
+    if (modelInfo.downloadUrl.isEmpty())
+    {
+        fail("Model has no download URL");
+        return jobHasFinished;
+    }
     
-    for (int i = 0; i <= numSteps; ++i)
+    if (destinationDir.createDirectory().failed())
     {
-        if (shouldExit())
+        fail("Could not create " + destinationDir.getFullPathName());
+        return jobHasFinished;
+    }
+    
+    Transfer transfer;
+    transfer.partFile = destinationDir.getChildFile(modelInfo.id + ".onnx.part");
+    transfer.stateFile = destinationDir.getChildFile(modelInfo.id + ".onnx.part.json");
+    
+    std::unique_ptr<juce::InputStream> firstChunk;
+    
+    if (transfer.load(modelInfo.downloadUrl))
+    {
+        Logger::log(Logger::Level::Info, "Resuming download of " + modelInfo.name + " at "
+                    + ModelMarketplace::formatFileSize(static_cast<size_t>(transfer.bytesDone)));
+    }
+    else
+    {
+        transfer.partFile.deleteFile();
+        transfer.stateFile.deleteFile();
+        
+        // The first chunk's request doubles as the probe for range support and size
+        int statusCode = 0;
+        juce::StringPairArray headers;
+        firstChunk = openRange(0, CHUNK_SIZE - 1, statusCode, &headers);
+        
+        if (firstChunk == nullptr)
         {
+            fail("Could not connect to " + modelInfo.downloadUrl);
             return jobHasFinished;
         }
         
-        // Update progress
+        if (statusCode == 200)
         {
-            const juce::ScopedLock sl(marketplace.marketplaceLock);
-            auto& progress = marketplace.activeDownloads[modelInfo.id];
-            progress.bytesDownloaded = i * bytesPerStep;
-            progress.progress = static_cast<float>(i) / static_cast<float>(numSteps);
-            progress.status = "Downloading... " + 
-                             ModelMarketplace::formatFileSize(progress.bytesDownloaded) + " / " +
-                             ModelMarketplace::formatFileSize(modelInfo.fileSize);
+            transfer.output = std::make_unique<juce::FileOutputStream>(transfer.partFile);
+            
+            if (!transfer.output->openedOk() || !downloadWhole(transfer, *firstChunk))
+            {
+                transfer.output.reset();
+                transfer.partFile.deleteFile();
+                fail(isCancelled() ? "Cancelled by user" : transfer.error);
+                return jobHasFinished;
+            }
             
-            marketplace.notifyDownloadProgress(progress);
+            transfer.output.reset();
+            completeDownload(transfer);
+            return jobHasFinished;
         }
         
-        // Simulate download time
-        juce::Thread::sleep(100);
+        const auto totalBytes = headers.getValue("Content-Range", {})
+                                    .fromLastOccurrenceOf("/", false, false).getLargeIntValue();
+        
+        if (statusCode != 206 || totalBytes <= 0)
+        {
+            fail("Server returned HTTP " + juce::String(statusCode));
+            return jobHasFinished;
+        }
+        
+        transfer.setTotalBytes(totalBytes);
     }
     
-    // Create placeholder file (in real implementation, would save actual downloaded data)
-    juce::File destFile = destinationDir.getChildFile(modelInfo.id + ".onnx");
-    destFile.create();
-    destFile.replaceWithText("# Placeholder for " + modelInfo.name + "\n# Size: " + 
-                            ModelMarketplace::formatFileSize(modelInfo.fileSize));
+    transfer.output = std::make_unique<juce::FileOutputStream>(transfer.partFile);
+    if (!transfer.output->openedOk())
+    {
+        fail("Could not write " + transfer.partFile.getFullPathName());
+        return jobHasFinished;
+    }
+    
+    if (!transfer.advanceHash())
+    {
+        transfer.failed = true;
+        transfer.error = "Could not read " + transfer.partFile.getFullPathName();
+    }
+    
+    updateProgress(transfer.bytesDone, transfer.totalBytes);
+    
+    {
+        juce::ThreadPool connections(NUM_CONNECTIONS - 1);
+        
+        // The probe's response is chunk 0; the other connections start on the chunks after it
+        if (firstChunk != nullptr)
+            transfer.nextChunk = 1;
+        
+        for (int i = 1; i < NUM_CONNECTIONS; ++i)
+            connections.addJob([this, &transfer] { downloadChunks(transfer); });
+        
+        if (firstChunk != nullptr)
+        {
+            juce::MemoryBlock data;
+            bool received = readStream(*firstChunk, transfer.getChunkLength(0), data);
+            firstChunk.reset();
+            
+            // Retried on a fresh request like any other chunk
+            if (!received)
+                received = fetchChunk(transfer, 0, data);
+            
+            if (received)
+            {
+                commitChunk(transfer, 0, std::move(data));
+            }
+            else if (!isCancelled())
+            {
+                const juce::ScopedLock sl(transfer.lock);
+                transfer.failed = true;
+                transfer.error = "Chunk 1 of " + juce::String(transfer.numChunks) + " failed to download";
+            }
+        }
+        
+        downloadChunks(transfer);
+        connections.removeAllJobs(false, -1);
+    }
+    
+    transfer.output.reset();
+    
+    // The part and state files stay behind for the next attempt to resume
+    if (isCancelled())
+    {
+        fail("Cancelled by user");
+        return jobHasFinished;
+    }
+    
+    if (transfer.failed)
+    {
+        fail(transfer.error);
+        return jobHasFinished;
+    }
+    
+    completeDownload(transfer);
+    return jobHasFinished;
+}
+
+std::unique_ptr<juce::InputStream> ModelMarketplace::DownloadTask::openRange(juce::int64 start, juce::int64 end,
+                                                                            int& statusCode,
+                                                                            juce::StringPairArray* headers) const
+{
+    const auto options = juce::URL::InputStreamOptions(juce::URL::ParameterHandling::inAddress)
+                             .withExtraHeaders("Range: bytes=" + juce::String(start) + "-" + juce::String(end))
+                             .withConnectionTimeoutMs(CONNECTION_TIMEOUT_MS)
+                             .withStatusCode(&statusCode)
+                             .withResponseHeaders(headers);
+    
+    return juce::URL(modelInfo.downloadUrl).createInputStream(options);
+}
+
+void ModelMarketplace::DownloadTask::downloadChunks(Transfer& transfer)
+{
+    while (!isCancelled())
+    {
+        int chunk;
+        {
+            const juce::ScopedLock sl(transfer.lock);
+            if (transfer.failed)
+                return;
+            
+            chunk = transfer.claimChunk();
+        }
+        
+        if (chunk < 0)
+            return;
+        
+        juce::MemoryBlock data;
+        if (!fetchChunk(transfer, chunk, data))
+        {
+            const juce::ScopedLock sl(transfer.lock);
+            if (!transfer.failed && !isCancelled())
+            {
+                transfer.failed = true;
+                transfer.error = "Chunk " + juce::String(chunk + 1) + " of "
+                               + juce::String(transfer.numChunks) + " failed to download";
+            }
+            return;
+        }
+        
+        if (!commitChunk(transfer, chunk, std::move(data)))
+            return;
+    }
+}
+
+bool ModelMarketplace::DownloadTask::fetchChunk(Transfer& transfer, int chunk, juce::MemoryBlock& data)
+{
+    const auto start = chunk * CHUNK_SIZE;
+    const auto length = transfer.getChunkLength(chunk);
+    
+    for (int attempt = 1; attempt <= MAX_ATTEMPTS && !isCancelled(); ++attempt)
+    {
+        int statusCode = 0;
+        auto stream = openRange(start, start + length - 1, statusCode, nullptr);
+        
+        if (stream != nullptr && statusCode == 206 && readStream(*stream, length, data))
+            return true;
+        
+        Logger::log(Logger::Level::Warning, "Chunk " + juce::String(chunk + 1) + " of " + modelInfo.name
+                    + " failed (attempt " + juce::String(attempt) + ")");
+        
+        juce::Thread::sleep(500 * attempt);
+    }
+    
+    return false;
+}
+
+bool ModelMarketplace::DownloadTask::readStream(juce::InputStream& stream, juce::int64 length,
+                                                juce::MemoryBlock& data) const
+{
+    data.setSize(static_cast<size_t>(length));
+    auto* dest = static_cast<char*>(data.getData());
+    
+    for (juce::int64 position = 0; position < length;)
+    {
+        if (isCancelled())
+            return false;
+        
+        const int numRead = stream.read(dest + position, static_cast<int>(juce::jmin<juce::int64>(READ_SIZE, length - position)));
+        if (numRead <= 0)
+            return false;
+        
+        position += numRead;
+    }
+    
+    return true;
+}
+
+bool ModelMarketplace::DownloadTask::commitChunk(Transfer& transfer, int chunk, juce::MemoryBlock&& data)
+{
+    const juce::ScopedLock sl(transfer.lock);
+    
+    if (transfer.failed)
+        return false;
+    
+    if (transfer.chunkDone[static_cast<size_t>(chunk)])
+        return true;
+    
+    // Flushed before the state file records the chunk as done
+    auto& output = *transfer.output;
+    if (!output.setPosition(chunk * CHUNK_SIZE) || !output.write(data.getData(), data.getSize()))
+    {
+        transfer.failed = true;
+        transfer.error = "Could not write " + transfer.partFile.getFullPathName();
+        return false;
+    }
+    output.flush();
+    
+    transfer.chunkDone[static_cast<size_t>(chunk)] = true;
+    transfer.bytesDone += static_cast<juce::int64>(data.getSize());
+    
+    if (chunk == transfer.numHashed)
+    {
+        transfer.hash.update(data.getData(), data.getSize());
+        ++transfer.numHashed;
+    }
+    else if (transfer.unhashedChunks.size() < Transfer::MAX_UNHASHED_CHUNKS)
+    {
+        transfer.unhashedChunks.emplace(chunk, std::move(data));
+    }
+    
+    if (!transfer.advanceHash())
+    {
+        transfer.failed = true;
+        transfer.error = "Could not read " + transfer.partFile.getFullPathName();
+        return false;
+    }
+    
+    transfer.save(modelInfo.downloadUrl);
+    updateProgress(transfer.bytesDone, transfer.totalBytes);
+    return true;
+}
+
+bool ModelMarketplace::DownloadTask::downloadWhole(Transfer& transfer, juce::InputStream& stream)
+{
+    Logger::log(Logger::Level::Info, "Server does not support range requests; downloading "
+                + modelInfo.name + " in one stream");
+    
+    const auto totalBytes = juce::jmax(stream.getTotalLength(), static_cast<juce::int64>(modelInfo.fileSize));
+    juce::HeapBlock<char> buffer(READ_SIZE);
+    juce::int64 lastReported = 0;
+    
+    while (!stream.isExhausted())
+    {
+        if (isCancelled())
+            return false;
+        
+        const int numRead = stream.read(buffer, READ_SIZE);
+        if (numRead <= 0)
+            break;
+        
+        if (!transfer.output->write(buffer, static_cast<size_t>(numRead)))
+        {
+            transfer.error = "Could not write " + transfer.partFile.getFullPathName();
+            return false;
+        }
+        
+        transfer.hash.update(buffer, static_cast<size_t>(numRead));
+        transfer.bytesDone += numRead;
+        
+        if (transfer.bytesDone - lastReported >= CHUNK_SIZE)
+        {
+            updateProgress(transfer.bytesDone, totalBytes);
+            lastReported = transfer.bytesDone;
+        }
+    }
+    
+    if (stream.getTotalLength() >= 0 && transfer.bytesDone != stream.getTotalLength())
+    {
+        transfer.error = "Connection closed before the download finished";
+        return false;
+    }
+    
+    return true;
+}
+
+void ModelMarketplace::DownloadTask::completeDownload(Transfer& transfer)
+{
+    const auto digest = transfer.hash.finish();
+    
+    if (modelInfo.sha256.isNotEmpty() && !digest.equalsIgnoreCase(modelInfo.sha256.trim()))
+    {
+        transfer.partFile.deleteFile();
+        transfer.stateFile.deleteFile();
+        fail("Checksum mismatch (expected " + modelInfo.sha256 + ", got " + digest + ")");
+        return;
+    }
+    
+    // A rename, so the model never appears under its final name half-written
+    const juce::File destFile = destinationDir.getChildFile(modelInfo.id + ".onnx");
+    if (!transfer.partFile.replaceFileIn(destFile))
+    {
+        fail("Could not move the download to " + destFile.getFullPathName());
+        return;
+    }
+    transfer.stateFile.deleteFile();
     
     // Mark as complete
+    OnnxEngine* engine = nullptr;
     {
         const juce::ScopedLock sl(marketplace.marketplaceLock);
-        auto& progress = marketplace.activeDownloads[modelInfo.id];
-        progress.isComplete = true;
-        progress.progress = 1.0f;
-        progress.status = "Complete";
         
         marketplace.installedModels[modelInfo.id] = destFile;
         marketplace.saveInstalledModels();
         marketplace.activeDownloads.erase(modelInfo.id);
+        engine = marketplace.onnxEngine;
     }
     
+    if (engine != nullptr && modelInfo.modelRole.isNotEmpty())
+        engine->loadModelAsync(modelInfo.modelRole, destFile.getFullPathName());
+    
     marketplace.notifyDownloadComplete(modelInfo.id, destFile);
     
-    Logger::log(Logger::Level::Info, "Downloaded model: " + modelInfo.name);
+    Logger::log(Logger::Level::Info, "Downloaded model: " + modelInfo.name + " (sha256 " + digest + ")");
+}
+
+bool ModelMarketplace::DownloadTask::isCancelled() const
+{
+    if (shouldExit())
+        return true;
+    
+    const juce::ScopedLock sl(marketplace.marketplaceLock);
+    auto it = marketplace.activeDownloads.find(modelInfo.id);
+    return it == marketplace.activeDownloads.end() || it->second.hasFailed;
+}
+
+void ModelMarketplace::DownloadTask::updateProgress(juce::int64 bytesDownloaded, juce::int64 totalBytes)
+{
+    const juce::ScopedLock sl(marketplace.marketplaceLock);
     
-    return jobHasFinished;
+    auto it = marketplace.activeDownloads.find(modelInfo.id);
+    if (it == marketplace.activeDownloads.end())
+        return;
+    
+    auto& progress = it->second;
+    progress.bytesDownloaded = static_cast<size_t>(bytesDownloaded);
+    progress.totalBytes = static_cast<size_t>(totalBytes);
+    progress.progress = totalBytes > 0 ? static_cast<float>(bytesDownloaded) / static_cast<float>(totalBytes) : 0.0f;
+    progress.status = "Downloading... " + 
+                     ModelMarketplace::formatFileSize(progress.bytesDownloaded) + " / " +
+                     ModelMarketplace::formatFileSize(progress.totalBytes);
+    
+    marketplace.notifyDownloadProgress(progress);
+}
+
+void ModelMarketplace::DownloadTask::fail(const juce::String& error)
+{
+    Logger::log(Logger::Level::Warning, "Download of " + modelInfo.name + " failed: " + error);
+    
+    {
+        const juce::ScopedLock sl(marketplace.marketplaceLock);
+        marketplace.activeDownloads.erase(modelInfo.id);
+    }
+    
+    // Listeners may already be gone while the marketplace shuts down
+    if (!shouldExit())
+        marketplace.notifyDownloadFailed(modelInfo.id, error);
 }
 
 //==============================================================================
@@ -4,6 +4,13 @@
  * 
  * This module provides infrastructure for discovering, downloading, and
  * managing community-shared ONNX models from an online marketplace.
+ * 
+ * Downloads fetch a model in fixed-size HTTP range chunks over several
+ * connections at once. Each download persists a small state file beside
+ * its partial file, so an interrupted download resumes with the chunks it
+ * is missing. The SHA-256 of the file is computed as the chunks arrive,
+ * and the finished file is renamed into place and handed to the
+ * OnnxEngine.
  */
 
 #pragma once
@@ -17,6 +24,8 @@
 namespace MAEVN
 {
 
+class OnnxEngine;
+
 //==============================================================================
 /**
  * @brief Model category types
@@ -50,6 +59,8 @@ struct MarketplaceModelInfo
     juce::String downloadUrl;       ///< URL to download model
     juce::String thumbnailUrl;      ///< URL to thumbnail image
     juce::String documentationUrl;  ///< URL to documentation
+    juce::String sha256;            ///< Expected SHA-256 of the file, hex (empty = not checked)
+    juce::String modelRole;         ///< OnnxEngine role the model fills (empty = none)
     
     size_t fileSize;                ///< Model file size in bytes
     juce::Time uploadDate;          ///< Upload date
@@ -224,6 +235,10 @@ public:
     
     /**
      * @brief Cancel an active download
+     * 
+     * The chunks downloaded so far are kept, so downloading the model
+     * again resumes where this one stopped.
+     * 
      * @param modelId Model ID to cancel
      */
     void cancelDownload(const juce::String& modelId);
@@ -277,6 +292,14 @@ public:
      */
     juce::File getModelsDirectory() const { return modelsDirectory; }
     
+    /**
+     * @brief Set the engine that loads completed downloads (nullptr = none)
+     * 
+     * A downloaded model with a role is loaded into it in the background,
+     * without a restart.
+     */
+    void setOnnxEngine(OnnxEngine* engine);
+    
     /**
      * @brief Submit a rating for a model
      * @param modelId Model ID
@@ -321,6 +344,7 @@ private:
     juce::String apiEndpoint;
     juce::File modelsDirectory;
     bool connected;
+    OnnxEngine* onnxEngine;
     
     std::vector<MarketplaceModelInfo> catalog;
     std::map<juce::String, DownloadProgress> activeDownloads;
@@ -332,19 +356,68 @@ private:
     
     /**
      * @brief Internal download task
+     * 
+     * Runs NUM_CONNECTIONS connections, each claiming the next missing
+     * chunk. Chunks are written at their offsets in the partial file;
+     * hashing follows the contiguous prefix of written chunks, from
+     * memory when it can and from the file otherwise.
      */
     class DownloadTask : public juce::ThreadPoolJob
     {
     public:
+        static constexpr juce::int64 CHUNK_SIZE = 4 * 1024 * 1024;   // A multiple of SHA-256's 64-byte block
+        static constexpr int NUM_CONNECTIONS = 4;
+        static constexpr int MAX_ATTEMPTS = 3;                        // Per chunk, before the download fails
+        static constexpr int CONNECTION_TIMEOUT_MS = 15000;
+        
         DownloadTask(ModelMarketplace& owner, const MarketplaceModelInfo& model, 
                     const juce::File& destDir);
         
         JobStatus runJob() override;
         
     private:
+        struct Transfer;
+        
         ModelMarketplace& marketplace;
         MarketplaceModelInfo modelInfo;
         juce::File destinationDir;
+        
+        /**
+         * @brief Open a request for bytes [start, end] of the model
+         */
+        std::unique_ptr<juce::InputStream> openRange(juce::int64 start, juce::int64 end,
+                                                     int& statusCode, juce::StringPairArray* headers) const;
+        
+        /**
+         * @brief Download chunks until none are left (runs on every connection)
+         */
+        void downloadChunks(Transfer& transfer);
+        
+        bool fetchChunk(Transfer& transfer, int chunk, juce::MemoryBlock& data);
+        
+        /**
+         * @brief Read exactly length bytes of a response (false if cut short or cancelled)
+         */
+        bool readStream(juce::InputStream& stream, juce::int64 length, juce::MemoryBlock& data) const;
+        
+        /**
+         * @brief Verify, rename into place, register and hand to the OnnxEngine
+         */
+        void completeDownload(Transfer& transfer);
+        
+        /**
+         * @brief Write a chunk, advance the hash and persist the state (under the transfer's lock)
+         */
+        bool commitChunk(Transfer& transfer, int chunk, juce::MemoryBlock&& data);
+        
+        /**
+         * @brief Download from a server without range support, in one stream
+         */
+        bool downloadWhole(Transfer& transfer, juce::InputStream& stream);
+        
+        bool isCancelled() const;
+        void updateProgress(juce::int64 bytesDownloaded, juce::int64 totalBytes);
+        void fail(const juce::String& error);
     };
     
     juce::ThreadPool downloadPool;
@@ -0,0 +1,94 @@
+/**
+ * @file MultiTapDelay.cpp
+ * @brief Implementation of the multi-tap delay engine
+ */
+
+#include "MultiTapDelay.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+MultiTapDelay::MultiTapDelay()
+    : ringMask(0)
+    , writePosition(0)
+    , currentSampleRate(44100.0)
+    , maxBlockSize(0)
+    , maxDelaySamples(0)
+    , numActiveTaps(0)
+{
+    tapDelays.fill(0);
+    tapGains.fill(0.0f);
+}
+
+void MultiTapDelay::prepare(double sampleRate, int maxBlock, int numChannels, double maxDelaySeconds)
+{
+    currentSampleRate = sampleRate;
+    maxBlockSize = juce::jmax(1, maxBlock);
+    maxDelaySamples = juce::jmax(1, static_cast<int>(std::ceil(maxDelaySeconds * sampleRate)));
+    
+    // A whole block must fit behind the longest tap
+    const int ringSize = juce::nextPowerOfTwo(maxDelaySamples + maxBlockSize);
+    ringMask = ringSize - 1;
+    
+    rings.assign(static_cast<size_t>(juce::jmax(1, numChannels)), std::vector<float>(static_cast<size_t>(ringSize), 0.0f));
+    writePosition = 0;
+}
+
+void MultiTapDelay::reset()
+{
+    for (auto& ring : rings)
+        std::fill(ring.begin(), ring.end(), 0.0f);
+    
+    writePosition = 0;
+}
+
+void MultiTapDelay::setTaps(const Tap* taps, int numTaps)
+{
+    numActiveTaps = juce::jlimit(0, MAX_TAPS, numTaps);
+    
+    for (int i = 0; i < numActiveTaps; ++i)
+    {
+        const int delay = juce::roundToInt(taps[i].delaySeconds * currentSampleRate);
+        tapDelays[static_cast<size_t>(i)] = juce::jlimit(0, maxDelaySamples, delay);
+        tapGains[static_cast<size_t>(i)] = taps[i].gain;
+    }
+}
+
+//==============================================================================
+void MultiTapDelay::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    jassert(numSamples <= maxBlockSize);
+    numSamples = juce::jmin(numSamples, maxBlockSize);
+    if (numSamples <= 0 || rings.empty())
+        return;
+    
+    const int ringSize = ringMask + 1;
+    const int channels = juce::jmin(static_cast<int>(rings.size()), buffer.getNumChannels());
+    
+    for (int ch = 0; ch < channels; ++ch)
+    {
+        float* data = buffer.getWritePointer(ch);
+        float* ring = rings[static_cast<size_t>(ch)].data();
+        
+        // Write the block first so taps shorter than a block read this block's input
+        const int firstWrite = juce::jmin(numSamples, ringSize - writePosition);
+        std::copy(data, data + firstWrite, ring + writePosition);
+        std::copy(data + firstWrite, data + numSamples, ring);
+        
+        for (int tap = 0; tap < numActiveTaps; ++tap)
+        {
+            const float gain = tapGains[static_cast<size_t>(tap)];
+            const int start = (writePosition - tapDelays[static_cast<size_t>(tap)]) & ringMask;
+            const int firstRead = juce::jmin(numSamples, ringSize - start);
+            
+            juce::FloatVectorOperations::addWithMultiply(data, ring + start, gain, firstRead);
+            if (firstRead < numSamples)
+                juce::FloatVectorOperations::addWithMultiply(data + firstRead, ring, gain, numSamples - firstRead);
+        }
+    }
+    
+    writePosition = (writePosition + numSamples) & ringMask;
+}
+
+} // namespace MAEVN
@@ -0,0 +1,81 @@
+/**
+ * @file MultiTapDelay.h
+ * @brief One circular buffer per channel read by any number of fixed taps
+ *
+ * Each block is written into the ring once, and every tap then adds a
+ * contiguous run of the ring (at most two around the wrap) into the output
+ * with a vectorised multiply-add. The cost is one pass over the block per
+ * tap, with no per-sample delay-line bookkeeping, so patterns of dozens of
+ * reflections stay cheap.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Feed-forward multi-tap delay (integer tap positions)
+ *
+ * All methods belong to the audio thread once playback has started; owners
+ * rebuild the tap pattern there when their parameters change.
+ */
+class MultiTapDelay
+{
+public:
+    static constexpr int MAX_TAPS = 64;
+    
+    struct Tap
+    {
+        float delaySeconds = 0.0f;
+        float gain = 0.0f;
+    };
+    
+    MultiTapDelay();
+    
+    /**
+     * @brief Allocate the rings (call outside the audio callback)
+     */
+    void prepare(double sampleRate, int maxBlockSize, int numChannels, double maxDelaySeconds);
+    
+    /**
+     * @brief Clear the delay history
+     */
+    void reset();
+    
+    /**
+     * @brief Replace the tap pattern (extra taps are dropped, delays clamped)
+     */
+    void setTaps(const Tap* taps, int numTaps);
+    
+    int getNumTaps() const { return numActiveTaps; }
+    
+    /**
+     * @brief Add the sum of the taps to numSamples of every prepared channel;
+     *        the input itself passes through
+     */
+    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+
+private:
+    std::vector<std::vector<float>> rings;   // [channel], power-of-two length
+    int ringMask;
+    int writePosition;
+    
+    double currentSampleRate;
+    int maxBlockSize;
+    int maxDelaySamples;
+    
+    std::array<int, MAX_TAPS> tapDelays;
+    std::array<float, MAX_TAPS> tapGains;
+    int numActiveTaps;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultiTapDelay)
+};
+
+} // namespace MAEVN
@@ -0,0 +1,264 @@
+/**
+ * @file MultiVoicePitchShifter.cpp
+ * @brief Implementation of the multi-voice phase vocoder
+ */
+
+#include "MultiVoicePitchShifter.h"
+
+namespace MAEVN
+{
+
+namespace
+{
+    float wrapPhase(float phase)
+    {
+        return phase - static_cast<float>(TWO_PI) * std::round(phase * static_cast<float>(1.0 / TWO_PI));
+    }
+}
+
+//==============================================================================
+MultiVoicePitchShifter::MultiVoicePitchShifter()
+    : frameSize(0)
+    , hopSize(0)
+    , numBins(0)
+    , fifoPosition(0)
+    , overlapAddScale(1.0f)
+    , numPeaks(0)
+{
+}
+
+void MultiVoicePitchShifter::prepare(double sampleRate, int /*maxBlockSize*/, int numChannels)
+{
+    const int order = juce::jlimit(8, 13, juce::roundToInt(std::log2(sampleRate * FRAME_SECONDS)));
+    frameSize = 1 << order;
+    hopSize = frameSize / OVERLAP;
+    numBins = frameSize / 2 + 1;
+    
+    fft = std::make_unique<juce::dsp::FFT>(order);
+    
+    // Periodic Hann for analysis and synthesis; overlapAddScale makes the
+    // overlapping squared windows sum to one
+    window.resize(static_cast<size_t>(frameSize));
+    double squaredSum = 0.0;
+    for (int i = 0; i < frameSize; ++i)
+    {
+        window[static_cast<size_t>(i)] = static_cast<float>(0.5 - 0.5 * std::cos(TWO_PI * i / frameSize));
+        squaredSum += static_cast<double>(window[static_cast<size_t>(i)]) * window[static_cast<size_t>(i)];
+    }
+    overlapAddScale = static_cast<float>(hopSize / squaredSum);
+    
+    channels = std::vector<ChannelState>(static_cast<size_t>(juce::jmax(1, numChannels)));
+    for (auto& state : channels)
+    {
+        state.inputFrame.assign(static_cast<size_t>(frameSize), 0.0f);
+        state.outputHop.assign(static_cast<size_t>(hopSize), 0.0f);
+        state.accumulator.assign(static_cast<size_t>(frameSize), 0.0f);
+        state.analysisPhases.assign(static_cast<size_t>(numBins), 0.0f);
+        state.synthesisPhases.assign(static_cast<size_t>(MAX_VOICES * numBins), 0.0f);
+    }
+    
+    workspace.assign(static_cast<size_t>(2 * frameSize), 0.0f);
+    magnitudes.assign(static_cast<size_t>(numBins), 0.0f);
+    phases.assign(static_cast<size_t>(numBins), 0.0f);
+    peakFrequencies.assign(static_cast<size_t>(numBins), 0.0f);
+    peakBins.assign(static_cast<size_t>(numBins), 0);
+    voiceMagnitudes.assign(static_cast<size_t>(numBins), 0.0f);
+    voicePhases.assign(static_cast<size_t>(numBins), 0.0f);
+    mixSpectrum.assign(static_cast<size_t>(2 * numBins), 0.0f);
+    
+    reset();
+}
+
+void MultiVoicePitchShifter::reset()
+{
+    for (auto& state : channels)
+    {
+        std::fill(state.inputFrame.begin(), state.inputFrame.end(), 0.0f);
+        std::fill(state.outputHop.begin(), state.outputHop.end(), 0.0f);
+        std::fill(state.accumulator.begin(), state.accumulator.end(), 0.0f);
+        std::fill(state.analysisPhases.begin(), state.analysisPhases.end(), 0.0f);
+        std::fill(state.synthesisPhases.begin(), state.synthesisPhases.end(), 0.0f);
+    }
+    
+    fifoPosition = frameSize - hopSize;
+}
+
+void MultiVoicePitchShifter::setVoice(int index, float semitones, float gain)
+{
+    if (index < 0 || index >= MAX_VOICES)
+        return;
+    
+    auto& voice = voices[static_cast<size_t>(index)];
+    voice.ratio = semitones == 0.0f ? 1.0f : std::exp2(juce::jlimit(-24.0f, 24.0f, semitones) / 12.0f);
+    voice.gain = juce::jmax(0.0f, gain);
+}
+
+//==============================================================================
+void MultiVoicePitchShifter::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    if (channels.empty() || frameSize == 0)
+        return;
+    
+    const int numChannels = juce::jmin(static_cast<int>(channels.size()), buffer.getNumChannels());
+    const int hopStart = frameSize - hopSize;
+    int position = 0;
+    
+    while (position < numSamples)
+    {
+        const int chunk = juce::jmin(numSamples - position, frameSize - fifoPosition);
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& state = channels[static_cast<size_t>(ch)];
+            float* data = buffer.getWritePointer(ch) + position;
+            
+            std::copy(data, data + chunk, state.inputFrame.begin() + fifoPosition);
+            std::copy(state.outputHop.begin() + (fifoPosition - hopStart),
+                      state.outputHop.begin() + (fifoPosition - hopStart + chunk), data);
+        }
+        
+        fifoPosition += chunk;
+        position += chunk;
+        
+        if (fifoPosition == frameSize)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                processFrame(channels[static_cast<size_t>(ch)]);
+            
+            fifoPosition = hopStart;
+        }
+    }
+}
+
+void MultiVoicePitchShifter::processFrame(ChannelState& state)
+{
+    //==========================================================================
+    // Analysis, once for every voice
+    //==========================================================================
+    juce::FloatVectorOperations::multiply(workspace.data(), state.inputFrame.data(), window.data(), frameSize);
+    std::fill(workspace.begin() + frameSize, workspace.end(), 0.0f);
+    fft->performRealOnlyForwardTransform(workspace.data(), true);
+    
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        const float re = workspace[static_cast<size_t>(2 * bin)];
+        const float im = workspace[static_cast<size_t>(2 * bin + 1)];
+        magnitudes[static_cast<size_t>(bin)] = std::sqrt(re * re + im * im);
+        phases[static_cast<size_t>(bin)] = std::atan2(im, re);
+    }
+    
+    // Peaks: bins above both neighbours on either side. Each peak's true
+    // frequency is its centre frequency plus the phase advance it was off by
+    numPeaks = 0;
+    const float binSpacing = static_cast<float>(TWO_PI / frameSize);
+    
+    for (int bin = 2; bin < numBins - 2; ++bin)
+    {
+        const float m = magnitudes[static_cast<size_t>(bin)];
+        if (m <= magnitudes[static_cast<size_t>(bin - 1)] || m <= magnitudes[static_cast<size_t>(bin - 2)]
+            || m < magnitudes[static_cast<size_t>(bin + 1)] || m < magnitudes[static_cast<size_t>(bin + 2)])
+            continue;
+        
+        const float expected = binSpacing * static_cast<float>(bin * hopSize);
+        const float deviation = wrapPhase(phases[static_cast<size_t>(bin)]
+                                          - state.analysisPhases[static_cast<size_t>(bin)] - expected);
+        peakFrequencies[static_cast<size_t>(bin)] = binSpacing * static_cast<float>(bin) + deviation / static_cast<float>(hopSize);
+        peakBins[static_cast<size_t>(numPeaks++)] = bin;
+    }
+    
+    std::copy(phases.begin(), phases.end(), state.analysisPhases.begin());
+    
+    //==========================================================================
+    // Synthesis: voices add spectra, one inverse transform for all of them
+    //==========================================================================
+    std::fill(mixSpectrum.begin(), mixSpectrum.end(), 0.0f);
+    
+    for (int v = 0; v < MAX_VOICES; ++v)
+    {
+        const auto& voice = voices[static_cast<size_t>(v)];
+        if (voice.gain <= 0.0f)
+            continue;
+        
+        float* previousPhases = state.synthesisPhases.data() + v * numBins;
+        
+        if (voice.ratio == 1.0f)
+        {
+            // Untransposed: the analysis itself, with phases kept in step for a later shift
+            juce::FloatVectorOperations::addWithMultiply(mixSpectrum.data(), workspace.data(), voice.gain, 2 * numBins);
+            std::copy(phases.begin(), phases.end(), previousPhases);
+        }
+        else
+        {
+            synthesiseVoice(voice, previousPhases);
+        }
+    }
+    
+    std::copy(mixSpectrum.begin(), mixSpectrum.end(), workspace.begin());
+    fft->performRealOnlyInverseTransform(workspace.data());
+    
+    float* accumulator = state.accumulator.data();
+    for (int i = 0; i < frameSize; ++i)
+        accumulator[i] += workspace[static_cast<size_t>(i)] * window[static_cast<size_t>(i)] * overlapAddScale;
+    
+    // The oldest hop has had every overlapping frame added: play it out next
+    std::copy(accumulator, accumulator + hopSize, state.outputHop.begin());
+    std::copy(accumulator + hopSize, accumulator + frameSize, accumulator);
+    std::fill(accumulator + frameSize - hopSize, accumulator + frameSize, 0.0f);
+    
+    std::copy(state.inputFrame.begin() + hopSize, state.inputFrame.end(), state.inputFrame.begin());
+}
+
+void MultiVoicePitchShifter::synthesiseVoice(const Voice& voice, float* previousPhases)
+{
+    std::fill(voiceMagnitudes.begin(), voiceMagnitudes.end(), 0.0f);
+    std::copy(previousPhases, previousPhases + numBins, voicePhases.begin());
+    
+    int target = numPeaks > 0 ? juce::roundToInt(static_cast<float>(peakBins[0]) * voice.ratio) : 0;
+    
+    for (int p = 0; p < numPeaks && target < numBins; ++p)
+    {
+        const int peak = peakBins[static_cast<size_t>(p)];
+        const bool lastPeak = p == numPeaks - 1;
+        const int nextTarget = lastPeak ? numBins : juce::roundToInt(static_cast<float>(peakBins[static_cast<size_t>(p + 1)]) * voice.ratio);
+        
+        // A region reaches halfway to the neighbouring peaks, both where the
+        // bins come from and where they land, so transposed regions neither
+        // overlap when squeezed nor repeat bins when stretched
+        const int previousPeak = p == 0 ? peak : peakBins[static_cast<size_t>(p - 1)];
+        const int regionStart = p == 0 ? 0 : (previousPeak + peak + 1) / 2;
+        const int regionEnd = lastPeak ? numBins : (peak + peakBins[static_cast<size_t>(p + 1)] + 1) / 2;
+        const int destinationStart = p == 0 ? 0 : (juce::roundToInt(static_cast<float>(previousPeak) * voice.ratio) + target + 1) / 2;
+        const int destinationEnd = lastPeak ? numBins : (target + nextTarget + 1) / 2;
+        const int shift = target - peak;
+        
+        // The peak advances at its transposed frequency; the bins around it
+        // keep their analysed phase offsets from it
+        const float peakPhase = wrapPhase(previousPhases[target]
+                                          + peakFrequencies[static_cast<size_t>(peak)] * voice.ratio * static_cast<float>(hopSize));
+        const float peakAnalysisPhase = phases[static_cast<size_t>(peak)];
+        
+        const int first = juce::jmax(regionStart, destinationStart - shift);
+        const int last = juce::jmin(regionEnd, juce::jmin(destinationEnd, numBins) - shift);
+        
+        for (int bin = first; bin < last; ++bin)
+        {
+            const auto destination = static_cast<size_t>(bin + shift);
+            voiceMagnitudes[destination] += magnitudes[static_cast<size_t>(bin)];
+            voicePhases[destination] = peakPhase + (phases[static_cast<size_t>(bin)] - peakAnalysisPhase);
+        }
+        
+        target = nextTarget;
+    }
+    
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        const float phase = wrapPhase(voicePhases[static_cast<size_t>(bin)]);
+        const float magnitude = voiceMagnitudes[static_cast<size_t>(bin)] * voice.gain;
+        
+        previousPhases[bin] = phase;
+        mixSpectrum[static_cast<size_t>(2 * bin)] += magnitude * std::cos(phase);
+        mixSpectrum[static_cast<size_t>(2 * bin + 1)] += magnitude * std::sin(phase);
+    }
+}
+
+} // namespace MAEVN
@@ -0,0 +1,121 @@
+/**
+ * @file MultiVoicePitchShifter.h
+ * @brief Phase vocoder that renders several pitch-shifted voices from one analysis
+ *
+ * Each channel is analysed once per hop: a Hann-windowed FFT gives every
+ * bin's magnitude and phase, and the spectral peaks' true frequencies come
+ * from their phase advance since the previous frame. A voice moves each
+ * peak, with the bins around it, to ratio times its frequency and keeps the
+ * bins' phases locked to the peak (Laroche and Dolson's phase vocoder), so
+ * transposed voices stay free of the usual phasiness. Voices are summed as
+ * spectra, so a frame costs one forward and one inverse FFT per channel
+ * however many voices there are; an extra voice only adds its bin remap.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <memory>
+#include <vector>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Sum of up to MAX_VOICES transpositions of the input
+ *
+ * A voice at 0 semitones passes the analysis phases through unchanged and
+ * so reconstructs the input exactly (delayed by getLatencySamples()). All
+ * methods belong to the audio thread once playback has started.
+ */
+class MultiVoicePitchShifter
+{
+public:
+    static constexpr int MAX_VOICES = 8;
+    static constexpr int OVERLAP = 4;
+    
+    /** Frame length aimed for; rounded to the nearest power of two for the rate */
+    static constexpr double FRAME_SECONDS = 0.0232;
+    
+    MultiVoicePitchShifter();
+    
+    /**
+     * @brief Allocate frames and phase state (call outside the audio callback)
+     */
+    void prepare(double sampleRate, int maxBlockSize, int numChannels);
+    
+    /**
+     * @brief Clear all frames and phases
+     */
+    void reset();
+    
+    /**
+     * @brief Set one voice; a gain of 0 turns it off
+     */
+    void setVoice(int index, float semitones, float gain);
+    
+    /**
+     * @brief Replace numSamples of every prepared channel with the voice mix
+     */
+    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    /**
+     * @brief Delay of every voice relative to the input (valid after prepare)
+     */
+    int getLatencySamples() const { return frameSize; }
+
+private:
+    struct Voice
+    {
+        float ratio = 1.0f;
+        float gain = 0.0f;
+    };
+    
+    struct ChannelState
+    {
+        std::vector<float> inputFrame;       // newest frameSize input samples
+        std::vector<float> outputHop;        // finished output being played out
+        std::vector<float> accumulator;      // overlap-add of synthesised frames
+        std::vector<float> analysisPhases;   // previous frame's bin phases
+        std::vector<float> synthesisPhases;  // [voice * numBins + bin], previous frame
+    };
+    
+    void processFrame(ChannelState& state);
+    
+    /**
+     * @brief Add one transposed voice to mixSpectrum from the current analysis
+     */
+    void synthesiseVoice(const Voice& voice, float* previousPhases);
+    
+    std::array<Voice, MAX_VOICES> voices;
+    
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int frameSize;
+    int hopSize;
+    int numBins;
+    int fifoPosition;   // write position in inputFrame, frameSize - hopSize .. frameSize
+    float overlapAddScale;
+    
+    std::vector<ChannelState> channels;
+    std::vector<float> window;
+    
+    // Current frame's analysis, shared by every voice
+    std::vector<float> workspace;
+    std::vector<float> magnitudes;
+    std::vector<float> phases;
+    std::vector<float> peakFrequencies;   // [bin], radians per sample, set at peaks only
+    std::vector<int> peakBins;
+    int numPeaks;
+    
+    // Synthesis scratch
+    std::vector<float> voiceMagnitudes;
+    std::vector<float> voicePhases;
+    std::vector<float> mixSpectrum;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultiVoicePitchShifter)
+};
+
+} // namespace MAEVN
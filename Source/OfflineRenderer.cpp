@@ -0,0 +1,362 @@
+/**
+ * @file OfflineRenderer.cpp
+ * @brief Implementation of the offline render engine
+ */
+
+#include "OfflineRenderer.h"
+#include "PatternEngine.h"
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+namespace MAEVN
+{
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer(OnnxEngine* engine)
+    : onnxEngine(engine)
+{
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+}
+
+void OfflineRenderer::copyChainSettings(const AIFXEngine& fxEngine,
+                                        const CinematicAudioEnhancer& enhancer,
+                                        bool masteringEnabled)
+{
+    for (int trackIndex = 0; trackIndex < OfflineRenderSettings::NUM_TRACKS; ++trackIndex)
+        settings.fxModes[static_cast<size_t>(trackIndex)] = fxEngine.getFXMode(trackIndex);
+    
+    settings.masteringEnabled = masteringEnabled;
+    settings.enhancerParameters = enhancer.getParameters();
+}
+
+//==============================================================================
+bool OfflineRenderer::renderToFile(const std::vector<TimelineBlock>& blocks, const juce::File& file)
+{
+    double startTime, endTime;
+    getTimelineSpan(blocks, startTime, endTime);
+    
+    return renderToFile(blocks, startTime, endTime, file);
+}
+
+bool OfflineRenderer::renderToFile(const std::vector<TimelineBlock>& blocks, double startTime, double endTime,
+                                   const juce::File& file)
+{
+    auto writer = createWriterFor(file, 2);
+    if (writer == nullptr)
+    {
+        Logger::log(Logger::Level::Error, "Cannot write render to " + file.getFullPathName());
+        return false;
+    }
+    
+    juce::TimeSliceThread writerThread("Offline Render Writer");
+    writerThread.startThread();
+    
+    bool success;
+    {
+        juce::AudioFormatWriter::ThreadedWriter threadedWriter(writer.release(), writerThread, WRITER_BUFFER_SAMPLES);
+        
+        success = render(blocks, startTime, endTime, [&threadedWriter](const juce::AudioBuffer<float>& buffer, int numSamples)
+        {
+            // The queue only takes a block whole; wait for the disk to catch up
+            while (!threadedWriter.write(buffer.getArrayOfReadPointers(), numSamples))
+                juce::Thread::sleep(1);
+            
+            return true;
+        });
+    } // the writer drains its queue to disk as it is destroyed
+    
+    writerThread.stopThread(1000);
+    return success;
+}
+
+bool OfflineRenderer::renderToBuffer(const std::vector<TimelineBlock>& blocks, double startTime, double endTime,
+                                     juce::AudioBuffer<float>& output)
+{
+    int numWritten = 0;
+    output.setSize(2, 0);
+    
+    const bool success = render(blocks, startTime, endTime, [&](const juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        // Grown geometrically, so a long render is not copied block by block
+        if (numWritten + numSamples > output.getNumSamples())
+            output.setSize(2, juce::jmax(numWritten + numSamples, output.getNumSamples() * 2), true, false, true);
+        
+        for (int ch = 0; ch < 2; ++ch)
+            output.copyFrom(ch, numWritten, buffer, ch, 0, numSamples);
+        
+        numWritten += numSamples;
+        return true;
+    });
+    
+    output.setSize(2, numWritten, true, false, true);
+    return success;
+}
+
+bool OfflineRenderer::renderStageScript(const juce::String& script, double bpm, const juce::File& file)
+{
+    PatternEngine patternEngine;
+    patternEngine.setBPM(bpm);
+    
+    if (patternEngine.parseStageScript(script) == 0)
+    {
+        Logger::log(Logger::Level::Warning, "Stage script has no blocks to render");
+        return false;
+    }
+    
+    return renderToFile(patternEngine.getBlocks(), file);
+}
+
+std::unique_ptr<juce::AudioFormatWriter> OfflineRenderer::createWriterFor(const juce::File& file, int numChannels) const
+{
+    std::unique_ptr<juce::AudioFormat> format;
+    if (file.hasFileExtension(".aiff;.aif"))
+        format = std::make_unique<juce::AiffAudioFormat>();
+    else
+        format = std::make_unique<juce::WavAudioFormat>();
+    
+    auto stream = std::make_unique<juce::FileOutputStream>(file);
+    if (!stream->openedOk())
+        return nullptr;
+    
+    // Overwrite rather than append to an existing file
+    stream->setPosition(0);
+    stream->truncate();
+    
+    std::unique_ptr<juce::AudioFormatWriter> writer(
+        format->createWriterFor(stream.get(),
+                                settings.sampleRate,
+                                static_cast<unsigned int>(numChannels),
+                                settings.bitDepth,
+                                {},
+                                0));
+    
+    // The writer owns the stream once it exists
+    if (writer != nullptr)
+        stream.release();
+    
+    return writer;
+}
+
+//==============================================================================
+bool OfflineRenderer::render(const std::vector<TimelineBlock>& blocks, double startTime, double endTime,
+                             const Sink& sink)
+{
+    constexpr int NUM_TRACKS = OfflineRenderSettings::NUM_TRACKS;
+    const double renderStarted = juce::Time::getMillisecondCounterHiRes();
+    lastResult = {};
+    
+    const double sampleRate = settings.sampleRate;
+    const int blockSize = juce::jlimit(64, WRITER_BUFFER_SAMPLES / 4, settings.blockSize);
+    
+    if (sampleRate <= 0.0 || endTime <= startTime)
+    {
+        Logger::log(Logger::Level::Warning, "Nothing to render");
+        return false;
+    }
+    
+    const auto clips = renderClips(blocks, startTime, endTime);
+    lastResult.numClipsRendered = static_cast<int>(clips.clips.size());
+    
+    // Fresh chains per render, so no state carries over from the last one.
+    // Offline there is no deadline, so every inference is waited for.
+    AIFXEngine fxEngine(onnxEngine);
+    fxEngine.setAsyncInferenceEnabled(false);
+    for (int trackIndex = 0; trackIndex < NUM_TRACKS; ++trackIndex)
+        fxEngine.setFXMode(trackIndex, settings.fxModes[static_cast<size_t>(trackIndex)]);
+    fxEngine.prepare(sampleRate, blockSize);
+    
+    CinematicAudioEnhancer enhancer;
+    enhancer.setParameters(settings.enhancerParameters);
+    enhancer.prepare(sampleRate, blockSize);
+    
+    // The chains delay the mix by their latency, which is rendered and dropped
+    const bool mastering = settings.masteringEnabled;
+    const int latency = fxEngine.getLatencySamples() + (mastering ? enhancer.getLatencySamples() : 0);
+    const double tail = settings.tailSeconds >= 0.0
+                            ? settings.tailSeconds
+                            : fxEngine.getTailLengthSeconds() + (mastering ? enhancer.getTailLengthSeconds() : 0.0);
+    
+    const auto numOutputSamples = static_cast<juce::int64>(std::ceil((endTime - startTime + tail) * sampleRate));
+    const auto numTotalSamples = numOutputSamples + latency;
+    
+    // Only tracks with rendered audio run their chains
+    std::array<juce::AudioBuffer<float>, NUM_TRACKS> trackBuffers;
+    std::array<bool, NUM_TRACKS> trackHasAudio {};
+    for (int trackIndex = 0; trackIndex < NUM_TRACKS; ++trackIndex)
+    {
+        trackHasAudio[static_cast<size_t>(trackIndex)] = clips.hasAudio(trackIndex, startTime, endTime);
+        if (trackHasAudio[static_cast<size_t>(trackIndex)])
+            trackBuffers[static_cast<size_t>(trackIndex)].setSize(2, blockSize);
+    }
+    
+    using AlignmentDelay = juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None>;
+    std::array<AlignmentDelay, NUM_TRACKS> trackAlignment;
+    juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(blockSize), 2 };
+    for (auto& delay : trackAlignment)
+    {
+        delay.setMaximumDelayInSamples(MAX_ALIGNMENT_DELAY);
+        delay.prepare(spec);
+        delay.setDelay(0.0f);
+    }
+    
+    juce::AudioBuffer<float> mix(2, blockSize);
+    LoudnessMeter loudness;
+    loudness.prepare(sampleRate, 2);
+    
+    // The tracks of each block run in parallel; the mastering pass follows on this thread
+    RealtimeWorkerPool workers;
+    workers.start(juce::jmin(getNumThreads(), NUM_TRACKS) - 1);
+    
+    bool success = true;
+    for (juce::int64 numRendered = 0; success && numRendered < numTotalSamples;)
+    {
+        const int numSamples = static_cast<int>(juce::jmin<juce::int64>(blockSize, numTotalSamples - numRendered));
+        const double position = startTime + static_cast<double>(numRendered) / sampleRate;
+        
+        std::array<juce::AudioBuffer<float>*, NUM_TRACKS> tracks {};
+        for (int trackIndex = 0; trackIndex < NUM_TRACKS; ++trackIndex)
+        {
+            if (!trackHasAudio[static_cast<size_t>(trackIndex)])
+                continue;
+            
+            auto& track = trackBuffers[static_cast<size_t>(trackIndex)];
+            track.clear(0, numSamples);
+            clips.mixInto(track, trackIndex, position, numSamples);
+            tracks[static_cast<size_t>(trackIndex)] = &track;
+        }
+        
+        fxEngine.processTracks(tracks.data(), NUM_TRACKS, numSamples, &workers);
+        
+        // Sum the tracks, aligning every one to the slowest chain
+        const int totalLatency = fxEngine.getRunningLatencySamples();
+        mix.clear(0, numSamples);
+        
+        for (int trackIndex = 0; trackIndex < NUM_TRACKS; ++trackIndex)
+        {
+            auto* track = tracks[static_cast<size_t>(trackIndex)];
+            if (track == nullptr)
+                continue;
+            
+            const int alignment = juce::jlimit(0, MAX_ALIGNMENT_DELAY,
+                                               totalLatency - fxEngine.getRunningTrackLatencySamples(trackIndex));
+            if (alignment > 0)
+            {
+                auto& delay = trackAlignment[static_cast<size_t>(trackIndex)];
+                delay.setDelay(static_cast<float>(alignment));
+                
+                juce::dsp::AudioBlock<float> block(*track);
+                auto subBlock = block.getSubsetChannelBlock(0, 2).getSubBlock(0, static_cast<size_t>(numSamples));
+                delay.process(juce::dsp::ProcessContextReplacing<float>(subBlock));
+            }
+            
+            for (int ch = 0; ch < mix.getNumChannels(); ++ch)
+                mix.addFrom(ch, 0, *track, ch, 0, numSamples);
+        }
+        
+        if (mastering)
+            enhancer.process(mix, numSamples);
+        
+        // Skip the samples that are only the chains' delay
+        const int skip = static_cast<int>(juce::jlimit<juce::int64>(0, numSamples, latency - numRendered));
+        if (skip < numSamples)
+        {
+            juce::AudioBuffer<float> audible(mix.getArrayOfWritePointers(), mix.getNumChannels(), skip, numSamples - skip);
+            loudness.process(audible, audible.getNumSamples());
+            success = sink(audible, audible.getNumSamples());
+        }
+        
+        numRendered += numSamples;
+        
+        if (onProgress)
+            onProgress(static_cast<float>(static_cast<double>(numRendered) / static_cast<double>(numTotalSamples)));
+    }
+    
+    workers.stop();
+    
+    lastResult.audioSeconds = static_cast<double>(numOutputSamples) / sampleRate;
+    lastResult.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - renderStarted) / 1000.0;
+    lastResult.integratedLUFS = loudness.getIntegratedLUFS();
+    
+    Logger::log(Logger::Level::Info, "Rendered " + juce::String(lastResult.audioSeconds, 1) + " s in "
+                + juce::String(lastResult.renderSeconds, 1) + " s ("
+                + juce::String(lastResult.getRealtimeFactor(), 1) + "x realtime, "
+                + juce::String(lastResult.integratedLUFS, 1) + " LUFS integrated)");
+    
+    return success;
+}
+
+ReadyClips OfflineRenderer::renderClips(const std::vector<TimelineBlock>& blocks, double startTime, double endTime) const
+{
+    ReadyClips ready;
+    ready.sampleRate = settings.sampleRate;
+    
+    if (!renderer)
+        return ready;
+    
+    std::vector<const TimelineBlock*> jobs;
+    for (const auto& block : blocks)
+    {
+        if (block.startTime < endTime && block.startTime + block.duration > startTime)
+            jobs.push_back(&block);
+    }
+    
+    if (jobs.empty())
+        return ready;
+    
+    // Every block renders on its own; the slowest one bounds the wait
+    std::vector<VocalRenderCache::RenderedAudio> audio(jobs.size());
+    std::atomic<int> numRemaining { static_cast<int>(jobs.size()) };
+    juce::WaitableEvent finished;
+    
+    {
+        juce::ThreadPool pool(juce::jmin(getNumThreads(), static_cast<int>(jobs.size())));
+        
+        for (size_t i = 0; i < jobs.size(); ++i)
+        {
+            pool.addJob([&, i]
+            {
+                audio[i] = renderer(*jobs[i], settings.sampleRate);
+                
+                if (numRemaining.fetch_sub(1) == 1)
+                    finished.signal();
+            });
+        }
+        
+        finished.wait();
+    }
+    
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        if (audio[i] != nullptr)
+            ready.clips.push_back({ *jobs[i], std::move(audio[i]) });
+    }
+    
+    return ready;
+}
+
+int OfflineRenderer::getNumThreads() const
+{
+    return settings.numThreads > 0 ? settings.numThreads : juce::SystemStats::getNumCpus();
+}
+
+void OfflineRenderer::getTimelineSpan(const std::vector<TimelineBlock>& blocks, double& startTime, double& endTime)
+{
+    startTime = std::numeric_limits<double>::max();
+    endTime = std::numeric_limits<double>::lowest();
+    
+    for (const auto& block : blocks)
+    {
+        startTime = juce::jmin(startTime, block.startTime);
+        endTime = juce::jmax(endTime, block.startTime + block.duration);
+    }
+    
+    // No blocks is an empty span, which render() rejects
+    if (blocks.empty())
+        startTime = endTime = 0.0;
+}
+
+} // namespace MAEVN
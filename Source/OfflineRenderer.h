@@ -0,0 +1,176 @@
+/**
+ * @file OfflineRenderer.h
+ * @brief Faster-than-realtime bounce of a timeline through the FX and mastering chains
+ *
+ * Exports and the headless render tool cannot go through the audio
+ * callback: there is no host, and nothing has to keep up with a clock.
+ * The offline renderer first renders every generative block of the
+ * arrangement on a thread pool over all cores, then runs the mix in large
+ * blocks through its own AIFXEngine (the tracks in parallel on a worker
+ * pool) and CinematicAudioEnhancer, compensating both chains' latency,
+ * and streams the result to disk through a background ThreadedWriter.
+ * The chains are set up from an OfflineRenderSettings, which can be taken
+ * from the live engines; the live engines themselves are never touched.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <functional>
+#include <vector>
+#include "Utilities.h"
+#include "OnnxEngine.h"
+#include "AIFXEngine.h"
+#include "CinematicAudioEnhancer.h"
+#include "LoudnessMeter.h"
+#include "RealtimeWorkerPool.h"
+#include "RenderAheadScheduler.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief How an offline render sounds and is written
+ */
+struct OfflineRenderSettings
+{
+    static constexpr int NUM_TRACKS = 6;   // Vocal, 808, HiHat, Snare, Piano, Synth
+    
+    double sampleRate = 48000.0;
+    int bitDepth = 24;
+    int blockSize = 8192;                  ///< Samples per processing block
+    int numThreads = 0;                    ///< Threads to render on (0 = every core)
+    double tailSeconds = -1.0;             ///< Rendered past the last block (negative = the chains' own tail)
+    
+    std::array<FXMode, NUM_TRACKS> fxModes {};   ///< Per-track FX mode (Off, as in a fresh AIFXEngine)
+    bool masteringEnabled = true;          ///< Run the mix through the CinematicAudioEnhancer
+    CinematicAudioEnhancer::Parameters enhancerParameters;
+};
+
+//==============================================================================
+/**
+ * @brief Statistics of the last offline render
+ */
+struct OfflineRenderResult
+{
+    double audioSeconds = 0.0;             ///< Length of the rendered audio
+    double renderSeconds = 0.0;            ///< Wall-clock time the render took
+    int numClipsRendered = 0;              ///< Generative blocks that produced audio
+    float integratedLUFS = LoudnessMeter::MINIMUM_LUFS;
+    
+    /** How many times faster than realtime the render ran */
+    double getRealtimeFactor() const { return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0; }
+};
+
+//==============================================================================
+/**
+ * @brief Renders a set of timeline blocks to a file or buffer, offline
+ *
+ * One render at a time; render calls block until the audio is complete
+ * (and, for files, on disk). Not realtime-safe.
+ */
+class OfflineRenderer
+{
+public:
+    /**
+     * @brief Renders one block at a sample rate; returns nullptr if it cannot
+     *
+     * Called on the render pool, for several blocks at once.
+     */
+    using BlockRenderer = RenderAheadScheduler::BlockRenderer;
+    
+    /** Samples the background writer can queue before a render waits for the disk */
+    static constexpr int WRITER_BUFFER_SAMPLES = 1 << 18;
+    
+    /** Longest per-track delay used to line tracks up with the slowest chain */
+    static constexpr int MAX_ALIGNMENT_DELAY = 16384;
+    
+    explicit OfflineRenderer(OnnxEngine* onnxEngine = nullptr);
+    ~OfflineRenderer();
+    
+    /**
+     * @brief Set the ONNX engine the AI effects run on (nullptr = DSP only)
+     */
+    void setOnnxEngine(OnnxEngine* engine) { onnxEngine = engine; }
+    
+    /**
+     * @brief Set the renderer for generative blocks
+     */
+    void setRenderer(BlockRenderer newRenderer) { renderer = std::move(newRenderer); }
+    
+    void setSettings(const OfflineRenderSettings& newSettings) { settings = newSettings; }
+    const OfflineRenderSettings& getSettings() const { return settings; }
+    
+    /**
+     * @brief Take the FX modes and enhancer parameters of the live chains
+     */
+    void copyChainSettings(const AIFXEngine& fxEngine, const CinematicAudioEnhancer& enhancer, bool masteringEnabled);
+    
+    /**
+     * @brief Called with the progress (0.0 - 1.0) of a render, on the rendering thread
+     */
+    std::function<void(float)> onProgress;
+    
+    /**
+     * @brief Render blocks from the first block's start to the last one's end, plus the tail
+     *
+     * The format follows the file's extension (.wav or .aiff).
+     */
+    bool renderToFile(const std::vector<TimelineBlock>& blocks, const juce::File& file);
+    
+    /**
+     * @brief Render the blocks heard in [startTime, endTime) seconds to a file
+     */
+    bool renderToFile(const std::vector<TimelineBlock>& blocks, double startTime, double endTime,
+                      const juce::File& file);
+    
+    /**
+     * @brief Render the blocks heard in [startTime, endTime) seconds into a stereo buffer
+     */
+    bool renderToBuffer(const std::vector<TimelineBlock>& blocks, double startTime, double endTime,
+                        juce::AudioBuffer<float>& output);
+    
+    /**
+     * @brief Parse a stage script and render the whole arrangement to a file
+     */
+    bool renderStageScript(const juce::String& script, double bpm, const juce::File& file);
+    
+    /**
+     * @brief Statistics of the last render
+     */
+    const OfflineRenderResult& getLastResult() const { return lastResult; }
+    
+    /**
+     * @brief Writer for a file in the format its extension names, at the current settings
+     */
+    std::unique_ptr<juce::AudioFormatWriter> createWriterFor(const juce::File& file, int numChannels) const;
+
+private:
+    /** Receives each finished stretch of the mix: (buffer, numSamples); false stops the render */
+    using Sink = std::function<bool(const juce::AudioBuffer<float>&, int)>;
+    
+    /**
+     * @brief Render [startTime, endTime) plus the tail, passing the mix to sink block by block
+     */
+    bool render(const std::vector<TimelineBlock>& blocks, double startTime, double endTime, const Sink& sink);
+    
+    /**
+     * @brief Render the generative blocks overlapping [startTime, endTime) on every core
+     */
+    ReadyClips renderClips(const std::vector<TimelineBlock>& blocks, double startTime, double endTime) const;
+    
+    int getNumThreads() const;
+    
+    static void getTimelineSpan(const std::vector<TimelineBlock>& blocks, double& startTime, double& endTime);
+    
+    OnnxEngine* onnxEngine;
+    BlockRenderer renderer;
+    OfflineRenderSettings settings;
+    OfflineRenderResult lastResult;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineRenderer)
+};
+
+} // namespace MAEVN
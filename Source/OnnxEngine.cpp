@@ -4,8 +4,28 @@
  */
 
 #include "OnnxEngine.h"
+#include <algorithm>
 #include <fstream>
 
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <cpuid.h>
+ #endif
+#elif JUCE_ARM && JUCE_64BIT
+ #if JUCE_LINUX || JUCE_ANDROID
+  #include <sys/auxv.h>
+ #elif JUCE_MAC || JUCE_IOS
+  #include <sys/sysctl.h>
+ #elif JUCE_WINDOWS
+  #ifndef NOMINMAX
+   #define NOMINMAX
+  #endif
+  #include <windows.h>
+ #endif
+#endif
+
 namespace MAEVN
 {
 
@@ -23,26 +43,59 @@ OnnxModel::~OnnxModel()
     unload();
 }
 
-bool OnnxModel::loadModel(const juce::String& modelPath)
+bool OnnxModel::loadModel(Ort::Env& environment,
+                          const juce::String& modelPath,
+                          const ThreadingProfile& threading,
+                          const juce::File& optimizedCache,
+                          GPUBackend backend,
+                          const GPUConfig& gpuConfig)
 {
     const juce::ScopedLock sl(modelLock);
     
+    const juce::File modelFile(modelPath);
+    const bool useCache = optimizedCache != juce::File();
+    
     try
     {
-        // Create ONNX Runtime environment
-        environment = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "MAEVN");
+        bool loadedFromCache = false;
         
-        // Configure session options for optimal performance
-        sessionOptions = std::make_unique<Ort::SessionOptions>();
-        sessionOptions->SetIntraOpNumThreads(1); // Real-time audio: single thread
-        sessionOptions->SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        // A cache older than the model belongs to a previous export
+        if (useCache && optimizedCache.existsAsFile()
+            && optimizedCache.getLastModificationTime() >= modelFile.getLastModificationTime())
+        {
+            try
+            {
+                // The cached graph is already optimized
+                createSession(environment, optimizedCache, threading,
+                              GraphOptimizationLevel::ORT_DISABLE_ALL, {}, backend, gpuConfig);
+                loadedFromCache = true;
+            }
+            catch (const Ort::Exception& e)
+            {
+                Logger::log(Logger::Level::Warning, "Discarding optimized model cache "
+                            + optimizedCache.getFullPathName() + ": " + juce::String(e.what()));
+                optimizedCache.deleteFile();
+            }
+        }
         
-        // Load the model
-        #ifdef _WIN32
-            session = std::make_unique<Ort::Session>(*environment, modelPath.toWideCharPointer(), *sessionOptions);
-        #else
-            session = std::make_unique<Ort::Session>(*environment, modelPath.toRawUTF8(), *sessionOptions);
-        #endif
+        if (!loadedFromCache)
+        {
+            try
+            {
+                createSession(environment, modelFile, threading,
+                              GraphOptimizationLevel::ORT_ENABLE_ALL, optimizedCache, backend, gpuConfig);
+            }
+            catch (const Ort::Exception&)
+            {
+                if (!useCache)
+                    throw;
+                
+                // The cache may not be writable (e.g. read-only Models folder)
+                optimizedCache.deleteFile();
+                createSession(environment, modelFile, threading,
+                              GraphOptimizationLevel::ORT_ENABLE_ALL, {}, backend, gpuConfig);
+            }
+        }
         
         // Get input/output metadata
         Ort::AllocatorWithDefaultOptions allocator;
@@ -52,7 +105,8 @@ bool OnnxModel::loadModel(const juce::String& modelPath)
         if (numInputNodes > 0)
         {
             auto inputName = session->GetInputNameAllocated(0, allocator);
-            inputNames.push_back(inputName.get());
+            inputNameStrings.push_back(inputName.get());
+            inputNames.push_back(inputNameStrings.back().c_str());
             
             auto inputTypeInfo = session->GetInputTypeInfo(0);
             auto tensorInfo = inputTypeInfo.GetTensorTypeAndShapeInfo();
@@ -64,7 +118,8 @@ bool OnnxModel::loadModel(const juce::String& modelPath)
         if (numOutputNodes > 0)
         {
             auto outputName = session->GetOutputNameAllocated(0, allocator);
-            outputNames.push_back(outputName.get());
+            outputNameStrings.push_back(outputName.get());
+            outputNames.push_back(outputNameStrings.back().c_str());
             
             auto outputTypeInfo = session->GetOutputTypeInfo(0);
             auto tensorInfo = outputTypeInfo.GetTensorTypeAndShapeInfo();
@@ -72,23 +127,79 @@ bool OnnxModel::loadModel(const juce::String& modelPath)
         }
         
         modelLoaded = true;
-        Logger::log(Logger::Level::Info, "ONNX model loaded: " + modelPath);
+        Logger::log(Logger::Level::Info, "ONNX model loaded: " + modelPath
+                    + (loadedFromCache ? " (optimized cache)" : ""));
         return true;
     }
     catch (const Ort::Exception& e)
     {
         Logger::log(Logger::Level::Error, "Failed to load ONNX model: " + juce::String(e.what()));
+        session.reset();
         modelLoaded = false;
         return false;
     }
 }
 
+void OnnxModel::createSession(Ort::Env& environment,
+                              const juce::File& file,
+                              const ThreadingProfile& threading,
+                              GraphOptimizationLevel optimizationLevel,
+                              const juce::File& saveOptimizedTo,
+                              GPUBackend backend,
+                              const GPUConfig& gpuConfig)
+{
+    // Configure session options for the role's threading profile
+    sessionOptions = std::make_unique<Ort::SessionOptions>();
+    
+    if (threading.useGlobalThreadPool)
+    {
+        // Run on the environment's shared pools instead of creating our own
+        sessionOptions->DisablePerSessionThreads();
+    }
+    else
+    {
+        // An intra-op count of 1 runs on the calling thread (no pool threads)
+        sessionOptions->SetIntraOpNumThreads(threading.intraOpThreads);
+        sessionOptions->SetInterOpNumThreads(threading.interOpThreads);
+    }
+    
+    sessionOptions->SetExecutionMode(threading.parallelExecution ? ExecutionMode::ORT_PARALLEL
+                                                                 : ExecutionMode::ORT_SEQUENTIAL);
+    sessionOptions->SetGraphOptimizationLevel(optimizationLevel);
+    
+    // Providers are tried in order of appending; ORT's CPU provider takes the rest
+    if (!GPUAccelerationManager::appendExecutionProvider(*sessionOptions, backend, gpuConfig))
+    {
+        if (!gpuConfig.fallbackToCPU)
+            throw Ort::Exception("Execution provider unavailable: "
+                                 + GPUAccelerationManager::getBackendName(backend).toStdString(), ORT_FAIL);
+        
+        Logger::log(Logger::Level::Warning, "Falling back to CPU for " + file.getFileName());
+    }
+    
+    // Graphs optimized at ORT_ENABLE_ALL may contain CPU-specific kernels, which
+    // is fine for a cache that lives with this machine's install
+    if (saveOptimizedTo != juce::File())
+    {
+        #ifdef _WIN32
+            sessionOptions->SetOptimizedModelFilePath(saveOptimizedTo.getFullPathName().toWideCharPointer());
+        #else
+            sessionOptions->SetOptimizedModelFilePath(saveOptimizedTo.getFullPathName().toRawUTF8());
+        #endif
+    }
+    
+    // Load the model
+    #ifdef _WIN32
+        session = std::make_unique<Ort::Session>(environment, file.getFullPathName().toWideCharPointer(), *sessionOptions);
+    #else
+        session = std::make_unique<Ort::Session>(environment, file.getFullPathName().toRawUTF8(), *sessionOptions);
+    #endif
+}
+
 bool OnnxModel::runInference(const std::vector<float>& inputData,
                              const std::vector<int64_t>& inputShape,
                              std::vector<float>& outputData)
 {
-    const juce::ScopedLock sl(modelLock);
-    
     if (!modelLoaded || !session)
         return false;
     
@@ -128,21 +239,215 @@ bool OnnxModel::runInference(const std::vector<float>& inputData,
     }
     catch (const Ort::Exception& e)
     {
-        Logger::log(Logger::Level::Error, "Inference failed: " + juce::String(e.what()));
+        Logger::logRealtime(Logger::Level::Error, Logger::Message::InferenceFailed, e.what());
+        return false;
+    }
+}
+
+bool OnnxModel::prepareInPlace(int numChannels, int numSamples, int batchSize)
+{
+    const juce::ScopedLock sl(modelLock);
+    
+    if (!modelLoaded || !session || numChannels <= 0 || numSamples <= 0 || batchSize <= 0)
+        return false;
+    
+    // A static batch dimension can only serve its own size
+    if (batchSize > 1 && !inputShape.empty() && inputShape[0] > 0 && inputShape[0] != batchSize)
+        return false;
+    
+    if (hasBinding(batchSize, numChannels, numSamples))
+        return true;
+    
+    std::vector<std::unique_ptr<BoundTensors>> added;
+    
+    try
+    {
+        for (int copy = 0; copy < BINDINGS_PER_SHAPE; ++copy)
+            added.push_back(createBinding(batchSize, numChannels, numSamples));
+    }
+    catch (const Ort::Exception& e)
+    {
+        Logger::log(Logger::Level::Error, "Failed to bind tensors: " + juce::String(e.what()));
         return false;
     }
+    
+    for (auto& bound : added)
+        boundTensors.push_back(std::move(bound));
+    
+    // Inference keeps walking the old table; the new one lists every binding
+    auto table = std::make_unique<BindingTable>();
+    for (const auto& bound : boundTensors)
+        table->push_back(bound.get());
+    
+    std::stable_sort(table->begin(), table->end(), [](const BoundTensors* a, const BoundTensors* b)
+    {
+        return a->numSamples < b->numSamples;
+    });
+    
+    publishedBindings.store(table.get(), std::memory_order_release);
+    bindingTables.push_back(std::move(table));
+    return true;
+}
+
+bool OnnxModel::hasInPlaceBinding(int numChannels, int numSamples, int batchSize) const
+{
+    return hasBinding(batchSize, numChannels, numSamples);
+}
+
+bool OnnxModel::runInferenceInPlace(const float* const* input,
+                                    float* const* output,
+                                    int numChannels,
+                                    int numSamples)
+{
+    return runInferenceBatch(input, output, 1, numChannels, numSamples);
+}
+
+bool OnnxModel::runInferenceBatch(const float* const* input,
+                                  float* const* output,
+                                  int batchSize,
+                                  int numChannels,
+                                  int numSamples)
+{
+    if (!modelLoaded || !session)
+        return false;
+    
+    auto* bound = claimBinding(batchSize, numChannels, numSamples);
+    if (bound == nullptr)
+        return false;
+    
+    // Copy planar channels into the bound input tensor, zero-padding short blocks
+    for (int channel = 0; channel < batchSize * numChannels; ++channel)
+    {
+        float* dest = bound->inputStorage.data() + channel * bound->numSamples;
+        std::copy(input[channel], input[channel] + numSamples, dest);
+        std::fill(dest + numSamples, dest + bound->numSamples, 0.0f);
+    }
+    
+    try
+    {
+        session->Run(Ort::RunOptions{nullptr}, *bound->binding);
+    }
+    catch (const Ort::Exception& e)
+    {
+        bound->inUse.store(false, std::memory_order_release);
+        Logger::logRealtime(Logger::Level::Error, Logger::Message::InferenceFailed, e.what());
+        return false;
+    }
+    
+    // Map output channels back onto planar audio (mono output feeds all channels)
+    const int samplesToCopy = juce::jmin(numSamples, bound->outputSamples);
+    for (int item = 0; item < batchSize && bound->outputChannels > 0; ++item)
+    {
+        const float* itemOutput = bound->outputStorage.data()
+                                + item * bound->outputChannels * bound->outputSamples;
+        
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const int sourceChannel = juce::jmin(channel, bound->outputChannels - 1);
+            const float* source = itemOutput + sourceChannel * bound->outputSamples;
+            std::copy(source, source + samplesToCopy, output[item * numChannels + channel]);
+        }
+    }
+    
+    bound->inUse.store(false, std::memory_order_release);
+    return true;
+}
+
+std::unique_ptr<OnnxModel::BoundTensors> OnnxModel::createBinding(int batchSize, int numChannels, int numSamples) const
+{
+    auto bound = std::make_unique<BoundTensors>();
+    bound->batchSize = batchSize;
+    bound->numChannels = numChannels;
+    bound->numSamples = numSamples;
+    bound->inputDims = { batchSize, numChannels, numSamples };
+    
+    // Resolve dynamic output dimensions from the input block shape
+    bound->outputDims = bound->inputDims;
+    if (outputShape.size() == bound->outputDims.size())
+    {
+        for (size_t i = 1; i < outputShape.size(); ++i)
+        {
+            if (outputShape[i] > 0)
+                bound->outputDims[i] = outputShape[i];
+        }
+    }
+    bound->outputChannels = static_cast<int>(bound->outputDims[1]);
+    bound->outputSamples = static_cast<int>(bound->outputDims[2]);
+    
+    bound->inputStorage.assign(static_cast<size_t>(batchSize * numChannels * numSamples), 0.0f);
+    bound->outputStorage.assign(static_cast<size_t>(batchSize * bound->outputChannels * bound->outputSamples), 0.0f);
+    
+    auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    
+    bound->inputTensor = Ort::Value::CreateTensor<float>(
+        memoryInfo,
+        bound->inputStorage.data(),
+        bound->inputStorage.size(),
+        bound->inputDims.data(),
+        bound->inputDims.size()
+    );
+    
+    bound->outputTensor = Ort::Value::CreateTensor<float>(
+        memoryInfo,
+        bound->outputStorage.data(),
+        bound->outputStorage.size(),
+        bound->outputDims.data(),
+        bound->outputDims.size()
+    );
+    
+    bound->binding = std::make_unique<Ort::IoBinding>(*session);
+    bound->binding->BindInput(inputNames[0], bound->inputTensor);
+    bound->binding->BindOutput(outputNames[0], bound->outputTensor);
+    
+    return bound;
+}
+
+OnnxModel::BoundTensors* OnnxModel::claimBinding(int batchSize, int numChannels, int numSamples) const
+{
+    const auto* table = publishedBindings.load(std::memory_order_acquire);
+    if (table == nullptr)
+        return nullptr;
+    
+    // The table is sorted, so the first free fit pads short blocks the least
+    for (auto* bound : *table)
+    {
+        if (bound->batchSize == batchSize && bound->numChannels == numChannels
+            && bound->numSamples >= numSamples
+            && !bound->inUse.exchange(true, std::memory_order_acquire))
+        {
+            return bound;
+        }
+    }
+    return nullptr;
+}
+
+bool OnnxModel::hasBinding(int batchSize, int numChannels, int numSamples) const
+{
+    const auto* table = publishedBindings.load(std::memory_order_acquire);
+    if (table == nullptr)
+        return false;
+    
+    return std::any_of(table->begin(), table->end(), [&](const BoundTensors* bound)
+    {
+        return bound->batchSize == batchSize && bound->numChannels == numChannels
+               && bound->numSamples >= numSamples;
+    });
 }
 
 void OnnxModel::unload()
 {
     const juce::ScopedLock sl(modelLock);
     
+    publishedBindings.store(nullptr, std::memory_order_release);
+    bindingTables.clear();
+    boundTensors.clear();
     session.reset();
     sessionOptions.reset();
-    environment.reset();
     
     inputNames.clear();
     outputNames.clear();
+    inputNameStrings.clear();
+    outputNameStrings.clear();
     inputShape.clear();
     outputShape.clear();
     
@@ -154,14 +459,39 @@ void OnnxModel::unload()
 //==============================================================================
 
 OnnxEngine::OnnxEngine()
-    : initialized(false)
+    : globalIntraOpThreads(juce::jmax(1, juce::SystemStats::getNumPhysicalCpus() / 2))
+    , globalInterOpThreads(1)
+    , initialized(false)
     , useGPU(false)
+    , optimizedModelCacheEnabled(true)
+    , qualityPreference(QualityPreference::Balanced)
+    , loadPool(juce::jlimit(1, 4, juce::SystemStats::getNumPhysicalCpus()))
+    , lazyLoader(*this)
 {
+    // Realtime roles: inference stays on the calling thread
+    realtimeProfile.intraOpThreads = 1;
+    realtimeProfile.interOpThreads = 1;
+    realtimeProfile.useGlobalThreadPool = false;
+    
+    // Offline roles: fan out over the shared global pools
+    offlineProfile.useGlobalThreadPool = true;
+    offlineProfile.parallelExecution = false;
+    
+    roleProfiles["vocal_tts"] = InferenceProfile::Offline;
+    
+    lazyLoader.startThread(juce::Thread::Priority::low);
 }
 
 OnnxEngine::~OnnxEngine()
 {
+    lazyLoader.stopThread(1000);
+    cancelPendingLoads();
     unloadAllModels();
+    
+    // Audio has stopped by now, so nothing else holds a reference
+    loadPool.removeAllJobs(true, -1);
+    retiredModels.clear();
+    environment.reset();
 }
 
 bool OnnxEngine::initialize()
@@ -173,44 +503,522 @@ bool OnnxEngine::initialize()
     
     try
     {
-        // ONNX Runtime is initialized per-model
+        // One environment for every model; its global pools serve offline roles
+        Ort::ThreadingOptions threadingOptions;
+        threadingOptions.SetGlobalIntraOpNumThreads(globalIntraOpThreads);
+        threadingOptions.SetGlobalInterOpNumThreads(globalInterOpThreads);
+        threadingOptions.SetGlobalSpinControl(0); // don't busy-wait between offline jobs
+        
+        environment = std::make_unique<Ort::Env>(threadingOptions, ORT_LOGGING_LEVEL_WARNING, "MAEVN");
+        
         initialized = true;
-        Logger::log(Logger::Level::Info, "ONNX Engine initialized");
+        Logger::log(Logger::Level::Info, "ONNX Engine initialized (global pool: "
+                    + juce::String(globalIntraOpThreads) + " intra-op, "
+                    + juce::String(globalInterOpThreads) + " inter-op threads)");
         return true;
     }
-    catch (...)
+    catch (const Ort::Exception& e)
     {
-        Logger::log(Logger::Level::Error, "Failed to initialize ONNX Engine");
+        Logger::log(Logger::Level::Error, "Failed to initialize ONNX Engine: " + juce::String(e.what()));
         return false;
     }
 }
 
+void OnnxEngine::setGlobalThreadPoolSize(int intraOpThreads, int interOpThreads)
+{
+    const juce::ScopedLock sl(engineLock);
+    
+    if (initialized)
+    {
+        Logger::log(Logger::Level::Warning, "Global thread pool size must be set before initialize()");
+        return;
+    }
+    
+    globalIntraOpThreads = juce::jmax(1, intraOpThreads);
+    globalInterOpThreads = juce::jmax(1, interOpThreads);
+}
+
+void OnnxEngine::setThreadingProfile(InferenceProfile profile, const ThreadingProfile& settings)
+{
+    const juce::ScopedLock sl(engineLock);
+    
+    auto& target = (profile == InferenceProfile::Offline) ? offlineProfile : realtimeProfile;
+    target = settings;
+    target.intraOpThreads = juce::jmax(1, target.intraOpThreads);
+    target.interOpThreads = juce::jmax(1, target.interOpThreads);
+}
+
+void OnnxEngine::setRoleProfile(const juce::String& role, InferenceProfile profile)
+{
+    const juce::ScopedLock sl(engineLock);
+    roleProfiles[role] = profile;
+}
+
+InferenceProfile OnnxEngine::getRoleProfile(const juce::String& role) const
+{
+    const juce::ScopedLock sl(engineLock);
+    
+    auto it = roleProfiles.find(role);
+    return it != roleProfiles.end() ? it->second : InferenceProfile::Realtime;
+}
+
+void OnnxEngine::setOptimizedModelCacheEnabled(bool enabled)
+{
+    const juce::ScopedLock sl(engineLock);
+    optimizedModelCacheEnabled = enabled;
+}
+
 bool OnnxEngine::loadModel(const juce::String& role, const juce::String& modelPath)
+{
+    int generation = 0;
+    {
+        const juce::ScopedLock sl(engineLock);
+        
+        if (!initialized && !initialize())
+            return false;
+        
+        modelPaths[role] = modelPath;
+        modelVariants.erase(role);
+        generation = ++loadGenerations[role];
+        setLoadState(role, ModelLoadState::Loading);
+    }
+    
+    notifyLoadState(role, ModelLoadState::Loading);
+    return buildAndPublish(role, modelPath, generation);
+}
+
+void OnnxEngine::registerModel(const juce::String& role, const juce::String& modelPath)
+{
+    const juce::ScopedLock sl(engineLock);
+    
+    modelPaths[role] = modelPath;
+    modelVariants.erase(role);
+    
+    const auto state = getModelLoadState(role);
+    if (state != ModelLoadState::Ready && state != ModelLoadState::Loading)
+        setLoadState(role, ModelLoadState::Registered);
+}
+
+bool OnnxEngine::loadModelAsync(const juce::String& role, const juce::String& modelPath)
 {
     const juce::ScopedLock sl(engineLock);
     
     if (!initialized && !initialize())
         return false;
     
-    // Check if file exists
+    auto pathIt = modelPaths.find(role);
+    if (getModelLoadState(role) == ModelLoadState::Loading
+        && pathIt != modelPaths.end() && pathIt->second == modelPath)
+        return true;
+    
+    modelPaths[role] = modelPath;
+    modelVariants.erase(role);
+    return queueLoad(role) != nullptr;
+}
+
+ModelLoadState OnnxEngine::getModelLoadState(const juce::String& role) const
+{
+    auto* slot = findSlot(role);
+    return slot != nullptr ? slot->state.load(std::memory_order_acquire) : ModelLoadState::Missing;
+}
+
+void OnnxEngine::cancelPendingLoads()
+{
+    // A session that is already being built can't be interrupted, so wait for it
+    loadPool.removeAllJobs(true, -1);
+    
+    const juce::ScopedLock sl(engineLock);
+    for (auto& pair : slots)
+    {
+        // Queued loads that never ran go back to loading on first use
+        auto loading = ModelLoadState::Loading;
+        pair.second->state.compare_exchange_strong(loading, ModelLoadState::Registered);
+    }
+}
+
+juce::ThreadPoolJob* OnnxEngine::queueLoad(const juce::String& role) const
+{
+    const auto path = resolveModelPath(role, getRoleBackend(role));
+    if (path.isEmpty())
+        return nullptr;
+    
+    const int generation = ++loadGenerations[role];
+    setLoadState(role, ModelLoadState::Loading);
+    
+    // Lazy loads start from const queries; the task only uses the engine's locked API
+    auto* task = new LoadTask(const_cast<OnnxEngine&>(*this), role, path, generation);
+    loadPool.addJob(task, true);
+    return task;
+}
+
+void OnnxEngine::registerModelVariants(const juce::String& role,
+                                       const std::map<ModelPrecision, juce::String>& variantPaths)
+{
+    if (variantPaths.empty())
+        return;
+    
+    const juce::ScopedLock sl(engineLock);
+    
+    modelVariants[role] = variantPaths;
+    modelPaths[role] = resolveModelPath(role, getRoleBackend(role));
+    
+    const auto state = getModelLoadState(role);
+    if (state != ModelLoadState::Ready && state != ModelLoadState::Loading)
+        setLoadState(role, ModelLoadState::Registered);
+}
+
+void OnnxEngine::setQualityPreference(QualityPreference preference)
+{
+    const juce::ScopedLock sl(engineLock);
+    qualityPreference = preference;
+}
+
+ModelPrecision OnnxEngine::getModelPrecision(const juce::String& role) const
+{
+    const juce::ScopedLock sl(engineLock);
+    
+    auto it = loadedPrecisions.find(role);
+    return it != loadedPrecisions.end() ? it->second : ModelPrecision::FP32;
+}
+
+juce::String OnnxEngine::getPrecisionName(ModelPrecision precision)
+{
+    switch (precision)
+    {
+        case ModelPrecision::FP32:  return "fp32";
+        case ModelPrecision::FP16:  return "fp16";
+        case ModelPrecision::INT8:  return "int8";
+        default:                    return "unknown";
+    }
+}
+
+bool OnnxEngine::parsePrecision(const juce::String& name, ModelPrecision& precision)
+{
+    for (auto candidate : { ModelPrecision::FP32, ModelPrecision::FP16, ModelPrecision::INT8 })
+    {
+        if (name.equalsIgnoreCase(getPrecisionName(candidate)))
+        {
+            precision = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+juce::String OnnxEngine::resolveModelPath(const juce::String& role, GPUBackend backend) const
+{
+    auto variantsIt = modelVariants.find(role);
+    if (variantsIt == modelVariants.end())
+    {
+        auto pathIt = modelPaths.find(role);
+        return pathIt != modelPaths.end() ? pathIt->second : juce::String();
+    }
+    
+    // Variants the export pipeline didn't produce are skipped
+    std::map<ModelPrecision, juce::String> available;
+    for (const auto& variant : variantsIt->second)
+    {
+        if (juce::File(variant.second).existsAsFile())
+            available.insert(variant);
+    }
+    
+    if (available.empty())
+    {
+        // Let the load report the missing file
+        auto fp32It = variantsIt->second.find(ModelPrecision::FP32);
+        return fp32It != variantsIt->second.end() ? fp32It->second : variantsIt->second.begin()->second;
+    }
+    
+    return available[choosePrecision(backend, available)];
+}
+
+ModelPrecision OnnxEngine::choosePrecision(GPUBackend backend,
+                                           const std::map<ModelPrecision, juce::String>& available) const
+{
+    auto has = [&available](ModelPrecision precision) { return available.count(precision) > 0; };
+    
+    if (qualityPreference != QualityPreference::Quality)
+    {
+        if (backend != GPUBackend::None)
+        {
+            // fp16 runs natively on Tensor Cores, DirectML, CoreML and OpenVINO GPUs;
+            // dynamic int8 kernels are CPU-oriented
+            const bool nvidia = backend == GPUBackend::CUDA || backend == GPUBackend::TensorRT;
+            const bool tensorCores = executionConfig.useTensorCores && executionDevice.computeCapability >= 7.0f;
+            const bool fastHalf = !nvidia || tensorCores;
+            
+            if (has(ModelPrecision::FP16) && (fastHalf || qualityPreference == QualityPreference::Performance))
+                return ModelPrecision::FP16;
+        }
+        else
+        {
+            // ORT's CPU provider has few fp16 kernels; int8 pays off most with dot-product instructions
+            if (has(ModelPrecision::INT8)
+                && (qualityPreference == QualityPreference::Performance || cpuHasInt8DotProduct()))
+                return ModelPrecision::INT8;
+        }
+    }
+    
+    if (has(ModelPrecision::FP32))
+        return ModelPrecision::FP32;
+    
+    // Only reduced-precision variants were exported; prefer the more accurate one
+    return has(ModelPrecision::FP16) && backend != GPUBackend::None ? ModelPrecision::FP16
+                                                                     : available.begin()->first;
+}
+
+bool OnnxEngine::cpuHasInt8DotProduct()
+{
+   #if JUCE_INTEL
+    // AVX512-VNNI: CPUID leaf 7 ECX bit 11; AVX-VNNI: leaf 7 subleaf 1 EAX bit 4
+    #if JUCE_MSVC
+     int info[4] = {};
+     __cpuid(info, 0);
+     if (info[0] < 7)
+         return false;
+     
+     __cpuidex(info, 7, 0);
+     const bool avx512Vnni = (info[2] & (1 << 11)) != 0;
+     __cpuidex(info, 7, 1);
+     const bool avxVnni = (info[0] & (1 << 4)) != 0;
+    #else
+     if (__get_cpuid_max(0, nullptr) < 7)
+         return false;
+     
+     unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+     __cpuid_count(7, 0, eax, ebx, ecx, edx);
+     const bool avx512Vnni = (ecx & (1u << 11)) != 0;
+     __cpuid_count(7, 1, eax, ebx, ecx, edx);
+     const bool avxVnni = (eax & (1u << 4)) != 0;
+    #endif
+    return avx512Vnni || avxVnni;
+   #elif JUCE_ARM && JUCE_64BIT
+    // ARMv8.2 SDOT/UDOT are optional (ARMv8.0 cores such as Cortex-A53/A72 lack them),
+    // so ask the OS; 32-bit ARM builds never use them
+    #if JUCE_LINUX || JUCE_ANDROID
+     constexpr unsigned long hwcapAsimdDotProduct = 1ul << 20; // HWCAP_ASIMDDP
+     return (getauxval(AT_HWCAP) & hwcapAsimdDotProduct) != 0;
+    #elif JUCE_MAC || JUCE_IOS
+     int hasDotProduct = 0;
+     size_t size = sizeof(hasDotProduct);
+     return sysctlbyname("hw.optional.arm.FEAT_DotProd", &hasDotProduct, &size, nullptr, 0) == 0
+         && hasDotProduct != 0;
+    #elif JUCE_WINDOWS
+     #ifndef PF_ARM_V82_DP_INSTRUCTIONS_AVAILABLE
+      #define PF_ARM_V82_DP_INSTRUCTIONS_AVAILABLE 43
+     #endif
+     return IsProcessorFeaturePresent(PF_ARM_V82_DP_INSTRUCTIONS_AVAILABLE) != 0;
+    #else
+     return false;
+    #endif
+   #else
+    return false;
+   #endif
+}
+
+void OnnxEngine::requestLazyLoad(const juce::String& role) const
+{
+    if (getModelLoadState(role) == ModelLoadState::Registered)
+        queueLoad(role);
+}
+
+void OnnxEngine::serviceLazyLoads()
+{
+    const juce::ScopedLock sl(engineLock);
+    
+    for (const auto& pair : slots)
+    {
+        if (pair.second->loadWanted.exchange(false, std::memory_order_acquire))
+            requestLazyLoad(pair.first);
+    }
+}
+
+bool OnnxEngine::buildAndPublish(const juce::String& role, const juce::String& modelPath, int generation)
+{
+    ThreadingProfile threading;
+    GPUBackend backend = GPUBackend::None;
+    GPUConfig gpuConfig;
+    bool useCache = false;
+    {
+        const juce::ScopedLock sl(engineLock);
+        
+        if (!initialized && !initialize())
+        {
+            setLoadState(role, ModelLoadState::Failed);
+            return false;
+        }
+        
+        threading = (getRoleProfile(role) == InferenceProfile::Offline) ? offlineProfile : realtimeProfile;
+        backend = getRoleBackend(role);
+        gpuConfig = executionConfig;
+        
+        // Graphs optimized for the CPU provider don't transfer to GPU providers
+        useCache = optimizedModelCacheEnabled && backend == GPUBackend::None;
+    }
+    
+    // Build the session without holding engineLock so inference keeps running
+    std::shared_ptr<OnnxModel> model;
     juce::File modelFile(modelPath);
+    
     if (!modelFile.existsAsFile())
     {
         Logger::log(Logger::Level::Error, "Model file not found: " + modelPath);
-        return false;
+    }
+    else
+    {
+        const auto cacheFile = useCache ? modelFile.getSiblingFile(modelFile.getFileNameWithoutExtension()
+                                                                   + ".optimized.onnx")
+                                        : juce::File();
+        
+        model = std::make_shared<OnnxModel>();
+        if (!model->loadModel(*environment, modelPath, threading, cacheFile, backend, gpuConfig))
+            model.reset();
     }
     
-    // Create and load model
-    auto model = std::make_unique<OnnxModel>();
-    if (model->loadModel(modelPath))
+    const auto state = model ? ModelLoadState::Ready : ModelLoadState::Failed;
     {
-        models[role] = std::move(model);
-        modelPaths[role] = modelPath;
-        Logger::log(Logger::Level::Info, "Loaded model [" + role + "]: " + modelPath);
-        return true;
+        const juce::ScopedLock sl(engineLock);
+        
+        // A newer load or an unload superseded this one
+        auto genIt = loadGenerations.find(role);
+        if (genIt == loadGenerations.end() || genIt->second != generation)
+            return false;
+        
+        if (model)
+        {
+            // Bind zero-copy shapes requested before or during this load
+            auto shapesIt = inPlaceShapes.find(role);
+            if (shapesIt != inPlaceShapes.end())
+            {
+                for (const auto& shape : shapesIt->second)
+                    model->prepareInPlace(shape.numChannels, shape.numSamples, shape.batchSize);
+            }
+            
+            // Record which variant (if any) this path is
+            auto& precision = loadedPrecisions[role];
+            precision = ModelPrecision::FP32;
+            auto variantsIt = modelVariants.find(role);
+            if (variantsIt != modelVariants.end())
+            {
+                for (const auto& variant : variantsIt->second)
+                {
+                    if (variant.second == modelPath)
+                        precision = variant.first;
+                }
+            }
+            
+            // Publish: new calls pick up the new session, in-flight ones finish on the old
+            retireModel(std::atomic_exchange(&getSlot(role).model, std::move(model)));
+        }
+        
+        setLoadState(role, state);
     }
     
-    return false;
+    if (state == ModelLoadState::Ready)
+        Logger::log(Logger::Level::Info, "Loaded model [" + role + "] on "
+                    + GPUAccelerationManager::getBackendName(backend) + " ("
+                    + getPrecisionName(getModelPrecision(role)) + "): " + modelPath);
+    
+    releaseRetiredModels();
+    
+    notifyLoadState(role, state);
+    return state == ModelLoadState::Ready;
+}
+
+std::shared_ptr<OnnxModel> OnnxEngine::acquireModel(const juce::String& role) const
+{
+    // Ready models are read without engineLock; inference runs on the caller's reference
+    auto* slot = findSlot(role);
+    if (slot == nullptr)
+        return nullptr;
+    
+    auto model = std::atomic_load(&slot->model);
+    if (model != nullptr && model->isReady())
+        return model;
+    
+    // Callers may be on the audio thread, so the lazy loader queues the load
+    if (slot->state.load(std::memory_order_acquire) == ModelLoadState::Registered)
+        slot->loadWanted.store(true, std::memory_order_release);
+    
+    return nullptr;
+}
+
+OnnxEngine::ModelSlot* OnnxEngine::findSlot(const juce::String& role) const
+{
+    const auto* slotMap = publishedSlots.load(std::memory_order_acquire);
+    if (slotMap == nullptr)
+        return nullptr;
+    
+    auto it = slotMap->find(role);
+    return it != slotMap->end() ? it->second : nullptr;
+}
+
+OnnxEngine::ModelSlot& OnnxEngine::getSlot(const juce::String& role) const
+{
+    auto it = slots.find(role);
+    if (it != slots.end())
+        return *it->second;
+    
+    auto& slot = slots[role];
+    slot = std::make_unique<ModelSlot>();
+    
+    // Readers keep walking the old table; the new one adds this role
+    auto slotMap = std::make_unique<SlotMap>();
+    for (const auto& pair : slots)
+        (*slotMap)[pair.first] = pair.second.get();
+    
+    publishedSlots.store(slotMap.get(), std::memory_order_release);
+    slotMaps.push_back(std::move(slotMap));
+    return *slot;
+}
+
+void OnnxEngine::retireModel(std::shared_ptr<OnnxModel> model)
+{
+    if (model == nullptr)
+        return;
+    
+    retiredModels.push_back(std::move(model));
+    
+    // The pool thread frees it once no inference holds a reference
+    loadPool.addJob(new ReleaseTask(*this), true);
+}
+
+int OnnxEngine::releaseRetiredModels()
+{
+    std::vector<std::shared_ptr<OnnxModel>> released;
+    int remaining = 0;
+    {
+        const juce::ScopedLock sl(engineLock);
+        
+        for (auto it = retiredModels.begin(); it != retiredModels.end();)
+        {
+            if (it->use_count() == 1)
+            {
+                released.push_back(std::move(*it));
+                it = retiredModels.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        remaining = static_cast<int>(retiredModels.size());
+    }
+    
+    // Sessions are destroyed here, outside the lock and off the audio thread
+    released.clear();
+    return remaining;
+}
+
+void OnnxEngine::setLoadState(const juce::String& role, ModelLoadState state) const
+{
+    getSlot(role).state.store(state, std::memory_order_release);
+}
+
+void OnnxEngine::notifyLoadState(const juce::String& role, ModelLoadState state)
+{
+    if (onModelLoadStateChanged)
+        onModelLoadStateChanged(role, state);
 }
 
 bool OnnxEngine::runInference(const juce::String& role,
@@ -218,22 +1026,78 @@ bool OnnxEngine::runInference(const juce::String& role,
                               const std::vector<int64_t>& inputShape,
                               std::vector<float>& outputData)
 {
-    const juce::ScopedLock sl(engineLock);
+    if (auto model = acquireModel(role))
+        return model->runInference(inputData, inputShape, outputData);
     
-    auto it = models.find(role);
-    if (it != models.end() && it->second->isReady())
+    // Registered roles are about to be queued by the lazy loader
+    const auto state = getModelLoadState(role);
+    if (state != ModelLoadState::Loading && state != ModelLoadState::Registered)
+        Logger::logRealtime(Logger::Level::Warning, Logger::Message::ModelNotReady, role.toRawUTF8());
+    return false;
+}
+
+bool OnnxEngine::prepareInPlaceInference(const juce::String& role, int numChannels, int numSamples)
+{
+    return prepareBatchInference(role, 1, numChannels, numSamples);
+}
+
+bool OnnxEngine::prepareBatchInference(const juce::String& role, int batchSize, int numChannels, int numSamples)
+{
+    std::shared_ptr<OnnxModel> model;
     {
-        return it->second->runInference(inputData, inputShape, outputData);
+        const juce::ScopedLock sl(engineLock);
+        
+        auto& shapes = inPlaceShapes[role];
+        const BlockShape shape { batchSize, numChannels, numSamples };
+        if (std::find(shapes.begin(), shapes.end(), shape) == shapes.end())
+            shapes.push_back(shape);
+        
+        if (auto* slot = findSlot(role))
+            model = std::atomic_load(&slot->model);
     }
     
-    Logger::log(Logger::Level::Warning, "Model not found or not ready: " + role);
+    return model != nullptr && model->isReady() && model->prepareInPlace(numChannels, numSamples, batchSize);
+}
+
+bool OnnxEngine::isBatchReady(const juce::String& role, int batchSize, int numChannels, int numSamples) const
+{
+    auto model = acquireModel(role);
+    return model != nullptr && model->hasInPlaceBinding(numChannels, numSamples, batchSize);
+}
+
+bool OnnxEngine::runInferenceBatch(const juce::String& role,
+                                   const float* const* input,
+                                   float* const* output,
+                                   int batchSize,
+                                   int numChannels,
+                                   int numSamples)
+{
+    if (auto model = acquireModel(role))
+        return model->runInferenceBatch(input, output, batchSize, numChannels, numSamples);
+    
     return false;
 }
 
-int OnnxEngine::loadModelsFromConfig(const juce::String& configPath)
+bool OnnxEngine::isInPlaceReady(const juce::String& role, int numChannels, int numSamples) const
 {
-    const juce::ScopedLock sl(engineLock);
+    auto model = acquireModel(role);
+    return model != nullptr && model->hasInPlaceBinding(numChannels, numSamples);
+}
+
+bool OnnxEngine::runInferenceInPlace(const juce::String& role,
+                                     const float* const* input,
+                                     float* const* output,
+                                     int numChannels,
+                                     int numSamples)
+{
+    if (auto model = acquireModel(role))
+        return model->runInferenceInPlace(input, output, numChannels, numSamples);
     
+    return false;
+}
+
+int OnnxEngine::loadModelsFromConfig(const juce::String& configPath, ModelLoadPolicy policy)
+{
     juce::File configFile(configPath);
     if (!configFile.existsAsFile())
     {
@@ -245,19 +1109,72 @@ int OnnxEngine::loadModelsFromConfig(const juce::String& configPath)
     if (!config.isObject())
         return 0;
     
-    int loadedCount = 0;
+    juce::StringArray roles;
+    std::vector<juce::ThreadPoolJob*> jobs;
     auto* obj = config.getDynamicObject();
     
-    for (auto& prop : obj->getProperties())
     {
-        juce::String role = prop.name.toString();
-        juce::String path = prop.value.toString();
+        const juce::ScopedLock sl(engineLock);
         
-        // Make path absolute if relative (paths in config.json are typically relative)
-        juce::File baseDir = configFile.getParentDirectory();
-        juce::File modelFile = baseDir.getChildFile(path);
+        if (!initialized && !initialize())
+            return 0;
         
-        if (loadModel(role, modelFile.getFullPathName()))
+        for (auto& prop : obj->getProperties())
+        {
+            juce::String role = prop.name.toString();
+            
+            // Make path absolute if relative (paths in config.json are typically relative)
+            juce::File baseDir = configFile.getParentDirectory();
+            
+            if (auto* variantsObj = prop.value.getDynamicObject())
+            {
+                // { "fp32": "...", "fp16": "...", "int8": "..." }
+                std::map<ModelPrecision, juce::String> variants;
+                for (auto& variant : variantsObj->getProperties())
+                {
+                    ModelPrecision precision;
+                    if (parsePrecision(variant.name.toString(), precision))
+                        variants[precision] = baseDir.getChildFile(variant.value.toString()).getFullPathName();
+                    else
+                        Logger::log(Logger::Level::Warning, "Unknown precision '" + variant.name.toString()
+                                    + "' for model role: " + role);
+                }
+                
+                if (variants.empty())
+                    continue;
+                
+                registerModelVariants(role, variants);
+            }
+            else
+            {
+                juce::File modelFile = baseDir.getChildFile(prop.value.toString());
+                registerModel(role, modelFile.getFullPathName());
+            }
+            
+            roles.add(role);
+            
+            if (policy != ModelLoadPolicy::Lazy)
+            {
+                if (auto* job = queueLoad(role))
+                    jobs.push_back(job);
+            }
+        }
+    }
+    
+    if (policy != ModelLoadPolicy::Blocking)
+    {
+        Logger::log(Logger::Level::Info, "Registered " + juce::String(roles.size()) + " models from config"
+                    + (policy == ModelLoadPolicy::Lazy ? " (lazy)" : " (loading in background)"));
+        return roles.size();
+    }
+    
+    for (auto* job : jobs)
+        loadPool.waitForJobToFinish(job, -1);
+    
+    int loadedCount = 0;
+    for (const auto& role : roles)
+    {
+        if (getModelLoadState(role) == ModelLoadState::Ready)
             loadedCount++;
     }
     
@@ -267,33 +1184,48 @@ int OnnxEngine::loadModelsFromConfig(const juce::String& configPath)
 
 bool OnnxEngine::reloadModel(const juce::String& role)
 {
-    const juce::ScopedLock sl(engineLock);
+    juce::String path;
+    int generation = 0;
+    {
+        const juce::ScopedLock sl(engineLock);
+        
+        // Re-resolve so variant choice follows backend and preference changes
+        path = resolveModelPath(role, getRoleBackend(role));
+        if (path.isEmpty())
+            return false;
+        
+        generation = ++loadGenerations[role];
+        setLoadState(role, ModelLoadState::Loading);
+    }
     
-    auto pathIt = modelPaths.find(role);
-    if (pathIt == modelPaths.end())
-        return false;
+    notifyLoadState(role, ModelLoadState::Loading);
     
-    unloadModel(role);
-    return loadModel(role, pathIt->second);
+    // The current model keeps serving until the new one is published
+    return buildAndPublish(role, path, generation);
 }
 
 bool OnnxEngine::isModelReady(const juce::String& role) const
 {
-    const juce::ScopedLock sl(engineLock);
-    
-    auto it = models.find(role);
-    return (it != models.end() && it->second->isReady());
+    return acquireModel(role) != nullptr;
 }
 
 void OnnxEngine::unloadModel(const juce::String& role)
 {
     const juce::ScopedLock sl(engineLock);
     
-    auto it = models.find(role);
-    if (it != models.end())
+    // Discard any load still in flight for this role
+    ++loadGenerations[role];
+    
+    auto* slot = findSlot(role);
+    if (slot == nullptr)
+        return;
+    
+    slot->state.store(ModelLoadState::Missing, std::memory_order_release);
+    
+    // Inference already running on it finishes before it is freed
+    if (auto model = std::atomic_exchange(&slot->model, std::shared_ptr<OnnxModel>()))
     {
-        it->second->unload();
-        models.erase(it);
+        retireModel(std::move(model));
         Logger::log(Logger::Level::Info, "Unloaded model: " + role);
     }
 }
@@ -302,12 +1234,18 @@ void OnnxEngine::unloadAllModels()
 {
     const juce::ScopedLock sl(engineLock);
     
-    for (auto& pair : models)
+    for (auto& pair : slots)
     {
-        pair.second->unload();
+        pair.second->state.store(ModelLoadState::Missing, std::memory_order_release);
+        retireModel(std::atomic_exchange(&pair.second->model, std::shared_ptr<OnnxModel>()));
     }
-    models.clear();
     modelPaths.clear();
+    modelVariants.clear();
+    loadedPrecisions.clear();
+    
+    // Keep the generation counters so in-flight loads are discarded
+    for (auto& pair : loadGenerations)
+        ++pair.second;
     
     Logger::log(Logger::Level::Info, "All models unloaded");
 }
@@ -317,20 +1255,265 @@ juce::StringArray OnnxEngine::getLoadedModels() const
     const juce::ScopedLock sl(engineLock);
     
     juce::StringArray result;
-    for (const auto& pair : models)
+    for (const auto& pair : slots)
     {
-        if (pair.second->isReady())
+        auto model = std::atomic_load(&pair.second->model);
+        if (model != nullptr && model->isReady())
             result.add(pair.first);
     }
     return result;
 }
 
+juce::String OnnxEngine::getModelPath(const juce::String& role) const
+{
+    const juce::ScopedLock sl(engineLock);
+    
+    auto it = modelPaths.find(role);
+    return it != modelPaths.end() ? it->second : juce::String();
+}
+
+std::vector<int64_t> OnnxEngine::getModelInputShape(const juce::String& role) const
+{
+    auto* slot = findSlot(role);
+    auto model = slot != nullptr ? std::atomic_load(&slot->model) : nullptr;
+    return model != nullptr && model->isReady() ? model->getInputShape() : std::vector<int64_t>();
+}
+
 void OnnxEngine::setUseGPU(bool shouldUseGPU)
 {
+    const juce::ScopedLock sl(engineLock);
+    
     useGPU = shouldUseGPU;
     Logger::log(Logger::Level::Info, "GPU acceleration: " + juce::String(useGPU ? "enabled" : "disabled"));
 }
 
+void OnnxEngine::setExecutionConfig(const GPUConfig& config)
+{
+    const juce::ScopedLock sl(engineLock);
+    executionConfig = config;
+}
+
+void OnnxEngine::setExecutionDevice(const GPUDeviceInfo& device)
+{
+    const juce::ScopedLock sl(engineLock);
+    executionDevice = device;
+}
+
+void OnnxEngine::setRoleBackend(const juce::String& role, GPUBackend backend)
+{
+    const juce::ScopedLock sl(engineLock);
+    roleBackends[role] = backend;
+}
+
+GPUBackend OnnxEngine::getRoleBackend(const juce::String& role) const
+{
+    const juce::ScopedLock sl(engineLock);
+    
+    auto it = roleBackends.find(role);
+    if (it != roleBackends.end())
+        return it->second;
+    
+    return useGPU ? executionConfig.preferredBackend : GPUBackend::None;
+}
+
+BackendBenchmarkResult OnnxEngine::benchmarkModel(const juce::String& role,
+                                                  GPUBackend backend,
+                                                  int blockSize,
+                                                  int iterations)
+{
+    BackendBenchmarkResult result;
+    result.role = role;
+    result.backend = backend;
+    result.blockSize = blockSize;
+    
+    juce::String modelPath;
+    ThreadingProfile threading;
+    GPUConfig gpuConfig;
+    {
+        const juce::ScopedLock sl(engineLock);
+        
+        modelPath = resolveModelPath(role, backend);
+        if (!initialized || modelPath.isEmpty() || blockSize <= 0)
+            return result;
+        
+        threading = (getRoleProfile(role) == InferenceProfile::Offline) ? offlineProfile : realtimeProfile;
+        gpuConfig = executionConfig;
+    }
+    
+    // A silent CPU fallback would be timed as the GPU backend
+    gpuConfig.fallbackToCPU = false;
+    
+    OnnxModel model;
+    if (!model.loadModel(*environment, modelPath, threading, {}, backend, gpuConfig))
+        return result;
+    
+    auto shape = model.getInputShape();
+    if (shape.empty())
+        return result;
+    
+    size_t numElements = 1;
+    for (size_t i = 0; i < shape.size(); ++i)
+    {
+        if (shape[i] <= 0)
+            shape[i] = (i + 1 == shape.size()) ? blockSize : (i == 0 ? 1 : 2);
+        numElements *= static_cast<size_t>(shape[i]);
+    }
+    
+    std::vector<float> input(numElements);
+    std::vector<float> output;
+    juce::Random random;
+    for (auto& sample : input)
+        sample = random.nextFloat() * 2.0f - 1.0f;
+    
+    // Warm-up runs absorb arena growth and kernel compilation
+    for (int i = 0; i < 3; ++i)
+    {
+        if (!model.runInference(input, shape, output))
+            return result;
+    }
+    
+    for (int i = 0; i < juce::jmax(1, iterations); ++i)
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        if (!model.runInference(input, shape, output))
+            return result;
+        
+        const auto elapsedTicks = juce::Time::getHighResolutionTicks() - startTicks;
+        result.metrics.update(juce::Time::highResolutionTicksToSeconds(elapsedTicks) * 1000.0);
+    }
+    
+    result.succeeded = true;
+    return result;
+}
+
+void OnnxEngine::selectFastestBackends(const std::vector<BackendBenchmarkResult>& results)
+{
+    struct Candidate
+    {
+        double cost = 0.0;
+        int attempts = 0;
+        int runs = 0;
+    };
+    
+    std::unordered_map<juce::String, std::map<GPUBackend, Candidate>> candidates;
+    
+    for (const auto& result : results)
+    {
+        auto& candidate = candidates[result.role][result.backend];
+        candidate.attempts++;
+        
+        if (!result.succeeded)
+            continue;
+        
+        // Realtime roles have to make every block's deadline
+        const bool realtime = getRoleProfile(result.role) == InferenceProfile::Realtime;
+        candidate.cost += realtime ? result.metrics.maxInferenceTimeMs : result.metrics.averageInferenceTimeMs;
+        candidate.runs++;
+    }
+    
+    for (const auto& rolePair : candidates)
+    {
+        const auto& role = rolePair.first;
+        
+        int requiredRuns = 0;
+        for (const auto& backendPair : rolePair.second)
+            requiredRuns = juce::jmax(requiredRuns, backendPair.second.attempts);
+        
+        bool found = false;
+        GPUBackend fastest = GPUBackend::None;
+        double bestCost = 0.0;
+        
+        for (const auto& backendPair : rolePair.second)
+        {
+            const auto& candidate = backendPair.second;
+            if (candidate.runs < requiredRuns)
+                continue;
+            
+            if (!found || candidate.cost < bestCost)
+            {
+                found = true;
+                fastest = backendPair.first;
+                bestCost = candidate.cost;
+            }
+        }
+        
+        if (!found || fastest == getRoleBackend(role))
+            continue;
+        
+        setRoleBackend(role, fastest);
+        Logger::log(Logger::Level::Info, "Role [" + role + "] switched to "
+                    + GPUAccelerationManager::getBackendName(fastest));
+        
+        // Swap in a session on the new backend without interrupting audio
+        const juce::ScopedLock sl(engineLock);
+        queueLoad(role);
+    }
+}
+
+//==============================================================================
+// LoadTask Implementation
+//==============================================================================
+
+OnnxEngine::LoadTask::LoadTask(OnnxEngine& owner, const juce::String& role,
+                               const juce::String& modelPath, int generation)
+    : ThreadPoolJob("Load model: " + role)
+    , engine(owner)
+    , modelRole(role)
+    , path(modelPath)
+    , loadGeneration(generation)
+{
+}
+
+juce::ThreadPoolJob::JobStatus OnnxEngine::LoadTask::runJob()
+{
+    if (shouldExit())
+        return jobHasFinished;
+    
+    engine.notifyLoadState(modelRole, ModelLoadState::Loading);
+    engine.buildAndPublish(modelRole, path, loadGeneration);
+    
+    return jobHasFinished;
+}
+
+//==============================================================================
+// LazyLoader Implementation
+//==============================================================================
+
+OnnxEngine::LazyLoader::LazyLoader(OnnxEngine& owner)
+    : juce::Thread("MAEVN Lazy Model Loader")
+    , engine(owner)
+{
+}
+
+void OnnxEngine::LazyLoader::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(LAZY_LOAD_POLL_MS);
+        engine.serviceLazyLoads();
+    }
+}
+
+//==============================================================================
+// ReleaseTask Implementation
+//==============================================================================
+
+OnnxEngine::ReleaseTask::ReleaseTask(OnnxEngine& owner)
+    : ThreadPoolJob("Release retired models")
+    , engine(owner)
+{
+}
+
+juce::ThreadPoolJob::JobStatus OnnxEngine::ReleaseTask::runJob()
+{
+    if (engine.releaseRetiredModels() == 0 || shouldExit())
+        return jobHasFinished;
+    
+    // An inference still holds a retired model; look again shortly
+    juce::Thread::sleep(5);
+    return jobNeedsRunningAgain;
+}
+
 juce::var OnnxEngine::parseConfigFile(const juce::String& configPath)
 {
     juce::File file(configPath);
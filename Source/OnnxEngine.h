@@ -5,6 +5,8 @@
  * This module provides a high-performance interface to ONNX Runtime for
  * loading and executing AI models in real-time audio processing context.
  * Supports hot-reloading, thread-safe inference, and multiple concurrent models.
+ * Inference takes a shared reference to the published model, so reloads and
+ * unloads never free a session that is still running.
  */
 
 #pragma once
@@ -14,28 +16,115 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
 #include <unordered_map>
+#include <functional>
+#include <map>
 #include "Utilities.h"
+#include "GPUAcceleration.h"
 
 namespace MAEVN
 {
 
+//==============================================================================
+/**
+ * @brief Scheduling class of a model role
+ * 
+ * Realtime roles run inside the audio callback and must not wake pool
+ * threads; offline roles (e.g. vocal_tts) render ahead and may fan out.
+ */
+enum class InferenceProfile
+{
+    Realtime = 0,
+    Offline
+};
+
+/**
+ * @brief ONNX Runtime threading settings for an inference profile
+ */
+struct ThreadingProfile
+{
+    int intraOpThreads = 1;            // per-session pool size (ignored with global pool)
+    int interOpThreads = 1;            // per-session pool size (ignored with global pool)
+    bool useGlobalThreadPool = false;  // share the engine-wide ORT thread pools
+    bool parallelExecution = false;    // ORT_PARALLEL instead of ORT_SEQUENTIAL
+};
+
+/**
+ * @brief Load state of a model role
+ */
+enum class ModelLoadState
+{
+    Missing = 0,    // role not known to the engine
+    Registered,     // path known, loads on first use
+    Loading,        // session being built on the load pool
+    Ready,          // loaded and serving inference
+    Failed          // file missing or session creation failed
+};
+
+/**
+ * @brief How loadModelsFromConfig() brings models in
+ */
+enum class ModelLoadPolicy
+{
+    Blocking = 0,   // load in parallel and wait for every role
+    Background,     // queue every role on the load pool and return
+    Lazy            // register paths; each role loads on first use
+};
+
+/**
+ * @brief Numeric precision of an exported model variant
+ */
+enum class ModelPrecision
+{
+    FP32 = 0,
+    FP16,
+    INT8            // dynamic-quantized weights
+};
+
+/**
+ * @brief User trade-off between fidelity and CPU/GPU cost
+ */
+enum class QualityPreference
+{
+    Quality = 0,    // always fp32
+    Balanced,       // reduced precision where the hardware runs it natively
+    Performance     // reduced precision whenever a variant exists
+};
+
 //==============================================================================
 /**
  * @brief ONNX model wrapper with inference capabilities
+ *
+ * A model is loaded before it is published and is not changed afterwards,
+ * except that tensor bindings may be added. Inference never takes
+ * modelLock, so it is safe on the audio thread.
  */
 class OnnxModel
 {
 public:
+    /** Bindings made per block shape, so concurrent callers each get their own */
+    static constexpr int BINDINGS_PER_SHAPE = 4;
+    
     OnnxModel();
     ~OnnxModel();
     
     /**
      * @brief Load ONNX model from file
+     * @param environment Shared ONNX Runtime environment (must outlive the model)
      * @param modelPath Full path to .onnx file
+     * @param threading Threading settings for the session
+     * @param optimizedCache Where ORT's optimized graph is cached (empty = no cache)
+     * @param backend Execution provider to append (None = CPU)
+     * @param gpuConfig Device settings for the execution provider
      * @return true if loaded successfully
      */
-    bool loadModel(const juce::String& modelPath);
+    bool loadModel(Ort::Env& environment,
+                   const juce::String& modelPath,
+                   const ThreadingProfile& threading,
+                   const juce::File& optimizedCache = {},
+                   GPUBackend backend = GPUBackend::None,
+                   const GPUConfig& gpuConfig = GPUConfig());
     
     /**
      * @brief Run inference on input data
@@ -48,6 +137,48 @@ public:
                      const std::vector<int64_t>& inputShape,
                      std::vector<float>& outputData);
     
+    /**
+     * @brief Pre-allocate and bind input/output tensors for a block shape
+     * 
+     * Tensors of shape {batchSize, numChannels, numSamples} are created once
+     * and bound with Ort::IoBinding so runInferenceInPlace() does no heap work.
+     * Batches above 1 need a model with a dynamic batch dimension. Not for
+     * the audio thread; the new bindings are published atomically, so
+     * inference already running is never held up.
+     * @return true if a binding for this shape is available
+     */
+    bool prepareInPlace(int numChannels, int numSamples, int batchSize = 1);
+    
+    /**
+     * @brief Check if a pre-bound tensor pair can serve this block
+     */
+    bool hasInPlaceBinding(int numChannels, int numSamples, int batchSize = 1) const;
+    
+    /**
+     * @brief Run inference on planar audio using pre-bound tensors
+     * 
+     * Blocks shorter than the prepared size are zero-padded. Input and
+     * output may point at the same memory. If every binding of this shape
+     * is busy on other threads, the block is left alone and false returned.
+     * @return true if inference succeeded
+     */
+    bool runInferenceInPlace(const float* const* input,
+                             float* const* output,
+                             int numChannels,
+                             int numSamples);
+    
+    /**
+     * @brief Run one batched inference over several planar blocks
+     * @param input batchSize * numChannels channel pointers, item-major
+     * @param output Same layout as input (may alias it)
+     * @return true if inference succeeded
+     */
+    bool runInferenceBatch(const float* const* input,
+                           float* const* output,
+                           int batchSize,
+                           int numChannels,
+                           int numSamples);
+    
     /**
      * @brief Check if model is loaded and ready
      */
@@ -69,17 +200,73 @@ public:
     void unload();
     
 private:
-    std::unique_ptr<Ort::Env> environment;
+    /**
+     * @brief Tensors pre-bound for one block shape
+     */
+    struct BoundTensors
+    {
+        int batchSize = 1;
+        int numChannels = 0;
+        int numSamples = 0;
+        int outputChannels = 0;
+        int outputSamples = 0;
+        
+        std::vector<float> inputStorage;
+        std::vector<float> outputStorage;
+        std::vector<int64_t> inputDims;
+        std::vector<int64_t> outputDims;
+        
+        Ort::Value inputTensor{nullptr};
+        Ort::Value outputTensor{nullptr};
+        std::unique_ptr<Ort::IoBinding> binding;
+        
+        std::atomic<bool> inUse { false };  // claimed by a running inference
+    };
+    
+    // Sorted by numSamples, so the first fit pads the least
+    using BindingTable = std::vector<BoundTensors*>;
+    
+    /**
+     * @brief Allocate and bind one tensor pair (throws Ort::Exception)
+     */
+    std::unique_ptr<BoundTensors> createBinding(int batchSize, int numChannels, int numSamples) const;
+    
+    /**
+     * @brief Smallest free binding that fits; the caller must release inUse
+     */
+    BoundTensors* claimBinding(int batchSize, int numChannels, int numSamples) const;
+    
+    /**
+     * @brief Check if any published binding fits this block
+     */
+    bool hasBinding(int batchSize, int numChannels, int numSamples) const;
+    
+    void createSession(Ort::Env& environment,
+                       const juce::File& file,
+                       const ThreadingProfile& threading,
+                       GraphOptimizationLevel optimizationLevel,
+                       const juce::File& saveOptimizedTo,
+                       GPUBackend backend,
+                       const GPUConfig& gpuConfig);
+    
     std::unique_ptr<Ort::Session> session;
     std::unique_ptr<Ort::SessionOptions> sessionOptions;
     
+    std::vector<std::string> inputNameStrings;
+    std::vector<std::string> outputNameStrings;
     std::vector<const char*> inputNames;
     std::vector<const char*> outputNames;
     std::vector<int64_t> inputShape;
     std::vector<int64_t> outputShape;
     
+    // Owned bindings and the tables listing them, added under modelLock.
+    // Old tables are kept until unload() since inference may still walk them.
+    std::vector<std::unique_ptr<BoundTensors>> boundTensors;
+    std::vector<std::unique_ptr<const BindingTable>> bindingTables;
+    std::atomic<const BindingTable*> publishedBindings { nullptr };
+    
     bool modelLoaded;
-    juce::CriticalSection modelLock;
+    mutable juce::CriticalSection modelLock;    // loading, unloading and binding only
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OnnxModel)
 };
@@ -95,19 +282,115 @@ public:
     ~OnnxEngine();
     
     /**
-     * @brief Initialize ONNX Runtime environment
+     * @brief Initialize the shared ONNX Runtime environment and global thread pools
      * @return true if initialization succeeded
      */
     bool initialize();
     
+    /**
+     * @brief Size the global ORT thread pools used by offline roles
+     * 
+     * Must be called before initialize(); the pools are created with the
+     * environment and cannot be resized afterwards.
+     */
+    void setGlobalThreadPoolSize(int intraOpThreads, int interOpThreads);
+    
+    /**
+     * @brief Set threading settings for an inference profile
+     * 
+     * Applies to models loaded afterwards (use reloadModel() to re-apply).
+     */
+    void setThreadingProfile(InferenceProfile profile, const ThreadingProfile& settings);
+    
+    /**
+     * @brief Assign a model role to an inference profile (default: Realtime,
+     *        except "vocal_tts" which is Offline)
+     */
+    void setRoleProfile(const juce::String& role, InferenceProfile profile);
+    
+    /**
+     * @brief Get the inference profile of a model role
+     */
+    InferenceProfile getRoleProfile(const juce::String& role) const;
+    
+    /**
+     * @brief Cache ORT's optimized graph next to each .onnx file
+     * 
+     * The first load writes "<model>.optimized.onnx"; later loads use it and
+     * skip graph optimization while it is newer than the source model.
+     */
+    void setOptimizedModelCacheEnabled(bool enabled);
+    
     /**
      * @brief Load a model with a specific role identifier
+     * 
+     * Blocks the caller while the session is built; inference on other
+     * roles continues meanwhile.
      * @param role Model identifier (e.g., "808", "vocal_tts", "piano")
      * @param modelPath Path to .onnx file
      * @return true if loaded successfully
      */
     bool loadModel(const juce::String& role, const juce::String& modelPath);
     
+    /**
+     * @brief Register a model path without loading it
+     * 
+     * The role loads on the background pool on its first isModelReady() or
+     * inference request.
+     */
+    void registerModel(const juce::String& role, const juce::String& modelPath);
+    
+    /**
+     * @brief Register precision variants of a role (fp32/fp16/int8)
+     * 
+     * The variant is chosen at load time from the role's backend, the
+     * detected hardware and the quality preference; variants missing on
+     * disk are skipped. Loads on first use like registerModel().
+     */
+    void registerModelVariants(const juce::String& role,
+                               const std::map<ModelPrecision, juce::String>& variantPaths);
+    
+    /**
+     * @brief Set the quality/performance preference for variant selection
+     * 
+     * Applies to models loaded afterwards (use reloadModel() to re-apply).
+     */
+    void setQualityPreference(QualityPreference preference);
+    QualityPreference getQualityPreference() const { return qualityPreference; }
+    
+    /**
+     * @brief Get the precision of the variant a role is running
+     */
+    ModelPrecision getModelPrecision(const juce::String& role) const;
+    
+    /**
+     * @brief Get the config.json key of a precision ("fp32", "fp16", "int8")
+     */
+    static juce::String getPrecisionName(ModelPrecision precision);
+    
+    /**
+     * @brief Queue a model load on the background pool
+     * @return true if a load was queued or is already in progress
+     */
+    bool loadModelAsync(const juce::String& role, const juce::String& modelPath);
+    
+    /**
+     * @brief Get the load state of a role (lock-free, any thread)
+     */
+    ModelLoadState getModelLoadState(const juce::String& role) const;
+    
+    /**
+     * @brief Called from the load pool whenever a role's load state changes
+     * 
+     * Never invoked while engine locks are held.
+     */
+    std::function<void(const juce::String& role, ModelLoadState state)> onModelLoadStateChanged;
+    
+    /**
+     * @brief Drop queued loads and wait for the ones already building
+     */
+    void cancelPendingLoads();
+    
     /**
      * @brief Run inference using a specific model
      * @param role Model identifier
@@ -121,22 +404,88 @@ public:
                      const std::vector<int64_t>& inputShape,
                      std::vector<float>& outputData);
     
+    /**
+     * @brief Pre-bind tensors for zero-copy inference on a role
+     * 
+     * The shape is remembered and re-bound whenever the role is (re)loaded.
+     * @param role Model identifier
+     * @param numChannels Number of planar audio channels
+     * @param numSamples Maximum block size
+     * @return true if the binding is ready now
+     */
+    bool prepareInPlaceInference(const juce::String& role, int numChannels, int numSamples);
+    
+    /**
+     * @brief Pre-bind tensors for cross-track batches of a role
+     * 
+     * Like prepareInPlaceInference() with a leading batch dimension.
+     * @return true if the binding is ready now (false for static-batch models)
+     */
+    bool prepareBatchInference(const juce::String& role, int batchSize, int numChannels, int numSamples);
+    
+    /**
+     * @brief Check if runInferenceBatch() can serve this batch shape
+     */
+    bool isBatchReady(const juce::String& role, int batchSize, int numChannels, int numSamples) const;
+    
+    /**
+     * @brief Run one inference over several planar blocks (one session Run)
+     * @param input batchSize * numChannels channel pointers, item-major
+     * @param output Same layout as input (may alias it)
+     * @return true if inference succeeded
+     */
+    bool runInferenceBatch(const juce::String& role,
+                           const float* const* input,
+                           float* const* output,
+                           int batchSize,
+                           int numChannels,
+                           int numSamples);
+    
+    /**
+     * @brief Check if runInferenceInPlace() can serve this block shape
+     */
+    bool isInPlaceReady(const juce::String& role, int numChannels, int numSamples) const;
+    
+    /**
+     * @brief Run inference on planar audio without heap allocation
+     * @param role Model identifier
+     * @param input Planar input channel pointers
+     * @param output Planar output channel pointers (may alias input)
+     * @param numChannels Number of channels
+     * @param numSamples Number of samples per channel
+     * @return true if inference succeeded
+     */
+    bool runInferenceInPlace(const juce::String& role,
+                             const float* const* input,
+                             float* const* output,
+                             int numChannels,
+                             int numSamples);
+    
     /**
      * @brief Load all models from config file
      * @param configPath Path to config.json
-     * @return Number of models loaded
+     * @param policy Whether to wait for, queue, or defer the loads
+     * @return Number of models loaded (Blocking) or roles registered (otherwise)
      */
-    int loadModelsFromConfig(const juce::String& configPath);
+    int loadModelsFromConfig(const juce::String& configPath,
+                             ModelLoadPolicy policy = ModelLoadPolicy::Background);
     
     /**
      * @brief Hot reload a specific model
+     * 
+     * The new session is built off the audio thread and swapped in atomically;
+     * inference already running finishes on the old one, which is then freed
+     * on the load pool.
      * @param role Model identifier to reload
      * @return true if reloaded successfully
      */
     bool reloadModel(const juce::String& role);
     
     /**
-     * @brief Check if a model is loaded and ready
+     * @brief Check if a model is loaded and ready (lock-free, any thread)
+     * 
+     * A registered role that has not been loaded yet is queued for loading
+     * within LAZY_LOAD_POLL_MS.
      * @param role Model identifier
      */
     bool isModelReady(const juce::String& role) const;
@@ -157,19 +506,257 @@ public:
      */
     juce::StringArray getLoadedModels() const;
     
+    /**
+     * @brief Get the model file a role is (or will be) loaded from
+     * @return Empty if the role is unknown
+     */
+    juce::String getModelPath(const juce::String& role) const;
+    
+    /**
+     * @brief Get the declared input shape of a role (dynamic dims are -1)
+     * @return Empty if the role is not loaded
+     */
+    std::vector<int64_t> getModelInputShape(const juce::String& role) const;
+    
     /**
      * @brief Enable/disable GPU acceleration if available
+     * 
+     * Roles without an explicit backend use the execution config's preferred
+     * backend while enabled. Applies to models loaded afterwards.
      */
     void setUseGPU(bool useGPU);
     
+    /**
+     * @brief Set execution provider settings (device, memory limit, fallback)
+     */
+    void setExecutionConfig(const GPUConfig& config);
+    
+    /**
+     * @brief Set the active GPU device (used to judge fp16 support)
+     */
+    void setExecutionDevice(const GPUDeviceInfo& device);
+    
+    /**
+     * @brief Choose the backend for one role (e.g. TTS on GPU, 808 DDSP on CPU)
+     * 
+     * Applies to the next (re)load of the role.
+     */
+    void setRoleBackend(const juce::String& role, GPUBackend backend);
+    
+    /**
+     * @brief Get the backend a role's sessions are created on
+     */
+    GPUBackend getRoleBackend(const juce::String& role) const;
+    
+    /**
+     * @brief Time a role on a backend using a scratch session
+     * 
+     * The published model keeps serving while this runs. Dynamic input
+     * dimensions are resolved to {1, 2, blockSize}.
+     */
+    BackendBenchmarkResult benchmarkModel(const juce::String& role,
+                                          GPUBackend backend,
+                                          int blockSize,
+                                          int iterations = 50);
+    
+    /**
+     * @brief Switch each role to its fastest backend and reload changed roles
+     * 
+     * Realtime roles are ranked by worst-case time, offline roles by mean
+     * time; a backend must have run at every benchmarked block size.
+     */
+    void selectFastestBackends(const std::vector<BackendBenchmarkResult>& results);
+    
+    /** How often requests for registered roles are turned into queued loads */
+    static constexpr int LAZY_LOAD_POLL_MS = 20;
+    
 private:
-    std::unordered_map<juce::String, std::unique_ptr<OnnxModel>> models;
+    // Declared before the models so it is destroyed after every session
+    std::unique_ptr<Ort::Env> environment;
+    
+    /**
+     * @brief Published model and load state of one role
+     * 
+     * Slots are created under engineLock and live as long as the engine, so
+     * the audio thread can read them without taking it.
+     */
+    struct ModelSlot
+    {
+        std::shared_ptr<OnnxModel> model;   // std::atomic_load/atomic_store only
+        std::atomic<ModelLoadState> state { ModelLoadState::Missing };
+        std::atomic<bool> loadWanted { false }; // raised by inference on a Registered role
+    };
+    
+    using SlotMap = std::unordered_map<juce::String, ModelSlot*>;
+    
+    // Every role's slot; guarded by engineLock, never erased
+    mutable std::unordered_map<juce::String, std::unique_ptr<ModelSlot>> slots;
+    
+    // Immutable lookup tables, replaced whenever a role is added; old ones are
+    // kept until the engine goes since a reader may still be walking them
+    mutable std::vector<std::unique_ptr<const SlotMap>> slotMaps;
+    mutable std::atomic<const SlotMap*> publishedSlots { nullptr };
+    
+    std::vector<std::shared_ptr<OnnxModel>> retiredModels; // freed on the load pool
     std::unordered_map<juce::String, juce::String> modelPaths; // for hot reloading
+    /**
+     * @brief Pre-bound tensor shape, re-bound whenever its role loads
+     */
+    struct BlockShape
+    {
+        int batchSize;
+        int numChannels;
+        int numSamples;
+        
+        bool operator==(const BlockShape& other) const
+        {
+            return batchSize == other.batchSize && numChannels == other.numChannels
+                && numSamples == other.numSamples;
+        }
+    };
+    
+    std::unordered_map<juce::String, std::vector<BlockShape>> inPlaceShapes;
+    
+    std::unordered_map<juce::String, InferenceProfile> roleProfiles;
+    ThreadingProfile realtimeProfile;
+    ThreadingProfile offlineProfile;
+    int globalIntraOpThreads;
+    int globalInterOpThreads;
+    
+    GPUConfig executionConfig;
+    GPUDeviceInfo executionDevice;
+    std::unordered_map<juce::String, GPUBackend> roleBackends;
+    
+    std::unordered_map<juce::String, std::map<ModelPrecision, juce::String>> modelVariants;
+    std::unordered_map<juce::String, ModelPrecision> loadedPrecisions;
+    
+    // Lazy loads are queued from const queries such as isModelReady()
+    mutable std::unordered_map<juce::String, int> loadGenerations; // stale loads are discarded
     
     bool initialized;
     bool useGPU;
+    bool optimizedModelCacheEnabled;
+    QualityPreference qualityPreference;
     mutable juce::CriticalSection engineLock;
     
+    /**
+     * @brief Background model load
+     */
+    class LoadTask : public juce::ThreadPoolJob
+    {
+    public:
+        LoadTask(OnnxEngine& owner, const juce::String& role, const juce::String& modelPath, int generation);
+        
+        JobStatus runJob() override;
+        
+    private:
+        OnnxEngine& engine;
+        juce::String modelRole;
+        juce::String path;
+        int loadGeneration;
+    };
+    
+    /**
+     * @brief Frees retired models once in-flight inference has let go
+     */
+    class ReleaseTask : public juce::ThreadPoolJob
+    {
+    public:
+        explicit ReleaseTask(OnnxEngine& owner);
+        
+        JobStatus runJob() override;
+        
+    private:
+        OnnxEngine& engine;
+    };
+    
+    mutable juce::ThreadPool loadPool;
+    
+    /**
+     * @brief Queues the loads that inference asked for
+     * 
+     * The audio thread only raises a slot's loadWanted flag; waking a thread
+     * takes a lock, so this one polls instead.
+     */
+    class LazyLoader : public juce::Thread
+    {
+    public:
+        explicit LazyLoader(OnnxEngine& owner);
+        
+        void run() override;
+        
+    private:
+        OnnxEngine& engine;
+    };
+    
+    LazyLoader lazyLoader;
+    
+    /**
+     * @brief Take a reference to a ready model without locking (asks for lazy roles)
+     */
+    std::shared_ptr<OnnxModel> acquireModel(const juce::String& role) const;
+    
+    /**
+     * @brief Find a role's slot without locking (any thread)
+     * @return nullptr if the role was never seen
+     */
+    ModelSlot* findSlot(const juce::String& role) const;
+    
+    /**
+     * @brief Find or create a role's slot (engineLock held)
+     */
+    ModelSlot& getSlot(const juce::String& role) const;
+    
+    /**
+     * @brief Hand a replaced model to the load pool for freeing (engineLock held)
+     */
+    void retireModel(std::shared_ptr<OnnxModel> model);
+    
+    /**
+     * @brief Free retired models nobody references any more
+     * @return Number of retired models still in use
+     */
+    int releaseRetiredModels();
+    
+    /**
+     * @brief Queue a background load for a role with a known path (engineLock held)
+     */
+    juce::ThreadPoolJob* queueLoad(const juce::String& role) const;
+    
+    /**
+     * @brief Queue a role that is registered but has never been requested (engineLock held)
+     */
+    void requestLazyLoad(const juce::String& role) const;
+    
+    /**
+     * @brief Queue every role whose load inference asked for (lazy loader thread)
+     */
+    void serviceLazyLoads();
+    
+    /**
+     * @brief Build a session outside the engine lock and publish it
+     * @param generation Load generation the result belongs to (-1 = always publish)
+     */
+    bool buildAndPublish(const juce::String& role, const juce::String& modelPath, int generation);
+    
+    /**
+     * @brief Path to load for a role: its single path, or the chosen variant (engineLock held)
+     */
+    juce::String resolveModelPath(const juce::String& role, GPUBackend backend) const;
+    
+    ModelPrecision choosePrecision(GPUBackend backend,
+                                   const std::map<ModelPrecision, juce::String>& available) const;
+    
+    /**
+     * @brief Check at runtime for int8 dot-product instructions (AVX512-VNNI, AVX-VNNI, ARM SDOT)
+     */
+    static bool cpuHasInt8DotProduct();
+    
+    static bool parsePrecision(const juce::String& name, ModelPrecision& precision);
+    
+    void setLoadState(const juce::String& role, ModelLoadState state) const;
+    void notifyLoadState(const juce::String& role, ModelLoadState state);
+    
     /**
      * @brief Parse config.json to get model paths
      */
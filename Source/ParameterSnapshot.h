@@ -0,0 +1,89 @@
+/**
+ * @file ParameterSnapshot.h
+ * @brief Lock-free handoff of a parameter struct from editing threads to the audio thread
+ *
+ * The editing side publishes a complete copy of the struct; the audio
+ * thread picks up the most recent complete copy at the start of a block
+ * and reads it for the rest of that block. Neither side ever waits for
+ * the other and a block never sees a half-written edit.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Double-buffered parameter struct with an atomically swapped spare slot
+ *
+ * One slot belongs to the writer, one to the reader, and the third holds
+ * the latest published value. Publishing and acquiring each swap a slot
+ * index with a single atomic exchange, so both are wait-free.
+ *
+ * publish() must only be called from one thread at a time (callers
+ * serialize with their own lock); acquireLatest() and getAcquired() belong
+ * to the audio thread.
+ */
+template <typename ValueType>
+class ParameterSnapshot
+{
+public:
+    static_assert(std::is_trivially_copyable<ValueType>::value,
+                  "Snapshots are copied on the audio thread and must not allocate");
+    
+    explicit ParameterSnapshot(const ValueType& initialValue = {})
+    {
+        slots.fill(initialValue);
+    }
+    
+    /**
+     * @brief Make a complete value visible to the next acquireLatest()
+     * @return The value this publish displaced, which the reader neither
+     *         holds nor can acquire any more (e.g. a pointer safe to free)
+     */
+    ValueType publish(const ValueType& value)
+    {
+        slots[static_cast<size_t>(writeSlot)] = value;
+        const int previous = latestSlot.exchange(writeSlot | NEW_VALUE_FLAG, std::memory_order_acq_rel);
+        writeSlot = previous & SLOT_MASK;
+        return slots[static_cast<size_t>(writeSlot)];
+    }
+    
+    /**
+     * @brief Take ownership of the latest published value, if there is a new one
+     * @return true if getAcquired() now returns a newer value
+     */
+    bool acquireLatest()
+    {
+        if ((latestSlot.load(std::memory_order_relaxed) & NEW_VALUE_FLAG) == 0)
+            return false;
+        
+        const int previous = latestSlot.exchange(readSlot, std::memory_order_acq_rel);
+        readSlot = previous & SLOT_MASK;
+        return true;
+    }
+    
+    /**
+     * @brief The value taken by the last acquireLatest() (audio thread only)
+     */
+    const ValueType& getAcquired() const { return slots[static_cast<size_t>(readSlot)]; }
+
+private:
+    static constexpr int SLOT_MASK = 3;
+    static constexpr int NEW_VALUE_FLAG = 4;
+    
+    std::array<ValueType, 3> slots;
+    std::atomic<int> latestSlot { 1 };
+    int writeSlot = 0;
+    int readSlot = 2;
+    
+    JUCE_DECLARE_NON_COPYABLE(ParameterSnapshot)
+};
+
+} // namespace MAEVN
@@ -0,0 +1,702 @@
+/**
+ * @file PartitionedConvolver.cpp
+ * @brief Implementation of the partitioned convolution engine
+ */
+
+#include "PartitionedConvolver.h"
+
+namespace MAEVN
+{
+
+namespace
+{
+    /**
+     * @brief acc += a * b over interleaved complex bins
+     *
+     * Written out by hand: std::complex multiplication goes through a
+     * NaN-checking library call unless fast-math is on.
+     */
+    void multiplyAccumulate(float* acc, const float* a, const float* b, int numBins)
+    {
+        for (int i = 0; i < 2 * numBins; i += 2)
+        {
+            acc[i] += a[i] * b[i] - a[i + 1] * b[i + 1];
+            acc[i + 1] += a[i] * b[i + 1] + a[i + 1] * b[i];
+        }
+    }
+    
+    // Overlap-save transforms are twice the partition size
+    int getFFTOrder(int partitionSize)
+    {
+        return juce::roundToInt(std::log2(2.0 * partitionSize));
+    }
+    
+    /**
+     * @brief Spectrum of up to partitionSize taps, zero-padded to the transform size
+     */
+    void transformPartition(juce::dsp::FFT& fft, const float* taps, int numTaps,
+                            int partitionSize, float* spectrum, float* workspace)
+    {
+        std::fill(workspace, workspace + 4 * partitionSize, 0.0f);
+        std::copy(taps, taps + numTaps, workspace);
+        fft.performRealOnlyForwardTransform(workspace, true);
+        std::copy(workspace, workspace + 2 * (partitionSize + 1), spectrum);
+    }
+    
+    /**
+     * @brief Resample to the processing rate, truncate, and scale to unit energy
+     *
+     * Normalising the energy keeps the wet level meaning the same for any IR.
+     */
+    juce::AudioBuffer<float> conformImpulse(const juce::AudioBuffer<float>& impulse,
+                                            double impulseRate, double targetRate)
+    {
+        const int numChannels = juce::jmin(2, impulse.getNumChannels());
+        const double ratio = impulseRate / targetRate;
+        const int maxLength = static_cast<int>(PartitionedConvolver::MAX_IMPULSE_SECONDS * targetRate);
+        const int length = juce::jmin(maxLength, static_cast<int>(impulse.getNumSamples() / ratio));
+        
+        juce::AudioBuffer<float> result(numChannels, juce::jmax(0, length));
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            if (std::abs(ratio - 1.0) < 1.0e-9)
+            {
+                result.copyFrom(ch, 0, impulse, ch, 0, result.getNumSamples());
+                continue;
+            }
+            
+            // Padded so the interpolator never reads past the end
+            std::vector<float> source(static_cast<size_t>(impulse.getNumSamples() + 8), 0.0f);
+            std::copy(impulse.getReadPointer(ch), impulse.getReadPointer(ch) + impulse.getNumSamples(), source.begin());
+            
+            juce::LagrangeInterpolator interpolator;
+            interpolator.process(ratio, source.data(), result.getWritePointer(ch), result.getNumSamples());
+        }
+        
+        double energy = 0.0;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* data = result.getReadPointer(ch);
+            for (int i = 0; i < result.getNumSamples(); ++i)
+                energy += static_cast<double>(data[i]) * data[i];
+        }
+        
+        if (energy > 0.0)
+            result.applyGain(static_cast<float>(1.0 / std::sqrt(energy / numChannels)));
+        
+        return result;
+    }
+    
+    /**
+     * @brief Read up to MAX_IMPULSE_SECONDS of the first two channels
+     */
+    bool readImpulse(juce::AudioFormatReader& reader, juce::AudioBuffer<float>& result, double& sampleRate)
+    {
+        const auto maxSamples = static_cast<juce::int64>(PartitionedConvolver::MAX_IMPULSE_SECONDS * reader.sampleRate) + 1;
+        const int numSamples = static_cast<int>(juce::jmin(reader.lengthInSamples, maxSamples));
+        const int numChannels = juce::jmin(2, static_cast<int>(reader.numChannels));
+        
+        if (numSamples <= 0 || numChannels <= 0 || reader.sampleRate <= 0.0)
+            return false;
+        
+        result.setSize(numChannels, numSamples);
+        sampleRate = reader.sampleRate;
+        return reader.read(&result, 0, numSamples, 0, true, numChannels > 1);
+    }
+    
+    bool readMappedImpulse(juce::AudioFormat& format, const juce::File& file,
+                           juce::AudioBuffer<float>& result, double& sampleRate)
+    {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader(format.createMemoryMappedReader(file));
+        if (reader == nullptr || !reader->mapEntireFile())
+            return false;
+        
+        return readImpulse(*reader, result, sampleRate);
+    }
+}
+
+//==============================================================================
+// FrequencyDomainStage
+//==============================================================================
+
+void PartitionedConvolver::FrequencyDomainStage::prepare(int size, int partitions)
+{
+    partitionSize = size;
+    numBins = size + 1;
+    maxPartitions = juce::jmax(1, partitions);
+    
+    fft = std::make_unique<juce::dsp::FFT>(getFFTOrder(size));
+    workspace.assign(static_cast<size_t>(4 * size), 0.0f);
+    accumulator.assign(static_cast<size_t>(2 * numBins), 0.0f);
+    inputSpectra.assign(static_cast<size_t>(maxPartitions * 2 * numBins), 0.0f);
+    newestPartition = 0;
+}
+
+void PartitionedConvolver::FrequencyDomainStage::reset()
+{
+    std::fill(inputSpectra.begin(), inputSpectra.end(), 0.0f);
+    newestPartition = 0;
+}
+
+void PartitionedConvolver::FrequencyDomainStage::process(const float* previous, const float* input,
+                                                         const float* spectra, int numPartitions,
+                                                         float* output)
+{
+    numPartitions = juce::jmin(numPartitions, maxPartitions);
+    if (maxPartitions <= 0)
+    {
+        std::fill(output, output + partitionSize, 0.0f);
+        return;
+    }
+    
+    std::copy(previous, previous + partitionSize, workspace.begin());
+    std::copy(input, input + partitionSize, workspace.begin() + partitionSize);
+    fft->performRealOnlyForwardTransform(workspace.data(), true);
+    
+    const int spectrumSize = 2 * numBins;
+    newestPartition = (newestPartition + 1) % maxPartitions;
+    std::copy(workspace.begin(), workspace.begin() + spectrumSize,
+              inputSpectra.begin() + newestPartition * spectrumSize);
+    
+    // The input is still recorded, so partitions can be added back later
+    if (numPartitions <= 0)
+    {
+        std::fill(output, output + partitionSize, 0.0f);
+        return;
+    }
+    
+    // Partition p of the response meets the input from p partitions ago
+    std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        const int slot = (newestPartition - p + maxPartitions) % maxPartitions;
+        multiplyAccumulate(accumulator.data(), inputSpectra.data() + slot * spectrumSize,
+                           spectra + p * spectrumSize, numBins);
+    }
+    
+    // The inverse transform rebuilds the negative frequencies and scales by 1 / size;
+    // the first half of the frame is circular wrap-around and is discarded
+    std::copy(accumulator.begin(), accumulator.end(), workspace.begin());
+    fft->performRealOnlyInverseTransform(workspace.data());
+    std::copy(workspace.begin() + partitionSize, workspace.begin() + 2 * partitionSize, output);
+}
+
+//==============================================================================
+// PartitionedConvolver
+//==============================================================================
+
+PartitionedConvolver::PartitionedConvolver()
+    : juce::Thread("Convolution Tail")
+    , sourceSampleRate(44100.0)
+    , nextKernelId(0)
+    , currentSampleRate(0.0)
+    , numChannels(2)
+    , workerTailPartitions(-1)
+    , activeKernel(nullptr)
+    , headPosition(0)
+    , tailPosition(0)
+    , tailPartition(0)
+    , tailMutedUntil(0)
+    , tailReady(false)
+{
+    slotKernels.fill(nullptr);
+    slotClearsHistory.fill(false);
+    
+    for (auto& completed : completedPartitions)
+        completed.store(-1);
+}
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+    release();
+}
+
+void PartitionedConvolver::prepare(double sampleRate, int /*maxBlockSize*/, int channelCount)
+{
+    release();
+    
+    const juce::ScopedLock sl(loadLock);
+    
+    currentSampleRate = sampleRate;
+    numChannels = juce::jmax(1, channelCount);
+    
+    const int maxTailPartitions = static_cast<int>(std::ceil(MAX_IMPULSE_SECONDS * sampleRate / TAIL_PARTITION_SIZE));
+    
+    channels = std::vector<ChannelState>(static_cast<size_t>(numChannels));
+    for (auto& state : channels)
+    {
+        state.directHistory.assign(2 * HEAD_PARTITION_SIZE, 0.0f);
+        state.headPrevious.assign(HEAD_PARTITION_SIZE, 0.0f);
+        state.headInput.assign(HEAD_PARTITION_SIZE, 0.0f);
+        state.headOutput.assign(HEAD_PARTITION_SIZE, 0.0f);
+        state.headStage.prepare(HEAD_PARTITION_SIZE, HEAD_PARTITIONS);
+        
+        state.tailInput.assign(TAIL_SLOTS * TAIL_PARTITION_SIZE, 0.0f);
+        state.tailOutput.assign(TAIL_SLOTS * TAIL_PARTITION_SIZE, 0.0f);
+        state.tailStage.prepare(TAIL_PARTITION_SIZE, maxTailPartitions);
+    }
+    
+    tailSilence.assign(TAIL_PARTITION_SIZE, 0.0f);
+    
+    // Nothing else is running: the rebuilt kernel can be installed directly
+    pendingKernel.store(nullptr);
+    kernels.clear();
+    
+    auto kernel = buildKernel();
+    kernel->id = ++nextKernelId;
+    activeKernel = kernel.get();
+    workerKernelId.store(kernel->id);
+    kernels.push_back(std::move(kernel));
+    
+    reset();
+}
+
+void PartitionedConvolver::release()
+{
+    signalThreadShouldExit();
+    workerWake.signal();
+    stopThread(2000);
+}
+
+void PartitionedConvolver::reset()
+{
+    if (channels.empty())
+        return;
+    
+    release();
+    
+    for (auto& state : channels)
+    {
+        std::fill(state.tailInput.begin(), state.tailInput.end(), 0.0f);
+        std::fill(state.tailOutput.begin(), state.tailOutput.end(), 0.0f);
+        state.tailStage.reset();
+    }
+    
+    headPosition = 0;
+    tailPosition = 0;
+    tailPartition = 0;
+    slotKernels.fill(activeKernel);
+    slotClearsHistory.fill(false);
+    
+    tailPartitionsWritten.store(0);
+    for (auto& completed : completedPartitions)
+        completed.store(-1);
+    
+    clearHistory();
+    
+    startThread(juce::Thread::Priority::high);
+}
+
+void PartitionedConvolver::clearHistory()
+{
+    for (auto& state : channels)
+    {
+        std::fill(state.directHistory.begin(), state.directHistory.end(), 0.0f);
+        std::fill(state.headPrevious.begin(), state.headPrevious.end(), 0.0f);
+        std::fill(state.headInput.begin(), state.headInput.end(), 0.0f);
+        std::fill(state.headOutput.begin(), state.headOutput.end(), 0.0f);
+        state.headStage.reset();
+        
+        // The part of the current partition already written is old input too
+        const int slot = static_cast<int>(tailPartition % TAIL_SLOTS);
+        std::fill(state.tailInput.begin() + slot * TAIL_PARTITION_SIZE,
+                  state.tailInput.begin() + slot * TAIL_PARTITION_SIZE + tailPosition, 0.0f);
+    }
+    
+    // The worker restarts from this partition; the two blocks still due
+    // were computed from the old history and stay muted
+    slotClearsHistory[static_cast<size_t>(tailPartition % TAIL_SLOTS)] = true;
+    tailMutedUntil = tailPartition + 2;
+    tailReady = false;
+}
+
+//==============================================================================
+void PartitionedConvolver::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    if (channels.empty() || activeKernel == nullptr)
+    {
+        buffer.clear(0, numSamples);
+        return;
+    }
+    
+    const int channelsToProcess = juce::jmin(buffer.getNumChannels(), numChannels);
+    for (int ch = channelsToProcess; ch < buffer.getNumChannels(); ++ch)
+        buffer.clear(ch, 0, numSamples);
+    
+    int position = 0;
+    
+    while (position < numSamples)
+    {
+        if (tailPosition == 0)
+            beginTailPartition();
+        
+        // Tail partitions are a whole number of head partitions, so stopping
+        // at head boundaries also stops at every tail boundary
+        const int count = juce::jmin(numSamples - position, HEAD_PARTITION_SIZE - headPosition);
+        const int inputSlot = static_cast<int>(tailPartition % TAIL_SLOTS);
+        const int dueSlot = static_cast<int>((tailPartition + TAIL_SLOTS - 2) % TAIL_SLOTS);
+        const Kernel& kernel = *activeKernel;
+        
+        for (int ch = 0; ch < channelsToProcess; ++ch)
+        {
+            float* data = buffer.getWritePointer(ch, position);
+            auto& state = channels[static_cast<size_t>(ch)];
+            
+            if (kernel.lengthSamples == 0)
+            {
+                juce::FloatVectorOperations::clear(data, count);
+                continue;
+            }
+            
+            std::copy(data, data + count, state.tailInput.begin() + inputSlot * TAIL_PARTITION_SIZE + tailPosition);
+            std::copy(data, data + count, state.headInput.begin() + headPosition);
+            
+            const float* taps = kernel.directTaps[static_cast<size_t>(ch)].data();
+            const float* headOutput = state.headOutput.data() + headPosition;
+            float* history = state.directHistory.data();
+            
+            for (int i = 0; i < count; ++i)
+            {
+                // After the double write, history[w + 1 .. w + P] runs oldest to newest
+                const int w = headPosition + i;
+                history[w] = data[i];
+                history[w + HEAD_PARTITION_SIZE] = data[i];
+                
+                const float* window = history + w + 1;
+                float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+                
+                for (int j = 0; j < HEAD_PARTITION_SIZE; j += 4)
+                {
+                    sum0 += taps[j] * window[j];
+                    sum1 += taps[j + 1] * window[j + 1];
+                    sum2 += taps[j + 2] * window[j + 2];
+                    sum3 += taps[j + 3] * window[j + 3];
+                }
+                
+                data[i] = (sum0 + sum1) + (sum2 + sum3) + headOutput[i];
+            }
+            
+            if (tailReady)
+                juce::FloatVectorOperations::add(data, state.tailOutput.data() + dueSlot * TAIL_PARTITION_SIZE + tailPosition, count);
+        }
+        
+        position += count;
+        headPosition += count;
+        tailPosition += count;
+        
+        if (headPosition == HEAD_PARTITION_SIZE)
+        {
+            headPosition = 0;
+            
+            if (kernel.lengthSamples > 0)
+            {
+                for (int ch = 0; ch < channelsToProcess; ++ch)
+                {
+                    auto& state = channels[static_cast<size_t>(ch)];
+                    state.headStage.process(state.headPrevious.data(), state.headInput.data(),
+                                            kernel.headSpectra[static_cast<size_t>(ch)].data(),
+                                            kernel.numHeadPartitions, state.headOutput.data());
+                    std::swap(state.headPrevious, state.headInput);
+                }
+            }
+        }
+        
+        if (tailPosition == TAIL_PARTITION_SIZE)
+        {
+            tailPosition = 0;
+            finishTailPartition();
+        }
+    }
+}
+
+void PartitionedConvolver::beginTailPartition()
+{
+    const auto slot = static_cast<size_t>(tailPartition % TAIL_SLOTS);
+    slotClearsHistory[slot] = false;
+    
+    if (auto* kernel = pendingKernel.exchange(nullptr, std::memory_order_acq_rel))
+    {
+        activeKernel = kernel;
+        clearHistory();
+    }
+    
+    slotKernels[slot] = activeKernel;
+    
+    // Output of partition n - 2 plays during partition n
+    const juce::int64 due = tailPartition - 2;
+    const auto dueSlot = static_cast<size_t>((tailPartition + TAIL_SLOTS - 2) % TAIL_SLOTS);
+    const bool expected = due >= 0 && tailPartition >= tailMutedUntil && activeKernel->numTailPartitions > 0;
+    
+    tailReady = expected && completedPartitions[dueSlot].load(std::memory_order_acquire) == due;
+    
+    if (expected && !tailReady)
+        missedDeadlines.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PartitionedConvolver::finishTailPartition()
+{
+    ++tailPartition;
+    
+    // No signal (it takes a lock): the worker polls within TAIL_POLL_MS
+    tailPartitionsWritten.store(tailPartition, std::memory_order_release);
+}
+
+//==============================================================================
+void PartitionedConvolver::run()
+{
+    juce::int64 nextPartition = tailPartitionsWritten.load();
+    
+    while (!threadShouldExit())
+    {
+        const juce::int64 written = tailPartitionsWritten.load(std::memory_order_acquire);
+        
+        if (nextPartition >= written)
+        {
+            workerWake.wait(TAIL_POLL_MS);
+            continue;
+        }
+        
+        // Fell so far behind that the audio thread is overwriting the input
+        // still needed: drop the backlog and restart from the newest partition
+        bool restart = false;
+        if (written - nextPartition >= TAIL_SLOTS - 1)
+        {
+            nextPartition = written - 1;
+            restart = true;
+        }
+        
+        convolveTailPartition(nextPartition, restart);
+        ++nextPartition;
+    }
+}
+
+void PartitionedConvolver::convolveTailPartition(juce::int64 partition, bool restart)
+{
+    const auto slot = static_cast<size_t>(partition % TAIL_SLOTS);
+    const auto previousSlot = static_cast<size_t>((partition + TAIL_SLOTS - 1) % TAIL_SLOTS);
+    const Kernel& kernel = *slotKernels[slot];
+    restart = restart || slotClearsHistory[slot];
+    
+    // Slots only ever move to newer kernels, so older ones are free from here on
+    const bool newKernel = kernel.id != workerKernelId.load(std::memory_order_relaxed);
+    if (newKernel)
+        workerKernelId.store(kernel.id, std::memory_order_release);
+    
+    // Step towards the tail limit; the input spectra of every partition are
+    // kept, so partitions can come back in without a gap
+    const int limit = getTailPartitionLimit(kernel);
+    if (restart || newKernel || workerTailPartitions < 0)
+    {
+        workerTailPartitions = limit;
+    }
+    else if (workerTailPartitions != limit)
+    {
+        const int step = juce::jmax(1, kernel.numTailPartitions / TAIL_LIMIT_STEPS);
+        workerTailPartitions = workerTailPartitions < limit ? juce::jmin(limit, workerTailPartitions + step)
+                                                            : juce::jmax(limit, workerTailPartitions - step);
+    }
+    
+    const int numTailPartitions = juce::jmin(workerTailPartitions, kernel.numTailPartitions);
+    
+    for (size_t ch = 0; ch < channels.size(); ++ch)
+    {
+        auto& state = channels[ch];
+        float* output = state.tailOutput.data() + slot * TAIL_PARTITION_SIZE;
+        
+        if (restart)
+            state.tailStage.reset();
+        
+        if (kernel.numTailPartitions == 0)
+        {
+            std::fill(output, output + TAIL_PARTITION_SIZE, 0.0f);
+            continue;
+        }
+        
+        // Runs even with every partition limited away, to keep the input spectra current
+        const float* previous = restart ? tailSilence.data()
+                                        : state.tailInput.data() + previousSlot * TAIL_PARTITION_SIZE;
+        state.tailStage.process(previous, state.tailInput.data() + slot * TAIL_PARTITION_SIZE,
+                                kernel.tailSpectra[ch].data(), numTailPartitions, output);
+    }
+    
+    completedPartitions[slot].store(partition, std::memory_order_release);
+}
+
+int PartitionedConvolver::getTailPartitionLimit(const Kernel& kernel) const
+{
+    const double limitSeconds = tailLimitSeconds.load(std::memory_order_relaxed);
+    if (limitSeconds <= 0.0)
+        return kernel.numTailPartitions;
+    
+    // The first 2 * TAIL_PARTITION_SIZE taps are the head's
+    const double tailSamples = limitSeconds * currentSampleRate - 2 * TAIL_PARTITION_SIZE;
+    const int partitions = static_cast<int>(std::ceil(tailSamples / TAIL_PARTITION_SIZE));
+    return juce::jlimit(0, kernel.numTailPartitions, partitions);
+}
+
+//==============================================================================
+bool PartitionedConvolver::loadImpulseResponse(const juce::AudioBuffer<float>& impulse, double impulseSampleRate)
+{
+    if (impulse.getNumChannels() == 0 || impulse.getNumSamples() == 0 || impulseSampleRate <= 0.0)
+    {
+        Logger::log(Logger::Level::Warning, "Ignoring empty impulse response");
+        return false;
+    }
+    
+    const juce::ScopedLock sl(loadLock);
+    
+    sourceImpulse.makeCopyOf(impulse);
+    sourceSampleRate = impulseSampleRate;
+    impulseLengthSeconds.store(juce::jmin(MAX_IMPULSE_SECONDS, impulse.getNumSamples() / impulseSampleRate));
+    
+    if (currentSampleRate > 0.0)
+        publishKernel(buildKernel());
+    
+    Logger::log(Logger::Level::Info, "Loaded impulse response: " +
+                juce::String(impulseLengthSeconds.load(), 2) + " s, " +
+                juce::String(impulse.getNumChannels()) + " channel(s)");
+    return true;
+}
+
+bool PartitionedConvolver::loadImpulseResponse(const juce::File& file)
+{
+    juce::AudioBuffer<float> impulse;
+    double impulseSampleRate = 0.0;
+    bool loaded = false;
+    
+    // WAV and AIFF samples are read straight out of a mapping of the file
+    if (file.hasFileExtension("wav"))
+    {
+        juce::WavAudioFormat format;
+        loaded = readMappedImpulse(format, file, impulse, impulseSampleRate);
+    }
+    else if (file.hasFileExtension("aif;aiff"))
+    {
+        juce::AiffAudioFormat format;
+        loaded = readMappedImpulse(format, file, impulse, impulseSampleRate);
+    }
+    
+    if (!loaded)
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+        loaded = reader != nullptr && readImpulse(*reader, impulse, impulseSampleRate);
+    }
+    
+    if (!loaded)
+    {
+        Logger::log(Logger::Level::Error, "Failed to read impulse response: " + file.getFullPathName());
+        return false;
+    }
+    
+    return loadImpulseResponse(impulse, impulseSampleRate);
+}
+
+bool PartitionedConvolver::loadImpulseResponse(const void* data, size_t numBytes)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    
+    std::unique_ptr<juce::AudioFormatReader> reader(
+        formatManager.createReaderFor(std::make_unique<juce::MemoryInputStream>(data, numBytes, false)));
+    
+    juce::AudioBuffer<float> impulse;
+    double impulseSampleRate = 0.0;
+    
+    if (reader == nullptr || !readImpulse(*reader, impulse, impulseSampleRate))
+    {
+        Logger::log(Logger::Level::Error, "Failed to decode impulse response data");
+        return false;
+    }
+    
+    return loadImpulseResponse(impulse, impulseSampleRate);
+}
+
+void PartitionedConvolver::clearImpulseResponse()
+{
+    const juce::ScopedLock sl(loadLock);
+    
+    sourceImpulse.setSize(0, 0);
+    impulseLengthSeconds.store(0.0);
+    
+    if (currentSampleRate > 0.0)
+        publishKernel(buildKernel());
+}
+
+//==============================================================================
+std::unique_ptr<PartitionedConvolver::Kernel> PartitionedConvolver::buildKernel() const
+{
+    auto kernel = std::make_unique<Kernel>();
+    if (sourceImpulse.getNumSamples() == 0 || currentSampleRate <= 0.0)
+        return kernel;
+    
+    const auto impulse = conformImpulse(sourceImpulse, sourceSampleRate, currentSampleRate);
+    const int length = impulse.getNumSamples();
+    const int tailStart = 2 * TAIL_PARTITION_SIZE;
+    
+    kernel->lengthSamples = length;
+    kernel->numHeadPartitions = juce::jlimit(0, HEAD_PARTITIONS,
+        (length - HEAD_PARTITION_SIZE + HEAD_PARTITION_SIZE - 1) / HEAD_PARTITION_SIZE);
+    kernel->numTailPartitions = length > tailStart
+        ? (length - tailStart + TAIL_PARTITION_SIZE - 1) / TAIL_PARTITION_SIZE : 0;
+    
+    juce::dsp::FFT headFFT(getFFTOrder(HEAD_PARTITION_SIZE));
+    juce::dsp::FFT tailFFT(getFFTOrder(TAIL_PARTITION_SIZE));
+    std::vector<float> workspace(4 * TAIL_PARTITION_SIZE);
+    
+    const int headSpectrumSize = 2 * (HEAD_PARTITION_SIZE + 1);
+    const int tailSpectrumSize = 2 * (TAIL_PARTITION_SIZE + 1);
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        // A mono IR feeds every channel
+        const float* ir = impulse.getReadPointer(juce::jmin(ch, impulse.getNumChannels() - 1));
+        
+        std::vector<float> taps(HEAD_PARTITION_SIZE, 0.0f);
+        for (int j = 0; j < juce::jmin(HEAD_PARTITION_SIZE, length); ++j)
+            taps[static_cast<size_t>(HEAD_PARTITION_SIZE - 1 - j)] = ir[j];
+        kernel->directTaps.push_back(std::move(taps));
+        
+        std::vector<float> headSpectra(static_cast<size_t>(kernel->numHeadPartitions * headSpectrumSize));
+        for (int p = 0; p < kernel->numHeadPartitions; ++p)
+        {
+            const int offset = HEAD_PARTITION_SIZE * (p + 1);
+            transformPartition(headFFT, ir + offset, juce::jmin(HEAD_PARTITION_SIZE, length - offset),
+                               HEAD_PARTITION_SIZE, headSpectra.data() + p * headSpectrumSize, workspace.data());
+        }
+        kernel->headSpectra.push_back(std::move(headSpectra));
+        
+        std::vector<float> tailSpectra(static_cast<size_t>(kernel->numTailPartitions * tailSpectrumSize));
+        for (int p = 0; p < kernel->numTailPartitions; ++p)
+        {
+            const int offset = tailStart + TAIL_PARTITION_SIZE * p;
+            transformPartition(tailFFT, ir + offset, juce::jmin(TAIL_PARTITION_SIZE, length - offset),
+                               TAIL_PARTITION_SIZE, tailSpectra.data() + p * tailSpectrumSize, workspace.data());
+        }
+        kernel->tailSpectra.push_back(std::move(tailSpectra));
+    }
+    
+    return kernel;
+}
+
+void PartitionedConvolver::publishKernel(std::unique_ptr<Kernel> kernel)
+{
+    kernel->id = ++nextKernelId;
+    kernels.push_back(std::move(kernel));
+    
+    // A kernel displaced here was never picked up and is freed below once
+    // the worker has moved past its id
+    pendingKernel.exchange(kernels.back().get(), std::memory_order_acq_rel);
+    
+    // The audio thread is never behind the worker, so anything older than
+    // the worker's kernel is unreferenced
+    const int oldestInUse = workerKernelId.load(std::memory_order_acquire);
+    kernels.erase(std::remove_if(kernels.begin(), kernels.end(),
+                                 [oldestInUse](const std::unique_ptr<Kernel>& k) { return k->id < oldestInUse; }),
+                  kernels.end());
+}
+
+} // namespace MAEVN
@@ -0,0 +1,279 @@
+/**
+ * @file PartitionedConvolver.h
+ * @brief Non-uniform partitioned FFT convolution for long reverb impulse responses
+ *
+ * The impulse response is split into three parts:
+ * - The first HEAD_PARTITION_SIZE taps run as a direct FIR, so there is no
+ *   added latency.
+ * - The rest of the first 2 * TAIL_PARTITION_SIZE taps runs as a uniformly
+ *   partitioned FFT convolution on the audio thread.
+ * - Everything after that runs in TAIL_PARTITION_SIZE partitions on a
+ *   background thread. Each tail block is due two partitions after its
+ *   input arrives, which gives the worker a whole partition of time.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+/**
+ * @brief Engine behind a reverb's late field
+ */
+enum class ReverbMode
+{
+    Algorithmic,    // juce::dsp::Reverb (Freeverb)
+    Convolution     // PartitionedConvolver with a loaded impulse response
+};
+
+//==============================================================================
+/**
+ * @brief Zero-latency convolution engine with a background tail thread
+ *
+ * process() replaces the buffer with the wet (fully convolved) signal and is
+ * realtime safe. Impulse responses may be loaded from any non-audio thread
+ * at any time; the audio thread switches to a new one at the next tail
+ * partition boundary.
+ */
+class PartitionedConvolver : private juce::Thread
+{
+public:
+    static constexpr int HEAD_PARTITION_SIZE = 128;
+    static constexpr int TAIL_PARTITION_SIZE = 2048;
+    
+    /** How often the tail worker looks for a partition from the audio thread */
+    static constexpr int TAIL_POLL_MS = 2;
+    
+    /** Longer impulse responses are truncated */
+    static constexpr double MAX_IMPULSE_SECONDS = 10.0;
+    
+    PartitionedConvolver();
+    ~PartitionedConvolver() override;
+    
+    /**
+     * @brief Allocate processing state, rebuild the loaded IR for this rate
+     *        and start the tail thread (call outside the audio callback)
+     */
+    void prepare(double sampleRate, int maxBlockSize, int numChannels);
+    
+    /**
+     * @brief Stop the tail thread
+     */
+    void release();
+    
+    /**
+     * @brief Convolve numSamples of every prepared channel in place
+     */
+    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    /**
+     * @brief Clear all convolution history (call while audio is stopped)
+     */
+    void reset();
+    
+    /**
+     * @brief Forget the input heard so far (audio thread; e.g. after a bypass)
+     */
+    void clearHistory();
+    
+    /**
+     * @brief Use an impulse response held in memory
+     * @param impulse Mono or stereo impulse response
+     * @param impulseSampleRate Rate it was recorded at (resampled if needed)
+     */
+    bool loadImpulseResponse(const juce::AudioBuffer<float>& impulse, double impulseSampleRate);
+    
+    /**
+     * @brief Use an impulse response file (WAV and AIFF are memory-mapped)
+     */
+    bool loadImpulseResponse(const juce::File& file);
+    
+    /**
+     * @brief Use an encoded audio file held in memory (e.g. BinaryData shipped with presets)
+     */
+    bool loadImpulseResponse(const void* data, size_t numBytes);
+    
+    /**
+     * @brief Output silence until another impulse response is loaded
+     */
+    void clearImpulseResponse();
+    
+    bool hasImpulseResponse() const { return impulseLengthSeconds.load() > 0.0; }
+    
+    /**
+     * @brief Length of the loaded impulse response (0 if none)
+     */
+    double getImpulseLengthSeconds() const { return impulseLengthSeconds.load(); }
+    
+    /**
+     * @brief Tail blocks that were not ready in time and were left silent
+     */
+    int getNumMissedDeadlines() const { return missedDeadlines.load(); }
+    
+    /**
+     * @brief Convolve no more than this much of the impulse response (any thread)
+     *
+     * Used by the CPU governor. The worker moves to a new length a few tail
+     * partitions at a time, so the tail fades out rather than cutting off.
+     * @param seconds Length kept (<= 0 = all of it)
+     */
+    void setTailLimitSeconds(double seconds) { tailLimitSeconds.store(seconds); }
+    double getTailLimitSeconds() const { return tailLimitSeconds.load(); }
+
+private:
+    static constexpr int TAIL_SLOTS = 4;
+    static constexpr int HEAD_PARTITIONS = 2 * TAIL_PARTITION_SIZE / HEAD_PARTITION_SIZE - 1;
+    static constexpr int TAIL_LIMIT_STEPS = 32;     // partitions a full change of length takes
+    
+    /**
+     * @brief An impulse response prepared for one sample rate
+     *
+     * Spectra are stored as interleaved (re, im) pairs, partitionSize + 1
+     * bins per partition.
+     */
+    struct Kernel
+    {
+        int id = 0;
+        int lengthSamples = 0;
+        int numHeadPartitions = 0;
+        int numTailPartitions = 0;
+        std::vector<std::vector<float>> directTaps;   // [channel], time-reversed
+        std::vector<std::vector<float>> headSpectra;  // [channel]
+        std::vector<std::vector<float>> tailSpectra;  // [channel]
+    };
+    
+    /**
+     * @brief Uniformly partitioned overlap-save convolution of one channel
+     */
+    class FrequencyDomainStage
+    {
+    public:
+        void prepare(int partitionSize, int maxPartitions);
+        void reset();
+        
+        /**
+         * @brief Convolve one partition of input
+         * @param previous The partition before input (partitionSize samples)
+         * @param input The newest partition (partitionSize samples)
+         * @param spectra Impulse response partitions (see Kernel)
+         * @param output partitionSize samples of output for input's time span
+         */
+        void process(const float* previous, const float* input,
+                     const float* spectra, int numPartitions, float* output);
+    
+    private:
+        std::unique_ptr<juce::dsp::FFT> fft;
+        int partitionSize = 0;
+        int numBins = 0;
+        int maxPartitions = 0;
+        int newestPartition = 0;
+        std::vector<float> workspace;
+        std::vector<float> accumulator;
+        std::vector<float> inputSpectra;   // frequency-domain delay line
+    };
+    
+    struct ChannelState
+    {
+        // Direct FIR history, stored twice so the last taps are contiguous
+        std::vector<float> directHistory;
+        
+        // Head input of the previous and current partition, and head output
+        // computed from the previous partition
+        std::vector<float> headPrevious;
+        std::vector<float> headInput;
+        std::vector<float> headOutput;
+        FrequencyDomainStage headStage;
+        
+        // Tail rings: TAIL_SLOTS partitions, indexed by partition number
+        std::vector<float> tailInput;
+        std::vector<float> tailOutput;
+        FrequencyDomainStage tailStage;   // worker thread
+    };
+    
+    void run() override;
+    
+    /**
+     * @brief Build a kernel for the prepared rate from the stored source IR
+     *        (caller holds loadLock)
+     */
+    std::unique_ptr<Kernel> buildKernel() const;
+    
+    /**
+     * @brief Hand a new kernel to the audio thread and free unused ones
+     *        (caller holds loadLock)
+     */
+    void publishKernel(std::unique_ptr<Kernel> kernel);
+    
+    /**
+     * @brief Pick up a new kernel and decide whether the due tail block is ready
+     */
+    void beginTailPartition();
+    
+    /**
+     * @brief Publish the completed input partition to the worker
+     */
+    void finishTailPartition();
+    
+    /**
+     * @brief Worker: convolve one tail partition (from silence if restarting)
+     */
+    void convolveTailPartition(juce::int64 partition, bool restart);
+    
+    /**
+     * @brief Tail partitions of a kernel that tailLimitSeconds leaves in
+     */
+    int getTailPartitionLimit(const Kernel& kernel) const;
+    
+    // Loader side (guarded by loadLock)
+    juce::CriticalSection loadLock;
+    juce::AudioBuffer<float> sourceImpulse;
+    double sourceSampleRate;
+    std::vector<std::unique_ptr<Kernel>> kernels;
+    int nextKernelId;
+    
+    double currentSampleRate;      // 0 until prepare()
+    int numChannels;
+    std::vector<ChannelState> channels;
+    std::vector<float> tailSilence;
+    
+    // Kernel handoff; kernels older than workerKernelId are no longer used
+    std::atomic<Kernel*> pendingKernel { nullptr };
+    std::atomic<int> workerKernelId { 0 };
+    std::atomic<double> impulseLengthSeconds { 0.0 };
+    std::atomic<double> tailLimitSeconds { 0.0 };
+    
+    // Worker thread: tail partitions convolved, moving towards the limit
+    int workerTailPartitions;
+    
+    // Audio thread
+    Kernel* activeKernel;
+    int headPosition;
+    int tailPosition;
+    juce::int64 tailPartition;
+    juce::int64 tailMutedUntil;
+    bool tailReady;
+    
+    // Per tail slot, written by the audio thread before the partition is published
+    std::array<Kernel*, TAIL_SLOTS> slotKernels;
+    std::array<bool, TAIL_SLOTS> slotClearsHistory;
+    
+    // Partitions handed to the worker, and the partition whose output each
+    // slot holds (-1 for none)
+    std::atomic<juce::int64> tailPartitionsWritten { 0 };
+    std::array<std::atomic<juce::int64>, TAIL_SLOTS> completedPartitions;
+    std::atomic<int> missedDeadlines { 0 };
+    
+    // Only signalled by release(); the audio thread never signals, the worker polls
+    juce::WaitableEvent workerWake;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedConvolver)
+};
+
+} // namespace MAEVN
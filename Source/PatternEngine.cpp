@@ -4,7 +4,9 @@
  */
 
 #include "PatternEngine.h"
-#include <regex>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 
 namespace MAEVN
 {
@@ -16,7 +18,12 @@ PatternEngine::PatternEngine()
     , playing(false)
     , defaultBlockDuration(4.0)
     , quantizationEnabled(true)
+    , scriptIsParsed(false)
+    , scriptBPM(0.0)
+    , scriptBlockDuration(0.0)
+    , scriptQuantization(false)
 {
+    publishTimeline({});
 }
 
 PatternEngine::~PatternEngine()
@@ -27,64 +34,171 @@ int PatternEngine::parseStageScript(const juce::String& scriptInput)
 {
     const juce::ScopedLock sl(blockLock);
     
-    clearBlocks();
+    // Split into lines once; each line is a slice of the UTF-8 text
+    std::string text = scriptInput.toStdString();
+    std::vector<ScriptLine> lines;
+    tokenizeLines(text, lines);
     
-    if (scriptInput.isEmpty())
-        return 0;
+    // Timing settings or manual edits since the last parse invalidate every line
+    const bool incremental = scriptIsParsed && scriptBPM == currentBPM && scriptBlockDuration == defaultBlockDuration
+                             && scriptQuantization == quantizationEnabled;
+    
+    // Unchanged leading and trailing lines of the previous script
+    size_t prefix = 0;
+    size_t suffix = 0;
+    
+    if (incremental)
+    {
+        const size_t common = juce::jmin(lines.size(), scriptLines.size());
+        while (prefix < common && sameLine(text, lines[prefix], scriptLines[prefix]))
+            ++prefix;
+        
+        while (suffix < common - prefix
+               && sameLine(text, lines[lines.size() - 1 - suffix], scriptLines[scriptLines.size() - 1 - suffix]))
+            ++suffix;
+        
+        if (prefix == lines.size() && prefix == scriptLines.size())
+            return static_cast<int>(blocks.size());
+    }
+    
+    // Blocks of the unchanged prefix stay; the changed lines' blocks are replaced
+    int firstBlock = 0;
+    int numRemoved = static_cast<int>(blocks.size());
     
-    // Split input into lines
-    juce::StringArray lines;
-    lines.addLines(scriptInput);
+    if (incremental)
+    {
+        for (size_t line = 0; line < prefix; ++line)
+            firstBlock += scriptLines[line].hasBlock ? 1 : 0;
+        
+        numRemoved -= firstBlock;
+        for (size_t line = scriptLines.size() - suffix; line < scriptLines.size(); ++line)
+            numRemoved -= scriptLines[line].hasBlock ? 1 : 0;
+    }
+    
+    double cursor = firstBlock > 0 ? blockCursors[static_cast<size_t>(firstBlock - 1)]
+                                       + blocks[static_cast<size_t>(firstBlock - 1)].duration
+                                   : 0.0;
     
-    double currentTime = 0.0;
-    int blockCount = 0;
+    std::vector<TimelineBlock> insertedBlocks;
+    std::vector<double> insertedCursors;
     
-    for (auto& line : lines)
+    for (size_t line = prefix; line < lines.size() - suffix; ++line)
     {
-        line = line.trim();
-        if (line.isEmpty())
+        auto& scriptLine = lines[line];
+        TimelineBlock block = parseBlock(text.data() + scriptLine.start, scriptLine.length, cursor);
+        
+        scriptLine.hasBlock = block.type != BlockType::Unknown;
+        if (!scriptLine.hasBlock)
             continue;
         
-        // Check if line contains a block marker [SOMETHING]
-        if (line.contains("[") && line.contains("]"))
-        {
-            TimelineBlock block = parseBlock(line, currentTime);
-            
-            if (block.type != BlockType::Unknown)
-            {
-                blocks.push_back(block);
-                currentTime += block.duration;
-                blockCount++;
-            }
-        }
+        block.trackIndex = getTrackIndexForBlockType(block.type);
+        insertedBlocks.push_back(block);
+        insertedCursors.push_back(cursor);
+        cursor += block.duration;
+    }
+    
+    for (size_t line = lines.size() - suffix; line < lines.size(); ++line)
+        lines[line].hasBlock = scriptLines[scriptLines.size() - (lines.size() - line)].hasBlock;
+    
+    for (size_t line = 0; line < prefix; ++line)
+        lines[line].hasBlock = scriptLines[line].hasBlock;
+    
+    const auto first = static_cast<std::ptrdiff_t>(firstBlock);
+    blocks.erase(blocks.begin() + first, blocks.begin() + first + numRemoved);
+    blocks.insert(blocks.begin() + first, insertedBlocks.begin(), insertedBlocks.end());
+    blockCursors.resize(static_cast<size_t>(firstBlock));
+    blockCursors.insert(blockCursors.end(), insertedCursors.begin(), insertedCursors.end());
+    
+    // Downstream blocks only move if the edited lines changed the running time
+    TimelineEdit edit { firstBlock, numRemoved, static_cast<int>(insertedBlocks.size()), false };
+    
+    for (size_t index = blockCursors.size(); index < blocks.size(); ++index)
+    {
+        auto& block = blocks[index];
+        const double startTime = quantizeTime(cursor);
+        edit.startsShifted = edit.startsShifted || block.startTime != startTime;
+        block.startTime = startTime;
+        blockCursors.push_back(cursor);
+        cursor += block.duration;
     }
     
-    // Assign track indices based on block types
-    assignTrackIndices();
+    scriptText = std::move(text);
+    scriptLines = std::move(lines);
+    scriptIsParsed = true;
+    scriptBPM = currentBPM;
+    scriptBlockDuration = defaultBlockDuration;
+    scriptQuantization = quantizationEnabled;
     
-    Logger::log(Logger::Level::Info, "Parsed " + juce::String(blockCount) + " blocks from stage script");
-    return blockCount;
+    publishTimeline(edit);
+    
+    if (!incremental)
+        Logger::log(Logger::Level::Info, "Parsed " + juce::String(edit.numInserted) + " blocks from stage script");
+    else
+        Logger::log(Logger::Level::Debug, "Re-parsed " + juce::String(edit.numInserted) + " blocks of the stage script from block "
+                    + juce::String(edit.firstBlock));
+    
+    return static_cast<int>(blocks.size());
+}
+
+void PatternEngine::tokenizeLines(const std::string& text, std::vector<ScriptLine>& lines)
+{
+    lines.clear();
+    
+    size_t start = 0;
+    while (start <= text.size())
+    {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos)
+            end = text.size();
+        
+        lines.push_back({ start, end - start, false });
+        start = end + 1;
+    }
+}
+
+bool PatternEngine::sameLine(const std::string& text, const ScriptLine& line, const ScriptLine& previousLine) const
+{
+    return line.length == previousLine.length
+           && text.compare(line.start, line.length, scriptText, previousLine.start, previousLine.length) == 0;
 }
 
-TimelineBlock PatternEngine::parseBlock(const juce::String& blockText, double startTime)
+TimelineBlock PatternEngine::parseBlock(const char* text, size_t length, double startTime)
 {
     TimelineBlock block;
     
+    const auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+    
     // Extract block type from [TAG]
-    int startBracket = blockText.indexOf("[");
-    int endBracket = blockText.indexOf("]");
+    const char* end = text + length;
+    const char* startBracket = std::find(text, end, '[');
+    const char* endBracket = std::find(text, end, ']');
     
-    if (startBracket < 0 || endBracket < 0 || endBracket <= startBracket)
+    if (startBracket == end || endBracket == end || endBracket <= startBracket)
         return block;
     
-    juce::String tag = blockText.substring(startBracket + 1, endBracket).trim();
-    block.type = stringToBlockType(tag);
+    const char* tagStart = startBracket + 1;
+    const char* tagEnd = endBracket;
+    while (tagStart < tagEnd && isSpace(*tagStart))
+        ++tagStart;
+    while (tagEnd > tagStart && isSpace(tagEnd[-1]))
+        --tagEnd;
+    
+    block.type = getBlockTypeForTag(tagStart, static_cast<size_t>(tagEnd - tagStart));
+    if (block.type == BlockType::Unknown)
+        return block;
     
     // Extract content after the tag
-    block.content = blockText.substring(endBracket + 1).trim();
+    const char* contentStart = endBracket + 1;
+    const char* contentEnd = end;
+    while (contentStart < contentEnd && isSpace(*contentStart))
+        ++contentStart;
+    while (contentEnd > contentStart && isSpace(contentEnd[-1]))
+        --contentEnd;
+    
+    block.content = juce::String::fromUTF8(contentStart, static_cast<int>(contentEnd - contentStart));
     
     // Set timing
-    block.startTime = quantizationEnabled ? quantizeTime(startTime) : startTime;
+    block.startTime = quantizeTime(startTime);
     block.duration = defaultBlockDuration;
     
     // Parse duration from content if specified (e.g., "duration:2.0")
@@ -103,13 +217,32 @@ TimelineBlock PatternEngine::parseBlock(const juce::String& blockText, double st
     return block;
 }
 
-void PatternEngine::assignTrackIndices()
+BlockType PatternEngine::getBlockTypeForTag(const char* tag, size_t length)
 {
-    // Assign track indices based on block type
-    for (auto& block : blocks)
+    static constexpr struct { const char* name; BlockType type; } tags[] = {
+        { "INTRO", BlockType::Intro },   { "HOOK", BlockType::Hook },
+        { "VERSE", BlockType::Verse },   { "BRIDGE", BlockType::Bridge },
+        { "OUTRO", BlockType::Outro },   { "808", BlockType::Drum_808 },
+        { "HIHAT", BlockType::Drum_HiHat }, { "SNARE", BlockType::Drum_Snare },
+        { "PIANO", BlockType::Instrument_Piano }, { "SYNTH", BlockType::Instrument_Synth },
+        { "VOCAL", BlockType::Vocal }
+    };
+    
+    // Same names as stringToBlockType(), compared in place without a String
+    for (const auto& entry : tags)
     {
-        block.trackIndex = getTrackIndexForBlockType(block.type);
+        if (std::strlen(entry.name) != length)
+            continue;
+        
+        bool matches = true;
+        for (size_t i = 0; i < length && matches; ++i)
+            matches = std::toupper(static_cast<unsigned char>(tag[i])) == entry.name[i];
+        
+        if (matches)
+            return entry.type;
     }
+    
+    return BlockType::Unknown;
 }
 
 int PatternEngine::getTrackIndexForBlockType(BlockType type) const
@@ -155,37 +288,137 @@ std::vector<TimelineBlock> PatternEngine::getActiveBlocks(double time) const
 {
     const juce::ScopedLock sl(blockLock);
     
+    // The newest snapshot always matches blocks while the lock is held
+    const auto& snapshot = *timelineStorage.back();
+    
+    std::vector<int> activeIndices;
+    for (int trackIndex = 0; trackIndex < snapshot.getNumTracks(); ++trackIndex)
+        snapshot.forEachActiveBlock(trackIndex, time, [&activeIndices](int index) { activeIndices.push_back(index); });
+    
+    // Keep timeline order
+    std::sort(activeIndices.begin(), activeIndices.end());
+    
     std::vector<TimelineBlock> activeBlocks;
+    activeBlocks.reserve(activeIndices.size());
+    for (const int index : activeIndices)
+        activeBlocks.push_back(snapshot.getBlock(index));
     
-    for (const auto& block : blocks)
+    return activeBlocks;
+}
+
+std::vector<TimelineBlock> PatternEngine::getBlocksInRange(double start, double end) const
+{
+    const juce::ScopedLock sl(blockLock);
+    
+    const auto indices = getBlockIndicesInRange(start, end);
+    
+    std::vector<TimelineBlock> rangeBlocks;
+    rangeBlocks.reserve(indices.size());
+    for (const int index : indices)
+        rangeBlocks.push_back(blocks[static_cast<size_t>(index)]);
+    
+    return rangeBlocks;
+}
+
+std::vector<int> PatternEngine::getBlockIndicesInRange(double start, double end) const
+{
+    const juce::ScopedLock sl(blockLock);
+    
+    const auto& snapshot = *timelineStorage.back();
+    
+    std::vector<int> indices;
+    for (int trackIndex = 0; trackIndex < snapshot.getNumTracks(); ++trackIndex)
+        snapshot.forEachBlockInRange(trackIndex, start, end, [&indices](int index) { indices.push_back(index); });
+    
+    // Keep timeline order
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+int PatternEngine::editBlocksInRange(double start, double end, const BlockEditor& editor)
+{
+    const juce::ScopedLock sl(blockLock);
+    
+    const auto indices = getBlockIndicesInRange(start, end);
+    
+    std::vector<TimelineBlock> rangeBlocks;
+    rangeBlocks.reserve(indices.size());
+    for (const int index : indices)
+        rangeBlocks.push_back(blocks[static_cast<size_t>(index)]);
+    
+    editor(rangeBlocks);
+    
+    // Write the edited copies back in place
+    const size_t numKept = juce::jmin(rangeBlocks.size(), indices.size());
+    int numChanged = 0;
+    for (size_t i = 0; i < numKept; ++i)
     {
-        double endTime = block.startTime + block.duration;
-        if (time >= block.startTime && time < endTime)
+        auto& block = blocks[static_cast<size_t>(indices[i])];
+        const auto& edited = rangeBlocks[i];
+        
+        if (edited.type != block.type || edited.startTime != block.startTime || edited.duration != block.duration
+            || edited.content != block.content || edited.trackIndex != block.trackIndex)
         {
-            activeBlocks.push_back(block);
+            block = edited;
+            ++numChanged;
         }
     }
     
-    return activeBlocks;
+    // Copies the editor dropped take the last blocks of the range with them
+    const int numRemoved = static_cast<int>(indices.size() - numKept);
+    for (size_t i = indices.size(); i-- > numKept;)
+        blocks.erase(blocks.begin() + indices[i]);
+    
+    // Appended blocks follow the last block of the range
+    const int numAdded = static_cast<int>(rangeBlocks.size() - numKept);
+    const int insertAt = indices.empty() ? static_cast<int>(blocks.size()) : indices.back() + 1 - numRemoved;
+    blocks.insert(blocks.begin() + insertAt, rangeBlocks.begin() + static_cast<std::ptrdiff_t>(numKept), rangeBlocks.end());
+    
+    if (numChanged == 0 && numAdded == 0 && numRemoved == 0)
+        return 0;
+    
+    // Only the span from the first to the last edited block is new to the snapshot
+    const int firstBlock = indices.empty() ? insertAt : indices.front();
+    const int span = indices.empty() ? 0 : indices.back() + 1 - firstBlock;
+    
+    scriptIsParsed = false;
+    publishTimeline({ firstBlock, span, span - numRemoved + numAdded, false });
+    return numChanged + numAdded + numRemoved;
 }
 
 std::vector<TimelineBlock> PatternEngine::getBlocksForTrack(int trackIndex) const
 {
     const juce::ScopedLock sl(blockLock);
     
-    std::vector<TimelineBlock> trackBlocks;
+    const auto& snapshot = *timelineStorage.back();
+    const auto& indices = snapshot.getTrackBlocks(trackIndex);
     
-    for (const auto& block : blocks)
-    {
-        if (block.trackIndex == trackIndex)
-        {
-            trackBlocks.push_back(block);
-        }
-    }
+    std::vector<TimelineBlock> trackBlocks;
+    trackBlocks.reserve(indices.size());
+    for (const int index : indices)
+        trackBlocks.push_back(snapshot.getBlock(index));
     
     return trackBlocks;
 }
 
+const TimelineSnapshot* PatternEngine::acquireTimeline()
+{
+    timeline.acquireLatest();
+    return timeline.getAcquired();
+}
+
+void PatternEngine::publishTimeline(const TimelineEdit& edit)
+{
+    timelineStorage.push_back(std::make_unique<TimelineSnapshot>(blocks, edit));
+    const TimelineSnapshot* retired = timeline.publish(timelineStorage.back().get());
+    
+    // The snapshot displaced by this publish can no longer reach the audio thread
+    timelineStorage.erase(std::remove_if(timelineStorage.begin(), timelineStorage.end(),
+                                         [retired](const std::unique_ptr<TimelineSnapshot>& snapshot)
+                                         { return snapshot.get() == retired; }),
+                          timelineStorage.end());
+}
+
 void PatternEngine::setBPM(double bpm)
 {
     if (bpm > 0.0)
@@ -220,13 +453,20 @@ double PatternEngine::secondsToBeats(double seconds) const
 void PatternEngine::clearBlocks()
 {
     const juce::ScopedLock sl(blockLock);
+    
+    const TimelineEdit edit { 0, static_cast<int>(blocks.size()), 0, false };
     blocks.clear();
+    scriptIsParsed = false;
+    publishTimeline(edit);
 }
 
 void PatternEngine::addBlock(const TimelineBlock& block)
 {
     const juce::ScopedLock sl(blockLock);
+    
     blocks.push_back(block);
+    scriptIsParsed = false;
+    publishTimeline({ static_cast<int>(blocks.size()) - 1, 0, 1, false });
 }
 
 void PatternEngine::removeBlock(int index)
@@ -236,6 +476,8 @@ void PatternEngine::removeBlock(int index)
     if (index >= 0 && index < (int)blocks.size())
     {
         blocks.erase(blocks.begin() + index);
+        scriptIsParsed = false;
+        publishTimeline({ index, 1, 0, false });
     }
 }
 
@@ -259,4 +501,68 @@ void PatternEngine::setQuantizationEnabled(bool enabled)
     Logger::log(Logger::Level::Info, "Quantization: " + juce::String(enabled ? "enabled" : "disabled"));
 }
 
+//==============================================================================
+void PatternEngine::writeState(juce::OutputStream& output) const
+{
+    const juce::ScopedLock sl(blockLock);
+    
+    output.writeDouble(defaultBlockDuration);
+    output.writeBool(quantizationEnabled);
+    output.writeInt(static_cast<int>(blocks.size()));
+    
+    for (const auto& block : blocks)
+    {
+        output.writeInt(static_cast<int>(block.type));
+        output.writeInt(block.trackIndex);
+        output.writeDouble(block.startTime);
+        output.writeDouble(block.duration);
+        output.writeString(block.content);
+    }
+}
+
+bool PatternEngine::readState(juce::InputStream& input)
+{
+    // Type, track, start, duration and at least the content's terminator
+    constexpr juce::int64 MIN_BLOCK_BYTES = 4 + 4 + 8 + 8 + 1;
+    
+    const double blockDuration = input.readDouble();
+    const bool quantization = input.readBool();
+    const int numBlocks = input.readInt();
+    
+    if (numBlocks < 0 || numBlocks * MIN_BLOCK_BYTES > input.getNumBytesRemaining())
+    {
+        Logger::log(Logger::Level::Warning, "Corrupt timeline state");
+        return false;
+    }
+    
+    // Decode outside the lock; the audio thread only sees the finished timeline
+    std::vector<TimelineBlock> newBlocks(static_cast<size_t>(numBlocks));
+    
+    for (auto& block : newBlocks)
+    {
+        const int type = input.readInt();
+        block.type = type >= 0 && type <= static_cast<int>(BlockType::Vocal) ? static_cast<BlockType>(type)
+                                                                               : BlockType::Unknown;
+        block.trackIndex = input.readInt();
+        block.startTime = input.readDouble();
+        block.duration = input.readDouble();
+        block.content = input.readString();
+    }
+    
+    const juce::ScopedLock sl(blockLock);
+    
+    const TimelineEdit edit { 0, static_cast<int>(blocks.size()), numBlocks, false };
+    blocks = std::move(newBlocks);
+    
+    if (blockDuration > 0.0)
+        defaultBlockDuration = blockDuration;
+    quantizationEnabled = quantization;
+    
+    scriptIsParsed = false;
+    publishTimeline(edit);
+    
+    Logger::log(Logger::Level::Info, "Restored " + juce::String(numBlocks) + " timeline blocks");
+    return true;
+}
+
 } // namespace MAEVN
@@ -9,9 +9,13 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <functional>
+#include <string>
 #include <vector>
 #include <memory>
 #include "Utilities.h"
+#include "ParameterSnapshot.h"
+#include "TimelineSnapshot.h"
 
 namespace MAEVN
 {
@@ -28,8 +32,15 @@ public:
     
     /**
      * @brief Parse stage script input into timeline blocks
+     *
+     * Incremental: only the lines that differ from the previously parsed
+     * script are parsed again and only the blocks after them are moved, so
+     * it is cheap enough to call on every edit. Adding, removing or clearing
+     * blocks by hand, or changing the BPM, default duration or quantization,
+     * makes the next call parse the whole script.
+     *
      * @param scriptInput Text with [HOOK], [VERSE], [808] etc.
-     * @return Number of blocks parsed
+     * @return Number of blocks in the timeline
      */
     int parseStageScript(const juce::String& scriptInput);
     
@@ -45,13 +56,52 @@ public:
      */
     std::vector<TimelineBlock> getActiveBlocks(double time) const;
     
+    /**
+     * @brief Get blocks overlapping a span of time
+     * @param start Start of the span in seconds
+     * @param end End of the span in seconds (exclusive)
+     * @return Vector of blocks in timeline order
+     */
+    std::vector<TimelineBlock> getBlocksInRange(double start, double end) const;
+    
+    /**
+     * @brief Get indices into getBlocks() of the blocks overlapping a span of time
+     * @return Indices in timeline order
+     */
+    std::vector<int> getBlockIndicesInRange(double start, double end) const;
+    
+    /** Edits copies of some blocks in place; may drop some or append new blocks */
+    using BlockEditor = std::function<void(std::vector<TimelineBlock>&)>;
+    
+    /**
+     * @brief Rewrite the blocks overlapping a span of time as one edit
+     *
+     * The editor gets copies of the blocks overlapping [start, end) in
+     * timeline order, under the block lock. Changed copies are written back
+     * in place and appended ones are inserted after the last of them; if the
+     * editor drops copies, that many blocks are removed from the end of the
+     * range. All other blocks are left alone, so the published timeline edit
+     * covers only the span of the range.
+     *
+     * @return Number of blocks changed, added or removed
+     */
+    int editBlocksInRange(double start, double end, const BlockEditor& editor);
+    
     /**
      * @brief Get blocks for a specific track
      * @param trackIndex Track/lane index
-     * @return Vector of blocks for that track
+     * @return Vector of blocks for that track, ordered by start time
      */
     std::vector<TimelineBlock> getBlocksForTrack(int trackIndex) const;
     
+    /**
+     * @brief Pick up the latest timeline snapshot (audio thread only)
+     *
+     * Lock-free. The snapshot stays valid until the next call; query it with
+     * an ActiveBlockIterator rather than the copying getters above.
+     */
+    const TimelineSnapshot* acquireTimeline();
+    
     /**
      * @brief Set BPM for quantization
      */
@@ -121,6 +171,17 @@ public:
      */
     void setQuantizationEnabled(bool enabled);
     
+    /**
+     * @brief Write the blocks and their default timing for the plugin state
+     */
+    void writeState(juce::OutputStream& output) const;
+    
+    /**
+     * @brief Replace the blocks with ones written by writeState(), as one edit
+     * @return false, leaving the timeline unchanged, if the data is malformed
+     */
+    bool readState(juce::InputStream& input);
+    
 private:
     std::vector<TimelineBlock> blocks;
     double currentBPM;
@@ -131,16 +192,54 @@ private:
     
     mutable juce::CriticalSection blockLock;
     
+    // Snapshots of blocks for the audio thread; storage holds every one it
+    // may still be reading, and is only touched under blockLock
+    ParameterSnapshot<const TimelineSnapshot*> timeline { nullptr };
+    std::vector<std::unique_ptr<TimelineSnapshot>> timelineStorage;
+    
+    /**
+     * @brief Index the current blocks and hand them to the audio thread (under blockLock)
+     */
+    void publishTimeline(const TimelineEdit& edit);
+    
+    //==============================================================================
+    // Incremental parsing: the last parsed script, a slice per line, and the
+    // settings its blocks were timed with
+    struct ScriptLine
+    {
+        size_t start;
+        size_t length;
+        bool hasBlock;   // the line produced one block
+    };
+    
+    std::string scriptText;
+    std::vector<ScriptLine> scriptLines;
+    std::vector<double> blockCursors;   // unquantized start of each block
+    bool scriptIsParsed;
+    double scriptBPM;
+    double scriptBlockDuration;
+    bool scriptQuantization;
+    
+    /**
+     * @brief Slice text into lines without copying it
+     */
+    static void tokenizeLines(const std::string& text, std::vector<ScriptLine>& lines);
+    
+    /**
+     * @brief Compare a line of text with a line of the previously parsed script
+     */
+    bool sameLine(const std::string& text, const ScriptLine& line, const ScriptLine& previousLine) const;
+    
     /**
-     * @brief Parse a single block from text
+     * @brief Parse a single block from one line of UTF-8 text
      * Example: "[HOOK] This is the hook lyrics"
      */
-    TimelineBlock parseBlock(const juce::String& blockText, double startTime);
+    TimelineBlock parseBlock(const char* text, size_t length, double startTime);
     
     /**
-     * @brief Assign track indices based on block types
+     * @brief Block type for a tag, matched case-insensitively in place
      */
-    void assignTrackIndices();
+    static BlockType getBlockTypeForTag(const char* tag, size_t length);
     
     /**
      * @brief Get track index for a block type
@@ -0,0 +1,285 @@
+/**
+ * @file PitchTracker.cpp
+ * @brief Implementation of the shared pitch tracker
+ */
+
+#include "PitchTracker.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+PitchTracker::PitchTracker()
+    : juce::Thread("Pitch Analysis")
+    , decimation(1)
+    , decimationPhase(0)
+    , maxBlockSize(0)
+    , numChannels(0)
+    , ringMask(0)
+    , analysisRate(TARGET_ANALYSIS_RATE)
+    , estimate(Estimate{})
+{
+    for (auto& state : antiAliasState)
+        state.fill(0.0f);
+}
+
+PitchTracker::~PitchTracker()
+{
+    release();
+}
+
+void PitchTracker::prepare(double sampleRate, int maxBlock, int channels)
+{
+    release();
+    
+    maxBlockSize = juce::jmax(1, maxBlock);
+    numChannels = juce::jmax(1, channels);
+    decimation = juce::jmax(1, juce::roundToInt(sampleRate / TARGET_ANALYSIS_RATE));
+    analysisRate = sampleRate / decimation;
+    
+    // Fourth-order Butterworth at 80% of the analysis Nyquist frequency
+    const float cutoff = static_cast<float>(0.4 * analysisRate);
+    antiAliasCoefficients[0] = BiquadCoefficients::makeLowPass(sampleRate, cutoff, 0.54119610f);
+    antiAliasCoefficients[1] = BiquadCoefficients::makeLowPass(sampleRate, cutoff, 1.30656296f);
+    
+    monoScratch.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+    
+    const int ringSize = juce::nextPowerOfTwo(4 * ANALYSIS_WINDOW);
+    ring.assign(static_cast<size_t>(ringSize), 0.0f);
+    ringMask = ringSize - 1;
+    
+    // Zero-padding to twice the window keeps the autocorrelation linear
+    const int fftSize = 2 * ANALYSIS_WINDOW;
+    fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(fftSize)));
+    frame.assign(static_cast<size_t>(ANALYSIS_WINDOW), 0.0f);
+    workspace.assign(static_cast<size_t>(2 * fftSize), 0.0f);
+    nsdf.assign(static_cast<size_t>(ANALYSIS_WINDOW / 2 + 2), 0.0f);
+    
+    reset();
+}
+
+void PitchTracker::release()
+{
+    stopThread(2000);
+}
+
+void PitchTracker::reset()
+{
+    if (ring.empty())
+        return;
+    
+    release();
+    
+    for (auto& state : antiAliasState)
+        state.fill(0.0f);
+    
+    std::fill(ring.begin(), ring.end(), 0.0f);
+    decimationPhase = 0;
+    samplesWritten.store(0);
+    estimate.store(Estimate{});
+    
+    startThread(juce::Thread::Priority::normal);
+}
+
+//==============================================================================
+void PitchTracker::pushSamples(const juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const int channels = juce::jmin(numChannels, buffer.getNumChannels());
+    if (ring.empty() || channels <= 0 || numSamples <= 0)
+        return;
+    
+    jassert(numSamples <= maxBlockSize);
+    numSamples = juce::jmin(numSamples, maxBlockSize);
+    
+    float* mono = monoScratch.data();
+    std::copy(buffer.getReadPointer(0), buffer.getReadPointer(0) + numSamples, mono);
+    for (int ch = 1; ch < channels; ++ch)
+        juce::FloatVectorOperations::add(mono, buffer.getReadPointer(ch), numSamples);
+    
+    if (channels > 1)
+        juce::FloatVectorOperations::multiply(mono, 1.0f / static_cast<float>(channels), numSamples);
+    
+    for (size_t section = 0; section < antiAliasCoefficients.size(); ++section)
+    {
+        const auto& c = antiAliasCoefficients[section];
+        float z1 = antiAliasState[section][0];
+        float z2 = antiAliasState[section][1];
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = mono[i];
+            const float y = c.b0 * x + z1;
+            z1 = c.b1 * x - c.a1 * y + z2;
+            z2 = c.b2 * x - c.a2 * y;
+            mono[i] = y;
+        }
+        
+        antiAliasState[section][0] = z1;
+        antiAliasState[section][1] = z2;
+    }
+    
+    juce::int64 position = samplesWritten.load(std::memory_order_relaxed);
+    
+    int i = decimationPhase;
+    for (; i < numSamples; i += decimation)
+        ring[static_cast<size_t>(position++ & ringMask)] = mono[i];
+    
+    decimationPhase = i - numSamples;
+    
+    // The worker polls for it within HOP_POLL_MS
+    samplesWritten.store(position, std::memory_order_release);
+}
+
+//==============================================================================
+float PitchTracker::frequencyToMidiNote(float frequency)
+{
+    if (frequency <= 0.0f)
+        return 0.0f;
+    
+    return 69.0f + 12.0f * std::log2(frequency / 440.0f);
+}
+
+float PitchTracker::getMidiNote() const
+{
+    return frequencyToMidiNote(getFrequency());
+}
+
+//==============================================================================
+void PitchTracker::run()
+{
+    juce::int64 analysedUpTo = samplesWritten.load();
+    
+    while (!threadShouldExit())
+    {
+        const juce::int64 written = samplesWritten.load(std::memory_order_acquire);
+        
+        if (written < ANALYSIS_WINDOW || written - analysedUpTo < ANALYSIS_HOP)
+        {
+            wait(HOP_POLL_MS);
+            continue;
+        }
+        
+        // Only the newest window matters; hops missed while busy are skipped
+        const juce::int64 start = written - ANALYSIS_WINDOW;
+        for (int i = 0; i < ANALYSIS_WINDOW; ++i)
+            frame[static_cast<size_t>(i)] = ring[static_cast<size_t>((start + i) & ringMask)];
+        
+        analysedUpTo = written;
+        
+        // The audio thread lapped the copy: try again on the next hop
+        if (samplesWritten.load(std::memory_order_acquire) - start > ringMask + 1)
+            continue;
+        
+        analyseFrame();
+    }
+}
+
+void PitchTracker::analyseFrame()
+{
+    const int windowSize = ANALYSIS_WINDOW;
+    
+    double energy = 0.0;
+    for (const float x : frame)
+        energy += static_cast<double>(x) * x;
+    
+    if (energy < static_cast<double>(SILENCE_POWER) * windowSize)
+    {
+        estimate.store(Estimate{}, std::memory_order_release);
+        return;
+    }
+    
+    // Autocorrelation r(tau) = sum x[j] x[j + tau] as the inverse of the power spectrum
+    std::copy(frame.begin(), frame.end(), workspace.begin());
+    std::fill(workspace.begin() + windowSize, workspace.end(), 0.0f);
+    fft->performRealOnlyForwardTransform(workspace.data(), true);
+    
+    for (int bin = 0; bin <= windowSize; ++bin)
+    {
+        const float re = workspace[static_cast<size_t>(2 * bin)];
+        const float im = workspace[static_cast<size_t>(2 * bin + 1)];
+        workspace[static_cast<size_t>(2 * bin)] = re * re + im * im;
+        workspace[static_cast<size_t>(2 * bin + 1)] = 0.0f;
+    }
+    
+    fft->performRealOnlyInverseTransform(workspace.data());
+    
+    // nsdf(tau) = 2 r(tau) / m(tau), where m(tau) sums the squares of both
+    // overlapping segments and shrinks by one sample at each end per lag
+    const int minLag = juce::jmax(2, static_cast<int>(analysisRate / MAX_FREQUENCY));
+    const int maxLag = juce::jmin(windowSize / 2, static_cast<int>(std::ceil(analysisRate / MIN_FREQUENCY)));
+    
+    double m = 2.0 * energy;
+    for (int lag = 0; lag <= maxLag + 1; ++lag)
+    {
+        nsdf[static_cast<size_t>(lag)] = m > 0.0 ? static_cast<float>(2.0 * workspace[static_cast<size_t>(lag)] / m) : 0.0f;
+        
+        const float head = frame[static_cast<size_t>(lag)];
+        const float tail = frame[static_cast<size_t>(windowSize - 1 - lag)];
+        m -= static_cast<double>(head) * head + static_cast<double>(tail) * tail;
+    }
+    
+    // Key maxima: the highest point of each positive lobe after the one at
+    // lag 0, refined by a parabola through the peak and its neighbours
+    static constexpr int MAX_KEY_MAXIMA = 32;
+    std::array<float, MAX_KEY_MAXIMA> keyLags;
+    std::array<float, MAX_KEY_MAXIMA> keyHeights;
+    int numKeyMaxima = 0;
+    float highest = 0.0f;
+    
+    int lag = 1;
+    while (lag <= maxLag && nsdf[static_cast<size_t>(lag)] > 0.0f)
+        ++lag;
+    
+    while (lag <= maxLag && numKeyMaxima < MAX_KEY_MAXIMA)
+    {
+        while (lag <= maxLag && nsdf[static_cast<size_t>(lag)] <= 0.0f)
+            ++lag;
+        
+        if (lag > maxLag)
+            break;
+        
+        int peak = lag;
+        while (lag <= maxLag && nsdf[static_cast<size_t>(lag)] > 0.0f)
+        {
+            if (nsdf[static_cast<size_t>(lag)] > nsdf[static_cast<size_t>(peak)])
+                peak = lag;
+            ++lag;
+        }
+        
+        if (peak < minLag)
+            continue;
+        
+        const float left = nsdf[static_cast<size_t>(peak - 1)];
+        const float centre = nsdf[static_cast<size_t>(peak)];
+        const float right = nsdf[static_cast<size_t>(peak + 1)];
+        const float curvature = left - 2.0f * centre + right;
+        const float offset = curvature < 0.0f ? juce::jlimit(-0.5f, 0.5f, 0.5f * (left - right) / curvature) : 0.0f;
+        
+        keyLags[static_cast<size_t>(numKeyMaxima)] = static_cast<float>(peak) + offset;
+        keyHeights[static_cast<size_t>(numKeyMaxima)] = centre - 0.25f * (left - right) * offset;
+        highest = juce::jmax(highest, keyHeights[static_cast<size_t>(numKeyMaxima)]);
+        ++numKeyMaxima;
+    }
+    
+    // The first key maximum close to the highest is the period; later ones
+    // are its multiples and would read an octave or more low
+    Estimate result;
+    
+    for (int k = 0; k < numKeyMaxima; ++k)
+    {
+        if (keyHeights[static_cast<size_t>(k)] < PEAK_THRESHOLD * highest)
+            continue;
+        
+        result.clarity = juce::jmin(1.0f, keyHeights[static_cast<size_t>(k)]);
+        
+        const float frequency = static_cast<float>(analysisRate / keyLags[static_cast<size_t>(k)]);
+        if (result.clarity >= MIN_CLARITY && frequency >= MIN_FREQUENCY && frequency <= MAX_FREQUENCY)
+            result.frequency = frequency;
+        
+        break;
+    }
+    
+    estimate.store(result, std::memory_order_release);
+}
+
+} // namespace MAEVN
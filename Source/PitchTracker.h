@@ -0,0 +1,140 @@
+/**
+ * @file PitchTracker.h
+ * @brief Shared monophonic pitch analysis on a background thread
+ *
+ * The audio thread only mixes its input to mono, low-passes it and keeps
+ * every DECIMATION-th sample (an analysis rate of about 22 kHz) in a ring.
+ * A worker thread analyses the newest ANALYSIS_WINDOW samples every
+ * ANALYSIS_HOP samples (75% overlap) with the McLeod pitch method: the
+ * normalised square difference function (YIN's difference function scaled
+ * into -1..1) built from an FFT autocorrelation, so a window costs two
+ * FFTs rather than a lag-by-lag sum. The result is published as one atomic
+ * Estimate, which any number of consumers read for free.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "SmoothedBiquad.h"
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Pitch tracker fed by the audio thread and read from anywhere
+ *
+ * One tracker analyses one input; processors hand a pointer to it to every
+ * module that needs pitch instead of each module estimating its own.
+ */
+class PitchTracker : private juce::Thread
+{
+public:
+    /** Analysis rate the decimation factor aims for */
+    static constexpr double TARGET_ANALYSIS_RATE = 22050.0;
+    
+    static constexpr int ANALYSIS_WINDOW = 2048;
+    static constexpr int ANALYSIS_HOP = ANALYSIS_WINDOW / 4;
+    
+    /** How often the worker looks for a new hop (a hop is about 23 ms) */
+    static constexpr int HOP_POLL_MS = 5;
+    
+    static constexpr float MIN_FREQUENCY = 40.0f;     // below an 808's low E
+    static constexpr float MAX_FREQUENCY = 1500.0f;   // above a soprano's top
+    
+    /** Peaks of the normalised function below this are reported as unvoiced */
+    static constexpr float MIN_CLARITY = 0.8f;
+    
+    /**
+     * @brief One analysis result
+     */
+    struct Estimate
+    {
+        float frequency = 0.0f;   // Hz, 0 when unvoiced
+        float clarity = 0.0f;     // 0..1, height of the chosen peak
+    };
+    
+    PitchTracker();
+    ~PitchTracker() override;
+    
+    /**
+     * @brief Allocate the analysis state and start the worker (call outside the audio callback)
+     */
+    void prepare(double sampleRate, int maxBlockSize, int numChannels);
+    
+    /**
+     * @brief Stop the worker
+     */
+    void release();
+    
+    /**
+     * @brief Forget the input heard so far and report unvoiced (call while audio is stopped)
+     */
+    void reset();
+    
+    /**
+     * @brief Queue numSamples of the input for analysis (audio thread, realtime safe)
+     */
+    void pushSamples(const juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    /**
+     * @brief Newest estimate (any thread)
+     */
+    Estimate getEstimate() const { return estimate.load(std::memory_order_acquire); }
+    
+    float getFrequency() const { return getEstimate().frequency; }
+    bool hasPitch() const { return getFrequency() > 0.0f; }
+    
+    /**
+     * @brief Newest frequency as a fractional MIDI note (0 when unvoiced)
+     */
+    float getMidiNote() const;
+    
+    static float frequencyToMidiNote(float frequency);
+
+private:
+    /** Mean square below which a window is treated as silence (-60 dBFS RMS) */
+    static constexpr float SILENCE_POWER = 1.0e-6f;
+    
+    /** The first peak within this fraction of the highest one is the period */
+    static constexpr float PEAK_THRESHOLD = 0.9f;
+    
+    void run() override;
+    
+    /**
+     * @brief Analyse the window held in frame and publish the result (worker thread)
+     */
+    void analyseFrame();
+    
+    // Audio thread
+    std::array<BiquadCoefficients, 2> antiAliasCoefficients;
+    std::array<std::array<float, 2>, 2> antiAliasState;
+    std::vector<float> monoScratch;
+    int decimation;
+    int decimationPhase;
+    int maxBlockSize;
+    int numChannels;
+    
+    // Decimated input, written by the audio thread and read by the worker
+    std::vector<float> ring;
+    int ringMask;
+    std::atomic<juce::int64> samplesWritten { 0 };   // polled; signalling would lock
+    
+    // Worker thread
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<float> frame;
+    std::vector<float> workspace;
+    std::vector<float> nsdf;
+    double analysisRate;
+    
+    std::atomic<Estimate> estimate;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PitchTracker)
+};
+
+} // namespace MAEVN
@@ -15,12 +15,14 @@ MAEVNAudioProcessorEditor::MAEVNAudioProcessorEditor(MAEVNAudioProcessor& p)
 {
     setSize(1200, 800);
     setupUI();
+    startTimerHz(TIMELINE_REFRESH_HZ);
     
     Logger::log(Logger::Level::Info, "MAEVN Editor initialized");
 }
 
 MAEVNAudioProcessorEditor::~MAEVNAudioProcessorEditor()
 {
+    stopTimer();
 }
 
 //==============================================================================
@@ -60,7 +62,7 @@ void MAEVNAudioProcessorEditor::resized()
         }
     }
     
-    // Bottom area for preset browser and undo history
+    // Bottom area for preset browser, undo history and the profiler between them
     auto bottomArea = bounds;
     if (presetBrowser)
     {
@@ -70,6 +72,10 @@ void MAEVNAudioProcessorEditor::resized()
     {
         undoHistory->setBounds(bottomArea.removeFromRight(300).reduced(10));
     }
+    if (profilerView)
+    {
+        profilerView->setBounds(bottomArea.reduced(10));
+    }
 }
 
 void MAEVNAudioProcessorEditor::setupUI()
@@ -82,6 +88,9 @@ void MAEVNAudioProcessorEditor::setupUI()
         "Enter stage script here, e.g.:\n[HOOK] Catchy hook lyrics\n[VERSE] Verse lyrics\n[808] Bass pattern",
         juce::Colours::grey);
     
+    // Keep the timeline in step while typing; only edited lines are re-parsed
+    stageScriptInput.onTextChange = [this] { onStageScriptEdited(); };
+    
     // Parse button
     addAndMakeVisible(parseButton);
     parseButton.setButtonText("Parse Script");
@@ -95,6 +104,7 @@ void MAEVNAudioProcessorEditor::setupUI()
     bpmSlider.setRange(60.0, 200.0, 1.0);
     bpmSlider.setValue(audioProcessor.getPatternEngine().getBPM());
     bpmSlider.onValueChange = [this] { onBPMChanged(); };
+    bpmSlider.onDragEnd = [this] { audioProcessor.refreshVocalRenders(); };
     
     // Create timeline lanes
     const juce::StringArray trackNames = {
@@ -103,7 +113,8 @@ void MAEVNAudioProcessorEditor::setupUI()
     
     for (int i = 0; i < 6; ++i)
     {
-        auto lane = std::make_unique<TimelineLane>(i, &audioProcessor.getPatternEngine());
+        auto lane = std::make_unique<TimelineLane>(i, &audioProcessor.getPatternEngine(),
+                                                   &audioProcessor.getWaveformPeaks());
         lane->setTrackName(trackNames[i]);
         addAndMakeVisible(*lane);
         timelineLanes.push_back(std::move(lane));
@@ -116,6 +127,19 @@ void MAEVNAudioProcessorEditor::setupUI()
     // Undo history
     undoHistory = std::make_unique<UndoHistoryComponent>(&audioProcessor.getUndoManager());
     addAndMakeVisible(*undoHistory);
+    
+    // Realtime profiler
+    profilerView = std::make_unique<RealtimeProfilerComponent>(&audioProcessor.getProfiler());
+    addAndMakeVisible(*profilerView);
+}
+
+void MAEVNAudioProcessorEditor::onStageScriptEdited()
+{
+    audioProcessor.getPatternEngine().parseStageScript(stageScriptInput.getText());
+    
+    // Lanes repaint only the blocks the edit changed
+    for (auto& lane : timelineLanes)
+        lane->refreshBlocks();
 }
 
 void MAEVNAudioProcessorEditor::onParseButtonClicked()
@@ -147,7 +171,7 @@ void MAEVNAudioProcessorEditor::onParseButtonClicked()
     // Refresh timeline lanes
     for (auto& lane : timelineLanes)
     {
-        lane->repaint();
+        lane->refreshBlocks();
     }
     
     // Show result
@@ -160,6 +184,10 @@ void MAEVNAudioProcessorEditor::onBPMChanged()
     double newBPM = bpmSlider.getValue();
     audioProcessor.getPatternEngine().setBPM(newBPM);
     
+    // Re-render vocals once the drag settles, not on every step
+    if (!bpmSlider.isMouseButtonDown())
+        audioProcessor.refreshVocalRenders();
+    
     // Add undo action
     ActionState action(
         ActionState::Type::ArrangementChange,
@@ -171,4 +199,23 @@ void MAEVNAudioProcessorEditor::onBPMChanged()
     Logger::log(Logger::Level::Info, "BPM changed to: " + juce::String(newBPM, 1));
 }
 
+void MAEVNAudioProcessorEditor::timerCallback()
+{
+    auto& patternEngine = audioProcessor.getPatternEngine();
+    const double playhead = patternEngine.getCurrentPosition();
+    
+    // Only look up peaks once some pyramid has grown
+    const auto peaksVersion = audioProcessor.getWaveformPeaks().getVersion();
+    const bool peaksChanged = peaksVersion != lastPeaksVersion;
+    lastPeaksVersion = peaksVersion;
+    
+    for (auto& lane : timelineLanes)
+    {
+        lane->setPlayheadPosition(playhead);
+        
+        if (peaksChanged)
+            lane->refreshWaveforms();
+    }
+}
+
 } // namespace MAEVN
@@ -10,13 +10,18 @@
 #include "TimelineLane.h"
 #include "PresetBrowserComponent.h"
 #include "UndoHistoryComponent.h"
+#include "RealtimeProfiler.h"
 
 namespace MAEVN
 {
 
-class MAEVNAudioProcessorEditor : public juce::AudioProcessorEditor
+class MAEVNAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                  private juce::Timer
 {
 public:
+    /** Playhead and waveform refresh rate of the timeline lanes */
+    static constexpr int TIMELINE_REFRESH_HZ = 30;
+    
     MAEVNAudioProcessorEditor(MAEVNAudioProcessor&);
     ~MAEVNAudioProcessorEditor() override;
     
@@ -34,6 +39,7 @@ private:
     
     // Timeline lanes
     std::vector<std::unique_ptr<TimelineLane>> timelineLanes;
+    juce::uint32 lastPeaksVersion = 0;
     
     // Preset browser
     std::unique_ptr<PresetBrowserComponent> presetBrowser;
@@ -41,9 +47,14 @@ private:
     // Undo history
     std::unique_ptr<UndoHistoryComponent> undoHistory;
     
+    // Realtime profiler
+    std::unique_ptr<RealtimeProfilerComponent> profilerView;
+    
     void setupUI();
+    void onStageScriptEdited();
     void onParseButtonClicked();
     void onBPMChanged();
+    void timerCallback() override;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MAEVNAudioProcessorEditor)
 };
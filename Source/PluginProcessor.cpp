@@ -9,18 +9,68 @@
 namespace MAEVN
 {
 
+namespace
+{
+    // Versions of the saved state's sections; bump when appending fields
+    constexpr int PARAMS_STATE_VERSION = 1;
+    constexpr int FX_STATE_VERSION = 1;
+    constexpr int TIMELINE_STATE_VERSION = 1;
+}
+
 //==============================================================================
 MAEVNAudioProcessor::MAEVNAudioProcessor()
     : AudioProcessor(BusesProperties()
                      .withInput("Input", juce::AudioChannelSet::stereo(), true)
+                     .withInput("808 In", juce::AudioChannelSet::stereo(), false)
+                     .withInput("HiHat In", juce::AudioChannelSet::stereo(), false)
+                     .withInput("Snare In", juce::AudioChannelSet::stereo(), false)
+                     .withInput("Piano In", juce::AudioChannelSet::stereo(), false)
+                     .withInput("Synth In", juce::AudioChannelSet::stereo(), false)
                      .withOutput("Output", juce::AudioChannelSet::stereo(), true))
     , aiFXEngine(&onnxEngine)
+    , vocalSynthesizer(onnxEngine, vocalRenderCache)
+    , renderScheduler(patternEngine)
     , currentSampleRate(44100.0)
     , currentBlockSize(512)
     , cinematicEnhancerEnabled(true)
+    , prepared(false)
 {
+    profileStages.transport = profiler.registerStage("block/transport");
+    profileStages.routing = profiler.registerStage("block/routing");
+    profileStages.fx = profiler.registerStage("block/fx", true);
+    profileStages.mix = profiler.registerStage("block/mix");
+    profileStages.enhancer = profiler.registerStage("block/enhancer", true);
+    profileStages.metering = profiler.registerStage("block/metering");
+    
+    aiFXEngine.setProfiler(&profiler);
+    cinematicEnhancer.setProfiler(&profiler);
+    
     // Initialize ONNX engine
     onnxEngine.initialize();
+    gpuManager.setOnnxEngine(&onnxEngine);
+    
+    // Models finish loading on the load pool; the effects that use them are
+    // re-prepared on the message thread, where the host latency may change
+    onnxEngine.onModelLoadStateChanged = [this](const juce::String& role, ModelLoadState state)
+    {
+        if (state != ModelLoadState::Ready)
+            return;
+        
+        {
+            const juce::ScopedLock sl(readyModelRolesLock);
+            readyModelRoles.addIfNotAlreadyThere(role);
+        }
+        
+        triggerAsyncUpdate();
+    };
+    
+    // Rendered blocks, from the cache or fresh, also get a waveform for the lanes
+    renderScheduler.setRenderer([this](const TimelineBlock& block, double sampleRate)
+    {
+        auto audio = renderVocalBlock(block, sampleRate);
+        waveformPeaks.addRenderedAudio(block, audio, sampleRate);
+        return audio;
+    });
     
     // Load models and presets
     initializeModelsAndPresets();
@@ -33,6 +83,33 @@ MAEVNAudioProcessor::MAEVNAudioProcessor()
 
 MAEVNAudioProcessor::~MAEVNAudioProcessor()
 {
+    // Renders run the vocal models, which are destroyed after the scheduler
+    renderScheduler.stop();
+    
+    // Background loads call back into aiFXEngine, which is destroyed first
+    onnxEngine.cancelPendingLoads();
+    onnxEngine.onModelLoadStateChanged = nullptr;
+    cancelPendingUpdate();
+}
+
+void MAEVNAudioProcessor::handleAsyncUpdate()
+{
+    juce::StringArray roles;
+    {
+        const juce::ScopedLock sl(readyModelRolesLock);
+        roles.swapWith(readyModelRoles);
+    }
+    
+    for (const auto& role : roles)
+    {
+        aiFXEngine.refreshModelRole(role);
+        
+        // Vocal blocks skipped while the models were missing can render now
+        if (role.startsWith("vocal_"))
+            renderScheduler.invalidate();
+    }
+    
+    updateHostLatency();
 }
 
 //==============================================================================
@@ -58,7 +135,24 @@ bool MAEVNAudioProcessor::isMidiEffect() const
 
 double MAEVNAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // Tracks run side by side into the enhancer, which runs its stages in series
+    double tail = aiFXEngine.getTailLengthSeconds();
+    
+    if (cinematicEnhancerEnabled)
+        tail += cinematicEnhancer.getTailLengthSeconds();
+    
+    return tail;
+}
+
+void MAEVNAudioProcessor::updateHostLatency()
+{
+    // The enhancer runs after the track mix, so its delay adds to the FX engine's
+    int latency = aiFXEngine.getLatencySamples();
+    
+    if (cinematicEnhancerEnabled)
+        latency += cinematicEnhancer.getLatencySamples();
+    
+    setLatencySamples(latency);
 }
 
 int MAEVNAudioProcessor::getNumPrograms()
@@ -93,11 +187,19 @@ void MAEVNAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
     currentSampleRate = sampleRate;
     currentBlockSize = samplesPerBlock;
     
+    // Render-ahead and playback read the timeline from here on
+    loadPendingTimeline();
+    prepared = true;
+    
     // Prepare AI FX engine
     aiFXEngine.prepare(sampleRate, samplesPerBlock);
     
     // Prepare Cinematic Audio Enhancer
     cinematicEnhancer.prepare(sampleRate, samplesPerBlock);
+    outputLoudness.prepare(sampleRate, getTotalNumOutputChannels());
+    
+    // Report async inference and oversampling delay so the host can compensate
+    updateHostLatency();
     
     // Allocate track buffers
     for (auto& buffer : trackBuffers)
@@ -105,12 +207,28 @@ void MAEVNAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
         buffer.setSize(2, samplesPerBlock);
     }
     
+    juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(samplesPerBlock), 2 };
+    for (auto& delay : trackAlignment)
+    {
+        delay.setMaximumDelayInSamples(MAX_ALIGNMENT_DELAY);
+        delay.prepare(spec);
+        delay.setDelay(0.0f);
+    }
+    
+    trackWorkers.start(RealtimeWorkerPool::getDefaultNumWorkers());
+    
+    // Clips are rendered per sample rate; cached renders make a change cheap
+    renderScheduler.start(sampleRate);
+    
     Logger::log(Logger::Level::Info, 
         "Prepared to play: " + juce::String(sampleRate) + " Hz, " + juce::String(samplesPerBlock) + " samples");
 }
 
 void MAEVNAudioProcessor::releaseResources()
 {
+    prepared = false;
+    trackWorkers.stop();
+    renderScheduler.stop();
     aiFXEngine.reset();
     cinematicEnhancer.reset();
 }
@@ -124,6 +242,14 @@ bool MAEVNAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) con
     if (layouts.getMainInputChannelSet() != juce::AudioChannelSet::stereo())
         return false;
     
+    // Auxiliary track inputs are optional stereo buses
+    for (int bus = 1; bus < layouts.inputBuses.size(); ++bus)
+    {
+        const auto& set = layouts.getChannelSet(true, bus);
+        if (!set.isDisabled() && set != juce::AudioChannelSet::stereo())
+            return false;
+    }
+    
     return true;
 }
 
@@ -135,25 +261,72 @@ void MAEVNAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
     auto totalNumOutputChannels = getTotalNumOutputChannels();
     int numSamples = buffer.getNumSamples();
     
+    profiler.beginBlock(numSamples, currentSampleRate);
+    governor.beginBlock();
+    
     // Clear unused output channels
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, numSamples);
     
     // Update transport information
-    updateTransportInfo();
+    {
+        const RealtimeProfiler::ScopedTimer timer(&profiler, profileStages.transport);
+        updateTransportInfo(numSamples);
+    }
     
     // Process all tracks with FX
     processAllTracks(buffer, numSamples);
     
+    auto mainOutput = getBusBuffer(buffer, false, 0);
+    MeterBlock meters;
+    meters.numSamples = numSamples;
+    meters.sampleRate = currentSampleRate;
+    meters.cpuLoad = governor.getLoad();
+    meters.qualityTier = static_cast<int>(appliedQualityTier);
+    
+    {
+        const RealtimeProfiler::ScopedTimer timer(&profiler, profileStages.metering);
+        meters.measureInput(mainOutput, numSamples);
+    }
+    
     // Apply Cinematic Audio Enhancement (final processing stage)
     if (cinematicEnhancerEnabled)
     {
-        cinematicEnhancer.process(buffer, numSamples);
+        const RealtimeProfiler::ScopedTimer timer(&profiler, profileStages.enhancer);
+        cinematicEnhancer.process(mainOutput, numSamples);
+        meters.gainReductionDB[LIMITER_METER_STAGE] = cinematicEnhancer.getLimiterGainReductionDB();
+    }
+    
+    {
+        const RealtimeProfiler::ScopedTimer timer(&profiler, profileStages.metering);
+        meters.measureOutput(mainOutput, numSamples);
+        outputLoudness.process(mainOutput, numSamples);
+        meters.momentaryLUFS = outputLoudness.getMomentaryLUFS();
+        meterQueue.push(meters);
+    }
+    
+    profiler.endBlock();
+    
+    // Offline renders have no deadline and always run at full quality
+    const auto tier = governor.endBlock(numSamples, currentSampleRate, !isNonRealtime());
+    if (tier != appliedQualityTier)
+    {
+        applyQualityTier(tier);
+        appliedQualityTier = tier;
     }
     
     juce::ignoreUnused(midiMessages);
 }
 
+void MAEVNAudioProcessor::applyQualityTier(QualityTier tier)
+{
+    // Tiers are cumulative: each one keeps the levers of those before it
+    aiFXEngine.setAIFallback(tier >= QualityTier::AIFallback);
+    cinematicEnhancer.setSaturationOversamplingLimit(tier >= QualityTier::ReducedOversampling ? 1 : 4);
+    cinematicEnhancer.setCinematicReverbTailLimit(tier >= QualityTier::ShortReverbTail ? CPUGovernor::SHORT_TAIL_SECONDS
+                                                                                        : 0.0);
+}
+
 //==============================================================================
 bool MAEVNAudioProcessor::hasEditor() const
 {
@@ -168,28 +341,100 @@ juce::AudioProcessorEditor* MAEVNAudioProcessor::createEditor()
 //==============================================================================
 void MAEVNAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    // Save plugin state
-    auto* obj = new juce::DynamicObject();
+    StateChunkWriter writer;
     
-    obj->setProperty("bpm", patternEngine.getBPM());
-    obj->setProperty("cinematicEnhancerEnabled", cinematicEnhancerEnabled);
+    {
+        juce::MemoryOutputStream params(writer.addSection(StateSection::ProcessorParams, PARAMS_STATE_VERSION), false);
+        params.writeDouble(patternEngine.getBPM());
+        params.writeBool(cinematicEnhancerEnabled);
+    }
     
-    // Save FX modes for each track
-    juce::Array<juce::var> fxModes;
-    for (int i = 0; i < aiFXEngine.getNumTracks(); ++i)
     {
-        fxModes.add(static_cast<int>(aiFXEngine.getFXMode(i)));
+        // FX mode of each track
+        juce::MemoryOutputStream fx(writer.addSection(StateSection::FXChains, FX_STATE_VERSION), false);
+        fx.writeInt(aiFXEngine.getNumTracks());
+        for (int i = 0; i < aiFXEngine.getNumTracks(); ++i)
+        {
+            fx.writeInt(static_cast<int>(aiFXEngine.getFXMode(i)));
+        }
+    }
+    
+    {
+        const juce::ScopedLock sl(stateLock);
+        
+        // A restored timeline nothing has touched goes back out without a decode/encode round trip
+        if (timelineStatePending)
+        {
+            writer.addSection(StateSection::Timeline, TIMELINE_STATE_VERSION, pendingTimelineState);
+        }
+        else
+        {
+            juce::MemoryOutputStream timeline(writer.addSection(StateSection::Timeline, TIMELINE_STATE_VERSION), false);
+            patternEngine.writeState(timeline);
+        }
     }
-    obj->setProperty("fxModes", fxModes);
     
-    juce::var state(obj);
-    juce::String stateString = juce::JSON::toString(state);
-    destData.append(stateString.toRawUTF8(), stateString.getNumBytesAsUTF8());
+    writer.writeTo(destData);
 }
 
 void MAEVNAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-    // Restore plugin state
+    if (!StateChunkReader::isStateChunk(data, static_cast<size_t>(sizeInBytes)))
+    {
+        setLegacyJSONState(data, sizeInBytes);
+        return;
+    }
+    
+    StateChunkReader reader(data, static_cast<size_t>(sizeInBytes));
+    if (!reader.isValid())
+        return;
+    
+    if (auto params = reader.createSectionStream(StateSection::ProcessorParams))
+    {
+        patternEngine.setBPM(params->readDouble());
+        cinematicEnhancerEnabled = params->readBool();
+    }
+    
+    if (auto fx = reader.createSectionStream(StateSection::FXChains))
+    {
+        const int numModes = fx->readInt();
+        for (int i = 0; i < numModes && i < aiFXEngine.getNumTracks(); ++i)
+        {
+            aiFXEngine.setFXMode(i, static_cast<FXMode>(fx->readInt()));
+        }
+    }
+    
+    if (reader.hasSection(StateSection::Timeline))
+    {
+        const juce::ScopedLock sl(stateLock);
+        pendingTimelineState = reader.copySection(StateSection::Timeline);
+        timelineStatePending = true;
+    }
+    
+    // Playback needs the timeline now; otherwise it waits for prepareToPlay() or the editor
+    if (prepared)
+        loadPendingTimeline();
+}
+
+void MAEVNAudioProcessor::loadPendingTimeline()
+{
+    if (!timelineStatePending)
+        return;
+    
+    const juce::ScopedLock sl(stateLock);
+    
+    if (!timelineStatePending)
+        return;
+    
+    juce::MemoryInputStream input(pendingTimelineState, false);
+    patternEngine.readState(input);
+    
+    pendingTimelineState.reset();
+    timelineStatePending = false;
+}
+
+void MAEVNAudioProcessor::setLegacyJSONState(const void* data, int sizeInBytes)
+{
     juce::String stateString = juce::String::createStringFromData(data, sizeInBytes);
     juce::var state = juce::JSON::parse(stateString);
     
@@ -234,7 +479,8 @@ void MAEVNAudioProcessor::initializeModelsAndPresets()
         juce::File configFile = modelsDir.getChildFile("config.json");
         if (configFile.existsAsFile())
         {
-            onnxEngine.loadModelsFromConfig(configFile.getFullPathName());
+            // Don't stall plugin instantiation on session creation
+            onnxEngine.loadModelsFromConfig(configFile.getFullPathName(), ModelLoadPolicy::Background);
         }
     }
     
@@ -248,21 +494,96 @@ void MAEVNAudioProcessor::initializeModelsAndPresets()
 
 void MAEVNAudioProcessor::processAllTracks(juce::AudioBuffer<float>& buffer, int numSamples)
 {
-    // For now, just apply FX to main buffer
-    // In full implementation, would route to different tracks
+    numSamples = juce::jmin(numSamples, trackBuffers[0].getNumSamples());
+    
+    // Rendered blocks are only heard while the transport runs
+    const auto* readyClips = renderScheduler.acquireReadyClips();
+    if (readyClips != nullptr && (!patternEngine.isPlaying() || readyClips->sampleRate != currentSampleRate))
+        readyClips = nullptr;
     
-    // Apply FX for each active track
-    // This is a simplified version - full version would handle routing
-    for (int trackIndex = 0; trackIndex < aiFXEngine.getNumTracks(); ++trackIndex)
+    const double position = patternEngine.getCurrentPosition();
+    const double blockEnd = position + numSamples / currentSampleRate;
+    
+    // Route each track's source into its own buffer; tracks with no source are
+    // skipped once their effect tails have rung out
+    std::array<juce::AudioBuffer<float>*, NUM_TRACKS> tracks {};
+    RealtimeProfiler::ScopedTimer timer(&profiler, profileStages.routing);
+    
+    for (int trackIndex = 0; trackIndex < NUM_TRACKS; ++trackIndex)
     {
-        if (aiFXEngine.getFXMode(trackIndex) != FXMode::Off)
+        auto* bus = getBus(true, trackIndex);
+        const bool hasInput = bus != nullptr && bus->isEnabled();
+        const bool hasClips = readyClips != nullptr && readyClips->hasAudio(trackIndex, position, blockEnd);
+        
+        // The vocal track always runs, for its input and the rendered vocal lines
+        if (!hasInput && !hasClips && trackIndex != 0 && !aiFXEngine.isTrackTailActive(trackIndex))
+            continue;
+        
+        auto& track = trackBuffers[trackIndex];
+        track.clear(0, numSamples);
+        
+        if (hasInput)
         {
-            aiFXEngine.process(buffer, numSamples, trackIndex);
+            auto input = getBusBuffer(buffer, true, trackIndex);
+            for (int ch = 0; ch < track.getNumChannels(); ++ch)
+                track.copyFrom(ch, 0, input, juce::jmin(ch, input.getNumChannels() - 1), 0, numSamples);
         }
+        
+        if (hasClips)
+            readyClips->mixInto(track, trackIndex, position, numSamples);
+        
+        tracks[trackIndex] = &track;
     }
+    
+    timer.restart(profileStages.fx);
+    aiFXEngine.processTracks(tracks.data(), NUM_TRACKS, numSamples, &trackWorkers);
+    timer.restart(profileStages.mix);
+    
+    // Sum into the main output, aligning every track to the slowest chain
+    const int totalLatency = aiFXEngine.getRunningLatencySamples();
+    auto output = getBusBuffer(buffer, false, 0);
+    output.clear(0, numSamples);
+    
+    for (int trackIndex = 0; trackIndex < NUM_TRACKS; ++trackIndex)
+    {
+        auto* track = tracks[trackIndex];
+        if (track == nullptr)
+            continue;
+        
+        const int alignment = juce::jlimit(0, MAX_ALIGNMENT_DELAY,
+                                           totalLatency - aiFXEngine.getRunningTrackLatencySamples(trackIndex));
+        if (alignment > 0)
+        {
+            auto& delay = trackAlignment[trackIndex];
+            delay.setDelay(static_cast<float>(alignment));
+            
+            juce::dsp::AudioBlock<float> block(*track);
+            auto subBlock = block.getSubsetChannelBlock(0, 2).getSubBlock(0, static_cast<size_t>(numSamples));
+            delay.process(juce::dsp::ProcessContextReplacing<float>(subBlock));
+        }
+        
+        for (int ch = 0; ch < output.getNumChannels(); ++ch)
+            output.addFrom(ch, 0, *track, juce::jmin(ch, track->getNumChannels() - 1), 0, numSamples);
+    }
+}
+
+VocalRenderCache::RenderedAudio MAEVNAudioProcessor::renderVocalBlock(const TimelineBlock& block)
+{
+    return renderVocalBlock(block, currentSampleRate);
 }
 
-void MAEVNAudioProcessor::updateTransportInfo()
+VocalRenderCache::RenderedAudio MAEVNAudioProcessor::renderVocalBlock(const TimelineBlock& block, double sampleRate)
+{
+    return vocalSynthesizer.render(block, patternEngine.getBPM(), sampleRate);
+}
+
+void MAEVNAudioProcessor::refreshVocalRenders()
+{
+    // Blocks whose render did not change come straight from the render cache
+    renderScheduler.invalidate();
+}
+
+void MAEVNAudioProcessor::updateTransportInfo(int numSamples)
 {
     auto* playHeadPtr = getPlayHead();
     if (playHeadPtr != nullptr)
@@ -276,6 +597,9 @@ void MAEVNAudioProcessor::updateTransportInfo()
             double timeInSeconds = timeOpt.hasValue() ? *timeOpt : 0.0;
             patternEngine.updateTransport(isPlaying, timeInSeconds);
             
+            // A stopped playhead stays put, so the next block's position is no seek
+            renderScheduler.updatePlayhead(timeInSeconds, isPlaying ? numSamples / currentSampleRate : 0.0);
+            
             // Update BPM if it changed
             if (auto bpmOpt = posInfo->getBpm())
             {
@@ -10,17 +10,29 @@
 
 #include <JuceHeader.h>
 #include "OnnxEngine.h"
+#include "GPUAcceleration.h"
 #include "PatternEngine.h"
 #include "AIFXEngine.h"
 #include "CinematicAudioEnhancer.h"
+#include "LoudnessMeter.h"
+#include "Metering.h"
 #include "FXPresetManager.h"
 #include "GlobalUndoManager.h"
+#include "VocalRenderCache.h"
+#include "VocalSynthesizer.h"
+#include "RenderAheadScheduler.h"
+#include "WaveformPeaks.h"
+#include "RealtimeWorkerPool.h"
+#include "RealtimeProfiler.h"
+#include "CPUGovernor.h"
+#include "StateChunk.h"
 #include "Utilities.h"
 
 namespace MAEVN
 {
 
-class MAEVNAudioProcessor : public juce::AudioProcessor
+class MAEVNAudioProcessor : public juce::AudioProcessor,
+                            private juce::AsyncUpdater
 {
 public:
     MAEVNAudioProcessor();
@@ -60,25 +72,83 @@ public:
     //==============================================================================
     // Public access to engines for editor
     OnnxEngine& getOnnxEngine() { return onnxEngine; }
-    PatternEngine& getPatternEngine() { return patternEngine; }
+    GPUAccelerationManager& getGPUManager() { return gpuManager; }
+    PatternEngine& getPatternEngine() { loadPendingTimeline(); return patternEngine; }
     AIFXEngine& getAIFXEngine() { return aiFXEngine; }
     CinematicAudioEnhancer& getCinematicEnhancer() { return cinematicEnhancer; }
     FXPresetManager& getPresetManager() { return presetManager; }
     GlobalUndoManager& getUndoManager() { return undoManager; }
+    VocalRenderCache& getVocalRenderCache() { return vocalRenderCache; }
+    RenderAheadScheduler& getRenderScheduler() { return renderScheduler; }
+    
+    /** Gain reduction slot of the enhancer's final limiter in each MeterBlock */
+    static constexpr int LIMITER_METER_STAGE = 0;
+    
+    /** Per-block levels of the master output, drained by the UI */
+    MeterQueue& getMeterQueue() { return meterQueue; }
+    
+    /** Stage timings and deadline overruns of processBlock */
+    RealtimeProfiler& getProfiler() { return profiler; }
+    
+    /** CPU budget and the quality tier processBlock currently runs at */
+    CPUGovernor& getGovernor() { return governor; }
+    
+    //==============================================================================
+    // Vocal rendering
+    
+    /**
+     * @brief Get the rendered audio of a vocal block, synthesizing on a cache miss
+     * 
+     * Not realtime-safe. Also suitable as the renderer of DragDropExport's offline renderer.
+     * @return nullptr if the block is not vocal or the vocal models are not ready
+     */
+    VocalRenderCache::RenderedAudio renderVocalBlock(const TimelineBlock& block);
+    
+    /**
+     * @brief Get the rendered audio of a vocal block at a given sample rate
+     */
+    VocalRenderCache::RenderedAudio renderVocalBlock(const TimelineBlock& block, double sampleRate);
+    
+    /**
+     * @brief Re-render the upcoming vocal blocks for playback
+     * 
+     * Call from the message thread after the BPM changes. Arrangement edits
+     * need no call: the render-ahead scheduler picks them up by itself.
+     */
+    void refreshVocalRenders();
+    
+    /** Waveform peaks of every block the render-ahead pipeline has rendered */
+    WaveformPeakCache& getWaveformPeaks() { return waveformPeaks; }
     
     //==============================================================================
     // Cinematic enhancement control
-    void setCinematicEnhancerEnabled(bool enabled) { cinematicEnhancerEnabled = enabled; }
+    void setCinematicEnhancerEnabled(bool enabled) { cinematicEnhancerEnabled = enabled; updateHostLatency(); }
     bool isCinematicEnhancerEnabled() const { return cinematicEnhancerEnabled; }
     
+    /**
+     * @brief Report the FX engine and enhancer latency to the host
+     * 
+     * Call after changing anything that adds delay, e.g. the enhancer's
+     * saturation oversampling.
+     */
+    void updateHostLatency();
+    
 private:
     //==============================================================================
+    RealtimeProfiler profiler; // declared first so it outlives everything recording into it
     OnnxEngine onnxEngine;
+    GPUAccelerationManager gpuManager; // configures onnxEngine's execution providers
     PatternEngine patternEngine;
     AIFXEngine aiFXEngine;
     CinematicAudioEnhancer cinematicEnhancer;
     FXPresetManager presetManager;
     GlobalUndoManager undoManager;
+    VocalRenderCache vocalRenderCache;
+    VocalSynthesizer vocalSynthesizer;
+    WaveformPeakCache waveformPeaks; // fed by renderScheduler's worker, so declared before it
+    RenderAheadScheduler renderScheduler; // renders upcoming blocks for playback
+    MeterQueue meterQueue;
+    LoudnessMeter outputLoudness;
     
     double currentSampleRate;
     int currentBlockSize;
@@ -86,8 +156,52 @@ private:
     // Cinematic enhancer enable flag
     bool cinematicEnhancerEnabled;
     
+    // Set between prepareToPlay() and releaseResources()
+    bool prepared;
+    
+    // Timeline section of the last restored state, decoded on first use;
+    // until then it is saved back exactly as it was loaded
+    juce::MemoryBlock pendingTimelineState;
+    std::atomic<bool> timelineStatePending { false };
+    juce::CriticalSection stateLock;
+    
+    // Roles that finished loading, applied on the message thread
+    juce::StringArray readyModelRoles;
+    juce::CriticalSection readyModelRolesLock;
+    
     // Audio buffers for track processing
-    std::array<juce::AudioBuffer<float>, 6> trackBuffers; // 6 tracks
+    static constexpr int NUM_TRACKS = 6;
+    std::array<juce::AudioBuffer<float>, NUM_TRACKS> trackBuffers; // 6 tracks
+    
+    // Tracks with less latency are delayed to line up with the slowest one
+    static constexpr int MAX_ALIGNMENT_DELAY = 16384;
+    using AlignmentDelay = juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None>;
+    std::array<AlignmentDelay, NUM_TRACKS> trackAlignment;
+    
+    // Runs independent tracks' FX chains concurrently
+    RealtimeWorkerPool trackWorkers;
+    
+    // Profiler ids of processBlock's own stages
+    struct ProfileStages
+    {
+        int transport = -1;
+        int routing = -1;
+        int fx = -1;        // group: the FX engine's track stages
+        int mix = -1;
+        int enhancer = -1;  // group: the enhancer's stages
+        int metering = -1;
+    };
+    
+    ProfileStages profileStages;
+    
+    // Steps quality down when processBlock nears its deadline
+    CPUGovernor governor;
+    QualityTier appliedQualityTier = QualityTier::Full;    // audio thread
+    
+    /**
+     * @brief Turn the levers of a quality tier (any thread; each change crossfades)
+     */
+    void applyQualityTier(QualityTier tier);
     
     /**
      * @brief Initialize models and presets
@@ -95,14 +209,33 @@ private:
     void initializeModelsAndPresets();
     
     /**
-     * @brief Process audio for all tracks
+     * @brief Decode the timeline of a restored state if nothing has used it yet
+     */
+    void loadPendingTimeline();
+    
+    /**
+     * @brief Restore a state saved as JSON by earlier versions
+     */
+    void setLegacyJSONState(const void* data, int sizeInBytes);
+    
+    /**
+     * @brief Route inputs into trackBuffers, run each track's FX chain and sum
+     * 
+     * The main input and rendered vocal lines feed the vocal track; the
+     * optional auxiliary input buses feed tracks 1-5, along with any block
+     * of theirs the render-ahead scheduler has ready.
      */
     void processAllTracks(juce::AudioBuffer<float>& buffer, int numSamples);
     
     /**
      * @brief Update transport info from DAW
      */
-    void updateTransportInfo();
+    void updateTransportInfo(int numSamples);
+    
+    /**
+     * @brief Re-prepare the effects and host latency for models that finished loading
+     */
+    void handleAsyncUpdate() override;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MAEVNAudioProcessor)
 };
@@ -4,10 +4,68 @@
  */
 
 #include "PresetPackManager.h"
+#include <map>
 
 namespace MAEVN
 {
 
+namespace
+{
+    constexpr int SCAN_STOP_TIMEOUT_MS = 4000;
+    constexpr int INDEX_CACHE_VERSION = 1;
+    
+    juce::var createIndexEntry(const PresetPackInfo& info, juce::int64 fileSize, juce::int64 modificationTime)
+    {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("path", info.file.getFullPathName());
+        entry->setProperty("size", fileSize);
+        entry->setProperty("modified", modificationTime);
+        
+        entry->setProperty("name", info.name);
+        entry->setProperty("author", info.author);
+        entry->setProperty("description", info.description);
+        entry->setProperty("version", info.version);
+        entry->setProperty("createdDate", info.createdDate.toMilliseconds());
+        entry->setProperty("modifiedDate", info.modifiedDate.toMilliseconds());
+        entry->setProperty("license", info.license);
+        entry->setProperty("website", info.website);
+        entry->setProperty("numPresets", info.numPresets);
+        entry->setProperty("numPatterns", info.numPatterns);
+        entry->setProperty("thumbnailPath", info.thumbnailPath);
+        
+        juce::Array<juce::var> tagsArray;
+        for (const auto& tag : info.tags)
+            tagsArray.add(tag);
+        entry->setProperty("tags", tagsArray);
+        
+        return juce::var(entry);
+    }
+    
+    PresetPackInfo readIndexEntry(const juce::var& entry)
+    {
+        PresetPackInfo info;
+        info.name = entry["name"].toString();
+        info.author = entry["author"].toString();
+        info.description = entry["description"].toString();
+        info.version = entry["version"].toString();
+        info.createdDate = juce::Time(static_cast<juce::int64>(entry["createdDate"]));
+        info.modifiedDate = juce::Time(static_cast<juce::int64>(entry["modifiedDate"]));
+        info.license = entry["license"].toString();
+        info.website = entry["website"].toString();
+        info.numPresets = entry["numPresets"];
+        info.numPatterns = entry["numPatterns"];
+        info.thumbnailPath = entry["thumbnailPath"].toString();
+        
+        if (auto* tagsArray = entry["tags"].getArray())
+        {
+            for (const auto& tag : *tagsArray)
+                info.tags.add(tag.toString());
+        }
+        
+        return info;
+    }
+}
+
 //==============================================================================
 // PresetPack Implementation
 //==============================================================================
@@ -309,7 +367,8 @@ bool PresetPack::validate() const
 //==============================================================================
 
 PresetPackManager::PresetPackManager(FXPresetManager* manager)
-    : presetManager(manager)
+    : juce::Thread("MAEVN Pack Scanner")
+    , presetManager(manager)
 {
     packsDirectory = getDefaultPacksDirectory();
     packsDirectory.createDirectory();
@@ -321,6 +380,8 @@ PresetPackManager::PresetPackManager(FXPresetManager* manager)
 
 PresetPackManager::~PresetPackManager()
 {
+    stopThread(SCAN_STOP_TIMEOUT_MS);
+    cancelPendingUpdate();
 }
 
 bool PresetPackManager::importPack(const juce::File& file, bool mergeWithExisting)
@@ -479,16 +540,12 @@ bool PresetPackManager::uninstallPack(const juce::String& packName)
 {
     const juce::ScopedLock sl(packLock);
     
-    // Find and remove pack file
-    juce::Array<juce::File> packFiles;
-    packsDirectory.findChildFiles(packFiles, juce::File::findFiles, false);
-    
-    for (const auto& file : packFiles)
+    // Find and remove pack file; the scanned info knows which file it is
+    for (const auto& info : installedPacks)
     {
-        PresetPackInfo info;
-        if (getPackInfo(file, info) && info.name == packName)
+        if (info.name == packName)
         {
-            if (file.deleteFile())
+            if (info.file.deleteFile())
             {
                 refreshInstalledPacks();
                 Logger::log(Logger::Level::Info, "Uninstalled pack: " + packName);
@@ -521,23 +578,100 @@ void PresetPackManager::removeListener(PresetPackListener* listener)
 
 void PresetPackManager::refreshInstalledPacks()
 {
-    const juce::ScopedLock sl(packLock);
+    // The scan checks for exit between files, so restarting is quick
+    stopThread(SCAN_STOP_TIMEOUT_MS);
     
-    installedPacks.clear();
+    scanDirectory = packsDirectory;
+    startThread(juce::Thread::Priority::low);
+}
+
+void PresetPackManager::run()
+{
+    const auto cacheFile = scanDirectory.getChildFile(INDEX_CACHE_FILE_NAME);
     
-    auto packFiles = scanForPacks(packsDirectory);
+    // Cached info by path; an entry holds while its file's size and modification time match
+    std::map<juce::String, juce::var> cachedEntries;
+    const auto cache = juce::JSON::parse(cacheFile);
     
-    for (const auto& path : packFiles)
+    if (static_cast<int>(cache["version"]) == INDEX_CACHE_VERSION)
     {
+        if (auto* entries = cache["packs"].getArray())
+        {
+            for (const auto& entry : *entries)
+                cachedEntries[entry["path"].toString()] = entry;
+        }
+    }
+    
+    std::vector<PresetPackInfo> packs;
+    juce::Array<juce::var> entries;
+    int numRead = 0;
+    
+    for (const auto& path : scanForPacks(scanDirectory))
+    {
+        if (threadShouldExit())
+            return;
+        
+        const juce::File file(path);
+        const auto fileSize = file.getSize();
+        const auto modificationTime = file.getLastModificationTime().toMilliseconds();
+        
         PresetPackInfo info;
-        if (getPackInfo(juce::File(path), info))
+        auto cached = cachedEntries.find(path);
+        
+        if (cached != cachedEntries.end()
+            && static_cast<juce::int64>(cached->second["size"]) == fileSize
+            && static_cast<juce::int64>(cached->second["modified"]) == modificationTime)
         {
-            installedPacks.push_back(info);
+            info = readIndexEntry(cached->second);
         }
+        else if (getPackInfo(file, info))
+        {
+            ++numRead;
+        }
+        else
+        {
+            continue;
+        }
+        
+        info.file = file;
+        entries.add(createIndexEntry(info, fileSize, modificationTime));
+        packs.push_back(info);
+    }
+    
+    // Rewrite the cache when packs were added, changed or removed
+    if (numRead > 0 || entries.size() != static_cast<int>(cachedEntries.size()))
+    {
+        auto* index = new juce::DynamicObject();
+        index->setProperty("version", INDEX_CACHE_VERSION);
+        index->setProperty("packs", entries);
+        
+        if (!cacheFile.replaceWithText(juce::JSON::toString(juce::var(index), true)))
+            Logger::log(Logger::Level::Warning, "Failed to write pack index: " + cacheFile.getFullPathName());
     }
     
-    Logger::log(Logger::Level::Info, "Found " + juce::String(static_cast<int>(installedPacks.size())) + 
-                " installed packs");
+    Logger::log(Logger::Level::Info, "Found " + juce::String(static_cast<int>(packs.size())) + 
+                " installed packs (" + juce::String(numRead) + " read from disk)");
+    
+    {
+        const juce::ScopedLock sl(scanLock);
+        scannedPacks = std::move(packs);
+    }
+    
+    triggerAsyncUpdate();
+}
+
+void PresetPackManager::handleAsyncUpdate()
+{
+    {
+        const juce::ScopedLock sl(scanLock);
+        installedPacks = std::move(scannedPacks);
+        scannedPacks.clear();
+    }
+    
+    for (auto* listener : listeners)
+    {
+        listener->onPacksScanned();
+    }
 }
 
 std::unique_ptr<PresetPack> PresetPackManager::createPackFromSession(const PresetPackInfo& info)
@@ -646,11 +780,16 @@ PresetPackBrowserComponent::PresetPackBrowserComponent(PresetPackManager* manage
     , packListBox("Pack List", this)
     , selectedPackIndex(-1)
 {
+    if (packManager != nullptr)
+        packManager->addListener(this);
+    
     setupUI();
 }
 
 PresetPackBrowserComponent::~PresetPackBrowserComponent()
 {
+    if (packManager != nullptr)
+        packManager->removeListener(this);
 }
 
 void PresetPackBrowserComponent::paint(juce::Graphics& g)
@@ -717,7 +856,9 @@ void PresetPackBrowserComponent::listBoxItemDoubleClicked(int row, const juce::M
     // Double-click to import/activate pack
     if (row >= 0 && row < static_cast<int>(displayedPacks.size()))
     {
-        // Future: Open pack details or install
+        // Scans only read pack info; the presets load now
+        if (packManager != nullptr && displayedPacks[row].file.existsAsFile())
+            packManager->importPack(displayedPacks[row].file, true);
     }
 }
 
@@ -725,18 +866,25 @@ void PresetPackBrowserComponent::refresh()
 {
     if (packManager != nullptr)
     {
+        // Show what is known now; onPacksScanned() brings the rescan's result
+        updateDisplayedPacks();
         packManager->refreshInstalledPacks();
-        displayedPacks.clear();
-        
-        for (const auto& info : packManager->getInstalledPacks())
-        {
-            displayedPacks.push_back(info);
-        }
-        
-        packListBox.updateContent();
     }
 }
 
+void PresetPackBrowserComponent::updateDisplayedPacks()
+{
+    displayedPacks.clear();
+    
+    for (const auto& info : packManager->getInstalledPacks())
+    {
+        displayedPacks.push_back(info);
+    }
+    
+    packListBox.updateContent();
+    repaint();
+}
+
 void PresetPackBrowserComponent::showImportDialog()
 {
     onImportClicked();
@@ -819,4 +967,25 @@ void PresetPackBrowserComponent::onRefreshClicked()
     refresh();
 }
 
+void PresetPackBrowserComponent::onPackImported(const PresetPackInfo& info)
+{
+}
+
+void PresetPackBrowserComponent::onPackExported(const PresetPackInfo& info)
+{
+}
+
+void PresetPackBrowserComponent::onPackImportFailed(const juce::String& error)
+{
+}
+
+void PresetPackBrowserComponent::onPackProgress(float progress, const juce::String& status)
+{
+}
+
+void PresetPackBrowserComponent::onPacksScanned()
+{
+    updateDisplayedPacks();
+}
+
 } // namespace MAEVN
@@ -4,6 +4,11 @@
  * 
  * This module provides functionality for creating, importing, and exporting
  * preset bundles that can be shared within the community.
+ * 
+ * Installed packs are found by a background scan. The scan keeps an index
+ * cache of every pack's info next to the packs, so unchanged files (same
+ * size and modification time) are not opened again; a pack's presets are
+ * only loaded once it is imported.
  */
 
 #pragma once
@@ -37,6 +42,7 @@ struct PresetPackInfo
     int numPresets;                 ///< Number of presets in pack
     int numPatterns;                ///< Number of sequencer patterns
     juce::String thumbnailPath;     ///< Path to thumbnail image
+    juce::File file;                ///< Pack file the info was read from (set by scans)
     
     PresetPackInfo()
         : version("1.0.0")
@@ -175,6 +181,11 @@ public:
      * @brief Called during import/export progress
      */
     virtual void onPackProgress(float progress, const juce::String& status) = 0;
+    
+    /**
+     * @brief Called on the message thread when a scan has updated the installed packs
+     */
+    virtual void onPacksScanned() {}
 };
 
 //==============================================================================
@@ -183,9 +194,14 @@ public:
  * 
  * Handles importing, exporting, and managing preset packs
  */
-class PresetPackManager
+class PresetPackManager : private juce::Thread,
+                          private juce::AsyncUpdater
 {
 public:
+    /** Name of the index cache file in the packs directory */
+    static constexpr const char* INDEX_CACHE_FILE_NAME = "PackIndex.cache";
+    
+
     PresetPackManager(FXPresetManager* presetManager);
     ~PresetPackManager();
     
@@ -267,10 +283,19 @@ public:
     void removeListener(PresetPackListener* listener);
     
     /**
-     * @brief Refresh list of installed packs
+     * @brief Rescan the packs directory on a background thread
+     * 
+     * Restarts a scan already in progress. getInstalledPacks() is updated
+     * on the message thread when the scan completes, followed by
+     * onPacksScanned() to the listeners.
      */
     void refreshInstalledPacks();
     
+    /**
+     * @brief Check whether a pack scan is in progress
+     */
+    bool isScanning() const { return isThreadRunning(); }
+    
     /**
      * @brief Create a pack from the current session
      * @param info Pack metadata
@@ -299,6 +324,14 @@ private:
     
     juce::CriticalSection packLock;
     
+    // Directory of the running scan and its result, waiting for the message thread
+    juce::File scanDirectory;
+    std::vector<PresetPackInfo> scannedPacks;
+    juce::CriticalSection scanLock;
+    
+    void run() override;
+    void handleAsyncUpdate() override;
+    
     void notifyPackImported(const PresetPackInfo& info);
     void notifyPackExported(const PresetPackInfo& info);
     void notifyPackImportFailed(const juce::String& error);
@@ -314,7 +347,8 @@ private:
  * @brief UI Component for browsing and managing preset packs
  */
 class PresetPackBrowserComponent : public juce::Component,
-                                    public juce::ListBoxModel
+                                    public juce::ListBoxModel,
+                                    private PresetPackListener
 {
 public:
     PresetPackBrowserComponent(PresetPackManager* manager);
@@ -362,6 +396,18 @@ private:
     void onExportClicked();
     void onRefreshClicked();
     
+    // PresetPackListener interface
+    void onPackImported(const PresetPackInfo& info) override;
+    void onPackExported(const PresetPackInfo& info) override;
+    void onPackImportFailed(const juce::String& error) override;
+    void onPackProgress(float progress, const juce::String& status) override;
+    void onPacksScanned() override;
+    
+    /**
+     * @brief Show the manager's current list of installed packs
+     */
+    void updateDisplayedPacks();
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetPackBrowserComponent)
 };
 
@@ -0,0 +1,441 @@
+/**
+ * @file RealtimeProfiler.cpp
+ * @brief Implementation of the realtime stage profiler and its view
+ */
+
+#include "RealtimeProfiler.h"
+#include <cmath>
+
+namespace MAEVN
+{
+
+namespace
+{
+    constexpr double P99_FRACTION = 0.99;
+    
+    void storeMax(std::atomic<juce::int64>& target, juce::int64 value) noexcept
+    {
+        auto current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+//==============================================================================
+RealtimeProfiler::RealtimeProfiler()
+    : secondsPerTick(1.0 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()))
+{
+    overrunHistory.reserve(MAX_OVERRUN_HISTORY);
+    
+    const int blockStage = registerStage("processBlock", true);
+    jassertquiet(blockStage == BLOCK_STAGE);
+}
+
+RealtimeProfiler::~RealtimeProfiler()
+{
+}
+
+int RealtimeProfiler::registerStage(const juce::String& name, bool isGroup)
+{
+    const juce::ScopedLock sl(namesLock);
+    
+    const int existing = stageNames.indexOf(name);
+    if (existing >= 0)
+        return existing;
+    
+    const int id = stageNames.size();
+    if (id >= MAX_STAGES)
+    {
+        Logger::log(Logger::Level::Warning, "Profiler stage limit reached, not timing: " + name);
+        return -1;
+    }
+    
+    stageNames.add(name);
+    stages[static_cast<size_t>(id)].isGroup = isGroup;
+    
+    // Published last, so readers never see a stage without its name
+    numStages.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+juce::String RealtimeProfiler::getStageName(int stageId) const
+{
+    const juce::ScopedLock sl(namesLock);
+    return stageNames[stageId];
+}
+
+//==============================================================================
+void RealtimeProfiler::beginBlock(int numSamples, double sampleRate) noexcept
+{
+    blockNumSamples = numSamples;
+    blockBudgetTicks = sampleRate > 0.0
+        ? static_cast<juce::int64>(numSamples / sampleRate / secondsPerTick)
+        : 0;
+    blockStartTicks = juce::Time::getHighResolutionTicks();
+}
+
+void RealtimeProfiler::endBlock() noexcept
+{
+    if (!isEnabled())
+        return;
+    
+    const auto elapsed = juce::Time::getHighResolutionTicks() - blockStartTicks;
+    addStageTime(BLOCK_STAGE, elapsed);
+    numBlocks.fetch_add(1, std::memory_order_relaxed);
+    
+    // Every stage's block time is cleared, whether or not this block overran
+    const int count = numStages.load(std::memory_order_acquire);
+    int worstStage = -1;
+    juce::int64 worstTicks = 0;
+    
+    for (int i = 0; i < count; ++i)
+    {
+        auto& stage = stages[static_cast<size_t>(i)];
+        const auto ticks = stage.blockTicks.exchange(0, std::memory_order_relaxed);
+        
+        if (!stage.isGroup && ticks > worstTicks)
+        {
+            worstStage = i;
+            worstTicks = ticks;
+        }
+    }
+    
+    if (blockBudgetTicks <= 0 || elapsed <= blockBudgetTicks)
+        return;
+    
+    numOverruns.fetch_add(1, std::memory_order_relaxed);
+    if (worstStage >= 0)
+        stages[static_cast<size_t>(worstStage)].overrunsCaused.fetch_add(1, std::memory_order_relaxed);
+    
+    Overrun overrun;
+    overrun.numSamples = blockNumSamples;
+    overrun.blockMicros = ticksToMicros(elapsed);
+    overrun.budgetMicros = ticksToMicros(blockBudgetTicks);
+    overrun.worstStage = worstStage;
+    overrun.worstStageMicros = ticksToMicros(worstTicks);
+    pushOverrun(overrun);
+}
+
+void RealtimeProfiler::addStageTime(int stageId, juce::int64 ticks) noexcept
+{
+    if (stageId < 0 || stageId >= MAX_STAGES)
+        return;
+    
+    auto& stage = stages[static_cast<size_t>(stageId)];
+    stage.buckets[static_cast<size_t>(getBucket(ticks))].fetch_add(1, std::memory_order_relaxed);
+    stage.totalTicks.fetch_add(ticks, std::memory_order_relaxed);
+    stage.blockTicks.fetch_add(ticks, std::memory_order_relaxed);
+    storeMax(stage.maxTicks, ticks);
+}
+
+int RealtimeProfiler::getBucket(juce::int64 ticks) const noexcept
+{
+    const auto nanos = static_cast<double>(ticks) * secondsPerTick * 1.0e9;
+    if (nanos < 1.0)
+        return 0;
+    
+    if (nanos >= static_cast<double>(1u << (NUM_BUCKETS - 2)))
+        return NUM_BUCKETS - 1;
+    
+    return juce::findHighestSetBit(static_cast<juce::uint32>(nanos)) + 1;
+}
+
+void RealtimeProfiler::pushOverrun(const Overrun& overrun) noexcept
+{
+    const juce::uint32 write = overrunWriteIndex.load(std::memory_order_relaxed);
+    
+    // Dropped while the editor is closed and nothing drains the ring
+    if (write - overrunReadIndex.load(std::memory_order_acquire) >= static_cast<juce::uint32>(OVERRUN_CAPACITY))
+        return;
+    
+    overrunRing[write & OVERRUN_MASK] = overrun;
+    overrunWriteIndex.store(write + 1, std::memory_order_release);
+}
+
+//==============================================================================
+int RealtimeProfiler::collectOverruns()
+{
+    const juce::uint32 write = overrunWriteIndex.load(std::memory_order_acquire);
+    juce::uint32 read = overrunReadIndex.load(std::memory_order_relaxed);
+    int count = 0;
+    
+    // The audio thread has no clock to spare; reports are stamped as they arrive
+    const auto now = juce::Time::getCurrentTime();
+    
+    for (; read != write; ++read, ++count)
+    {
+        auto overrun = overrunRing[read & OVERRUN_MASK];
+        overrun.time = now;
+        
+        if (static_cast<int>(overrunHistory.size()) >= MAX_OVERRUN_HISTORY)
+            overrunHistory.erase(overrunHistory.begin());
+        
+        overrunHistory.push_back(overrun);
+    }
+    
+    overrunReadIndex.store(read, std::memory_order_release);
+    return count;
+}
+
+std::vector<RealtimeProfiler::StageStats> RealtimeProfiler::getStageStats() const
+{
+    const int count = numStages.load(std::memory_order_acquire);
+    
+    std::vector<StageStats> result;
+    result.reserve(static_cast<size_t>(count));
+    
+    for (int i = 0; i < count; ++i)
+    {
+        const auto& stage = stages[static_cast<size_t>(i)];
+        
+        std::array<juce::int64, NUM_BUCKETS> buckets;
+        juce::int64 total = 0;
+        for (int b = 0; b < NUM_BUCKETS; ++b)
+        {
+            buckets[static_cast<size_t>(b)] = stage.buckets[static_cast<size_t>(b)].load(std::memory_order_relaxed);
+            total += buckets[static_cast<size_t>(b)];
+        }
+        
+        StageStats stats;
+        stats.name = getStageName(i);
+        stats.count = total;
+        stats.maxMicros = ticksToMicros(stage.maxTicks.load(std::memory_order_relaxed));
+        stats.overrunsCaused = stage.overrunsCaused.load(std::memory_order_relaxed);
+        
+        if (total > 0)
+        {
+            stats.meanMicros = ticksToMicros(stage.totalTicks.load(std::memory_order_relaxed)) / static_cast<double>(total);
+            
+            const auto target = static_cast<juce::int64>(std::ceil(static_cast<double>(total) * P99_FRACTION));
+            juce::int64 cumulative = 0;
+            int bucket = 0;
+            while (bucket < NUM_BUCKETS - 1 && (cumulative += buckets[static_cast<size_t>(bucket)]) < target)
+                ++bucket;
+            
+            // The bucket's upper edge, but never beyond the largest time seen
+            stats.p99Micros = juce::jmin(std::ldexp(1.0, bucket) * 1.0e-3, stats.maxMicros);
+        }
+        
+        result.push_back(stats);
+    }
+    
+    return result;
+}
+
+void RealtimeProfiler::reset()
+{
+    for (auto& stage : stages)
+    {
+        for (auto& bucket : stage.buckets)
+            bucket.store(0, std::memory_order_relaxed);
+        
+        stage.totalTicks.store(0, std::memory_order_relaxed);
+        stage.maxTicks.store(0, std::memory_order_relaxed);
+        stage.overrunsCaused.store(0, std::memory_order_relaxed);
+    }
+    
+    numBlocks.store(0, std::memory_order_relaxed);
+    numOverruns.store(0, std::memory_order_relaxed);
+    
+    collectOverruns();
+    overrunHistory.clear();
+}
+
+bool RealtimeProfiler::dumpToFile(const juce::File& file)
+{
+    collectOverruns();
+    
+    juce::Array<juce::var> stageList;
+    for (const auto& stats : getStageStats())
+    {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("name", stats.name);
+        entry->setProperty("count", stats.count);
+        entry->setProperty("meanMicros", stats.meanMicros);
+        entry->setProperty("p99Micros", stats.p99Micros);
+        entry->setProperty("maxMicros", stats.maxMicros);
+        entry->setProperty("overrunsCaused", stats.overrunsCaused);
+        stageList.add(juce::var(entry));
+    }
+    
+    juce::Array<juce::var> overrunList;
+    for (const auto& overrun : overrunHistory)
+    {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("time", overrun.time.toISO8601(true));
+        entry->setProperty("numSamples", overrun.numSamples);
+        entry->setProperty("blockMicros", overrun.blockMicros);
+        entry->setProperty("budgetMicros", overrun.budgetMicros);
+        entry->setProperty("worstStage", getStageName(overrun.worstStage));
+        entry->setProperty("worstStageMicros", overrun.worstStageMicros);
+        overrunList.add(juce::var(entry));
+    }
+    
+    auto* root = new juce::DynamicObject();
+    root->setProperty("blocks", getNumBlocks());
+    root->setProperty("overruns", getNumOverruns());
+    root->setProperty("stages", stageList);
+    root->setProperty("recentOverruns", overrunList);
+    
+    if (!file.replaceWithText(juce::JSON::toString(juce::var(root))))
+    {
+        Logger::log(Logger::Level::Error, "Failed to write profile: " + file.getFullPathName());
+        return false;
+    }
+    
+    Logger::log(Logger::Level::Info, "Profile written to " + file.getFullPathName());
+    return true;
+}
+
+//==============================================================================
+// RealtimeProfilerComponent Implementation
+//==============================================================================
+
+RealtimeProfilerComponent::RealtimeProfilerComponent(RealtimeProfiler* profiler)
+    : realtimeProfiler(profiler)
+{
+    setupUI();
+    startTimerHz(REFRESH_HZ);
+}
+
+RealtimeProfilerComponent::~RealtimeProfilerComponent()
+{
+    stopTimer();
+}
+
+void RealtimeProfilerComponent::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colour(30, 30, 35));
+    
+    g.setColour(juce::Colour(50, 50, 55));
+    g.drawRect(getLocalBounds(), 1);
+}
+
+void RealtimeProfilerComponent::resized()
+{
+    auto bounds = getLocalBounds().reduced(10);
+    
+    auto header = bounds.removeFromTop(30);
+    dumpButton.setBounds(header.removeFromRight(70).reduced(2));
+    resetButton.setBounds(header.removeFromRight(70).reduced(2));
+    titleLabel.setBounds(header);
+    
+    statusLabel.setBounds(bounds.removeFromTop(25));
+    bounds.removeFromTop(5);
+    
+    statsView.setBounds(bounds);
+}
+
+void RealtimeProfilerComponent::refresh()
+{
+    if (realtimeProfiler == nullptr)
+    {
+        statusLabel.setText("Status: No Profiler", juce::dontSendNotification);
+        return;
+    }
+    
+    realtimeProfiler->collectOverruns();
+    
+    const auto overruns = realtimeProfiler->getNumOverruns();
+    statusLabel.setText("Blocks: " + juce::String(realtimeProfiler->getNumBlocks())
+                        + " | Overruns: " + juce::String(overruns),
+                        juce::dontSendNotification);
+    statusLabel.setColour(juce::Label::textColourId,
+                          overruns > 0 ? juce::Colours::orange : juce::Colours::limegreen);
+    
+    juce::String text;
+    text << juce::String("Stage").paddedRight(' ', 24) << "     mean      p99      max  over\n";
+    
+    for (const auto& stats : realtimeProfiler->getStageStats())
+    {
+        if (stats.count == 0)
+            continue;
+        
+        text << stats.name.substring(0, 23).paddedRight(' ', 24)
+             << juce::String(stats.meanMicros, 1).paddedLeft(' ', 9)
+             << juce::String(stats.p99Micros, 1).paddedLeft(' ', 9)
+             << juce::String(stats.maxMicros, 1).paddedLeft(' ', 9)
+             << juce::String(stats.overrunsCaused).paddedLeft(' ', 6) << "\n";
+    }
+    
+    const auto& recent = realtimeProfiler->getRecentOverruns();
+    if (!recent.empty())
+    {
+        text << "\nRecent overruns (us)\n";
+        
+        // Newest first
+        for (auto it = recent.rbegin(); it != recent.rend(); ++it)
+        {
+            text << it->time.toString(false, true, true, true) << "  "
+                 << juce::String(it->blockMicros, 0) << " / " << juce::String(it->budgetMicros, 0)
+                 << "  " << realtimeProfiler->getStageName(it->worstStage)
+                 << " " << juce::String(it->worstStageMicros, 0) << "\n";
+        }
+    }
+    
+    if (text != statsView.getText())
+        statsView.setText(text, false);
+}
+
+void RealtimeProfilerComponent::setupUI()
+{
+    addAndMakeVisible(titleLabel);
+    titleLabel.setText("Realtime Profiler", juce::dontSendNotification);
+    titleLabel.setFont(juce::Font(18.0f, juce::Font::bold));
+    titleLabel.setColour(juce::Label::textColourId, juce::Colours::white);
+    
+    addAndMakeVisible(statusLabel);
+    statusLabel.setColour(juce::Label::textColourId, juce::Colours::lightgrey);
+    
+    addAndMakeVisible(statsView);
+    statsView.setMultiLine(true);
+    statsView.setReadOnly(true);
+    statsView.setScrollbarsShown(true);
+    statsView.setCaretVisible(false);
+    statsView.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
+    statsView.setColour(juce::TextEditor::backgroundColourId, juce::Colour(20, 20, 25));
+    statsView.setColour(juce::TextEditor::textColourId, juce::Colours::lightgrey);
+    
+    addAndMakeVisible(resetButton);
+    resetButton.setButtonText("Reset");
+    resetButton.onClick = [this]
+    {
+        if (realtimeProfiler != nullptr)
+            realtimeProfiler->reset();
+        refresh();
+    };
+    
+    addAndMakeVisible(dumpButton);
+    dumpButton.setButtonText("Dump...");
+    dumpButton.onClick = [this] { onDumpClicked(); };
+    
+    refresh();
+}
+
+void RealtimeProfilerComponent::timerCallback()
+{
+    refresh();
+}
+
+void RealtimeProfilerComponent::onDumpClicked()
+{
+    if (realtimeProfiler == nullptr)
+        return;
+    
+    const auto defaultFile = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                                 .getChildFile("MAEVN_profile.json");
+    
+    fileChooser = std::make_unique<juce::FileChooser>("Save Profile", defaultFile, "*.json");
+    fileChooser->launchAsync(juce::FileBrowserComponent::saveMode
+                                 | juce::FileBrowserComponent::canSelectFiles
+                                 | juce::FileBrowserComponent::warnAboutOverwriting,
+                             [this](const juce::FileChooser& chooser)
+                             {
+                                 const auto file = chooser.getResult();
+                                 if (file != juce::File() && realtimeProfiler != nullptr)
+                                     realtimeProfiler->dumpToFile(file);
+                             });
+}
+
+} // namespace MAEVN
@@ -0,0 +1,294 @@
+/**
+ * @file RealtimeProfiler.h
+ * @brief Per-stage timing and deadline-overrun detection for the audio thread
+ *
+ * Stages are registered by name off the audio thread and timed with a
+ * ScopedTimer. Every sample lands in a fixed log2 histogram of atomic
+ * counters, so recording costs two clock reads and a handful of relaxed
+ * atomic adds and never allocates or locks. The processor brackets each
+ * processBlock with beginBlock()/endBlock(); a block that takes longer than
+ * its numSamples / sampleRate budget is pushed, with the stage that took
+ * longest in it, into a single-producer, single-consumer ring that the
+ * editor drains.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Lock-free stage histograms and a ring of overrun reports
+ *
+ * registerStage(), collectOverruns() and the statistics getters are for the
+ * message thread; beginBlock()/endBlock() for the audio thread only. Stage
+ * times may be recorded from any thread, including the realtime workers.
+ */
+class RealtimeProfiler
+{
+public:
+    static constexpr int MAX_STAGES = 64;
+    static constexpr int NUM_BUCKETS = 32;      // bucket b holds times below 2^b ns
+    static constexpr int OVERRUN_CAPACITY = 64;
+    static constexpr int MAX_OVERRUN_HISTORY = 100;
+    static constexpr int BLOCK_STAGE = 0;       // the whole processBlock
+    
+    //==========================================================================
+    /**
+     * @brief Summary of one stage's histogram
+     */
+    struct StageStats
+    {
+        juce::String name;
+        juce::int64 count = 0;
+        double meanMicros = 0.0;
+        double p99Micros = 0.0;             // upper edge of the 99th percentile bucket
+        double maxMicros = 0.0;
+        juce::int64 overrunsCaused = 0;     // overrun blocks this stage took longest in
+    };
+    
+    /**
+     * @brief One block that missed its deadline
+     */
+    struct Overrun
+    {
+        juce::Time time;
+        int numSamples = 0;
+        double blockMicros = 0.0;
+        double budgetMicros = 0.0;
+        int worstStage = -1;
+        double worstStageMicros = 0.0;
+    };
+    
+    //==========================================================================
+    /**
+     * @brief Times a scope into a stage; does nothing for a null profiler or a stage id of -1
+     */
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(RealtimeProfiler* profilerToUse, int stageId) noexcept
+            : profiler(profilerToUse != nullptr && profilerToUse->isEnabled() ? profilerToUse : nullptr)
+            , stage(stageId)
+            , startTicks(profiler != nullptr ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+        
+        ~ScopedTimer() noexcept
+        {
+            if (profiler != nullptr)
+                profiler->addStageTime(stage, juce::Time::getHighResolutionTicks() - startTicks);
+        }
+        
+        /**
+         * @brief Close the current stage and go on timing the next one
+         */
+        void restart(int nextStageId) noexcept
+        {
+            if (profiler != nullptr)
+            {
+                const auto now = juce::Time::getHighResolutionTicks();
+                profiler->addStageTime(stage, now - startTicks);
+                startTicks = now;
+            }
+            
+            stage = nextStageId;
+        }
+    
+    private:
+        RealtimeProfiler* profiler;
+        int stage;
+        juce::int64 startTicks;
+        
+        JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+    };
+    
+    /**
+     * @brief Locks a CriticalSection, recording into a stage how long it had to wait
+     *
+     * Uncontended entries only cost a tryEnter() and are not recorded, so the
+     * stage's count is the number of times the lock was found held.
+     */
+    class ScopedProfiledLock
+    {
+    public:
+        ScopedProfiledLock(const juce::CriticalSection& lockToUse, RealtimeProfiler* profiler, int stageId) noexcept
+            : lock(lockToUse)
+        {
+            if (lock.tryEnter())
+                return;
+            
+            const ScopedTimer timer(profiler, stageId);
+            lock.enter();
+        }
+        
+        ~ScopedProfiledLock() noexcept
+        {
+            lock.exit();
+        }
+    
+    private:
+        const juce::CriticalSection& lock;
+        
+        JUCE_DECLARE_NON_COPYABLE(ScopedProfiledLock)
+    };
+    
+    //==========================================================================
+    RealtimeProfiler();
+    ~RealtimeProfiler();
+    
+    /**
+     * @brief Turn recording on or off (on by default)
+     */
+    void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Get the id of a stage, registering it if it is new
+     *
+     * A group stage encloses other stages and is never named as the worst
+     * stage of an overrun.
+     *
+     * @return Stage id, or -1 once MAX_STAGES stages exist
+     */
+    int registerStage(const juce::String& name, bool isGroup = false);
+    
+    //==========================================================================
+    /**
+     * @brief Start timing a block (audio thread)
+     */
+    void beginBlock(int numSamples, double sampleRate) noexcept;
+    
+    /**
+     * @brief Finish the block, reporting it if it overran its budget (audio thread)
+     */
+    void endBlock() noexcept;
+    
+    /**
+     * @brief Record one sample of a stage's time
+     */
+    void addStageTime(int stageId, juce::int64 ticks) noexcept;
+    
+    //==========================================================================
+    /**
+     * @brief Move waiting overrun reports into the history (message thread)
+     * @return Number of reports moved
+     */
+    int collectOverruns();
+    
+    /**
+     * @brief Most recent overruns, newest last (message thread, after collectOverruns)
+     */
+    const std::vector<Overrun>& getRecentOverruns() const { return overrunHistory; }
+    
+    std::vector<StageStats> getStageStats() const;
+    juce::String getStageName(int stageId) const;
+    
+    juce::int64 getNumBlocks() const { return numBlocks.load(std::memory_order_relaxed); }
+    juce::int64 getNumOverruns() const { return numOverruns.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Clear every histogram and the overrun history
+     *
+     * Counters are zeroed while the audio thread may still be adding to
+     * them, so the first block after a reset can be partly counted.
+     */
+    void reset();
+    
+    /**
+     * @brief Write the stage statistics and recent overruns as JSON
+     */
+    bool dumpToFile(const juce::File& file);
+
+private:
+    struct Stage
+    {
+        std::array<std::atomic<juce::int64>, NUM_BUCKETS> buckets {};
+        std::atomic<juce::int64> totalTicks { 0 };
+        std::atomic<juce::int64> maxTicks { 0 };
+        std::atomic<juce::int64> blockTicks { 0 };     // time spent in the current block
+        std::atomic<juce::int64> overrunsCaused { 0 };
+        bool isGroup = false;
+    };
+    
+    static constexpr juce::uint32 OVERRUN_MASK = OVERRUN_CAPACITY - 1;
+    static_assert((OVERRUN_CAPACITY & OVERRUN_MASK) == 0, "OVERRUN_CAPACITY must be a power of two");
+    
+    std::atomic<bool> enabled { true };
+    const double secondsPerTick;
+    
+    std::array<Stage, MAX_STAGES> stages;
+    std::atomic<int> numStages { 0 };
+    
+    juce::CriticalSection namesLock;
+    juce::StringArray stageNames;       // guarded by namesLock
+    
+    // Audio thread only
+    juce::int64 blockStartTicks = 0;
+    juce::int64 blockBudgetTicks = 0;
+    int blockNumSamples = 0;
+    
+    std::atomic<juce::int64> numBlocks { 0 };
+    std::atomic<juce::int64> numOverruns { 0 };
+    
+    std::array<Overrun, OVERRUN_CAPACITY> overrunRing;
+    std::atomic<juce::uint32> overrunWriteIndex { 0 };
+    std::atomic<juce::uint32> overrunReadIndex { 0 };
+    
+    std::vector<Overrun> overrunHistory;    // message thread
+    
+    double ticksToMicros(juce::int64 ticks) const { return static_cast<double>(ticks) * secondsPerTick * 1.0e6; }
+    int getBucket(juce::int64 ticks) const noexcept;
+    void pushOverrun(const Overrun& overrun) noexcept;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeProfiler)
+};
+
+//==============================================================================
+/**
+ * @brief Live view of a RealtimeProfiler with reset and dump-to-file
+ */
+class RealtimeProfilerComponent : public juce::Component,
+                                  private juce::Timer
+{
+public:
+    static constexpr int REFRESH_HZ = 4;
+    
+    RealtimeProfilerComponent(RealtimeProfiler* profiler);
+    ~RealtimeProfilerComponent() override;
+    
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    
+    /**
+     * @brief Refresh display
+     */
+    void refresh();
+
+private:
+    RealtimeProfiler* realtimeProfiler;
+    
+    juce::Label titleLabel;
+    juce::Label statusLabel;
+    juce::TextEditor statsView;
+    
+    juce::TextButton resetButton;
+    juce::TextButton dumpButton;
+    
+    std::unique_ptr<juce::FileChooser> fileChooser;
+    
+    void setupUI();
+    void timerCallback() override;
+    void onDumpClicked();
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeProfilerComponent)
+};
+
+} // namespace MAEVN
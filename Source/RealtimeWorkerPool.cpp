@@ -0,0 +1,210 @@
+/**
+ * @file RealtimeWorkerPool.cpp
+ * @brief Implementation of the realtime fork/join pool
+ */
+
+#include "RealtimeWorkerPool.h"
+#include <thread>
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+namespace MAEVN
+{
+
+namespace
+{
+    // Roughly 50-100 us of spinning before a worker starts yielding
+    constexpr int WORKER_SPIN_COUNT = 2000;
+    
+    // Longer than any block period, so workers stay awake while the host plays
+    constexpr juce::uint32 WORKER_IDLE_MS = 50;
+    
+    // How often a sleeping worker looks for a new block
+    constexpr int WORKER_SLEEP_POLL_MS = 5;
+    
+    constexpr int MAX_WORKERS = 4;
+}
+
+//==============================================================================
+/**
+ * @brief Worker thread: spins, then yields, for new generations; sleeps
+ * and polls once the host has stopped calling back
+ */
+class RealtimeWorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker(RealtimeWorkerPool& owner, int index)
+        : juce::Thread("MAEVN RT Worker " + juce::String(index))
+        , pool(owner)
+    {
+    }
+    
+    void stopWorker()
+    {
+        stopThread(1000);
+    }
+    
+    void run() override
+    {
+        // Match the host audio thread's denormal handling
+        juce::ScopedNoDenormals noDenormals;
+        
+        auto seenGeneration = getGeneration(pool.workState.load(std::memory_order_acquire));
+        auto lastWorkMs = juce::Time::getMillisecondCounter();
+        int spins = 0;
+        
+        while (!threadShouldExit())
+        {
+            const auto generation = getGeneration(pool.workState.load(std::memory_order_acquire));
+            
+            if (generation != seenGeneration)
+            {
+                seenGeneration = generation;
+                spins = 0;
+                pool.executeJobs(generation);
+                lastWorkMs = juce::Time::getMillisecondCounter();
+                continue;
+            }
+            
+            if (spins < WORKER_SPIN_COUNT)
+            {
+                ++spins;
+                pause();
+                continue;
+            }
+            
+            // Between blocks: give the core away without going to sleep
+            if (juce::Time::getMillisecondCounter() - lastWorkMs < WORKER_IDLE_MS)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            
+            // The host stopped calling back; run() does the jobs itself until we notice it again
+            wait(WORKER_SLEEP_POLL_MS);
+        }
+    }
+
+private:
+    RealtimeWorkerPool& pool;
+};
+
+//==============================================================================
+RealtimeWorkerPool::RealtimeWorkerPool()
+{
+}
+
+RealtimeWorkerPool::~RealtimeWorkerPool()
+{
+    stop();
+}
+
+int RealtimeWorkerPool::getDefaultNumWorkers()
+{
+    return juce::jlimit(0, MAX_WORKERS, juce::SystemStats::getNumPhysicalCpus() - 1);
+}
+
+void RealtimeWorkerPool::start(int numWorkers)
+{
+    stop();
+    
+    numWorkers = juce::jlimit(0, MAX_WORKERS, numWorkers);
+    const int numCpus = juce::SystemStats::getNumCpus();
+    
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto worker = std::make_unique<Worker>(*this, i);
+        
+        // Pin each worker to its own core, leaving core 0 to the host
+        if (numCpus > 1 && numCpus <= 32)
+            worker->setAffinityMask(1u << static_cast<juce::uint32>(1 + i % (numCpus - 1)));
+        
+        if (!worker->startRealtimeThread(juce::Thread::RealtimeOptions{}))
+        {
+            Logger::log(Logger::Level::Warning, "Realtime priority unavailable for worker " + juce::String(i));
+            worker->startThread(juce::Thread::Priority::highest);
+        }
+        
+        workers.push_back(std::move(worker));
+    }
+    
+    Logger::log(Logger::Level::Info, "Realtime worker pool started with " + juce::String(numWorkers) + " workers");
+}
+
+void RealtimeWorkerPool::stop()
+{
+    for (auto& worker : workers)
+        worker->stopWorker();
+    
+    workers.clear();
+}
+
+void RealtimeWorkerPool::run(int numJobs, JobFunction function, void* context)
+{
+    if (numJobs <= 0 || function == nullptr)
+        return;
+    
+    if (workers.empty() || numJobs == 1)
+    {
+        for (int job = 0; job < numJobs; ++job)
+            function(context, job);
+        return;
+    }
+    
+    const auto generation = getGeneration(workState.load(std::memory_order_relaxed)) + 1;
+    
+    auto& slot = slots[generation & 1];
+    slot.function.store(function, std::memory_order_relaxed);
+    slot.context.store(context, std::memory_order_relaxed);
+    slot.numJobs.store(numJobs, std::memory_order_relaxed);
+    remainingJobs.store(numJobs, std::memory_order_relaxed);
+    
+    // Fork: publishing the new generation releases the slot to the workers.
+    // Sleeping workers are not woken; whatever they leave is claimed here.
+    workState.store(static_cast<juce::uint64>(generation) << 32);
+    
+    executeJobs(generation);
+    
+    // Join: only jobs already claimed by awake workers are waited for
+    while (remainingJobs.load(std::memory_order_acquire) > 0)
+        pause();
+}
+
+void RealtimeWorkerPool::executeJobs(juce::uint32 generation)
+{
+    const auto& slot = slots[generation & 1];
+    auto state = workState.load(std::memory_order_acquire);
+    
+    for (;;)
+    {
+        // Read before claiming so a successful claim always matches this slot
+        const auto numJobs = static_cast<juce::uint32>(slot.numJobs.load(std::memory_order_relaxed));
+        const auto function = slot.function.load(std::memory_order_relaxed);
+        auto* context = slot.context.load(std::memory_order_relaxed);
+        
+        if (getGeneration(state) != generation || getJobIndex(state) >= numJobs)
+            return;
+        
+        if (workState.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel))
+        {
+            function(context, static_cast<int>(getJobIndex(state)));
+            remainingJobs.fetch_sub(1, std::memory_order_release);
+            state = workState.load(std::memory_order_acquire);
+        }
+    }
+}
+
+void RealtimeWorkerPool::pause()
+{
+   #if JUCE_INTEL
+    _mm_pause();
+   #elif JUCE_ARM && (JUCE_GCC || JUCE_CLANG)
+    __asm__ __volatile__ ("yield");
+   #else
+    std::this_thread::yield();
+   #endif
+}
+
+} // namespace MAEVN
@@ -0,0 +1,103 @@
+/**
+ * @file RealtimeWorkerPool.h
+ * @brief Small pool of pinned, realtime-priority threads for per-block fork/join
+ *
+ * The audio thread hands a fixed number of independent jobs (e.g. one per
+ * track) to the pool, takes a share of them itself and returns once all
+ * have run. Claiming and joining are lock-free and the audio thread never
+ * wakes a worker: workers spin, then yield, for a while after each block,
+ * and once the host stops calling back they sleep and poll for work. Jobs
+ * no awake worker claims are run by the calling thread.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Fork/join pool driven from the audio thread
+ */
+class RealtimeWorkerPool
+{
+public:
+    /** Job entry point: (context, jobIndex). Must not lock or allocate. */
+    using JobFunction = void (*)(void*, int);
+    
+    RealtimeWorkerPool();
+    ~RealtimeWorkerPool();
+    
+    /**
+     * @brief Start the worker threads (call outside the audio callback)
+     * @param numWorkers Threads besides the calling thread (0 = run inline)
+     */
+    void start(int numWorkers);
+    
+    /**
+     * @brief Stop and join the worker threads
+     */
+    void stop();
+    
+    /**
+     * @brief Get the number of running worker threads
+     */
+    int getNumWorkers() const { return static_cast<int>(workers.size()); }
+    
+    /**
+     * @brief Suggested worker count for this machine (physical cores - 1, max 4)
+     */
+    static int getDefaultNumWorkers();
+    
+    /**
+     * @brief Run jobs [0, numJobs) across the pool and the calling thread
+     *
+     * Realtime safe: never locks or signals. Returns after every job has
+     * finished. Must only be called from one thread at a time.
+     */
+    void run(int numJobs, JobFunction function, void* context);
+
+private:
+    class Worker;
+    
+    // Jobs are published in one of two slots so a worker still reading the
+    // previous block's slot can never see the next block's parameters
+    struct JobSlot
+    {
+        std::atomic<JobFunction> function { nullptr };
+        std::atomic<void*> context { nullptr };
+        std::atomic<int> numJobs { 0 };
+    };
+    
+    std::array<JobSlot, 2> slots;
+    
+    // High 32 bits: generation, low 32 bits: next job index
+    std::atomic<juce::uint64> workState { 0 };
+    std::atomic<int> remainingJobs { 0 };
+    
+    std::vector<std::unique_ptr<Worker>> workers;
+    
+    /**
+     * @brief Claim and run jobs of a generation until none are left
+     */
+    void executeJobs(juce::uint32 generation);
+    
+    static juce::uint32 getGeneration(juce::uint64 state) { return static_cast<juce::uint32>(state >> 32); }
+    static juce::uint32 getJobIndex(juce::uint64 state) { return static_cast<juce::uint32>(state); }
+    
+    /**
+     * @brief Spin-wait hint to the CPU
+     */
+    static void pause();
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeWorkerPool)
+};
+
+} // namespace MAEVN
@@ -0,0 +1,263 @@
+/**
+ * @file RenderAheadScheduler.cpp
+ * @brief Implementation of the background render-ahead scheduler
+ */
+
+#include "RenderAheadScheduler.h"
+#include <algorithm>
+
+namespace MAEVN
+{
+
+//==============================================================================
+bool ReadyClips::hasAudio(int trackIndex, double start, double end) const
+{
+    return std::any_of(clips.begin(), clips.end(), [&](const Clip& clip)
+    {
+        return clip.block.trackIndex == trackIndex && clip.block.startTime < end
+               && clip.block.startTime + clip.audio->getNumSamples() / sampleRate > start;
+    });
+}
+
+void ReadyClips::mixInto(juce::AudioBuffer<float>& buffer, int trackIndex, double position, int numSamples) const
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), 2);
+    
+    for (const auto& clip : clips)
+    {
+        if (clip.block.trackIndex != trackIndex)
+            continue;
+        
+        const auto clipLength = static_cast<juce::int64>(clip.audio->getNumSamples());
+        const auto offset = static_cast<juce::int64>(std::llround((position - clip.block.startTime) * sampleRate));
+        
+        if (offset + numSamples <= 0 || offset >= clipLength)
+            continue;
+        
+        const int destStart = static_cast<int>(juce::jmax<juce::int64>(0, -offset));
+        const int srcStart = static_cast<int>(juce::jmax<juce::int64>(0, offset));
+        const int count = static_cast<int>(juce::jmin<juce::int64>(numSamples - destStart, clipLength - srcStart));
+        
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            buffer.addFrom(ch, destStart, *clip.audio,
+                           juce::jmin(ch, clip.audio->getNumChannels() - 1), srcStart, count);
+        }
+    }
+}
+
+//==============================================================================
+RenderAheadScheduler::RenderAheadScheduler(PatternEngine& engine)
+    : juce::Thread("Render Ahead")
+    , patternEngine(engine)
+    , lookaheadSeconds(DEFAULT_LOOKAHEAD_SECONDS)
+    , renderSampleRate(0.0)
+    , generation(0)
+    , playheadPosition(0.0)
+    , expectedPosition(0.0)
+    , plannedGeneration(0)
+    , numPendingJobs(0)
+{
+}
+
+RenderAheadScheduler::~RenderAheadScheduler()
+{
+    stop();
+}
+
+void RenderAheadScheduler::setRenderer(BlockRenderer newRenderer)
+{
+    jassert(!isThreadRunning());
+    renderer = std::move(newRenderer);
+}
+
+void RenderAheadScheduler::start(double sampleRate)
+{
+    stop();
+    
+    // Nothing renders while stopped, so the worker's state can be touched here
+    if (sampleRate != renderSampleRate.load())
+    {
+        renderSampleRate.store(sampleRate);
+        ready.clear();
+        unrenderable.clear();
+        publishReadyClips();
+    }
+    
+    startThread(juce::Thread::Priority::low);
+}
+
+void RenderAheadScheduler::stop()
+{
+    signalThreadShouldExit();
+    planNeeded.signal();
+    
+    // A render cannot be interrupted; killing the thread would leak the model's state
+    stopThread(-1);
+}
+
+void RenderAheadScheduler::setLookahead(double seconds)
+{
+    lookaheadSeconds.store(juce::jmax(0.0, seconds));
+    planNeeded.signal();
+}
+
+void RenderAheadScheduler::invalidate()
+{
+    generation.fetch_add(1);
+    planNeeded.signal();
+}
+
+//==============================================================================
+void RenderAheadScheduler::updatePlayhead(double position, double blockSeconds)
+{
+    const bool seeked = std::abs(position - expectedPosition) > SEEK_THRESHOLD_SECONDS;
+    expectedPosition = position + blockSeconds;
+    playheadPosition.store(position, std::memory_order_relaxed);
+    
+    // The idle worker re-plans for the new position within SEEK_POLL_MS
+    if (seeked)
+        seekPending.store(true, std::memory_order_relaxed);
+}
+
+const ReadyClips* RenderAheadScheduler::acquireReadyClips()
+{
+    readyClips.acquireLatest();
+    return readyClips.getAcquired();
+}
+
+//==============================================================================
+void RenderAheadScheduler::run()
+{
+    while (!threadShouldExit())
+    {
+        seekPending.store(false, std::memory_order_relaxed);
+        plan(playheadPosition.load(std::memory_order_relaxed));
+        
+        if (jobs.empty() || !renderer)
+        {
+            for (int waited = 0; waited < IDLE_WAIT_MS && !threadShouldExit(); waited += SEEK_POLL_MS)
+            {
+                if (seekPending.load(std::memory_order_relaxed) || planNeeded.wait(SEEK_POLL_MS))
+                    break;
+            }
+            
+            continue;
+        }
+        
+        // Only the nearest job: a seek or edit during the render re-plans the rest
+        const Job job = jobs.front();
+        const juce::uint32 jobGeneration = generation.load();
+        auto audio = renderer(job.block, renderSampleRate.load());
+        
+        if (generation.load() != jobGeneration)
+            continue;
+        
+        if (audio == nullptr)
+        {
+            unrenderable.push_back(job.block);
+            continue;
+        }
+        
+        ready.push_back({ job.block, std::move(audio) });
+        publishReadyClips();
+    }
+}
+
+void RenderAheadScheduler::plan(double playhead)
+{
+    bool readyChanged = false;
+    
+    const juce::uint32 currentGeneration = generation.load();
+    if (currentGeneration != plannedGeneration)
+    {
+        plannedGeneration = currentGeneration;
+        readyChanged = !ready.empty();
+        ready.clear();
+        unrenderable.clear();
+    }
+    
+    const double rangeEnd = playhead + lookaheadSeconds.load();
+    const auto upcoming = patternEngine.getBlocksInRange(playhead, rangeEnd);
+    const auto isUpcoming = [&upcoming](const TimelineBlock& block)
+    {
+        return std::any_of(upcoming.begin(), upcoming.end(),
+                           [&block](const TimelineBlock& other) { return isSameBlock(block, other); });
+    };
+    
+    // mixInto() plays a clip's whole render, which may outlast its block
+    const double sampleRate = renderSampleRate.load();
+    const auto isSounding = [playhead, sampleRate](const ReadyClips::Clip& clip)
+    {
+        return clip.block.startTime + clip.audio->getNumSamples() / sampleRate > playhead;
+    };
+    
+    double soundingStart = playhead;
+    for (const auto& clip : ready)
+    {
+        if (isSounding(clip))
+            soundingStart = juce::jmin(soundingStart, clip.block.startTime);
+    }
+    
+    const auto current = soundingStart < playhead ? patternEngine.getBlocksInRange(soundingStart, rangeEnd) : upcoming;
+    const auto isCurrent = [&current](const TimelineBlock& block)
+    {
+        return std::any_of(current.begin(), current.end(),
+                           [&block](const TimelineBlock& other) { return isSameBlock(block, other); });
+    };
+    
+    // Clips of blocks that were edited or removed, or whose audio has played out, are dropped
+    const auto numReady = ready.size();
+    ready.erase(std::remove_if(ready.begin(), ready.end(),
+                               [&](const ReadyClips::Clip& clip) { return !isSounding(clip) || !isCurrent(clip.block); }),
+                ready.end());
+    readyChanged = readyChanged || ready.size() != numReady;
+    
+    unrenderable.erase(std::remove_if(unrenderable.begin(), unrenderable.end(),
+                                      [&isUpcoming](const TimelineBlock& block) { return !isUpcoming(block); }),
+                       unrenderable.end());
+    
+    jobs.clear();
+    for (const auto& block : upcoming)
+    {
+        const auto matches = [&block](const TimelineBlock& other) { return isSameBlock(block, other); };
+        
+        if (std::any_of(ready.begin(), ready.end(), [&matches](const ReadyClips::Clip& clip) { return matches(clip.block); })
+            || std::any_of(unrenderable.begin(), unrenderable.end(), matches))
+            continue;
+        
+        jobs.push_back({ block, juce::jmax(0.0, block.startTime - playhead) });
+    }
+    
+    // Nearest deadline first; blocks already playing come first of all
+    std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.deadline < b.deadline; });
+    numPendingJobs.store(static_cast<int>(jobs.size()));
+    
+    if (readyChanged)
+        publishReadyClips();
+}
+
+void RenderAheadScheduler::publishReadyClips()
+{
+    auto clips = std::make_unique<ReadyClips>();
+    clips->clips = ready;
+    clips->sampleRate = renderSampleRate.load();
+    
+    readyStorage.push_back(std::move(clips));
+    const ReadyClips* retired = readyClips.publish(readyStorage.back().get());
+    
+    // The set displaced by this publish can no longer reach the audio thread;
+    // its audio is released here, off the audio thread
+    readyStorage.erase(std::remove_if(readyStorage.begin(), readyStorage.end(),
+                                      [retired](const std::unique_ptr<ReadyClips>& set)
+                                      { return set.get() == retired; }),
+                       readyStorage.end());
+}
+
+bool RenderAheadScheduler::isSameBlock(const TimelineBlock& a, const TimelineBlock& b)
+{
+    return a.type == b.type && a.trackIndex == b.trackIndex && a.startTime == b.startTime
+           && a.duration == b.duration && a.content == b.content;
+}
+
+} // namespace MAEVN
@@ -0,0 +1,199 @@
+/**
+ * @file RenderAheadScheduler.h
+ * @brief Renders upcoming generative blocks in the background, nearest first
+ *
+ * Generative blocks (vocal lines through the TTS and vocoder models, and
+ * any other block type a renderer can synthesize) are far too slow to
+ * render when the playhead reaches them. The scheduler follows the
+ * playhead reported by the audio thread, looks LOOKAHEAD seconds ahead in
+ * the PatternEngine timeline and renders the blocks it finds on a worker
+ * thread, the one with the nearest deadline first. Finished audio is
+ * handed to the audio thread as an immutable set of ready clips, so
+ * playback only ever mixes buffers that already exist. A seek re-plans
+ * the queue at once: blocks left behind are dropped and the blocks around
+ * the new position go to the front.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Utilities.h"
+#include "ParameterSnapshot.h"
+#include "PatternEngine.h"
+#include "VocalRenderCache.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Rendered blocks the audio thread can play, as one immutable set
+ */
+struct ReadyClips
+{
+    struct Clip
+    {
+        TimelineBlock block;
+        VocalRenderCache::RenderedAudio audio;
+    };
+    
+    std::vector<Clip> clips;
+    double sampleRate = 0.0;
+    
+    /**
+     * @brief Whether any clip of a track overlaps [start, end) seconds
+     */
+    bool hasAudio(int trackIndex, double start, double end) const;
+    
+    /**
+     * @brief Add the clips of a track under the playhead to a buffer (audio thread)
+     * @param position Timeline position of the buffer's first sample in seconds
+     */
+    void mixInto(juce::AudioBuffer<float>& buffer, int trackIndex, double position, int numSamples) const;
+};
+
+//==============================================================================
+/**
+ * @brief Background render-ahead of the blocks following the playhead
+ *
+ * updatePlayhead() and acquireReadyClips() belong to the audio thread and
+ * are realtime safe; everything else is called from the message thread.
+ */
+class RenderAheadScheduler : private juce::Thread
+{
+public:
+    /**
+     * @brief Renders one block at a sample rate; returns nullptr if it cannot
+     *
+     * Called on the worker thread. A block it returns nullptr for is not
+     * tried again until invalidate(), or until it leaves the lookahead and
+     * comes back.
+     */
+    using BlockRenderer = std::function<VocalRenderCache::RenderedAudio(const TimelineBlock&, double)>;
+    
+    /** How far ahead of the playhead blocks are rendered */
+    static constexpr double DEFAULT_LOOKAHEAD_SECONDS = 8.0;
+    
+    /** A playhead this far from where the last block left it is a seek */
+    static constexpr double SEEK_THRESHOLD_SECONDS = 0.25;
+    
+    /** Worker poll interval while there is nothing to render */
+    static constexpr int IDLE_WAIT_MS = 50;
+    
+    /** How often an idle worker looks for a seek reported by the audio thread */
+    static constexpr int SEEK_POLL_MS = 5;
+    
+    explicit RenderAheadScheduler(PatternEngine& patternEngine);
+    ~RenderAheadScheduler() override;
+    
+    /**
+     * @brief Set the renderer (call before start())
+     */
+    void setRenderer(BlockRenderer newRenderer);
+    
+    /**
+     * @brief Start the worker rendering at a sample rate
+     *
+     * Restarting at a different rate drops every ready clip.
+     */
+    void start(double sampleRate);
+    
+    /**
+     * @brief Stop the worker, waiting for a render in progress to finish
+     */
+    void stop();
+    
+    /**
+     * @brief Set how many seconds ahead of the playhead to render
+     */
+    void setLookahead(double seconds);
+    double getLookahead() const { return lookaheadSeconds.load(); }
+    
+    /**
+     * @brief Drop every ready clip and render the upcoming blocks again
+     *
+     * Call when something the renders depend on changes other than the
+     * arrangement (e.g. the BPM or the models); arrangement edits are picked
+     * up on the worker's next pass.
+     */
+    void invalidate();
+    
+    /**
+     * @brief Report the playhead at the start of an audio block (audio thread)
+     * @param position Timeline position in seconds
+     * @param blockSeconds Length of the block, so the next call can tell a seek
+     */
+    void updatePlayhead(double position, double blockSeconds);
+    
+    /**
+     * @brief Pick up the newest ready clips (audio thread only)
+     *
+     * Lock-free. The set stays valid until the next call.
+     */
+    const ReadyClips* acquireReadyClips();
+    
+    /**
+     * @brief Blocks waiting to be rendered after the worker's last pass
+     */
+    int getNumPendingJobs() const { return numPendingJobs.load(); }
+
+private:
+    struct Job
+    {
+        TimelineBlock block;
+        double deadline;   // seconds until the block is heard, 0 if already playing
+    };
+    
+    void run() override;
+    
+    /**
+     * @brief Rebuild the job queue and prune the ready clips for the playhead (worker thread)
+     *
+     * A clip is kept until its audio, not its block, has played out: renders
+     * often run past the block's duration.
+     */
+    void plan(double playhead);
+    
+    /**
+     * @brief Hand a copy of the ready clips to the audio thread (worker thread)
+     */
+    void publishReadyClips();
+    
+    static bool isSameBlock(const TimelineBlock& a, const TimelineBlock& b);
+    
+    PatternEngine& patternEngine;
+    BlockRenderer renderer;
+    
+    std::atomic<double> lookaheadSeconds;
+    std::atomic<double> renderSampleRate;
+    std::atomic<juce::uint32> generation;
+    
+    // Written by the audio thread; signalling an event takes a lock, so a
+    // seek only raises seekPending and the idle worker polls for it
+    std::atomic<double> playheadPosition;
+    double expectedPosition;
+    std::atomic<bool> seekPending { false };
+    
+    // Signalled from the message thread
+    juce::WaitableEvent planNeeded;
+    
+    // Worker thread
+    juce::uint32 plannedGeneration;
+    std::vector<Job> jobs;
+    std::vector<ReadyClips::Clip> ready;
+    std::vector<TimelineBlock> unrenderable;
+    std::atomic<int> numPendingJobs;
+    
+    // Sets of ready clips for the audio thread; storage holds every one it may
+    // still be reading, and is only touched by the worker (or while it is stopped)
+    ParameterSnapshot<const ReadyClips*> readyClips { nullptr };
+    std::vector<std::unique_ptr<ReadyClips>> readyStorage;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderAheadScheduler)
+};
+
+} // namespace MAEVN
@@ -0,0 +1,162 @@
+/**
+ * @file RenderCLI.cpp
+ * @brief Headless batch renderer for stage scripts (MAEVN_Render)
+ *
+ * Bounces stage scripts to audio files without a DAW, through the same
+ * offline render engine the plugin's exports use:
+ *
+ *     MAEVN_Render [options] <script.txt | directory>...
+ *
+ *     --out=<dir>          Write renders here (default: next to each script)
+ *     --models=<dir>       Directory holding the models' config.json
+ *     --bpm=<bpm>          Tempo of the scripts (default 120)
+ *     --rate=<hz>          Sample rate (default 48000)
+ *     --bits=<16|24|32>    Bit depth (default 24)
+ *     --format=<wav|aiff>  File format (default wav)
+ *     --fx=<off|dsp|ai|hybrid>  FX mode of every track (default dsp)
+ *     --threads=<n>        Threads to render on (default: every core)
+ *     --no-master          Skip the cinematic mastering chain
+ *
+ * A directory argument renders every .txt script in it. The exit code is
+ * the number of scripts that failed.
+ */
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "Utilities.h"
+#include "OnnxEngine.h"
+#include "CinematicAudioEnhancer.h"
+#include "VocalRenderCache.h"
+#include "VocalSynthesizer.h"
+#include "OfflineRenderer.h"
+
+namespace
+{
+
+using namespace MAEVN;
+
+FXMode parseFXMode(const juce::String& name)
+{
+    if (name.equalsIgnoreCase("off"))    return FXMode::Off;
+    if (name.equalsIgnoreCase("ai"))     return FXMode::AI;
+    if (name.equalsIgnoreCase("hybrid")) return FXMode::Hybrid;
+    return FXMode::DSP;
+}
+
+/**
+ * @brief Collect the scripts named on the command line, expanding directories
+ */
+juce::Array<juce::File> findScripts(const juce::ArgumentList& args)
+{
+    juce::Array<juce::File> scripts;
+    
+    for (const auto& arg : args.arguments)
+    {
+        if (arg.isOption())
+            continue;
+        
+        const auto file = arg.resolveAsFile();
+        
+        if (file.isDirectory())
+            scripts.addArray(file.findChildFiles(juce::File::findFiles, false, "*.txt"));
+        else if (file.existsAsFile())
+            scripts.add(file);
+    }
+    
+    return scripts;
+}
+
+void printUsage()
+{
+    std::cout << "Usage: MAEVN_Render [options] <script.txt | directory>...\n"
+                 "  --out=<dir>  --models=<dir>  --bpm=<bpm>  --rate=<hz>  --bits=<16|24|32>\n"
+                 "  --format=<wav|aiff>  --fx=<off|dsp|ai|hybrid>  --threads=<n>  --no-master\n";
+}
+
+} // namespace
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+    const auto scripts = findScripts(args);
+    
+    if (scripts.isEmpty() || args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return scripts.isEmpty() ? 1 : 0;
+    }
+    
+    const auto valueOf = [&args](const char* option, const juce::String& fallback)
+    {
+        const auto value = args.getValueForOption(option);
+        return value.isNotEmpty() ? value : fallback;
+    };
+    
+    const double bpm = valueOf("--bpm", "120").getDoubleValue();
+    const auto extension = valueOf("--format", "wav").equalsIgnoreCase("aiff") ? ".aiff" : ".wav";
+    const auto outputDir = args.containsOption("--out") ? juce::File::getCurrentWorkingDirectory()
+                                                              .getChildFile(args.getValueForOption("--out"))
+                                                        : juce::File();
+    if (outputDir != juce::File())
+        outputDir.createDirectory();
+    
+    // Models load up front: a render farm would rather wait once than per script
+    OnnxEngine onnxEngine;
+    onnxEngine.initialize();
+    
+    if (args.containsOption("--models"))
+    {
+        const auto configFile = juce::File::getCurrentWorkingDirectory()
+                                    .getChildFile(args.getValueForOption("--models"))
+                                    .getChildFile("config.json");
+        const int numLoaded = onnxEngine.loadModelsFromConfig(configFile.getFullPathName(), ModelLoadPolicy::Blocking);
+        std::cout << "Loaded " << numLoaded << " models from " << configFile.getFullPathName() << "\n";
+    }
+    
+    VocalRenderCache renderCache;
+    VocalSynthesizer synthesizer(onnxEngine, renderCache);
+    
+    OfflineRenderSettings settings;
+    settings.sampleRate = valueOf("--rate", "48000").getDoubleValue();
+    settings.bitDepth = valueOf("--bits", "24").getIntValue();
+    settings.numThreads = valueOf("--threads", "0").getIntValue();
+    settings.masteringEnabled = !args.containsOption("--no-master");
+    settings.fxModes.fill(parseFXMode(valueOf("--fx", "dsp")));
+    
+    // The plugin's default mastering sound
+    CinematicAudioEnhancer enhancer;
+    enhancer.applyCinematicVocalPreset();
+    settings.enhancerParameters = enhancer.getParameters();
+    
+    OfflineRenderer renderer(&onnxEngine);
+    renderer.setSettings(settings);
+    renderer.setRenderer([&synthesizer, bpm](const TimelineBlock& block, double sampleRate)
+    {
+        return synthesizer.render(block, bpm, sampleRate);
+    });
+    
+    int numFailed = 0;
+    for (const auto& script : scripts)
+    {
+        const auto directory = outputDir != juce::File() ? outputDir : script.getParentDirectory();
+        const auto output = directory.getChildFile(script.getFileNameWithoutExtension() + extension);
+        
+        if (!renderer.renderStageScript(script.loadFileAsString(), bpm, output))
+        {
+            std::cout << "FAILED " << script.getFullPathName() << "\n";
+            ++numFailed;
+            continue;
+        }
+        
+        const auto& result = renderer.getLastResult();
+        std::cout << script.getFileName() << " -> " << output.getFullPathName() << ": "
+                  << juce::String(result.audioSeconds, 1) << " s in "
+                  << juce::String(result.renderSeconds, 1) << " s ("
+                  << juce::String(result.getRealtimeFactor(), 1) << "x realtime, "
+                  << juce::String(result.integratedLUFS, 1) << " LUFS)\n";
+    }
+    
+    std::cout << scripts.size() - numFailed << " of " << scripts.size() << " scripts rendered\n";
+    return numFailed;
+}
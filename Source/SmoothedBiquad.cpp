@@ -0,0 +1,313 @@
+/**
+ * @file SmoothedBiquad.cpp
+ * @brief Implementation of the smoothed biquad
+ */
+
+#include "SmoothedBiquad.h"
+
+namespace MAEVN
+{
+
+namespace
+{
+    BiquadCoefficients normalize(double b0, double b1, double b2, double a0, double a1, double a2)
+    {
+        const double inverseA0 = 1.0 / a0;
+        return { static_cast<float>(b0 * inverseA0), static_cast<float>(b1 * inverseA0),
+                 static_cast<float>(b2 * inverseA0), static_cast<float>(a1 * inverseA0),
+                 static_cast<float>(a2 * inverseA0) };
+    }
+    
+    double getOmega(double sampleRate, float frequency)
+    {
+        return juce::MathConstants<double>::twoPi * juce::jmax(1.0f, frequency) / sampleRate;
+    }
+}
+
+//==============================================================================
+BiquadCoefficients BiquadCoefficients::makeLowPass(double sampleRate, float frequency, float q)
+{
+    const double n = 1.0 / std::tan(getOmega(sampleRate, frequency) * 0.5);
+    const double nSquared = n * n;
+    const double inverseQ = 1.0 / q;
+    
+    return normalize(1.0, 2.0, 1.0,
+                     1.0 + inverseQ * n + nSquared, 2.0 * (1.0 - nSquared), 1.0 - inverseQ * n + nSquared);
+}
+
+BiquadCoefficients BiquadCoefficients::makeHighPass(double sampleRate, float frequency, float q)
+{
+    const double n = std::tan(getOmega(sampleRate, frequency) * 0.5);
+    const double nSquared = n * n;
+    const double inverseQ = 1.0 / q;
+    
+    return normalize(1.0, -2.0, 1.0,
+                     1.0 + inverseQ * n + nSquared, 2.0 * (nSquared - 1.0), 1.0 - inverseQ * n + nSquared);
+}
+
+BiquadCoefficients BiquadCoefficients::makeLowShelf(double sampleRate, float frequency, float q, float gain)
+{
+    const double A = std::sqrt(juce::jmax(0.0f, gain));
+    const double omega = getOmega(sampleRate, frequency);
+    const double cosOmega = std::cos(omega);
+    const double beta = std::sin(omega) * std::sqrt(A) / q;
+    const double aMinus1 = A - 1.0;
+    const double aPlus1 = A + 1.0;
+    
+    return normalize(A * (aPlus1 - aMinus1 * cosOmega + beta),
+                     A * 2.0 * (aMinus1 - aPlus1 * cosOmega),
+                     A * (aPlus1 - aMinus1 * cosOmega - beta),
+                     aPlus1 + aMinus1 * cosOmega + beta,
+                     -2.0 * (aMinus1 + aPlus1 * cosOmega),
+                     aPlus1 + aMinus1 * cosOmega - beta);
+}
+
+BiquadCoefficients BiquadCoefficients::makeHighShelf(double sampleRate, float frequency, float q, float gain)
+{
+    const double A = std::sqrt(juce::jmax(0.0f, gain));
+    const double omega = getOmega(sampleRate, frequency);
+    const double cosOmega = std::cos(omega);
+    const double beta = std::sin(omega) * std::sqrt(A) / q;
+    const double aMinus1 = A - 1.0;
+    const double aPlus1 = A + 1.0;
+    
+    return normalize(A * (aPlus1 + aMinus1 * cosOmega + beta),
+                     A * -2.0 * (aMinus1 + aPlus1 * cosOmega),
+                     A * (aPlus1 + aMinus1 * cosOmega - beta),
+                     aPlus1 - aMinus1 * cosOmega + beta,
+                     2.0 * (aMinus1 - aPlus1 * cosOmega),
+                     aPlus1 - aMinus1 * cosOmega - beta);
+}
+
+BiquadCoefficients BiquadCoefficients::makePeakFilter(double sampleRate, float frequency, float q, float gain)
+{
+    const double A = std::sqrt(juce::jmax(0.0f, gain));
+    const double omega = getOmega(sampleRate, frequency);
+    const double alpha = std::sin(omega) / (q * 2.0);
+    const double c2 = -2.0 * std::cos(omega);
+    
+    return normalize(1.0 + alpha * A, c2, 1.0 - alpha * A,
+                     1.0 + alpha / A, c2, 1.0 - alpha / A);
+}
+
+//==============================================================================
+BiquadCascade::Section::Section()
+{
+    // Start as a pass-through (ticket 0) until the owner designs a response
+    auto& initial = targets[0];
+    initial.values[0].store(current.b0);
+    initial.values[1].store(current.b1);
+    initial.values[2].store(current.b2);
+    initial.values[3].store(current.a1);
+    initial.values[4].store(current.a2);
+    initial.sequence.store(2);
+}
+
+bool BiquadCascade::Section::readTarget(BiquadCoefficients& result)
+{
+    const auto ticket = latestTicket.load(std::memory_order_acquire);
+    if (ticket == seenTicket)
+        return false;
+    
+    const auto& slot = targets[ticket % TARGET_SLOTS];
+    const auto sequence = 2 * ticket + 2;
+    if (slot.sequence.load(std::memory_order_acquire) != sequence)
+        return false;
+    
+    const BiquadCoefficients read { slot.values[0].load(std::memory_order_relaxed),
+                                    slot.values[1].load(std::memory_order_relaxed),
+                                    slot.values[2].load(std::memory_order_relaxed),
+                                    slot.values[3].load(std::memory_order_relaxed),
+                                    slot.values[4].load(std::memory_order_relaxed) };
+    
+    std::atomic_thread_fence(std::memory_order_acquire);
+    
+    // A newer write lapped the ring onto this slot: keep the old target and retry next block
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+        return false;
+    
+    seenTicket = ticket;
+    result = read;
+    return true;
+}
+
+//==============================================================================
+BiquadCascade::BiquadCascade(int sectionCount)
+    : numSections(juce::jlimit(1, MAX_SECTIONS, sectionCount))
+{
+    jassert(sectionCount >= 1 && sectionCount <= MAX_SECTIONS);
+}
+
+void BiquadCascade::prepare(int numChannels)
+{
+    state.assign(static_cast<size_t>(juce::jmax(0, numChannels) * numSections), {});
+    
+    for (int s = 0; s < numSections; ++s)
+        sections[static_cast<size_t>(s)].readTarget(sections[static_cast<size_t>(s)].current);
+}
+
+void BiquadCascade::reset()
+{
+    std::fill(state.begin(), state.end(), SectionState{});
+    
+    for (int s = 0; s < numSections; ++s)
+        sections[static_cast<size_t>(s)].readTarget(sections[static_cast<size_t>(s)].current);
+}
+
+void BiquadCascade::setCoefficients(int sectionIndex, const BiquadCoefficients& coefficients)
+{
+    if (sectionIndex < 0 || sectionIndex >= numSections)
+        return;
+    
+    auto& section = sections[static_cast<size_t>(sectionIndex)];
+    
+    // Concurrent writers get their own slots instead of waiting for each other
+    const auto ticket = section.nextTicket.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = section.targets[ticket % TARGET_SLOTS];
+    
+    slot.sequence.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    slot.values[0].store(coefficients.b0, std::memory_order_relaxed);
+    slot.values[1].store(coefficients.b1, std::memory_order_relaxed);
+    slot.values[2].store(coefficients.b2, std::memory_order_relaxed);
+    slot.values[3].store(coefficients.a1, std::memory_order_relaxed);
+    slot.values[4].store(coefficients.a2, std::memory_order_relaxed);
+    
+    slot.sequence.store(2 * ticket + 2, std::memory_order_release);
+    
+    // Publish unless a newer write already has; the loop only repeats when another writer got ahead
+    auto latest = section.latestTicket.load(std::memory_order_relaxed);
+    while (static_cast<juce::int32>(ticket - latest) > 0
+           && !section.latestTicket.compare_exchange_weak(latest, ticket, std::memory_order_release,
+                                                          std::memory_order_relaxed))
+    {
+    }
+}
+
+//==============================================================================
+void BiquadCascade::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const int numChannels = juce::jmin(buffer.getNumChannels(), static_cast<int>(state.size()) / numSections);
+    if (numSamples <= 0 || numChannels <= 0)
+        return;
+    
+    // Per-sample steps that reach each section's target by the end of the block
+    std::array<BiquadCoefficients, MAX_SECTIONS> start;
+    std::array<BiquadCoefficients, MAX_SECTIONS> step;
+    bool ramping = false;
+    const float scale = 1.0f / static_cast<float>(numSamples);
+    
+    for (int s = 0; s < numSections; ++s)
+    {
+        auto& section = sections[static_cast<size_t>(s)];
+        const auto current = section.current;
+        auto next = current;
+        
+        if (section.readTarget(next) && next != current)
+        {
+            step[static_cast<size_t>(s)] = { (next.b0 - current.b0) * scale, (next.b1 - current.b1) * scale,
+                                             (next.b2 - current.b2) * scale, (next.a1 - current.a1) * scale,
+                                             (next.a2 - current.a2) * scale };
+            ramping = true;
+        }
+        else
+        {
+            step[static_cast<size_t>(s)] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        }
+        
+        start[static_cast<size_t>(s)] = current;
+        section.current = next;
+    }
+    
+    int ch = 0;
+    for (; ch + 2 <= numChannels; ch += 2)
+    {
+        float* const channels[2] = { buffer.getWritePointer(ch), buffer.getWritePointer(ch + 1) };
+        SectionState* const states[2] = { state.data() + ch * numSections, state.data() + (ch + 1) * numSections };
+        
+        if (ramping)
+            processLanes<2, true>(channels, states, numSamples, start.data(), step.data());
+        else
+            processLanes<2, false>(channels, states, numSamples, start.data(), step.data());
+    }
+    
+    if (ch < numChannels)
+    {
+        float* const channels[1] = { buffer.getWritePointer(ch) };
+        SectionState* const states[1] = { state.data() + ch * numSections };
+        
+        if (ramping)
+            processLanes<1, true>(channels, states, numSamples, start.data(), step.data());
+        else
+            processLanes<1, false>(channels, states, numSamples, start.data(), step.data());
+    }
+}
+
+template <int LANES, bool RAMPING>
+void BiquadCascade::processLanes(float* const* channels, SectionState* const* states, int numSamples,
+                                 const BiquadCoefficients* start, const BiquadCoefficients* step) const
+{
+    // Coefficients are shared by the lanes; the state is one value per lane
+    // so the inner loops map onto a single vector register
+    std::array<BiquadCoefficients, MAX_SECTIONS> c;
+    float z1[MAX_SECTIONS][LANES];
+    float z2[MAX_SECTIONS][LANES];
+    
+    for (int s = 0; s < numSections; ++s)
+    {
+        c[static_cast<size_t>(s)] = start[s];
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            z1[s][lane] = states[lane][s].z1;
+            z2[s][lane] = states[lane][s].z2;
+        }
+    }
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float x[LANES];
+        for (int lane = 0; lane < LANES; ++lane)
+            x[lane] = channels[lane][i];
+        
+        for (int s = 0; s < numSections; ++s)
+        {
+            auto& k = c[static_cast<size_t>(s)];
+            
+            if constexpr (RAMPING)
+            {
+                k.b0 += step[s].b0;
+                k.b1 += step[s].b1;
+                k.b2 += step[s].b2;
+                k.a1 += step[s].a1;
+                k.a2 += step[s].a2;
+            }
+            
+            for (int lane = 0; lane < LANES; ++lane)
+            {
+                const float input = x[lane];
+                const float output = k.b0 * input + z1[s][lane];
+                z1[s][lane] = k.b1 * input - k.a1 * output + z2[s][lane];
+                z2[s][lane] = k.b2 * input - k.a2 * output;
+                x[lane] = output;
+            }
+        }
+        
+        for (int lane = 0; lane < LANES; ++lane)
+            channels[lane][i] = x[lane];
+    }
+    
+    // Flush denormals left behind by decaying tails
+    for (int s = 0; s < numSections; ++s)
+    {
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            JUCE_SNAP_TO_ZERO(z1[s][lane]);
+            JUCE_SNAP_TO_ZERO(z2[s][lane]);
+            states[lane][s].z1 = z1[s][lane];
+            states[lane][s].z2 = z2[s][lane];
+        }
+    }
+}
+
+} // namespace MAEVN
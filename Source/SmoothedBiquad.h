@@ -0,0 +1,175 @@
+/**
+ * @file SmoothedBiquad.h
+ * @brief Allocation-free biquad with lock-free, block-interpolated coefficient updates
+ *
+ * juce::dsp::IIR::Coefficients factory functions heap-allocate a new
+ * ref-counted object on every call, and writing the result into a live
+ * filter races the audio thread. Here coefficients are plain values
+ * designed on the stack, handed over through a sequence lock and ramped
+ * sample by sample across the next block, so automation neither
+ * allocates nor zippers. Filters in series share one BiquadCascade, which
+ * runs all of its sections over the buffer in a single pass.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Normalized biquad coefficients (a0 == 1)
+ *
+ * The design functions follow juce::dsp::IIR::Coefficients, so swapping
+ * one for the other leaves the response unchanged. Gains are linear.
+ */
+struct BiquadCoefficients
+{
+    float b0 = 1.0f;
+    float b1 = 0.0f;
+    float b2 = 0.0f;
+    float a1 = 0.0f;
+    float a2 = 0.0f;
+    
+    static BiquadCoefficients makeLowPass(double sampleRate, float frequency, float q = 0.70710678f);
+    static BiquadCoefficients makeHighPass(double sampleRate, float frequency, float q = 0.70710678f);
+    static BiquadCoefficients makeLowShelf(double sampleRate, float frequency, float q, float gain);
+    static BiquadCoefficients makeHighShelf(double sampleRate, float frequency, float q, float gain);
+    static BiquadCoefficients makePeakFilter(double sampleRate, float frequency, float q, float gain);
+    
+    bool operator==(const BiquadCoefficients& other) const
+    {
+        return b0 == other.b0 && b1 == other.b1 && b2 == other.b2 && a1 == other.a1 && a2 == other.a2;
+    }
+    bool operator!=(const BiquadCoefficients& other) const { return !(*this == other); }
+};
+
+//==============================================================================
+/**
+ * @brief Serial chain of transposed direct form II biquads in one pass
+ *
+ * Each sample runs through every section before the next one is read, so a
+ * block is loaded and stored once however many sections the chain has.
+ * Channels are filtered in pairs, as the two lanes of one vector, so a
+ * stereo buffer costs no more passes than a mono one.
+ *
+ * setCoefficients() may be called from any thread, including the audio
+ * thread, and never allocates or waits for another writer. The newest
+ * coefficients are picked up at the start of the next process() call and
+ * reached by its last sample; if a write is still in flight there, the
+ * block keeps its old target and looks again on the next one.
+ */
+class BiquadCascade
+{
+public:
+    static constexpr int MAX_SECTIONS = 8;
+    
+    /** Writes a section can have in flight before a slow one is lapped */
+    static constexpr int TARGET_SLOTS = 4;
+    
+    /**
+     * @brief Chain of numSections pass-through sections (1 .. MAX_SECTIONS)
+     */
+    explicit BiquadCascade(int numSections);
+    
+    /**
+     * @brief Allocate per-channel state (call outside the audio callback)
+     *
+     * Jumps straight to the most recently set coefficients.
+     */
+    void prepare(int numChannels);
+    
+    /**
+     * @brief Filter numSamples of every prepared channel in place
+     */
+    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    /**
+     * @brief Clear the filter state and jump to the target coefficients
+     */
+    void reset();
+    
+    /**
+     * @brief Set the coefficients one section ramps to on the next block (wait-free for the reader)
+     */
+    void setCoefficients(int section, const BiquadCoefficients& coefficients);
+    
+    int getNumSections() const { return numSections; }
+
+private:
+    struct Section
+    {
+        Section();
+        
+        /**
+         * @brief One write's coefficients, guarded by its own sequence
+         *
+         * The sequence is 2 * ticket + 1 while the write is in flight and
+         * 2 * ticket + 2 once it is done.
+         */
+        struct TargetSlot
+        {
+            std::atomic<juce::uint32> sequence { 0 };
+            std::array<std::atomic<float>, 5> values;
+        };
+        
+        // Each write takes the next ticket and fills its slot of the ring, so
+        // writers never wait on one another; the newest finished ticket is published
+        std::atomic<juce::uint32> nextTicket { 1 };
+        std::atomic<juce::uint32> latestTicket { 0 };
+        std::array<TargetSlot, TARGET_SLOTS> targets;
+        
+        // Audio thread only
+        juce::uint32 seenTicket = 0;
+        BiquadCoefficients current;
+        
+        /**
+         * @brief Read the target if it changed since the last read
+         */
+        bool readTarget(BiquadCoefficients& result);
+    };
+    
+    struct SectionState
+    {
+        float z1 = 0.0f;
+        float z2 = 0.0f;
+    };
+    
+    /**
+     * @brief Run LANES channels through every section, ramping coefficients when RAMPING
+     */
+    template <int LANES, bool RAMPING>
+    void processLanes(float* const* channels, SectionState* const* states, int numSamples,
+                      const BiquadCoefficients* start, const BiquadCoefficients* step) const;
+    
+    const int numSections;
+    std::array<Section, MAX_SECTIONS> sections;
+    std::vector<SectionState> state;   // [channel * numSections + section]
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BiquadCascade)
+};
+
+//==============================================================================
+/**
+ * @brief Multichannel smoothed biquad: a cascade of one section
+ */
+class SmoothedBiquad : public BiquadCascade
+{
+public:
+    SmoothedBiquad() : BiquadCascade(1) {}
+    
+    /**
+     * @brief Set the coefficients to ramp to on the next block (lock-free)
+     */
+    void setCoefficients(const BiquadCoefficients& coefficients) { BiquadCascade::setCoefficients(0, coefficients); }
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SmoothedBiquad)
+};
+
+} // namespace MAEVN
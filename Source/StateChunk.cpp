@@ -0,0 +1,146 @@
+/**
+ * @file StateChunk.cpp
+ * @brief Implementation of the binary state chunk container
+ */
+
+#include "StateChunk.h"
+#include <cstring>
+
+namespace MAEVN
+{
+
+namespace
+{
+    constexpr char CHUNK_MAGIC[4] = { 'M', 'V', 'S', 'T' };
+    constexpr size_t HEADER_SIZE = 12;         // magic, format version, section count
+    constexpr size_t TABLE_ENTRY_SIZE = 16;    // id, version, offset, size
+    
+    inline int readInt(const char* data)
+    {
+        return static_cast<int>(juce::ByteOrder::littleEndianInt(data));
+    }
+}
+
+//==============================================================================
+juce::MemoryBlock& StateChunkWriter::addSection(StateSection id, int version)
+{
+    sections.push_back(std::make_unique<Section>(Section { id, version, {} }));
+    return sections.back()->payload;
+}
+
+void StateChunkWriter::addSection(StateSection id, int version, const juce::MemoryBlock& payload)
+{
+    addSection(id, version) = payload;
+}
+
+void StateChunkWriter::writeTo(juce::MemoryBlock& destData) const
+{
+    juce::MemoryOutputStream output(destData, true);
+    
+    output.write(CHUNK_MAGIC, sizeof(CHUNK_MAGIC));
+    output.writeInt(StateChunkReader::FORMAT_VERSION);
+    output.writeInt(static_cast<int>(sections.size()));
+    
+    // Payloads follow the table in order
+    auto offset = HEADER_SIZE + TABLE_ENTRY_SIZE * sections.size();
+    for (const auto& section : sections)
+    {
+        output.writeInt(static_cast<int>(section->id));
+        output.writeInt(section->version);
+        output.writeInt(static_cast<int>(offset));
+        output.writeInt(static_cast<int>(section->payload.getSize()));
+        offset += section->payload.getSize();
+    }
+    
+    for (const auto& section : sections)
+        output.write(section->payload.getData(), section->payload.getSize());
+}
+
+//==============================================================================
+StateChunkReader::StateChunkReader(const void* data, size_t sizeInBytes)
+    : chunkData(static_cast<const char*>(data))
+    , chunkSize(sizeInBytes)
+    , valid(false)
+{
+    if (!isStateChunk(data, sizeInBytes))
+        return;
+    
+    const int formatVersion = readInt(chunkData + 4);
+    const int numSections = readInt(chunkData + 8);
+    
+    if (formatVersion < 1 || formatVersion > FORMAT_VERSION)
+    {
+        Logger::log(Logger::Level::Warning, "Unsupported state format version: " + juce::String(formatVersion));
+        return;
+    }
+    
+    if (numSections < 0 || HEADER_SIZE + TABLE_ENTRY_SIZE * static_cast<size_t>(numSections) > chunkSize)
+    {
+        Logger::log(Logger::Level::Warning, "Truncated state chunk");
+        return;
+    }
+    
+    sections.reserve(static_cast<size_t>(numSections));
+    
+    for (int i = 0; i < numSections; ++i)
+    {
+        const char* entry = chunkData + HEADER_SIZE + TABLE_ENTRY_SIZE * static_cast<size_t>(i);
+        const int offset = readInt(entry + 8);
+        const int size = readInt(entry + 12);
+        
+        if (offset < 0 || size < 0 || static_cast<size_t>(offset) + static_cast<size_t>(size) > chunkSize)
+        {
+            Logger::log(Logger::Level::Warning, "Corrupt state chunk section table");
+            sections.clear();
+            return;
+        }
+        
+        sections.push_back({ static_cast<StateSection>(readInt(entry)),
+                             readInt(entry + 4),
+                             static_cast<size_t>(offset),
+                             static_cast<size_t>(size) });
+    }
+    
+    valid = true;
+}
+
+bool StateChunkReader::isStateChunk(const void* data, size_t sizeInBytes)
+{
+    return data != nullptr && sizeInBytes >= HEADER_SIZE
+        && std::memcmp(data, CHUNK_MAGIC, sizeof(CHUNK_MAGIC)) == 0;
+}
+
+int StateChunkReader::getSectionVersion(StateSection id) const
+{
+    const auto* section = findSection(id);
+    return section != nullptr ? section->version : 0;
+}
+
+std::unique_ptr<juce::MemoryInputStream> StateChunkReader::createSectionStream(StateSection id) const
+{
+    const auto* section = findSection(id);
+    if (section == nullptr)
+        return nullptr;
+    
+    return std::make_unique<juce::MemoryInputStream>(chunkData + section->offset, section->size, false);
+}
+
+juce::MemoryBlock StateChunkReader::copySection(StateSection id) const
+{
+    const auto* section = findSection(id);
+    if (section == nullptr)
+        return {};
+    
+    return juce::MemoryBlock(chunkData + section->offset, section->size);
+}
+
+const StateChunkReader::Section* StateChunkReader::findSection(StateSection id) const
+{
+    for (const auto& section : sections)
+        if (section.id == id)
+            return &section;
+    
+    return nullptr;
+}
+
+} // namespace MAEVN
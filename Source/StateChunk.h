@@ -0,0 +1,141 @@
+/**
+ * @file StateChunk.h
+ * @brief Versioned binary container for plugin state
+ *
+ * A state chunk is a small header and a table of sections, followed by
+ * the sections' payloads:
+ *
+ *     "MVST"  format version  section count
+ *     { id  version  offset  size } per section
+ *     payloads...
+ *
+ * All values are little-endian 32-bit ints and offsets count from the
+ * start of the chunk. A reader only parses the table, so each section can
+ * be decoded on its own, kept as raw bytes until it is needed, or written
+ * back untouched. Sections carry their own version; fields are only ever
+ * appended to a section, and readers ignore bytes they do not know.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Section identifiers (stored in the chunk; never renumber)
+ */
+enum class StateSection : int
+{
+    ProcessorParams = 1,    // BPM, enable flags and other small parameters
+    Timeline = 2,           // Timeline blocks
+    SequencerPatterns = 3,  // Instrument sequencer patterns
+    FXChains = 4            // Per-track FX modes and effect settings
+};
+
+//==============================================================================
+/**
+ * @brief Builds a state chunk section by section
+ */
+class StateChunkWriter
+{
+public:
+    StateChunkWriter() = default;
+    
+    /**
+     * @brief Add a section and get the block to write its payload into
+     *
+     * Write into it through a juce::MemoryOutputStream; the block lives as
+     * long as the writer.
+     */
+    juce::MemoryBlock& addSection(StateSection id, int version);
+    
+    /**
+     * @brief Add a section whose payload is already encoded
+     */
+    void addSection(StateSection id, int version, const juce::MemoryBlock& payload);
+    
+    /**
+     * @brief Append the finished chunk to a block
+     */
+    void writeTo(juce::MemoryBlock& destData) const;
+
+private:
+    struct Section
+    {
+        StateSection id;
+        int version;
+        juce::MemoryBlock payload;
+    };
+    
+    std::vector<std::unique_ptr<Section>> sections;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StateChunkWriter)
+};
+
+//==============================================================================
+/**
+ * @brief Gives access to the sections of a state chunk without decoding them
+ *
+ * Refers to the data it was given instead of copying it, so the data must
+ * outlive the reader and every stream it creates.
+ */
+class StateChunkReader
+{
+public:
+    static constexpr int FORMAT_VERSION = 1;
+    
+    StateChunkReader(const void* data, size_t sizeInBytes);
+    
+    /**
+     * @brief Check whether data starts like a state chunk (as opposed to legacy JSON)
+     */
+    static bool isStateChunk(const void* data, size_t sizeInBytes);
+    
+    /**
+     * @brief Whether the header and section table were read successfully
+     */
+    bool isValid() const { return valid; }
+    
+    bool hasSection(StateSection id) const { return findSection(id) != nullptr; }
+    
+    /**
+     * @brief Get the version a section was written with (0 if it is missing)
+     */
+    int getSectionVersion(StateSection id) const;
+    
+    /**
+     * @brief Open a stream over a section's payload (nullptr if it is missing)
+     */
+    std::unique_ptr<juce::MemoryInputStream> createSectionStream(StateSection id) const;
+    
+    /**
+     * @brief Copy a section's payload, e.g. to decode it later
+     */
+    juce::MemoryBlock copySection(StateSection id) const;
+
+private:
+    struct Section
+    {
+        StateSection id;
+        int version;
+        size_t offset;
+        size_t size;
+    };
+    
+    const char* chunkData;
+    size_t chunkSize;
+    std::vector<Section> sections;
+    bool valid;
+    
+    const Section* findSection(StateSection id) const;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StateChunkReader)
+};
+
+} // namespace MAEVN
@@ -8,12 +8,17 @@
 namespace MAEVN
 {
 
-TimelineLane::TimelineLane(int track, PatternEngine* engine)
+TimelineLane::TimelineLane(int track, PatternEngine* engine, WaveformPeakCache* peakCache)
     : trackIndex(track)
     , patternEngine(engine)
+    , waveformPeaks(peakCache)
     , trackName("Track " + juce::String(track))
+    , pixelsPerSecond(DEFAULT_PIXELS_PER_SECOND)
+    , playheadX(-1)
 {
     setSize(800, 60);
+    setOpaque(true);
+    refreshBlocks();
 }
 
 TimelineLane::~TimelineLane()
@@ -22,25 +27,64 @@ TimelineLane::~TimelineLane()
 
 void TimelineLane::paint(juce::Graphics& g)
 {
+    // Only the dirty region is drawn; blocks outside it are skipped
+    const auto clip = g.getClipBounds();
+    
     g.fillAll(juce::Colours::darkgrey);
     g.setColour(juce::Colours::white);
     g.drawText(trackName, getLocalBounds(), juce::Justification::centredLeft);
     
-    // Draw blocks if pattern engine is available
-    if (patternEngine)
+    for (const auto& laneBlock : blocks)
     {
-        auto blocks = patternEngine->getBlocksForTrack(trackIndex);
-        for (const auto& block : blocks)
-        {
-            int x = (int)(block.startTime * 50); // 50 pixels per second
-            int width = (int)(block.duration * 50);
-            juce::Rectangle<int> blockRect(x, 20, width, 30);
-            
-            g.setColour(juce::Colours::lightblue);
-            g.fillRect(blockRect);
-            g.setColour(juce::Colours::black);
-            g.drawRect(blockRect, 1);
-        }
+        const auto blockRect = getBlockBounds(laneBlock.block);
+        if (!blockRect.intersects(clip))
+            continue;
+        
+        g.setColour(juce::Colours::lightblue);
+        g.fillRect(blockRect);
+        
+        if (laneBlock.peaks != nullptr)
+            paintWaveform(g, laneBlock, blockRect.getIntersection(clip));
+        
+        g.setColour(juce::Colours::black);
+        g.drawRect(blockRect, 1);
+    }
+    
+    if (playheadX >= 0 && getPlayheadBounds(playheadX).intersects(clip))
+    {
+        g.setColour(juce::Colours::orange);
+        g.fillRect(playheadX, 0, PLAYHEAD_WIDTH, getHeight());
+    }
+}
+
+void TimelineLane::paintWaveform(juce::Graphics& g, const LaneBlock& laneBlock, juce::Rectangle<int> bounds) const
+{
+    const auto& peaks = *laneBlock.peaks;
+    if (peaks.getNumLevels() == 0 || peaks.getSampleRate() <= 0.0)
+        return;
+    
+    const double samplesPerPixel = peaks.getSampleRate() / pixelsPerSecond;
+    const int level = peaks.getLevelForSamplesPerPixel(samplesPerPixel);
+    const double blockX = laneBlock.block.startTime * pixelsPerSecond;
+    
+    const auto blockRect = getBlockBounds(laneBlock.block);
+    const float centre = static_cast<float>(blockRect.getCentreY());
+    const float halfHeight = 0.5f * static_cast<float>(blockRect.getHeight() - 2);
+    
+    g.setColour(juce::Colours::darkblue);
+    
+    for (int x = bounds.getX(); x < bounds.getRight(); ++x)
+    {
+        const auto start = static_cast<juce::int64>((x - blockX) * samplesPerPixel);
+        const auto end = static_cast<juce::int64>((x + 1 - blockX) * samplesPerPixel);
+        
+        WaveformPeaks::Peak peak;
+        if (!peaks.getPeakInRange(level, start, juce::jmax(end, start + 1), peak))
+            continue;
+        
+        const float top = centre - juce::jlimit(-1.0f, 1.0f, peak.max) * halfHeight;
+        const float bottom = centre - juce::jlimit(-1.0f, 1.0f, peak.min) * halfHeight;
+        g.drawVerticalLine(x, top, juce::jmax(bottom, top + 1.0f));
     }
 }
 
@@ -54,4 +98,108 @@ void TimelineLane::setTrackName(const juce::String& name)
     repaint();
 }
 
+//==============================================================================
+void TimelineLane::refreshBlocks()
+{
+    std::vector<LaneBlock> newBlocks;
+    if (patternEngine)
+    {
+        for (const auto& block : patternEngine->getBlocksForTrack(trackIndex))
+        {
+            LaneBlock laneBlock;
+            laneBlock.block = block;
+            newBlocks.push_back(laneBlock);
+        }
+    }
+    
+    // Repaint where a block was and where it is now, for every block that differs
+    const size_t numBlocks = juce::jmax(blocks.size(), newBlocks.size());
+    for (size_t i = 0; i < numBlocks; ++i)
+    {
+        const bool hadBlock = i < blocks.size();
+        const bool hasBlock = i < newBlocks.size();
+        
+        if (hadBlock && hasBlock && isSameBlock(blocks[i].block, newBlocks[i].block))
+        {
+            newBlocks[i].peaks = blocks[i].peaks;
+            newBlocks[i].paintedPeaks = blocks[i].paintedPeaks;
+            continue;
+        }
+        
+        if (hadBlock)
+            repaint(getBlockBounds(blocks[i].block).expanded(1));
+        if (hasBlock)
+            repaint(getBlockBounds(newBlocks[i].block).expanded(1));
+    }
+    
+    blocks = std::move(newBlocks);
+    refreshWaveforms();
+}
+
+void TimelineLane::refreshWaveforms()
+{
+    if (waveformPeaks == nullptr)
+        return;
+    
+    for (auto& laneBlock : blocks)
+    {
+        auto peaks = waveformPeaks->find(laneBlock.block);
+        const int readyPeaks = peaks != nullptr && peaks->getNumLevels() > 0 ? peaks->getNumReadyPeaks(0) : 0;
+        
+        if (peaks == laneBlock.peaks && readyPeaks == laneBlock.paintedPeaks)
+            continue;
+        
+        laneBlock.peaks = std::move(peaks);
+        laneBlock.paintedPeaks = readyPeaks;
+        repaint(getBlockBounds(laneBlock.block));
+    }
+}
+
+void TimelineLane::setPlayheadPosition(double seconds)
+{
+    const int x = seconds >= 0.0 ? juce::roundToInt(seconds * pixelsPerSecond) : -1;
+    if (x == playheadX)
+        return;
+    
+    if (playheadX >= 0)
+        repaint(getPlayheadBounds(playheadX));
+    if (x >= 0)
+        repaint(getPlayheadBounds(x));
+    
+    playheadX = x;
+}
+
+void TimelineLane::setPixelsPerSecond(double newPixelsPerSecond)
+{
+    newPixelsPerSecond = juce::jmax(0.01, newPixelsPerSecond);
+    if (newPixelsPerSecond == pixelsPerSecond)
+        return;
+    
+    const double playheadSeconds = playheadX >= 0 ? playheadX / pixelsPerSecond : -1.0;
+    pixelsPerSecond = newPixelsPerSecond;
+    playheadX = playheadSeconds >= 0.0 ? juce::roundToInt(playheadSeconds * pixelsPerSecond) : -1;
+    repaint();
+}
+
+//==============================================================================
+juce::Rectangle<int> TimelineLane::getBlockBounds(const TimelineBlock& block) const
+{
+    const int x = static_cast<int>(block.startTime * pixelsPerSecond);
+    const int width = static_cast<int>(block.duration * pixelsPerSecond);
+    return { x, BLOCK_TOP, width, BLOCK_HEIGHT };
+}
+
+juce::Rectangle<int> TimelineLane::getPlayheadBounds(int x) const
+{
+    return { x - 1, 0, PLAYHEAD_WIDTH + 2, getHeight() };
+}
+
+bool TimelineLane::isSameBlock(const TimelineBlock& a, const TimelineBlock& b)
+{
+    return a.type == b.type
+        && a.startTime == b.startTime
+        && a.duration == b.duration
+        && a.content == b.content;
+}
+
 } // namespace MAEVN
@@ -1,13 +1,20 @@
 /**
  * @file TimelineLane.h
  * @brief Timeline lane component for track visualization
+ *
+ * The lane keeps a copy of its track's blocks and repaints only what
+ * changes: the blocks an edit touched, a block whose waveform gained peaks
+ * and the strips the playhead leaves and enters. Waveforms are drawn from
+ * the level of the block's peak pyramid that matches the zoom.
  */
 
 #pragma once
 
 #include <JuceHeader.h>
+#include <vector>
 #include "Utilities.h"
 #include "PatternEngine.h"
+#include "WaveformPeaks.h"
 
 namespace MAEVN
 {
@@ -15,7 +22,12 @@ namespace MAEVN
 class TimelineLane : public juce::Component
 {
 public:
-    TimelineLane(int trackIndex, PatternEngine* engine);
+    static constexpr double DEFAULT_PIXELS_PER_SECOND = 50.0;
+    static constexpr int BLOCK_TOP = 20;
+    static constexpr int BLOCK_HEIGHT = 30;
+    static constexpr int PLAYHEAD_WIDTH = 2;
+    
+    TimelineLane(int trackIndex, PatternEngine* engine, WaveformPeakCache* peakCache = nullptr);
     ~TimelineLane() override;
     
     void paint(juce::Graphics& g) override;
@@ -24,11 +36,55 @@ public:
     void setTrackName(const juce::String& name);
     int getTrackIndex() const { return trackIndex; }
     
+    /**
+     * @brief Re-read the track's blocks and repaint the ones that changed
+     */
+    void refreshBlocks();
+    
+    /**
+     * @brief Pick up waveform peaks that arrived since the last call
+     */
+    void refreshWaveforms();
+    
+    /**
+     * @brief Move the playhead, repainting only the strips it leaves and enters
+     * @param seconds Timeline position (negative = hidden)
+     */
+    void setPlayheadPosition(double seconds);
+    
+    /**
+     * @brief Set the zoom (repaints the whole lane)
+     */
+    void setPixelsPerSecond(double pixelsPerSecond);
+    double getPixelsPerSecond() const { return pixelsPerSecond; }
+
 private:
+    struct LaneBlock
+    {
+        TimelineBlock block;
+        WaveformPeakCache::Peaks peaks;
+        int paintedPeaks = 0;   // level-0 peaks ready when last repainted
+    };
+    
     int trackIndex;
     PatternEngine* patternEngine;
+    WaveformPeakCache* waveformPeaks;
     juce::String trackName;
     
+    std::vector<LaneBlock> blocks;
+    double pixelsPerSecond;
+    int playheadX;              // -1 = hidden
+    
+    juce::Rectangle<int> getBlockBounds(const TimelineBlock& block) const;
+    juce::Rectangle<int> getPlayheadBounds(int x) const;
+    
+    /**
+     * @brief Draw a block's waveform within the clip region from the level matching the zoom
+     */
+    void paintWaveform(juce::Graphics& g, const LaneBlock& laneBlock, juce::Rectangle<int> bounds) const;
+    
+    static bool isSameBlock(const TimelineBlock& a, const TimelineBlock& b);
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimelineLane)
 };
 
@@ -0,0 +1,165 @@
+/**
+ * @file TimelineSnapshot.cpp
+ * @brief Implementation of the indexed timeline snapshot and its iterator
+ */
+
+#include "TimelineSnapshot.h"
+#include <algorithm>
+#include <limits>
+
+namespace MAEVN
+{
+
+//==============================================================================
+TimelineSnapshot::TimelineSnapshot(const std::vector<TimelineBlock>& timelineBlocks, const TimelineEdit& timelineEdit)
+    : blocks(timelineBlocks)
+    , edit(timelineEdit)
+{
+    int numTracks = 0;
+    for (const auto& block : blocks)
+        numTracks = juce::jmax(numTracks, block.trackIndex + 1);
+    
+    tracks.resize(static_cast<size_t>(numTracks));
+    
+    for (int index = 0; index < getNumBlocks(); ++index)
+    {
+        const int trackIndex = blocks[static_cast<size_t>(index)].trackIndex;
+        if (trackIndex >= 0)
+            tracks[static_cast<size_t>(trackIndex)].order.push_back(index);
+    }
+    
+    for (auto& track : tracks)
+    {
+        // Stable, so blocks starting together keep their timeline order
+        std::stable_sort(track.order.begin(), track.order.end(), [this](int a, int b)
+        {
+            return blocks[static_cast<size_t>(a)].startTime < blocks[static_cast<size_t>(b)].startTime;
+        });
+        
+        double latest = -std::numeric_limits<double>::infinity();
+        for (const int index : track.order)
+        {
+            const auto& block = blocks[static_cast<size_t>(index)];
+            const double end = block.startTime + juce::jmax(0.0, block.duration);
+            latest = juce::jmax(latest, end);
+            
+            track.starts.push_back(block.startTime);
+            track.ends.push_back(end);
+            track.latestEnd.push_back(latest);
+        }
+    }
+}
+
+const std::vector<int>& TimelineSnapshot::getTrackBlocks(int trackIndex) const
+{
+    static const std::vector<int> noBlocks;
+    return juce::isPositiveAndBelow(trackIndex, getNumTracks()) ? tracks[static_cast<size_t>(trackIndex)].order : noBlocks;
+}
+
+int TimelineSnapshot::TrackIndex::findFirstStartingAfter(double time) const
+{
+    return static_cast<int>(std::upper_bound(starts.begin(), starts.end(), time) - starts.begin());
+}
+
+int TimelineSnapshot::TrackIndex::findFirstStartingAtOrAfter(double time) const
+{
+    return static_cast<int>(std::lower_bound(starts.begin(), starts.end(), time) - starts.begin());
+}
+
+//==============================================================================
+ActiveBlockIterator::ActiveBlockIterator()
+    : timeline(nullptr)
+    , track(nullptr)
+    , trackIndex(-1)
+    , needsSeek(true)
+    , playhead(0.0)
+    , nextPosition(0)
+    , numActive(0)
+{
+}
+
+void ActiveBlockIterator::setTimeline(const TimelineSnapshot* snapshot, int newTrackIndex)
+{
+    if (snapshot == timeline && newTrackIndex == trackIndex)
+        return;
+    
+    timeline = snapshot;
+    trackIndex = newTrackIndex;
+    track = snapshot != nullptr && juce::isPositiveAndBelow(newTrackIndex, snapshot->getNumTracks())
+                ? &snapshot->tracks[static_cast<size_t>(newTrackIndex)]
+                : nullptr;
+    needsSeek = true;
+    numActive = 0;
+}
+
+void ActiveBlockIterator::advanceTo(double time)
+{
+    if (track == nullptr)
+    {
+        playhead = time;
+        numActive = 0;
+        return;
+    }
+    
+    if (needsSeek || time < playhead || time - playhead > SEEK_THRESHOLD_SECONDS)
+    {
+        seek(time);
+        return;
+    }
+    
+    // Drop the blocks that have ended, then pick up the ones that started
+    for (int i = numActive - 1; i >= 0; --i)
+    {
+        if (track->ends[static_cast<size_t>(active[static_cast<size_t>(i)])] <= time)
+            active[static_cast<size_t>(i)] = active[static_cast<size_t>(--numActive)];
+    }
+    
+    const int numPositions = static_cast<int>(track->order.size());
+    for (; nextPosition < numPositions && track->starts[static_cast<size_t>(nextPosition)] <= time; ++nextPosition)
+        addIfActive(nextPosition, time);
+    
+    playhead = time;
+}
+
+void ActiveBlockIterator::seek(double time)
+{
+    numActive = 0;
+    nextPosition = track->findFirstStartingAfter(time);
+    
+    // Only blocks starting before time and ending after it; latestEnd stops
+    // the walk at the first position nothing earlier can still overlap
+    for (int position = nextPosition - 1;
+         position >= 0 && track->latestEnd[static_cast<size_t>(position)] > time; --position)
+        addIfActive(position, time);
+    
+    playhead = time;
+    needsSeek = false;
+}
+
+void ActiveBlockIterator::addIfActive(int position, double time)
+{
+    if (track->ends[static_cast<size_t>(position)] <= time)
+        return;
+    
+    // More overlapping blocks than slots is a malformed arrangement: the
+    // excess simply is not reported
+    jassert(numActive < MAX_ACTIVE);
+    if (numActive < MAX_ACTIVE)
+        active[static_cast<size_t>(numActive++)] = position;
+}
+
+int ActiveBlockIterator::getActiveBlockIndex(int i) const
+{
+    jassert(juce::isPositiveAndBelow(i, numActive));
+    return track->order[static_cast<size_t>(active[static_cast<size_t>(i)])];
+}
+
+int ActiveBlockIterator::getNextBlockIndex() const
+{
+    if (track == nullptr || needsSeek || nextPosition >= static_cast<int>(track->order.size()))
+        return -1;
+    
+    return track->order[static_cast<size_t>(nextPosition)];
+}
+
+} // namespace MAEVN
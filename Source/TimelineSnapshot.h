@@ -0,0 +1,202 @@
+/**
+ * @file TimelineSnapshot.h
+ * @brief Immutable, indexed copy of the timeline for audio-thread queries
+ *
+ * PatternEngine builds a new snapshot on the editing thread whenever its
+ * blocks change and hands it over lock-free. Each snapshot carries a
+ * per-track index of its blocks sorted by start time, so a seek is a
+ * binary search, and an ActiveBlockIterator following the playhead only
+ * looks at the blocks it crosses. Queries return indices into the
+ * snapshot's own blocks; nothing is copied on the audio thread.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Which blocks a snapshot changed relative to the one published before it
+ *
+ * Blocks [firstBlock, firstBlock + numInserted) replace numRemoved blocks of
+ * the previous timeline. The blocks after them are the same blocks, moved
+ * in time only if startsShifted.
+ */
+struct TimelineEdit
+{
+    int firstBlock = 0;
+    int numRemoved = 0;
+    int numInserted = 0;
+    bool startsShifted = false;
+};
+
+//==============================================================================
+/**
+ * @brief The blocks of a timeline with a per-track interval index
+ *
+ * Block indices match the order of PatternEngine::getBlocks() at the time
+ * the snapshot was built. A block is active over [startTime, startTime +
+ * duration).
+ */
+class TimelineSnapshot
+{
+public:
+    TimelineSnapshot(const std::vector<TimelineBlock>& timelineBlocks, const TimelineEdit& edit);
+    
+    int getNumBlocks() const { return static_cast<int>(blocks.size()); }
+    const TimelineBlock& getBlock(int index) const { return blocks[static_cast<size_t>(index)]; }
+    const std::vector<TimelineBlock>& getBlocks() const { return blocks; }
+    
+    /**
+     * @brief How this snapshot differs from the previously published one
+     */
+    const TimelineEdit& getEdit() const { return edit; }
+    
+    /**
+     * @brief One past the highest track index any block uses
+     */
+    int getNumTracks() const { return static_cast<int>(tracks.size()); }
+    
+    /**
+     * @brief Indices of one track's blocks, ordered by start time
+     */
+    const std::vector<int>& getTrackBlocks(int trackIndex) const;
+    
+    /**
+     * @brief Call visitor(blockIndex) for each block of a track active at time
+     *
+     * O(log n) to find the position plus the blocks overlapping it.
+     */
+    template <typename Visitor>
+    void forEachActiveBlock(int trackIndex, double time, Visitor&& visitor) const
+    {
+        if (!juce::isPositiveAndBelow(trackIndex, getNumTracks()))
+            return;
+        
+        const auto& track = tracks[static_cast<size_t>(trackIndex)];
+        for (int position = track.findFirstStartingAfter(time) - 1;
+             position >= 0 && track.latestEnd[static_cast<size_t>(position)] > time; --position)
+        {
+            if (track.ends[static_cast<size_t>(position)] > time)
+                visitor(track.order[static_cast<size_t>(position)]);
+        }
+    }
+    
+    /**
+     * @brief Call visitor(blockIndex) for each block of a track overlapping [start, end)
+     *
+     * Visits blocks latest start first.
+     */
+    template <typename Visitor>
+    void forEachBlockInRange(int trackIndex, double start, double end, Visitor&& visitor) const
+    {
+        if (!juce::isPositiveAndBelow(trackIndex, getNumTracks()))
+            return;
+        
+        const auto& track = tracks[static_cast<size_t>(trackIndex)];
+        for (int position = track.findFirstStartingAtOrAfter(end) - 1;
+             position >= 0 && track.latestEnd[static_cast<size_t>(position)] > start; --position)
+        {
+            if (track.ends[static_cast<size_t>(position)] > start)
+                visitor(track.order[static_cast<size_t>(position)]);
+        }
+    }
+
+private:
+    friend class ActiveBlockIterator;
+    
+    struct TrackIndex
+    {
+        std::vector<int> order;          // block indices by start time
+        std::vector<double> starts;      // start of order[i]
+        std::vector<double> ends;        // end of order[i]
+        std::vector<double> latestEnd;   // latest end among order[0 .. i]
+        
+        /**
+         * @brief Position in order of the first block starting after time
+         */
+        int findFirstStartingAfter(double time) const;
+        
+        /**
+         * @brief Position in order of the first block starting at or after time
+         */
+        int findFirstStartingAtOrAfter(double time) const;
+    };
+    
+    std::vector<TimelineBlock> blocks;
+    std::vector<TrackIndex> tracks;
+    TimelineEdit edit;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimelineSnapshot)
+};
+
+//==============================================================================
+/**
+ * @brief Blocks of one track active at a playhead that moves forward
+ *
+ * advanceTo() costs O(1) amortized while the playhead moves forward block
+ * by block: it only drops the blocks that ended and picks up the ones that
+ * started. Moving backwards, jumping more than SEEK_THRESHOLD_SECONDS or
+ * switching snapshots falls back to a binary-search seek. Audio thread
+ * only; never allocates.
+ */
+class ActiveBlockIterator
+{
+public:
+    static constexpr int MAX_ACTIVE = 16;
+    static constexpr double SEEK_THRESHOLD_SECONDS = 1.0;
+    
+    ActiveBlockIterator();
+    
+    /**
+     * @brief Follow a track of a snapshot (which must outlive the iteration)
+     *
+     * The next advanceTo() seeks unless this is the snapshot and track
+     * already followed.
+     */
+    void setTimeline(const TimelineSnapshot* snapshot, int trackIndex);
+    
+    /**
+     * @brief Move the playhead to time in seconds
+     */
+    void advanceTo(double time);
+    
+    int getNumActive() const { return numActive; }
+    
+    /**
+     * @brief Snapshot index of the i-th active block (unordered)
+     */
+    int getActiveBlockIndex(int i) const;
+    
+    const TimelineBlock& getActiveBlock(int i) const { return timeline->getBlock(getActiveBlockIndex(i)); }
+    
+    /**
+     * @brief Snapshot index of the next block to start after the playhead, or -1
+     */
+    int getNextBlockIndex() const;
+
+private:
+    void seek(double time);
+    void addIfActive(int position, double time);
+    
+    const TimelineSnapshot* timeline;
+    const TimelineSnapshot::TrackIndex* track;
+    int trackIndex;
+    bool needsSeek;
+    double playhead;
+    int nextPosition;   // first position in track order not yet started
+    
+    // Positions in track order of the blocks under the playhead
+    std::array<int, MAX_ACTIVE> active;
+    int numActive;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ActiveBlockIterator)
+};
+
+} // namespace MAEVN
@@ -0,0 +1,268 @@
+/**
+ * @file TruePeakLimiter.cpp
+ * @brief Implementation of the lookahead true-peak limiter
+ */
+
+#include "TruePeakLimiter.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+TruePeakLimiter::TruePeakLimiter()
+    : currentSampleRate(44100.0)
+    , maxBlockSize(0)
+    , numChannels(0)
+    , maxLookaheadSamples(0)
+    , minimumFront(0)
+    , minimumCount(0)
+    , averagePosition(0)
+    , averageSum(1.0)
+    , samplePosition(0)
+    , activeLookahead(0)
+    , activeReleaseMs(0.0f)
+    , releaseCoefficient(1.0f)
+    , envelope(1.0f)
+{
+    designInterpolator();
+}
+
+void TruePeakLimiter::prepare(double sampleRate, int maxBlock, int numChannelsToUse)
+{
+    currentSampleRate = sampleRate;
+    maxBlockSize = juce::jmax(1, maxBlock);
+    numChannels = juce::jmax(1, numChannelsToUse);
+    maxLookaheadSamples = lookaheadToSamples(MAX_LOOKAHEAD_MS);
+    
+    const int maxDelay = maxLookaheadSamples + DETECTION_DELAY;
+    
+    channels.resize(static_cast<size_t>(numChannels));
+    for (auto& state : channels)
+    {
+        state.detectionHistory.assign(static_cast<size_t>(TAPS_PER_PHASE - 1 + maxBlockSize), 0.0f);
+        state.delayLine.assign(static_cast<size_t>(maxDelay + maxBlockSize), 0.0f);
+    }
+    
+    peaks.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+    gains.assign(static_cast<size_t>(maxBlockSize), 1.0f);
+    
+    minimumPositions.assign(static_cast<size_t>(maxLookaheadSamples + 2), 0);
+    minimumGains.assign(static_cast<size_t>(maxLookaheadSamples + 2), 1.0f);
+    averageHistory.assign(static_cast<size_t>(maxLookaheadSamples + 1), 1.0f);
+    
+    activeLookahead = lookaheadToSamples(lookaheadMs.load());
+    activeReleaseMs = 0.0f;   // recomputed on the first block
+    clearState();
+}
+
+void TruePeakLimiter::reset()
+{
+    clearState();
+}
+
+void TruePeakLimiter::clearState()
+{
+    for (auto& state : channels)
+    {
+        std::fill(state.detectionHistory.begin(), state.detectionHistory.end(), 0.0f);
+        std::fill(state.delayLine.begin(), state.delayLine.end(), 0.0f);
+    }
+    
+    minimumFront = 0;
+    minimumCount = 0;
+    
+    std::fill(averageHistory.begin(), averageHistory.end(), 1.0f);
+    averagePosition = 0;
+    averageSum = static_cast<double>(activeLookahead + 1);
+    
+    samplePosition = 0;
+    envelope = 1.0f;
+    gainReductionDB.store(0.0f);
+}
+
+int TruePeakLimiter::lookaheadToSamples(float ms) const
+{
+    return juce::roundToInt(juce::jlimit(0.0f, MAX_LOOKAHEAD_MS, ms) * 0.001 * currentSampleRate);
+}
+
+int TruePeakLimiter::getLatencySamples(float lookahead) const
+{
+    return lookaheadToSamples(lookahead) + DETECTION_DELAY;
+}
+
+double TruePeakLimiter::getTailLengthSeconds() const
+{
+    // The delayed audio drains first, then the gain releases
+    return getLatencySamples() / currentSampleRate + releaseMs.load() / 1000.0;
+}
+
+//==============================================================================
+void TruePeakLimiter::designInterpolator()
+{
+    // Hann-windowed sinc spanning +-DETECTION_DELAY samples. Phase 0 is the
+    // input sample itself, so only the three fractional phases need taps.
+    for (int phase = 1; phase < OVERSAMPLING_FACTOR; ++phase)
+    {
+        auto& taps = phaseTaps[static_cast<size_t>(phase - 1)];
+        const double fraction = static_cast<double>(phase) / OVERSAMPLING_FACTOR;
+        double sum = 0.0;
+        
+        for (int k = 0; k < TAPS_PER_PHASE; ++k)
+        {
+            // Distance from tap k to the interpolated instant
+            const double d = k - (TAPS_PER_PHASE - 1 - DETECTION_DELAY) - fraction;
+            const double sinc = std::sin(juce::MathConstants<double>::pi * d) / (juce::MathConstants<double>::pi * d);
+            const double window = 0.5 * (1.0 + std::cos(juce::MathConstants<double>::pi * d / DETECTION_DELAY));
+            
+            taps[static_cast<size_t>(k)] = static_cast<float>(sinc * window);
+            sum += sinc * window;
+        }
+        
+        // Unity gain at DC
+        for (auto& tap : taps)
+            tap = static_cast<float>(tap / sum);
+    }
+}
+
+float TruePeakLimiter::holdMinimum(float requiredGain, int windowLength)
+{
+    const int capacity = static_cast<int>(minimumGains.size());
+    
+    // Drop the entry that has left the window
+    if (minimumCount > 0 && minimumPositions[static_cast<size_t>(minimumFront)] <= samplePosition - windowLength)
+    {
+        minimumFront = (minimumFront + 1) % capacity;
+        --minimumCount;
+    }
+    
+    // Entries no smaller than the new gain can never be the minimum again
+    while (minimumCount > 0)
+    {
+        const int back = (minimumFront + minimumCount - 1) % capacity;
+        if (minimumGains[static_cast<size_t>(back)] < requiredGain)
+            break;
+        --minimumCount;
+    }
+    
+    const int slot = (minimumFront + minimumCount) % capacity;
+    minimumPositions[static_cast<size_t>(slot)] = samplePosition;
+    minimumGains[static_cast<size_t>(slot)] = requiredGain;
+    ++minimumCount;
+    
+    return minimumGains[static_cast<size_t>(minimumFront)];
+}
+
+//==============================================================================
+void TruePeakLimiter::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    jassert(numSamples <= maxBlockSize);
+    numSamples = juce::jmin(numSamples, maxBlockSize);
+    if (numSamples <= 0 || channels.empty())
+        return;
+    
+    // A new lookahead moves the delay tap; start it clean
+    const int lookahead = lookaheadToSamples(lookaheadMs.load(std::memory_order_relaxed));
+    if (lookahead != activeLookahead)
+    {
+        activeLookahead = lookahead;
+        clearState();
+    }
+    
+    const float release = releaseMs.load(std::memory_order_relaxed);
+    if (release != activeReleaseMs)
+    {
+        activeReleaseMs = release;
+        releaseCoefficient = 1.0f - std::exp(-1.0f / static_cast<float>(release * 0.001 * currentSampleRate));
+    }
+    
+    const float drive = inputGain.load(std::memory_order_relaxed);
+    const float ceilingGain = ceiling.load(std::memory_order_relaxed);
+    const int numToProcess = juce::jmin(numChannels, buffer.getNumChannels());
+    const int historyLength = TAPS_PER_PHASE - 1;
+    
+    //==========================================================================
+    // True peak of every sample, linked across channels
+    std::fill(peaks.begin(), peaks.begin() + numSamples, 0.0f);
+    
+    for (int ch = 0; ch < numToProcess; ++ch)
+    {
+        float* data = buffer.getWritePointer(ch);
+        if (drive != 1.0f)
+            juce::FloatVectorOperations::multiply(data, drive, numSamples);
+        
+        float* history = channels[static_cast<size_t>(ch)].detectionHistory.data();
+        std::copy(data, data + numSamples, history + historyLength);
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float* x = history + i;
+            float peak = std::abs(x[historyLength - DETECTION_DELAY]);
+            
+            for (const auto& taps : phaseTaps)
+            {
+                float interpolated = 0.0f;
+                for (int k = 0; k < TAPS_PER_PHASE; ++k)
+                    interpolated += taps[static_cast<size_t>(k)] * x[k];
+                
+                peak = std::max(peak, std::abs(interpolated));
+            }
+            
+            peaks[static_cast<size_t>(i)] = std::max(peaks[static_cast<size_t>(i)], peak);
+        }
+        
+        std::copy(history + numSamples, history + numSamples + historyLength, history);
+    }
+    
+    //==========================================================================
+    // Gain computer: hold the smallest required gain for the window, then
+    // ramp into it with a moving average of the same length. Since every
+    // held value in the average covers the window's oldest peak, the ramp
+    // reaches that peak's gain by the time its audio leaves the delay line.
+    const int windowLength = activeLookahead + 1;
+    float smallestGain = 1.0f;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float peak = peaks[static_cast<size_t>(i)];
+        const float required = peak > ceilingGain ? ceilingGain / peak : 1.0f;
+        const float held = holdMinimum(required, windowLength);
+        
+        averageSum += held - averageHistory[static_cast<size_t>(averagePosition)];
+        averageHistory[static_cast<size_t>(averagePosition)] = held;
+        averagePosition = (averagePosition + 1) % windowLength;
+        
+        const float target = std::min(1.0f, static_cast<float>(averageSum / windowLength));
+        
+        // Gain drops at once (the ramp is already in target) and recovers at the release rate
+        if (target < envelope)
+            envelope = target;
+        else
+            envelope += (target - envelope) * releaseCoefficient;
+        
+        gains[static_cast<size_t>(i)] = envelope;
+        smallestGain = std::min(smallestGain, envelope);
+        ++samplePosition;
+    }
+    
+    gainReductionDB.store(gainTodB(smallestGain), std::memory_order_relaxed);
+    
+    //==========================================================================
+    // Delay the audio to meet the gain and apply it
+    const int delay = activeLookahead + DETECTION_DELAY;
+    
+    for (int ch = 0; ch < numToProcess; ++ch)
+    {
+        float* data = buffer.getWritePointer(ch);
+        float* delayed = channels[static_cast<size_t>(ch)].delayLine.data();
+        
+        std::copy(data, data + numSamples, delayed + delay);
+        juce::FloatVectorOperations::multiply(data, delayed, gains.data(), numSamples);
+        
+        // Interpolation error can leave a sample a hair over the ceiling
+        juce::FloatVectorOperations::clip(data, data, -ceilingGain, ceilingGain, numSamples);
+        
+        std::copy(delayed + numSamples, delayed + numSamples + delay, delayed);
+    }
+}
+
+} // namespace MAEVN
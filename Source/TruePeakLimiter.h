@@ -0,0 +1,151 @@
+/**
+ * @file TruePeakLimiter.h
+ * @brief Lookahead brickwall limiter with 4x oversampled true-peak detection
+ *
+ * Peaks are measured on a 4x polyphase interpolation of the input (the
+ * BS.1770 true-peak method), so the ceiling holds between samples and
+ * survives lossy encoding. The gain each peak needs is held for the
+ * lookahead window by a monotonic-deque sliding minimum and ramped in by a
+ * moving average of the same length, both O(1) per sample whatever the
+ * lookahead. The audio is delayed to meet the ramp; getLatencySamples()
+ * reports that delay.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "Utilities.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Stereo-linked true-peak limiter used as the last stage of a chain
+ *
+ * Setters may be called from any thread. Changing the lookahead changes
+ * getLatencySamples(); the owner re-reports latency to the host, and the
+ * limiter restarts from silence when the audio thread picks it up.
+ */
+class TruePeakLimiter
+{
+public:
+    static constexpr int OVERSAMPLING_FACTOR = 4;
+    static constexpr int TAPS_PER_PHASE = 12;
+    
+    /** The interpolator centres on this many samples in the past */
+    static constexpr int DETECTION_DELAY = TAPS_PER_PHASE / 2;
+    
+    static constexpr float MAX_LOOKAHEAD_MS = 10.0f;
+    
+    TruePeakLimiter();
+    
+    /**
+     * @brief Allocate delay lines for the longest lookahead (call outside the audio callback)
+     */
+    void prepare(double sampleRate, int maxBlockSize, int numChannels);
+    
+    /**
+     * @brief Limit numSamples of every prepared channel in place
+     */
+    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+    
+    /**
+     * @brief Clear the delay lines and release the gain
+     */
+    void reset();
+    
+    /** Gain applied before limiting, in dB */
+    void setInputGain(float dB) { inputGain.store(dBToGain(juce::jlimit(-24.0f, 24.0f, dB))); }
+    
+    /** Highest true peak let through, in dBTP */
+    void setCeiling(float dB) { ceiling.store(dBToGain(juce::jlimit(-12.0f, 0.0f, dB))); }
+    
+    void setRelease(float ms) { releaseMs.store(juce::jlimit(1.0f, 1000.0f, ms)); }
+    float getRelease() const { return releaseMs.load(); }
+    
+    /**
+     * @brief Time the gain takes to reach a peak; the audio is delayed by it
+     */
+    void setLookahead(float ms) { lookaheadMs.store(juce::jlimit(0.0f, MAX_LOOKAHEAD_MS, ms)); }
+    float getLookahead() const { return lookaheadMs.load(); }
+    
+    /**
+     * @brief Delay added at the current lookahead (valid after prepare)
+     */
+    int getLatencySamples() const { return getLatencySamples(getLookahead()); }
+    
+    /**
+     * @brief Delay a given lookahead would add (valid after prepare)
+     */
+    int getLatencySamples(float lookahead) const;
+    
+    /**
+     * @brief How long output continues after the input stops
+     */
+    double getTailLengthSeconds() const;
+    
+    /**
+     * @brief Deepest gain reduction of the last block, in dB (0 or negative)
+     */
+    float getGainReductionDB() const { return gainReductionDB.load(std::memory_order_relaxed); }
+
+private:
+    struct ChannelState
+    {
+        // Last TAPS_PER_PHASE - 1 inputs followed by the current block
+        std::vector<float> detectionHistory;
+        
+        // Pending delayed samples followed by the current block
+        std::vector<float> delayLine;
+    };
+    
+    // Interpolation taps for the three phases between samples, oldest input first
+    std::array<std::array<float, TAPS_PER_PHASE>, OVERSAMPLING_FACTOR - 1> phaseTaps;
+    
+    std::atomic<float> inputGain { 1.0f };
+    std::atomic<float> ceiling { 1.0f };
+    std::atomic<float> releaseMs { 100.0f };
+    std::atomic<float> lookaheadMs { 1.5f };
+    std::atomic<float> gainReductionDB { 0.0f };
+    
+    double currentSampleRate;
+    int maxBlockSize;
+    int numChannels;
+    int maxLookaheadSamples;
+    
+    std::vector<ChannelState> channels;
+    std::vector<float> peaks;   // per sample, largest true peak of any channel
+    std::vector<float> gains;   // per sample, gain for the delayed audio
+    
+    // Sliding minimum of the required gain: a ring of (position, gain)
+    // entries with increasing gains, the oldest (smallest) at the front
+    std::vector<juce::int64> minimumPositions;
+    std::vector<float> minimumGains;
+    int minimumFront;
+    int minimumCount;
+    
+    // Moving average of the held gain over the same window
+    std::vector<float> averageHistory;
+    int averagePosition;
+    double averageSum;
+    
+    // Audio thread
+    juce::int64 samplePosition;
+    int activeLookahead;   // samples; the window is one longer
+    float activeReleaseMs;
+    float releaseCoefficient;
+    float envelope;
+    
+    int lookaheadToSamples(float ms) const;
+    void designInterpolator();
+    void clearState();
+    float holdMinimum(float requiredGain, int windowLength);
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TruePeakLimiter)
+};
+
+} // namespace MAEVN
@@ -27,10 +27,10 @@ void UndoHistoryComponent::paint(juce::Graphics& g)
     if (undoManager)
     {
         int y = 50;
-        const auto& history = undoManager->getHistory();
+        const int historySize = undoManager->getHistorySize();
         int currentIndex = undoManager->getCurrentHistoryIndex();
         
-        for (int i = 0; i < (int)history.size() && y < getHeight(); ++i)
+        for (int i = 0; i < historySize && y < getHeight(); ++i)
         {
             if (i == currentIndex)
             {
@@ -40,7 +40,7 @@ void UndoHistoryComponent::paint(juce::Graphics& g)
             {
                 g.setColour(juce::Colours::white);
             }
-            g.drawText(history[i].description, 10, y, getWidth() - 20, 20, juce::Justification::centredLeft);
+            g.drawText(undoManager->getHistoryDescription(i), 10, y, getWidth() - 20, 20, juce::Justification::centredLeft);
             y += 25;
         }
     }
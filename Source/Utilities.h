@@ -9,9 +9,12 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <memory>
+#include "Logger.h"
 
 namespace MAEVN
 {
@@ -30,6 +33,8 @@ constexpr int DEFAULT_SAMPLE_RATE = 44100;
 constexpr int MAX_CHANNELS = 2;
 constexpr double PI = 3.14159265358979323846;
 constexpr double TWO_PI = 2.0 * PI;
+constexpr float SILENCE_THRESHOLD = 1.0e-5f;   // -100 dBFS
+constexpr double FILTER_TAIL_SECONDS = 0.05;   // ring-out allowance for IIR stages
 
 //==============================================================================
 // Model Configuration
@@ -127,6 +132,25 @@ inline juce::String blockTypeToString(BlockType type)
     }
 }
 
+/**
+ * @brief Check if a block type is sung (rendered by the vocal models)
+ */
+inline bool isVocalBlockType(BlockType type)
+{
+    switch (type)
+    {
+        case BlockType::Intro:
+        case BlockType::Hook:
+        case BlockType::Verse:
+        case BlockType::Bridge:
+        case BlockType::Outro:
+        case BlockType::Vocal:
+            return true;
+        default:
+            return false;
+    }
+}
+
 /**
  * @brief Clamp value between min and max
  */
@@ -152,6 +176,69 @@ inline float gainTodB(float gain)
     return 20.0f * std::log10(gain);
 }
 
+/**
+ * @brief log2 for positive, normal x with absolute error below 3e-6
+ *
+ * The mantissa is folded into [sqrt(0.5), sqrt(2)) with integer arithmetic
+ * and an odd atanh series does the rest, so the function is branch-free
+ * and loops over it vectorise.
+ */
+inline float fastLog2(float x)
+{
+    std::int32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    
+    const std::int32_t exponent = (bits - 0x3f3504f3) >> 23;
+    bits -= exponent * (1 << 23);
+    
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+    
+    // ln(m) = 2 atanh(s), s = (m - 1) / (m + 1), |s| < 0.172
+    const float s = (mantissa - 1.0f) / (mantissa + 1.0f);
+    const float s2 = s * s;
+    const float lnMantissa = 2.0f * s * (1.0f + s2 * (0.33333333f + s2 * (0.2f + s2 * 0.14285714f)));
+    
+    return static_cast<float>(exponent) + lnMantissa * 1.44269504f;
+}
+
+/**
+ * @brief 2^x with relative error below 4e-6 (x clamped to +-126)
+ */
+inline float fastExp2(float x)
+{
+    x = std::min(std::max(x, -126.0f), 126.0f);
+    
+    const float whole = std::floor(x + 0.5f);
+    const float f = x - whole;   // [-0.5, 0.5]
+    
+    // Taylor series of e^(f ln 2)
+    const float p = 1.0f + f * (0.69314718f + f * (0.24022651f + f * (0.05550411f
+                  + f * (0.00961813f + f * 0.00133336f))));
+    
+    const std::int32_t bits = (static_cast<std::int32_t>(whole) + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    
+    return scale * p;
+}
+
+/**
+ * @brief dBToGain via fastExp2 (for per-sample gain computers)
+ */
+inline float fastDBToGain(float dB)
+{
+    return fastExp2(dB * 0.16609640f);
+}
+
+/**
+ * @brief gainTodB via fastLog2 (gain must be positive)
+ */
+inline float fastGainTodB(float gain)
+{
+    return fastLog2(gain) * 6.02059991f;
+}
+
 /**
  * @brief Simple envelope ADSR structure
  */
@@ -183,32 +270,85 @@ struct TimelineBlock
 };
 
 /**
- * @brief Logging utility
+ * @brief Estimate how long a juce::dsp::Reverb rings out (-60 dB)
+ *
+ * Its comb filters feed back 0.7 + 0.28 * roomSize per ~37 ms loop.
  */
-class Logger
+inline double getReverbTailSeconds(float roomSize)
+{
+    constexpr double longestCombSeconds = 1617.0 / 44100.0;
+    const double feedback = 0.7 + 0.28 * static_cast<double>(clamp(roomSize, 0.0f, 1.0f));
+    return longestCombSeconds * std::log(0.001) / std::log(feedback);
+}
+
+/**
+ * @brief Bypasses a stage once its input has been silent for longer than its tail
+ * 
+ * Audio thread only. A bypassed stage would only have output silence, and
+ * its state has decayed by then, so it resumes on the first non-silent
+ * block without a click.
+ */
+class SilenceGate
 {
 public:
-    enum class Level
+    void prepare(double sampleRate)
     {
-        Debug,
-        Info,
-        Warning,
-        Error
-    };
+        currentSampleRate = sampleRate;
+        reset();
+    }
     
-    static void log(Level level, const juce::String& message)
+    void reset()
     {
-        juce::String prefix;
-        switch (level)
+        silentSamples = 0;
+        open = false;
+    }
+    
+    /**
+     * @brief Whether the last block was processed, i.e. a tail may still be ringing
+     */
+    bool isOpen() const { return open; }
+    
+    /**
+     * @brief Account for a block and decide whether the stage has to run it
+     * @param inputSilent Whether the block entering the stage is silent
+     * @param tailSeconds How long the stage keeps sounding after its input stops
+     */
+    bool shouldProcess(bool inputSilent, int numSamples, double tailSeconds)
+    {
+        if (!inputSilent)
         {
-            case Level::Debug:   prefix = "[DEBUG] "; break;
-            case Level::Info:    prefix = "[INFO] "; break;
-            case Level::Warning: prefix = "[WARNING] "; break;
-            case Level::Error:   prefix = "[ERROR] "; break;
+            silentSamples = 0;
+            open = true;
+            return true;
         }
         
-        DBG(prefix + message);
+        const bool tailFinished = silentSamples > static_cast<juce::int64>(tailSeconds * currentSampleRate);
+        if (!tailFinished)
+            silentSamples += numSamples;
+        open = !tailFinished;
+        return open;
     }
+    
+    /**
+     * @brief Check whether every channel of a block is below SILENCE_THRESHOLD
+     */
+    static bool isSilent(const juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        if (buffer.hasBeenCleared())
+            return true;
+        
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            if (buffer.getMagnitude(ch, 0, numSamples) > SILENCE_THRESHOLD)
+                return false;
+        }
+        return true;
+    }
+    
+private:
+    double currentSampleRate = 44100.0;
+    juce::int64 silentSamples = 0;
+    bool open = false;
 };
 
 } // namespace MAEVN
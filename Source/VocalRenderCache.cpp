@@ -0,0 +1,246 @@
+/**
+ * @file VocalRenderCache.cpp
+ * @brief Implementation of the vocal render cache
+ */
+
+#include "VocalRenderCache.h"
+
+namespace MAEVN
+{
+
+namespace
+{
+    constexpr int RENDER_FILE_VERSION = 1;
+    constexpr const char* LEGACY_RENDER_FILE_EXTENSION = ".f32"; // raw files of the old disk tier
+    constexpr size_t DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+}
+
+//==============================================================================
+VocalRenderCache::VocalRenderCache()
+    : memoryUsage(0)
+    , memoryBudget(DEFAULT_MEMORY_BUDGET)
+    , diskStore(juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                    .getChildFile("MAEVN")
+                    .getChildFile("RenderCache"))
+    , diskCacheEnabled(true)
+    , hitCount(0)
+    , missCount(0)
+{
+}
+
+VocalRenderCache::~VocalRenderCache()
+{
+    clearMemory();
+}
+
+//==============================================================================
+juce::String VocalRenderCache::makeKey(const TimelineBlock& block,
+                                       const juce::String& modelHash,
+                                       double bpm,
+                                       double sampleRate,
+                                       const juce::String& parameters)
+{
+    // Start time is left out: the same line renders identically anywhere
+    juce::String description;
+    description << "v" << RENDER_FILE_VERSION
+                << "|" << blockTypeToString(block.type)
+                << "|" << block.content
+                << "|" << juce::String(block.duration, 6)
+                << "|" << modelHash
+                << "|" << juce::String(bpm, 3)
+                << "|" << juce::String(sampleRate, 1)
+                << "|" << parameters;
+    
+    return juce::SHA256(description.toUTF8()).toHexString();
+}
+
+juce::String VocalRenderCache::getModelHash(const juce::StringArray& modelPaths)
+{
+    juce::String combined;
+    
+    for (const auto& path : modelPaths)
+    {
+        juce::File file(path);
+        if (!file.existsAsFile())
+            return {};
+        
+        const auto size = file.getSize();
+        const auto modified = file.getLastModificationTime();
+        
+        {
+            const juce::ScopedLock sl(cacheLock);
+            auto it = modelDigests.find(path);
+            if (it != modelDigests.end() && it->second.size == size && it->second.modified == modified)
+            {
+                combined << it->second.digest;
+                continue;
+            }
+        }
+        
+        // Hash outside the lock; model files can be hundreds of megabytes
+        auto digest = juce::SHA256(file).toHexString();
+        
+        {
+            const juce::ScopedLock sl(cacheLock);
+            modelDigests[path] = { size, modified, digest };
+        }
+        
+        combined << digest;
+    }
+    
+    return modelPaths.size() == 1 ? combined : juce::SHA256(combined.toUTF8()).toHexString();
+}
+
+//==============================================================================
+VocalRenderCache::RenderedAudio VocalRenderCache::find(const juce::String& key)
+{
+    {
+        const juce::ScopedLock sl(cacheLock);
+        
+        auto it = lruIndex.find(key);
+        if (it != lruIndex.end())
+        {
+            lruList.splice(lruList.begin(), lruList, it->second);
+            ++hitCount;
+            return it->second->audio;
+        }
+        
+        if (!diskCacheEnabled)
+        {
+            ++missCount;
+            return nullptr;
+        }
+    }
+    
+    auto audio = diskStore.read(key);
+    if (audio == nullptr)
+    {
+        ++missCount;
+        return nullptr;
+    }
+    
+    ++hitCount;
+    
+    const juce::ScopedLock sl(cacheLock);
+    return insertIntoMemory(key, std::move(audio));
+}
+
+VocalRenderCache::RenderedAudio VocalRenderCache::store(const juce::String& key,
+                                                        const juce::AudioBuffer<float>& audio,
+                                                        double sampleRate)
+{
+    auto copy = std::make_shared<juce::AudioBuffer<float>>();
+    copy->makeCopyOf(audio);
+    RenderedAudio shared = std::move(copy);
+    
+    bool writeToDisk;
+    {
+        const juce::ScopedLock sl(cacheLock);
+        shared = insertIntoMemory(key, shared);
+        writeToDisk = diskCacheEnabled;
+    }
+    
+    // 32-bit float, so a render read back is bit-identical
+    if (writeToDisk && diskStore.store(key, *shared, sampleRate, 32) == juce::File())
+    {
+        Logger::log(Logger::Level::Warning,
+                    "Failed to write vocal render to disk cache: " + key);
+    }
+    
+    return shared;
+}
+
+//==============================================================================
+void VocalRenderCache::setMemoryBudget(size_t bytes)
+{
+    const juce::ScopedLock sl(cacheLock);
+    memoryBudget = bytes;
+    evictToBudget();
+}
+
+size_t VocalRenderCache::getMemoryUsage() const
+{
+    const juce::ScopedLock sl(cacheLock);
+    return memoryUsage;
+}
+
+void VocalRenderCache::setDiskCacheDirectory(const juce::File& directory)
+{
+    diskStore.setDirectory(directory);
+}
+
+juce::File VocalRenderCache::getDiskCacheDirectory() const
+{
+    return diskStore.getDirectory();
+}
+
+void VocalRenderCache::setDiskCacheEnabled(bool enabled)
+{
+    const juce::ScopedLock sl(cacheLock);
+    diskCacheEnabled = enabled;
+}
+
+void VocalRenderCache::clearMemory()
+{
+    const juce::ScopedLock sl(cacheLock);
+    lruIndex.clear();
+    lruList.clear();
+    memoryUsage = 0;
+}
+
+void VocalRenderCache::clearDisk()
+{
+    const auto directory = getDiskCacheDirectory();
+    if (!directory.isDirectory())
+        return;
+    
+    diskStore.clear();
+    
+    juce::Array<juce::File> files;
+    directory.findChildFiles(files, juce::File::findFiles, false,
+                             juce::String("*") + LEGACY_RENDER_FILE_EXTENSION);
+    
+    for (auto& file : files)
+        file.deleteFile();
+}
+
+//==============================================================================
+VocalRenderCache::RenderedAudio VocalRenderCache::insertIntoMemory(const juce::String& key,
+                                                                   RenderedAudio audio)
+{
+    auto it = lruIndex.find(key);
+    if (it != lruIndex.end())
+    {
+        memoryUsage -= it->second->bytes;
+        lruList.erase(it->second);
+        lruIndex.erase(it);
+    }
+    
+    const size_t bytes = getBufferBytes(*audio);
+    lruList.push_front({ key, audio, bytes });
+    lruIndex[key] = lruList.begin();
+    memoryUsage += bytes;
+    
+    evictToBudget();
+    return audio;
+}
+
+void VocalRenderCache::evictToBudget()
+{
+    // Keep at least the newest render even if it alone exceeds the budget
+    while (memoryUsage > memoryBudget && lruList.size() > 1)
+    {
+        auto& oldest = lruList.back();
+        memoryUsage -= oldest.bytes;
+        lruIndex.erase(oldest.key);
+        lruList.pop_back();
+    }
+}
+
+size_t VocalRenderCache::getBufferBytes(const juce::AudioBuffer<float>& audio)
+{
+    return static_cast<size_t>(audio.getNumChannels())
+         * static_cast<size_t>(audio.getNumSamples()) * sizeof(float);
+}
+
+} // namespace MAEVN
@@ -0,0 +1,173 @@
+/**
+ * @file VocalRenderCache.h
+ * @brief Content-addressed cache for rendered vocal (TTS + vocoder) audio
+ *
+ * Vocal blocks are synthesized by the vocal_tts and vocal_hifigan models,
+ * which is far too slow to repeat on every playback and export. Renders
+ * are keyed by a hash of everything that affects the output (block
+ * content, model files, BPM, sample rate, parameters) and kept in a
+ * memory tier with an LRU byte budget, backed by an AudioAssetStore of
+ * float WAV files on disk with a budget of its own.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include "Utilities.h"
+#include "AudioAssetStore.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Two-tier (memory LRU + disk) cache of rendered vocal audio
+ *
+ * All methods are thread-safe; none of them are realtime-safe.
+ */
+class VocalRenderCache
+{
+public:
+    using RenderedAudio = std::shared_ptr<const juce::AudioBuffer<float>>;
+    
+    VocalRenderCache();
+    ~VocalRenderCache();
+    
+    /**
+     * @brief Build the cache key of a vocal render
+     * @param block Vocal block (type, content and duration are hashed)
+     * @param modelHash Hash of the model files (see getModelHash())
+     * @param bpm Tempo the block was rendered at
+     * @param sampleRate Render sample rate
+     * @param parameters Any further render parameters, serialized
+     * @return Hex SHA-256 digest
+     */
+    static juce::String makeKey(const TimelineBlock& block,
+                                const juce::String& modelHash,
+                                double bpm,
+                                double sampleRate,
+                                const juce::String& parameters = {});
+    
+    /**
+     * @brief Hash the contents of a set of model files
+     *
+     * Digests are remembered per file until its size or modification time
+     * changes, so only the first call after a model update reads the file.
+     * @return Empty if any file is missing
+     */
+    juce::String getModelHash(const juce::StringArray& modelPaths);
+    
+    /**
+     * @brief Look up a render, promoting disk hits into memory
+     * @return nullptr on a miss
+     */
+    RenderedAudio find(const juce::String& key);
+    
+    /**
+     * @brief Store a render in memory and (if enabled) on disk
+     * @param sampleRate Rate the render was made at, for the disk file's header
+     * @return The shared cached copy
+     */
+    RenderedAudio store(const juce::String& key, const juce::AudioBuffer<float>& audio, double sampleRate);
+    
+    /**
+     * @brief Set the memory tier budget in bytes (evicts immediately)
+     */
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const { return memoryBudget; }
+    
+    /**
+     * @brief Get the bytes currently held by the memory tier
+     */
+    size_t getMemoryUsage() const;
+    
+    /**
+     * @brief Set the directory of the disk tier
+     */
+    void setDiskCacheDirectory(const juce::File& directory);
+    juce::File getDiskCacheDirectory() const;
+    
+    /**
+     * @brief Enable/disable the disk tier
+     */
+    void setDiskCacheEnabled(bool enabled);
+    bool isDiskCacheEnabled() const { return diskCacheEnabled; }
+    
+    /**
+     * @brief Set the disk tier budget in bytes (evicts immediately)
+     */
+    void setDiskBudget(juce::int64 bytes) { diskStore.setDiskBudget(bytes); }
+    juce::int64 getDiskBudget() const { return diskStore.getDiskBudget(); }
+    
+    /**
+     * @brief Get the bytes currently used by the disk tier
+     */
+    juce::int64 getDiskUsage() const { return diskStore.getDiskUsage(); }
+    
+    /**
+     * @brief Drop every render held in memory
+     */
+    void clearMemory();
+    
+    /**
+     * @brief Delete every render file of the disk tier
+     */
+    void clearDisk();
+    
+    /**
+     * @brief Get hit/miss counters (disk hits count as hits)
+     */
+    int getHitCount() const { return hitCount; }
+    int getMissCount() const { return missCount; }
+
+private:
+    struct MemoryEntry
+    {
+        juce::String key;
+        RenderedAudio audio;
+        size_t bytes;
+    };
+    
+    struct ModelFileDigest
+    {
+        juce::int64 size;
+        juce::Time modified;
+        juce::String digest;
+    };
+    
+    // Most recently used first
+    std::list<MemoryEntry> lruList;
+    std::unordered_map<juce::String, std::list<MemoryEntry>::iterator> lruIndex;
+    size_t memoryUsage;
+    size_t memoryBudget;
+    
+    AudioAssetStore diskStore;
+    bool diskCacheEnabled;
+    
+    std::unordered_map<juce::String, ModelFileDigest> modelDigests;
+    
+    std::atomic<int> hitCount;
+    std::atomic<int> missCount;
+    
+    mutable juce::CriticalSection cacheLock;
+    
+    /**
+     * @brief Insert into the memory tier and evict down to the budget
+     */
+    RenderedAudio insertIntoMemory(const juce::String& key, RenderedAudio audio);
+    
+    /**
+     * @brief Evict least recently used renders until under the budget
+     */
+    void evictToBudget();
+    
+    static size_t getBufferBytes(const juce::AudioBuffer<float>& audio);
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VocalRenderCache)
+};
+
+} // namespace MAEVN
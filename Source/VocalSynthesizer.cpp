@@ -0,0 +1,76 @@
+/**
+ * @file VocalSynthesizer.cpp
+ * @brief Implementation of cached vocal synthesis
+ */
+
+#include "VocalSynthesizer.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+VocalSynthesizer::VocalSynthesizer(OnnxEngine& engine, VocalRenderCache& cache)
+    : onnxEngine(engine)
+    , renderCache(cache)
+{
+}
+
+VocalRenderCache::RenderedAudio VocalSynthesizer::render(const TimelineBlock& block, double bpm, double sampleRate)
+{
+    if (!isVocalBlockType(block.type) || block.content.trim().isEmpty())
+        return nullptr;
+    
+    const auto modelHash = renderCache.getModelHash({ onnxEngine.getModelPath("vocal_tts"),
+                                                      onnxEngine.getModelPath("vocal_hifigan") });
+    if (modelHash.isEmpty())
+        return nullptr;
+    
+    const auto key = VocalRenderCache::makeKey(block, modelHash, bpm, sampleRate);
+    
+    if (auto cached = renderCache.find(key))
+        return cached;
+    
+    juce::AudioBuffer<float> audio;
+    if (!synthesize(block, sampleRate, audio))
+        return nullptr;
+    
+    return renderCache.store(key, audio, sampleRate);
+}
+
+bool VocalSynthesizer::synthesize(const TimelineBlock& block, double sampleRate, juce::AudioBuffer<float>& audio)
+{
+    if (!onnxEngine.isModelReady("vocal_tts") || !onnxEngine.isModelReady("vocal_hifigan"))
+        return false;
+    
+    // Character-level input to the acoustic model
+    std::vector<float> tokens;
+    for (auto ptr = block.content.getCharPointer(); !ptr.isEmpty(); ++ptr)
+        tokens.push_back(static_cast<float>(*ptr));
+    
+    std::vector<float> mel;
+    if (!onnxEngine.runInference("vocal_tts", tokens, { 1, static_cast<int64_t>(tokens.size()) }, mel))
+        return false;
+    
+    constexpr int MEL_BINS = 80;
+    const auto numFrames = static_cast<int64_t>(mel.size() / MEL_BINS);
+    if (numFrames == 0)
+        return false;
+    mel.resize(static_cast<size_t>(numFrames * MEL_BINS));
+    
+    std::vector<float> waveform;
+    if (!onnxEngine.runInference("vocal_hifigan", mel, { 1, MEL_BINS, numFrames }, waveform))
+        return false;
+    
+    // Fit the waveform to the block (mono vocoder output on both channels)
+    const int numSamples = static_cast<int>(block.duration * sampleRate);
+    const int numRendered = juce::jmin(numSamples, static_cast<int>(waveform.size()));
+    
+    audio.setSize(2, numSamples);
+    audio.clear();
+    for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+        audio.copyFrom(ch, 0, waveform.data(), numRendered);
+    
+    return true;
+}
+
+} // namespace MAEVN
@@ -0,0 +1,51 @@
+/**
+ * @file VocalSynthesizer.h
+ * @brief Renders vocal blocks through the TTS and vocoder models
+ *
+ * The lyrics of a vocal block go through the vocal_tts acoustic model and
+ * the vocal_hifigan vocoder. Renders are looked up in, and stored to, a
+ * VocalRenderCache, so the plugin's playback and exports and the headless
+ * render tool all share the same renders.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Utilities.h"
+#include "OnnxEngine.h"
+#include "VocalRenderCache.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Cached vocal synthesis for timeline blocks
+ *
+ * Thread-safe; not realtime-safe.
+ */
+class VocalSynthesizer
+{
+public:
+    VocalSynthesizer(OnnxEngine& onnxEngine, VocalRenderCache& renderCache);
+    
+    /**
+     * @brief Get the rendered audio of a vocal block, synthesizing on a cache miss
+     * @param bpm Tempo of the arrangement (part of the cache key)
+     * @return nullptr if the block is not vocal or the vocal models are not ready
+     */
+    VocalRenderCache::RenderedAudio render(const TimelineBlock& block, double bpm, double sampleRate);
+
+private:
+    /**
+     * @brief Run the vocal models over a block's lyrics
+     */
+    bool synthesize(const TimelineBlock& block, double sampleRate, juce::AudioBuffer<float>& audio);
+    
+    OnnxEngine& onnxEngine;
+    VocalRenderCache& renderCache;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VocalSynthesizer)
+};
+
+} // namespace MAEVN
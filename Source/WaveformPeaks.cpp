@@ -0,0 +1,258 @@
+/**
+ * @file WaveformPeaks.cpp
+ * @brief Implementation of the waveform peak pyramids and their cache
+ */
+
+#include "WaveformPeaks.h"
+
+namespace MAEVN
+{
+
+namespace
+{
+    void mergePeak(WaveformPeaks::Peak& peak, const WaveformPeaks::Peak& other)
+    {
+        peak.min = juce::jmin(peak.min, other.min);
+        peak.max = juce::jmax(peak.max, other.max);
+    }
+}
+
+//==============================================================================
+WaveformPeaks::WaveformPeaks(int length, double rate)
+    : lengthSamples(juce::jmax(0, length))
+    , sampleRate(rate)
+    , samplesAdded(0)
+{
+    // Halve until a single peak covers the whole buffer
+    int numPeaks = (lengthSamples + BASE_SAMPLES_PER_PEAK - 1) / BASE_SAMPLES_PER_PEAK;
+    while (numPeaks > 0 && static_cast<int>(levels.size()) < MAX_LEVELS)
+    {
+        levels.emplace_back(static_cast<size_t>(numPeaks));
+        if (numPeaks == 1)
+            break;
+        
+        numPeaks = (numPeaks + 1) / 2;
+    }
+}
+
+int WaveformPeaks::getLevelForSamplesPerPixel(double samplesPerPixel) const
+{
+    int level = 0;
+    while (level + 1 < getNumLevels() && getSamplesPerPeak(level + 1) <= samplesPerPixel)
+        ++level;
+    
+    return level;
+}
+
+bool WaveformPeaks::getPeakInRange(int level, juce::int64 startSample, juce::int64 endSample, Peak& result) const
+{
+    if (!juce::isPositiveAndBelow(level, getNumLevels()))
+        return false;
+    
+    const juce::int64 samplesPerPeak = getSamplesPerPeak(level);
+    const auto first = juce::jmax(static_cast<juce::int64>(0), startSample / samplesPerPeak);
+    const auto last = juce::jmin(static_cast<juce::int64>(getNumReadyPeaks(level)),
+                                 (endSample + samplesPerPeak - 1) / samplesPerPeak);
+    if (first >= last)
+        return false;
+    
+    const auto* peaks = getPeaks(level);
+    result = peaks[first];
+    for (auto i = first + 1; i < last; ++i)
+        mergePeak(result, peaks[i]);
+    
+    return true;
+}
+
+int WaveformPeaks::addSamples(const juce::AudioBuffer<float>& audio, int maxSamples)
+{
+    if (levels.empty())
+        return 0;
+    
+    const int end = juce::jmin(lengthSamples, audio.getNumSamples(), samplesAdded + juce::jmax(0, maxSamples));
+    const int added = end - samplesAdded;
+    
+    // Level 0: only whole peaks, except for the last one of the buffer
+    auto& base = levels[0];
+    int peak = readyPeaks[0].load(std::memory_order_relaxed);
+    
+    for (; peak < static_cast<int>(base.size()); ++peak)
+    {
+        const int start = peak * BASE_SAMPLES_PER_PEAK;
+        const int stop = juce::jmin(start + BASE_SAMPLES_PER_PEAK, lengthSamples);
+        if (stop > end)
+            break;
+        
+        Peak result { 0.0f, 0.0f };
+        for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax(audio.getReadPointer(ch, start), stop - start);
+            const Peak channelPeak { range.getStart(), range.getEnd() };
+            
+            if (ch == 0)
+                result = channelPeak;
+            else
+                mergePeak(result, channelPeak);
+        }
+        
+        base[static_cast<size_t>(peak)] = result;
+    }
+    
+    readyPeaks[0].store(peak, std::memory_order_release);
+    samplesAdded = end;
+    
+    // Each level above merges pairs of the one below as soon as both are ready
+    for (size_t level = 1; level < levels.size(); ++level)
+    {
+        const auto& below = levels[level - 1];
+        const int belowReady = readyPeaks[level - 1].load(std::memory_order_relaxed);
+        const int belowTotal = static_cast<int>(below.size());
+        auto& peaks = levels[level];
+        int ready = readyPeaks[level].load(std::memory_order_relaxed);
+        
+        for (; 2 * ready < belowReady; ++ready)
+        {
+            const int second = 2 * ready + 1;
+            if (second < belowTotal && second >= belowReady)
+                break;
+            
+            Peak result = below[static_cast<size_t>(2 * ready)];
+            if (second < belowTotal)
+                mergePeak(result, below[static_cast<size_t>(second)]);
+            
+            peaks[static_cast<size_t>(ready)] = result;
+        }
+        
+        readyPeaks[level].store(ready, std::memory_order_release);
+    }
+    
+    return added;
+}
+
+//==============================================================================
+WaveformPeakCache::WaveformPeakCache()
+    : juce::Thread("Waveform Peaks")
+{
+    startThread(juce::Thread::Priority::low);
+}
+
+WaveformPeakCache::~WaveformPeakCache()
+{
+    stopThread(2000);
+}
+
+juce::String WaveformPeakCache::makeKey(const TimelineBlock& block)
+{
+    // What the render depends on; the position is left out
+    return juce::String(static_cast<int>(block.type)) + ":" + juce::String(block.trackIndex) + ":"
+         + juce::String(block.duration, 6) + ":" + block.content;
+}
+
+void WaveformPeakCache::addRenderedAudio(const TimelineBlock& block, VocalRenderCache::RenderedAudio audio,
+                                         double sampleRate)
+{
+    if (audio == nullptr || audio->getNumSamples() == 0)
+        return;
+    
+    const auto key = makeKey(block);
+    
+    {
+        const juce::ScopedLock sl(lock);
+        
+        auto existing = entries.find(key);
+        if (existing != entries.end()
+            && !existing->second.source.owner_before(audio) && !audio.owner_before(existing->second.source))
+            return;
+        
+        if (existing == entries.end())
+        {
+            insertionOrder.push_back(key);
+            
+            while (static_cast<int>(insertionOrder.size()) > MAX_ENTRIES)
+            {
+                const auto oldest = insertionOrder.front();
+                insertionOrder.pop_front();
+                entries.erase(oldest);
+                buildQueue.erase(std::remove(buildQueue.begin(), buildQueue.end(), oldest), buildQueue.end());
+            }
+        }
+        
+        auto& entry = entries[key];
+        entry.peaks = std::make_shared<WaveformPeaks>(audio->getNumSamples(), sampleRate);
+        entry.audio = audio;
+        entry.source = audio;
+        
+        if (std::find(buildQueue.begin(), buildQueue.end(), key) == buildQueue.end())
+            buildQueue.push_back(key);
+    }
+    
+    version.fetch_add(1, std::memory_order_release);
+    notify();
+}
+
+WaveformPeakCache::Peaks WaveformPeakCache::find(const TimelineBlock& block) const
+{
+    const juce::ScopedLock sl(lock);
+    
+    const auto entry = entries.find(makeKey(block));
+    return entry != entries.end() ? entry->second.peaks : nullptr;
+}
+
+void WaveformPeakCache::clear()
+{
+    const juce::ScopedLock sl(lock);
+    
+    entries.clear();
+    insertionOrder.clear();
+    buildQueue.clear();
+    version.fetch_add(1, std::memory_order_release);
+}
+
+void WaveformPeakCache::run()
+{
+    while (!threadShouldExit())
+    {
+        juce::String key;
+        std::shared_ptr<WaveformPeaks> peaks;
+        VocalRenderCache::RenderedAudio audio;
+        
+        {
+            const juce::ScopedLock sl(lock);
+            
+            if (!buildQueue.empty())
+            {
+                key = buildQueue.front();
+                const auto& entry = entries.at(key);
+                peaks = entry.peaks;
+                audio = entry.audio;
+            }
+        }
+        
+        if (peaks == nullptr)
+        {
+            wait(-1);
+            continue;
+        }
+        
+        // Built outside the lock; the UI reads only the peaks published so far
+        peaks->addSamples(*audio, CHUNK_SAMPLES);
+        version.fetch_add(1, std::memory_order_release);
+        
+        const juce::ScopedLock sl(lock);
+        
+        // Blocks take turns, so one long render doesn't hold up the rest
+        const auto queued = std::find(buildQueue.begin(), buildQueue.end(), key);
+        const auto entry = entries.find(key);
+        if (queued == buildQueue.end() || entry == entries.end() || entry->second.peaks != peaks)
+            continue;
+        
+        buildQueue.erase(queued);
+        
+        if (peaks->isComplete())
+            entry->second.audio = nullptr;
+        else
+            buildQueue.push_back(key);
+    }
+}
+
+} // namespace MAEVN
@@ -0,0 +1,166 @@
+/**
+ * @file WaveformPeaks.h
+ * @brief Multi-resolution min/max peaks of rendered blocks for drawing waveforms
+ *
+ * Level 0 of a pyramid holds the min and max of every BASE_SAMPLES_PER_PEAK
+ * samples and each level above halves the resolution of the one below, so
+ * a lane at any zoom reads one or two peaks per pixel instead of walking
+ * the samples. Pyramids are built on a background thread in runs of
+ * CHUNK_SAMPLES as rendered audio arrives from the render pipeline; a lane
+ * draws whatever part is ready and repaints the block when more comes in.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Utilities.h"
+#include "VocalRenderCache.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+/**
+ * @brief Min/max pyramid of one rendered buffer, across all of its channels
+ *
+ * Filled in order by one builder thread; peaks below getNumReadyPeaks() may
+ * be read from any thread while the rest are still being built.
+ */
+class WaveformPeaks
+{
+public:
+    static constexpr int BASE_SAMPLES_PER_PEAK = 32;
+    static constexpr int MAX_LEVELS = 20;
+    
+    struct Peak
+    {
+        float min = 0.0f;
+        float max = 0.0f;
+    };
+    
+    /**
+     * @brief Allocate every level for a buffer of a given length
+     */
+    WaveformPeaks(int lengthSamples, double sampleRate);
+    
+    int getLengthSamples() const { return lengthSamples; }
+    double getSampleRate() const { return sampleRate; }
+    
+    int getNumLevels() const { return static_cast<int>(levels.size()); }
+    int getSamplesPerPeak(int level) const { return BASE_SAMPLES_PER_PEAK << level; }
+    int getNumPeaks(int level) const { return static_cast<int>(levels[static_cast<size_t>(level)].size()); }
+    
+    /**
+     * @brief Peaks of a level built so far (any thread)
+     */
+    int getNumReadyPeaks(int level) const { return readyPeaks[static_cast<size_t>(level)].load(std::memory_order_acquire); }
+    
+    const Peak* getPeaks(int level) const { return levels[static_cast<size_t>(level)].data(); }
+    
+    /**
+     * @brief Coarsest level that still has a peak for every pixel
+     */
+    int getLevelForSamplesPerPixel(double samplesPerPixel) const;
+    
+    /**
+     * @brief Combined peak of a span of samples at a level, from the ready peaks only
+     * @return false if no ready peak covers the span
+     */
+    bool getPeakInRange(int level, juce::int64 startSample, juce::int64 endSample, Peak& result) const;
+    
+    bool isComplete() const { return samplesAdded >= lengthSamples; }
+    
+    /**
+     * @brief Add the next run of samples to every level (builder thread)
+     * @return Samples added
+     */
+    int addSamples(const juce::AudioBuffer<float>& audio, int maxSamples);
+
+private:
+    const int lengthSamples;
+    const double sampleRate;
+    
+    std::vector<std::vector<Peak>> levels;
+    std::array<std::atomic<int>, MAX_LEVELS> readyPeaks {};
+    int samplesAdded;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformPeaks)
+};
+
+//==============================================================================
+/**
+ * @brief Peak pyramids of the blocks the render pipeline has produced
+ *
+ * addRenderedAudio() may be called from any thread (the render-ahead worker
+ * feeds it); find() and getVersion() are for the editor. Blocks are matched
+ * by what their render depends on, not by position, so moving a block
+ * keeps its waveform.
+ */
+class WaveformPeakCache : private juce::Thread
+{
+public:
+    using Peaks = std::shared_ptr<const WaveformPeaks>;
+    
+    /** Samples built per turn before the next queued block gets one */
+    static constexpr int CHUNK_SAMPLES = 65536;
+    
+    /** Pyramids kept; the oldest are dropped first */
+    static constexpr int MAX_ENTRIES = 256;
+    
+    WaveformPeakCache();
+    ~WaveformPeakCache() override;
+    
+    /**
+     * @brief Queue the rendered audio of a block for a pyramid
+     *
+     * A block already holding a pyramid of the same audio is left alone;
+     * new audio (e.g. after a BPM change) replaces it.
+     */
+    void addRenderedAudio(const TimelineBlock& block, VocalRenderCache::RenderedAudio audio, double sampleRate);
+    
+    /**
+     * @brief Get a block's pyramid, possibly still being built
+     * @return nullptr if no audio has arrived for the block
+     */
+    Peaks find(const TimelineBlock& block) const;
+    
+    /**
+     * @brief Changes whenever any pyramid gains peaks, so the UI can poll cheaply
+     */
+    juce::uint32 getVersion() const { return version.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief Drop every pyramid and queued build
+     */
+    void clear();
+    
+    static juce::String makeKey(const TimelineBlock& block);
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<WaveformPeaks> peaks;
+        VocalRenderCache::RenderedAudio audio;                  // released once built
+        std::weak_ptr<const juce::AudioBuffer<float>> source;   // tells a new render from the same one
+    };
+    
+    void run() override;
+    
+    mutable juce::CriticalSection lock;
+    std::unordered_map<juce::String, Entry> entries;   // guarded by lock
+    std::deque<juce::String> insertionOrder;            // guarded by lock
+    std::deque<juce::String> buildQueue;                // guarded by lock
+    
+    std::atomic<juce::uint32> version { 0 };
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformPeakCache)
+};
+
+} // namespace MAEVN
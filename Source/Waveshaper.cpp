@@ -0,0 +1,206 @@
+/**
+ * @file Waveshaper.cpp
+ * @brief Implementation of the shared saturation engine
+ */
+
+#include "Waveshaper.h"
+
+namespace MAEVN
+{
+
+namespace
+{
+    // [7/6] Lambert continued fraction of tanh; it reaches 1.0 at this input,
+    // so clamping here bounds the error by 1 - tanh(4.97) < 1e-4
+    constexpr float TANH_CLAMP = 4.97f;
+    
+    inline float rationalTanh(float x)
+    {
+        x = std::min(std::max(x, -TANH_CLAMP), TANH_CLAMP);
+        const float x2 = x * x;
+        const float numerator = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+        const float denominator = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f));
+        return std::min(std::max(numerator / denominator, -1.0f), 1.0f);
+    }
+}
+
+//==============================================================================
+Waveshaper::Waveshaper()
+    : preparedChannels(0)
+    , activeOrder(0)
+    , historyMask(0)
+    , historyWritePos(0)
+{
+}
+
+Waveshaper::~Waveshaper()
+{
+}
+
+void Waveshaper::prepare(double /*sampleRate*/, int maxBlockSize, int numChannels)
+{
+    preparedChannels = juce::jmax(1, numChannels);
+    
+    for (size_t i = 0; i < oversamplers.size(); ++i)
+    {
+        // Integer latency so the host can compensate it exactly
+        oversamplers[i] = std::make_unique<juce::dsp::Oversampling<float>>(
+            static_cast<size_t>(preparedChannels), i + 1,
+            juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, true);
+        oversamplers[i]->initProcessing(static_cast<size_t>(maxBlockSize));
+    }
+    
+    // Room for a block plus the longest delay a lower order makes up
+    const int historySize = juce::nextPowerOfTwo(maxBlockSize + getLatencySamples(4) + 1);
+    inputHistory.setSize(preparedChannels, historySize);
+    inputHistory.clear();
+    historyMask = historySize - 1;
+    historyWritePos = 0;
+    
+    transitionBuffer.setSize(preparedChannels, maxBlockSize);
+    
+    activeOrder = juce::jmin(oversamplingOrder.load(), oversamplingLimit.load());
+}
+
+void Waveshaper::reset()
+{
+    for (auto& oversampler : oversamplers)
+    {
+        if (oversampler != nullptr)
+            oversampler->reset();
+    }
+    
+    inputHistory.clear();
+}
+
+int Waveshaper::getLatencySamples(int factor) const
+{
+    const int order = getOrder(factor);
+    if (order == 0 || oversamplers[static_cast<size_t>(order - 1)] == nullptr)
+        return 0;
+    
+    return juce::roundToInt(oversamplers[static_cast<size_t>(order - 1)]->getLatencyInSamples());
+}
+
+void Waveshaper::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const float in = inputGain.load(std::memory_order_relaxed);
+    const float out = outputGain.load(std::memory_order_relaxed);
+    const int setOrder = oversamplingOrder.load(std::memory_order_relaxed);
+    const int order = juce::jmin(setOrder, oversamplingLimit.load(std::memory_order_relaxed));
+    const int numChannels = juce::jmin(buffer.getNumChannels(), preparedChannels);
+    
+    if (setOrder == 0 && activeOrder == 0)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            saturate(buffer.getWritePointer(ch), numSamples, in, out);
+        return;
+    }
+    
+    // Always kept, so a lower order can start at any block
+    pushHistory(buffer, numChannels, numSamples);
+    
+    if (order == activeOrder)
+    {
+        processPath(buffer, numChannels, numSamples, order, setOrder, in, out);
+        return;
+    }
+    
+    // Run the old and new order side by side and crossfade; the new
+    // order's filters have been idle, so they start clean
+    if (order > 0)
+        oversamplers[static_cast<size_t>(order - 1)]->reset();
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+        transitionBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+    
+    processPath(transitionBuffer, numChannels, numSamples, order, setOrder, in, out);
+    processPath(buffer, numChannels, numSamples, activeOrder, setOrder, in, out);
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        buffer.applyGainRamp(ch, 0, numSamples, 1.0f, 0.0f);
+        buffer.addFromWithRamp(ch, 0, transitionBuffer.getReadPointer(ch), numSamples, 0.0f, 1.0f);
+    }
+    
+    activeOrder = order;
+}
+
+void Waveshaper::processPath(juce::AudioBuffer<float>& buffer, int numChannels, int numSamples, int order,
+                             int setOrder, float in, float out)
+{
+    // The shaper is memoryless, so delaying its input delays its output
+    const int delay = getLatencySamples(1 << setOrder) - getLatencySamples(1 << order);
+    if (delay > 0)
+        readHistory(buffer, numChannels, numSamples, delay);
+    
+    processAtOrder(buffer, numChannels, numSamples, order, in, out);
+}
+
+void Waveshaper::processAtOrder(juce::AudioBuffer<float>& buffer, int numChannels, int numSamples, int order,
+                                float in, float out)
+{
+    auto* oversampler = order > 0 ? oversamplers[static_cast<size_t>(order - 1)].get() : nullptr;
+    
+    if (oversampler == nullptr)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            saturate(buffer.getWritePointer(ch), numSamples, in, out);
+        return;
+    }
+    
+    juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(),
+                                       static_cast<size_t>(numChannels),
+                                       static_cast<size_t>(numSamples));
+    auto upsampled = oversampler->processSamplesUp(block);
+    
+    for (size_t ch = 0; ch < upsampled.getNumChannels(); ++ch)
+        saturate(upsampled.getChannelPointer(ch), static_cast<int>(upsampled.getNumSamples()), in, out);
+    
+    oversampler->processSamplesDown(block);
+}
+
+void Waveshaper::pushHistory(const juce::AudioBuffer<float>& buffer, int numChannels, int numSamples)
+{
+    const int size = historyMask + 1;
+    const int first = juce::jmin(numSamples, size - historyWritePos);
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        inputHistory.copyFrom(ch, historyWritePos, buffer, ch, 0, first);
+        if (first < numSamples)
+            inputHistory.copyFrom(ch, 0, buffer, ch, first, numSamples - first);
+    }
+    
+    historyWritePos = (historyWritePos + numSamples) & historyMask;
+}
+
+void Waveshaper::readHistory(juce::AudioBuffer<float>& buffer, int numChannels, int numSamples, int delaySamples) const
+{
+    const int size = historyMask + 1;
+    const int start = (historyWritePos - numSamples - delaySamples + 2 * size) & historyMask;
+    const int first = juce::jmin(numSamples, size - start);
+    
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        buffer.copyFrom(ch, 0, inputHistory, ch, start, first);
+        if (first < numSamples)
+            buffer.copyFrom(ch, first, inputHistory, ch, 0, numSamples - first);
+    }
+}
+
+//==============================================================================
+void Waveshaper::saturate(float* data, int numSamples, float inputGain, float outputGain)
+{
+    // Branch-free over contiguous samples so the compiler emits packed
+    // SSE/AVX/NEON min, max, multiply and divide for the whole loop
+    for (int i = 0; i < numSamples; ++i)
+        data[i] = rationalTanh(data[i] * inputGain) * outputGain;
+}
+
+float Waveshaper::fastTanh(float x)
+{
+    return rationalTanh(x);
+}
+
+} // namespace MAEVN
@@ -0,0 +1,184 @@
+/**
+ * @file GlobalUndoManagerTests.cpp
+ * @brief Delta-encoded undo history: every snapshot rebuilds exactly, undo/redo
+ * hand back the right states, and trimming to the budget keeps the newest
+ */
+
+#include <JuceHeader.h>
+#include <vector>
+#include "GlobalUndoManager.h"
+
+namespace MAEVN
+{
+
+namespace
+{
+    /**
+     * @brief A timeline-like state that changes a little from step to step
+     *
+     * Blocks are edited, appended and removed, and a property changes type,
+     * so every kind of delta is produced along the way.
+     */
+    juce::var makeTimelineState(int step)
+    {
+        juce::Array<juce::var> blocks;
+        const int numBlocks = 8 + (step % 5);
+        
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            auto* block = new juce::DynamicObject();
+            block->setProperty("type", i % 3);
+            block->setProperty("start", i * 4.0 + (i == step % numBlocks ? 0.5 : 0.0));
+            block->setProperty("duration", 4.0);
+            block->setProperty("content", "Line " + juce::String(i) + (i == 2 ? " v" + juce::String(step / 4) : ""));
+            blocks.add(juce::var(block));
+        }
+        
+        auto* state = new juce::DynamicObject();
+        state->setProperty("bpm", 120 + step % 7);
+        state->setProperty("blocks", blocks);
+        state->setProperty("marker", step % 10 == 0 ? juce::var("intro") : juce::var(step));
+        return juce::var(state);
+    }
+
+    juce::var makeFXState(int step)
+    {
+        auto* state = new juce::DynamicObject();
+        state->setProperty("track", step % 6);
+        state->setProperty("mode", step % 4);
+        state->setProperty("mix", step * 0.01);
+        return juce::var(state);
+    }
+
+    bool sameJSON(const juce::var& a, const juce::var& b)
+    {
+        return juce::JSON::toString(a, true) == juce::JSON::toString(b, true);
+    }
+}
+
+//==============================================================================
+class GlobalUndoManagerTests : public juce::UnitTest
+{
+public:
+    GlobalUndoManagerTests() : juce::UnitTest("GlobalUndoManager", "MAEVN") {}
+    
+    void runTest() override
+    {
+        beginTest("Every snapshot rebuilds exactly from keyframes and deltas");
+        {
+            GlobalUndoManager manager;
+            const auto expected = fillHistory(manager);
+            
+            expectEquals(manager.getHistorySize(), static_cast<int>(expected.size()));
+            
+            for (int i = 0; i < manager.getHistorySize(); ++i)
+            {
+                const auto action = manager.getHistoryAction(i);
+                expect(action.type == expected[static_cast<size_t>(i)].type);
+                expectEquals(action.description, expected[static_cast<size_t>(i)].description);
+                expect(sameJSON(action.stateData, expected[static_cast<size_t>(i)].stateData),
+                       "state " + juce::String(i) + " differs");
+            }
+        }
+        
+        beginTest("Undo and redo hand back the states that were added");
+        {
+            GlobalUndoManager manager;
+            const auto expected = fillHistory(manager);
+            
+            int nextUndo = static_cast<int>(expected.size()) - 1;
+            int nextRedo = 0;
+            bool statesMatch = true;
+            
+            manager.setUndoCallback([&](const ActionState& action)
+            {
+                statesMatch = statesMatch && sameJSON(action.stateData, expected[static_cast<size_t>(nextUndo)].stateData);
+                --nextUndo;
+            });
+            
+            manager.setRedoCallback([&](const ActionState& action)
+            {
+                statesMatch = statesMatch && sameJSON(action.stateData, expected[static_cast<size_t>(nextRedo)].stateData);
+                ++nextRedo;
+            });
+            
+            while (manager.undo()) {}
+            expectEquals(nextUndo, -1);
+            expect(!manager.canUndo());
+            
+            while (manager.redo()) {}
+            expectEquals(nextRedo, static_cast<int>(expected.size()));
+            expect(!manager.canRedo());
+            
+            expect(statesMatch);
+        }
+        
+        beginTest("A new action after undo drops the redo tail");
+        {
+            GlobalUndoManager manager;
+            const auto expected = fillHistory(manager);
+            
+            for (int i = 0; i < 10; ++i)
+                manager.undo();
+            
+            const auto replacement = makeTimelineState(1000);
+            manager.addAction(ActionState(ActionState::Type::TimelineChange, "Replacement", replacement));
+            
+            const int size = manager.getHistorySize();
+            expectEquals(size, static_cast<int>(expected.size()) - 9);
+            expect(!manager.canRedo());
+            expect(sameJSON(manager.getHistoryAction(size - 1).stateData, replacement));
+            expect(sameJSON(manager.getHistoryAction(size - 2).stateData,
+                            expected[static_cast<size_t>(size - 2)].stateData));
+        }
+        
+        beginTest("Trimming to the budget keeps the newest snapshots intact");
+        {
+            GlobalUndoManager manager;
+            const auto expected = fillHistory(manager);
+            
+            const size_t budget = manager.getMemoryUsage() / 4;
+            manager.setMemoryBudget(budget);
+            
+            const int size = manager.getHistorySize();
+            expect(size > 0 && size < static_cast<int>(expected.size()));
+            expect(manager.getMemoryUsage() <= budget || size == 1);
+            
+            // The surviving entries are the newest ones, still rebuildable
+            const size_t firstKept = expected.size() - static_cast<size_t>(size);
+            for (int i = 0; i < size; ++i)
+            {
+                expect(sameJSON(manager.getHistoryAction(i).stateData, expected[firstKept + static_cast<size_t>(i)].stateData),
+                       "trimmed state " + juce::String(i) + " differs");
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief Add interleaved timeline and FX actions; more timeline actions than
+     * KEYFRAME_INTERVAL, so delta chains restart from a keyframe
+     */
+    static std::vector<ActionState> fillHistory(GlobalUndoManager& manager)
+    {
+        std::vector<ActionState> added;
+        const int numTimelineActions = GlobalUndoManager::KEYFRAME_INTERVAL * 2 + 5;
+        
+        for (int step = 0; step < numTimelineActions; ++step)
+        {
+            added.emplace_back(ActionState::Type::TimelineChange, "Timeline " + juce::String(step), makeTimelineState(step));
+            
+            if (step % 4 == 0)
+                added.emplace_back(ActionState::Type::FXChange, "FX " + juce::String(step), makeFXState(step));
+        }
+        
+        for (const auto& action : added)
+            manager.addAction(action);
+        
+        return added;
+    }
+};
+
+static GlobalUndoManagerTests globalUndoManagerTests;
+
+} // namespace MAEVN
@@ -0,0 +1,136 @@
+/**
+ * @file LoudnessMeterTests.cpp
+ * @brief LoudnessMeter against the EBU Tech 3341 minimum requirements
+ *
+ * Cases 1-5 of EBU Tech 3341 (stereo 1 kHz sines at 48 kHz) expect
+ * integrated loudness within +-0.1 LU of the stated value; cases 3-5
+ * exercise the absolute and relative gates.
+ */
+
+#include <JuceHeader.h>
+#include <utility>
+#include <vector>
+#include "LoudnessMeter.h"
+
+namespace MAEVN
+{
+
+namespace
+{
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr double TONE_HZ = 1000.0;
+    constexpr float TOLERANCE_LU = 0.1f;
+
+    /**
+     * @brief Stereo 1 kHz sine, one segment per (dBFS, seconds) pair, phase continuous
+     */
+    juce::AudioBuffer<float> makeTone(const std::vector<std::pair<float, double>>& segments)
+    {
+        int totalSamples = 0;
+        for (const auto& segment : segments)
+            totalSamples += juce::roundToInt(segment.second * SAMPLE_RATE);
+        
+        juce::AudioBuffer<float> buffer(2, totalSamples);
+        const double increment = juce::MathConstants<double>::twoPi * TONE_HZ / SAMPLE_RATE;
+        int position = 0;
+        
+        for (const auto& segment : segments)
+        {
+            const float amplitude = juce::Decibels::decibelsToGain(segment.first, -200.0f);
+            const int length = juce::roundToInt(segment.second * SAMPLE_RATE);
+            
+            for (int i = 0; i < length; ++i, ++position)
+            {
+                const auto sample = static_cast<float>(amplitude * std::sin(increment * position));
+                buffer.setSample(0, position, sample);
+                buffer.setSample(1, position, sample);
+            }
+        }
+        
+        return buffer;
+    }
+}
+
+//==============================================================================
+class LoudnessMeterTests : public juce::UnitTest
+{
+public:
+    LoudnessMeterTests() : juce::UnitTest("LoudnessMeter", "MAEVN") {}
+    
+    void runTest() override
+    {
+        beginTest("EBU 3341 case 1: -23 dBFS sine reads -23 LUFS");
+        expectIntegrated({ { -23.0f, 20.0 } }, -23.0f);
+        
+        beginTest("EBU 3341 case 2: -33 dBFS sine reads -33 LUFS");
+        expectIntegrated({ { -33.0f, 20.0 } }, -33.0f);
+        
+        beginTest("EBU 3341 case 3: relative gate drops the quiet ends");
+        expectIntegrated({ { -36.0f, 10.0 }, { -23.0f, 60.0 }, { -36.0f, 10.0 } }, -23.0f);
+        
+        beginTest("EBU 3341 case 4: absolute and relative gates");
+        expectIntegrated({ { -72.0f, 10.0 }, { -36.0f, 10.0 }, { -23.0f, 60.0 },
+                           { -36.0f, 10.0 }, { -72.0f, 10.0 } }, -23.0f);
+        
+        beginTest("EBU 3341 case 5: level changes average to -23 LUFS");
+        expectIntegrated({ { -26.0f, 20.0 }, { -20.0f, 20.1 }, { -26.0f, 20.0 } }, -23.0f);
+        
+        beginTest("Streaming meter matches the offline measurement");
+        {
+            const auto tone = makeTone({ { -23.0f, 20.0 } });
+            
+            LoudnessMeter meter;
+            meter.prepare(SAMPLE_RATE, 2);
+            
+            // An odd block size, so sub-blocks straddle process() calls
+            constexpr int blockSize = 471;
+            juce::AudioBuffer<float> block(2, blockSize);
+            
+            for (int start = 0; start < tone.getNumSamples(); start += blockSize)
+            {
+                const int numSamples = juce::jmin(blockSize, tone.getNumSamples() - start);
+                for (int ch = 0; ch < 2; ++ch)
+                    block.copyFrom(ch, 0, tone, ch, start, numSamples);
+                
+                meter.process(block, numSamples);
+            }
+            
+            expectWithinAbsoluteError(meter.getMomentaryLUFS(), -23.0f, TOLERANCE_LU);
+            expectWithinAbsoluteError(meter.getShortTermLUFS(), -23.0f, TOLERANCE_LU);
+            expectWithinAbsoluteError(meter.getIntegratedLUFS(), -23.0f, TOLERANCE_LU);
+        }
+        
+        beginTest("Silence reads the minimum");
+        {
+            juce::AudioBuffer<float> silence(2, static_cast<int>(SAMPLE_RATE * 5));
+            silence.clear();
+            expectEquals(LoudnessMeter::measureIntegratedLUFS(silence, SAMPLE_RATE), LoudnessMeter::MINIMUM_LUFS);
+        }
+        
+        beginTest("reset() clears every measurement");
+        {
+            const auto tone = makeTone({ { -23.0f, 5.0 } });
+            
+            LoudnessMeter meter;
+            meter.prepare(SAMPLE_RATE, 2);
+            meter.process(tone, tone.getNumSamples());
+            meter.reset();
+            
+            expectEquals(meter.getMomentaryLUFS(), LoudnessMeter::MINIMUM_LUFS);
+            expectEquals(meter.getShortTermLUFS(), LoudnessMeter::MINIMUM_LUFS);
+            expectEquals(meter.getIntegratedLUFS(), LoudnessMeter::MINIMUM_LUFS);
+        }
+    }
+
+private:
+    void expectIntegrated(const std::vector<std::pair<float, double>>& segments, float expectedLUFS)
+    {
+        const auto tone = makeTone(segments);
+        expectWithinAbsoluteError(LoudnessMeter::measureIntegratedLUFS(tone, SAMPLE_RATE),
+                                  expectedLUFS, TOLERANCE_LU);
+    }
+};
+
+static LoudnessMeterTests loudnessMeterTests;
+
+} // namespace MAEVN
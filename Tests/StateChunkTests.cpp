@@ -0,0 +1,162 @@
+/**
+ * @file StateChunkTests.cpp
+ * @brief StateChunkWriter / StateChunkReader round trip and rejection of bad data
+ */
+
+#include <JuceHeader.h>
+#include <cstring>
+#include "StateChunk.h"
+
+namespace MAEVN
+{
+
+//==============================================================================
+class StateChunkTests : public juce::UnitTest
+{
+public:
+    StateChunkTests() : juce::UnitTest("StateChunk", "MAEVN") {}
+    
+    void runTest() override
+    {
+        beginTest("Sections round-trip with their versions");
+        {
+            juce::MemoryBlock chunk;
+            writeTestChunk(chunk);
+            
+            StateChunkReader reader(chunk.getData(), chunk.getSize());
+            expect(reader.isValid());
+            
+            expectEquals(reader.getSectionVersion(StateSection::ProcessorParams), 3);
+            expectEquals(reader.getSectionVersion(StateSection::Timeline), 1);
+            expectEquals(reader.getSectionVersion(StateSection::FXChains), 2);
+            
+            auto params = reader.createSectionStream(StateSection::ProcessorParams);
+            expect(params != nullptr);
+            if (params != nullptr)
+            {
+                expectEquals(params->readDouble(), 128.0);
+                expectEquals(params->readInt(), 42);
+                expect(params->readBool());
+                expect(params->isExhausted());
+            }
+            
+            auto timeline = reader.createSectionStream(StateSection::Timeline);
+            expect(timeline != nullptr);
+            if (timeline != nullptr)
+            {
+                expectEquals(timeline->readString(), juce::String("Verse"));
+                expectEquals(timeline->readString(), juce::String("Hook"));
+                expect(timeline->isExhausted());
+            }
+            
+            // An empty payload is still a section
+            expect(reader.hasSection(StateSection::FXChains));
+            expectEquals(static_cast<int>(reader.copySection(StateSection::FXChains).getSize()), 0);
+        }
+        
+        beginTest("Missing sections are reported as missing");
+        {
+            juce::MemoryBlock chunk;
+            writeTestChunk(chunk);
+            
+            StateChunkReader reader(chunk.getData(), chunk.getSize());
+            expect(!reader.hasSection(StateSection::SequencerPatterns));
+            expectEquals(reader.getSectionVersion(StateSection::SequencerPatterns), 0);
+            expect(reader.createSectionStream(StateSection::SequencerPatterns) == nullptr);
+            expectEquals(static_cast<int>(reader.copySection(StateSection::SequencerPatterns).getSize()), 0);
+        }
+        
+        beginTest("Copied sections can be written back untouched");
+        {
+            juce::MemoryBlock original;
+            writeTestChunk(original);
+            StateChunkReader reader(original.getData(), original.getSize());
+            
+            StateChunkWriter writer;
+            for (auto id : { StateSection::ProcessorParams, StateSection::Timeline, StateSection::FXChains })
+                writer.addSection(id, reader.getSectionVersion(id), reader.copySection(id));
+            
+            juce::MemoryBlock rewritten;
+            writer.writeTo(rewritten);
+            expect(rewritten == original);
+        }
+        
+        beginTest("Unknown sections are skipped");
+        {
+            StateChunkWriter writer;
+            juce::MemoryOutputStream(writer.addSection(static_cast<StateSection>(99), 7), false).writeInt(-1);
+            juce::MemoryOutputStream(writer.addSection(StateSection::Timeline, 1), false).writeString("Intro");
+            
+            juce::MemoryBlock chunk;
+            writer.writeTo(chunk);
+            
+            StateChunkReader reader(chunk.getData(), chunk.getSize());
+            expect(reader.isValid());
+            
+            auto timeline = reader.createSectionStream(StateSection::Timeline);
+            expect(timeline != nullptr && timeline->readString() == "Intro");
+        }
+        
+        beginTest("Legacy JSON is not taken for a chunk");
+        {
+            const juce::String json = "{\"bpm\": 120}";
+            expect(!StateChunkReader::isStateChunk(json.toRawUTF8(), json.getNumBytesAsUTF8()));
+            
+            StateChunkReader reader(json.toRawUTF8(), json.getNumBytesAsUTF8());
+            expect(!reader.isValid());
+        }
+        
+        beginTest("Truncated chunks are rejected");
+        {
+            juce::MemoryBlock chunk;
+            writeTestChunk(chunk);
+            
+            // Cut into the last payload, and into the section table
+            for (size_t size : { chunk.getSize() - 1, static_cast<size_t>(20) })
+            {
+                StateChunkReader reader(chunk.getData(), size);
+                expect(!reader.isValid());
+                expect(!reader.hasSection(StateSection::ProcessorParams));
+            }
+        }
+        
+        beginTest("Newer format versions are rejected");
+        {
+            juce::MemoryBlock chunk;
+            writeTestChunk(chunk);
+            
+            // The format version follows the 4-byte magic
+            const auto newer = juce::ByteOrder::swapIfBigEndian(static_cast<juce::uint32>(StateChunkReader::FORMAT_VERSION + 1));
+            std::memcpy(static_cast<char*>(chunk.getData()) + 4, &newer, sizeof(newer));
+            
+            StateChunkReader reader(chunk.getData(), chunk.getSize());
+            expect(!reader.isValid());
+        }
+    }
+
+private:
+    static void writeTestChunk(juce::MemoryBlock& destData)
+    {
+        StateChunkWriter writer;
+        
+        {
+            juce::MemoryOutputStream params(writer.addSection(StateSection::ProcessorParams, 3), false);
+            params.writeDouble(128.0);
+            params.writeInt(42);
+            params.writeBool(true);
+        }
+        
+        {
+            juce::MemoryOutputStream timeline(writer.addSection(StateSection::Timeline, 1), false);
+            timeline.writeString("Verse");
+            timeline.writeString("Hook");
+        }
+        
+        writer.addSection(StateSection::FXChains, 2);
+        writer.writeTo(destData);
+    }
+};
+
+static StateChunkTests stateChunkTests;
+
+} // namespace MAEVN
@@ -0,0 +1,31 @@
+/**
+ * @file TestMain.cpp
+ * @brief Runs every MAEVN unit test (MAEVN_Tests)
+ *
+ *     MAEVN_Tests [--seed=<n>]
+ *
+ * The tests register themselves as juce::UnitTest instances in the
+ * "MAEVN" category. The exit code is non-zero if any expectation failed,
+ * so the target can run under ctest.
+ */
+
+#include <JuceHeader.h>
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+    const auto seed = args.getValueForOption("--seed").getLargeIntValue();
+    
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("MAEVN", seed);
+    
+    int numFailures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        numFailures += runner.getResult(i)->failures;
+    
+    // The log writer is a DeletedAtShutdown singleton
+    juce::DeletedAtShutdown::deleteAll();
+    
+    return numFailures > 0 ? 1 : 0;
+}
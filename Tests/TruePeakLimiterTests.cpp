@@ -0,0 +1,141 @@
+/**
+ * @file TruePeakLimiterTests.cpp
+ * @brief TruePeakLimiter ceiling on inter-sample peaks, and transparency below it
+ */
+
+#include <JuceHeader.h>
+#include <vector>
+#include "TruePeakLimiter.h"
+
+namespace MAEVN
+{
+
+namespace
+{
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr int BLOCK_SIZE = 512;
+}
+
+//==============================================================================
+class TruePeakLimiterTests : public juce::UnitTest
+{
+public:
+    TruePeakLimiterTests() : juce::UnitTest("TruePeakLimiter", "MAEVN") {}
+    
+    void runTest() override
+    {
+        beginTest("Inter-sample peaks are held to the ceiling");
+        {
+            // A sine at fs/4 with a 45 degree phase: every sample sits at -3 dBFS
+            // while the waveform peaks at 0 dBTP halfway between samples. A
+            // sample-peak limiter set to -2 dB would let it through untouched.
+            constexpr float ceilingDB = -2.0f;
+            
+            TruePeakLimiter limiter;
+            limiter.setCeiling(ceilingDB);
+            limiter.prepare(SAMPLE_RATE, BLOCK_SIZE, 2);
+            
+            juce::AudioBuffer<float> buffer(2, BLOCK_SIZE);
+            constexpr int numBlocks = 200;
+            float samplePeak = 0.0f;
+            
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (int i = 0; i < BLOCK_SIZE; ++i)
+                {
+                    const double n = block * BLOCK_SIZE + i;
+                    const auto sample = static_cast<float>(std::sin(juce::MathConstants<double>::halfPi * n
+                                                                    + juce::MathConstants<double>::pi / 4.0));
+                    buffer.setSample(0, i, sample);
+                    buffer.setSample(1, i, sample);
+                }
+                
+                limiter.process(buffer, BLOCK_SIZE);
+                
+                // Measure once the gain has settled
+                if (block >= numBlocks / 2)
+                    samplePeak = juce::jmax(samplePeak, buffer.getMagnitude(0, BLOCK_SIZE),
+                                            buffer.getMagnitude(1, BLOCK_SIZE));
+            }
+            
+            // The settled output is the input scaled by a constant gain, so its
+            // true peak is exactly sqrt(2) times its sample peak
+            const float truePeakDB = juce::Decibels::gainToDecibels(samplePeak * juce::MathConstants<float>::sqrt2);
+            
+            // Allowance for the 4x detector's interpolation error at fs/4
+            expectLessOrEqual(truePeakDB, ceilingDB + 0.1f, "true peak above the ceiling");
+            expectGreaterThan(truePeakDB, ceilingDB - 0.5f, "limited far below the ceiling");
+            expectLessThan(limiter.getGainReductionDB(), 0.0f);
+        }
+        
+        beginTest("Audio below the ceiling is only delayed");
+        {
+            TruePeakLimiter limiter;
+            limiter.setCeiling(-1.0f);
+            limiter.prepare(SAMPLE_RATE, BLOCK_SIZE, 2);
+            
+            const int latency = limiter.getLatencySamples();
+            expectGreaterThan(latency, 0);
+            
+            constexpr int numBlocks = 40;
+            std::vector<float> input(static_cast<size_t>(numBlocks * BLOCK_SIZE));
+            for (size_t n = 0; n < input.size(); ++n)
+                input[n] = 0.25f * static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * 997.0 * n / SAMPLE_RATE));
+            
+            juce::AudioBuffer<float> buffer(2, BLOCK_SIZE);
+            double worstError = 0.0;
+            
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                const auto* source = input.data() + block * BLOCK_SIZE;
+                buffer.copyFrom(0, 0, source, BLOCK_SIZE);
+                buffer.copyFrom(1, 0, source, BLOCK_SIZE);
+                
+                limiter.process(buffer, BLOCK_SIZE);
+                
+                for (int i = 0; i < BLOCK_SIZE; ++i)
+                {
+                    const int n = block * BLOCK_SIZE + i;
+                    const float expected = n >= latency ? input[static_cast<size_t>(n - latency)] : 0.0f;
+                    
+                    for (int ch = 0; ch < 2; ++ch)
+                        worstError = juce::jmax(worstError, static_cast<double>(std::abs(buffer.getSample(ch, i) - expected)));
+                }
+            }
+            
+            expectLessThan(worstError, 1.0e-6);
+            expectEquals(limiter.getGainReductionDB(), 0.0f);
+        }
+        
+        beginTest("Input gain drives the signal into the ceiling");
+        {
+            constexpr float ceilingDB = -1.0f;
+            
+            TruePeakLimiter limiter;
+            limiter.setCeiling(ceilingDB);
+            limiter.setInputGain(12.0f);
+            limiter.prepare(SAMPLE_RATE, BLOCK_SIZE, 1);
+            
+            juce::AudioBuffer<float> buffer(1, BLOCK_SIZE);
+            juce::Random random(getRandom().nextInt64());
+            float samplePeak = 0.0f;
+            
+            for (int block = 0; block < 100; ++block)
+            {
+                for (int i = 0; i < BLOCK_SIZE; ++i)
+                    buffer.setSample(0, i, random.nextFloat() * 2.0f - 1.0f);
+                
+                limiter.process(buffer, BLOCK_SIZE);
+                samplePeak = juce::jmax(samplePeak, buffer.getMagnitude(0, BLOCK_SIZE));
+            }
+            
+            // Sample peaks are clipped to the ceiling whatever the detector misses
+            expectLessOrEqual(juce::Decibels::gainToDecibels(samplePeak), ceilingDB + 1.0e-4f);
+            expectLessThan(limiter.getGainReductionDB(), -6.0f);
+        }
+    }
+};
+
+static TruePeakLimiterTests truePeakLimiterTests;
+
+} // namespace MAEVN
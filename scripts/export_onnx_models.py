@@ -11,6 +11,8 @@ import os
 import numpy as np
 import sys
 import io
+import json
+import argparse
 
 # Configure UTF-8 encoding for stdout to prevent UnicodeEncodeError
 if not sys.stdout.encoding or sys.stdout.encoding.lower() not in ('utf-8', 'utf8'):
@@ -111,12 +113,65 @@ def export_model(model, dummy_input, output_path, model_name):
     
     print(f"[OK] {model_name} exported successfully")
 
+def export_variants(fp32_path, precisions):
+    """Write fp16 / int8 variants next to an fp32 model, return {precision: path}"""
+    variants = {"fp32": fp32_path}
+    stem, ext = os.path.splitext(fp32_path)
+    
+    if "fp16" in precisions:
+        import onnx
+        from onnxruntime.transformers.float16 import convert_float_to_float16
+        
+        # Keep float32 inputs/outputs so the plugin feeds every variant the same tensors
+        fp16_path = f"{stem}.fp16{ext}"
+        model = convert_float_to_float16(onnx.load(fp32_path), keep_io_types=True)
+        onnx.save(model, fp16_path)
+        variants["fp16"] = fp16_path
+        print(f"  [OK] fp16 variant: {fp16_path}")
+    
+    if "int8" in precisions:
+        from onnxruntime.quantization import quantize_dynamic, QuantType
+        
+        # Dynamic quantization: int8 weights, activations quantized per inference
+        int8_path = f"{stem}.int8{ext}"
+        quantize_dynamic(fp32_path, int8_path, weight_type=QuantType.QInt8)
+        variants["int8"] = int8_path
+        print(f"  [OK] int8 variant: {int8_path}")
+    
+    return variants
+
+def update_config(config_path, role_variants):
+    """Merge exported variants into config.json, keeping user-supplied roles"""
+    config = {}
+    if os.path.exists(config_path):
+        with open(config_path, "r", encoding="utf-8") as f:
+            config = json.load(f)
+    
+    models_dir = os.path.dirname(config_path)
+    for role, variants in role_variants.items():
+        relative = {precision: os.path.relpath(path, models_dir).replace(os.sep, "/")
+                    for precision, path in variants.items()}
+        # A single fp32 export keeps the plain string form
+        config[role] = relative["fp32"] if list(relative) == ["fp32"] else relative
+    
+    with open(config_path, "w", encoding="utf-8") as f:
+        json.dump(config, f, indent=2)
+    print(f"[OK] Updated {config_path}")
+
 def main():
     """Main export function"""
+    parser = argparse.ArgumentParser(description="Export MAEVN instrument models to ONNX")
+    parser.add_argument("--precisions", default="fp32,fp16,int8",
+                        help="Comma-separated variants to produce (fp32 is always exported)")
+    args = parser.parse_args()
+    precisions = {p.strip().lower() for p in args.precisions.split(",") if p.strip()}
+    
     print("=" * 60)
     print("MAEVN ONNX Model Export")
     print("=" * 60)
     
+    role_variants = {}
+    
     # Set to evaluation mode
     torch.set_grad_enabled(False)
     
@@ -125,30 +180,37 @@ def main():
     model_808.eval()
     dummy_808 = torch.randn(1, 128)
     export_model(model_808, dummy_808, "../Models/drums/808_ddsp.onnx", "808 Bass")
+    role_variants["808"] = export_variants("../Models/drums/808_ddsp.onnx", precisions)
     
     # Export hi-hat model
     model_hihat = SimpleHiHat()
     model_hihat.eval()
     dummy_hihat = torch.randn(1, 64)
     export_model(model_hihat, dummy_hihat, "../Models/drums/hihat_ddsp.onnx", "Hi-Hat")
+    role_variants["hihat"] = export_variants("../Models/drums/hihat_ddsp.onnx", precisions)
     
     # Export snare model
     model_snare = SimpleSnare()
     model_snare.eval()
     dummy_snare = torch.randn(1, 64)
     export_model(model_snare, dummy_snare, "../Models/drums/snare_ddsp.onnx", "Snare")
+    role_variants["snare"] = export_variants("../Models/drums/snare_ddsp.onnx", precisions)
     
     # Export piano model
     model_piano = SimplePiano()
     model_piano.eval()
     dummy_piano = torch.randn(1, 256)
     export_model(model_piano, dummy_piano, "../Models/instruments/piano_ddsp.onnx", "Piano")
+    role_variants["piano"] = export_variants("../Models/instruments/piano_ddsp.onnx", precisions)
     
     # Export synth model
     model_synth = SimpleSynth()
     model_synth.eval()
     dummy_synth = torch.randn(1, 128)
     export_model(model_synth, dummy_synth, "../Models/instruments/synth_fm.onnx", "Synth")
+    role_variants["synth"] = export_variants("../Models/instruments/synth_fm.onnx", precisions)
+    
+    update_config("../Models/config.json", role_variants)
     
     print("=" * 60)
     print("All models exported successfully!")